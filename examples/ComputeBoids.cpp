@@ -269,7 +269,7 @@ nxt::CommandBuffer createCommandBuffer(const nxt::Framebuffer& framebuffer, size
             .SetComputePipeline(updatePipeline)
             .TransitionBufferUsage(bufferSrc, nxt::BufferUsageBit::Storage)
             .TransitionBufferUsage(bufferDst, nxt::BufferUsageBit::Storage)
-            .SetBindGroup(0, updateBGs[i])
+            .SetBindGroup(0, updateBGs[i], 0, nullptr)
             .Dispatch(kNumParticles, 1, 1)
         .EndComputePass()
 
@@ -140,7 +140,7 @@ void frame() {
         .BeginComputePass()
             .SetComputePipeline(computePipeline)
             .TransitionBufferUsage(buffer, nxt::BufferUsageBit::Storage)
-            .SetBindGroup(0, computeBindGroup)
+            .SetBindGroup(0, computeBindGroup, 0, nullptr)
             .Dispatch(1, 1, 1)
         .EndComputePass()
 
@@ -148,7 +148,7 @@ void frame() {
         .BeginRenderSubpass()
             .SetRenderPipeline(renderPipeline)
             .TransitionBufferUsage(buffer, nxt::BufferUsageBit::Uniform)
-            .SetBindGroup(0, renderBindGroup)
+            .SetBindGroup(0, renderBindGroup, 0, nullptr)
             .DrawArrays(3, 1, 0, 0)
         .EndRenderSubpass()
         .EndRenderPass()
@@ -286,20 +286,20 @@ void frame() {
         .BeginRenderSubpass()
             .SetRenderPipeline(pipeline)
             .TransitionBufferUsage(cameraBuffer, nxt::BufferUsageBit::Uniform)
-            .SetBindGroup(0, bindGroup[0])
+            .SetBindGroup(0, bindGroup[0], 0, nullptr)
             .SetVertexBuffers(0, 1, &vertexBuffer, vertexBufferOffsets)
             .SetIndexBuffer(indexBuffer, 0)
             .DrawElements(36, 1, 0, 0)
 
             .SetStencilReference(0x1)
             .SetRenderPipeline(planePipeline)
-            .SetBindGroup(0, bindGroup[0])
+            .SetBindGroup(0, bindGroup[0], 0, nullptr)
             .SetVertexBuffers(0, 1, &planeBuffer, vertexBufferOffsets)
             .DrawElements(6, 1, 0, 0)
 
             .SetRenderPipeline(reflectionPipeline)
             .SetVertexBuffers(0, 1, &vertexBuffer, vertexBufferOffsets)
-            .SetBindGroup(0, bindGroup[1])
+            .SetBindGroup(0, bindGroup[1], 0, nullptr)
             .DrawElements(36, 1, 0, 0)
         .EndRenderSubpass()
         .EndRenderPass()
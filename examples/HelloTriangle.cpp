@@ -159,7 +159,7 @@ void frame() {
         .BeginRenderPass(renderpass, framebuffer)
         .BeginRenderSubpass()
             .SetRenderPipeline(pipeline)
-            .SetBindGroup(0, bindGroup)
+            .SetBindGroup(0, bindGroup, 0, nullptr)
             .SetVertexBuffers(0, 1, &vertexBuffer, vertexBufferOffsets)
             .SetIndexBuffer(indexBuffer, 0)
             .DrawElements(3, 1, 0, 0)
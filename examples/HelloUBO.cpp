@@ -108,7 +108,7 @@ void frame() {
         .BeginRenderSubpass()
             .SetRenderPipeline(pipeline)
             .TransitionBufferUsage(buffer, nxt::BufferUsageBit::Uniform)
-            .SetBindGroup(0, bindGroup)
+            .SetBindGroup(0, bindGroup, 0, nullptr)
             .DrawArrays(3, 1, 0, 0)
         .EndRenderSubpass()
         .EndRenderPass()
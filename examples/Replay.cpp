@@ -0,0 +1,219 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays a trace recorded with the --trace option of the samples on a wire server, to benchmark
+// the server with the workload of a real application. With the null backend it measures the cost
+// of the wire and of the frontend validation only, and checks that the replay is deterministic.
+
+#include "utils/BackendBinding.h"
+#include "wire/TraceReplayer.h"
+#include "wire/WireCmd.h"
+
+#include <nxt/nxt.h>
+#include "GLFW/glfw3.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace nxt::wire;
+
+static bool ReadTrace(const char* filename, std::vector<uint64_t>* trace, size_t* size) {
+    FILE* file = fopen(filename, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // Read in uint64_t so that the trace is aligned to 8 bytes.
+    trace->resize((fileSize + 7) / 8);
+    bool success = fileSize >= 0 &&
+                   fread(trace->data(), 1, fileSize, file) == static_cast<size_t>(fileSize);
+    fclose(file);
+
+    *size = static_cast<size_t>(fileSize);
+    return success;
+}
+
+int main(int argc, const char** argv) {
+    utils::BackendType backendType = utils::BackendType::Null;
+    const char* filename = nullptr;
+    int iterations = 10;
+    bool perCommand = false;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::string("-b") == argv[i] || std::string("--backend") == argv[i]) {
+            i++;
+            if (i < argc && std::string("d3d12") == argv[i]) {
+                backendType = utils::BackendType::D3D12;
+                continue;
+            }
+            if (i < argc && std::string("metal") == argv[i]) {
+                backendType = utils::BackendType::Metal;
+                continue;
+            }
+            if (i < argc && std::string("null") == argv[i]) {
+                backendType = utils::BackendType::Null;
+                continue;
+            }
+            if (i < argc && std::string("opengl") == argv[i]) {
+                backendType = utils::BackendType::OpenGL;
+                continue;
+            }
+            if (i < argc && std::string("vulkan") == argv[i]) {
+                backendType = utils::BackendType::Vulkan;
+                continue;
+            }
+            fprintf(stderr,
+                    "--backend expects a backend name (opengl, metal, d3d12, null, vulkan)\n");
+            return 1;
+        }
+        if (std::string("-n") == argv[i] || std::string("--iterations") == argv[i]) {
+            i++;
+            if (i < argc && atoi(argv[i]) > 0) {
+                iterations = atoi(argv[i]);
+                continue;
+            }
+            fprintf(stderr, "--iterations expects a positive number\n");
+            return 1;
+        }
+        if (std::string("-p") == argv[i] || std::string("--per-command") == argv[i]) {
+            perCommand = true;
+            continue;
+        }
+        if (std::string("--check") == argv[i]) {
+            check = true;
+            continue;
+        }
+        if (std::string("-h") == argv[i] || std::string("--help") == argv[i]) {
+            printf("Usage: %s [-b BACKEND] [-n ITERATIONS] [-p] [--check] TRACE_FILE\n", argv[0]);
+            printf("  BACKEND is one of: d3d12, metal, null, opengl, vulkan, default is null\n");
+            printf("  -p times each type of command, which adds the overhead of the timer\n");
+            printf("  --check fails if the return commands differ from the trace's, which is\n");
+            printf("    only expected to pass with the backend used for the trace\n");
+            return 0;
+        }
+        filename = argv[i];
+    }
+
+    if (filename == nullptr) {
+        fprintf(stderr, "Expected a trace file, see --help\n");
+        return 1;
+    }
+
+    std::vector<uint64_t> traceStorage;
+    size_t traceSize = 0;
+    if (!ReadTrace(filename, &traceStorage, &traceSize)) {
+        fprintf(stderr, "Couldn't read trace file %s\n", filename);
+        return 1;
+    }
+
+    TraceReplayer replayer(reinterpret_cast<uint8_t*>(traceStorage.data()), traceSize);
+    if (!replayer.IsValid()) {
+        fprintf(stderr, "Invalid trace file %s\n", filename);
+        return 1;
+    }
+
+    utils::BackendBinding* binding = utils::CreateBinding(backendType);
+    if (binding == nullptr) {
+        fprintf(stderr, "Backend not supported\n");
+        return 1;
+    }
+
+    // Backends other than null need a window, but it doesn't need to be shown.
+    if (backendType != utils::BackendType::Null) {
+        if (!glfwInit()) {
+            return 1;
+        }
+        binding->SetupGLFWWindowHints();
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        GLFWwindow* window = glfwCreateWindow(640, 480, "NXT replay", nullptr, nullptr);
+        if (window == nullptr) {
+            return 1;
+        }
+        binding->SetWindow(window);
+    }
+    replayer.SetSwapChainImplementation(binding->GetSwapChainImplementation());
+
+    std::vector<ReplayCommandStats> stats;
+    uint64_t bestNanoseconds = UINT64_MAX;
+    uint64_t totalNanoseconds = 0;
+    uint64_t firstHash = 0;
+    for (int i = 0; i < iterations; ++i) {
+        // Each iteration uses a new device and server, so that it starts from the same state.
+        nxtProcTable procs;
+        nxtDevice device;
+        binding->GetProcAndDevice(&procs, &device);
+
+        if (!replayer.Replay(device, procs, perCommand ? &stats : nullptr)) {
+            fprintf(stderr, "The server rejected commands of the trace in iteration %d\n", i);
+            return 1;
+        }
+
+        uint64_t nanoseconds = replayer.GetReplayNanoseconds();
+        bestNanoseconds = std::min(bestNanoseconds, nanoseconds);
+        totalNanoseconds += nanoseconds;
+
+        if (i == 0) {
+            firstHash = replayer.GetReplayReturnHash();
+        } else if (replayer.GetReplayReturnHash() != firstHash) {
+            fprintf(stderr, "Iteration %d returned different commands than the first one\n", i);
+            return 1;
+        }
+    }
+
+    uint64_t commandCount = replayer.GetCommandCount();
+    uint64_t commandBytes = replayer.GetCommandBytes();
+    if (commandCount == 0) {
+        printf("The trace doesn't contain commands\n");
+        return 0;
+    }
+
+    double bestSeconds = static_cast<double>(bestNanoseconds) * 1e-9;
+    double count = static_cast<double>(commandCount);
+    double bytes = static_cast<double>(commandBytes);
+    printf("%llu commands, %llu bytes\n", static_cast<unsigned long long>(commandCount),
+           static_cast<unsigned long long>(commandBytes));
+    printf("Best of %d: %.3f ms, %.1f ns/command, %.1f Mcommands/s, %.1f MB/s\n", iterations,
+           bestSeconds * 1e3, static_cast<double>(bestNanoseconds) / count,
+           count / bestSeconds * 1e-6, bytes / bestSeconds * 1e-6);
+    printf("Average: %.3f ms\n", static_cast<double>(totalNanoseconds) / iterations * 1e-6);
+
+    if (perCommand) {
+        printf("\n%-48s %12s %12s %12s\n", "Command", "Count", "Bytes", "ns/command");
+        for (size_t id = 0; id < stats.size(); ++id) {
+            const ReplayCommandStats& commandStats = stats[id];
+            if (commandStats.count == 0) {
+                continue;
+            }
+            printf("%-48s %12llu %12llu %12.1f\n", GetWireCmdName(static_cast<WireCmd>(id)),
+                   static_cast<unsigned long long>(commandStats.count / iterations),
+                   static_cast<unsigned long long>(commandStats.bytes / iterations),
+                   static_cast<double>(commandStats.nanoseconds) /
+                       static_cast<double>(commandStats.count));
+        }
+    }
+
+    if (check && firstHash != replayer.GetTracedReturnHash()) {
+        fprintf(stderr, "The return commands differ from the trace's\n");
+        return 1;
+    }
+    return 0;
+}
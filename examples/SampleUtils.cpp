@@ -14,7 +14,10 @@
 
 #include "common/Platform.h"
 #include "utils/BackendBinding.h"
-#include "wire/TerribleCommandBuffer.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/CommandTrace.h"
+#include "wire/CompactEncoding.h"
+#include "wire/WireServerThread.h"
 
 #include <nxt/nxt.h>
 #include <nxt/nxtcpp.h>
@@ -30,8 +33,9 @@ void PrintDeviceError(const char* message, nxt::CallbackUserdata) {
 
 enum class CmdBufType {
     None,
-    Terrible,
-    //TODO(cwallez@chromium.org) double terrible cmdbuf
+    Chunked,
+    Compact,
+    Threaded,
 };
 
 // Default to D3D12, Metal, Vulkan, OpenGL in that order as D3D12 and Metal are the preferred on
@@ -48,15 +52,42 @@ enum class CmdBufType {
     #error
 #endif
 
-static CmdBufType cmdBufType = CmdBufType::Terrible;
+static CmdBufType cmdBufType = CmdBufType::Chunked;
 static utils::BackendBinding* binding = nullptr;
 
 static GLFWwindow* window = nullptr;
 
 static nxt::wire::CommandHandler* wireServer = nullptr;
 static nxt::wire::CommandHandler* wireClient = nullptr;
-static nxt::wire::TerribleCommandBuffer* c2sBuf = nullptr;
-static nxt::wire::TerribleCommandBuffer* s2cBuf = nullptr;
+static nxt::wire::ChunkedCommandSerializer* c2sBuf = nullptr;
+static nxt::wire::ChunkedCommandSerializer* s2cBuf = nullptr;
+static nxt::wire::CompactCommandSerializer* compactC2sBuf = nullptr;
+static nxt::wire::CompactCommandHandler* compactWireServer = nullptr;
+static nxt::wire::WireServerThread* wireServerThread = nullptr;
+
+// When tracing, the client and server write their commands through the trace serializers.
+static const char* traceFilename = nullptr;
+static nxt::wire::TraceWriter* traceWriter = nullptr;
+static nxt::wire::TraceCommandSerializer* c2sTrace = nullptr;
+static nxt::wire::TraceCommandSerializer* s2cTrace = nullptr;
+
+static nxt::wire::CommandSerializer* TraceC2S(nxt::wire::CommandSerializer* serializer) {
+    if (traceWriter == nullptr) {
+        return serializer;
+    }
+    c2sTrace = new nxt::wire::TraceCommandSerializer(serializer, traceWriter,
+                                                     nxt::wire::TraceRecordType::Commands);
+    return c2sTrace;
+}
+
+static nxt::wire::CommandSerializer* TraceS2C(nxt::wire::CommandSerializer* serializer) {
+    if (traceWriter == nullptr) {
+        return serializer;
+    }
+    s2cTrace = new nxt::wire::TraceCommandSerializer(serializer, traceWriter,
+                                                     nxt::wire::TraceRecordType::ReturnCommands);
+    return s2cTrace;
+}
 
 nxt::Device CreateCppNXTDevice() {
     binding = utils::CreateBinding(backendType);
@@ -80,6 +111,15 @@ nxt::Device CreateCppNXTDevice() {
     nxtProcTable backendProcs;
     binding->GetProcAndDevice(&backendProcs, &backendDevice);
 
+    if (traceFilename != nullptr) {
+        FILE* traceFile = fopen(traceFilename, "wb");
+        if (traceFile == nullptr) {
+            fprintf(stderr, "Couldn't open trace file %s\n", traceFilename);
+            return nxt::Device();
+        }
+        traceWriter = new nxt::wire::TraceWriter(traceFile);
+    }
+
     nxtDevice cDevice = nullptr;
     nxtProcTable procs;
     switch (cmdBufType) {
@@ -88,23 +128,62 @@ nxt::Device CreateCppNXTDevice() {
             cDevice = backendDevice;
             break;
 
-        case CmdBufType::Terrible:
+        case CmdBufType::Chunked:
             {
-                c2sBuf = new nxt::wire::TerribleCommandBuffer();
-                s2cBuf = new nxt::wire::TerribleCommandBuffer();
+                c2sBuf = new nxt::wire::ChunkedCommandSerializer();
+                s2cBuf = new nxt::wire::ChunkedCommandSerializer();
 
-                wireServer = nxt::wire::NewServerCommandHandler(backendDevice, backendProcs, s2cBuf);
+                wireServer = nxt::wire::NewServerCommandHandler(backendDevice, backendProcs,
+                                                                TraceS2C(s2cBuf));
                 c2sBuf->SetHandler(wireServer);
 
                 nxtDevice clientDevice;
                 nxtProcTable clientProcs;
-                wireClient = nxt::wire::NewClientDevice(&clientProcs, &clientDevice, c2sBuf);
+                wireClient =
+                    nxt::wire::NewClientDevice(&clientProcs, &clientDevice, TraceC2S(c2sBuf));
+                s2cBuf->SetHandler(wireClient);
+
+                procs = clientProcs;
+                cDevice = clientDevice;
+            }
+            break;
+
+        case CmdBufType::Compact:
+            {
+                c2sBuf = new nxt::wire::ChunkedCommandSerializer();
+                s2cBuf = new nxt::wire::ChunkedCommandSerializer();
+                compactC2sBuf = new nxt::wire::CompactCommandSerializer(c2sBuf);
+
+                wireServer = nxt::wire::NewServerCommandHandler(backendDevice, backendProcs,
+                                                                TraceS2C(s2cBuf));
+                compactWireServer = new nxt::wire::CompactCommandHandler(wireServer);
+                c2sBuf->SetHandler(compactWireServer);
+
+                // The commands are traced before their compact encoding, as the server sees them.
+                nxtDevice clientDevice;
+                nxtProcTable clientProcs;
+                wireClient = nxt::wire::NewClientDevice(&clientProcs, &clientDevice,
+                                                        TraceC2S(compactC2sBuf));
                 s2cBuf->SetHandler(wireClient);
 
                 procs = clientProcs;
                 cDevice = clientDevice;
             }
             break;
+
+        case CmdBufType::Threaded:
+            {
+                wireServerThread = new nxt::wire::WireServerThread(backendDevice, backendProcs);
+
+                nxtDevice clientDevice;
+                nxtProcTable clientProcs;
+                wireClient = nxt::wire::NewClientDevice(&clientProcs, &clientDevice,
+                                                        wireServerThread->GetCommandSerializer());
+
+                procs = clientProcs;
+                cDevice = clientDevice;
+            }
+            break;
     }
 
     nxtSetProcs(&procs);
@@ -201,27 +280,62 @@ bool InitSample(int argc, const char** argv) {
                 cmdBufType = CmdBufType::None;
                 continue;
             }
-            if (i < argc && std::string("terrible") == argv[i]) {
-                cmdBufType = CmdBufType::Terrible;
+            if (i < argc && std::string("chunked") == argv[i]) {
+                cmdBufType = CmdBufType::Chunked;
+                continue;
+            }
+            if (i < argc && std::string("compact") == argv[i]) {
+                cmdBufType = CmdBufType::Compact;
+                continue;
+            }
+            if (i < argc && std::string("threaded") == argv[i]) {
+                cmdBufType = CmdBufType::Threaded;
                 continue;
             }
-            fprintf(stderr, "--command-buffer expects a command buffer name (none, terrible)\n");
+            fprintf(stderr, "--command-buffer expects a command buffer name (none, chunked, compact, threaded)\n");
+            return false;
+        }
+        if (std::string("-t") == argv[i] || std::string("--trace") == argv[i]) {
+            i++;
+            if (i < argc) {
+                traceFilename = argv[i];
+                continue;
+            }
+            fprintf(stderr, "--trace expects a file name\n");
             return false;
         }
         if (std::string("-h") == argv[i] || std::string("--help") == argv[i]) {
-            printf("Usage: %s [-b BACKEND] [-c COMMAND_BUFFER]\n", argv[0]);
+            printf("Usage: %s [-b BACKEND] [-c COMMAND_BUFFER] [-t TRACE_FILE]\n", argv[0]);
             printf("  BACKEND is one of: d3d12, metal, null, opengl, vulkan\n");
-            printf("  COMMAND_BUFFER is one of: none, terrible\n");
+            printf("  COMMAND_BUFFER is one of: none, chunked, compact, threaded\n");
+            printf("  compact uses the compact wire encoding for client commands\n");
+            printf("  threaded runs the wire server on its own thread, the backend must support it\n");
+            printf("  TRACE_FILE records the wire commands for nxt_replay, with chunked or compact\n");
             return false;
         }
     }
+    if (traceFilename != nullptr && cmdBufType != CmdBufType::Chunked &&
+        cmdBufType != CmdBufType::Compact) {
+        fprintf(stderr, "--trace needs the chunked or compact command buffer\n");
+        return false;
+    }
     return true;
 }
 
 void DoFlush() {
-    if (cmdBufType == CmdBufType::Terrible) {
+    if (c2sTrace != nullptr) {
+        c2sTrace->Flush();
+        s2cTrace->Flush();
+    } else if (cmdBufType == CmdBufType::Chunked) {
         c2sBuf->Flush();
         s2cBuf->Flush();
+    } else if (cmdBufType == CmdBufType::Compact) {
+        compactC2sBuf->Flush();
+        s2cBuf->Flush();
+    }
+    if (cmdBufType == CmdBufType::Threaded) {
+        wireServerThread->GetCommandSerializer()->Flush();
+        wireServerThread->HandleReturnCommands(wireClient);
     }
     glfwPollEvents();
 }
@@ -512,7 +512,7 @@ namespace {
                     reinterpret_cast<const uint32_t*>(&transforms));
             cmd.SetRenderPipeline(material.pipeline);
             cmd.TransitionBufferUsage(material.uniformBuffer, nxt::BufferUsageBit::Uniform);
-            cmd.SetBindGroup(0, material.bindGroup0);
+            cmd.SetBindGroup(0, material.bindGroup0, 0, nullptr);
 
             uint32_t vertexCount = 0;
             for (const auto& s : slotSemantics) {
@@ -98,8 +98,11 @@ class ObjectType(Type):
 ############################################################
 import json
 
+# Methods returning values other than objects are native too because the wire can't return them.
 def is_native_method(method):
-    return method.return_type.category == "natively defined" or \
+    returns_native_value = method.return_type.category == "native" and \
+        method.return_type.name.canonical_case() != "void"
+    return method.return_type.category == "natively defined" or returns_native_value or \
         any([arg.type.category == "natively defined" for arg in method.arguments])
 
 def link_object(obj, types):
@@ -350,7 +353,7 @@ def debug(text):
     print(text)
 
 def main():
-    targets = ['nxt', 'nxtcpp', 'mock_nxt', 'opengl', 'metal', 'd3d12', 'null', 'wire', 'blink']
+    targets = ['nxt', 'nxtcpp', 'mock_nxt', 'opengl', 'metal', 'd3d12', 'null', 'wire', 'tracing', 'blink']
 
     parser = argparse.ArgumentParser(
         description = 'Generates code for various target for NXT.',
@@ -437,10 +440,20 @@ def main():
         renders.append(FileRender('BackendProcTable.cpp', backend + '/ProcTable.' + extension, base_backend_params + [backend_params]))
 
     if 'wire' in targets:
-        renders.append(FileRender('wire/WireCmd.h', 'wire/WireCmd_autogen.h', base_backend_params))
-        renders.append(FileRender('wire/WireCmd.cpp', 'wire/WireCmd_autogen.cpp', base_backend_params))
-        renders.append(FileRender('wire/WireClient.cpp', 'wire/WireClient.cpp', base_backend_params))
-        renders.append(FileRender('wire/WireServer.cpp', 'wire/WireServer.cpp', base_backend_params))
+        wire_params = base_backend_params + [{
+            # Commands with only value arguments have the same size every time
+            'has_fixed_size': lambda method: all(arg.annotation == 'value' for arg in method.arguments)
+        }]
+        renders.append(FileRender('wire/WireCmd.h', 'wire/WireCmd_autogen.h', wire_params))
+        renders.append(FileRender('wire/WireCmd.cpp', 'wire/WireCmd_autogen.cpp', wire_params))
+        renders.append(FileRender('wire/WireClient.cpp', 'wire/WireClient.cpp', wire_params))
+        renders.append(FileRender('wire/WireServer.cpp', 'wire/WireServer.cpp', wire_params))
+
+    if 'tracing' in targets:
+        tracing_params = {
+            'has_array_arguments': lambda method: any(arg.annotation != 'value' for arg in method.arguments)
+        }
+        renders.append(FileRender('TracingProcTable.cpp', 'tracing/TracingProcTable.cpp', [base_params, api_params, c_params, tracing_params]))
 
     if 'blink' in targets:
         js_params = {'native_methods': lambda typ: js_native_methods(api_params['types'], typ)}
@@ -48,6 +48,8 @@ namespace {{namespace}} {
 
         {% set methodsWithExtraValidation = (
             "CommandBufferBuilderGetResult",
+            "RenderBundleBuilderGetResult",
+            "QueueSignal",
             "QueueSubmit",
         ) %}
 
@@ -81,9 +83,10 @@ namespace {{namespace}} {
                 }
 
                 //* Autogenerated part of the entry point validation
-                //*  - Check that enum and bitmaks are in the correct range
+                //*  - Check that enum and bitmaks are in the correct range, unless kCheckValues is false
                 //*  - Check that builders have not been consumed already
                 //*  - Others TODO
+                template <bool kCheckValues>
                 bool ValidateBase{{suffix}}(
                     {{-as_backendType(type)}} self
                     {%- for arg in method.arguments -%}
@@ -101,9 +104,9 @@ namespace {{namespace}} {
                     bool error = false;
                     {% for arg in method.arguments %}
                         {% if arg.type.category == "enum" %}
-                            if (!CheckEnum{{as_cType(arg.type.name)}}({{as_varName(arg.name)}})) error = true;;
+                            if (kCheckValues && !CheckEnum{{as_cType(arg.type.name)}}({{as_varName(arg.name)}})) error = true;;
                         {% elif arg.type.category == "bitmask" %}
-                            if (!CheckBitmask{{as_cType(arg.type.name)}}({{as_varName(arg.name)}})) error = true;
+                            if (kCheckValues && !CheckBitmask{{as_cType(arg.type.name)}}({{as_varName(arg.name)}})) error = true;
                         {% else %}
                             (void) {{as_varName(arg.name)}};
                         {% endif %}
@@ -120,6 +123,7 @@ namespace {{namespace}} {
                 }
 
                 //* Entry point with validation
+                template <bool kCheckValues>
                 {{as_backendType(method.return_type)}} Validating{{suffix}}(
                     {{-as_backendType(type)}} self
                     {%- for arg in method.arguments -%}
@@ -127,7 +131,7 @@ namespace {{namespace}} {
                     {%- endfor -%}
                 ) {
                     //* Do the autogenerated checks
-                    bool valid = ValidateBase{{suffix}}(self
+                    bool valid = ValidateBase{{suffix}}<kCheckValues>(self
                         {%- for arg in method.arguments -%}
                             , {{as_varName(arg.name)}}
                         {%- endfor -%}
@@ -196,7 +200,19 @@ namespace {{namespace}} {
         nxtProcTable table;
         {% for type in by_category["object"] %}
             {% for method in native_methods(type) %}
-                table.{{as_varName(type.name, method.name)}} = reinterpret_cast<{{as_cProc(type.name, method.name)}}>(Validating{{as_MethodSuffix(type.name, method.name)}});
+                table.{{as_varName(type.name, method.name)}} = reinterpret_cast<{{as_cProc(type.name, method.name)}}>(Validating{{as_MethodSuffix(type.name, method.name)}}<true>);
+            {% endfor %}
+        {% endfor %}
+        return table;
+    }
+
+    //* Procs for a wire server trusting a client that already checked the values of enums and
+    //* bitmasks. The other validation, that depends on the state of the backend, is still done.
+    nxtProcTable GetClientValidatedProcs() {
+        nxtProcTable table;
+        {% for type in by_category["object"] %}
+            {% for method in native_methods(type) %}
+                table.{{as_varName(type.name, method.name)}} = reinterpret_cast<{{as_cProc(type.name, method.name)}}>(Validating{{as_MethodSuffix(type.name, method.name)}}<false>);
             {% endfor %}
         {% endfor %}
         return table;
@@ -0,0 +1,116 @@
+//* Copyright 2017 The NXT Authors
+//*
+//* Licensed under the Apache License, Version 2.0 (the "License");
+//* you may not use this file except in compliance with the License.
+//* You may obtain a copy of the License at
+//*
+//*     http://www.apache.org/licenses/LICENSE-2.0
+//*
+//* Unless required by applicable law or agreed to in writing, software
+//* distributed under the License is distributed on an "AS IS" BASIS,
+//* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//* See the License for the specific language governing permissions and
+//* limitations under the License.
+
+#include "tracing/TracingStats.h"
+
+#include <cstring>
+
+namespace nxt { namespace tracing {
+
+    namespace {
+
+        enum EntryPoint : uint32_t {
+            {% for type in by_category["object"] %}
+                {% for method in native_methods(type) %}
+                    {{as_MethodSuffix(type.name, method.name)}},
+                {% endfor %}
+            {% endfor %}
+            Count,
+        };
+
+        //* The procs being traced, all the tracing tables forward to them.
+        nxtProcTable sProcs;
+        bool sHasProcs = false;
+
+        {% for type in by_category["object"] %}
+            {% for method in native_methods(type) %}
+                {% set suffix = as_MethodSuffix(type.name, method.name) %}
+                {{as_cType(method.return_type.name)}} Tracing{{suffix}}(
+                    {{-as_cType(type.name)}} self
+                    {%- for arg in method.arguments -%}
+                        , {{as_annotated_cType(arg)}}
+                    {%- endfor -%}
+                ) {
+                    EntryPointStats* entryPointStats =
+                        &GetThreadEntryPointStats()[EntryPoint::{{suffix}}];
+
+                    {% if has_array_arguments(method) %}
+                        //* Bytes of the array arguments, strings including their terminator.
+                        uint64_t argumentBytes = 0;
+                        {% for arg in method.arguments if arg.annotation != "value" %}
+                            {% if arg.length == "strlen" %}
+                                argumentBytes += strlen({{as_varName(arg.name)}}) + 1;
+                            {% else %}
+                                argumentBytes += static_cast<uint64_t>({{as_varName(arg.length.name)}}) * sizeof({{as_cType(arg.type.name)}});
+                            {% endif %}
+                        {% endfor %}
+                        RecordArrayBytes(entryPointStats, argumentBytes);
+                    {% endif %}
+
+                    //* Reading the timestamps costs more than the counters, so only the sampled
+                    //* calls are timed.
+                    if (!CountCall(entryPointStats)) {
+                        return sProcs.{{as_varName(type.name, method.name)}}(self
+                            {%- for arg in method.arguments -%}
+                                , {{as_varName(arg.name)}}
+                            {%- endfor -%}
+                        );
+                    }
+
+                    uint64_t callStart = ReadTimestamp();
+                    {% if method.return_type.name.canonical_case() != "void" %}
+                        auto result =
+                    {%- endif %}
+                    sProcs.{{as_varName(type.name, method.name)}}(self
+                        {%- for arg in method.arguments -%}
+                            , {{as_varName(arg.name)}}
+                        {%- endfor -%}
+                    );
+                    RecordSampledCall(entryPointStats, callStart, ReadTimestamp());
+                    {% if method.return_type.name.canonical_case() != "void" %}
+                        return result;
+                    {% endif %}
+                }
+            {% endfor %}
+        {% endfor %}
+
+    }  // anonymous namespace
+
+    const uint32_t kEntryPointCount = EntryPoint::Count;
+
+    const char* const kEntryPointNames[] = {
+        {% for type in by_category["object"] %}
+            {% for method in native_methods(type) %}
+                "{{as_cMethod(type.name, method.name)}}",
+            {% endfor %}
+        {% endfor %}
+    };
+
+    bool WrapProcs(const nxtProcTable& procs, nxtProcTable* tracingProcs) {
+        //* Wrapping other procs would make the existing tracing procs forward to them.
+        if (sHasProcs && memcmp(&sProcs, &procs, sizeof(procs)) != 0) {
+            return false;
+        }
+        sProcs = procs;
+        sHasProcs = true;
+
+        {% for type in by_category["object"] %}
+            {% for method in native_methods(type) %}
+                tracingProcs->{{as_varName(type.name, method.name)}} = Tracing{{as_MethodSuffix(type.name, method.name)}};
+            {% endfor %}
+        {% endfor %}
+        return true;
+    }
+
+}}  // namespace nxt::tracing
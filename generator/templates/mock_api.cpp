@@ -64,6 +64,22 @@ void ProcTableAsClass::BufferMapReadAsync(nxtBuffer self, uint32_t start, uint32
     OnBufferMapReadAsyncCallback(self, start, size, callback, userdata);
 }
 
+void ProcTableAsClass::DeviceMapReadRangesAsync(nxtDevice self, uint32_t count, nxtBuffer const * buffers, uint32_t const * starts, uint32_t const * sizes, nxtBufferMapReadRangesCallback callback, nxtCallbackUserdata userdata) {
+    auto object = reinterpret_cast<ProcTableAsClass::Object*>(self);
+    object->mapReadRangesCallback = callback;
+    object->mapReadRangesUserdata = userdata;
+
+    OnDeviceMapReadRangesAsyncCallback(self, count, buffers, starts, sizes, userdata);
+}
+
+void ProcTableAsClass::FenceOnCompletion(nxtFence self, uint64_t value, nxtFenceOnCompletionCallback callback, nxtCallbackUserdata userdata) {
+    auto object = reinterpret_cast<ProcTableAsClass::Object*>(self);
+    object->fenceOnCompletionCallback = callback;
+    object->userdata1 = userdata;
+
+    OnFenceOnCompletionCallback(self, value, userdata);
+}
+
 void ProcTableAsClass::CallDeviceErrorCallback(nxtDevice device, const char* message) {
     auto object = reinterpret_cast<ProcTableAsClass::Object*>(device);
     object->deviceErrorCallback(message, object->userdata1);
@@ -76,6 +92,14 @@ void ProcTableAsClass::CallMapReadCallback(nxtBuffer buffer, nxtBufferMapReadSta
     auto object = reinterpret_cast<ProcTableAsClass::Object*>(buffer);
     object->mapReadCallback(status, data, object->userdata1);
 }
+void ProcTableAsClass::CallMapReadRangesCallback(nxtDevice device, nxtBufferMapReadStatus status, uint32_t count, const void* const* data) {
+    auto object = reinterpret_cast<ProcTableAsClass::Object*>(device);
+    object->mapReadRangesCallback(status, count, data, object->mapReadRangesUserdata);
+}
+void ProcTableAsClass::CallFenceOnCompletionCallback(nxtFence fence, nxtFenceCompletionStatus status) {
+    auto object = reinterpret_cast<ProcTableAsClass::Object*>(fence);
+    object->fenceOnCompletionCallback(status, object->userdata1);
+}
 
 {% for type in by_category["object"] if type.is_builder %}
     void ProcTableAsClass::{{as_MethodSuffix(type.name, Name("set error callback"))}}({{as_cType(type.name)}} self, nxtBuilderErrorCallback callback, nxtCallbackUserdata userdata1, nxtCallbackUserdata userdata2) {
@@ -95,3 +119,8 @@ void ProcTableAsClass::CallMapReadCallback(nxtBuffer buffer, nxtBufferMapReadSta
         return reinterpret_cast<{{as_cType(type.name)}}>(mObjects.back().get());
     }
 {% endfor %}
+
+MockProcTable::MockProcTable() {
+    // Mocked devices don't have a completion fd unless the test sets one.
+    ON_CALL(*this, DeviceGetCompletionFd(testing::_)).WillByDefault(testing::Return(-1));
+}
@@ -58,22 +58,35 @@ class ProcTableAsClass {
         // Stores callback and userdata and calls the On* methods
         void DeviceSetErrorCallback(nxtDevice self, nxtDeviceErrorCallback callback, nxtCallbackUserdata userdata);
         void BufferMapReadAsync(nxtBuffer self, uint32_t start, uint32_t size, nxtBufferMapReadCallback callback, nxtCallbackUserdata userdata);
+        void DeviceMapReadRangesAsync(nxtDevice self, uint32_t count, nxtBuffer const * buffers, uint32_t const * starts, uint32_t const * sizes, nxtBufferMapReadRangesCallback callback, nxtCallbackUserdata userdata);
+        void FenceOnCompletion(nxtFence self, uint64_t value, nxtFenceOnCompletionCallback callback, nxtCallbackUserdata userdata);
+
+        // Methods returning values can't go on the wire so they aren't in the generated methods
+        virtual int32_t DeviceGetCompletionFd(nxtDevice device) = 0;
+        virtual uint64_t FenceGetCompletedValue(nxtFence fence) = 0;
 
         // Special cased mockable methods
         virtual void OnDeviceSetErrorCallback(nxtDevice device, nxtDeviceErrorCallback callback, nxtCallbackUserdata userdata) = 0;
         virtual void OnBuilderSetErrorCallback(nxtBufferBuilder builder, nxtBuilderErrorCallback callback, nxtCallbackUserdata userdata1, nxtCallbackUserdata userdata2) = 0;
         virtual void OnBufferMapReadAsyncCallback(nxtBuffer buffer, uint32_t start, uint32_t size, nxtBufferMapReadCallback callback, nxtCallbackUserdata userdata) = 0;
+        virtual void OnDeviceMapReadRangesAsyncCallback(nxtDevice device, uint32_t count, nxtBuffer const * buffers, uint32_t const * starts, uint32_t const * sizes, nxtCallbackUserdata userdata) = 0;
+        virtual void OnFenceOnCompletionCallback(nxtFence fence, uint64_t value, nxtCallbackUserdata userdata) = 0;
 
         // Calls the stored callbacks
         void CallDeviceErrorCallback(nxtDevice device, const char* message);
         void CallBuilderErrorCallback(void* builder , nxtBuilderErrorStatus status, const char* message);
         void CallMapReadCallback(nxtBuffer buffer, nxtBufferMapReadStatus status, const void* data);
+        void CallMapReadRangesCallback(nxtDevice device, nxtBufferMapReadStatus status, uint32_t count, const void* const* data);
+        void CallFenceOnCompletionCallback(nxtFence fence, nxtFenceCompletionStatus status);
 
         struct Object {
             ProcTableAsClass* procs = nullptr;
             nxtDeviceErrorCallback deviceErrorCallback = nullptr;
             nxtBuilderErrorCallback builderErrorCallback = nullptr;
             nxtBufferMapReadCallback mapReadCallback = nullptr;
+            nxtBufferMapReadRangesCallback mapReadRangesCallback = nullptr;
+            nxtCallbackUserdata mapReadRangesUserdata = 0;
+            nxtFenceOnCompletionCallback fenceOnCompletionCallback = nullptr;
             nxtCallbackUserdata userdata1 = 0;
             nxtCallbackUserdata userdata2 = 0;
         };
@@ -85,6 +98,8 @@ class ProcTableAsClass {
 
 class MockProcTable : public ProcTableAsClass {
     public:
+        MockProcTable();
+
         {% for type in by_category["object"] %}
             {% for method in type.methods if len(method.arguments) < 10 %}
                 MOCK_METHOD{{len(method.arguments) + 1}}(
@@ -104,6 +119,11 @@ class MockProcTable : public ProcTableAsClass {
         MOCK_METHOD3(OnDeviceSetErrorCallback, void(nxtDevice device, nxtDeviceErrorCallback callback, nxtCallbackUserdata userdata));
         MOCK_METHOD4(OnBuilderSetErrorCallback, void(nxtBufferBuilder builder, nxtBuilderErrorCallback callback, nxtCallbackUserdata userdata1, nxtCallbackUserdata userdata2));
         MOCK_METHOD5(OnBufferMapReadAsyncCallback, void(nxtBuffer buffer, uint32_t start, uint32_t size, nxtBufferMapReadCallback callback, nxtCallbackUserdata userdata));
+        MOCK_METHOD6(OnDeviceMapReadRangesAsyncCallback, void(nxtDevice device, uint32_t count, nxtBuffer const * buffers, uint32_t const * starts, uint32_t const * sizes, nxtCallbackUserdata userdata));
+        MOCK_METHOD3(OnFenceOnCompletionCallback, void(nxtFence fence, uint64_t value, nxtCallbackUserdata userdata));
+
+        MOCK_METHOD1(DeviceGetCompletionFd, int32_t(nxtDevice device));
+        MOCK_METHOD1(FenceGetCompletedValue, uint64_t(nxtFence fence));
 };
 
 #endif // MOCK_NXT_H
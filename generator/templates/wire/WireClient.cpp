@@ -12,13 +12,17 @@
 //* See the License for the specific language governing permissions and
 //* limitations under the License.
 
+#include "wire/BulkDataChannel.h"
+#include "wire/ObjectSlabs.h"
 #include "wire/Wire.h"
 #include "wire/WireCmd.h"
 
 #include "common/Assert.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cstdlib>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -48,6 +52,9 @@ namespace wire {
             nxtCallbackUserdata userdata1 = 0;
             nxtCallbackUserdata userdata2 = 0;
             bool canCall = true;
+            //* Set when the client found the error itself and already called the callback, the
+            //* status the server sends later is ignored.
+            bool calledByClient = false;
         };
 
         //* All non-Device objects of the client side have:
@@ -69,13 +76,32 @@ namespace wire {
         {% set special_objects = [
             "device",
             "buffer",
+            "fence",
+            "fence builder",
         ] %}
+        //* Builders track their status on the client so that calls the server would reject can be
+        //* dropped before they are sent.
+        struct BuilderBase : ObjectBase {
+            using ObjectBase::ObjectBase;
+
+            void HandleError(const char* message) {
+                gotError = true;
+                errorMessage = message;
+            }
+
+            bool consumed = false;
+            bool gotError = false;
+            std::string errorMessage;
+        };
+
         {% for type in by_category["object"] if not type.name.canonical_case() in special_objects %}
-            struct {{type.name.CamelCase()}} : ObjectBase {
-                using ObjectBase::ObjectBase;
+            struct {{type.name.CamelCase()}} : {{"BuilderBase" if type.is_builder else "ObjectBase"}} {
+                using {{"BuilderBase" if type.is_builder else "ObjectBase"}}::{{"BuilderBase" if type.is_builder else "ObjectBase"}};
             };
         {% endfor %}
 
+        void CancelMapReadRangesRequests(Device* device, uint32_t bufferId);
+
         struct Buffer : ObjectBase {
             using ObjectBase::ObjectBase;
 
@@ -83,12 +109,12 @@ namespace wire {
                 //* Callbacks need to be fired in all cases, as they can handle freeing resources
                 //* so we call them with "Unknown" status.
                 ClearMapRequests(NXT_BUFFER_MAP_READ_STATUS_UNKNOWN);
-
-                if (mappedData) {
-                    free(mappedData);
-                }
+                CancelMapReadRangesRequests(device, id);
+                ClearMappedData();
             }
 
+            void ClearMappedData();
+
             void ClearMapRequests(nxtBufferMapReadStatus status) {
                 for (auto& it : readRequests) {
                     it.second.callback(status, nullptr, it.second.userdata);
@@ -109,6 +135,56 @@ namespace wire {
 
             //* Only one mapped pointer can be active at a time because Unmap clears all the in-flight requests.
             void* mappedData = nullptr;
+            //* When not 0, mappedData points in the bulk data channel instead of being malloc'ed.
+            uint32_t mappedBulkDataSerial = 0;
+        };
+
+        //* Fences track their signaled and completed values on the client so that they can be
+        //* queried synchronously. The server sends the completed values as the GPU reaches them.
+        struct Fence : ObjectBase {
+            using ObjectBase::ObjectBase;
+
+            ~Fence() {
+                //* Callbacks need to be fired in all cases, as they can handle freeing resources
+                //* so we call them with "Unknown" status.
+                auto pendingRequests = std::move(requests);
+                requests.clear();
+                for (auto& it : pendingRequests) {
+                    it.second.callback(NXT_FENCE_COMPLETION_STATUS_UNKNOWN, it.second.userdata);
+                }
+            }
+
+            void SetCompletedValue(uint64_t value) {
+                completedValue = value;
+
+                //* The ready requests are removed before being called so that callbacks can add
+                //* requests on this fence.
+                std::vector<OnCompletionData> readyRequests;
+                auto end = requests.upper_bound(value);
+                for (auto it = requests.begin(); it != end; ++it) {
+                    readyRequests.push_back(it->second);
+                }
+                requests.erase(requests.begin(), end);
+
+                for (const auto& request : readyRequests) {
+                    request.callback(NXT_FENCE_COMPLETION_STATUS_SUCCESS, request.userdata);
+                }
+            }
+
+            struct OnCompletionData {
+                nxtFenceOnCompletionCallback callback = nullptr;
+                nxtCallbackUserdata userdata = 0;
+            };
+            //* The requests indexed by the value they wait on.
+            std::multimap<uint64_t, OnCompletionData> requests;
+            uint64_t signaledValue = 0;
+            uint64_t completedValue = 0;
+        };
+
+        struct FenceBuilder : BuilderBase {
+            using BuilderBase::BuilderBase;
+
+            uint64_t initialValue = 0;
         };
 
         //* TODO(cwallez@chromium.org): Do something with objects before they are destroyed ?
@@ -117,71 +193,56 @@ namespace wire {
         class ObjectAllocator {
             public:
                 struct ObjectAndSerial {
-                    ObjectAndSerial(std::unique_ptr<T> object, uint32_t serial)
-                        : object(std::move(object)), serial(serial) {
-                    }
-                    std::unique_ptr<T> object;
+                    T* object;
                     uint32_t serial;
                 };
 
                 ObjectAllocator(Device* device) : mDevice(device) {
-                    // ID 0 is nullptr
-                    mObjects.emplace_back(nullptr, 0);
                 }
 
-                ObjectAndSerial* New() {
+                ObjectAndSerial New() {
                     uint32_t id = GetNewId();
-                    T* result = new T(mDevice, 1, id);
-                    auto object = std::unique_ptr<T>(result);
-
-                    if (id >= mObjects.size()) {
-                        ASSERT(id == mObjects.size());
-                        mObjects.emplace_back(std::move(object), 0);
-                    } else {
-                        ASSERT(mObjects[id].object == nullptr);
-                        //* TODO(cwallez@chromium.org): investigate if overflows could cause bad things to happen
-                        mObjects[id].serial++;
-                        mObjects[id].object = std::move(object);
-                    }
-
-                    return &mObjects[id];
+                    //* TODO(cwallez@chromium.org): investigate if overflows could cause bad things to happen
+                    uint32_t serial = mObjects.GetGeneration(id);
+                    return {mObjects.Construct(id, mDevice, 1, id), serial};
                 }
                 void Free(T* obj) {
-                    FreeId(obj->id);
-                    mObjects[obj->id].object = nullptr;
+                    uint32_t id = obj->id;
+                    mObjects.Destroy(id);
+                    FreeId(id);
                 }
 
                 T* GetObject(uint32_t id) {
-                    if (id >= mObjects.size()) {
-                        return nullptr;
-                    }
-                    return mObjects[id].object.get();
+                    return mObjects.Get(id);
                 }
 
                 uint32_t GetSerial(uint32_t id) {
-                    if (id >= mObjects.size()) {
-                        return 0;
-                    }
-                    return mObjects[id].serial;
+                    return mObjects.GetGeneration(id);
                 }
 
             private:
+                //* The lowest free ID is reused first so that the server's object tables stay as
+                //* small as the peak number of live objects, and recently used entries stay dense.
                 uint32_t GetNewId() {
                     if (mFreeIds.empty()) {
                         return mCurrentId ++;
                     }
+                    std::pop_heap(mFreeIds.begin(), mFreeIds.end(), std::greater<uint32_t>());
                     uint32_t id = mFreeIds.back();
                     mFreeIds.pop_back();
                     return id;
                 }
                 void FreeId(uint32_t id) {
                     mFreeIds.push_back(id);
+                    std::push_heap(mFreeIds.begin(), mFreeIds.end(), std::greater<uint32_t>());
                 }
 
                 // 0 is an ID reserved to represent nullptr
                 uint32_t mCurrentId = 1;
+                //* A min-heap of the IDs that can be reused.
                 std::vector<uint32_t> mFreeIds;
-                std::vector<ObjectAndSerial> mObjects;
+                //* ID 0 is never constructed so it stays nullptr.
+                ObjectSlabs<T> mObjects;
                 Device* mDevice;
         };
 
@@ -189,8 +250,9 @@ namespace wire {
         //* and the object id allocators.
         class Device : public ObjectBase {
             public:
-                Device(CommandSerializer* serializer)
+                Device(CommandSerializer* serializer, BulkDataChannel* bulkData)
                     : ObjectBase(this, 1, 1),
+                    bulkData(bulkData),
                     {% for type in by_category["object"] if not type.name.canonical_case() == "device" %}
                         {{type.name.camelCase()}}(this),
                     {% endfor %}
@@ -201,6 +263,21 @@ namespace wire {
                     return mSerializer->GetCmdSpace(size);
                 }
 
+                //* MapReadRangesAsync requests are on the device because they can span multiple
+                //* buffers. They are declared before the object allocators so that buffers
+                //* destroyed with the device can still cancel them.
+                struct MapReadRangesRequestData {
+                    nxtBufferMapReadRangesCallback callback = nullptr;
+                    nxtCallbackUserdata userdata = 0;
+                    std::vector<uint32_t> bufferIds;
+                    std::vector<uint32_t> bufferSerials;
+                    std::vector<uint32_t> sizes;
+                };
+                std::map<uint32_t, MapReadRangesRequestData> mapReadRangesRequests;
+                uint32_t mapReadRangesRequestSerial = 0;
+
+                BulkDataChannel* bulkData = nullptr;
+
                 {% for type in by_category["object"] if not type.name.canonical_case() == "device" %}
                     ObjectAllocator<{{type.name.CamelCase()}}> {{type.name.camelCase()}};
                 {% endfor %}
@@ -218,6 +295,28 @@ namespace wire {
                CommandSerializer* mSerializer = nullptr;
         };
 
+        //* Helper functions to check the value of enums, the same as the ones of the backends.
+        {% for type in by_category["enum"] %}
+            {% set cType = as_cType(type.name) %}
+            bool CheckEnum{{cType}}({{cType}} value) {
+                switch (value) {
+                    {% for value in type.values %}
+                        case {{as_cEnum(type.name, value.name)}}:
+                            return true;
+                    {% endfor %}
+                    default:
+                        return false;
+                }
+            }
+        {% endfor %}
+
+        {% for type in by_category["bitmask"] %}
+            {% set cType = as_cType(type.name) %}
+            bool CheckBitmask{{cType}}({{cType}} value) {
+                return (value & ~{{type.full_mask}}) == 0;
+            }
+        {% endfor %}
+
         //* Implementation of the client API functions.
         {% for type in by_category["object"] %}
             {% set Type = type.name.CamelCase() %}
@@ -232,6 +331,39 @@ namespace wire {
                     {%- endfor -%}
                 ) {
                     Device* device = self->device;
+                    {% set returns_object = method.return_type.category == "object" %}
+
+                    //* Do the checks of the generated backend validation here so that calls the
+                    //* server would reject aren't sent. Errors are reported like the server would.
+                    {% if type.is_builder and returns_object %}
+                        //* GetResult must be sent so the server knows the ID of the result, but it
+                        //* makes the builder an error first so that the result is an error object.
+                        bool valid = !self->consumed && !self->gotError;
+                        if (!valid) {
+                            device->HandleError("Builder cannot be used after GetResult");
+
+                            wire::{{as_MethodSuffix(type.name, Name("inject error"))}}Cmd errorCmd;
+                            errorCmd.self = self->id;
+                            auto allocErrorCmd = reinterpret_cast<decltype(errorCmd)*>(device->GetCmdSpace(errorCmd.GetRequiredSize()));
+                            *allocErrorCmd = errorCmd;
+                        }
+                    {% elif type.is_builder %}
+                        if (self->consumed || self->gotError) {
+                            device->HandleError("Builder cannot be used after GetResult");
+                            return;
+                        }
+                    {% endif %}
+                    {% for arg in method.arguments if arg.type.category in ["enum", "bitmask"] %}
+                        if (!Check{{"Enum" if arg.type.category == "enum" else "Bitmask"}}{{as_cType(arg.type.name)}}({{as_varName(arg.name)}})) {
+                            {% if type.is_builder %}
+                                self->HandleError("Bad value in {{Suffix}}");
+                            {% else %}
+                                device->HandleError("Bad value in {{Suffix}}");
+                            {% endif %}
+                            return;
+                        }
+                    {% endfor %}
+
                     wire::{{Suffix}}Cmd cmd;
 
                     //* Create the structure going on the wire on the stack and fill it with the value
@@ -276,19 +408,31 @@ namespace wire {
 
                     //* For object creation, store the object ID the client will use for the result.
                     {% if method.return_type.category == "object" %}
-                        auto* allocation = self->device->{{method.return_type.name.camelCase()}}.New();
+                        auto allocation = self->device->{{method.return_type.name.camelCase()}}.New();
 
                         {% if type.is_builder %}
                             //* We are in GetResult, so the callback that should be called is the
                             //* currently set one. Copy it over to the created object and prevent the
                             //* builder from calling the callback on destruction.
-                            allocation->object->builderCallback = self->builderCallback;
+                            allocation.object->builderCallback = self->builderCallback;
                             self->builderCallback.canCall = false;
+
+                            //* Call the callback of builders with errors found by the client now,
+                            //* with the error message instead of the one the server will send.
+                            if (!valid) {
+                                BuilderCallbackData* callback = &allocation.object->builderCallback;
+                                if (self->gotError && !self->consumed && !callback->Call(NXT_BUILDER_ERROR_STATUS_ERROR, self->errorMessage.c_str())) {
+                                    device->HandleError(("Unhandled builder error: " + self->errorMessage).c_str());
+                                }
+                                callback->canCall = false;
+                                callback->calledByClient = true;
+                            }
+                            self->consumed = true;
                         {% endif %}
 
-                        allocCmd->resultId = allocation->object->id;
-                        allocCmd->resultSerial = allocation->serial;
-                        return allocation->object.get();
+                        allocCmd->resultId = allocation.object->id;
+                        allocCmd->resultSerial = allocation.serial;
+                        return allocation.object;
                     {% endif %}
                 }
             {% endfor %}
@@ -352,6 +496,89 @@ namespace wire {
             *allocCmd = cmd;
         }
 
+        void ClientDeviceMapReadRangesAsync(Device* self, uint32_t count, Buffer* const* buffers, const uint32_t* starts, const uint32_t* sizes, nxtBufferMapReadRangesCallback callback, nxtCallbackUserdata userdata) {
+            uint32_t serial = self->mapReadRangesRequestSerial++;
+            ASSERT(self->mapReadRangesRequests.find(serial) == self->mapReadRangesRequests.end());
+
+            Device::MapReadRangesRequestData request;
+            request.callback = callback;
+            request.userdata = userdata;
+            for (uint32_t i = 0; i < count; ++i) {
+                request.bufferIds.push_back(buffers[i]->id);
+                request.bufferSerials.push_back(self->buffer.GetSerial(buffers[i]->id));
+                request.sizes.push_back(sizes[i]);
+            }
+            self->mapReadRangesRequests[serial] = std::move(request);
+
+            wire::DeviceMapReadRangesAsyncCmd cmd;
+            cmd.requestSerial = serial;
+            cmd.rangeCount = count;
+
+            size_t requiredSize = cmd.GetRequiredSize();
+            auto allocCmd = reinterpret_cast<decltype(cmd)*>(self->GetCmdSpace(requiredSize));
+            *allocCmd = cmd;
+
+            MapReadRange* ranges = allocCmd->GetRanges();
+            for (uint32_t i = 0; i < count; ++i) {
+                ranges[i].bufferId = buffers[i]->id;
+                ranges[i].start = starts[i];
+                ranges[i].size = sizes[i];
+            }
+        }
+
+        //* Unmapping or destroying one of the buffers makes the whole request fail, for the same
+        //* reason Unmap clears the single buffer requests.
+        void CancelMapReadRangesRequests(Device* device, uint32_t bufferId) {
+            auto& requests = device->mapReadRangesRequests;
+            for (auto it = requests.begin(); it != requests.end();) {
+                const auto& ids = it->second.bufferIds;
+                if (std::find(ids.begin(), ids.end(), bufferId) == ids.end()) {
+                    it++;
+                    continue;
+                }
+
+                auto request = std::move(it->second);
+                it = requests.erase(it);
+                request.callback(NXT_BUFFER_MAP_READ_STATUS_UNKNOWN, static_cast<uint32_t>(request.sizes.size()), nullptr, request.userdata);
+            }
+        }
+
+        void Buffer::ClearMappedData() {
+            if (mappedBulkDataSerial != 0) {
+                device->bulkData->Release(mappedBulkDataSerial);
+                mappedBulkDataSerial = 0;
+            } else if (mappedData) {
+                free(mappedData);
+            }
+            mappedData = nullptr;
+        }
+
+        void ProxyClientBufferSetSubData(Buffer* buffer, uint32_t start, uint32_t count, const uint32_t* data) {
+            //* Large uploads are copied in the bulk data channel when it has space left, instead of
+            //* in the command stream.
+            size_t dataSize = size_t(count) * sizeof(uint32_t);
+            BulkDataChannel* bulkData = buffer->device->bulkData;
+            if (dataSize >= BulkDataChannel::kMinBulkDataSize && bulkData != nullptr) {
+                wire::BufferSetSubDataBulkCmd cmd;
+                uint8_t* destination = bulkData->Allocate(dataSize, &cmd.dataSerial, &cmd.dataOffset);
+
+                if (destination != nullptr) {
+                    memcpy(destination, data, dataSize);
+
+                    cmd.bufferId = buffer->id;
+                    cmd.start = start;
+                    cmd.count = count;
+
+                    size_t requiredSize = cmd.GetRequiredSize();
+                    auto allocCmd = reinterpret_cast<decltype(cmd)*>(buffer->device->GetCmdSpace(requiredSize));
+                    *allocCmd = cmd;
+                    return;
+                }
+            }
+
+            ClientBufferSetSubData(buffer, start, count, data);
+        }
+
         void ProxyClientBufferUnmap(Buffer* buffer) {
             //* Invalidate the local pointer, and cancel all other in-flight requests that would turn into
             //* errors anyway (you can't double map). This prevents race when the following happens, where
@@ -360,15 +587,71 @@ namespace wire {
             //*  - Server -> Client: Result of MapRequest1
             //*  - Unmap locally on the client
             //*  - Server -> Client: Result of MapRequest2
-            if (buffer->mappedData) {
-                free(buffer->mappedData);
-                buffer->mappedData = nullptr;
-            }
+            buffer->ClearMappedData();
             buffer->ClearMapRequests(NXT_BUFFER_MAP_READ_STATUS_UNKNOWN);
+            CancelMapReadRangesRequests(buffer->device, buffer->id);
 
             ClientBufferUnmap(buffer);
         }
 
+        Fence* ProxyClientFenceBuilderGetResult(FenceBuilder* builder) {
+            Fence* fence = ClientFenceBuilderGetResult(builder);
+            fence->signaledValue = builder->initialValue;
+            fence->completedValue = builder->initialValue;
+            return fence;
+        }
+
+        void ProxyClientFenceBuilderSetInitialValue(FenceBuilder* builder, uint64_t value) {
+            if (!builder->consumed && !builder->gotError) {
+                builder->initialValue = value;
+            }
+            ClientFenceBuilderSetInitialValue(builder, value);
+        }
+
+        uint64_t ClientFenceGetCompletedValue(Fence* fence) {
+            return fence->completedValue;
+        }
+
+        void ClientFenceOnCompletion(Fence* fence, uint64_t value, nxtFenceOnCompletionCallback callback, nxtCallbackUserdata userdata) {
+            //* The signaled and completed values are known on the client so the requests are
+            //* resolved here, the server only sends the completed values.
+            if (value > fence->signaledValue) {
+                fence->device->HandleError("Fence OnCompletion value greater than the signaled value");
+                callback(NXT_FENCE_COMPLETION_STATUS_ERROR, userdata);
+                return;
+            }
+
+            if (value <= fence->completedValue) {
+                callback(NXT_FENCE_COMPLETION_STATUS_SUCCESS, userdata);
+                return;
+            }
+
+            Fence::OnCompletionData request;
+            request.callback = callback;
+            request.userdata = userdata;
+            fence->requests.emplace(value, request);
+        }
+
+        void ProxyClientQueueSignal(Queue* queue, Fence* fence, uint64_t value) {
+            if (value <= fence->signaledValue) {
+                queue->device->HandleError("Fence value less than or equal to the signaled value");
+                return;
+            }
+            fence->signaledValue = value;
+
+            ClientQueueSignal(queue, fence, value);
+
+            //* Ask the server to tell when the fence reaches the value, so that the completed
+            //* value is updated even if there are no OnCompletion requests.
+            wire::FenceOnCompletionCmd cmd;
+            cmd.fenceId = fence->id;
+            cmd.value = value;
+
+            size_t requiredSize = cmd.GetRequiredSize();
+            auto allocCmd = reinterpret_cast<decltype(cmd)*>(queue->device->GetCmdSpace(requiredSize));
+            *allocCmd = cmd;
+        }
+
         void ClientDeviceReference(Device*) {
         }
 
@@ -380,12 +663,24 @@ namespace wire {
             self->errorUserdata = userdata;
         }
 
+        int32_t ClientDeviceGetCompletionFd(Device*) {
+            //* The client's callbacks are called when it handles the return commands, so it is the
+            //* transport that the application should poll. The server polls the device's fd.
+            return -1;
+        }
+
         // Some commands don't have a custom wire format, but need to be handled manually to update
         // some client-side state tracking. For these we have to functions:
         //  - An autogenerated Client{{suffix}} method that sends the command on the wire
         //  - A manual ProxyClient{{suffix}} method that will be inserted in the proctable instead of
         //    the autogenerated one, and that will have to call Client{{suffix}}
-        {% set proxied_commands = ["BufferUnmap"] %}
+        {% set proxied_commands = [
+            "BufferSetSubData",
+            "BufferUnmap",
+            "FenceBuilderGetResult",
+            "FenceBuilderSetInitialValue",
+            "QueueSignal",
+        ] %}
 
         nxtProcTable GetProcs() {
             nxtProcTable table;
@@ -424,6 +719,12 @@ namespace wire {
                             case ReturnWireCmd::BufferMapReadAsyncCallback:
                                 success = HandleBufferMapReadAsyncCallback(&commands, &size);
                                 break;
+                            case ReturnWireCmd::DeviceMapReadRangesAsyncCallback:
+                                success = HandleDeviceMapReadRangesAsyncCallback(&commands, &size);
+                                break;
+                            case ReturnWireCmd::FenceUpdateCompletedValue:
+                                success = HandleFenceUpdateCompletedValue(&commands, &size);
+                                break;
                             default:
                                 success = false;
                         }
@@ -500,6 +801,10 @@ namespace wire {
                             return true;
                         }
 
+                        if (builtObject->builderCallback.calledByClient) {
+                            return true;
+                        }
+
                         bool called = builtObject->builderCallback.Call(static_cast<nxtBuilderErrorStatus>(cmd->status), cmd->GetMessage());
 
                         // Unhandled builder errors are forwarded to the device
@@ -517,17 +822,32 @@ namespace wire {
                         return false;
                     }
 
+                    //* Data in the bulk data channel must be received in order, even for requests
+                    //* that were cancelled in which case it is released right away.
+                    uint8_t* bulkData = nullptr;
+                    if (cmd->bulkDataSerial != 0) {
+                        if (mDevice->bulkData == nullptr || cmd->status != NXT_BUFFER_MAP_READ_STATUS_SUCCESS) {
+                            return false;
+                        }
+                        bulkData = mDevice->bulkData->Receive(cmd->bulkDataSerial, cmd->bulkDataOffset, cmd->dataLength);
+                        if (bulkData == nullptr) {
+                            return false;
+                        }
+                    }
+
                     auto* buffer = mDevice->buffer.GetObject(cmd->bufferId);
                     uint32_t bufferSerial = mDevice->buffer.GetSerial(cmd->bufferId);
 
                     //* The buffer might have been deleted or recreated so this isn't an error.
                     if (buffer == nullptr || bufferSerial != cmd->bufferSerial) {
+                        ReleaseBulkData(cmd->bulkDataSerial);
                         return true;
                     }
 
                     //* The requests can have been deleted via an Unmap so this isn't an error.
                     auto requestIt = buffer->readRequests.find(cmd->requestSerial);
                     if (requestIt == buffer->readRequests.end()) {
+                        ReleaseBulkData(cmd->bulkDataSerial);
                         return true;
                     }
 
@@ -539,14 +859,24 @@ namespace wire {
                         //* The server didn't send the right amount of data, this is an error and could cause
                         //* the application to crash if we did call the callback.
                         if (request.size != cmd->dataLength) {
+                            ReleaseBulkData(cmd->bulkDataSerial);
                             return false;
                         }
 
                         if (buffer->mappedData != nullptr) {
+                            ReleaseBulkData(cmd->bulkDataSerial);
                             return false;
                         }
-                        buffer->mappedData = malloc(request.size);
-                        memcpy(buffer->mappedData, cmd->GetData(), request.size);
+
+                        //* Data in the bulk data channel stays valid until it is released so it
+                        //* is used directly until the buffer is unmapped.
+                        if (bulkData != nullptr) {
+                            buffer->mappedData = bulkData;
+                            buffer->mappedBulkDataSerial = cmd->bulkDataSerial;
+                        } else {
+                            buffer->mappedData = malloc(request.size);
+                            memcpy(buffer->mappedData, cmd->GetData(), request.size);
+                        }
 
                         request.callback(static_cast<nxtBufferMapReadStatus>(cmd->status), buffer->mappedData, request.userdata);
                     } else {
@@ -556,12 +886,114 @@ namespace wire {
                     buffer->readRequests.erase(requestIt);
                     return true;
                 }
+
+                void ReleaseBulkData(uint32_t serial) {
+                    if (serial != 0) {
+                        mDevice->bulkData->Release(serial);
+                    }
+                }
+
+                bool HandleDeviceMapReadRangesAsyncCallback(const uint8_t** commands, size_t* size) {
+                    const auto* cmd = GetCommand<ReturnDeviceMapReadRangesAsyncCallbackCmd>(commands, size);
+                    if (cmd == nullptr) {
+                        return false;
+                    }
+
+                    //* The request can have been cancelled by an Unmap so this isn't an error.
+                    auto requestIt = mDevice->mapReadRangesRequests.find(cmd->requestSerial);
+                    if (requestIt == mDevice->mapReadRangesRequests.end()) {
+                        return true;
+                    }
+
+                    auto request = std::move(requestIt->second);
+                    mDevice->mapReadRangesRequests.erase(requestIt);
+                    uint32_t count = static_cast<uint32_t>(request.sizes.size());
+
+                    if (cmd->status != NXT_BUFFER_MAP_READ_STATUS_SUCCESS) {
+                        request.callback(static_cast<nxtBufferMapReadStatus>(cmd->status), count, nullptr, request.userdata);
+                        return true;
+                    }
+
+                    //* Gather how much data goes to each buffer, the ranges are sent one after the
+                    //* other so they can be scattered in each buffer's mappedData.
+                    std::map<Buffer*, size_t> bufferSizes;
+                    size_t totalSize = 0;
+                    for (uint32_t i = 0; i < count; ++i) {
+                        auto* buffer = mDevice->buffer.GetObject(request.bufferIds[i]);
+                        uint32_t bufferSerial = mDevice->buffer.GetSerial(request.bufferIds[i]);
+
+                        //* A buffer was destroyed and the request cancelled, or recreated with the
+                        //* same ID, the server would have sent an error otherwise.
+                        if (buffer == nullptr || bufferSerial != request.bufferSerials[i]) {
+                            return false;
+                        }
+                        if (buffer->mappedData != nullptr) {
+                            return false;
+                        }
+
+                        bufferSizes[buffer] += request.sizes[i];
+                        totalSize += request.sizes[i];
+                    }
+
+                    //* The server didn't send the right amount of data, this is an error and could cause
+                    //* the application to crash if we did call the callback.
+                    if (totalSize != cmd->dataLength) {
+                        return false;
+                    }
+
+                    std::map<Buffer*, size_t> bufferOffsets;
+                    for (const auto& it : bufferSizes) {
+                        it.first->mappedData = malloc(it.second);
+                        bufferOffsets[it.first] = 0;
+                    }
+
+                    std::vector<const void*> pointers(count);
+                    const uint8_t* data = reinterpret_cast<const uint8_t*>(cmd->GetData());
+                    for (uint32_t i = 0; i < count; ++i) {
+                        auto* buffer = mDevice->buffer.GetObject(request.bufferIds[i]);
+                        uint8_t* destination = reinterpret_cast<uint8_t*>(buffer->mappedData) + bufferOffsets[buffer];
+
+                        memcpy(destination, data, request.sizes[i]);
+                        pointers[i] = destination;
+
+                        data += request.sizes[i];
+                        bufferOffsets[buffer] += request.sizes[i];
+                    }
+
+                    request.callback(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, count, pointers.data(), request.userdata);
+                    return true;
+                }
+
+                bool HandleFenceUpdateCompletedValue(const uint8_t** commands, size_t* size) {
+                    const auto* cmd = GetCommand<ReturnFenceUpdateCompletedValueCmd>(commands, size);
+                    if (cmd == nullptr) {
+                        return false;
+                    }
+
+                    auto* fence = mDevice->fence.GetObject(cmd->fenceId);
+                    uint32_t fenceSerial = mDevice->fence.GetSerial(cmd->fenceId);
+
+                    //* The fence might have been deleted or recreated so this isn't an error.
+                    if (fence == nullptr || fenceSerial != cmd->fenceSerial) {
+                        return true;
+                    }
+
+                    //* The server can't complete values that weren't signaled.
+                    if (cmd->value > fence->signaledValue) {
+                        return false;
+                    }
+
+                    if (cmd->value > fence->completedValue) {
+                        fence->SetCompletedValue(cmd->value);
+                    }
+                    return true;
+                }
         };
 
     }
 
-    CommandHandler* NewClientDevice(nxtProcTable* procs, nxtDevice* device, CommandSerializer* serializer) {
-        auto clientDevice = new client::Device(serializer);
+    CommandHandler* NewClientDevice(nxtProcTable* procs, nxtDevice* device, CommandSerializer* serializer, BulkDataChannel* bulkData) {
+        auto clientDevice = new client::Device(serializer, bulkData);
 
         *device = reinterpret_cast<nxtDeviceImpl*>(clientDevice);
         *procs = client::GetProcs();
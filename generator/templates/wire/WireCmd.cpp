@@ -21,21 +21,24 @@ namespace wire {
         {% for method in type.methods %}
             {% set Suffix = as_MethodSuffix(type.name, method.name) %}
 
-            size_t {{Suffix}}Cmd::GetRequiredSize() const {
-                size_t result = sizeof(*this);
-
-                {% for arg in method.arguments if arg.annotation != "value" %}
-                    {% if arg.length == "strlen" %}
-                        result += {{as_varName(arg.name)}}Strlen + 1;
-                    {% elif arg.type.category == "object" %}
-                        result += {{as_varName(arg.length.name)}} * sizeof(uint32_t);
-                    {% else %}
-                        result += {{as_varName(arg.length.name)}} * sizeof({{as_cType(arg.type.name)}});
-                    {% endif %}
-                {% endfor %}
+            //* The size of commands of a fixed size is computed inline in the header.
+            {% if not has_fixed_size(method) %}
+                size_t {{Suffix}}Cmd::GetRequiredSize() const {
+                    size_t result = sizeof(*this);
+
+                    {% for arg in method.arguments if arg.annotation != "value" %}
+                        {% if arg.length == "strlen" %}
+                            result += {{as_varName(arg.name)}}Strlen + 1;
+                        {% elif arg.type.category == "object" %}
+                            result += {{as_varName(arg.length.name)}} * sizeof(uint32_t);
+                        {% else %}
+                            result += {{as_varName(arg.length.name)}} * sizeof({{as_cType(arg.type.name)}});
+                        {% endif %}
+                    {% endfor %}
 
-                return result;
-            }
+                    return result;
+                }
+            {% endif %}
 
             {% for const in ["", "const"] %}
                 {% for get_arg in method.arguments if get_arg.annotation != "value" %}
@@ -65,10 +68,6 @@ namespace wire {
             {% endfor %}
         {% endfor %}
 
-        {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
-        size_t {{Suffix}}Cmd::GetRequiredSize() const {
-            return sizeof(*this);
-        }
     {% endfor %}
 
     {% for type in by_category["object"] if type.is_builder %}
@@ -86,5 +85,35 @@ namespace wire {
         }
     {% endfor %}
 
+    const char* GetWireCmdName(WireCmd command) {
+        switch (command) {
+            {% for type in by_category["object"] %}
+                {% for method in type.methods %}
+                    {% set Suffix = as_MethodSuffix(type.name, method.name) %}
+                    case WireCmd::{{Suffix}}:
+                        return "{{Suffix}}";
+                {% endfor %}
+                {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
+                case WireCmd::{{Suffix}}:
+                    return "{{Suffix}}";
+                {% if type.is_builder %}
+                    {% set Suffix = as_MethodSuffix(type.name, Name("inject error")) %}
+                    case WireCmd::{{Suffix}}:
+                        return "{{Suffix}}";
+                {% endif %}
+            {% endfor %}
+            case WireCmd::BufferMapReadAsync:
+                return "BufferMapReadAsync";
+            case WireCmd::BufferSetSubDataBulk:
+                return "BufferSetSubDataBulk";
+            case WireCmd::DeviceMapReadRangesAsync:
+                return "DeviceMapReadRangesAsync";
+            case WireCmd::FenceOnCompletion:
+                return "FenceOnCompletion";
+            default:
+                return "Unknown";
+        }
+    }
+
 }
 }
@@ -27,10 +27,22 @@ namespace wire {
                 {{as_MethodSuffix(type.name, method.name)}},
             {% endfor %}
             {{as_MethodSuffix(type.name, Name("destroy"))}},
+            {% if type.is_builder %}
+                {{as_MethodSuffix(type.name, Name("inject error"))}},
+            {% endif %}
         {% endfor %}
         BufferMapReadAsync,
+        BufferSetSubDataBulk,
+        DeviceMapReadRangesAsync,
+        FenceOnCompletion,
     };
 
+    //* The number of commands, used to size tables indexed by WireCmd.
+    constexpr uint32_t kWireCmdCount = static_cast<uint32_t>(WireCmd::FenceOnCompletion) + 1;
+
+    //* Returns the name of a command, for tools reporting statistics on the command stream.
+    const char* GetWireCmdName(WireCmd command);
+
     {% for type in by_category["object"] %}
         {% for method in type.methods %}
             {% set Suffix = as_MethodSuffix(type.name, method.name) %}
@@ -71,7 +83,14 @@ namespace wire {
                 //* have been initialized.
 
                 //* Compute how much buffer memory is required to hold the structure and all its arguments.
-                size_t GetRequiredSize() const;
+                //* It is inline for commands of a fixed size so that checking their size is free.
+                {% if has_fixed_size(method) %}
+                    size_t GetRequiredSize() const {
+                        return sizeof(*this);
+                    }
+                {% else %}
+                    size_t GetRequiredSize() const;
+                {% endif %}
 
                 //* Gets the pointer to the start of the buffer containing a non-value parameter.
                 {% for get_arg in method.arguments if get_arg.annotation != "value" %}
@@ -88,9 +107,25 @@ namespace wire {
             WireCmd commandId = WireCmd::{{Suffix}};
             uint32_t objectId;
 
-            size_t GetRequiredSize() const;
+            size_t GetRequiredSize() const {
+                return sizeof(*this);
+            }
         };
 
+        //* The command structure used when the client found an error in a builder call and didn't
+        //* send it, so that the server makes an error object on GetResult.
+        {% if type.is_builder %}
+            {% set Suffix = as_MethodSuffix(type.name, Name("inject error")) %}
+            struct {{Suffix}}Cmd {
+                WireCmd commandId = WireCmd::{{Suffix}};
+                uint32_t self;
+
+                size_t GetRequiredSize() const {
+                    return sizeof(*this);
+                }
+            };
+        {% endif %}
+
     {% endfor %}
 
     //* Enum used as a prefix to each command on the return wire format.
@@ -100,6 +135,8 @@ namespace wire {
                 {{type.name.CamelCase()}}ErrorCallback,
         {% endfor %}
         BufferMapReadAsyncCallback,
+        DeviceMapReadRangesAsyncCallback,
+        FenceUpdateCompletedValue,
     };
 
     {% for type in by_category["object"] if type.is_builder %}
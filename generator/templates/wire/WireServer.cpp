@@ -12,12 +12,16 @@
 //* See the License for the specific language governing permissions and
 //* limitations under the License.
 
+#include "wire/BulkDataChannel.h"
+#include "wire/KnownObjects.h"
 #include "wire/Wire.h"
 #include "wire/WireCmd.h"
 
 #include "common/Assert.h"
 
+#include <array>
 #include <cstring>
+#include <limits>
 #include <vector>
 
 namespace nxt {
@@ -34,110 +38,60 @@ namespace wire {
             uint32_t size;
         };
 
-        //* Stores what the backend knows about the type.
-        template<typename T>
-        struct ObjectDataBase {
-            //* The backend-provided handle and serial to this object.
-            T handle;
-            uint32_t serial = 0;
-
-            //* Built object ID and serial, needed to send to the client along with builder error callbacks
-            //* TODO(cwallez@chromium.org) only have this for builder T
-            uint32_t builtObjectId = 0;
-            uint32_t builtObjectSerial = 0;
-
-            //* Used by the error-propagation mechanism to know if this object is an error.
-            //* TODO(cwallez@chromium.org): this is doubling the memory usage of
-            //* std::vector<ObjectDataBase> consider making it a special marker value in handle instead.
-            bool valid;
-            //* Whether this object has been allocated, used by the KnownObjects queries
-            //* TODO(cwallez@chromium.org): make this an internal bit vector in KnownObjects.
-            bool allocated;
+        struct MapReadRangesUserdata {
+            Server* server;
+            uint32_t requestSerial;
+            std::vector<uint32_t> sizes;
         };
 
-        //* Keeps track of the mapping between client IDs and backend objects.
-        template<typename T>
-        class KnownObjects {
-            public:
-                using Data = ObjectDataBase<T>;
-
-                KnownObjects() {
-                    //* Pre-allocate ID 0 to refer to the null handle.
-                    Data nullObject;
-                    nullObject.handle = nullptr;
-                    nullObject.valid = true;
-                    nullObject.allocated = true;
-                    mKnown.push_back(nullObject);
-                }
-
-                //* Get a backend objects for a given client ID.
-                //* Returns nullptr if the ID hasn't previously been allocated.
-                Data* Get(uint32_t id) {
-                    if (id >= mKnown.size()) {
-                        return nullptr;
-                    }
-
-                    Data* data = &mKnown[id];
-
-                    if (!data->allocated) {
-                        return nullptr;
-                    }
-
-                    return data;
-                }
+        struct FenceCompletionUserdata {
+            Server* server;
+            uint32_t fenceId;
+            uint32_t fenceSerial;
+            uint64_t value;
+        };
 
-                //* Allocates the data for a given ID and returns it.
-                //* Returns nullptr if the ID is already allocated, or too far ahead.
-                //* Invalidates all the Data*
-                Data* Allocate(uint32_t id) {
-                    if (id > mKnown.size()) {
-                        return nullptr;
-                    }
+        void ForwardDeviceErrorToServer(const char* message, nxtCallbackUserdata userdata);
 
-                    Data data;
-                    data.allocated = true;
-                    data.valid = false;
-                    data.handle = nullptr;
+        {% for type in by_category["object"] if type.is_builder%}
+            void Forward{{type.name.CamelCase()}}ToClient(nxtBuilderErrorStatus status, const char* message, nxtCallbackUserdata userdata1, nxtCallbackUserdata userdata2);
+        {% endfor %}
 
-                    if (id >= mKnown.size()) {
-                        mKnown.push_back(data);
-                        return &mKnown.back();
-                    }
+        void ForwardBufferMapReadAsync(nxtBufferMapReadStatus status, const void* ptr, nxtCallbackUserdata userdata);
+        void ForwardDeviceMapReadRangesAsync(nxtBufferMapReadStatus status, uint32_t count, const void* const* ptrs, nxtCallbackUserdata userdata);
+        void ForwardFenceCompletedValue(nxtFenceCompletionStatus status, nxtCallbackUserdata userdata);
 
-                    if (mKnown[id].allocated) {
-                        return nullptr;
+        //* Storage for the handles of an array of objects, that only allocates for long arrays.
+        template <typename T>
+        class HandleArray {
+            public:
+                HandleArray(size_t count) : mData(mInline) {
+                    if (count > kInlineCount) {
+                        mHeap.resize(count);
+                        mData = mHeap.data();
                     }
-
-                    mKnown[id] = data;
-                    return &mKnown[id];
                 }
+                HandleArray(const HandleArray&) = delete;
+                HandleArray& operator=(const HandleArray&) = delete;
 
-                //* Marks an ID as deallocated
-                void Free(uint32_t id) {
-                    ASSERT(id < mKnown.size());
-                    mKnown[id].allocated = false;
+                T* Get() {
+                    return mData;
                 }
 
             private:
-                std::vector<Data> mKnown;
+                static constexpr size_t kInlineCount = 16;
+                T mInline[kInlineCount];
+                std::vector<T> mHeap;
+                T* mData;
         };
 
-        void ForwardDeviceErrorToServer(const char* message, nxtCallbackUserdata userdata);
-
-        {% for type in by_category["object"] if type.is_builder%}
-            void Forward{{type.name.CamelCase()}}ToClient(nxtBuilderErrorStatus status, const char* message, nxtCallbackUserdata userdata1, nxtCallbackUserdata userdata2);
-        {% endfor %}
-
-        void ForwardBufferMapReadAsync(nxtBufferMapReadStatus status, const void* ptr, nxtCallbackUserdata userdata);
-
         class Server : public CommandHandler {
             public:
-                Server(nxtDevice device, const nxtProcTable& procs, CommandSerializer* serializer)
-                    : mProcs(procs), mSerializer(serializer) {
+                Server(nxtDevice device, const nxtProcTable& procs, CommandSerializer* serializer, BulkDataChannel* bulkData)
+                    : mProcs(procs), mSerializer(serializer), mBulkData(bulkData) {
                     //* The client-server knowledge is bootstrapped with device 1.
-                    auto* deviceData = mKnownDevice.Allocate(1);
-                    deviceData->handle = device;
-                    deviceData->valid = true;
+                    mKnownDevice.Allocate(1, 0);
+                    mKnownDevice.SetHandle(1, device);
 
                     auto userdata = static_cast<nxtCallbackUserdata>(reinterpret_cast<intptr_t>(this));
                     procs.deviceSetErrorCallback(device, ForwardDeviceErrorToServer, userdata);
@@ -155,24 +109,23 @@ namespace wire {
                 {% for type in by_category["object"] if type.is_builder%}
                     {% set Type = type.name.CamelCase() %}
                     void On{{Type}}Error(nxtBuilderErrorStatus status, const char* message, uint32_t id, uint32_t serial) {
-                        auto* builder = mKnown{{Type}}.Get(id);
-
-                        if (builder == nullptr || builder->serial != serial) {
+                        if (!mKnown{{Type}}.IsAllocated(id) || mKnown{{Type}}.GetSerial(id) != serial) {
                             return;
                         }
 
                         if (status != NXT_BUILDER_ERROR_STATUS_SUCCESS) {
-                            builder->valid = false;
+                            mKnown{{Type}}.SetValid(id, false);
                         }
 
                         if (status != NXT_BUILDER_ERROR_STATUS_UNKNOWN) {
                             //* Unknown is the only status that can be returned without a call to GetResult
                             //* so we are guaranteed to have created an object.
-                            ASSERT(builder->builtObjectId != 0);
+                            const auto& builtObject = mKnown{{Type}}.GetBuiltObject(id);
+                            ASSERT(builtObject.id != 0);
 
                             Return{{Type}}ErrorCallbackCmd cmd;
-                            cmd.builtObjectId = builder->builtObjectId;
-                            cmd.builtObjectSerial = builder->builtObjectSerial;
+                            cmd.builtObjectId = builtObject.id;
+                            cmd.builtObjectSerial = builtObject.serial;
                             cmd.status = status;
                             cmd.messageStrlen = std::strlen(message);
 
@@ -195,45 +148,64 @@ namespace wire {
                         cmd.dataLength = data->size;
                     }
 
+                    //* Large results go through the bulk data channel when it has space left so
+                    //* they aren't copied in the return commands.
+                    uint8_t* bulkDestination = nullptr;
+                    if (cmd.dataLength >= BulkDataChannel::kMinBulkDataSize && mBulkData != nullptr) {
+                        bulkDestination = mBulkData->Allocate(cmd.dataLength, &cmd.bulkDataSerial, &cmd.bulkDataOffset);
+                    }
+
                     auto allocCmd = reinterpret_cast<ReturnBufferMapReadAsyncCallbackCmd*>(GetCmdSpace(cmd.GetRequiredSize()));
                     *allocCmd = cmd;
 
-                    if (status == NXT_BUFFER_MAP_READ_STATUS_SUCCESS) {
+                    if (bulkDestination != nullptr) {
+                        memcpy(bulkDestination, ptr, data->size);
+                    } else if (status == NXT_BUFFER_MAP_READ_STATUS_SUCCESS) {
                         memcpy(allocCmd->GetData(), ptr, data->size);
                     }
 
                     delete data;
                 }
 
+                void OnMapReadRangesAsyncCallback(nxtBufferMapReadStatus status, const void* const* ptrs, MapReadRangesUserdata* data) {
+                    ReturnDeviceMapReadRangesAsyncCallbackCmd cmd;
+                    cmd.requestSerial = data->requestSerial;
+                    cmd.status = status;
+
+                    cmd.dataLength = 0;
+                    if (status == NXT_BUFFER_MAP_READ_STATUS_SUCCESS) {
+                        for (uint32_t size : data->sizes) {
+                            cmd.dataLength += size;
+                        }
+                    }
+
+                    auto allocCmd = reinterpret_cast<ReturnDeviceMapReadRangesAsyncCallbackCmd*>(GetCmdSpace(cmd.GetRequiredSize()));
+                    *allocCmd = cmd;
+
+                    //* All the ranges are sent in a single command, one after the other.
+                    if (status == NXT_BUFFER_MAP_READ_STATUS_SUCCESS) {
+                        uint8_t* destination = reinterpret_cast<uint8_t*>(allocCmd->GetData());
+                        for (size_t i = 0; i < data->sizes.size(); ++i) {
+                            memcpy(destination, ptrs[i], data->sizes[i]);
+                            destination += data->sizes[i];
+                        }
+                    }
+
+                    delete data;
+                }
+
                 const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
-                    mProcs.deviceTick(mKnownDevice.Get(1)->handle);
+                    mProcs.deviceTick(mKnownDevice.GetHandle(1));
 
                     while (size > sizeof(WireCmd)) {
-                        WireCmd cmdId = *reinterpret_cast<const WireCmd*>(commands);
-
-                        bool success = false;
-                        switch (cmdId) {
-                            {% for type in by_category["object"] %}
-                                {% for method in type.methods %}
-                                    {% set Suffix = as_MethodSuffix(type.name, method.name) %}
-                                    case WireCmd::{{Suffix}}:
-                                        success = Handle{{Suffix}}(&commands, &size);
-                                        break;
-                                {% endfor %}
-                                {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
-                                case WireCmd::{{Suffix}}:
-                                    success = Handle{{Suffix}}(&commands, &size);
-                                    break;
-                            {% endfor %}
-                            case WireCmd::BufferMapReadAsync:
-                                success = HandleBufferMapReadAsync(&commands, &size);
-                                break;
-
-                            default:
-                                success = false;
+                        uint32_t cmdId = static_cast<uint32_t>(*reinterpret_cast<const WireCmd*>(commands));
+                        if (cmdId >= kWireCmdCount) {
+                            return nullptr;
                         }
 
-                        if (!success) {
+                        HandlerFn handler = sHandlers[cmdId];
+                        ASSERT(handler != nullptr);
+                        if (!(this->*handler)(&commands, &size)) {
                             return nullptr;
                         }
                     }
@@ -245,9 +217,32 @@ namespace wire {
                     return commands;
                 }
 
+                void OnFenceCompletedValue(nxtFenceCompletionStatus status, FenceCompletionUserdata* data) {
+                    //* Other statuses mean the fence was destroyed or the request was invalid, the
+                    //* client handles these cases itself.
+                    if (status == NXT_FENCE_COMPLETION_STATUS_SUCCESS) {
+                        ReturnFenceUpdateCompletedValueCmd cmd;
+                        cmd.fenceId = data->fenceId;
+                        cmd.fenceSerial = data->fenceSerial;
+                        cmd.value = data->value;
+
+                        auto allocCmd = reinterpret_cast<ReturnFenceUpdateCompletedValueCmd*>(GetCmdSpace(cmd.GetRequiredSize()));
+                        *allocCmd = cmd;
+                    }
+
+                    delete data;
+                }
+
             private:
+                //* The handlers indexed by WireCmd, so that dispatching a command is a single
+                //* indirect call.
+                using HandlerFn = bool (Server::*)(const uint8_t** commands, size_t* size);
+                using HandlerTable = std::array<HandlerFn, kWireCmdCount>;
+                static const HandlerTable sHandlers;
+
                 nxtProcTable mProcs;
                 CommandSerializer* mSerializer = nullptr;
+                BulkDataChannel* mBulkData = nullptr;
 
                 void* GetCmdSpace(size_t size) {
                     return mSerializer->GetCmdSpace(size);
@@ -255,7 +250,7 @@ namespace wire {
 
                 //* The list of known IDs for each object type.
                 {% for type in by_category["object"] %}
-                    KnownObjects<{{as_cType(type.name)}}> mKnown{{type.name.CamelCase()}};
+                    KnownObjects<{{as_cType(type.name)}}{% if type.is_builder %}, true{% endif %}> mKnown{{type.name.CamelCase()}};
                 {% endfor %}
 
                 //* Helper function for the getting of the command data in command handlers.
@@ -300,13 +295,12 @@ namespace wire {
                             //* Unpack 'self'
                             {% set Type = type.name.CamelCase() %}
                             {{as_cType(type.name)}} self;
-                            auto* selfData = mKnown{{Type}}.Get(cmd->self);
                             {
-                                if (selfData == nullptr) {
+                                bool selfValid;
+                                if (!mKnown{{Type}}.Get(cmd->self, &self, &selfValid)) {
                                     return false;
                                 }
-                                valid = valid && selfData->valid;
-                                self = selfData->handle;
+                                valid = valid && selfValid;
                             }
 
                             //* Unpack value objects from IDs.
@@ -314,12 +308,11 @@ namespace wire {
                                 {% set Type = arg.type.name.CamelCase() %}
                                 {{as_cType(arg.type.name)}} arg_{{as_varName(arg.name)}};
                                 {
-                                    auto* data = mKnown{{Type}}.Get(cmd->{{as_varName(arg.name)}});
-                                    if (data == nullptr) {
+                                    bool argValid;
+                                    if (!mKnown{{Type}}.Get(cmd->{{as_varName(arg.name)}}, &arg_{{as_varName(arg.name)}}, &argValid)) {
                                         return false;
                                     }
-                                    valid = valid && data->valid;
-                                    arg_{{as_varName(arg.name)}} = data->handle;
+                                    valid = valid && argValid;
                                 }
                             {% endfor %}
 
@@ -334,20 +327,18 @@ namespace wire {
                                         return false;
                                     }
                                 {% elif arg.type.category == "object" %}
-                                    //* Unpack arrays of objects.
-                                    //* TODO(cwallez@chromium.org) do not allocate when there are few objects.
-                                    std::vector<{{as_cType(arg.type.name)}}> {{argName}}Storage(cmd->{{as_varName(arg.length.name)}});
-                                    auto {{argName}}Ids = reinterpret_cast<const uint32_t*>(cmd->GetPtr_{{argName}}());
-                                    for (size_t i = 0; i < cmd->{{as_varName(arg.length.name)}}; i++) {
-                                        {% set Type = arg.type.name.CamelCase() %}
-                                        auto* data = mKnown{{Type}}.Get({{argName}}Ids[i]);
-                                        if (data == nullptr) {
+                                    //* Unpack arrays of objects, translating all the IDs at once.
+                                    {% set Type = arg.type.name.CamelCase() %}
+                                    HandleArray<{{as_cType(arg.type.name)}}> {{argName}}Storage(cmd->{{as_varName(arg.length.name)}});
+                                    {
+                                        auto {{argName}}Ids = reinterpret_cast<const uint32_t*>(cmd->GetPtr_{{argName}}());
+                                        bool argValid;
+                                        if (!mKnown{{Type}}.GetMany({{argName}}Ids, cmd->{{as_varName(arg.length.name)}}, {{argName}}Storage.Get(), &argValid)) {
                                             return false;
                                         }
-                                        {{argName}}Storage[i] = data->handle;
-                                        valid = valid && data->valid;
+                                        valid = valid && argValid;
                                     }
-                                    arg_{{argName}} = {{argName}}Storage.data();
+                                    arg_{{argName}} = {{argName}}Storage.Get();
                                 {% else %}
                                     //* For anything else, just get the pointer.
                                     arg_{{argName}} = reinterpret_cast<const {{as_cType(arg.type.name)}}*>(cmd->GetPtr_{{argName}}());
@@ -361,25 +352,22 @@ namespace wire {
                             {% set returns = return_type.name.canonical_case() != "void" %}
                             {% if returns %}
                                 {% set Type = method.return_type.name.CamelCase() %}
-                                auto* resultData = mKnown{{Type}}.Allocate(cmd->resultId);
-                                if (resultData == nullptr) {
+                                if (!mKnown{{Type}}.Allocate(cmd->resultId, cmd->resultSerial)) {
                                     return false;
                                 }
-                                resultData->serial = cmd->resultSerial;
 
                                 {% if type.is_builder %}
-                                    selfData->builtObjectId = cmd->resultId;
-                                    selfData->builtObjectSerial = cmd->resultSerial;
+                                    mKnown{{type.name.CamelCase()}}.SetBuiltObject(cmd->self, cmd->resultId, cmd->resultSerial);
                                 {% endif %}
                             {% endif %}
 
                             //* After the data is allocated, apply the argument error propagation mechanism
                             if (!valid) {
                                 {% if type.is_builder %}
-                                    selfData->valid = false;
+                                    mKnown{{type.name.CamelCase()}}.SetValid(cmd->self, false);
                                     //* If we are in GetResult, fake an error callback
                                     {% if returns %}
-                                        On{{type.name.CamelCase()}}Error(NXT_BUILDER_ERROR_STATUS_ERROR, "Maybe monad", cmd->self, selfData->serial);
+                                        On{{type.name.CamelCase()}}Error(NXT_BUILDER_ERROR_STATUS_ERROR, "Maybe monad", cmd->self, mKnown{{type.name.CamelCase()}}.GetSerial(cmd->self));
                                     {% endif %}
                                 {% endif %}
                                 return true;
@@ -399,15 +387,14 @@ namespace wire {
                             );
 
                             {% if returns %}
-                                resultData->handle = result;
-                                resultData->valid = result != nullptr;
+                                mKnown{{Type}}.SetHandle(cmd->resultId, result);
 
                                 //* builders remember the ID of the object they built so that they can send it
                                 //* in the callback to the client.
                                 {% if return_type.is_builder %}
                                     if (result != nullptr) {
                                         uint64_t userdata1 = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this));
-                                        uint64_t userdata2 = (uint64_t(resultData->serial) << uint64_t(32)) + cmd->resultId;
+                                        uint64_t userdata2 = (uint64_t(cmd->resultSerial) << uint64_t(32)) + cmd->resultId;
                                         mProcs.{{as_varName(return_type.name, Name("set error callback"))}}(result, Forward{{return_type.name.CamelCase()}}ToClient, userdata1, userdata2);
                                     }
                                 {% endif %}
@@ -431,18 +418,38 @@ namespace wire {
                             return false;
                         }
 
-                        auto* data = mKnown{{type.name.CamelCase()}}.Get(cmd->objectId);
-                        if (data == nullptr) {
+                        {{as_cType(type.name)}} handle;
+                        bool valid;
+                        if (!mKnown{{type.name.CamelCase()}}.Get(cmd->objectId, &handle, &valid)) {
                             return false;
                         }
 
-                        if (data->valid) {
-                            mProcs.{{as_varName(type.name, Name("release"))}}(data->handle);
+                        if (valid) {
+                            mProcs.{{as_varName(type.name, Name("release"))}}(handle);
                         }
 
                         mKnown{{type.name.CamelCase()}}.Free(cmd->objectId);
                         return true;
                     }
+
+                    //* The client found an error in a call to the builder and didn't send it. Making
+                    //* the builder an error object makes its GetResult return an error object.
+                    {% if type.is_builder %}
+                        {% set Suffix = as_MethodSuffix(type.name, Name("inject error")) %}
+                        bool Handle{{Suffix}}(const uint8_t** commands, size_t* size) {
+                            const auto* cmd = GetCommand<{{Suffix}}Cmd>(commands, size);
+                            if (cmd == nullptr) {
+                                return false;
+                            }
+
+                            if (cmd->self == 0 || !mKnown{{type.name.CamelCase()}}.IsAllocated(cmd->self)) {
+                                return false;
+                            }
+
+                            mKnown{{type.name.CamelCase()}}.SetValid(cmd->self, false);
+                            return true;
+                        }
+                    {% endif %}
                 {% endfor %}
 
                 bool HandleBufferMapReadAsync(const uint8_t** commands, size_t* size) {
@@ -453,32 +460,159 @@ namespace wire {
                         return false;
                     }
 
-                    auto* buffer = mKnownBuffer.Get(cmd->bufferId);
-                    if (buffer == nullptr) {
+                    nxtBuffer buffer;
+                    bool bufferValid;
+                    if (!mKnownBuffer.Get(cmd->bufferId, &buffer, &bufferValid)) {
                         return false;
                     }
 
                     auto* data = new MapReadUserdata;
                     data->server = this;
                     data->bufferId = cmd->bufferId;
-                    data->bufferSerial = buffer->serial;
+                    data->bufferSerial = mKnownBuffer.GetSerial(cmd->bufferId);
                     data->requestSerial = cmd->requestSerial;
                     data->size = cmd->size;
 
                     auto userdata = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(data));
 
-                    if (!buffer->valid) {
+                    if (!bufferValid) {
                         //* Fake the buffer returning a failure, data will be freed in this call.
                         ForwardBufferMapReadAsync(NXT_BUFFER_MAP_READ_STATUS_ERROR, nullptr, userdata);
                         return true;
                     }
 
-                    mProcs.bufferMapReadAsync(buffer->handle, cmd->start, cmd->size, ForwardBufferMapReadAsync, userdata);
+                    mProcs.bufferMapReadAsync(buffer, cmd->start, cmd->size, ForwardBufferMapReadAsync, userdata);
+
+                    return true;
+                }
+
+                bool HandleBufferSetSubDataBulk(const uint8_t** commands, size_t* size) {
+                    const auto* cmd = GetCommand<BufferSetSubDataBulkCmd>(commands, size);
+                    if (cmd == nullptr || mBulkData == nullptr) {
+                        return false;
+                    }
+
+                    nxtBuffer buffer;
+                    bool bufferValid;
+                    if (!mKnownBuffer.Get(cmd->bufferId, &buffer, &bufferValid)) {
+                        return false;
+                    }
+
+                    uint64_t dataSize = uint64_t(cmd->count) * sizeof(uint32_t);
+                    if (dataSize > std::numeric_limits<uint32_t>::max()) {
+                        return false;
+                    }
+                    uint8_t* data = mBulkData->Receive(cmd->dataSerial, cmd->dataOffset, static_cast<uint32_t>(dataSize));
+                    if (data == nullptr) {
+                        return false;
+                    }
+
+                    //* SetSubData copies the data so the space can be given back to the client right away.
+                    if (bufferValid) {
+                        mProcs.bufferSetSubData(buffer, cmd->start, cmd->count, reinterpret_cast<const uint32_t*>(data));
+                    }
+                    mBulkData->Release(cmd->dataSerial);
+
+                    return true;
+                }
+
+                bool HandleDeviceMapReadRangesAsync(const uint8_t** commands, size_t* size) {
+                    //* Like for BufferMapReadAsync, the request is forwarded to the device with
+                    //* userdata containing what the client will require in the return command.
+                    const auto* cmd = GetCommand<DeviceMapReadRangesAsyncCmd>(commands, size);
+                    if (cmd == nullptr) {
+                        return false;
+                    }
+
+                    auto* data = new MapReadRangesUserdata;
+                    data->server = this;
+                    data->requestSerial = cmd->requestSerial;
+
+                    std::vector<nxtBuffer> buffers(cmd->rangeCount);
+                    std::vector<uint32_t> starts(cmd->rangeCount);
+                    std::vector<uint32_t> sizes(cmd->rangeCount);
+
+                    bool allValid = true;
+                    const MapReadRange* ranges = cmd->GetRanges();
+                    for (uint32_t i = 0; i < cmd->rangeCount; ++i) {
+                        bool bufferValid;
+                        if (!mKnownBuffer.Get(ranges[i].bufferId, &buffers[i], &bufferValid)) {
+                            delete data;
+                            return false;
+                        }
+
+                        allValid = allValid && bufferValid;
+                        starts[i] = ranges[i].start;
+                        sizes[i] = ranges[i].size;
+                    }
+                    data->sizes = sizes;
+
+                    auto userdata = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(data));
+
+                    if (!allValid) {
+                        //* Fake the device returning a failure, data will be freed in this call.
+                        ForwardDeviceMapReadRangesAsync(NXT_BUFFER_MAP_READ_STATUS_ERROR, cmd->rangeCount, nullptr, userdata);
+                        return true;
+                    }
+
+                    mProcs.deviceMapReadRangesAsync(mKnownDevice.GetHandle(1), cmd->rangeCount, buffers.data(), starts.data(), sizes.data(), ForwardDeviceMapReadRangesAsync, userdata);
+
+                    return true;
+                }
+
+                bool HandleFenceOnCompletion(const uint8_t** commands, size_t* size) {
+                    //* The client sends this after each signal so that it learns the completed
+                    //* values of the fence.
+                    const auto* cmd = GetCommand<FenceOnCompletionCmd>(commands, size);
+                    if (cmd == nullptr) {
+                        return false;
+                    }
+
+                    nxtFence fence;
+                    bool fenceValid;
+                    if (!mKnownFence.Get(cmd->fenceId, &fence, &fenceValid)) {
+                        return false;
+                    }
+
+                    //* Error fences never complete.
+                    if (!fenceValid) {
+                        return true;
+                    }
+
+                    auto* data = new FenceCompletionUserdata;
+                    data->server = this;
+                    data->fenceId = cmd->fenceId;
+                    data->fenceSerial = mKnownFence.GetSerial(cmd->fenceId);
+                    data->value = cmd->value;
+
+                    auto userdata = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(data));
+                    mProcs.fenceOnCompletion(fence, cmd->value, ForwardFenceCompletedValue, userdata);
 
                     return true;
                 }
         };
 
+        const Server::HandlerTable Server::sHandlers = []() {
+            HandlerTable table = {};
+            {% for type in by_category["object"] %}
+                {% for method in type.methods %}
+                    {% set Suffix = as_MethodSuffix(type.name, method.name) %}
+                    table[static_cast<size_t>(WireCmd::{{Suffix}})] = &Server::Handle{{Suffix}};
+                {% endfor %}
+                {% set Suffix = as_MethodSuffix(type.name, Name("destroy")) %}
+                table[static_cast<size_t>(WireCmd::{{Suffix}})] = &Server::Handle{{Suffix}};
+                {% if type.is_builder %}
+                    {% set Suffix = as_MethodSuffix(type.name, Name("inject error")) %}
+                    table[static_cast<size_t>(WireCmd::{{Suffix}})] = &Server::Handle{{Suffix}};
+                {% endif %}
+            {% endfor %}
+            table[static_cast<size_t>(WireCmd::BufferMapReadAsync)] = &Server::HandleBufferMapReadAsync;
+            table[static_cast<size_t>(WireCmd::BufferSetSubDataBulk)] = &Server::HandleBufferSetSubDataBulk;
+            table[static_cast<size_t>(WireCmd::DeviceMapReadRangesAsync)] = &Server::HandleDeviceMapReadRangesAsync;
+            table[static_cast<size_t>(WireCmd::FenceOnCompletion)] = &Server::HandleFenceOnCompletion;
+            return table;
+        }();
+
         void ForwardDeviceErrorToServer(const char* message, nxtCallbackUserdata userdata) {
             auto server = reinterpret_cast<Server*>(static_cast<intptr_t>(userdata));
             server->OnDeviceError(message);
@@ -497,10 +631,20 @@ namespace wire {
             auto data = reinterpret_cast<MapReadUserdata*>(static_cast<uintptr_t>(userdata));
             data->server->OnMapReadAsyncCallback(status, ptr, data);
         }
+
+        void ForwardDeviceMapReadRangesAsync(nxtBufferMapReadStatus status, uint32_t, const void* const* ptrs, nxtCallbackUserdata userdata) {
+            auto data = reinterpret_cast<MapReadRangesUserdata*>(static_cast<uintptr_t>(userdata));
+            data->server->OnMapReadRangesAsyncCallback(status, ptrs, data);
+        }
+
+        void ForwardFenceCompletedValue(nxtFenceCompletionStatus status, nxtCallbackUserdata userdata) {
+            auto data = reinterpret_cast<FenceCompletionUserdata*>(static_cast<uintptr_t>(userdata));
+            data->server->OnFenceCompletedValue(status, data);
+        }
     }
 
-    CommandHandler* NewServerCommandHandler(nxtDevice device, const nxtProcTable& procs, CommandSerializer* serializer) {
-        return new server::Server(device, procs, serializer);
+    CommandHandler* NewServerCommandHandler(nxtDevice device, const nxtProcTable& procs, CommandSerializer* serializer, BulkDataChannel* bulkData) {
+        return new server::Server(device, procs, serializer, bulkData);
     }
 
 }
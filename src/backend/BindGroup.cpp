@@ -43,7 +43,8 @@ namespace backend {
         ASSERT(binding < kMaxBindingsPerGroup);
         ASSERT(mLayout->GetBindingInfo().mask[binding]);
         ASSERT(mLayout->GetBindingInfo().types[binding] == nxt::BindingType::UniformBuffer ||
-               mLayout->GetBindingInfo().types[binding] == nxt::BindingType::StorageBuffer);
+               mLayout->GetBindingInfo().types[binding] == nxt::BindingType::StorageBuffer ||
+               IsDynamicBufferBinding(mLayout->GetBindingInfo().types[binding]));
         return reinterpret_cast<BufferViewBase*>(mBindings[binding].Get());
     }
 
@@ -118,10 +119,12 @@ namespace backend {
             nxt::BufferUsageBit requiredBit = nxt::BufferUsageBit::None;
             switch (layoutInfo.types[i]) {
                 case nxt::BindingType::UniformBuffer:
+                case nxt::BindingType::DynamicUniformBuffer:
                     requiredBit = nxt::BufferUsageBit::Uniform;
                     break;
 
                 case nxt::BindingType::StorageBuffer:
+                case nxt::BindingType::DynamicStorageBuffer:
                     requiredBit = nxt::BufferUsageBit::Storage;
                     break;
 
@@ -15,6 +15,7 @@
 #include "backend/BindGroupLayout.h"
 
 #include "backend/Device.h"
+#include "common/BitSetIterator.h"
 
 #include <functional>
 
@@ -79,6 +80,11 @@ namespace backend {
 
     BindGroupLayoutBase::BindGroupLayoutBase(BindGroupLayoutBuilder* builder, bool blueprint)
         : mDevice(builder->mDevice), mBindingInfo(builder->mBindingInfo), mIsBlueprint(blueprint) {
+        for (uint32_t binding : IterateBitSet(mBindingInfo.mask)) {
+            if (IsDynamicBufferBinding(mBindingInfo.types[binding])) {
+                mDynamicBufferCount++;
+            }
+        }
     }
 
     BindGroupLayoutBase::~BindGroupLayoutBase() {
@@ -92,6 +98,26 @@ namespace backend {
         return mBindingInfo;
     }
 
+    uint32_t BindGroupLayoutBase::GetDynamicBufferCount() const {
+        return mDynamicBufferCount;
+    }
+
+    bool IsDynamicBufferBinding(nxt::BindingType type) {
+        return type == nxt::BindingType::DynamicUniformBuffer ||
+               type == nxt::BindingType::DynamicStorageBuffer;
+    }
+
+    nxt::BindingType GetShaderBindingType(nxt::BindingType type) {
+        switch (type) {
+            case nxt::BindingType::DynamicUniformBuffer:
+                return nxt::BindingType::UniformBuffer;
+            case nxt::BindingType::DynamicStorageBuffer:
+                return nxt::BindingType::StorageBuffer;
+            default:
+                return type;
+        }
+    }
+
     // BindGroupLayoutBuilder
 
     BindGroupLayoutBuilder::BindGroupLayoutBuilder(DeviceBase* device) : Builder(device) {
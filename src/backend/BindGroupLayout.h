@@ -39,9 +39,14 @@ namespace backend {
         };
         const LayoutBindingInfo& GetBindingInfo() const;
 
+        // The offsets of the dynamic buffers are given to SetBindGroup in the order of their
+        // bindings.
+        uint32_t GetDynamicBufferCount() const;
+
       private:
         DeviceBase* mDevice;
         LayoutBindingInfo mBindingInfo;
+        uint32_t mDynamicBufferCount = 0;
         bool mIsBlueprint = false;
     };
 
@@ -65,6 +70,12 @@ namespace backend {
         BindGroupLayoutBase::LayoutBindingInfo mBindingInfo;
     };
 
+    bool IsDynamicBufferBinding(nxt::BindingType type);
+
+    // Dynamic buffers are seen as regular buffers by shaders, the dynamic offset is applied when
+    // the bind group is set.
+    nxt::BindingType GetShaderBindingType(nxt::BindingType type);
+
     // Implements the functors necessary for the unordered_set<BGL*>-based cache.
     struct BindGroupLayoutCacheFuncs {
         // The hash function
@@ -84,30 +84,36 @@ namespace backend {
                                   uint32_t size,
                                   nxtBufferMapReadCallback callback,
                                   nxtCallbackUserdata userdata) {
-        if (start + size > GetSize()) {
-            mDevice->HandleError("Buffer map read out of range");
+        if (!ValidateMapRead(start, size)) {
             callback(NXT_BUFFER_MAP_READ_STATUS_ERROR, nullptr, userdata);
             return;
         }
 
+        // TODO(cwallez@chromium.org): what to do on wraparound? Could cause crashes.
+        mMapReadSerial++;
+        mMapReadCallback = callback;
+        mMapReadUserdata = userdata;
+        MapReadAsyncImpl(mMapReadSerial, start, size);
+        mIsMapped = true;
+    }
+
+    bool BufferBase::ValidateMapRead(uint32_t start, uint32_t size) {
+        if (start > GetSize() || size > GetSize() - start) {
+            mDevice->HandleError("Buffer map read out of range");
+            return false;
+        }
+
         if (!(mCurrentUsage & nxt::BufferUsageBit::MapRead)) {
             mDevice->HandleError("Buffer needs the map read usage bit");
-            callback(NXT_BUFFER_MAP_READ_STATUS_ERROR, nullptr, userdata);
-            return;
+            return false;
         }
 
         if (mIsMapped) {
             mDevice->HandleError("Buffer already mapped");
-            callback(NXT_BUFFER_MAP_READ_STATUS_ERROR, nullptr, userdata);
-            return;
+            return false;
         }
 
-        // TODO(cwallez@chromium.org): what to do on wraparound? Could cause crashes.
-        mMapReadSerial++;
-        mMapReadCallback = callback;
-        mMapReadUserdata = userdata;
-        MapReadAsyncImpl(mMapReadSerial, start, size);
-        mIsMapped = true;
+        return true;
     }
 
     void BufferBase::Unmap() {
@@ -134,7 +140,8 @@ namespace backend {
     bool BufferBase::IsUsagePossible(nxt::BufferUsageBit allowedUsage, nxt::BufferUsageBit usage) {
         const nxt::BufferUsageBit allReadBits =
             nxt::BufferUsageBit::MapRead | nxt::BufferUsageBit::TransferSrc |
-            nxt::BufferUsageBit::Index | nxt::BufferUsageBit::Vertex | nxt::BufferUsageBit::Uniform;
+            nxt::BufferUsageBit::Index | nxt::BufferUsageBit::Vertex |
+            nxt::BufferUsageBit::Uniform | nxt::BufferUsageBit::Indirect;
         bool allowed = (usage & allowedUsage) == usage;
         bool readOnly = (usage & allReadBits) == usage;
         bool singleUse = nxt::HasZeroOrOneBits(usage);
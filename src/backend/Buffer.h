@@ -36,6 +36,8 @@ namespace backend {
         bool IsFrozen() const;
         bool HasFrozenUsage(nxt::BufferUsageBit usage) const;
         void UpdateUsageInternal(nxt::BufferUsageBit usage);
+        // Checks a MapReadAsync of the range would succeed, calling HandleError otherwise.
+        bool ValidateMapRead(uint32_t start, uint32_t size);
 
         DeviceBase* GetDevice();
 
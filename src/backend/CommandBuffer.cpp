@@ -22,6 +22,8 @@
 #include "backend/Device.h"
 #include "backend/InputState.h"
 #include "backend/PipelineLayout.h"
+#include "backend/QuerySet.h"
+#include "backend/RenderBundle.h"
 #include "backend/RenderPipeline.h"
 #include "backend/Texture.h"
 
@@ -122,10 +124,40 @@ namespace backend {
             return true;
         }
 
+        bool ValidateQueryRange(CommandBufferBuilder* builder,
+                                const QuerySetBase* querySet,
+                                uint32_t firstQuery,
+                                uint32_t queryCount) {
+            uint32_t count = querySet->GetCount();
+            if (firstQuery > count || queryCount > count - firstQuery) {
+                builder->HandleError("Query index out of range");
+                return false;
+            }
+
+            return true;
+        }
+
+        bool ValidateResolveDestination(CommandBufferBuilder* builder,
+                                        const ResolveQuerySetCmd* cmd) {
+            if (cmd->destinationOffset % sizeof(uint64_t) != 0) {
+                builder->HandleError("Query resolve offset must be a multiple of 8");
+                return false;
+            }
+
+            uint64_t resultsSize = uint64_t(cmd->queryCount) * sizeof(uint64_t);
+            if (uint64_t(cmd->destinationOffset) + resultsSize > cmd->destination->GetSize()) {
+                builder->HandleError("Query resolve would overflow the buffer");
+                return false;
+            }
+
+            return true;
+        }
+
     }  // namespace
 
     CommandBufferBase::CommandBufferBase(CommandBufferBuilder* builder)
         : mDevice(builder->mDevice),
+          mIsReusable(builder->mIsReusable),
           mBuffersTransitioned(std::move(builder->mState->mBuffersTransitioned)),
           mTexturesTransitioned(std::move(builder->mState->mTexturesTransitioned)) {
     }
@@ -150,6 +182,10 @@ namespace backend {
         return mDevice;
     }
 
+    bool CommandBufferBase::IsReusable() const {
+        return mIsReusable;
+    }
+
     void FreeCommands(CommandIterator* commands) {
         Command type;
         while (commands->NextCommandId(&type)) {
@@ -158,6 +194,10 @@ namespace backend {
                     BeginComputePassCmd* begin = commands->NextCommand<BeginComputePassCmd>();
                     begin->~BeginComputePassCmd();
                 } break;
+                case Command::BeginQuery: {
+                    BeginQueryCmd* begin = commands->NextCommand<BeginQueryCmd>();
+                    begin->~BeginQueryCmd();
+                } break;
                 case Command::BeginRenderPass: {
                     BeginRenderPassCmd* begin = commands->NextCommand<BeginRenderPassCmd>();
                     begin->~BeginRenderPassCmd();
@@ -182,18 +222,35 @@ namespace backend {
                     DispatchCmd* dispatch = commands->NextCommand<DispatchCmd>();
                     dispatch->~DispatchCmd();
                 } break;
+                case Command::DispatchIndirect: {
+                    DispatchIndirectCmd* dispatch = commands->NextCommand<DispatchIndirectCmd>();
+                    dispatch->~DispatchIndirectCmd();
+                } break;
                 case Command::DrawArrays: {
                     DrawArraysCmd* draw = commands->NextCommand<DrawArraysCmd>();
                     draw->~DrawArraysCmd();
                 } break;
+                case Command::DrawArraysIndirect: {
+                    DrawArraysIndirectCmd* draw = commands->NextCommand<DrawArraysIndirectCmd>();
+                    draw->~DrawArraysIndirectCmd();
+                } break;
                 case Command::DrawElements: {
                     DrawElementsCmd* draw = commands->NextCommand<DrawElementsCmd>();
                     draw->~DrawElementsCmd();
                 } break;
+                case Command::DrawElementsIndirect: {
+                    DrawElementsIndirectCmd* draw =
+                        commands->NextCommand<DrawElementsIndirectCmd>();
+                    draw->~DrawElementsIndirectCmd();
+                } break;
                 case Command::EndComputePass: {
                     EndComputePassCmd* cmd = commands->NextCommand<EndComputePassCmd>();
                     cmd->~EndComputePassCmd();
                 } break;
+                case Command::EndQuery: {
+                    EndQueryCmd* cmd = commands->NextCommand<EndQueryCmd>();
+                    cmd->~EndQueryCmd();
+                } break;
                 case Command::EndRenderPass: {
                     EndRenderPassCmd* cmd = commands->NextCommand<EndRenderPassCmd>();
                     cmd->~EndRenderPassCmd();
@@ -202,6 +259,28 @@ namespace backend {
                     EndRenderSubpassCmd* cmd = commands->NextCommand<EndRenderSubpassCmd>();
                     cmd->~EndRenderSubpassCmd();
                 } break;
+                case Command::ExecuteBundles: {
+                    ExecuteBundlesCmd* cmd = commands->NextCommand<ExecuteBundlesCmd>();
+                    auto bundles = commands->NextData<Ref<RenderBundleBase>>(cmd->count);
+                    for (size_t i = 0; i < cmd->count; ++i) {
+                        (&bundles[i])->~Ref<RenderBundleBase>();
+                    }
+                    cmd->~ExecuteBundlesCmd();
+                } break;
+                case Command::MultiDrawArrays: {
+                    MultiDrawArraysCmd* cmd = commands->NextCommand<MultiDrawArraysCmd>();
+                    SkipMultiDrawParameters(commands, cmd->drawCount);
+                    cmd->~MultiDrawArraysCmd();
+                } break;
+                case Command::MultiDrawElements: {
+                    MultiDrawElementsCmd* cmd = commands->NextCommand<MultiDrawElementsCmd>();
+                    SkipMultiDrawParameters(commands, cmd->drawCount);
+                    cmd->~MultiDrawElementsCmd();
+                } break;
+                case Command::ResolveQuerySet: {
+                    ResolveQuerySetCmd* cmd = commands->NextCommand<ResolveQuerySetCmd>();
+                    cmd->~ResolveQuerySetCmd();
+                } break;
                 case Command::SetComputePipeline: {
                     SetComputePipelineCmd* cmd = commands->NextCommand<SetComputePipelineCmd>();
                     cmd->~SetComputePipelineCmd();
@@ -225,6 +304,7 @@ namespace backend {
                 } break;
                 case Command::SetBindGroup: {
                     SetBindGroupCmd* cmd = commands->NextCommand<SetBindGroupCmd>();
+                    commands->NextData<uint32_t>(cmd->dynamicOffsetCount);
                     cmd->~SetBindGroupCmd();
                 } break;
                 case Command::SetIndexBuffer: {
@@ -250,17 +330,38 @@ namespace backend {
                         commands->NextCommand<TransitionTextureUsageCmd>();
                     cmd->~TransitionTextureUsageCmd();
                 } break;
+                case Command::WriteTimestamp: {
+                    WriteTimestampCmd* cmd = commands->NextCommand<WriteTimestampCmd>();
+                    cmd->~WriteTimestampCmd();
+                } break;
             }
         }
         commands->DataWasDestroyed();
     }
 
+    void CopyMultiDrawParameters(CommandAllocator* allocator,
+                                 uint32_t drawCount,
+                                 uint32_t const* parameters) {
+        uint32_t* data = allocator->AllocateData<uint32_t>(drawCount);
+        memcpy(data, parameters, drawCount * sizeof(uint32_t));
+    }
+
+    void SkipMultiDrawParameters(CommandIterator* commands, uint32_t drawCount) {
+        for (uint32_t i = 0; i < 4; ++i) {
+            commands->NextData<uint32_t>(drawCount);
+        }
+    }
+
     void SkipCommand(CommandIterator* commands, Command type) {
         switch (type) {
             case Command::BeginComputePass:
                 commands->NextCommand<BeginComputePassCmd>();
                 break;
 
+            case Command::BeginQuery:
+                commands->NextCommand<BeginQueryCmd>();
+                break;
+
             case Command::BeginRenderPass:
                 commands->NextCommand<BeginRenderPassCmd>();
                 break;
@@ -285,18 +386,34 @@ namespace backend {
                 commands->NextCommand<DispatchCmd>();
                 break;
 
+            case Command::DispatchIndirect:
+                commands->NextCommand<DispatchIndirectCmd>();
+                break;
+
             case Command::DrawArrays:
                 commands->NextCommand<DrawArraysCmd>();
                 break;
 
+            case Command::DrawArraysIndirect:
+                commands->NextCommand<DrawArraysIndirectCmd>();
+                break;
+
             case Command::DrawElements:
                 commands->NextCommand<DrawElementsCmd>();
                 break;
 
+            case Command::DrawElementsIndirect:
+                commands->NextCommand<DrawElementsIndirectCmd>();
+                break;
+
             case Command::EndComputePass:
                 commands->NextCommand<EndComputePassCmd>();
                 break;
 
+            case Command::EndQuery:
+                commands->NextCommand<EndQueryCmd>();
+                break;
+
             case Command::EndRenderPass:
                 commands->NextCommand<EndRenderPassCmd>();
                 break;
@@ -305,6 +422,25 @@ namespace backend {
                 commands->NextCommand<EndRenderSubpassCmd>();
                 break;
 
+            case Command::ExecuteBundles: {
+                auto* cmd = commands->NextCommand<ExecuteBundlesCmd>();
+                commands->NextData<Ref<RenderBundleBase>>(cmd->count);
+            } break;
+
+            case Command::MultiDrawArrays: {
+                auto* cmd = commands->NextCommand<MultiDrawArraysCmd>();
+                SkipMultiDrawParameters(commands, cmd->drawCount);
+            } break;
+
+            case Command::MultiDrawElements: {
+                auto* cmd = commands->NextCommand<MultiDrawElementsCmd>();
+                SkipMultiDrawParameters(commands, cmd->drawCount);
+            } break;
+
+            case Command::ResolveQuerySet:
+                commands->NextCommand<ResolveQuerySetCmd>();
+                break;
+
             case Command::SetComputePipeline:
                 commands->NextCommand<SetComputePipelineCmd>();
                 break;
@@ -326,9 +462,10 @@ namespace backend {
                 commands->NextCommand<SetBlendColorCmd>();
                 break;
 
-            case Command::SetBindGroup:
-                commands->NextCommand<SetBindGroupCmd>();
-                break;
+            case Command::SetBindGroup: {
+                auto* cmd = commands->NextCommand<SetBindGroupCmd>();
+                commands->NextData<uint32_t>(cmd->dynamicOffsetCount);
+            } break;
 
             case Command::SetIndexBuffer:
                 commands->NextCommand<SetIndexBufferCmd>();
@@ -347,6 +484,10 @@ namespace backend {
             case Command::TransitionTextureUsage:
                 commands->NextCommand<TransitionTextureUsageCmd>();
                 break;
+
+            case Command::WriteTimestamp:
+                commands->NextCommand<WriteTimestampCmd>();
+                break;
         }
     }
 
@@ -374,6 +515,13 @@ namespace backend {
                     }
                 } break;
 
+                case Command::BeginQuery: {
+                    BeginQueryCmd* cmd = mIterator.NextCommand<BeginQueryCmd>();
+                    if (!mState->BeginQuery(cmd->querySet.Get(), cmd->queryIndex)) {
+                        return false;
+                    }
+                } break;
+
                 case Command::BeginRenderPass: {
                     BeginRenderPassCmd* cmd = mIterator.NextCommand<BeginRenderPassCmd>();
                     auto* renderPass = cmd->renderPass.Get();
@@ -459,6 +607,14 @@ namespace backend {
                     }
                 } break;
 
+                case Command::DispatchIndirect: {
+                    DispatchIndirectCmd* dispatch = mIterator.NextCommand<DispatchIndirectCmd>();
+                    if (!mState->ValidateCanDispatchIndirect(dispatch->indirectBuffer.Get(),
+                                                             dispatch->indirectOffset)) {
+                        return false;
+                    }
+                } break;
+
                 case Command::DrawArrays: {
                     mIterator.NextCommand<DrawArraysCmd>();
                     if (!mState->ValidateCanDrawArrays()) {
@@ -466,6 +622,14 @@ namespace backend {
                     }
                 } break;
 
+                case Command::DrawArraysIndirect: {
+                    DrawArraysIndirectCmd* draw = mIterator.NextCommand<DrawArraysIndirectCmd>();
+                    if (!mState->ValidateCanDrawArraysIndirect(draw->indirectBuffer.Get(),
+                                                               draw->indirectOffset)) {
+                        return false;
+                    }
+                } break;
+
                 case Command::DrawElements: {
                     mIterator.NextCommand<DrawElementsCmd>();
                     if (!mState->ValidateCanDrawElements()) {
@@ -473,6 +637,15 @@ namespace backend {
                     }
                 } break;
 
+                case Command::DrawElementsIndirect: {
+                    DrawElementsIndirectCmd* draw =
+                        mIterator.NextCommand<DrawElementsIndirectCmd>();
+                    if (!mState->ValidateCanDrawElementsIndirect(draw->indirectBuffer.Get(),
+                                                                 draw->indirectOffset)) {
+                        return false;
+                    }
+                } break;
+
                 case Command::EndComputePass: {
                     mIterator.NextCommand<EndComputePassCmd>();
                     if (!mState->EndComputePass()) {
@@ -480,6 +653,13 @@ namespace backend {
                     }
                 } break;
 
+                case Command::EndQuery: {
+                    EndQueryCmd* cmd = mIterator.NextCommand<EndQueryCmd>();
+                    if (!mState->EndQuery(cmd->querySet.Get(), cmd->queryIndex)) {
+                        return false;
+                    }
+                } break;
+
                 case Command::EndRenderPass: {
                     mIterator.NextCommand<EndRenderPassCmd>();
                     if (!mState->EndRenderPass()) {
@@ -494,6 +674,43 @@ namespace backend {
                     }
                 } break;
 
+                case Command::ExecuteBundles: {
+                    ExecuteBundlesCmd* cmd = mIterator.NextCommand<ExecuteBundlesCmd>();
+                    auto bundles = mIterator.NextData<Ref<RenderBundleBase>>(cmd->count);
+                    for (uint32_t i = 0; i < cmd->count; ++i) {
+                        if (!mState->ExecuteBundle(bundles[i].Get())) {
+                            return false;
+                        }
+                    }
+                } break;
+
+                case Command::MultiDrawArrays: {
+                    MultiDrawArraysCmd* cmd = mIterator.NextCommand<MultiDrawArraysCmd>();
+                    SkipMultiDrawParameters(&mIterator, cmd->drawCount);
+                    if (!mState->ValidateCanDrawArrays()) {
+                        return false;
+                    }
+                } break;
+
+                case Command::MultiDrawElements: {
+                    MultiDrawElementsCmd* cmd = mIterator.NextCommand<MultiDrawElementsCmd>();
+                    SkipMultiDrawParameters(&mIterator, cmd->drawCount);
+                    if (!mState->ValidateCanDrawElements()) {
+                        return false;
+                    }
+                } break;
+
+                case Command::ResolveQuerySet: {
+                    ResolveQuerySetCmd* cmd = mIterator.NextCommand<ResolveQuerySetCmd>();
+                    if (!ValidateQueryRange(this, cmd->querySet.Get(), cmd->firstQuery,
+                                            cmd->queryCount) ||
+                        !ValidateResolveDestination(this, cmd) || !mState->ValidateCanCopy() ||
+                        !mState->ValidateCanUseBufferAs(cmd->destination.Get(),
+                                                        nxt::BufferUsageBit::TransferDst)) {
+                        return false;
+                    }
+                } break;
+
                 case Command::SetComputePipeline: {
                     SetComputePipelineCmd* cmd = mIterator.NextCommand<SetComputePipelineCmd>();
                     ComputePipelineBase* pipeline = cmd->pipeline.Get();
@@ -539,14 +756,17 @@ namespace backend {
 
                 case Command::SetBindGroup: {
                     SetBindGroupCmd* cmd = mIterator.NextCommand<SetBindGroupCmd>();
-                    if (!mState->SetBindGroup(cmd->index, cmd->group.Get())) {
+                    uint32_t* dynamicOffsets =
+                        mIterator.NextData<uint32_t>(cmd->dynamicOffsetCount);
+                    if (!mState->SetBindGroup(cmd->index, cmd->group.Get(),
+                                              cmd->dynamicOffsetCount, dynamicOffsets)) {
                         return false;
                     }
                 } break;
 
                 case Command::SetIndexBuffer: {
                     SetIndexBufferCmd* cmd = mIterator.NextCommand<SetIndexBufferCmd>();
-                    if (!mState->SetIndexBuffer(cmd->buffer.Get())) {
+                    if (!mState->SetIndexBuffer(cmd->buffer.Get(), cmd->offset)) {
                         return false;
                     }
                 } break;
@@ -577,6 +797,17 @@ namespace backend {
                     }
 
                 } break;
+
+                case Command::WriteTimestamp: {
+                    WriteTimestampCmd* cmd = mIterator.NextCommand<WriteTimestampCmd>();
+                    if (!ValidateQueryRange(this, cmd->querySet.Get(), cmd->queryIndex, 1)) {
+                        return false;
+                    }
+                    if (cmd->querySet->GetType() != nxt::QueryType::Timestamp) {
+                        HandleError("Timestamps can only be written to timestamp query sets");
+                        return false;
+                    }
+                } break;
             }
         }
 
@@ -602,6 +833,13 @@ namespace backend {
         mAllocator.Allocate<BeginComputePassCmd>(Command::BeginComputePass);
     }
 
+    void CommandBufferBuilder::BeginQuery(QuerySetBase* querySet, uint32_t queryIndex) {
+        BeginQueryCmd* cmd = mAllocator.Allocate<BeginQueryCmd>(Command::BeginQuery);
+        new (cmd) BeginQueryCmd;
+        cmd->querySet = querySet;
+        cmd->queryIndex = queryIndex;
+    }
+
     void CommandBufferBuilder::BeginRenderPass(RenderPassBase* renderPass,
                                                FramebufferBase* framebuffer) {
         BeginRenderPassCmd* cmd = mAllocator.Allocate<BeginRenderPassCmd>(Command::BeginRenderPass);
@@ -697,6 +935,15 @@ namespace backend {
         dispatch->z = z;
     }
 
+    void CommandBufferBuilder::DispatchIndirect(BufferBase* indirectBuffer,
+                                                uint32_t indirectOffset) {
+        DispatchIndirectCmd* dispatch =
+            mAllocator.Allocate<DispatchIndirectCmd>(Command::DispatchIndirect);
+        new (dispatch) DispatchIndirectCmd;
+        dispatch->indirectBuffer = indirectBuffer;
+        dispatch->indirectOffset = indirectOffset;
+    }
+
     void CommandBufferBuilder::DrawArrays(uint32_t vertexCount,
                                           uint32_t instanceCount,
                                           uint32_t firstVertex,
@@ -709,6 +956,15 @@ namespace backend {
         draw->firstInstance = firstInstance;
     }
 
+    void CommandBufferBuilder::DrawArraysIndirect(BufferBase* indirectBuffer,
+                                                  uint32_t indirectOffset) {
+        DrawArraysIndirectCmd* draw =
+            mAllocator.Allocate<DrawArraysIndirectCmd>(Command::DrawArraysIndirect);
+        new (draw) DrawArraysIndirectCmd;
+        draw->indirectBuffer = indirectBuffer;
+        draw->indirectOffset = indirectOffset;
+    }
+
     void CommandBufferBuilder::DrawElements(uint32_t indexCount,
                                             uint32_t instanceCount,
                                             uint32_t firstIndex,
@@ -721,10 +977,26 @@ namespace backend {
         draw->firstInstance = firstInstance;
     }
 
+    void CommandBufferBuilder::DrawElementsIndirect(BufferBase* indirectBuffer,
+                                                    uint32_t indirectOffset) {
+        DrawElementsIndirectCmd* draw =
+            mAllocator.Allocate<DrawElementsIndirectCmd>(Command::DrawElementsIndirect);
+        new (draw) DrawElementsIndirectCmd;
+        draw->indirectBuffer = indirectBuffer;
+        draw->indirectOffset = indirectOffset;
+    }
+
     void CommandBufferBuilder::EndComputePass() {
         mAllocator.Allocate<EndComputePassCmd>(Command::EndComputePass);
     }
 
+    void CommandBufferBuilder::EndQuery(QuerySetBase* querySet, uint32_t queryIndex) {
+        EndQueryCmd* cmd = mAllocator.Allocate<EndQueryCmd>(Command::EndQuery);
+        new (cmd) EndQueryCmd;
+        cmd->querySet = querySet;
+        cmd->queryIndex = queryIndex;
+    }
+
     void CommandBufferBuilder::EndRenderPass() {
         mAllocator.Allocate<EndRenderPassCmd>(Command::EndRenderPass);
     }
@@ -733,6 +1005,62 @@ namespace backend {
         mAllocator.Allocate<EndRenderSubpassCmd>(Command::EndRenderSubpass);
     }
 
+    void CommandBufferBuilder::ExecuteBundles(uint32_t count, RenderBundleBase* const* bundles) {
+        ExecuteBundlesCmd* cmd = mAllocator.Allocate<ExecuteBundlesCmd>(Command::ExecuteBundles);
+        new (cmd) ExecuteBundlesCmd;
+        cmd->count = count;
+
+        Ref<RenderBundleBase>* cmdBundles = mAllocator.AllocateData<Ref<RenderBundleBase>>(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            new (&cmdBundles[i]) Ref<RenderBundleBase>(bundles[i]);
+        }
+    }
+
+    void CommandBufferBuilder::MultiDrawArrays(uint32_t drawCount,
+                                               uint32_t const* vertexCounts,
+                                               uint32_t const* instanceCounts,
+                                               uint32_t const* firstVertices,
+                                               uint32_t const* firstInstances) {
+        MultiDrawArraysCmd* cmd = mAllocator.Allocate<MultiDrawArraysCmd>(Command::MultiDrawArrays);
+        new (cmd) MultiDrawArraysCmd;
+        cmd->drawCount = drawCount;
+
+        CopyMultiDrawParameters(&mAllocator, drawCount, vertexCounts);
+        CopyMultiDrawParameters(&mAllocator, drawCount, instanceCounts);
+        CopyMultiDrawParameters(&mAllocator, drawCount, firstVertices);
+        CopyMultiDrawParameters(&mAllocator, drawCount, firstInstances);
+    }
+
+    void CommandBufferBuilder::MultiDrawElements(uint32_t drawCount,
+                                                 uint32_t const* indexCounts,
+                                                 uint32_t const* instanceCounts,
+                                                 uint32_t const* firstIndices,
+                                                 uint32_t const* firstInstances) {
+        MultiDrawElementsCmd* cmd =
+            mAllocator.Allocate<MultiDrawElementsCmd>(Command::MultiDrawElements);
+        new (cmd) MultiDrawElementsCmd;
+        cmd->drawCount = drawCount;
+
+        CopyMultiDrawParameters(&mAllocator, drawCount, indexCounts);
+        CopyMultiDrawParameters(&mAllocator, drawCount, instanceCounts);
+        CopyMultiDrawParameters(&mAllocator, drawCount, firstIndices);
+        CopyMultiDrawParameters(&mAllocator, drawCount, firstInstances);
+    }
+
+    void CommandBufferBuilder::ResolveQuerySet(QuerySetBase* querySet,
+                                               uint32_t firstQuery,
+                                               uint32_t queryCount,
+                                               BufferBase* destination,
+                                               uint32_t destinationOffset) {
+        ResolveQuerySetCmd* cmd = mAllocator.Allocate<ResolveQuerySetCmd>(Command::ResolveQuerySet);
+        new (cmd) ResolveQuerySetCmd;
+        cmd->querySet = querySet;
+        cmd->firstQuery = firstQuery;
+        cmd->queryCount = queryCount;
+        cmd->destination = destination;
+        cmd->destinationOffset = destinationOffset;
+    }
+
     void CommandBufferBuilder::SetComputePipeline(ComputePipelineBase* pipeline) {
         SetComputePipelineCmd* cmd =
             mAllocator.Allocate<SetComputePipelineCmd>(Command::SetComputePipeline);
@@ -747,6 +1075,10 @@ namespace backend {
         cmd->pipeline = pipeline;
     }
 
+    void CommandBufferBuilder::SetReusable(bool reusable) {
+        mIsReusable = reusable;
+    }
+
     void CommandBufferBuilder::SetPushConstants(nxt::ShaderStageBit stages,
                                                 uint32_t offset,
                                                 uint32_t count,
@@ -784,7 +1116,10 @@ namespace backend {
         cmd->a = a;
     }
 
-    void CommandBufferBuilder::SetBindGroup(uint32_t groupIndex, BindGroupBase* group) {
+    void CommandBufferBuilder::SetBindGroup(uint32_t groupIndex,
+                                            BindGroupBase* group,
+                                            uint32_t dynamicOffsetCount,
+                                            uint32_t const* dynamicOffsets) {
         if (groupIndex >= kMaxBindGroups) {
             HandleError("Setting bind group over the max");
             return;
@@ -794,6 +1129,10 @@ namespace backend {
         new (cmd) SetBindGroupCmd;
         cmd->index = groupIndex;
         cmd->group = group;
+        cmd->dynamicOffsetCount = dynamicOffsetCount;
+
+        uint32_t* offsets = mAllocator.AllocateData<uint32_t>(dynamicOffsetCount);
+        memcpy(offsets, dynamicOffsets, dynamicOffsetCount * sizeof(uint32_t));
     }
 
     void CommandBufferBuilder::SetIndexBuffer(BufferBase* buffer, uint32_t offset) {
@@ -844,6 +1183,13 @@ namespace backend {
         cmd->usage = usage;
     }
 
+    void CommandBufferBuilder::WriteTimestamp(QuerySetBase* querySet, uint32_t queryIndex) {
+        WriteTimestampCmd* cmd = mAllocator.Allocate<WriteTimestampCmd>(Command::WriteTimestamp);
+        new (cmd) WriteTimestampCmd;
+        cmd->querySet = querySet;
+        cmd->queryIndex = queryIndex;
+    }
+
     void CommandBufferBuilder::MoveToIterator() {
         if (!mWasMovedToIterator) {
             mIterator = std::move(mAllocator);
@@ -33,6 +33,7 @@ namespace backend {
     class FramebufferBase;
     class DeviceBase;
     class PipelineBase;
+    class QuerySetBase;
     class RenderPassBase;
     class TextureBase;
 
@@ -41,12 +42,20 @@ namespace backend {
     class CommandBufferBase : public RefCounted {
       public:
         CommandBufferBase(CommandBufferBuilder* builder);
+
+        // The commands are validated when the command buffer is built, so submits only need to
+        // check the state that can change between them.
         bool ValidateResourceUsagesImmediate();
 
         DeviceBase* GetDevice();
 
+        // Reusable command buffers are expected to be submitted many times, so backends can keep
+        // the translation of their commands to replay it on the next submits.
+        bool IsReusable() const;
+
       private:
         DeviceBase* mDevice;
+        bool mIsReusable;
         std::set<BufferBase*> mBuffersTransitioned;
         std::set<TextureBase*> mTexturesTransitioned;
     };
@@ -62,6 +71,7 @@ namespace backend {
 
         // NXT API
         void BeginComputePass();
+        void BeginQuery(QuerySetBase* querySet, uint32_t queryIndex);
         void BeginRenderPass(RenderPassBase* renderPass, FramebufferBase* framebuffer);
         void BeginRenderSubpass();
         void CopyBufferToBuffer(BufferBase* source,
@@ -92,26 +102,57 @@ namespace backend {
                                  uint32_t bufferOffset,
                                  uint32_t rowPitch);
         void Dispatch(uint32_t x, uint32_t y, uint32_t z);
+        void DispatchIndirect(BufferBase* indirectBuffer, uint32_t indirectOffset);
         void DrawArrays(uint32_t vertexCount,
                         uint32_t instanceCount,
                         uint32_t firstVertex,
                         uint32_t firstInstance);
+        void DrawArraysIndirect(BufferBase* indirectBuffer, uint32_t indirectOffset);
         void DrawElements(uint32_t vertexCount,
                           uint32_t instanceCount,
                           uint32_t firstIndex,
                           uint32_t firstInstance);
+        void DrawElementsIndirect(BufferBase* indirectBuffer, uint32_t indirectOffset);
         void EndComputePass();
+        void EndQuery(QuerySetBase* querySet, uint32_t queryIndex);
         void EndRenderPass();
         void EndRenderSubpass();
+
+        template <typename T>
+        void ExecuteBundles(uint32_t count, T* const* bundles) {
+            static_assert(std::is_base_of<RenderBundleBase, T>::value, "");
+            ExecuteBundles(count, reinterpret_cast<RenderBundleBase* const*>(bundles));
+        }
+        void ExecuteBundles(uint32_t count, RenderBundleBase* const* bundles);
+
+        void MultiDrawArrays(uint32_t drawCount,
+                             uint32_t const* vertexCounts,
+                             uint32_t const* instanceCounts,
+                             uint32_t const* firstVertices,
+                             uint32_t const* firstInstances);
+        void MultiDrawElements(uint32_t drawCount,
+                               uint32_t const* indexCounts,
+                               uint32_t const* instanceCounts,
+                               uint32_t const* firstIndices,
+                               uint32_t const* firstInstances);
+        void ResolveQuerySet(QuerySetBase* querySet,
+                             uint32_t firstQuery,
+                             uint32_t queryCount,
+                             BufferBase* destination,
+                             uint32_t destinationOffset);
         void SetPushConstants(nxt::ShaderStageBit stages,
                               uint32_t offset,
                               uint32_t count,
                               const void* data);
         void SetComputePipeline(ComputePipelineBase* pipeline);
         void SetRenderPipeline(RenderPipelineBase* pipeline);
+        void SetReusable(bool reusable);
         void SetStencilReference(uint32_t reference);
         void SetBlendColor(float r, float g, float b, float a);
-        void SetBindGroup(uint32_t groupIndex, BindGroupBase* group);
+        void SetBindGroup(uint32_t groupIndex,
+                          BindGroupBase* group,
+                          uint32_t dynamicOffsetCount,
+                          uint32_t const* dynamicOffsets);
         void SetIndexBuffer(BufferBase* buffer, uint32_t offset);
 
         template <typename T>
@@ -130,6 +171,7 @@ namespace backend {
 
         void TransitionBufferUsage(BufferBase* buffer, nxt::BufferUsageBit usage);
         void TransitionTextureUsage(TextureBase* texture, nxt::TextureUsageBit usage);
+        void WriteTimestamp(QuerySetBase* querySet, uint32_t queryIndex);
 
       private:
         friend class CommandBufferBase;
@@ -142,6 +184,7 @@ namespace backend {
         CommandIterator mIterator;
         bool mWasMovedToIterator = false;
         bool mWereCommandsAcquired = false;
+        bool mIsReusable = false;
     };
 
 }  // namespace backend
@@ -17,19 +17,23 @@
 #include "backend/BindGroup.h"
 #include "backend/BindGroupLayout.h"
 #include "backend/Buffer.h"
+#include "backend/Commands.h"
 #include "backend/ComputePipeline.h"
 #include "backend/Forward.h"
 #include "backend/Framebuffer.h"
 #include "backend/InputState.h"
 #include "backend/PipelineLayout.h"
+#include "backend/QuerySet.h"
+#include "backend/RenderBundle.h"
 #include "backend/RenderPass.h"
 #include "backend/RenderPipeline.h"
 #include "backend/Texture.h"
 #include "common/Assert.h"
 #include "common/BitSetIterator.h"
+#include "common/Math.h"
 
 namespace backend {
-    CommandBufferStateTracker::CommandBufferStateTracker(CommandBufferBuilder* mBuilder)
+    CommandBufferStateTracker::CommandBufferStateTracker(BuilderBase* mBuilder)
         : mBuilder(mBuilder) {
     }
 
@@ -118,6 +122,35 @@ namespace backend {
         return RevalidateCanDraw();
     }
 
+    bool CommandBufferStateTracker::ValidateCanDispatchIndirect(BufferBase* indirectBuffer,
+                                                                uint32_t indirectOffset) {
+        return ValidateCanDispatch() &&
+               ValidateIndirectBuffer(indirectBuffer, indirectOffset, sizeof(DispatchIndirectArgs));
+    }
+
+    bool CommandBufferStateTracker::ValidateCanDrawArraysIndirect(BufferBase* indirectBuffer,
+                                                                  uint32_t indirectOffset) {
+        return ValidateCanDrawArrays() &&
+               ValidateIndirectBuffer(indirectBuffer, indirectOffset,
+                                      sizeof(DrawArraysIndirectArgs));
+    }
+
+    bool CommandBufferStateTracker::ValidateCanDrawElementsIndirect(BufferBase* indirectBuffer,
+                                                                    uint32_t indirectOffset) {
+        if (!ValidateCanDrawElements() ||
+            !ValidateIndirectBuffer(indirectBuffer, indirectOffset,
+                                    sizeof(DrawElementsIndirectArgs))) {
+            return false;
+        }
+        // The first index of indirect draws is relative to the start of the index buffer in
+        // OpenGL, so the offset can't be applied there.
+        if (mIndexBufferOffset != 0) {
+            mBuilder->HandleError("DrawElementsIndirect requires an index buffer offset of 0");
+            return false;
+        }
+        return true;
+    }
+
     bool CommandBufferStateTracker::ValidateEndCommandBuffer() const {
         if (mCurrentRenderPass != nullptr) {
             mBuilder->HandleError("Can't end command buffer with an active render pass");
@@ -165,11 +198,69 @@ namespace backend {
             mBuilder->HandleError("Can't end a compute pass without beginning one");
             return false;
         }
+        if (!ValidateNoActiveQueries()) {
+            return false;
+        }
         mAspects.reset(VALIDATION_ASPECT_COMPUTE_PASS);
         UnsetPipeline();
         return true;
     }
 
+    bool CommandBufferStateTracker::BeginQuery(QuerySetBase* querySet, uint32_t queryIndex) {
+        if (queryIndex >= querySet->GetCount()) {
+            mBuilder->HandleError("Query index out of range");
+            return false;
+        }
+
+        switch (querySet->GetType()) {
+            case nxt::QueryType::Occlusion:
+                if (!mAspects[VALIDATION_ASPECT_RENDER_SUBPASS]) {
+                    mBuilder->HandleError("Occlusion queries must be in a render subpass");
+                    return false;
+                }
+                break;
+            case nxt::QueryType::PipelineStatistics:
+                if (!mAspects[VALIDATION_ASPECT_RENDER_SUBPASS] &&
+                    !mAspects[VALIDATION_ASPECT_COMPUTE_PASS]) {
+                    mBuilder->HandleError(
+                        "Pipeline statistics queries must be in a subpass or a compute pass");
+                    return false;
+                }
+                break;
+            case nxt::QueryType::Timestamp:
+                mBuilder->HandleError("Timestamp queries can only be written with WriteTimestamp");
+                return false;
+            default:
+                UNREACHABLE();
+        }
+
+        ActiveQuery* active = GetActiveQuery(querySet->GetType());
+        if (active->querySet != nullptr) {
+            mBuilder->HandleError("A query of the same type is already active");
+            return false;
+        }
+
+        active->querySet = querySet;
+        active->queryIndex = queryIndex;
+        return true;
+    }
+
+    bool CommandBufferStateTracker::EndQuery(QuerySetBase* querySet, uint32_t queryIndex) {
+        if (querySet->GetType() == nxt::QueryType::Timestamp) {
+            mBuilder->HandleError("Timestamp queries can only be written with WriteTimestamp");
+            return false;
+        }
+
+        ActiveQuery* active = GetActiveQuery(querySet->GetType());
+        if (active->querySet != querySet || active->queryIndex != queryIndex) {
+            mBuilder->HandleError("Can't end a query that isn't active");
+            return false;
+        }
+
+        *active = ActiveQuery();
+        return true;
+    }
+
     bool CommandBufferStateTracker::BeginSubpass() {
         if (mCurrentRenderPass == nullptr) {
             mBuilder->HandleError("Can't begin a subpass without an active render pass");
@@ -216,6 +307,10 @@ namespace backend {
                 continue;
             }
         }
+        if (!ValidateNoActiveQueries()) {
+            return false;
+        }
+
         // Everything in mTexturesAttached should be for the current render subpass.
         mTexturesAttached.clear();
 
@@ -268,6 +363,42 @@ namespace backend {
         return true;
     }
 
+    bool CommandBufferStateTracker::BeginRenderBundle(RenderPassBase* renderPass,
+                                                      uint32_t subpass) {
+        if (subpass >= renderPass->GetSubpassCount()) {
+            mBuilder->HandleError("Render bundle subpass out of range");
+            return false;
+        }
+
+        // Bundles are validated as if they were recorded at the start of their subpass. There is
+        // no framebuffer so resources can only be used with their frozen usages.
+        mCurrentRenderPass = renderPass;
+        mCurrentSubpass = subpass;
+        mAspects.set(VALIDATION_ASPECT_RENDER_SUBPASS);
+        return true;
+    }
+
+    bool CommandBufferStateTracker::ExecuteBundle(RenderBundleBase* bundle) {
+        if (!mAspects[VALIDATION_ASPECT_RENDER_SUBPASS]) {
+            mBuilder->HandleError("Render bundles must be executed in a render subpass");
+            return false;
+        }
+        if (!bundle->GetRenderPass()->IsCompatibleWith(mCurrentRenderPass) ||
+            bundle->GetSubpass() != mCurrentSubpass) {
+            mBuilder->HandleError("Render bundle is incompatible with this subpass");
+            return false;
+        }
+
+        // The bundle leaves the backend state in an unknown state so everything needs to be set
+        // again, including the bind groups that would otherwise be inherited.
+        UnsetPipeline();
+        mLastPipeline = nullptr;
+        mLastRenderPipeline = nullptr;
+        mBindgroupsSet.reset();
+        mInputsSet.reset();
+        return true;
+    }
+
     bool CommandBufferStateTracker::SetComputePipeline(ComputePipelineBase* pipeline) {
         if (!mAspects[VALIDATION_ASPECT_COMPUTE_PASS]) {
             mBuilder->HandleError("A compute pass must be active when a compute pipeline is set");
@@ -299,17 +430,23 @@ namespace backend {
         return true;
     }
 
-    bool CommandBufferStateTracker::SetBindGroup(uint32_t index, BindGroupBase* bindgroup) {
+    bool CommandBufferStateTracker::SetBindGroup(uint32_t index,
+                                                 BindGroupBase* bindgroup,
+                                                 uint32_t dynamicOffsetCount,
+                                                 const uint32_t* dynamicOffsets) {
         if (!ValidateBindGroupUsages(bindgroup)) {
             return false;
         }
+        if (!ValidateDynamicOffsets(bindgroup, dynamicOffsetCount, dynamicOffsets)) {
+            return false;
+        }
         mBindgroupsSet.set(index);
         mBindgroups[index] = bindgroup;
 
         return true;
     }
 
-    bool CommandBufferStateTracker::SetIndexBuffer(BufferBase* buffer) {
+    bool CommandBufferStateTracker::SetIndexBuffer(BufferBase* buffer, uint32_t offset) {
         if (!HavePipeline()) {
             mBuilder->HandleError("Can't set the index buffer without a pipeline");
             return false;
@@ -322,6 +459,7 @@ namespace backend {
         }
 
         mAspects.set(VALIDATION_ASPECT_INDEX_BUFFER);
+        mIndexBufferOffset = offset;
         return true;
     }
 
@@ -434,6 +572,25 @@ namespace backend {
         return IsInternalTextureTransitionPossible(texture, usage);
     }
 
+    bool CommandBufferStateTracker::ValidateIndirectBuffer(BufferBase* buffer,
+                                                           uint32_t offset,
+                                                           size_t argumentsSize) const {
+        if (!BufferHasGuaranteedUsageBit(buffer, nxt::BufferUsageBit::Indirect)) {
+            mBuilder->HandleError("Buffer needs the indirect usage bit to be guaranteed");
+            return false;
+        }
+        if (offset % 4 != 0) {
+            mBuilder->HandleError("Indirect offset must be a multiple of 4");
+            return false;
+        }
+        uint32_t bufferSize = buffer->GetSize();
+        if (offset > bufferSize || argumentsSize > bufferSize - offset) {
+            mBuilder->HandleError("Indirect arguments would overflow the buffer");
+            return false;
+        }
+        return true;
+    }
+
     bool CommandBufferStateTracker::RecomputeHaveAspectBindGroups() {
         if (mAspects[VALIDATION_ASPECT_BIND_GROUPS]) {
             return true;
@@ -483,14 +640,18 @@ namespace backend {
             nxt::BindingType type = layoutInfo.types[i];
             switch (type) {
                 case nxt::BindingType::UniformBuffer:
-                case nxt::BindingType::StorageBuffer: {
+                case nxt::BindingType::StorageBuffer:
+                case nxt::BindingType::DynamicUniformBuffer:
+                case nxt::BindingType::DynamicStorageBuffer: {
                     nxt::BufferUsageBit requiredUsage = nxt::BufferUsageBit::None;
                     switch (type) {
                         case nxt::BindingType::UniformBuffer:
+                        case nxt::BindingType::DynamicUniformBuffer:
                             requiredUsage = nxt::BufferUsageBit::Uniform;
                             break;
 
                         case nxt::BindingType::StorageBuffer:
+                        case nxt::BindingType::DynamicStorageBuffer:
                             requiredUsage = nxt::BufferUsageBit::Storage;
                             break;
 
@@ -520,6 +681,61 @@ namespace backend {
         return true;
     }
 
+    bool CommandBufferStateTracker::ValidateDynamicOffsets(BindGroupBase* group,
+                                                           uint32_t dynamicOffsetCount,
+                                                           const uint32_t* dynamicOffsets) const {
+        const BindGroupLayoutBase* layout = group->GetLayout();
+        if (dynamicOffsetCount != layout->GetDynamicBufferCount()) {
+            mBuilder->HandleError("Dynamic offset count doesn't match the bind group layout");
+            return false;
+        }
+
+        const auto& layoutInfo = layout->GetBindingInfo();
+        uint32_t offsetIndex = 0;
+        for (uint32_t binding : IterateBitSet(layoutInfo.mask)) {
+            if (!IsDynamicBufferBinding(layoutInfo.types[binding])) {
+                continue;
+            }
+
+            uint32_t offset = dynamicOffsets[offsetIndex++];
+            if (!IsAligned(offset, kDynamicBufferOffsetAlignment)) {
+                mBuilder->HandleError("Dynamic offset needs to be 256-byte aligned");
+                return false;
+            }
+
+            // The dynamic offset moves the buffer view, which must stay inside its buffer.
+            BufferViewBase* view = group->GetBindingAsBufferView(binding);
+            uint64_t viewEnd = static_cast<uint64_t>(offset) + view->GetOffset() + view->GetSize();
+            if (viewEnd > view->GetBuffer()->GetSize()) {
+                mBuilder->HandleError("Dynamic offset moves the buffer view out of its buffer");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    CommandBufferStateTracker::ActiveQuery* CommandBufferStateTracker::GetActiveQuery(
+        nxt::QueryType type) {
+        switch (type) {
+            case nxt::QueryType::Occlusion:
+                return &mActiveOcclusionQuery;
+            case nxt::QueryType::PipelineStatistics:
+                return &mActivePipelineStatisticsQuery;
+            default:
+                UNREACHABLE();
+        }
+    }
+
+    bool CommandBufferStateTracker::ValidateNoActiveQueries() const {
+        if (mActiveOcclusionQuery.querySet != nullptr ||
+            mActivePipelineStatisticsQuery.querySet != nullptr) {
+            mBuilder->HandleError("Queries must be ended before the end of their pass");
+            return false;
+        }
+        return true;
+    }
+
     bool CommandBufferStateTracker::RevalidateCanDraw() {
         if (!mAspects[VALIDATION_ASPECT_RENDER_PIPELINE]) {
             mBuilder->HandleError("No active render pipeline");
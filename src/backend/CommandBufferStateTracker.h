@@ -26,7 +26,7 @@
 namespace backend {
     class CommandBufferStateTracker {
       public:
-        explicit CommandBufferStateTracker(CommandBufferBuilder* builder);
+        explicit CommandBufferStateTracker(BuilderBase* builder);
 
         // Non-state-modifying validation functions
         bool HaveRenderPass() const;
@@ -37,20 +37,30 @@ namespace backend {
         bool ValidateCanDispatch();
         bool ValidateCanDrawArrays();
         bool ValidateCanDrawElements();
+        bool ValidateCanDispatchIndirect(BufferBase* indirectBuffer, uint32_t indirectOffset);
+        bool ValidateCanDrawArraysIndirect(BufferBase* indirectBuffer, uint32_t indirectOffset);
+        bool ValidateCanDrawElementsIndirect(BufferBase* indirectBuffer, uint32_t indirectOffset);
         bool ValidateEndCommandBuffer() const;
         bool ValidateSetPushConstants(nxt::ShaderStageBit stages);
 
         // State-modifying methods
         bool BeginComputePass();
         bool EndComputePass();
+        bool BeginQuery(QuerySetBase* querySet, uint32_t queryIndex);
+        bool EndQuery(QuerySetBase* querySet, uint32_t queryIndex);
         bool BeginSubpass();
         bool EndSubpass();
         bool BeginRenderPass(RenderPassBase* renderPass, FramebufferBase* framebuffer);
         bool EndRenderPass();
+        bool BeginRenderBundle(RenderPassBase* renderPass, uint32_t subpass);
+        bool ExecuteBundle(RenderBundleBase* bundle);
         bool SetComputePipeline(ComputePipelineBase* pipeline);
         bool SetRenderPipeline(RenderPipelineBase* pipeline);
-        bool SetBindGroup(uint32_t index, BindGroupBase* bindgroup);
-        bool SetIndexBuffer(BufferBase* buffer);
+        bool SetBindGroup(uint32_t index,
+                          BindGroupBase* bindgroup,
+                          uint32_t dynamicOffsetCount,
+                          const uint32_t* dynamicOffsets);
+        bool SetIndexBuffer(BufferBase* buffer, uint32_t offset);
         bool SetVertexBuffer(uint32_t index, BufferBase* buffer);
         bool TransitionBufferUsage(BufferBase* buffer, nxt::BufferUsageBit usage);
         bool TransitionTextureUsage(TextureBase* texture, nxt::TextureUsageBit usage);
@@ -84,6 +94,9 @@ namespace backend {
                                                  nxt::TextureUsageBit usage) const;
         bool IsExplicitTextureTransitionPossible(TextureBase* texture,
                                                  nxt::TextureUsageBit usage) const;
+        bool ValidateIndirectBuffer(BufferBase* buffer,
+                                    uint32_t offset,
+                                    size_t argumentsSize) const;
 
         // Queries for lazily evaluated aspects
         bool RecomputeHaveAspectBindGroups();
@@ -91,18 +104,29 @@ namespace backend {
 
         bool HavePipeline() const;
         bool ValidateBindGroupUsages(BindGroupBase* group) const;
+        bool ValidateDynamicOffsets(BindGroupBase* group,
+                                    uint32_t dynamicOffsetCount,
+                                    const uint32_t* dynamicOffsets) const;
         bool RevalidateCanDraw();
 
+        struct ActiveQuery {
+            QuerySetBase* querySet = nullptr;
+            uint32_t queryIndex = 0;
+        };
+        ActiveQuery* GetActiveQuery(nxt::QueryType type);
+        bool ValidateNoActiveQueries() const;
+
         void SetPipelineCommon(PipelineBase* pipeline);
         void UnsetPipeline();
 
-        CommandBufferBuilder* mBuilder;
+        BuilderBase* mBuilder;
 
         ValidationAspects mAspects;
 
         std::bitset<kMaxBindGroups> mBindgroupsSet;
         std::array<BindGroupBase*, kMaxBindGroups> mBindgroups = {};
         std::bitset<kMaxVertexInputs> mInputsSet;
+        uint32_t mIndexBufferOffset = 0;
         PipelineBase* mLastPipeline = nullptr;
         RenderPipelineBase* mLastRenderPipeline = nullptr;
 
@@ -112,6 +136,11 @@ namespace backend {
         RenderPassBase* mCurrentRenderPass = nullptr;
         FramebufferBase* mCurrentFramebuffer = nullptr;
         uint32_t mCurrentSubpass = 0;
+
+        // Queries are begun and ended in the same pass, and only one query of each type can be
+        // active at a time.
+        ActiveQuery mActiveOcclusionQuery;
+        ActiveQuery mActivePipelineStatisticsQuery;
     };
 }  // namespace backend
 
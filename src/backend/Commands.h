@@ -29,17 +29,26 @@ namespace backend {
 
     enum class Command {
         BeginComputePass,
+        BeginQuery,
         BeginRenderPass,
         BeginRenderSubpass,
         CopyBufferToBuffer,
         CopyBufferToTexture,
         CopyTextureToBuffer,
         Dispatch,
+        DispatchIndirect,
         DrawArrays,
+        DrawArraysIndirect,
         DrawElements,
+        DrawElementsIndirect,
         EndComputePass,
+        EndQuery,
         EndRenderPass,
         EndRenderSubpass,
+        ExecuteBundles,
+        MultiDrawArrays,
+        MultiDrawElements,
+        ResolveQuerySet,
         SetComputePipeline,
         SetRenderPipeline,
         SetPushConstants,
@@ -50,10 +59,16 @@ namespace backend {
         SetVertexBuffers,
         TransitionBufferUsage,
         TransitionTextureUsage,
+        WriteTimestamp,
     };
 
     struct BeginComputePassCmd {};
 
+    struct BeginQueryCmd {
+        Ref<QuerySetBase> querySet;
+        uint32_t queryIndex;
+    };
+
     struct BeginRenderPassCmd {
         Ref<RenderPassBase> renderPass;
         Ref<FramebufferBase> framebuffer;
@@ -97,6 +112,11 @@ namespace backend {
         uint32_t z;
     };
 
+    struct DispatchIndirectCmd {
+        Ref<BufferBase> indirectBuffer;
+        uint32_t indirectOffset;
+    };
+
     struct DrawArraysCmd {
         uint32_t vertexCount;
         uint32_t instanceCount;
@@ -104,6 +124,11 @@ namespace backend {
         uint32_t firstInstance;
     };
 
+    struct DrawArraysIndirectCmd {
+        Ref<BufferBase> indirectBuffer;
+        uint32_t indirectOffset;
+    };
+
     struct DrawElementsCmd {
         uint32_t indexCount;
         uint32_t instanceCount;
@@ -111,12 +136,69 @@ namespace backend {
         uint32_t firstInstance;
     };
 
+    struct DrawElementsIndirectCmd {
+        Ref<BufferBase> indirectBuffer;
+        uint32_t indirectOffset;
+    };
+
+    // Layout of the arguments read from the buffer of the indirect commands, which is the same in
+    // all the backend APIs. baseVertex has no equivalent in DrawElements and should be 0.
+    struct DispatchIndirectArgs {
+        uint32_t x;
+        uint32_t y;
+        uint32_t z;
+    };
+
+    struct DrawArraysIndirectArgs {
+        uint32_t vertexCount;
+        uint32_t instanceCount;
+        uint32_t firstVertex;
+        uint32_t firstInstance;
+    };
+
+    struct DrawElementsIndirectArgs {
+        uint32_t indexCount;
+        uint32_t instanceCount;
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t firstInstance;
+    };
+
     struct EndComputePassCmd {};
 
+    struct EndQueryCmd {
+        Ref<QuerySetBase> querySet;
+        uint32_t queryIndex;
+    };
+
     struct EndRenderPassCmd {};
 
     struct EndRenderSubpassCmd {};
 
+    // Followed by count Ref<RenderBundleBase>.
+    struct ExecuteBundlesCmd {
+        uint32_t count;
+    };
+
+    // Followed by drawCount vertex counts, instance counts, first vertices and first instances.
+    struct MultiDrawArraysCmd {
+        uint32_t drawCount;
+    };
+
+    // Followed by drawCount index counts, instance counts, first indices and first instances.
+    struct MultiDrawElementsCmd {
+        uint32_t drawCount;
+    };
+
+    // Writes queryCount uint64_t results to the destination buffer.
+    struct ResolveQuerySetCmd {
+        Ref<QuerySetBase> querySet;
+        uint32_t firstQuery;
+        uint32_t queryCount;
+        Ref<BufferBase> destination;
+        uint32_t destinationOffset;
+    };
+
     struct SetComputePipelineCmd {
         Ref<ComputePipelineBase> pipeline;
     };
@@ -139,9 +221,11 @@ namespace backend {
         float r, g, b, a;
     };
 
+    // Followed by dynamicOffsetCount uint32_t.
     struct SetBindGroupCmd {
         uint32_t index;
         Ref<BindGroupBase> group;
+        uint32_t dynamicOffsetCount;
     };
 
     struct SetIndexBufferCmd {
@@ -166,11 +250,22 @@ namespace backend {
         nxt::TextureUsageBit usage;
     };
 
+    struct WriteTimestampCmd {
+        Ref<QuerySetBase> querySet;
+        uint32_t queryIndex;
+    };
+
     // This needs to be called before the CommandIterator is freed so that the Ref<> present in
     // the commands have a chance to run their destructor and remove internal references.
     void FreeCommands(CommandIterator* commands);
     void SkipCommand(CommandIterator* commands, Command type);
 
+    // The four arrays of parameters of the multi-draw commands are stored as additional data.
+    void CopyMultiDrawParameters(CommandAllocator* allocator,
+                                 uint32_t drawCount,
+                                 uint32_t const* parameters);
+    void SkipMultiDrawParameters(CommandIterator* commands, uint32_t drawCount);
+
 }  // namespace backend
 
 #endif  // BACKEND_COMMANDS_H_
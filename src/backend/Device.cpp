@@ -21,10 +21,13 @@
 #include "backend/CommandBuffer.h"
 #include "backend/ComputePipeline.h"
 #include "backend/DepthStencilState.h"
+#include "backend/Fence.h"
 #include "backend/Framebuffer.h"
 #include "backend/InputState.h"
 #include "backend/PipelineLayout.h"
+#include "backend/QuerySet.h"
 #include "backend/Queue.h"
+#include "backend/RenderBundle.h"
 #include "backend/RenderPass.h"
 #include "backend/RenderPipeline.h"
 #include "backend/Sampler.h"
@@ -32,7 +35,9 @@
 #include "backend/SwapChain.h"
 #include "backend/Texture.h"
 
+#include <algorithm>
 #include <unordered_set>
+#include <vector>
 
 namespace backend {
 
@@ -47,6 +52,69 @@ namespace backend {
         BindGroupLayoutCache bindGroupLayouts;
     };
 
+    // MapReadRangesRequest
+
+    namespace {
+
+        // Tracks a MapReadRangesAsync until all the buffers it maps have completed their map read
+        // and the single callback can be called with the pointers to each range.
+        struct MapReadRangesRequest {
+            struct MappedBuffer {
+                MapReadRangesRequest* request;
+                BufferBase* buffer;
+                // The union of the ranges of this buffer, that is what gets mapped.
+                uint32_t start;
+                uint32_t end;
+                const uint8_t* data;
+            };
+
+            nxtBufferMapReadRangesCallback callback;
+            nxtCallbackUserdata userdata;
+
+            std::vector<MappedBuffer> buffers;
+            // For each range, the index of its buffer in buffers and its start.
+            std::vector<size_t> rangeBuffers;
+            std::vector<uint32_t> rangeStarts;
+
+            size_t pendingBufferCount;
+            nxtBufferMapReadStatus status = NXT_BUFFER_MAP_READ_STATUS_SUCCESS;
+        };
+
+        void OnMapReadRangesBufferMapped(nxtBufferMapReadStatus status,
+                                         const void* data,
+                                         nxtCallbackUserdata userdata) {
+            auto mapped = reinterpret_cast<MapReadRangesRequest::MappedBuffer*>(
+                static_cast<uintptr_t>(userdata));
+            MapReadRangesRequest* request = mapped->request;
+
+            mapped->data = static_cast<const uint8_t*>(data);
+            if (status != NXT_BUFFER_MAP_READ_STATUS_SUCCESS) {
+                request->status = status;
+            }
+
+            ASSERT(request->pendingBufferCount > 0);
+            request->pendingBufferCount--;
+            if (request->pendingBufferCount > 0) {
+                return;
+            }
+
+            uint32_t count = static_cast<uint32_t>(request->rangeStarts.size());
+            if (request->status == NXT_BUFFER_MAP_READ_STATUS_SUCCESS) {
+                std::vector<const void*> pointers(count);
+                for (uint32_t i = 0; i < count; ++i) {
+                    const auto& buffer = request->buffers[request->rangeBuffers[i]];
+                    pointers[i] = buffer.data + (request->rangeStarts[i] - buffer.start);
+                }
+                request->callback(request->status, count, pointers.data(), request->userdata);
+            } else {
+                request->callback(request->status, count, nullptr, request->userdata);
+            }
+
+            delete request;
+        }
+
+    }  // anonymous namespace
+
     // DeviceBase
 
     DeviceBase::DeviceBase() {
@@ -63,6 +131,10 @@ namespace backend {
         }
     }
 
+    void DeviceBase::SignalCompletion() {
+        mCompletionEvent.Signal();
+    }
+
     void DeviceBase::SetErrorCallback(nxt::DeviceErrorCallback callback,
                                       nxt::CallbackUserdata userdata) {
         mErrorCallback = callback;
@@ -115,6 +187,9 @@ namespace backend {
     DepthStencilStateBuilder* DeviceBase::CreateDepthStencilStateBuilder() {
         return new DepthStencilStateBuilder(this);
     }
+    FenceBuilder* DeviceBase::CreateFenceBuilder() {
+        return new FenceBuilder(this);
+    }
     FramebufferBuilder* DeviceBase::CreateFramebufferBuilder() {
         return new FramebufferBuilder(this);
     }
@@ -124,9 +199,15 @@ namespace backend {
     PipelineLayoutBuilder* DeviceBase::CreatePipelineLayoutBuilder() {
         return new PipelineLayoutBuilder(this);
     }
+    QuerySetBuilder* DeviceBase::CreateQuerySetBuilder() {
+        return new QuerySetBuilder(this);
+    }
     QueueBuilder* DeviceBase::CreateQueueBuilder() {
         return new QueueBuilder(this);
     }
+    RenderBundleBuilder* DeviceBase::CreateRenderBundleBuilder() {
+        return new RenderBundleBuilder(this);
+    }
     RenderPassBuilder* DeviceBase::CreateRenderPassBuilder() {
         return new RenderPassBuilder(this);
     }
@@ -147,9 +228,86 @@ namespace backend {
     }
 
     void DeviceBase::Tick() {
+        // Cleared before ticking so that completions racing with the tick leave the fd readable.
+        mCompletionEvent.Clear();
         TickImpl();
     }
 
+    int32_t DeviceBase::GetCompletionFd() {
+        if (!SignalsCompletion()) {
+            return -1;
+        }
+        return mCompletionEvent.GetFd();
+    }
+
+    bool DeviceBase::SignalsCompletion() const {
+        return true;
+    }
+
+    void DeviceBase::MapReadRangesAsync(uint32_t count,
+                                        BufferBase* const* buffers,
+                                        uint32_t const* starts,
+                                        uint32_t const* sizes,
+                                        nxtBufferMapReadRangesCallback callback,
+                                        nxtCallbackUserdata userdata) {
+        auto request = new MapReadRangesRequest;
+        request->callback = callback;
+        request->userdata = userdata;
+        request->rangeBuffers.reserve(count);
+        request->rangeStarts.reserve(count);
+
+        // Validate all the ranges before mapping anything so that the request either maps all
+        // the buffers or none of them. Ranges of the same buffer are merged and it is mapped
+        // only once.
+        bool valid = true;
+        for (uint32_t i = 0; i < count && valid; ++i) {
+            valid = buffers[i]->ValidateMapRead(starts[i], sizes[i]);
+
+            size_t bufferIndex = 0;
+            while (bufferIndex < request->buffers.size() &&
+                   request->buffers[bufferIndex].buffer != buffers[i]) {
+                bufferIndex++;
+            }
+
+            if (bufferIndex == request->buffers.size()) {
+                request->buffers.push_back(
+                    {request, buffers[i], starts[i], starts[i] + sizes[i], nullptr});
+            } else {
+                auto& mapped = request->buffers[bufferIndex];
+                mapped.start = std::min(mapped.start, starts[i]);
+                mapped.end = std::max(mapped.end, starts[i] + sizes[i]);
+            }
+
+            request->rangeBuffers.push_back(bufferIndex);
+            request->rangeStarts.push_back(starts[i]);
+        }
+
+        if (!valid) {
+            callback(NXT_BUFFER_MAP_READ_STATUS_ERROR, count, nullptr, userdata);
+            delete request;
+            return;
+        }
+
+        if (count == 0) {
+            callback(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, 0, nullptr, userdata);
+            delete request;
+            return;
+        }
+
+        // Backends might complete maps immediately, so the request must know how many buffers
+        // it waits on before the first map, and must not be used after the last one.
+        size_t bufferCount = request->buffers.size();
+        request->pendingBufferCount = bufferCount;
+        MapReadRangesRequest::MappedBuffer* mappedBuffers = request->buffers.data();
+        for (size_t i = 0; i < bufferCount; ++i) {
+            auto& mapped = mappedBuffers[i];
+            auto mappedUserdata =
+                static_cast<nxtCallbackUserdata>(reinterpret_cast<uintptr_t>(&mapped));
+            mapped.buffer->MapReadAsync(mapped.start, mapped.end - mapped.start,
+                                        OnMapReadRangesBufferMapped, mappedUserdata);
+        }
+    }
+
     void DeviceBase::Reference() {
         ASSERT(mRefCount != 0);
         mRefCount++;
@@ -17,9 +17,12 @@
 
 #include "backend/Forward.h"
 #include "backend/RefCounted.h"
+#include "common/PollableEvent.h"
 
 #include "nxt/nxtcpp.h"
 
+#include <type_traits>
+
 namespace backend {
 
     using ErrorCallback = void (*)(const char* errorMessage, void* userData);
@@ -30,6 +33,9 @@ namespace backend {
         virtual ~DeviceBase();
 
         void HandleError(const char* message);
+        // Makes the completion fd readable so that the application ticks the device. Backends
+        // call it when a serial completes, and it can be called from any thread.
+        void SignalCompletion();
 
         // Used by autogenerated code, returns itself
         DeviceBase* GetDevice();
@@ -46,7 +52,9 @@ namespace backend {
         virtual FramebufferBase* CreateFramebuffer(FramebufferBuilder* builder) = 0;
         virtual InputStateBase* CreateInputState(InputStateBuilder* builder) = 0;
         virtual PipelineLayoutBase* CreatePipelineLayout(PipelineLayoutBuilder* builder) = 0;
+        virtual QuerySetBase* CreateQuerySet(QuerySetBuilder* builder) = 0;
         virtual QueueBase* CreateQueue(QueueBuilder* builder) = 0;
+        virtual RenderBundleBase* CreateRenderBundle(RenderBundleBuilder* builder) = 0;
         virtual RenderPassBase* CreateRenderPass(RenderPassBuilder* builder) = 0;
         virtual RenderPipelineBase* CreateRenderPipeline(RenderPipelineBuilder* builder) = 0;
         virtual SamplerBase* CreateSampler(SamplerBuilder* builder) = 0;
@@ -56,6 +64,9 @@ namespace backend {
         virtual TextureViewBase* CreateTextureView(TextureViewBuilder* builder) = 0;
 
         virtual void TickImpl() = 0;
+        // Whether the backend calls SignalCompletion when work completes. When it doesn't, the
+        // device has no completion fd.
+        virtual bool SignalsCompletion() const;
 
         // Many NXT objects are completely immutable once created which means that if two
         // builders are given the same arguments, they can return the same object. Reusing
@@ -83,10 +94,13 @@ namespace backend {
         CommandBufferBuilder* CreateCommandBufferBuilder();
         ComputePipelineBuilder* CreateComputePipelineBuilder();
         DepthStencilStateBuilder* CreateDepthStencilStateBuilder();
+        FenceBuilder* CreateFenceBuilder();
         FramebufferBuilder* CreateFramebufferBuilder();
         InputStateBuilder* CreateInputStateBuilder();
         PipelineLayoutBuilder* CreatePipelineLayoutBuilder();
+        QuerySetBuilder* CreateQuerySetBuilder();
         QueueBuilder* CreateQueueBuilder();
+        RenderBundleBuilder* CreateRenderBundleBuilder();
         RenderPassBuilder* CreateRenderPassBuilder();
         RenderPipelineBuilder* CreateRenderPipelineBuilder();
         SamplerBuilder* CreateSamplerBuilder();
@@ -95,7 +109,29 @@ namespace backend {
         TextureBuilder* CreateTextureBuilder();
 
         void Tick();
+        // A file descriptor that becomes readable when ticking the device would complete work,
+        // and is cleared by Tick. Returns -1 on platforms without pollable file descriptors and
+        // for backends that can't tell when work completes.
+        int32_t GetCompletionFd();
         void SetErrorCallback(nxt::DeviceErrorCallback callback, nxt::CallbackUserdata userdata);
+
+        template <typename T>
+        void MapReadRangesAsync(uint32_t count,
+                                T* const* buffers,
+                                uint32_t const* starts,
+                                uint32_t const* sizes,
+                                nxtBufferMapReadRangesCallback callback,
+                                nxtCallbackUserdata userdata) {
+            static_assert(std::is_base_of<BufferBase, T>::value, "");
+            MapReadRangesAsync(count, reinterpret_cast<BufferBase* const*>(buffers), starts, sizes,
+                               callback, userdata);
+        }
+        void MapReadRangesAsync(uint32_t count,
+                                BufferBase* const* buffers,
+                                uint32_t const* starts,
+                                uint32_t const* sizes,
+                                nxtBufferMapReadRangesCallback callback,
+                                nxtCallbackUserdata userdata);
         void Reference();
         void Release();
 
@@ -105,6 +141,8 @@ namespace backend {
         struct Caches;
         Caches* mCaches = nullptr;
 
+        PollableEvent mCompletionEvent;
+
         nxt::DeviceErrorCallback mErrorCallback = nullptr;
         nxt::CallbackUserdata mErrorUserdata = 0;
         uint32_t mRefCount = 1;
@@ -0,0 +1,147 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "backend/Fence.h"
+
+#include "backend/Device.h"
+#include "common/Assert.h"
+
+#include <vector>
+
+namespace backend {
+
+    // FenceBase
+
+    FenceBase::FenceBase(FenceBuilder* builder)
+        : mDevice(builder->mDevice),
+          mSignaledValue(builder->mInitialValue),
+          mCompletedValue(builder->mInitialValue) {
+    }
+
+    FenceBase::~FenceBase() {
+        // Callbacks need to be fired in all cases, as they can handle freeing resources, so we
+        // call them with "Unknown" status.
+        auto requests = std::move(mRequests);
+        mRequests.clear();
+        for (auto& request : requests) {
+            request.second.callback(NXT_FENCE_COMPLETION_STATUS_UNKNOWN,
+                                    request.second.userdata);
+        }
+    }
+
+    DeviceBase* FenceBase::GetDevice() {
+        return mDevice;
+    }
+
+    uint64_t FenceBase::GetSignaledValue() const {
+        return mSignaledValue;
+    }
+
+    void FenceBase::SetSignaledValue(uint64_t signalValue) {
+        ASSERT(signalValue > mSignaledValue);
+        mSignaledValue = signalValue;
+    }
+
+    void FenceBase::SetCompletedValue(uint64_t completedValue) {
+        ASSERT(completedValue <= mSignaledValue);
+        if (completedValue <= mCompletedValue) {
+            return;
+        }
+        mCompletedValue = completedValue;
+
+        // The ready requests are removed before being called so that callbacks can add requests
+        // on this fence.
+        std::vector<OnCompletionData> readyRequests;
+        auto end = mRequests.upper_bound(completedValue);
+        for (auto it = mRequests.begin(); it != end; ++it) {
+            readyRequests.push_back(it->second);
+        }
+        mRequests.erase(mRequests.begin(), end);
+
+        for (const auto& request : readyRequests) {
+            request.callback(NXT_FENCE_COMPLETION_STATUS_SUCCESS, request.userdata);
+        }
+    }
+
+    uint64_t FenceBase::GetCompletedValue() const {
+        return mCompletedValue;
+    }
+
+    void FenceBase::OnCompletion(uint64_t value,
+                                 nxtFenceOnCompletionCallback callback,
+                                 nxtCallbackUserdata userdata) {
+        // Waiting on a value that wasn't signaled could never complete.
+        if (value > mSignaledValue) {
+            mDevice->HandleError("Fence OnCompletion value greater than the signaled value");
+            callback(NXT_FENCE_COMPLETION_STATUS_ERROR, userdata);
+            return;
+        }
+
+        if (value <= mCompletedValue) {
+            callback(NXT_FENCE_COMPLETION_STATUS_SUCCESS, userdata);
+            return;
+        }
+
+        OnCompletionData request;
+        request.callback = callback;
+        request.userdata = userdata;
+        mRequests.emplace(value, request);
+    }
+
+    // FenceBuilder
+
+    FenceBuilder::FenceBuilder(DeviceBase* device) : Builder(device) {
+    }
+
+    FenceBase* FenceBuilder::GetResultImpl() {
+        return new FenceBase(this);
+    }
+
+    void FenceBuilder::SetInitialValue(uint64_t initialValue) {
+        if (mInitialValueSet) {
+            HandleError("Fence initial value property set multiple times");
+            return;
+        }
+
+        mInitialValue = initialValue;
+        mInitialValueSet = true;
+    }
+
+    // FenceSignalTracker
+
+    void FenceSignalTracker::UpdateFenceOnComplete(FenceBase* fence,
+                                                   uint64_t value,
+                                                   Serial serial) {
+        FenceInFlight fenceInFlight;
+        fenceInFlight.fence = fence;
+        fenceInFlight.value = value;
+
+        mFencesInFlight.Enqueue(std::move(fenceInFlight), serial);
+    }
+
+    void FenceSignalTracker::Tick(Serial finishedSerial) {
+        // The fences are removed from the queue before their callbacks are called, as callbacks
+        // can signal fences again.
+        std::vector<FenceInFlight> completedFences;
+        for (auto& fenceInFlight : mFencesInFlight.IterateUpTo(finishedSerial)) {
+            completedFences.push_back(std::move(fenceInFlight));
+        }
+        mFencesInFlight.ClearUpTo(finishedSerial);
+
+        for (auto& fenceInFlight : completedFences) {
+            fenceInFlight.fence->SetCompletedValue(fenceInFlight.value);
+        }
+    }
+
+}  // namespace backend
@@ -0,0 +1,100 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BACKEND_FENCE_H_
+#define BACKEND_FENCE_H_
+
+#include "backend/Builder.h"
+#include "backend/Forward.h"
+#include "backend/RefCounted.h"
+#include "common/SerialQueue.h"
+
+#include "nxt/nxtcpp.h"
+
+#include <map>
+
+namespace backend {
+
+    // A fence holds a monotonically increasing uint64_t value. Queue::Signal(fence, value) makes
+    // the fence reach value once the GPU has finished the work submitted before the signal.
+    //  - The signaled value is the largest value passed to Signal so far, and is updated
+    //    immediately.
+    //  - The completed value is the largest value the GPU has reached, and is updated when the
+    //    device is ticked.
+    // OnCompletion callbacks are called once the completed value reaches their value.
+    class FenceBase : public RefCounted {
+      public:
+        FenceBase(FenceBuilder* builder);
+        ~FenceBase();
+
+        DeviceBase* GetDevice();
+
+        uint64_t GetSignaledValue() const;
+        void SetSignaledValue(uint64_t signalValue);
+        // Called by the backends when the GPU reached a value, calls the callbacks now ready.
+        void SetCompletedValue(uint64_t completedValue);
+
+        // NXT API
+        uint64_t GetCompletedValue() const;
+        void OnCompletion(uint64_t value,
+                          nxtFenceOnCompletionCallback callback,
+                          nxtCallbackUserdata userdata);
+
+      private:
+        struct OnCompletionData {
+            nxtFenceOnCompletionCallback callback = nullptr;
+            nxtCallbackUserdata userdata = 0;
+        };
+
+        DeviceBase* mDevice;
+        uint64_t mSignaledValue;
+        uint64_t mCompletedValue;
+        // The requests indexed by the value they wait on.
+        std::multimap<uint64_t, OnCompletionData> mRequests;
+    };
+
+    class FenceBuilder : public Builder<FenceBase> {
+      public:
+        FenceBuilder(DeviceBase* device);
+
+        // NXT API
+        void SetInitialValue(uint64_t initialValue);
+
+      private:
+        friend class FenceBase;
+
+        FenceBase* GetResultImpl() override;
+
+        bool mInitialValueSet = false;
+        uint64_t mInitialValue = 0;
+    };
+
+    // Used by the backends to update the completed value of fences when the commands submitted
+    // before their signal are finished, like for buffer map reads.
+    class FenceSignalTracker {
+      public:
+        void UpdateFenceOnComplete(FenceBase* fence, uint64_t value, Serial serial);
+        void Tick(Serial finishedSerial);
+
+      private:
+        struct FenceInFlight {
+            Ref<FenceBase> fence;
+            uint64_t value;
+        };
+        SerialQueue<FenceInFlight> mFencesInFlight;
+    };
+
+}  // namespace backend
+
+#endif  // BACKEND_FENCE_H_
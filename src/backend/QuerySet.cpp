@@ -0,0 +1,85 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "backend/QuerySet.h"
+
+#include "backend/Device.h"
+#include "common/Constants.h"
+
+namespace backend {
+
+    // QuerySetBase
+
+    QuerySetBase::QuerySetBase(QuerySetBuilder* builder)
+        : mDevice(builder->mDevice), mType(builder->mType), mCount(builder->mCount) {
+    }
+
+    DeviceBase* QuerySetBase::GetDevice() {
+        return mDevice;
+    }
+
+    nxt::QueryType QuerySetBase::GetType() const {
+        return mType;
+    }
+
+    uint32_t QuerySetBase::GetCount() const {
+        return mCount;
+    }
+
+    // QuerySetBuilder
+
+    enum QuerySetSetProperties {
+        QUERY_SET_PROPERTY_COUNT = 0x1,
+        QUERY_SET_PROPERTY_TYPE = 0x2,
+    };
+
+    QuerySetBuilder::QuerySetBuilder(DeviceBase* device) : Builder(device) {
+    }
+
+    QuerySetBase* QuerySetBuilder::GetResultImpl() {
+        constexpr int allProperties = QUERY_SET_PROPERTY_COUNT | QUERY_SET_PROPERTY_TYPE;
+        if ((mPropertiesSet & allProperties) != allProperties) {
+            HandleError("Query set missing properties");
+            return nullptr;
+        }
+
+        if (mCount == 0 || mCount > kMaxQueriesPerSet) {
+            HandleError("Query set count out of range");
+            return nullptr;
+        }
+
+        return mDevice->CreateQuerySet(this);
+    }
+
+    void QuerySetBuilder::SetCount(uint32_t count) {
+        if ((mPropertiesSet & QUERY_SET_PROPERTY_COUNT) != 0) {
+            HandleError("Query set count property set multiple times");
+            return;
+        }
+
+        mCount = count;
+        mPropertiesSet |= QUERY_SET_PROPERTY_COUNT;
+    }
+
+    void QuerySetBuilder::SetType(nxt::QueryType type) {
+        if ((mPropertiesSet & QUERY_SET_PROPERTY_TYPE) != 0) {
+            HandleError("Query set type property set multiple times");
+            return;
+        }
+
+        mType = type;
+        mPropertiesSet |= QUERY_SET_PROPERTY_TYPE;
+    }
+
+}  // namespace backend
@@ -0,0 +1,68 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BACKEND_QUERYSET_H_
+#define BACKEND_QUERYSET_H_
+
+#include "backend/Builder.h"
+#include "backend/Forward.h"
+#include "backend/RefCounted.h"
+
+#include "nxt/nxtcpp.h"
+
+namespace backend {
+
+    // A query set holds a number of queries of the same type. Each query produces a uint64_t
+    // result when it is resolved into a buffer:
+    //  - Occlusion: the number of samples that passed the depth and stencil tests.
+    //  - PipelineStatistics: the number of primitives sent to the rasterizer.
+    //  - Timestamp: a GPU timestamp in nanoseconds. Only differences between timestamps are
+    //    meaningful.
+    // The result of a query that wasn't written by a previous command is undefined.
+    class QuerySetBase : public RefCounted {
+      public:
+        QuerySetBase(QuerySetBuilder* builder);
+
+        DeviceBase* GetDevice();
+        nxt::QueryType GetType() const;
+        uint32_t GetCount() const;
+
+      private:
+        DeviceBase* mDevice;
+        nxt::QueryType mType;
+        uint32_t mCount;
+    };
+
+    class QuerySetBuilder : public Builder<QuerySetBase> {
+      public:
+        QuerySetBuilder(DeviceBase* device);
+
+        // NXT API
+        void SetCount(uint32_t count);
+        void SetType(nxt::QueryType type);
+
+      private:
+        friend class QuerySetBase;
+
+        QuerySetBase* GetResultImpl() override;
+
+        int mPropertiesSet = 0;
+
+        nxt::QueryType mType = nxt::QueryType::Occlusion;
+        uint32_t mCount = 0;
+    };
+
+}  // namespace backend
+
+#endif  // BACKEND_QUERYSET_H_
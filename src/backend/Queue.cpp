@@ -16,6 +16,7 @@
 
 #include "backend/CommandBuffer.h"
 #include "backend/Device.h"
+#include "backend/Fence.h"
 
 namespace backend {
 
@@ -32,6 +33,25 @@ namespace backend {
         return command->ValidateResourceUsagesImmediate();
     }
 
+    bool QueueBase::ValidateSignal(FenceBase* fence, uint64_t signalValue) {
+        if (fence->GetDevice() != mDevice) {
+            mDevice->HandleError("Fence signaled on a queue of another device");
+            return false;
+        }
+
+        if (signalValue <= fence->GetSignaledValue()) {
+            mDevice->HandleError("Fence value less than or equal to the signaled value");
+            return false;
+        }
+
+        return true;
+    }
+
+    void QueueBase::Signal(FenceBase* fence, uint64_t signalValue) {
+        fence->SetSignaledValue(signalValue);
+        SignalImpl(fence, signalValue);
+    }
+
     // QueueBuilder
 
     QueueBuilder::QueueBuilder(DeviceBase* device) : Builder(device) {
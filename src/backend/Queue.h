@@ -41,10 +41,17 @@ namespace backend {
             }
             return true;
         }
+        bool ValidateSignal(FenceBase* fence, uint64_t signalValue);
+
+        // NXT API
+        void Signal(FenceBase* fence, uint64_t signalValue);
 
       private:
         bool ValidateSubmitCommand(CommandBufferBase* command);
 
+        // Makes the fence complete signalValue once the commands submitted so far are finished.
+        virtual void SignalImpl(FenceBase* fence, uint64_t signalValue) = 0;
+
         DeviceBase* mDevice;
     };
 
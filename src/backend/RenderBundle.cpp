@@ -0,0 +1,402 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "backend/RenderBundle.h"
+
+#include "backend/BindGroup.h"
+#include "backend/Buffer.h"
+#include "backend/CommandBufferStateTracker.h"
+#include "backend/Device.h"
+#include "backend/RenderPipeline.h"
+#include "common/Assert.h"
+#include "common/Constants.h"
+
+#include <cstring>
+
+namespace backend {
+
+    // RenderBundleBase
+
+    RenderBundleBase::RenderBundleBase(RenderBundleBuilder* builder)
+        : mRenderPass(builder->GetRenderPass()),
+          mSubpass(builder->GetSubpass()),
+          mCommands(builder->AcquireCommands()) {
+    }
+
+    RenderBundleBase::~RenderBundleBase() {
+        FreeCommands(&mCommands);
+    }
+
+    RenderPassBase* RenderBundleBase::GetRenderPass() {
+        return mRenderPass.Get();
+    }
+
+    uint32_t RenderBundleBase::GetSubpass() const {
+        return mSubpass;
+    }
+
+    CommandIterator* RenderBundleBase::GetCommands() {
+        return &mCommands;
+    }
+
+    // RenderBundleBuilder
+
+    RenderBundleBuilder::RenderBundleBuilder(DeviceBase* device)
+        : Builder(device), mState(std::make_unique<CommandBufferStateTracker>(this)) {
+    }
+
+    RenderBundleBuilder::~RenderBundleBuilder() {
+        if (!mWereCommandsAcquired) {
+            MoveToIterator();
+            FreeCommands(&mIterator);
+        }
+    }
+
+    bool RenderBundleBuilder::ValidateGetResult() {
+        MoveToIterator();
+
+        if (!mRenderPass) {
+            HandleError("Render bundle subpass not set");
+            return false;
+        }
+        if (!mState->BeginRenderBundle(mRenderPass.Get(), mSubpass)) {
+            return false;
+        }
+
+        Command type;
+        while (mIterator.NextCommandId(&type)) {
+            switch (type) {
+                case Command::DrawArrays: {
+                    mIterator.NextCommand<DrawArraysCmd>();
+                    if (!mState->ValidateCanDrawArrays()) {
+                        return false;
+                    }
+                } break;
+
+                case Command::DrawArraysIndirect: {
+                    DrawArraysIndirectCmd* draw = mIterator.NextCommand<DrawArraysIndirectCmd>();
+                    if (!mState->ValidateCanDrawArraysIndirect(draw->indirectBuffer.Get(),
+                                                               draw->indirectOffset)) {
+                        return false;
+                    }
+                } break;
+
+                case Command::DrawElements: {
+                    mIterator.NextCommand<DrawElementsCmd>();
+                    if (!mState->ValidateCanDrawElements()) {
+                        return false;
+                    }
+                } break;
+
+                case Command::DrawElementsIndirect: {
+                    DrawElementsIndirectCmd* draw =
+                        mIterator.NextCommand<DrawElementsIndirectCmd>();
+                    if (!mState->ValidateCanDrawElementsIndirect(draw->indirectBuffer.Get(),
+                                                                 draw->indirectOffset)) {
+                        return false;
+                    }
+                } break;
+
+                case Command::MultiDrawArrays: {
+                    MultiDrawArraysCmd* cmd = mIterator.NextCommand<MultiDrawArraysCmd>();
+                    SkipMultiDrawParameters(&mIterator, cmd->drawCount);
+                    if (!mState->ValidateCanDrawArrays()) {
+                        return false;
+                    }
+                } break;
+
+                case Command::MultiDrawElements: {
+                    MultiDrawElementsCmd* cmd = mIterator.NextCommand<MultiDrawElementsCmd>();
+                    SkipMultiDrawParameters(&mIterator, cmd->drawCount);
+                    if (!mState->ValidateCanDrawElements()) {
+                        return false;
+                    }
+                } break;
+
+                case Command::SetBindGroup: {
+                    SetBindGroupCmd* cmd = mIterator.NextCommand<SetBindGroupCmd>();
+                    uint32_t* dynamicOffsets =
+                        mIterator.NextData<uint32_t>(cmd->dynamicOffsetCount);
+                    if (!mState->SetBindGroup(cmd->index, cmd->group.Get(),
+                                              cmd->dynamicOffsetCount, dynamicOffsets)) {
+                        return false;
+                    }
+                } break;
+
+                case Command::SetIndexBuffer: {
+                    SetIndexBufferCmd* cmd = mIterator.NextCommand<SetIndexBufferCmd>();
+                    if (!mState->SetIndexBuffer(cmd->buffer.Get(), cmd->offset)) {
+                        return false;
+                    }
+                } break;
+
+                case Command::SetPushConstants: {
+                    SetPushConstantsCmd* cmd = mIterator.NextCommand<SetPushConstantsCmd>();
+                    mIterator.NextData<uint32_t>(cmd->count);
+                    if (!mState->ValidateSetPushConstants(cmd->stages)) {
+                        return false;
+                    }
+                } break;
+
+                case Command::SetRenderPipeline: {
+                    SetRenderPipelineCmd* cmd = mIterator.NextCommand<SetRenderPipelineCmd>();
+                    if (!mState->SetRenderPipeline(cmd->pipeline.Get())) {
+                        return false;
+                    }
+                } break;
+
+                case Command::SetVertexBuffers: {
+                    SetVertexBuffersCmd* cmd = mIterator.NextCommand<SetVertexBuffersCmd>();
+                    auto buffers = mIterator.NextData<Ref<BufferBase>>(cmd->count);
+                    mIterator.NextData<uint32_t>(cmd->count);
+
+                    for (uint32_t i = 0; i < cmd->count; ++i) {
+                        if (!mState->SetVertexBuffer(cmd->startSlot + i, buffers[i].Get())) {
+                            return false;
+                        }
+                    }
+                } break;
+
+                default:
+                    // The builder only records commands that are allowed in render bundles.
+                    UNREACHABLE();
+            }
+        }
+
+        return true;
+    }
+
+    CommandIterator RenderBundleBuilder::AcquireCommands() {
+        ASSERT(!mWereCommandsAcquired);
+        mWereCommandsAcquired = true;
+        return std::move(mIterator);
+    }
+
+    RenderPassBase* RenderBundleBuilder::GetRenderPass() {
+        return mRenderPass.Get();
+    }
+
+    uint32_t RenderBundleBuilder::GetSubpass() const {
+        return mSubpass;
+    }
+
+    RenderBundleBase* RenderBundleBuilder::GetResultImpl() {
+        MoveToIterator();
+        return mDevice->CreateRenderBundle(this);
+    }
+
+    void RenderBundleBuilder::DrawArrays(uint32_t vertexCount,
+                                         uint32_t instanceCount,
+                                         uint32_t firstVertex,
+                                         uint32_t firstInstance) {
+        DrawArraysCmd* draw = mAllocator.Allocate<DrawArraysCmd>(Command::DrawArrays);
+        new (draw) DrawArraysCmd;
+        draw->vertexCount = vertexCount;
+        draw->instanceCount = instanceCount;
+        draw->firstVertex = firstVertex;
+        draw->firstInstance = firstInstance;
+    }
+
+    void RenderBundleBuilder::DrawArraysIndirect(BufferBase* indirectBuffer,
+                                                 uint32_t indirectOffset) {
+        DrawArraysIndirectCmd* draw =
+            mAllocator.Allocate<DrawArraysIndirectCmd>(Command::DrawArraysIndirect);
+        new (draw) DrawArraysIndirectCmd;
+        draw->indirectBuffer = indirectBuffer;
+        draw->indirectOffset = indirectOffset;
+    }
+
+    void RenderBundleBuilder::DrawElements(uint32_t indexCount,
+                                           uint32_t instanceCount,
+                                           uint32_t firstIndex,
+                                           uint32_t firstInstance) {
+        DrawElementsCmd* draw = mAllocator.Allocate<DrawElementsCmd>(Command::DrawElements);
+        new (draw) DrawElementsCmd;
+        draw->indexCount = indexCount;
+        draw->instanceCount = instanceCount;
+        draw->firstIndex = firstIndex;
+        draw->firstInstance = firstInstance;
+    }
+
+    void RenderBundleBuilder::DrawElementsIndirect(BufferBase* indirectBuffer,
+                                                   uint32_t indirectOffset) {
+        DrawElementsIndirectCmd* draw =
+            mAllocator.Allocate<DrawElementsIndirectCmd>(Command::DrawElementsIndirect);
+        new (draw) DrawElementsIndirectCmd;
+        draw->indirectBuffer = indirectBuffer;
+        draw->indirectOffset = indirectOffset;
+    }
+
+    void RenderBundleBuilder::MultiDrawArrays(uint32_t drawCount,
+                                              uint32_t const* vertexCounts,
+                                              uint32_t const* instanceCounts,
+                                              uint32_t const* firstVertices,
+                                              uint32_t const* firstInstances) {
+        MultiDrawArraysCmd* cmd = mAllocator.Allocate<MultiDrawArraysCmd>(Command::MultiDrawArrays);
+        new (cmd) MultiDrawArraysCmd;
+        cmd->drawCount = drawCount;
+
+        CopyMultiDrawParameters(&mAllocator, drawCount, vertexCounts);
+        CopyMultiDrawParameters(&mAllocator, drawCount, instanceCounts);
+        CopyMultiDrawParameters(&mAllocator, drawCount, firstVertices);
+        CopyMultiDrawParameters(&mAllocator, drawCount, firstInstances);
+    }
+
+    void RenderBundleBuilder::MultiDrawElements(uint32_t drawCount,
+                                                uint32_t const* indexCounts,
+                                                uint32_t const* instanceCounts,
+                                                uint32_t const* firstIndices,
+                                                uint32_t const* firstInstances) {
+        MultiDrawElementsCmd* cmd =
+            mAllocator.Allocate<MultiDrawElementsCmd>(Command::MultiDrawElements);
+        new (cmd) MultiDrawElementsCmd;
+        cmd->drawCount = drawCount;
+
+        CopyMultiDrawParameters(&mAllocator, drawCount, indexCounts);
+        CopyMultiDrawParameters(&mAllocator, drawCount, instanceCounts);
+        CopyMultiDrawParameters(&mAllocator, drawCount, firstIndices);
+        CopyMultiDrawParameters(&mAllocator, drawCount, firstInstances);
+    }
+
+    void RenderBundleBuilder::SetBindGroup(uint32_t groupIndex,
+                                           BindGroupBase* group,
+                                           uint32_t dynamicOffsetCount,
+                                           uint32_t const* dynamicOffsets) {
+        if (groupIndex >= kMaxBindGroups) {
+            HandleError("Setting bind group over the max");
+            return;
+        }
+
+        SetBindGroupCmd* cmd = mAllocator.Allocate<SetBindGroupCmd>(Command::SetBindGroup);
+        new (cmd) SetBindGroupCmd;
+        cmd->index = groupIndex;
+        cmd->group = group;
+        cmd->dynamicOffsetCount = dynamicOffsetCount;
+
+        uint32_t* offsets = mAllocator.AllocateData<uint32_t>(dynamicOffsetCount);
+        memcpy(offsets, dynamicOffsets, dynamicOffsetCount * sizeof(uint32_t));
+    }
+
+    void RenderBundleBuilder::SetIndexBuffer(BufferBase* buffer, uint32_t offset) {
+        SetIndexBufferCmd* cmd = mAllocator.Allocate<SetIndexBufferCmd>(Command::SetIndexBuffer);
+        new (cmd) SetIndexBufferCmd;
+        cmd->buffer = buffer;
+        cmd->offset = offset;
+    }
+
+    void RenderBundleBuilder::SetPushConstants(nxt::ShaderStageBit stages,
+                                               uint32_t offset,
+                                               uint32_t count,
+                                               const void* data) {
+        // Written so that offset + count can't overflow.
+        if (count > kMaxPushConstants || offset > kMaxPushConstants - count) {
+            HandleError("Setting too many push constants");
+            return;
+        }
+
+        SetPushConstantsCmd* cmd =
+            mAllocator.Allocate<SetPushConstantsCmd>(Command::SetPushConstants);
+        new (cmd) SetPushConstantsCmd;
+        cmd->stages = stages;
+        cmd->offset = offset;
+        cmd->count = count;
+
+        uint32_t* values = mAllocator.AllocateData<uint32_t>(count);
+        memcpy(values, data, count * sizeof(uint32_t));
+    }
+
+    void RenderBundleBuilder::SetRenderPipeline(RenderPipelineBase* pipeline) {
+        SetRenderPipelineCmd* cmd =
+            mAllocator.Allocate<SetRenderPipelineCmd>(Command::SetRenderPipeline);
+        new (cmd) SetRenderPipelineCmd;
+        cmd->pipeline = pipeline;
+    }
+
+    void RenderBundleBuilder::SetSubpass(RenderPassBase* renderPass, uint32_t subpass) {
+        mRenderPass = renderPass;
+        mSubpass = subpass;
+    }
+
+    void RenderBundleBuilder::SetVertexBuffers(uint32_t startSlot,
+                                               uint32_t count,
+                                               BufferBase* const* buffers,
+                                               uint32_t const* offsets) {
+        SetVertexBuffersCmd* cmd =
+            mAllocator.Allocate<SetVertexBuffersCmd>(Command::SetVertexBuffers);
+        new (cmd) SetVertexBuffersCmd;
+        cmd->startSlot = startSlot;
+        cmd->count = count;
+
+        Ref<BufferBase>* cmdBuffers = mAllocator.AllocateData<Ref<BufferBase>>(count);
+        for (size_t i = 0; i < count; ++i) {
+            new (&cmdBuffers[i]) Ref<BufferBase>(buffers[i]);
+        }
+
+        uint32_t* cmdOffsets = mAllocator.AllocateData<uint32_t>(count);
+        memcpy(cmdOffsets, offsets, count * sizeof(uint32_t));
+    }
+
+    void RenderBundleBuilder::MoveToIterator() {
+        if (!mWasMovedToIterator) {
+            mIterator = std::move(mAllocator);
+            mWasMovedToIterator = true;
+        }
+    }
+
+    // CommandBufferIterator
+
+    CommandBufferIterator::CommandBufferIterator(CommandIterator* commands)
+        : mCommands(commands), mCurrent(commands) {
+    }
+
+    bool CommandBufferIterator::NextCommandId(Command* commandId) {
+        while (true) {
+            if (mCurrent->NextCommandId(commandId)) {
+                if (mCurrent != mCommands || *commandId != Command::ExecuteBundles) {
+                    return true;
+                }
+
+                ExecuteBundlesCmd* cmd = mCommands->NextCommand<ExecuteBundlesCmd>();
+                mBundles = mCommands->NextData<Ref<RenderBundleBase>>(cmd->count);
+                mBundleCount = cmd->count;
+                mNextBundle = 0;
+            } else if (mCurrent == mCommands) {
+                return false;
+            }
+
+            // Either an ExecuteBundles command was just read or the current bundle is finished
+            // (its iterator reset itself). Continue with the next bundle or the command buffer.
+            if (mNextBundle < mBundleCount) {
+                mCurrent = mBundles[mNextBundle++]->GetCommands();
+            } else {
+                mCurrent = mCommands;
+            }
+        }
+    }
+
+    void CommandBufferIterator::SkipCommand(Command type) {
+        backend::SkipCommand(mCurrent, type);
+    }
+
+    void CommandBufferIterator::Reset() {
+        if (mCurrent != mCommands) {
+            mCurrent->Reset();
+        }
+        mCommands->Reset();
+        mCurrent = mCommands;
+        mBundleCount = 0;
+        mNextBundle = 0;
+    }
+
+}  // namespace backend
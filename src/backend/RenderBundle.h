@@ -0,0 +1,160 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BACKEND_RENDERBUNDLE_H_
+#define BACKEND_RENDERBUNDLE_H_
+
+#include "backend/Builder.h"
+#include "backend/CommandAllocator.h"
+#include "backend/Commands.h"
+#include "backend/Forward.h"
+#include "backend/RefCounted.h"
+
+#include "nxt/nxtcpp.h"
+
+#include <memory>
+#include <type_traits>
+
+namespace backend {
+
+    class CommandBufferStateTracker;
+
+    // A render bundle is a list of render subpass commands that is validated once against a
+    // render pass and subpass when it is built, and can then be executed in any compatible subpass
+    // without being recorded or validated again.
+    class RenderBundleBase : public RefCounted {
+      public:
+        RenderBundleBase(RenderBundleBuilder* builder);
+        ~RenderBundleBase();
+
+        RenderPassBase* GetRenderPass();
+        uint32_t GetSubpass() const;
+
+        // The commands use the same encoding as the commands of command buffers.
+        CommandIterator* GetCommands();
+
+      private:
+        Ref<RenderPassBase> mRenderPass;
+        uint32_t mSubpass;
+        CommandIterator mCommands;
+    };
+
+    class RenderBundleBuilder : public Builder<RenderBundleBase> {
+      public:
+        RenderBundleBuilder(DeviceBase* device);
+        ~RenderBundleBuilder();
+
+        bool ValidateGetResult();
+
+        CommandIterator AcquireCommands();
+        RenderPassBase* GetRenderPass();
+        uint32_t GetSubpass() const;
+
+        // NXT API
+        void DrawArrays(uint32_t vertexCount,
+                        uint32_t instanceCount,
+                        uint32_t firstVertex,
+                        uint32_t firstInstance);
+        void DrawArraysIndirect(BufferBase* indirectBuffer, uint32_t indirectOffset);
+        void DrawElements(uint32_t indexCount,
+                          uint32_t instanceCount,
+                          uint32_t firstIndex,
+                          uint32_t firstInstance);
+        void DrawElementsIndirect(BufferBase* indirectBuffer, uint32_t indirectOffset);
+        void MultiDrawArrays(uint32_t drawCount,
+                             uint32_t const* vertexCounts,
+                             uint32_t const* instanceCounts,
+                             uint32_t const* firstVertices,
+                             uint32_t const* firstInstances);
+        void MultiDrawElements(uint32_t drawCount,
+                               uint32_t const* indexCounts,
+                               uint32_t const* instanceCounts,
+                               uint32_t const* firstIndices,
+                               uint32_t const* firstInstances);
+        void SetBindGroup(uint32_t groupIndex,
+                          BindGroupBase* group,
+                          uint32_t dynamicOffsetCount,
+                          uint32_t const* dynamicOffsets);
+        void SetIndexBuffer(BufferBase* buffer, uint32_t offset);
+        void SetPushConstants(nxt::ShaderStageBit stages,
+                              uint32_t offset,
+                              uint32_t count,
+                              const void* data);
+        void SetRenderPipeline(RenderPipelineBase* pipeline);
+        void SetSubpass(RenderPassBase* renderPass, uint32_t subpass);
+
+        template <typename T>
+        void SetVertexBuffers(uint32_t startSlot,
+                              uint32_t count,
+                              T* const* buffers,
+                              uint32_t const* offsets) {
+            static_assert(std::is_base_of<BufferBase, T>::value, "");
+            SetVertexBuffers(startSlot, count, reinterpret_cast<BufferBase* const*>(buffers),
+                             offsets);
+        }
+        void SetVertexBuffers(uint32_t startSlot,
+                              uint32_t count,
+                              BufferBase* const* buffers,
+                              uint32_t const* offsets);
+
+      private:
+        friend class RenderBundleBase;
+
+        RenderBundleBase* GetResultImpl() override;
+        void MoveToIterator();
+
+        std::unique_ptr<CommandBufferStateTracker> mState;
+        CommandAllocator mAllocator;
+        CommandIterator mIterator;
+        bool mWasMovedToIterator = false;
+        bool mWereCommandsAcquired = false;
+
+        Ref<RenderPassBase> mRenderPass;
+        uint32_t mSubpass = 0;
+    };
+
+    // Iterates over the commands of a command buffer like a CommandIterator, except that the
+    // ExecuteBundles commands are replaced by the commands of the bundles they execute. This lets
+    // backends replay bundles with the same code they use for the commands of the command buffer.
+    class CommandBufferIterator {
+      public:
+        CommandBufferIterator(CommandIterator* commands);
+
+        bool NextCommandId(Command* commandId);
+        template <typename T>
+        T* NextCommand() {
+            return mCurrent->NextCommand<T>();
+        }
+        template <typename T>
+        T* NextData(size_t count) {
+            return mCurrent->NextData<T>(count);
+        }
+        void SkipCommand(Command type);
+
+        // Needs to be called if iteration was stopped early.
+        void Reset();
+
+      private:
+        CommandIterator* mCommands;
+        CommandIterator* mCurrent;
+
+        // The bundles of the last ExecuteBundles command.
+        Ref<RenderBundleBase>* mBundles = nullptr;
+        uint32_t mBundleCount = 0;
+        uint32_t mNextBundle = 0;
+    };
+
+}  // namespace backend
+
+#endif  // BACKEND_RENDERBUNDLE_H_
@@ -207,7 +207,7 @@ namespace backend {
                 continue;
             }
 
-            if (moduleInfo.type != layoutInfo.types[i]) {
+            if (moduleInfo.type != GetShaderBindingType(layoutInfo.types[i])) {
                 return false;
             }
             if ((layoutInfo.visibilities[i] & StageBit(mExecutionModel)) == 0) {
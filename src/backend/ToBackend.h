@@ -68,6 +68,11 @@ namespace backend {
         using BackendType = typename BackendTraits::DeviceType;
     };
 
+    template <typename BackendTraits>
+    struct ToBackendTraits<FenceBase, BackendTraits> {
+        using BackendType = typename BackendTraits::FenceType;
+    };
+
     template <typename BackendTraits>
     struct ToBackendTraits<FramebufferBase, BackendTraits> {
         using BackendType = typename BackendTraits::FramebufferType;
@@ -83,11 +88,21 @@ namespace backend {
         using BackendType = typename BackendTraits::PipelineLayoutType;
     };
 
+    template <typename BackendTraits>
+    struct ToBackendTraits<QuerySetBase, BackendTraits> {
+        using BackendType = typename BackendTraits::QuerySetType;
+    };
+
     template <typename BackendTraits>
     struct ToBackendTraits<QueueBase, BackendTraits> {
         using BackendType = typename BackendTraits::QueueType;
     };
 
+    template <typename BackendTraits>
+    struct ToBackendTraits<RenderBundleBase, BackendTraits> {
+        using BackendType = typename BackendTraits::RenderBundleType;
+    };
+
     template <typename BackendTraits>
     struct ToBackendTraits<RenderPassBase, BackendTraits> {
         using BackendType = typename BackendTraits::RenderPassType;
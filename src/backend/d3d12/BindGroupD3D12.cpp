@@ -31,7 +31,8 @@ namespace backend { namespace d3d12 {
                                       uint32_t* cbvUavSrvHeapOffset,
                                       const DescriptorHeapHandle& samplerHeapStart,
                                       uint32_t* samplerHeapOffset,
-                                      uint64_t serial) {
+                                      uint64_t serial,
+                                      const uint32_t* dynamicOffsets) {
         mHeapSerial = serial;
 
         const auto* bgl = ToBackend(GetLayout());
@@ -44,6 +45,7 @@ namespace backend { namespace d3d12 {
         const auto& bindingOffsets = bgl->GetBindingOffsets();
 
         auto d3d12Device = mDevice->GetD3D12Device();
+        uint32_t dynamicOffsetIndex = 0;
         for (uint32_t binding : IterateBitSet(layout.mask)) {
             switch (layout.types[binding]) {
                 case nxt::BindingType::UniformBuffer: {
@@ -53,6 +55,14 @@ namespace backend { namespace d3d12 {
                         &cbv, cbvUavSrvHeapStart.GetCPUHandle(*cbvUavSrvHeapOffset +
                                                               bindingOffsets[binding]));
                 } break;
+                case nxt::BindingType::DynamicUniformBuffer: {
+                    auto* view = ToBackend(GetBindingAsBufferView(binding));
+                    D3D12_CONSTANT_BUFFER_VIEW_DESC cbv = view->GetCBVDescriptor();
+                    cbv.BufferLocation += dynamicOffsets[dynamicOffsetIndex++];
+                    d3d12Device->CreateConstantBufferView(
+                        &cbv, cbvUavSrvHeapStart.GetCPUHandle(*cbvUavSrvHeapOffset +
+                                                              bindingOffsets[binding]));
+                } break;
                 case nxt::BindingType::StorageBuffer: {
                     auto* view = ToBackend(GetBindingAsBufferView(binding));
                     auto& uav = view->GetUAVDescriptor();
@@ -61,6 +71,16 @@ namespace backend { namespace d3d12 {
                         cbvUavSrvHeapStart.GetCPUHandle(*cbvUavSrvHeapOffset +
                                                         bindingOffsets[binding]));
                 } break;
+                case nxt::BindingType::DynamicStorageBuffer: {
+                    auto* view = ToBackend(GetBindingAsBufferView(binding));
+                    // The UAV elements are bytes so the offset can be added directly.
+                    D3D12_UNORDERED_ACCESS_VIEW_DESC uav = view->GetUAVDescriptor();
+                    uav.Buffer.FirstElement += dynamicOffsets[dynamicOffsetIndex++];
+                    d3d12Device->CreateUnorderedAccessView(
+                        ToBackend(view->GetBuffer())->GetD3D12Resource().Get(), nullptr, &uav,
+                        cbvUavSrvHeapStart.GetCPUHandle(*cbvUavSrvHeapOffset +
+                                                        bindingOffsets[binding]));
+                } break;
                 case nxt::BindingType::SampledTexture: {
                     auto* view = ToBackend(GetBindingAsTextureView(binding));
                     auto& srv = view->GetSRVDescriptor();
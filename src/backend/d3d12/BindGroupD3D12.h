@@ -29,11 +29,14 @@ namespace backend { namespace d3d12 {
       public:
         BindGroup(Device* device, BindGroupBuilder* builder);
 
+        // The descriptors of dynamic buffers include their dynamic offsets, so they are recorded
+        // each time the bind group is set.
         void RecordDescriptors(const DescriptorHeapHandle& cbvSrvUavHeapStart,
                                uint32_t* cbvUavSrvHeapOffset,
                                const DescriptorHeapHandle& samplerHeapStart,
                                uint32_t* samplerHeapOffset,
-                               uint64_t serial);
+                               uint64_t serial,
+                               const uint32_t* dynamicOffsets);
         uint32_t GetCbvUavSrvHeapOffset() const;
         uint32_t GetSamplerHeapOffset() const;
         uint64_t GetHeapSerial() const;
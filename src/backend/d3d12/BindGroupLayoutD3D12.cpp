@@ -26,9 +26,11 @@ namespace backend { namespace d3d12 {
         for (uint32_t binding : IterateBitSet(groupInfo.mask)) {
             switch (groupInfo.types[binding]) {
                 case nxt::BindingType::UniformBuffer:
+                case nxt::BindingType::DynamicUniformBuffer:
                     mBindingOffsets[binding] = mDescriptorCounts[CBV]++;
                     break;
                 case nxt::BindingType::StorageBuffer:
+                case nxt::BindingType::DynamicStorageBuffer:
                     mBindingOffsets[binding] = mDescriptorCounts[UAV]++;
                     break;
                 case nxt::BindingType::SampledTexture:
@@ -85,9 +87,11 @@ namespace backend { namespace d3d12 {
         for (uint32_t binding : IterateBitSet(groupInfo.mask)) {
             switch (groupInfo.types[binding]) {
                 case nxt::BindingType::UniformBuffer:
+                case nxt::BindingType::DynamicUniformBuffer:
                     mBindingOffsets[binding] += descriptorOffsets[CBV];
                     break;
                 case nxt::BindingType::StorageBuffer:
+                case nxt::BindingType::DynamicStorageBuffer:
                     mBindingOffsets[binding] += descriptorOffsets[UAV];
                     break;
                 case nxt::BindingType::SampledTexture:
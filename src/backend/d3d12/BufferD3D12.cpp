@@ -52,6 +52,9 @@ namespace backend { namespace d3d12 {
             if (usage & nxt::BufferUsageBit::Storage) {
                 resourceState |= D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
             }
+            if (usage & nxt::BufferUsageBit::Indirect) {
+                resourceState |= D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT;
+            }
 
             return resourceState;
         }
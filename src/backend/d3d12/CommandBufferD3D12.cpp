@@ -15,6 +15,7 @@
 #include "backend/d3d12/CommandBufferD3D12.h"
 
 #include "backend/Commands.h"
+#include "backend/RenderBundle.h"
 #include "backend/d3d12/BindGroupD3D12.h"
 #include "backend/d3d12/BindGroupLayoutD3D12.h"
 #include "backend/d3d12/BufferD3D12.h"
@@ -31,6 +32,8 @@
 #include "backend/d3d12/TextureD3D12.h"
 #include "common/Assert.h"
 
+#include <vector>
+
 namespace backend { namespace d3d12 {
 
     namespace {
@@ -53,8 +56,14 @@ namespace backend { namespace d3d12 {
             DescriptorHeapHandle cbvSrvUavGPUDescriptorHeap = {};
             DescriptorHeapHandle samplerGPUDescriptorHeap = {};
             std::array<BindGroup*, kMaxBindGroups> bindGroups = {};
+            std::array<uint32_t, kMaxBindGroups> cbvUavSrvHeapOffsets = {};
             bool inCompute = false;
 
+            // Bind groups with dynamic buffers get new descriptors each time they are set. These
+            // are their offsets in the heap, in the order of the SetBindGroup commands.
+            std::vector<uint32_t> dynamicGroupHeapOffsets;
+            size_t nextDynamicGroup = 0;
+
             Device* device;
 
             BindGroupStateTracker(Device* device) : device(device) {
@@ -64,7 +73,18 @@ namespace backend { namespace d3d12 {
                 inCompute = inCompute_;
             }
 
-            void TrackSetBindGroup(BindGroup* group, uint32_t index) {
+            void TrackSetBindGroup(BindGroup* group,
+                                   uint32_t index,
+                                   const uint32_t* dynamicOffsets = nullptr) {
+                if (group->GetLayout()->GetDynamicBufferCount() > 0) {
+                    bindGroups[index] = group;
+                    group->RecordDescriptors(cbvSrvUavCPUDescriptorHeap, &cbvSrvUavDescriptorIndex,
+                                             samplerCPUDescriptorHeap, &samplerDescriptorIndex,
+                                             device->GetSerial(), dynamicOffsets);
+                    dynamicGroupHeapOffsets.push_back(group->GetCbvUavSrvHeapOffset());
+                    return;
+                }
+
                 if (bindGroups[index] != group) {
                     bindGroups[index] = group;
 
@@ -74,7 +94,7 @@ namespace backend { namespace d3d12 {
                     if (group->GetHeapSerial() != serial) {
                         group->RecordDescriptors(
                             cbvSrvUavCPUDescriptorHeap, &cbvSrvUavDescriptorIndex,
-                            samplerCPUDescriptorHeap, &samplerDescriptorIndex, serial);
+                            samplerCPUDescriptorHeap, &samplerDescriptorIndex, serial, nullptr);
                     }
                 }
             }
@@ -86,7 +106,11 @@ namespace backend { namespace d3d12 {
 
                 uint32_t inheritUntil = oldLayout->GroupsInheritUpTo(newLayout);
                 for (uint32_t i = 0; i < inheritUntil; ++i) {
-                    TrackSetBindGroup(bindGroups[i], i);
+                    // Inherited groups with dynamic buffers keep the descriptors recorded when
+                    // they were set.
+                    if (bindGroups[i]->GetLayout()->GetDynamicBufferCount() == 0) {
+                        TrackSetBindGroup(bindGroups[i], i);
+                    }
                 }
             }
 
@@ -95,9 +119,20 @@ namespace backend { namespace d3d12 {
                               BindGroup* group,
                               uint32_t index,
                               bool force = false) {
-                if (bindGroups[index] != group || force) {
+                bool hasDynamicBuffers = group->GetLayout()->GetDynamicBufferCount() > 0;
+                if (bindGroups[index] != group || hasDynamicBuffers || force) {
                     bindGroups[index] = group;
 
+                    // Inherited groups are set again with the descriptors they were set with.
+                    if (!force) {
+                        if (hasDynamicBuffers) {
+                            cbvUavSrvHeapOffsets[index] =
+                                dynamicGroupHeapOffsets[nextDynamicGroup++];
+                        } else {
+                            cbvUavSrvHeapOffsets[index] = group->GetCbvUavSrvHeapOffset();
+                        }
+                    }
+
                     uint32_t cbvUavSrvCount =
                         ToBackend(group->GetLayout())->GetCbvUavSrvDescriptorCount();
                     uint32_t samplerCount =
@@ -110,11 +145,11 @@ namespace backend { namespace d3d12 {
                         if (inCompute) {
                             commandList->SetComputeRootDescriptorTable(
                                 parameterIndex, cbvSrvUavGPUDescriptorHeap.GetGPUHandle(
-                                                    group->GetCbvUavSrvHeapOffset()));
+                                                    cbvUavSrvHeapOffsets[index]));
                         } else {
                             commandList->SetGraphicsRootDescriptorTable(
                                 parameterIndex, cbvSrvUavGPUDescriptorHeap.GetGPUHandle(
-                                                    group->GetCbvUavSrvHeapOffset()));
+                                                    cbvUavSrvHeapOffsets[index]));
                         }
                     }
 
@@ -157,7 +192,7 @@ namespace backend { namespace d3d12 {
 
         void AllocateAndSetDescriptorHeaps(Device* device,
                                            BindGroupStateTracker* bindingTracker,
-                                           CommandIterator* commands) {
+                                           CommandBufferIterator* commands) {
             auto* descriptorHeapAllocator = device->GetDescriptorHeapAllocator();
 
             // TODO(enga@google.com): This currently allocates CPU heaps of arbitrarily chosen sizes
@@ -191,11 +226,13 @@ namespace backend { namespace d3d12 {
 
                         case Command::SetBindGroup: {
                             SetBindGroupCmd* cmd = commands->NextCommand<SetBindGroupCmd>();
+                            uint32_t* dynamicOffsets =
+                                commands->NextData<uint32_t>(cmd->dynamicOffsetCount);
                             BindGroup* group = ToBackend(cmd->group.Get());
-                            bindingTracker->TrackSetBindGroup(group, cmd->index);
+                            bindingTracker->TrackSetBindGroup(group, cmd->index, dynamicOffsets);
                         } break;
                         default:
-                            SkipCommand(commands, type);
+                            commands->SkipCommand(type);
                     }
                 }
 
@@ -237,8 +274,10 @@ namespace backend { namespace d3d12 {
     }
 
     void CommandBuffer::FillCommands(ComPtr<ID3D12GraphicsCommandList> commandList) {
+        CommandBufferIterator commands(&mCommands);
+
         BindGroupStateTracker bindingTracker(mDevice);
-        AllocateAndSetDescriptorHeaps(mDevice, &bindingTracker, &mCommands);
+        AllocateAndSetDescriptorHeaps(mDevice, &bindingTracker, &commands);
         bindingTracker.Reset();
 
         ID3D12DescriptorHeap* descriptorHeaps[2] = {bindingTracker.cbvSrvUavGPUDescriptorHeap.Get(),
@@ -259,16 +298,21 @@ namespace backend { namespace d3d12 {
         Framebuffer* currentFramebuffer = nullptr;
         uint32_t currentSubpass = 0;
 
-        while (mCommands.NextCommandId(&type)) {
+        while (commands.NextCommandId(&type)) {
             switch (type) {
                 case Command::BeginComputePass: {
-                    mCommands.NextCommand<BeginComputePassCmd>();
+                    commands.NextCommand<BeginComputePassCmd>();
                     bindingTracker.SetInComputePass(true);
                 } break;
 
+                case Command::BeginQuery:
+                    // Query sets can't be created on this backend.
+                    UNREACHABLE();
+                    break;
+
                 case Command::BeginRenderPass: {
                     BeginRenderPassCmd* beginRenderPassCmd =
-                        mCommands.NextCommand<BeginRenderPassCmd>();
+                        commands.NextCommand<BeginRenderPassCmd>();
                     currentRenderPass = ToBackend(beginRenderPassCmd->renderPass.Get());
                     currentFramebuffer = ToBackend(beginRenderPassCmd->framebuffer.Get());
                     currentSubpass = 0;
@@ -284,7 +328,7 @@ namespace backend { namespace d3d12 {
                 } break;
 
                 case Command::BeginRenderSubpass: {
-                    mCommands.NextCommand<BeginRenderSubpassCmd>();
+                    commands.NextCommand<BeginRenderSubpassCmd>();
                     const auto& subpass = currentRenderPass->GetSubpassInfo(currentSubpass);
 
                     Framebuffer::OMSetRenderTargetArgs args =
@@ -365,7 +409,7 @@ namespace backend { namespace d3d12 {
                 } break;
 
                 case Command::CopyBufferToBuffer: {
-                    CopyBufferToBufferCmd* copy = mCommands.NextCommand<CopyBufferToBufferCmd>();
+                    CopyBufferToBufferCmd* copy = commands.NextCommand<CopyBufferToBufferCmd>();
                     auto src = ToBackend(copy->source.buffer.Get())->GetD3D12Resource();
                     auto dst = ToBackend(copy->destination.buffer.Get())->GetD3D12Resource();
                     commandList->CopyBufferRegion(dst.Get(), copy->destination.offset, src.Get(),
@@ -373,7 +417,7 @@ namespace backend { namespace d3d12 {
                 } break;
 
                 case Command::CopyBufferToTexture: {
-                    CopyBufferToTextureCmd* copy = mCommands.NextCommand<CopyBufferToTextureCmd>();
+                    CopyBufferToTextureCmd* copy = commands.NextCommand<CopyBufferToTextureCmd>();
                     Buffer* buffer = ToBackend(copy->source.buffer.Get());
                     Texture* texture = ToBackend(copy->destination.texture.Get());
 
@@ -416,7 +460,7 @@ namespace backend { namespace d3d12 {
                 } break;
 
                 case Command::CopyTextureToBuffer: {
-                    CopyTextureToBufferCmd* copy = mCommands.NextCommand<CopyTextureToBufferCmd>();
+                    CopyTextureToBufferCmd* copy = commands.NextCommand<CopyTextureToBufferCmd>();
                     Texture* texture = ToBackend(copy->source.texture.Get());
                     Buffer* buffer = ToBackend(copy->destination.buffer.Get());
 
@@ -459,39 +503,100 @@ namespace backend { namespace d3d12 {
                 } break;
 
                 case Command::Dispatch: {
-                    DispatchCmd* dispatch = mCommands.NextCommand<DispatchCmd>();
+                    DispatchCmd* dispatch = commands.NextCommand<DispatchCmd>();
                     commandList->Dispatch(dispatch->x, dispatch->y, dispatch->z);
                 } break;
 
+                case Command::DispatchIndirect: {
+                    DispatchIndirectCmd* dispatch = commands.NextCommand<DispatchIndirectCmd>();
+                    Buffer* buffer = ToBackend(dispatch->indirectBuffer.Get());
+                    commandList->ExecuteIndirect(mDevice->GetDispatchIndirectSignature().Get(), 1,
+                                                 buffer->GetD3D12Resource().Get(),
+                                                 dispatch->indirectOffset, nullptr, 0);
+                } break;
+
                 case Command::DrawArrays: {
-                    DrawArraysCmd* draw = mCommands.NextCommand<DrawArraysCmd>();
+                    DrawArraysCmd* draw = commands.NextCommand<DrawArraysCmd>();
                     commandList->DrawInstanced(draw->vertexCount, draw->instanceCount,
                                                draw->firstVertex, draw->firstInstance);
                 } break;
 
+                case Command::DrawArraysIndirect: {
+                    DrawArraysIndirectCmd* draw = commands.NextCommand<DrawArraysIndirectCmd>();
+                    Buffer* buffer = ToBackend(draw->indirectBuffer.Get());
+                    commandList->ExecuteIndirect(mDevice->GetDrawIndirectSignature().Get(), 1,
+                                                 buffer->GetD3D12Resource().Get(),
+                                                 draw->indirectOffset, nullptr, 0);
+                } break;
+
                 case Command::DrawElements: {
-                    DrawElementsCmd* draw = mCommands.NextCommand<DrawElementsCmd>();
+                    DrawElementsCmd* draw = commands.NextCommand<DrawElementsCmd>();
 
                     commandList->DrawIndexedInstanced(draw->indexCount, draw->instanceCount,
                                                       draw->firstIndex, 0, draw->firstInstance);
                 } break;
 
+                case Command::DrawElementsIndirect: {
+                    DrawElementsIndirectCmd* draw =
+                        commands.NextCommand<DrawElementsIndirectCmd>();
+                    Buffer* buffer = ToBackend(draw->indirectBuffer.Get());
+                    commandList->ExecuteIndirect(mDevice->GetDrawIndexedIndirectSignature().Get(),
+                                                 1, buffer->GetD3D12Resource().Get(),
+                                                 draw->indirectOffset, nullptr, 0);
+                } break;
+
                 case Command::EndComputePass: {
-                    mCommands.NextCommand<EndComputePassCmd>();
+                    commands.NextCommand<EndComputePassCmd>();
                     bindingTracker.SetInComputePass(false);
                 } break;
 
+                case Command::EndQuery:
+                    // Query sets can't be created on this backend.
+                    UNREACHABLE();
+                    break;
+
                 case Command::EndRenderPass: {
-                    mCommands.NextCommand<EndRenderPassCmd>();
+                    commands.NextCommand<EndRenderPassCmd>();
                 } break;
 
                 case Command::EndRenderSubpass: {
-                    mCommands.NextCommand<EndRenderSubpassCmd>();
+                    commands.NextCommand<EndRenderSubpassCmd>();
                     currentSubpass += 1;
                 } break;
 
+                case Command::MultiDrawArrays: {
+                    MultiDrawArraysCmd* draw = commands.NextCommand<MultiDrawArraysCmd>();
+                    uint32_t* vertexCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* instanceCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstVertices = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstInstances = commands.NextData<uint32_t>(draw->drawCount);
+
+                    for (uint32_t i = 0; i < draw->drawCount; ++i) {
+                        commandList->DrawInstanced(vertexCounts[i], instanceCounts[i],
+                                                   firstVertices[i], firstInstances[i]);
+                    }
+                } break;
+
+                case Command::MultiDrawElements: {
+                    MultiDrawElementsCmd* draw = commands.NextCommand<MultiDrawElementsCmd>();
+                    uint32_t* indexCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* instanceCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstIndices = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstInstances = commands.NextData<uint32_t>(draw->drawCount);
+
+                    for (uint32_t i = 0; i < draw->drawCount; ++i) {
+                        commandList->DrawIndexedInstanced(indexCounts[i], instanceCounts[i],
+                                                          firstIndices[i], 0, firstInstances[i]);
+                    }
+                } break;
+
+                case Command::ResolveQuerySet:
+                    // Query sets can't be created on this backend.
+                    UNREACHABLE();
+                    break;
+
                 case Command::SetComputePipeline: {
-                    SetComputePipelineCmd* cmd = mCommands.NextCommand<SetComputePipelineCmd>();
+                    SetComputePipelineCmd* cmd = commands.NextCommand<SetComputePipelineCmd>();
                     ComputePipeline* pipeline = ToBackend(cmd->pipeline).Get();
                     PipelineLayout* layout = ToBackend(pipeline->GetLayout());
 
@@ -504,7 +609,7 @@ namespace backend { namespace d3d12 {
                 } break;
 
                 case Command::SetRenderPipeline: {
-                    SetRenderPipelineCmd* cmd = mCommands.NextCommand<SetRenderPipelineCmd>();
+                    SetRenderPipelineCmd* cmd = commands.NextCommand<SetRenderPipelineCmd>();
                     RenderPipeline* pipeline = ToBackend(cmd->pipeline).Get();
                     PipelineLayout* layout = ToBackend(pipeline->GetLayout());
 
@@ -519,29 +624,30 @@ namespace backend { namespace d3d12 {
                 } break;
 
                 case Command::SetPushConstants: {
-                    mCommands.NextCommand<SetPushConstantsCmd>();
+                    commands.NextCommand<SetPushConstantsCmd>();
                 } break;
 
                 case Command::SetStencilReference: {
-                    SetStencilReferenceCmd* cmd = mCommands.NextCommand<SetStencilReferenceCmd>();
+                    SetStencilReferenceCmd* cmd = commands.NextCommand<SetStencilReferenceCmd>();
 
                     commandList->OMSetStencilRef(cmd->reference);
                 } break;
 
                 case Command::SetBlendColor: {
-                    SetBlendColorCmd* cmd = mCommands.NextCommand<SetBlendColorCmd>();
+                    SetBlendColorCmd* cmd = commands.NextCommand<SetBlendColorCmd>();
                     ASSERT(lastRenderPipeline);
                     commandList->OMSetBlendFactor(static_cast<const FLOAT*>(&cmd->r));
                 } break;
 
                 case Command::SetBindGroup: {
-                    SetBindGroupCmd* cmd = mCommands.NextCommand<SetBindGroupCmd>();
+                    SetBindGroupCmd* cmd = commands.NextCommand<SetBindGroupCmd>();
+                    commands.NextData<uint32_t>(cmd->dynamicOffsetCount);
                     BindGroup* group = ToBackend(cmd->group.Get());
                     bindingTracker.SetBindGroup(commandList, lastLayout, group, cmd->index);
                 } break;
 
                 case Command::SetIndexBuffer: {
-                    SetIndexBufferCmd* cmd = mCommands.NextCommand<SetIndexBufferCmd>();
+                    SetIndexBufferCmd* cmd = commands.NextCommand<SetIndexBufferCmd>();
 
                     Buffer* buffer = ToBackend(cmd->buffer.Get());
                     D3D12_INDEX_BUFFER_VIEW bufferView;
@@ -556,9 +662,9 @@ namespace backend { namespace d3d12 {
                 } break;
 
                 case Command::SetVertexBuffers: {
-                    SetVertexBuffersCmd* cmd = mCommands.NextCommand<SetVertexBuffersCmd>();
-                    auto buffers = mCommands.NextData<Ref<BufferBase>>(cmd->count);
-                    auto offsets = mCommands.NextData<uint32_t>(cmd->count);
+                    SetVertexBuffersCmd* cmd = commands.NextCommand<SetVertexBuffersCmd>();
+                    auto buffers = commands.NextData<Ref<BufferBase>>(cmd->count);
+                    auto offsets = commands.NextData<uint32_t>(cmd->count);
 
                     auto inputState = ToBackend(lastRenderPipeline->GetInputState());
 
@@ -575,9 +681,14 @@ namespace backend { namespace d3d12 {
                                                     d3d12BufferViews.data());
                 } break;
 
+                case Command::ExecuteBundles:
+                    // The iterator replaces bundles with their commands.
+                    UNREACHABLE();
+                    break;
+
                 case Command::TransitionBufferUsage: {
                     TransitionBufferUsageCmd* cmd =
-                        mCommands.NextCommand<TransitionBufferUsageCmd>();
+                        commands.NextCommand<TransitionBufferUsageCmd>();
 
                     Buffer* buffer = ToBackend(cmd->buffer.Get());
 
@@ -592,7 +703,7 @@ namespace backend { namespace d3d12 {
 
                 case Command::TransitionTextureUsage: {
                     TransitionTextureUsageCmd* cmd =
-                        mCommands.NextCommand<TransitionTextureUsageCmd>();
+                        commands.NextCommand<TransitionTextureUsageCmd>();
 
                     Texture* texture = ToBackend(cmd->texture.Get());
 
@@ -604,6 +715,11 @@ namespace backend { namespace d3d12 {
 
                     texture->UpdateUsageInternal(cmd->usage);
                 } break;
+
+                case Command::WriteTimestamp:
+                    // Query sets can't be created on this backend.
+                    UNREACHABLE();
+                    break;
             }
         }
     }
@@ -82,6 +82,27 @@ namespace backend { namespace d3d12 {
         ASSERT(SUCCEEDED(hr));
     }
 
+    namespace {
+        // The signatures don't change any root argument so they don't need a root signature.
+        ComPtr<ID3D12CommandSignature> CreateIndirectSignature(
+            ComPtr<ID3D12Device> d3d12Device,
+            D3D12_INDIRECT_ARGUMENT_TYPE type,
+            uint32_t byteStride) {
+            D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = {};
+            argumentDesc.Type = type;
+
+            D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {};
+            signatureDesc.ByteStride = byteStride;
+            signatureDesc.NumArgumentDescs = 1;
+            signatureDesc.pArgumentDescs = &argumentDesc;
+
+            ComPtr<ID3D12CommandSignature> signature;
+            ASSERT_SUCCESS(d3d12Device->CreateCommandSignature(&signatureDesc, nullptr,
+                                                               IID_PPV_ARGS(&signature)));
+            return signature;
+        }
+    }  // anonymous namespace
+
     Device::Device(ComPtr<ID3D12Device> d3d12Device)
         : mD3d12Device(d3d12Device),
           mCommandAllocatorManager(new CommandAllocatorManager(this)),
@@ -99,6 +120,14 @@ namespace backend { namespace d3d12 {
         mFenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
         ASSERT(mFenceEvent != nullptr);
 
+        mDispatchIndirectSignature = CreateIndirectSignature(
+            d3d12Device, D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH, sizeof(D3D12_DISPATCH_ARGUMENTS));
+        mDrawIndirectSignature = CreateIndirectSignature(
+            d3d12Device, D3D12_INDIRECT_ARGUMENT_TYPE_DRAW, sizeof(D3D12_DRAW_ARGUMENTS));
+        mDrawIndexedIndirectSignature =
+            CreateIndirectSignature(d3d12Device, D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED,
+                                    sizeof(D3D12_DRAW_INDEXED_ARGUMENTS));
+
         NextSerial();
     }
 
@@ -126,6 +155,10 @@ namespace backend { namespace d3d12 {
         return mDescriptorHeapAllocator;
     }
 
+    FenceSignalTracker* Device::GetFenceSignalTracker() {
+        return &mFenceSignalTracker;
+    }
+
     MapReadRequestTracker* Device::GetMapReadRequestTracker() const {
         return mMapReadRequestTracker;
     }
@@ -134,6 +167,18 @@ namespace backend { namespace d3d12 {
         return mResourceAllocator;
     }
 
+    ComPtr<ID3D12CommandSignature> Device::GetDispatchIndirectSignature() {
+        return mDispatchIndirectSignature;
+    }
+
+    ComPtr<ID3D12CommandSignature> Device::GetDrawIndirectSignature() {
+        return mDrawIndirectSignature;
+    }
+
+    ComPtr<ID3D12CommandSignature> Device::GetDrawIndexedIndirectSignature() {
+        return mDrawIndexedIndirectSignature;
+    }
+
     ResourceUploader* Device::GetResourceUploader() {
         return mResourceUploader;
     }
@@ -168,6 +213,7 @@ namespace backend { namespace d3d12 {
         mCommandAllocatorManager->Tick(lastCompletedSerial);
         mDescriptorHeapAllocator->Tick(lastCompletedSerial);
         mMapReadRequestTracker->Tick(lastCompletedSerial);
+        mFenceSignalTracker.Tick(lastCompletedSerial);
         ExecuteCommandLists({});
         NextSerial();
     }
@@ -238,9 +284,17 @@ namespace backend { namespace d3d12 {
     PipelineLayoutBase* Device::CreatePipelineLayout(PipelineLayoutBuilder* builder) {
         return new PipelineLayout(this, builder);
     }
+    QuerySetBase* Device::CreateQuerySet(QuerySetBuilder* builder) {
+        // Queries aren't implemented in this backend.
+        builder->HandleError("Query sets are not supported on this backend");
+        return nullptr;
+    }
     QueueBase* Device::CreateQueue(QueueBuilder* builder) {
         return new Queue(this, builder);
     }
+    RenderBundleBase* Device::CreateRenderBundle(RenderBundleBuilder* builder) {
+        return new RenderBundleBase(builder);
+    }
     RenderPassBase* Device::CreateRenderPass(RenderPassBuilder* builder) {
         return new RenderPass(this, builder);
     }
@@ -19,6 +19,9 @@
 
 #include "backend/DepthStencilState.h"
 #include "backend/Device.h"
+#include "backend/Fence.h"
+#include "backend/QuerySet.h"
+#include "backend/RenderBundle.h"
 #include "backend/RenderPass.h"
 #include "backend/ToBackend.h"
 
@@ -35,10 +38,13 @@ namespace backend { namespace d3d12 {
     class ComputePipeline;
     class DepthStencilState;
     class Device;
+    using Fence = FenceBase;
     class Framebuffer;
     class InputState;
     class PipelineLayout;
+    using QuerySet = QuerySetBase;
     class Queue;
+    using RenderBundle = RenderBundleBase;
     class RenderPass;
     class RenderPipeline;
     class Sampler;
@@ -63,10 +69,13 @@ namespace backend { namespace d3d12 {
         using ComputePipelineType = ComputePipeline;
         using DepthStencilStateType = DepthStencilState;
         using DeviceType = Device;
+        using FenceType = Fence;
         using FramebufferType = Framebuffer;
         using InputStateType = InputState;
         using PipelineLayoutType = PipelineLayout;
+        using QuerySetType = QuerySet;
         using QueueType = Queue;
+        using RenderBundleType = RenderBundle;
         using RenderPassType = RenderPass;
         using RenderPipelineType = RenderPipeline;
         using SamplerType = Sampler;
@@ -100,7 +109,9 @@ namespace backend { namespace d3d12 {
         FramebufferBase* CreateFramebuffer(FramebufferBuilder* builder) override;
         InputStateBase* CreateInputState(InputStateBuilder* builder) override;
         PipelineLayoutBase* CreatePipelineLayout(PipelineLayoutBuilder* builder) override;
+        QuerySetBase* CreateQuerySet(QuerySetBuilder* builder) override;
         QueueBase* CreateQueue(QueueBuilder* builder) override;
+        RenderBundleBase* CreateRenderBundle(RenderBundleBuilder* builder) override;
         RenderPassBase* CreateRenderPass(RenderPassBuilder* builder) override;
         RenderPipelineBase* CreateRenderPipeline(RenderPipelineBuilder* builder) override;
         SamplerBase* CreateSampler(SamplerBuilder* builder) override;
@@ -115,10 +126,15 @@ namespace backend { namespace d3d12 {
         ComPtr<ID3D12CommandQueue> GetCommandQueue();
 
         DescriptorHeapAllocator* GetDescriptorHeapAllocator();
+        FenceSignalTracker* GetFenceSignalTracker();
         MapReadRequestTracker* GetMapReadRequestTracker() const;
         ResourceAllocator* GetResourceAllocator();
         ResourceUploader* GetResourceUploader();
 
+        ComPtr<ID3D12CommandSignature> GetDispatchIndirectSignature();
+        ComPtr<ID3D12CommandSignature> GetDrawIndirectSignature();
+        ComPtr<ID3D12CommandSignature> GetDrawIndexedIndirectSignature();
+
         void OpenCommandList(ComPtr<ID3D12GraphicsCommandList>* commandList);
         ComPtr<ID3D12GraphicsCommandList> GetPendingCommandList();
 
@@ -138,10 +154,15 @@ namespace backend { namespace d3d12 {
 
         CommandAllocatorManager* mCommandAllocatorManager;
         DescriptorHeapAllocator* mDescriptorHeapAllocator;
+        FenceSignalTracker mFenceSignalTracker;
         MapReadRequestTracker* mMapReadRequestTracker;
         ResourceAllocator* mResourceAllocator;
         ResourceUploader* mResourceUploader;
 
+        ComPtr<ID3D12CommandSignature> mDispatchIndirectSignature;
+        ComPtr<ID3D12CommandSignature> mDrawIndirectSignature;
+        ComPtr<ID3D12CommandSignature> mDrawIndexedIndirectSignature;
+
         struct PendingCommandList {
             ComPtr<ID3D12GraphicsCommandList> commandList;
             bool open = false;
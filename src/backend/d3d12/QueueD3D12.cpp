@@ -36,4 +36,10 @@ namespace backend { namespace d3d12 {
         mDevice->NextSerial();
     }
 
+    void Queue::SignalImpl(FenceBase* fence, uint64_t signalValue) {
+        mDevice->GetFenceSignalTracker()->UpdateFenceOnComplete(fence, signalValue,
+                                                                mDevice->GetSerial());
+        mDevice->NextSerial();
+    }
+
 }}  // namespace backend::d3d12
@@ -32,6 +32,8 @@ namespace backend { namespace d3d12 {
         void Submit(uint32_t numCommands, CommandBuffer* const* commands);
 
       private:
+        void SignalImpl(FenceBase* fence, uint64_t signalValue) override;
+
         Device* mDevice;
 
         ComPtr<ID3D12GraphicsCommandList> mCommandList;
@@ -15,6 +15,7 @@
 #include "backend/metal/CommandBufferMTL.h"
 
 #include "backend/Commands.h"
+#include "backend/RenderBundle.h"
 #include "backend/metal/BufferMTL.h"
 #include "backend/metal/ComputePipelineMTL.h"
 #include "backend/metal/DepthStencilStateMTL.h"
@@ -175,10 +176,11 @@ namespace backend { namespace metal {
         PerStage<std::array<uint32_t, kMaxPushConstants>> pushConstants;
 
         uint32_t currentSubpass = 0;
-        while (mCommands.NextCommandId(&type)) {
+        CommandBufferIterator commands(&mCommands);
+        while (commands.NextCommandId(&type)) {
             switch (type) {
                 case Command::BeginComputePass: {
-                    mCommands.NextCommand<BeginComputePassCmd>();
+                    commands.NextCommand<BeginComputePassCmd>();
                     encoders.BeginCompute(commandBuffer);
 
                     pushConstants[nxt::ShaderStage::Compute].fill(0);
@@ -187,9 +189,14 @@ namespace backend { namespace metal {
                                        atIndex:0];
                 } break;
 
+                case Command::BeginQuery:
+                    // Query sets can't be created on this backend.
+                    UNREACHABLE();
+                    break;
+
                 case Command::BeginRenderPass: {
                     BeginRenderPassCmd* beginRenderPassCmd =
-                        mCommands.NextCommand<BeginRenderPassCmd>();
+                        commands.NextCommand<BeginRenderPassCmd>();
                     encoders.currentRenderPass = ToBackend(beginRenderPassCmd->renderPass.Get());
                     encoders.currentFramebuffer = ToBackend(beginRenderPassCmd->framebuffer.Get());
                     encoders.EnsureNoBlitEncoder();
@@ -197,7 +204,7 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::BeginRenderSubpass: {
-                    mCommands.NextCommand<BeginRenderSubpassCmd>();
+                    commands.NextCommand<BeginRenderSubpassCmd>();
                     encoders.BeginSubpass(commandBuffer, currentSubpass);
 
                     pushConstants[nxt::ShaderStage::Vertex].fill(0);
@@ -212,7 +219,7 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::CopyBufferToBuffer: {
-                    CopyBufferToBufferCmd* copy = mCommands.NextCommand<CopyBufferToBufferCmd>();
+                    CopyBufferToBufferCmd* copy = commands.NextCommand<CopyBufferToBufferCmd>();
                     auto& src = copy->source;
                     auto& dst = copy->destination;
 
@@ -225,7 +232,7 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::CopyBufferToTexture: {
-                    CopyBufferToTextureCmd* copy = mCommands.NextCommand<CopyBufferToTextureCmd>();
+                    CopyBufferToTextureCmd* copy = commands.NextCommand<CopyBufferToTextureCmd>();
                     auto& src = copy->source;
                     auto& dst = copy->destination;
                     Buffer* buffer = ToBackend(src.buffer.Get());
@@ -254,7 +261,7 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::CopyTextureToBuffer: {
-                    CopyTextureToBufferCmd* copy = mCommands.NextCommand<CopyTextureToBufferCmd>();
+                    CopyTextureToBufferCmd* copy = commands.NextCommand<CopyTextureToBufferCmd>();
                     auto& src = copy->source;
                     auto& dst = copy->destination;
                     Texture* texture = ToBackend(src.texture.Get());
@@ -283,7 +290,7 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::Dispatch: {
-                    DispatchCmd* dispatch = mCommands.NextCommand<DispatchCmd>();
+                    DispatchCmd* dispatch = commands.NextCommand<DispatchCmd>();
                     ASSERT(encoders.compute);
 
                     [encoders.compute
@@ -291,8 +298,20 @@ namespace backend { namespace metal {
                         threadsPerThreadgroup:lastComputePipeline->GetLocalWorkGroupSize()];
                 } break;
 
+                case Command::DispatchIndirect: {
+                    DispatchIndirectCmd* dispatch = commands.NextCommand<DispatchIndirectCmd>();
+                    ASSERT(encoders.compute);
+
+                    Buffer* buffer = ToBackend(dispatch->indirectBuffer.Get());
+                    [encoders.compute
+                        dispatchThreadgroupsWithIndirectBuffer:buffer->GetMTLBuffer()
+                                          indirectBufferOffset:dispatch->indirectOffset
+                                         threadsPerThreadgroup:lastComputePipeline
+                                                                   ->GetLocalWorkGroupSize()];
+                } break;
+
                 case Command::DrawArrays: {
-                    DrawArraysCmd* draw = mCommands.NextCommand<DrawArraysCmd>();
+                    DrawArraysCmd* draw = commands.NextCommand<DrawArraysCmd>();
 
                     ASSERT(encoders.render);
                     [encoders.render drawPrimitives:lastRenderPipeline->GetMTLPrimitiveTopology()
@@ -302,8 +321,18 @@ namespace backend { namespace metal {
                                        baseInstance:draw->firstInstance];
                 } break;
 
+                case Command::DrawArraysIndirect: {
+                    DrawArraysIndirectCmd* draw = commands.NextCommand<DrawArraysIndirectCmd>();
+
+                    ASSERT(encoders.render);
+                    Buffer* buffer = ToBackend(draw->indirectBuffer.Get());
+                    [encoders.render drawPrimitives:lastRenderPipeline->GetMTLPrimitiveTopology()
+                                     indirectBuffer:buffer->GetMTLBuffer()
+                               indirectBufferOffset:draw->indirectOffset];
+                } break;
+
                 case Command::DrawElements: {
-                    DrawElementsCmd* draw = mCommands.NextCommand<DrawElementsCmd>();
+                    DrawElementsCmd* draw = commands.NextCommand<DrawElementsCmd>();
 
                     ASSERT(encoders.render);
                     [encoders.render
@@ -317,23 +346,90 @@ namespace backend { namespace metal {
                                  baseInstance:draw->firstInstance];
                 } break;
 
+                case Command::DrawElementsIndirect: {
+                    DrawElementsIndirectCmd* draw =
+                        commands.NextCommand<DrawElementsIndirectCmd>();
+
+                    ASSERT(encoders.render);
+                    Buffer* buffer = ToBackend(draw->indirectBuffer.Get());
+                    [encoders.render
+                        drawIndexedPrimitives:lastRenderPipeline->GetMTLPrimitiveTopology()
+                                    indexType:lastRenderPipeline->GetMTLIndexType()
+                                  indexBuffer:indexBuffer
+                            indexBufferOffset:indexBufferOffset
+                               indirectBuffer:buffer->GetMTLBuffer()
+                         indirectBufferOffset:draw->indirectOffset];
+                } break;
+
                 case Command::EndComputePass: {
-                    mCommands.NextCommand<EndComputePassCmd>();
+                    commands.NextCommand<EndComputePassCmd>();
                     encoders.EndCompute();
                 } break;
 
+                case Command::EndQuery:
+                    // Query sets can't be created on this backend.
+                    UNREACHABLE();
+                    break;
+
                 case Command::EndRenderPass: {
-                    mCommands.NextCommand<EndRenderPassCmd>();
+                    commands.NextCommand<EndRenderPassCmd>();
                 } break;
 
                 case Command::EndRenderSubpass: {
-                    mCommands.NextCommand<EndRenderSubpassCmd>();
+                    commands.NextCommand<EndRenderSubpassCmd>();
                     encoders.EndSubpass();
                     currentSubpass += 1;
                 } break;
 
+                case Command::MultiDrawArrays: {
+                    MultiDrawArraysCmd* draw = commands.NextCommand<MultiDrawArraysCmd>();
+                    uint32_t* vertexCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* instanceCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstVertices = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstInstances = commands.NextData<uint32_t>(draw->drawCount);
+
+                    ASSERT(encoders.render);
+                    MTLPrimitiveType topology = lastRenderPipeline->GetMTLPrimitiveTopology();
+                    for (uint32_t i = 0; i < draw->drawCount; ++i) {
+                        [encoders.render drawPrimitives:topology
+                                            vertexStart:firstVertices[i]
+                                            vertexCount:vertexCounts[i]
+                                          instanceCount:instanceCounts[i]
+                                           baseInstance:firstInstances[i]];
+                    }
+                } break;
+
+                case Command::MultiDrawElements: {
+                    MultiDrawElementsCmd* draw = commands.NextCommand<MultiDrawElementsCmd>();
+                    uint32_t* indexCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* instanceCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstIndices = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstInstances = commands.NextData<uint32_t>(draw->drawCount);
+
+                    ASSERT(encoders.render);
+                    MTLPrimitiveType topology = lastRenderPipeline->GetMTLPrimitiveTopology();
+                    MTLIndexType indexType = lastRenderPipeline->GetMTLIndexType();
+                    size_t formatSize = IndexFormatSize(lastRenderPipeline->GetIndexFormat());
+                    for (uint32_t i = 0; i < draw->drawCount; ++i) {
+                        [encoders.render
+                            drawIndexedPrimitives:topology
+                                       indexCount:indexCounts[i]
+                                        indexType:indexType
+                                      indexBuffer:indexBuffer
+                                indexBufferOffset:indexBufferOffset + firstIndices[i] * formatSize
+                                    instanceCount:instanceCounts[i]
+                                       baseVertex:0
+                                     baseInstance:firstInstances[i]];
+                    }
+                } break;
+
+                case Command::ResolveQuerySet:
+                    // Query sets can't be created on this backend.
+                    UNREACHABLE();
+                    break;
+
                 case Command::SetComputePipeline: {
-                    SetComputePipelineCmd* cmd = mCommands.NextCommand<SetComputePipelineCmd>();
+                    SetComputePipelineCmd* cmd = commands.NextCommand<SetComputePipelineCmd>();
                     lastComputePipeline = ToBackend(cmd->pipeline).Get();
 
                     ASSERT(encoders.compute);
@@ -341,7 +437,7 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::SetRenderPipeline: {
-                    SetRenderPipelineCmd* cmd = mCommands.NextCommand<SetRenderPipelineCmd>();
+                    SetRenderPipelineCmd* cmd = commands.NextCommand<SetRenderPipelineCmd>();
                     lastRenderPipeline = ToBackend(cmd->pipeline).Get();
 
                     ASSERT(encoders.render);
@@ -353,8 +449,8 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::SetPushConstants: {
-                    SetPushConstantsCmd* cmd = mCommands.NextCommand<SetPushConstantsCmd>();
-                    uint32_t* values = mCommands.NextData<uint32_t>(cmd->count);
+                    SetPushConstantsCmd* cmd = commands.NextCommand<SetPushConstantsCmd>();
+                    uint32_t* values = commands.NextData<uint32_t>(cmd->count);
 
                     for (auto stage : IterateStages(cmd->stages)) {
                         memcpy(&pushConstants[stage][cmd->offset], values,
@@ -389,7 +485,7 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::SetStencilReference: {
-                    SetStencilReferenceCmd* cmd = mCommands.NextCommand<SetStencilReferenceCmd>();
+                    SetStencilReferenceCmd* cmd = commands.NextCommand<SetStencilReferenceCmd>();
 
                     ASSERT(encoders.render);
 
@@ -397,7 +493,7 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::SetBlendColor: {
-                    SetBlendColorCmd* cmd = mCommands.NextCommand<SetBlendColorCmd>();
+                    SetBlendColorCmd* cmd = commands.NextCommand<SetBlendColorCmd>();
 
                     ASSERT(encoders.render);
 
@@ -405,7 +501,9 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::SetBindGroup: {
-                    SetBindGroupCmd* cmd = mCommands.NextCommand<SetBindGroupCmd>();
+                    SetBindGroupCmd* cmd = commands.NextCommand<SetBindGroupCmd>();
+                    uint32_t* dynamicOffsets = commands.NextData<uint32_t>(cmd->dynamicOffsetCount);
+                    uint32_t dynamicOffsetIndex = 0;
                     BindGroup* group = ToBackend(cmd->group.Get());
                     uint32_t groupIndex = cmd->index;
 
@@ -450,12 +548,17 @@ namespace backend { namespace metal {
 
                         switch (layout.types[binding]) {
                             case nxt::BindingType::UniformBuffer:
-                            case nxt::BindingType::StorageBuffer: {
+                            case nxt::BindingType::StorageBuffer:
+                            case nxt::BindingType::DynamicUniformBuffer:
+                            case nxt::BindingType::DynamicStorageBuffer: {
                                 BufferView* view =
                                     ToBackend(group->GetBindingAsBufferView(binding));
                                 auto b = ToBackend(view->GetBuffer());
                                 const id<MTLBuffer> buffer = b->GetMTLBuffer();
-                                const NSUInteger offset = view->GetOffset();
+                                NSUInteger offset = view->GetOffset();
+                                if (IsDynamicBufferBinding(layout.types[binding])) {
+                                    offset += dynamicOffsets[dynamicOffsetIndex++];
+                                }
                                 if (vertStage) {
                                     [encoders.render setVertexBuffers:&buffer
                                                               offsets:&offset
@@ -513,16 +616,16 @@ namespace backend { namespace metal {
                 } break;
 
                 case Command::SetIndexBuffer: {
-                    SetIndexBufferCmd* cmd = mCommands.NextCommand<SetIndexBufferCmd>();
+                    SetIndexBufferCmd* cmd = commands.NextCommand<SetIndexBufferCmd>();
                     auto b = ToBackend(cmd->buffer.Get());
                     indexBuffer = b->GetMTLBuffer();
                     indexBufferOffset = cmd->offset;
                 } break;
 
                 case Command::SetVertexBuffers: {
-                    SetVertexBuffersCmd* cmd = mCommands.NextCommand<SetVertexBuffersCmd>();
-                    auto buffers = mCommands.NextData<Ref<BufferBase>>(cmd->count);
-                    auto offsets = mCommands.NextData<uint32_t>(cmd->count);
+                    SetVertexBuffersCmd* cmd = commands.NextCommand<SetVertexBuffersCmd>();
+                    auto buffers = commands.NextData<Ref<BufferBase>>(cmd->count);
+                    auto offsets = commands.NextData<uint32_t>(cmd->count);
 
                     std::array<id<MTLBuffer>, kMaxVertexInputs> mtlBuffers;
                     std::array<NSUInteger, kMaxVertexInputs> mtlOffsets;
@@ -543,19 +646,29 @@ namespace backend { namespace metal {
                                                      cmd->count)];
                 } break;
 
+                case Command::ExecuteBundles:
+                    // The iterator replaces bundles with their commands.
+                    UNREACHABLE();
+                    break;
+
                 case Command::TransitionBufferUsage: {
                     TransitionBufferUsageCmd* cmd =
-                        mCommands.NextCommand<TransitionBufferUsageCmd>();
+                        commands.NextCommand<TransitionBufferUsageCmd>();
 
                     cmd->buffer->UpdateUsageInternal(cmd->usage);
                 } break;
 
                 case Command::TransitionTextureUsage: {
                     TransitionTextureUsageCmd* cmd =
-                        mCommands.NextCommand<TransitionTextureUsageCmd>();
+                        commands.NextCommand<TransitionTextureUsageCmd>();
 
                     cmd->texture->UpdateUsageInternal(cmd->usage);
                 } break;
+
+                case Command::WriteTimestamp:
+                    // Query sets can't be created on this backend.
+                    UNREACHABLE();
+                    break;
             }
         }
 
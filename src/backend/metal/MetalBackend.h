@@ -20,8 +20,11 @@
 #include "backend/BindGroup.h"
 #include "backend/BindGroupLayout.h"
 #include "backend/Device.h"
+#include "backend/Fence.h"
 #include "backend/Framebuffer.h"
+#include "backend/QuerySet.h"
 #include "backend/Queue.h"
+#include "backend/RenderBundle.h"
 #include "backend/RenderPass.h"
 #include "backend/ToBackend.h"
 #include "common/Serial.h"
@@ -41,10 +44,13 @@ namespace backend { namespace metal {
     class ComputePipeline;
     class DepthStencilState;
     class Device;
+    using Fence = FenceBase;
     class Framebuffer;
     class InputState;
     class PipelineLayout;
+    using QuerySet = QuerySetBase;
     class Queue;
+    using RenderBundle = RenderBundleBase;
     class RenderPass;
     class RenderPipeline;
     class Sampler;
@@ -63,10 +69,13 @@ namespace backend { namespace metal {
         using ComputePipelineType = ComputePipeline;
         using DepthStencilStateType = DepthStencilState;
         using DeviceType = Device;
+        using FenceType = Fence;
         using FramebufferType = Framebuffer;
         using InputStateType = InputState;
         using PipelineLayoutType = PipelineLayout;
+        using QuerySetType = QuerySet;
         using QueueType = Queue;
+        using RenderBundleType = RenderBundle;
         using RenderPassType = RenderPass;
         using RenderPipelineType = RenderPipeline;
         using SamplerType = Sampler;
@@ -100,7 +109,9 @@ namespace backend { namespace metal {
         InputStateBase* CreateInputState(InputStateBuilder* builder) override;
         FramebufferBase* CreateFramebuffer(FramebufferBuilder* builder) override;
         PipelineLayoutBase* CreatePipelineLayout(PipelineLayoutBuilder* builder) override;
+        QuerySetBase* CreateQuerySet(QuerySetBuilder* builder) override;
         QueueBase* CreateQueue(QueueBuilder* builder) override;
+        RenderBundleBase* CreateRenderBundle(RenderBundleBuilder* builder) override;
         RenderPassBase* CreateRenderPass(RenderPassBuilder* builder) override;
         RenderPipelineBase* CreateRenderPipeline(RenderPipelineBuilder* builder) override;
         SamplerBase* CreateSampler(SamplerBuilder* builder) override;
@@ -117,6 +128,7 @@ namespace backend { namespace metal {
         void SubmitPendingCommandBuffer();
         Serial GetPendingCommandSerial();
 
+        FenceSignalTracker* GetFenceSignalTracker();
         MapReadRequestTracker* GetMapReadTracker() const;
         ResourceUploader* GetResourceUploader() const;
 
@@ -125,6 +137,7 @@ namespace backend { namespace metal {
 
         id<MTLDevice> mMtlDevice = nil;
         id<MTLCommandQueue> mCommandQueue = nil;
+        FenceSignalTracker mFenceSignalTracker;
         MapReadRequestTracker* mMapReadTracker;
         ResourceUploader* mResourceUploader;
 
@@ -160,6 +173,8 @@ namespace backend { namespace metal {
         void Submit(uint32_t numCommands, CommandBuffer* const* commands);
 
       private:
+        void SignalImpl(FenceBase* fence, uint64_t signalValue) override;
+
         id<MTLCommandQueue> mCommandQueue = nil;
     };
 
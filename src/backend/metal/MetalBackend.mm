@@ -111,9 +111,17 @@ namespace backend { namespace metal {
     PipelineLayoutBase* Device::CreatePipelineLayout(PipelineLayoutBuilder* builder) {
         return new PipelineLayout(builder);
     }
+    QuerySetBase* Device::CreateQuerySet(QuerySetBuilder* builder) {
+        // Queries aren't implemented in this backend.
+        builder->HandleError("Query sets are not supported on this backend");
+        return nullptr;
+    }
     QueueBase* Device::CreateQueue(QueueBuilder* builder) {
         return new Queue(builder);
     }
+    RenderBundleBase* Device::CreateRenderBundle(RenderBundleBuilder* builder) {
+        return new RenderBundleBase(builder);
+    }
     RenderPassBase* Device::CreateRenderPass(RenderPassBuilder* builder) {
         return new RenderPass(builder);
     }
@@ -139,6 +147,7 @@ namespace backend { namespace metal {
     void Device::TickImpl() {
         mResourceUploader->Tick(mFinishedCommandSerial);
         mMapReadTracker->Tick(mFinishedCommandSerial);
+        mFenceSignalTracker.Tick(mFinishedCommandSerial);
 
         // Code above might have added GPU work, submit it. This also makes sure
         // that even when no GPU work is happening, the serial number keeps incrementing.
@@ -169,6 +178,8 @@ namespace backend { namespace metal {
         Serial pendingSerial = mPendingCommandSerial;
         [mPendingCommands addCompletedHandler:^(id<MTLCommandBuffer>) {
             this->mFinishedCommandSerial = pendingSerial;
+            // The handler is called on a Metal thread, wake the application so that it ticks.
+            this->SignalCompletion();
         }];
 
         [mPendingCommands commit];
@@ -186,6 +197,10 @@ namespace backend { namespace metal {
         return mPendingCommandSerial;
     }
 
+    FenceSignalTracker* Device::GetFenceSignalTracker() {
+        return &mFenceSignalTracker;
+    }
+
     MapReadRequestTracker* Device::GetMapReadTracker() const {
         return mMapReadTracker;
     }
@@ -240,6 +255,14 @@ namespace backend { namespace metal {
         device->SubmitPendingCommandBuffer();
     }
 
+    void Queue::SignalImpl(FenceBase* fence, uint64_t signalValue) {
+        // The fence completes with the pending command buffer, that is after the commands
+        // submitted so far.
+        Device* device = ToBackend(GetDevice());
+        device->GetFenceSignalTracker()->UpdateFenceOnComplete(fence, signalValue,
+                                                               device->GetPendingCommandSerial());
+    }
+
     // RenderPass
 
     RenderPass::RenderPass(RenderPassBuilder* builder) : RenderPassBase(builder) {
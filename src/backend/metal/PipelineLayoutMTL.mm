@@ -39,6 +39,8 @@ namespace backend { namespace metal {
                     switch (groupInfo.types[binding]) {
                         case nxt::BindingType::UniformBuffer:
                         case nxt::BindingType::StorageBuffer:
+                        case nxt::BindingType::DynamicUniformBuffer:
+                        case nxt::BindingType::DynamicStorageBuffer:
                             mIndexInfo[stage][group][binding] = bufferIndex;
                             bufferIndex++;
                             break;
@@ -18,6 +18,8 @@
 
 #include <spirv-cross/spirv_cross.hpp>
 
+#include <chrono>
+
 namespace backend { namespace null {
 
     nxtProcTable GetNonValidatingProcs();
@@ -69,9 +71,15 @@ namespace backend { namespace null {
     PipelineLayoutBase* Device::CreatePipelineLayout(PipelineLayoutBuilder* builder) {
         return new PipelineLayout(builder);
     }
+    QuerySetBase* Device::CreateQuerySet(QuerySetBuilder* builder) {
+        return new QuerySet(builder);
+    }
     QueueBase* Device::CreateQueue(QueueBuilder* builder) {
         return new Queue(builder);
     }
+    RenderBundleBase* Device::CreateRenderBundle(RenderBundleBuilder* builder) {
+        return new RenderBundle(builder);
+    }
     RenderPassBase* Device::CreateRenderPass(RenderPassBuilder* builder) {
         return new RenderPass(builder);
     }
@@ -102,6 +110,13 @@ namespace backend { namespace null {
     void Device::TickImpl() {
     }
 
+    // Pending operations, including map read callbacks, complete synchronously in Queue::Submit
+    // so ticking never has work to do. The device has no completion fd instead of one that is
+    // never readable, so that applications don't wait on it.
+    bool Device::SignalsCompletion() const {
+        return false;
+    }
+
     void Device::AddPendingOperation(std::unique_ptr<PendingOperation> operation) {
         mPendingOperations.emplace_back(std::move(operation));
     }
@@ -123,8 +138,9 @@ namespace backend { namespace null {
 
     Buffer::Buffer(BufferBuilder* builder) : BufferBase(builder) {
         if (GetAllowedUsage() & (nxt::BufferUsageBit::TransferDst | nxt::BufferUsageBit::MapRead |
-                                 nxt::BufferUsageBit::MapWrite)) {
-            mBackingData = std::unique_ptr<char[]>(new char[GetSize()]);
+                                 nxt::BufferUsageBit::MapWrite | nxt::BufferUsageBit::Indirect)) {
+            // Zero-initialized so that reading back data that wasn't written is deterministic.
+            mBackingData = std::unique_ptr<char[]>(new char[GetSize()]());
         }
     }
 
@@ -135,6 +151,18 @@ namespace backend { namespace null {
         CallMapReadCallback(serial, NXT_BUFFER_MAP_READ_STATUS_SUCCESS, ptr);
     }
 
+    void Buffer::ReadIndirectArguments(uint32_t offset, size_t size, void* arguments) const {
+        ASSERT(offset + size <= GetSize());
+        ASSERT(mBackingData);
+        memcpy(arguments, mBackingData.get() + offset, size);
+    }
+
+    void Buffer::WriteData(uint32_t offset, size_t size, const void* data) {
+        ASSERT(offset + size <= GetSize());
+        ASSERT(mBackingData);
+        memcpy(mBackingData.get() + offset, data, size);
+    }
+
     void Buffer::SetSubDataImpl(uint32_t start, uint32_t count, const uint32_t* data) {
         ASSERT(start + count <= GetSize());
         ASSERT(mBackingData);
@@ -170,24 +198,125 @@ namespace backend { namespace null {
     }
 
     void CommandBuffer::Execute() {
-        Command type;
-        while (mCommands.NextCommandId(&type)) {
-            switch (type) {
+        if (!mWasTranslated) {
+            Translate();
+        }
+
+        for (const Operation& operation : mOperations) {
+            switch (operation.type) {
                 case Command::TransitionBufferUsage: {
-                    TransitionBufferUsageCmd* cmd =
-                        mCommands.NextCommand<TransitionBufferUsageCmd>();
+                    auto* cmd = static_cast<TransitionBufferUsageCmd*>(operation.cmd);
                     cmd->buffer->UpdateUsageInternal(cmd->usage);
                 } break;
                 case Command::TransitionTextureUsage: {
-                    TransitionTextureUsageCmd* cmd =
-                        mCommands.NextCommand<TransitionTextureUsageCmd>();
+                    auto* cmd = static_cast<TransitionTextureUsageCmd*>(operation.cmd);
                     cmd->texture->UpdateUsageInternal(cmd->usage);
                 } break;
+                // The arguments are read like a GPU would even though nothing is executed, so
+                // that tools like ASan catch out-of-bounds reads.
+                case Command::DispatchIndirect: {
+                    auto* dispatch = static_cast<DispatchIndirectCmd*>(operation.cmd);
+                    DispatchIndirectArgs args;
+                    ToBackend(dispatch->indirectBuffer.Get())
+                        ->ReadIndirectArguments(dispatch->indirectOffset, sizeof(args), &args);
+                } break;
+                case Command::DrawArraysIndirect: {
+                    auto* draw = static_cast<DrawArraysIndirectCmd*>(operation.cmd);
+                    DrawArraysIndirectArgs args;
+                    ToBackend(draw->indirectBuffer.Get())
+                        ->ReadIndirectArguments(draw->indirectOffset, sizeof(args), &args);
+                } break;
+                case Command::DrawElementsIndirect: {
+                    auto* draw = static_cast<DrawElementsIndirectCmd*>(operation.cmd);
+                    DrawElementsIndirectArgs args;
+                    ToBackend(draw->indirectBuffer.Get())
+                        ->ReadIndirectArguments(draw->indirectOffset, sizeof(args), &args);
+                } break;
+                case Command::EndQuery: {
+                    auto* cmd = static_cast<EndQueryCmd*>(operation.cmd);
+                    ToBackend(cmd->querySet.Get())->WriteResult(cmd->queryIndex, 0);
+                } break;
+                case Command::ResolveQuerySet: {
+                    auto* cmd = static_cast<ResolveQuerySetCmd*>(operation.cmd);
+                    const uint64_t* results = ToBackend(cmd->querySet.Get())->GetResults();
+                    ToBackend(cmd->destination.Get())
+                        ->WriteData(cmd->destinationOffset, cmd->queryCount * sizeof(uint64_t),
+                                    &results[cmd->firstQuery]);
+                } break;
+                case Command::WriteTimestamp: {
+                    auto* cmd = static_cast<WriteTimestampCmd*>(operation.cmd);
+                    auto now = std::chrono::steady_clock::now().time_since_epoch();
+                    uint64_t timestamp =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+                    ToBackend(cmd->querySet.Get())->WriteResult(cmd->queryIndex, timestamp);
+                } break;
+                default:
+                    UNREACHABLE();
+            }
+        }
+
+        if (!IsReusable()) {
+            mOperations.clear();
+            mWasTranslated = false;
+        }
+    }
+
+    void CommandBuffer::Translate() {
+        CommandBufferIterator commands(&mCommands);
+        Command type;
+        while (commands.NextCommandId(&type)) {
+            switch (type) {
+                case Command::TransitionBufferUsage:
+                    mOperations.push_back(
+                        {type, commands.NextCommand<TransitionBufferUsageCmd>()});
+                    break;
+                case Command::TransitionTextureUsage:
+                    mOperations.push_back(
+                        {type, commands.NextCommand<TransitionTextureUsageCmd>()});
+                    break;
+                case Command::DispatchIndirect:
+                    mOperations.push_back({type, commands.NextCommand<DispatchIndirectCmd>()});
+                    break;
+                case Command::DrawArraysIndirect:
+                    mOperations.push_back({type, commands.NextCommand<DrawArraysIndirectCmd>()});
+                    break;
+                case Command::DrawElementsIndirect:
+                    mOperations.push_back(
+                        {type, commands.NextCommand<DrawElementsIndirectCmd>()});
+                    break;
+                case Command::EndQuery:
+                    mOperations.push_back({type, commands.NextCommand<EndQueryCmd>()});
+                    break;
+                case Command::ResolveQuerySet:
+                    mOperations.push_back({type, commands.NextCommand<ResolveQuerySetCmd>()});
+                    break;
+                case Command::WriteTimestamp:
+                    mOperations.push_back({type, commands.NextCommand<WriteTimestampCmd>()});
+                    break;
                 default:
-                    SkipCommand(&mCommands, type);
+                    commands.SkipCommand(type);
                     break;
             }
         }
+        mWasTranslated = true;
+    }
+
+    // QuerySet
+
+    QuerySet::QuerySet(QuerySetBuilder* builder)
+        : QuerySetBase(builder), mResults(GetCount(), 0) {
+    }
+
+    QuerySet::~QuerySet() {
+    }
+
+    void QuerySet::WriteResult(uint32_t index, uint64_t result) {
+        ASSERT(index < GetCount());
+        mResults[index] = result;
+    }
+
+    const uint64_t* QuerySet::GetResults() const {
+        return mResults.data();
     }
 
     // Queue
@@ -212,6 +341,25 @@ namespace backend { namespace null {
         operations.clear();
     }
 
+    // Like map reads, signals complete at the next Submit so that the order of the callbacks
+    // doesn't depend on when the device is ticked.
+    struct FenceSignalOperation : PendingOperation {
+        virtual void Execute() {
+            fence->SetCompletedValue(value);
+        }
+
+        Ref<Fence> fence;
+        uint64_t value;
+    };
+
+    void Queue::SignalImpl(FenceBase* fence, uint64_t signalValue) {
+        auto operation = new FenceSignalOperation;
+        operation->fence = fence;
+        operation->value = signalValue;
+
+        ToBackend(GetDevice())->AddPendingOperation(std::unique_ptr<PendingOperation>(operation));
+    }
+
     // Texture
 
     Texture::Texture(TextureBuilder* builder) : TextureBase(builder) {
@@ -22,13 +22,17 @@
 #include "backend/BlendState.h"
 #include "backend/Buffer.h"
 #include "backend/CommandBuffer.h"
+#include "backend/Commands.h"
 #include "backend/ComputePipeline.h"
 #include "backend/DepthStencilState.h"
 #include "backend/Device.h"
+#include "backend/Fence.h"
 #include "backend/Framebuffer.h"
 #include "backend/InputState.h"
 #include "backend/PipelineLayout.h"
+#include "backend/QuerySet.h"
 #include "backend/Queue.h"
+#include "backend/RenderBundle.h"
 #include "backend/RenderPass.h"
 #include "backend/RenderPipeline.h"
 #include "backend/Sampler.h"
@@ -48,10 +52,13 @@ namespace backend { namespace null {
     using ComputePipeline = ComputePipelineBase;
     using DepthStencilState = DepthStencilStateBase;
     class Device;
+    using Fence = FenceBase;
     using Framebuffer = FramebufferBase;
     using InputState = InputStateBase;
     using PipelineLayout = PipelineLayoutBase;
+    class QuerySet;
     class Queue;
+    using RenderBundle = RenderBundleBase;
     using RenderPass = RenderPassBase;
     using RenderPipeline = RenderPipelineBase;
     using Sampler = SamplerBase;
@@ -70,10 +77,13 @@ namespace backend { namespace null {
         using ComputePipelineType = ComputePipeline;
         using DepthStencilStateType = DepthStencilState;
         using DeviceType = Device;
+        using FenceType = Fence;
         using FramebufferType = Framebuffer;
         using InputStateType = InputState;
         using PipelineLayoutType = PipelineLayout;
+        using QuerySetType = QuerySet;
         using QueueType = Queue;
+        using RenderBundleType = RenderBundle;
         using RenderPassType = RenderPass;
         using RenderPipelineType = RenderPipeline;
         using SamplerType = Sampler;
@@ -109,7 +119,9 @@ namespace backend { namespace null {
         FramebufferBase* CreateFramebuffer(FramebufferBuilder* builder) override;
         InputStateBase* CreateInputState(InputStateBuilder* builder) override;
         PipelineLayoutBase* CreatePipelineLayout(PipelineLayoutBuilder* builder) override;
+        QuerySetBase* CreateQuerySet(QuerySetBuilder* builder) override;
         QueueBase* CreateQueue(QueueBuilder* builder) override;
+        RenderBundleBase* CreateRenderBundle(RenderBundleBuilder* builder) override;
         RenderPassBase* CreateRenderPass(RenderPassBuilder* builder) override;
         RenderPipelineBase* CreateRenderPipeline(RenderPipelineBuilder* builder) override;
         SamplerBase* CreateSampler(SamplerBuilder* builder) override;
@@ -119,6 +131,7 @@ namespace backend { namespace null {
         TextureViewBase* CreateTextureView(TextureViewBuilder* builder) override;
 
         void TickImpl() override;
+        bool SignalsCompletion() const override;
 
         void AddPendingOperation(std::unique_ptr<PendingOperation> operation);
         std::vector<std::unique_ptr<PendingOperation>> AcquirePendingOperations();
@@ -133,6 +146,8 @@ namespace backend { namespace null {
         ~Buffer();
 
         void MapReadOperationCompleted(uint32_t serial, const void* ptr);
+        void ReadIndirectArguments(uint32_t offset, size_t size, void* arguments) const;
+        void WriteData(uint32_t offset, size_t size, const void* data);
 
       private:
         void SetSubDataImpl(uint32_t start, uint32_t count, const uint32_t* data) override;
@@ -152,7 +167,33 @@ namespace backend { namespace null {
         void Execute();
 
       private:
+        // Gathers the commands that have an effect on the null backend, including the commands of
+        // the render bundles that are executed.
+        void Translate();
+
         CommandIterator mCommands;
+
+        struct Operation {
+            Command type;
+            void* cmd;
+        };
+        // Reusable command buffers keep their operations to replay them on the next submits.
+        std::vector<Operation> mOperations;
+        bool mWasTranslated = false;
+    };
+
+    // Queries are written when command buffers are executed. Nothing is drawn so occlusion and
+    // pipeline statistics queries are 0, and timestamps are taken on the CPU.
+    class QuerySet : public QuerySetBase {
+      public:
+        QuerySet(QuerySetBuilder* builder);
+        ~QuerySet();
+
+        void WriteResult(uint32_t index, uint64_t result);
+        const uint64_t* GetResults() const;
+
+      private:
+        std::vector<uint64_t> mResults;
     };
 
     class Queue : public QueueBase {
@@ -162,6 +203,9 @@ namespace backend { namespace null {
 
         // NXT API
         void Submit(uint32_t numCommands, CommandBuffer* const* commands);
+
+      private:
+        void SignalImpl(FenceBase* fence, uint64_t signalValue) override;
     };
 
     class Texture : public TextureBase {
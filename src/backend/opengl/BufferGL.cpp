@@ -14,40 +14,115 @@
 
 #include "backend/opengl/BufferGL.h"
 
+#include "backend/opengl/BufferUploaderGL.h"
 #include "backend/opengl/OpenGLBackend.h"
 
 namespace backend { namespace opengl {
 
+    namespace {
+
+        GLbitfield GLBufferStorageFlags(nxt::BufferUsageBit usage) {
+            GLbitfield flags = 0;
+
+            // SetSubData goes through the BufferUploader, that can fall back to glBufferSubData.
+            if (usage & nxt::BufferUsageBit::TransferDst) {
+                flags |= GL_DYNAMIC_STORAGE_BIT;
+            }
+            // Buffers read back by the CPU are kept persistently mapped. The mapping is coherent
+            // so data written by the GPU is visible as soon as the fence guarding the map
+            // request has signaled.
+            if (usage & nxt::BufferUsageBit::MapRead) {
+                flags |= GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            }
+
+            return flags;
+        }
+
+    }  // anonymous namespace
+
     // Buffer
 
     Buffer::Buffer(BufferBuilder* builder) : BufferBase(builder) {
         glGenBuffers(1, &mBuffer);
         glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
-        glBufferData(GL_ARRAY_BUFFER, GetSize(), nullptr, GL_STATIC_DRAW);
+
+        // Immutable storage with flags derived from the usage lets the driver pick the best
+        // memory for the buffer.
+        if (!ToBackend(GetDevice())->SupportsBufferStorage()) {
+            glBufferData(GL_ARRAY_BUFFER, GetSize(), nullptr, GL_STATIC_DRAW);
+            return;
+        }
+
+        GLbitfield flags = GLBufferStorageFlags(GetAllowedUsage());
+        glBufferStorage(GL_ARRAY_BUFFER, GetSize(), nullptr, flags);
+
+        if (flags & GL_MAP_PERSISTENT_BIT) {
+            GLbitfield mapFlags = flags & ~GL_DYNAMIC_STORAGE_BIT;
+            mPersistentPointer = reinterpret_cast<uint8_t*>(
+                glMapBufferRange(GL_ARRAY_BUFFER, 0, GetSize(), mapFlags));
+            ASSERT(mPersistentPointer != nullptr);
+        }
+    }
+
+    Buffer::~Buffer() {
+        // Deleting the buffer implicitly unmaps it.
+        glDeleteBuffers(1, &mBuffer);
+        mBuffer = 0;
     }
 
     GLuint Buffer::GetHandle() const {
         return mBuffer;
     }
 
+    void Buffer::OnMapReadCommandSerialFinished(uint32_t mapSerial,
+                                                uint32_t start,
+                                                uint32_t count) {
+        // The buffer was unmapped, or mapped again, before the fence signaled.
+        if (!mHasPendingMapRead || mapSerial != mPendingMapReadSerial) {
+            return;
+        }
+        mHasPendingMapRead = false;
+
+        const void* data = nullptr;
+        if (mPersistentPointer != nullptr) {
+            data = mPersistentPointer + start;
+        } else {
+            // The fence has passed so the GPU is done writing the buffer and this doesn't stall.
+            // TODO(cwallez@chromium.org): this crashes on Mac NVIDIA, use GetBufferSubData there
+            // instead?
+            glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
+            data = glMapBufferRange(GL_ARRAY_BUFFER, start, count, GL_MAP_READ_BIT);
+            mIsMappedWithGL = true;
+        }
+
+        CallMapReadCallback(mapSerial, NXT_BUFFER_MAP_READ_STATUS_SUCCESS, data);
+    }
+
     void Buffer::SetSubDataImpl(uint32_t start, uint32_t count, const uint32_t* data) {
-        glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
-        glBufferSubData(GL_ARRAY_BUFFER, start * sizeof(uint32_t), count * sizeof(uint32_t), data);
+        BufferUploader* uploader = ToBackend(GetDevice())->GetBufferUploader();
+        uploader->BufferSubData(mBuffer, start * sizeof(uint32_t), count * sizeof(uint32_t), data);
     }
 
     void Buffer::MapReadAsyncImpl(uint32_t serial, uint32_t start, uint32_t count) {
-        // TODO(cwallez@chromium.org): this does GPU->CPU synchronization, we could require a high
-        // version of OpenGL that would let us map the buffer unsynchronized.
-        // TODO(cwallez@chromium.org): this crashes on Mac NVIDIA, use GetBufferSubData there
-        // instead?
-        glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
-        void* data = glMapBufferRange(GL_ARRAY_BUFFER, start, count, GL_MAP_READ_BIT);
-        CallMapReadCallback(serial, NXT_BUFFER_MAP_READ_STATUS_SUCCESS, data);
+        // Instead of mapping now, which would wait for the GPU to finish all previous commands,
+        // the request completes in Device::Tick once a fence inserted after them has signaled.
+        Device* device = ToBackend(GetDevice());
+
+        mHasPendingMapRead = true;
+        mPendingMapReadSerial = serial;
+        device->GetMapReadRequestTracker()->Track(this, serial, start, count);
+        device->InsertFence();
     }
 
     void Buffer::UnmapImpl() {
-        glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
+        mHasPendingMapRead = false;
+
+        // Persistently mapped buffers stay mapped.
+        if (mIsMappedWithGL) {
+            glBindBuffer(GL_ARRAY_BUFFER, mBuffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            mIsMappedWithGL = false;
+        }
     }
 
     void Buffer::TransitionUsageImpl(nxt::BufferUsageBit, nxt::BufferUsageBit) {
@@ -58,4 +133,34 @@ namespace backend { namespace opengl {
     BufferView::BufferView(BufferViewBuilder* builder) : BufferViewBase(builder) {
     }
 
+    // MapReadRequestTracker
+
+    MapReadRequestTracker::MapReadRequestTracker(Device* device) : mDevice(device) {
+    }
+
+    MapReadRequestTracker::~MapReadRequestTracker() {
+        ASSERT(mInflightRequests.Empty());
+    }
+
+    void MapReadRequestTracker::Track(Buffer* buffer,
+                                      uint32_t mapSerial,
+                                      uint32_t start,
+                                      uint32_t count) {
+        Request request;
+        request.buffer = buffer;
+        request.mapSerial = mapSerial;
+        request.start = start;
+        request.count = count;
+
+        mInflightRequests.Enqueue(std::move(request), mDevice->GetSerial());
+    }
+
+    void MapReadRequestTracker::Tick(Serial finishedSerial) {
+        for (auto& request : mInflightRequests.IterateUpTo(finishedSerial)) {
+            request.buffer->OnMapReadCommandSerialFinished(request.mapSerial, request.start,
+                                                           request.count);
+        }
+        mInflightRequests.ClearUpTo(finishedSerial);
+    }
+
 }}  // namespace backend::opengl
@@ -16,6 +16,7 @@
 #define BACKEND_OPENGL_BUFFERGL_H_
 
 #include "backend/Buffer.h"
+#include "common/SerialQueue.h"
 
 #include "glad/glad.h"
 
@@ -26,9 +27,12 @@ namespace backend { namespace opengl {
     class Buffer : public BufferBase {
       public:
         Buffer(BufferBuilder* builder);
+        ~Buffer();
 
         GLuint GetHandle() const;
 
+        void OnMapReadCommandSerialFinished(uint32_t mapSerial, uint32_t start, uint32_t count);
+
       private:
         void SetSubDataImpl(uint32_t start, uint32_t count, const uint32_t* data) override;
         void MapReadAsyncImpl(uint32_t serial, uint32_t start, uint32_t count) override;
@@ -37,6 +41,15 @@ namespace backend { namespace opengl {
                                  nxt::BufferUsageBit targetUsage) override;
 
         GLuint mBuffer = 0;
+
+        // With ARB_buffer_storage, MapRead buffers are mapped for their whole lifetime so that
+        // completed map requests don't need to call into GL at all.
+        uint8_t* mPersistentPointer = nullptr;
+        // Set while a map request is waiting on its fence, or while the buffer is mapped with
+        // glMapBufferRange when it isn't persistently mapped.
+        bool mHasPendingMapRead = false;
+        bool mIsMappedWithGL = false;
+        uint32_t mPendingMapReadSerial = 0;
     };
 
     class BufferView : public BufferViewBase {
@@ -44,6 +57,26 @@ namespace backend { namespace opengl {
         BufferView(BufferViewBuilder* builder);
     };
 
+    class MapReadRequestTracker {
+      public:
+        MapReadRequestTracker(Device* device);
+        ~MapReadRequestTracker();
+
+        void Track(Buffer* buffer, uint32_t mapSerial, uint32_t start, uint32_t count);
+        void Tick(Serial finishedSerial);
+
+      private:
+        Device* mDevice;
+
+        struct Request {
+            Ref<Buffer> buffer;
+            uint32_t mapSerial;
+            uint32_t start;
+            uint32_t count;
+        };
+        SerialQueue<Request> mInflightRequests;
+    };
+
 }}  // namespace backend::opengl
 
 #endif  // BACKEND_OPENGL_BUFFERGL_H_
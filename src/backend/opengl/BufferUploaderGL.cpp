@@ -0,0 +1,108 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "backend/opengl/BufferUploaderGL.h"
+
+#include "backend/opengl/OpenGLBackend.h"
+
+#include <cstring>
+
+namespace backend { namespace opengl {
+
+    namespace {
+
+        constexpr size_t kRingSize = 4 * 1024 * 1024;
+        // Uploads bigger than this would evict too much of the ring and are better done by
+        // the driver.
+        constexpr size_t kMaxRingUploadSize = kRingSize / 4;
+        constexpr size_t kRingUploadAlignment = 16;
+
+    }  // anonymous namespace
+
+    BufferUploader::BufferUploader(Device* device) : mDevice(device) {
+        if (!device->SupportsBufferStorage()) {
+            return;
+        }
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &mRingBuffer);
+        glBindBuffer(GL_COPY_READ_BUFFER, mRingBuffer);
+        glBufferStorage(GL_COPY_READ_BUFFER, kRingSize, nullptr, flags);
+        mRingPointer = reinterpret_cast<uint8_t*>(
+            glMapBufferRange(GL_COPY_READ_BUFFER, 0, kRingSize, flags));
+        ASSERT(mRingPointer != nullptr);
+
+        mRingAllocator = std::make_unique<RingAllocator>(kRingSize);
+    }
+
+    BufferUploader::~BufferUploader() {
+        if (mRingBuffer != 0) {
+            // Deleting the buffer implicitly unmaps it.
+            glDeleteBuffers(1, &mRingBuffer);
+            mRingBuffer = 0;
+        }
+    }
+
+    void BufferUploader::BufferSubData(GLuint buffer,
+                                       GLintptr offset,
+                                       GLsizeiptr size,
+                                       const void* data) {
+        size_t ringOffset = RingAllocator::kInvalidOffset;
+        if (UseRing(size)) {
+            Serial serial = mDevice->GetSerial();
+            ringOffset = mRingAllocator->Allocate(static_cast<size_t>(size),
+                                                  kRingUploadAlignment, serial);
+            if (ringOffset != RingAllocator::kInvalidOffset) {
+                mLastUploadSerial = serial;
+            } else {
+                // Make sure the space used by previous uploads can be reclaimed in Tick.
+                if (mLastUploadSerial == serial) {
+                    mDevice->InsertFence();
+                }
+            }
+        }
+
+        if (ringOffset == RingAllocator::kInvalidOffset) {
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+            return;
+        }
+
+        // The ring is mapped coherently so the write is visible to the copy without a flush.
+        memcpy(mRingPointer + ringOffset, data, static_cast<size_t>(size));
+
+        glBindBuffer(GL_COPY_READ_BUFFER, mRingBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            static_cast<GLintptr>(ringOffset), offset, size);
+    }
+
+    void BufferUploader::Tick(Serial completedSerial) {
+        if (mRingAllocator == nullptr) {
+            return;
+        }
+
+        mRingAllocator->Tick(completedSerial);
+
+        // Uploads that aren't followed by a fence yet would never complete otherwise.
+        if (mLastUploadSerial == mDevice->GetSerial()) {
+            mDevice->InsertFence();
+        }
+    }
+
+    bool BufferUploader::UseRing(GLsizeiptr size) const {
+        return mRingAllocator != nullptr && static_cast<size_t>(size) <= kMaxRingUploadSize;
+    }
+
+}}  // namespace backend::opengl
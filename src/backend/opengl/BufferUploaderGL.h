@@ -0,0 +1,58 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BACKEND_OPENGL_BUFFERUPLOADERGL_H_
+#define BACKEND_OPENGL_BUFFERUPLOADERGL_H_
+
+#include "common/RingAllocator.h"
+#include "common/Serial.h"
+
+#include "glad/glad.h"
+
+#include <memory>
+
+namespace backend { namespace opengl {
+
+    class Device;
+
+    // Uploads data to buffers through a persistently mapped staging ring followed by
+    // glCopyBufferSubData. Unlike glBufferSubData this never makes the driver wait for the GPU
+    // to be done with the destination buffer, nor copy the data to a temporary on the
+    // calling thread. Falls back to glBufferSubData when ARB_buffer_storage isn't available or
+    // when the ring is full.
+    class BufferUploader {
+      public:
+        BufferUploader(Device* device);
+        ~BufferUploader();
+
+        void BufferSubData(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+        void Tick(Serial completedSerial);
+
+      private:
+        bool UseRing(GLsizeiptr size) const;
+
+        Device* mDevice = nullptr;
+
+        GLuint mRingBuffer = 0;
+        uint8_t* mRingPointer = nullptr;
+        std::unique_ptr<RingAllocator> mRingAllocator;
+        // The serial of the last upload done through the ring, it must be fenced for the space
+        // to be reclaimed.
+        Serial mLastUploadSerial = 0;
+    };
+
+}}  // namespace backend::opengl
+
+#endif  // BACKEND_OPENGL_BUFFERUPLOADERGL_H_
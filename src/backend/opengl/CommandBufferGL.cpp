@@ -15,17 +15,21 @@
 #include "backend/opengl/CommandBufferGL.h"
 
 #include "backend/Commands.h"
+#include "backend/RenderBundle.h"
 #include "backend/opengl/BufferGL.h"
 #include "backend/opengl/ComputePipelineGL.h"
 #include "backend/opengl/InputStateGL.h"
 #include "backend/opengl/OpenGLBackend.h"
 #include "backend/opengl/PersistentPipelineStateGL.h"
 #include "backend/opengl/PipelineLayoutGL.h"
+#include "backend/opengl/QuerySetGL.h"
 #include "backend/opengl/RenderPipelineGL.h"
 #include "backend/opengl/SamplerGL.h"
 #include "backend/opengl/TextureGL.h"
 
 #include <cstring>
+#include <functional>
+#include <vector>
 
 namespace backend { namespace opengl {
 
@@ -54,6 +58,52 @@ namespace backend { namespace opengl {
             }
         }
 
+        void DrawArraysInstanced(GLenum topology,
+                                 uint32_t vertexCount,
+                                 uint32_t instanceCount,
+                                 uint32_t firstVertex,
+                                 uint32_t firstInstance) {
+            if (firstInstance > 0) {
+                glDrawArraysInstancedBaseInstance(topology, firstVertex, vertexCount, instanceCount,
+                                                  firstInstance);
+            } else {
+                // This branch is only needed on OpenGL < 4.2
+                glDrawArraysInstanced(topology, firstVertex, vertexCount, instanceCount);
+            }
+        }
+
+        void DrawElementsInstanced(GLenum topology,
+                                   GLenum formatType,
+                                   uint32_t indexCount,
+                                   uint32_t instanceCount,
+                                   size_t indexOffset,
+                                   uint32_t firstInstance) {
+            if (firstInstance > 0) {
+                glDrawElementsInstancedBaseInstance(topology, indexCount, formatType,
+                                                    reinterpret_cast<void*>(indexOffset),
+                                                    instanceCount, firstInstance);
+            } else {
+                // This branch is only needed on OpenGL < 4.2
+                glDrawElementsInstanced(topology, indexCount, formatType,
+                                        reinterpret_cast<void*>(indexOffset), instanceCount);
+            }
+        }
+
+        // glMultiDraw* have no instancing so they can only be used when all the draws have a
+        // single instance.
+        bool HasOnlySingleInstances(uint32_t drawCount,
+                                    const uint32_t* instanceCounts,
+                                    const uint32_t* firstInstances) {
+            for (uint32_t i = 0; i < drawCount; ++i) {
+                if (instanceCounts[i] != 1 || firstInstances[i] != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        using Operations = std::vector<std::function<void()>>;
+
         // Push constants are implemented using OpenGL uniforms, however they aren't part of the
         // global OpenGL state but are part of the program state instead. This means that we have to
         // reapply push constants on pipeline change.
@@ -89,7 +139,8 @@ namespace backend { namespace opengl {
                 }
             }
 
-            void Apply(PipelineBase* pipeline, PipelineGL* glPipeline) {
+            // Records the uniform updates for the dirty push constants, with their values.
+            void Apply(PipelineBase* pipeline, PipelineGL* glPipeline, Operations* operations) {
                 for (auto stage : IterateStages(kAllStages)) {
                     const auto& pushConstants = pipeline->GetPushConstants(stage);
                     const auto& glPushConstants = glPipeline->GetGLPushConstants(stage);
@@ -98,18 +149,23 @@ namespace backend { namespace opengl {
                          IterateBitSet(mDirtyBits[stage] & pushConstants.mask)) {
                         GLint location = glPushConstants[constant];
                         switch (pushConstants.types[constant]) {
-                            case PushConstantType::Int:
-                                glUniform1i(location,
-                                            *reinterpret_cast<GLint*>(&mValues[stage][constant]));
-                                break;
-                            case PushConstantType::UInt:
-                                glUniform1ui(location,
-                                             *reinterpret_cast<GLuint*>(&mValues[stage][constant]));
-                                break;
-                            case PushConstantType::Float:
-                                glUniform1f(location,
-                                            *reinterpret_cast<GLfloat*>(&mValues[stage][constant]));
-                                break;
+                            case PushConstantType::Int: {
+                                GLint value = *reinterpret_cast<GLint*>(&mValues[stage][constant]);
+                                operations->push_back(
+                                    [location, value]() { glUniform1i(location, value); });
+                            } break;
+                            case PushConstantType::UInt: {
+                                GLuint value =
+                                    *reinterpret_cast<GLuint*>(&mValues[stage][constant]);
+                                operations->push_back(
+                                    [location, value]() { glUniform1ui(location, value); });
+                            } break;
+                            case PushConstantType::Float: {
+                                GLfloat value =
+                                    *reinterpret_cast<GLfloat*>(&mValues[stage][constant]);
+                                operations->push_back(
+                                    [location, value]() { glUniform1f(location, value); });
+                            } break;
                         }
                     }
 
@@ -165,9 +221,12 @@ namespace backend { namespace opengl {
                 mLastInputState = ToBackend(inputState);
             }
 
-            void Apply() {
+            // Records the bindings of the dirty index and vertex buffers.
+            void Apply(Operations* operations) {
                 if (mIndexBufferDirty && mIndexBuffer != nullptr) {
-                    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer->GetHandle());
+                    GLuint buffer = mIndexBuffer->GetHandle();
+                    operations->push_back(
+                        [buffer]() { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer); });
                     mIndexBufferDirty = false;
                 }
 
@@ -183,12 +242,16 @@ namespace backend { namespace opengl {
                         auto input = mLastInputState->GetInput(slot);
                         auto components = VertexFormatNumComponents(attribute.format);
                         auto formatType = VertexFormatType(attribute.format);
-
-                        glBindBuffer(GL_ARRAY_BUFFER, buffer);
-                        glVertexAttribPointer(
-                            location, components, formatType, GL_FALSE, input.stride,
-                            reinterpret_cast<void*>(
-                                static_cast<intptr_t>(offset + attribute.offset)));
+                        GLsizei stride = input.stride;
+                        void* pointer = reinterpret_cast<void*>(
+                            static_cast<intptr_t>(offset + attribute.offset));
+
+                        operations->push_back(
+                            [buffer, location, components, formatType, stride, pointer]() {
+                                glBindBuffer(GL_ARRAY_BUFFER, buffer);
+                                glVertexAttribPointer(location, components, formatType, GL_FALSE,
+                                                      stride, pointer);
+                            });
                     }
                 }
 
@@ -206,6 +269,73 @@ namespace backend { namespace opengl {
             InputState* mLastInputState = nullptr;
         };
 
+        void ApplyBindGroup(SetBindGroupCmd* cmd,
+                            uint32_t* dynamicOffsets,
+                            PipelineBase* pipeline,
+                            PipelineGL* glPipeline) {
+            uint32_t dynamicOffsetIndex = 0;
+            size_t groupIndex = cmd->index;
+            BindGroup* group = ToBackend(cmd->group.Get());
+
+            const auto& indices =
+                ToBackend(pipeline->GetLayout())->GetBindingIndexInfo()[groupIndex];
+            const auto& layout = group->GetLayout()->GetBindingInfo();
+
+            for (uint32_t binding : IterateBitSet(layout.mask)) {
+                switch (layout.types[binding]) {
+                    case nxt::BindingType::UniformBuffer:
+                    case nxt::BindingType::DynamicUniformBuffer: {
+                        BufferView* view = ToBackend(group->GetBindingAsBufferView(binding));
+                        GLuint buffer = ToBackend(view->GetBuffer())->GetHandle();
+                        GLuint uboIndex = indices[binding];
+
+                        GLintptr offset = view->GetOffset();
+                        if (IsDynamicBufferBinding(layout.types[binding])) {
+                            offset += dynamicOffsets[dynamicOffsetIndex++];
+                        }
+                        glBindBufferRange(GL_UNIFORM_BUFFER, uboIndex, buffer, offset,
+                                          view->GetSize());
+                    } break;
+
+                    case nxt::BindingType::Sampler: {
+                        GLuint sampler = ToBackend(group->GetBindingAsSampler(binding))->GetHandle();
+                        GLuint samplerIndex = indices[binding];
+
+                        for (auto unit : glPipeline->GetTextureUnitsForSampler(samplerIndex)) {
+                            glBindSampler(unit, sampler);
+                        }
+                    } break;
+
+                    case nxt::BindingType::SampledTexture: {
+                        TextureView* view = ToBackend(group->GetBindingAsTextureView(binding));
+                        Texture* texture = ToBackend(view->GetTexture());
+                        GLuint handle = texture->GetHandle();
+                        GLenum target = texture->GetGLTarget();
+                        GLuint textureIndex = indices[binding];
+
+                        for (auto unit : glPipeline->GetTextureUnitsForTexture(textureIndex)) {
+                            glActiveTexture(GL_TEXTURE0 + unit);
+                            glBindTexture(target, handle);
+                        }
+                    } break;
+
+                    case nxt::BindingType::StorageBuffer:
+                    case nxt::BindingType::DynamicStorageBuffer: {
+                        BufferView* view = ToBackend(group->GetBindingAsBufferView(binding));
+                        GLuint buffer = ToBackend(view->GetBuffer())->GetHandle();
+                        GLuint ssboIndex = indices[binding];
+
+                        GLintptr offset = view->GetOffset();
+                        if (IsDynamicBufferBinding(layout.types[binding])) {
+                            offset += dynamicOffsets[dynamicOffsetIndex++];
+                        }
+                        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, ssboIndex, buffer, offset,
+                                          view->GetSize());
+                    } break;
+                }
+            }
+        }
+
     }  // namespace
 
     CommandBuffer::CommandBuffer(CommandBufferBuilder* builder)
@@ -217,425 +347,577 @@ namespace backend { namespace opengl {
     }
 
     void CommandBuffer::Execute() {
+        if (!mWasTranslated) {
+            Translate();
+        }
+
+        mPersistentPipelineState.SetDefaultState();
+        for (const auto& operation : mOperations) {
+            operation();
+        }
+
+        // HACK: cleanup a tiny bit of state to make this work with
+        // virtualized contexts enabled in Chromium
+        glBindSampler(0, 0);
+
+        if (!IsReusable()) {
+            mOperations.clear();
+            mWasTranslated = false;
+        }
+    }
+
+    // The operations only capture state that can't change between submits and read the rest, like
+    // the framebuffer clear colors, when they are executed. They point into the commands, which
+    // live as long as the command buffer.
+    void CommandBuffer::Translate() {
         Command type;
         PipelineBase* lastPipeline = nullptr;
         PipelineGL* lastGLPipeline = nullptr;
         RenderPipeline* lastRenderPipeline = nullptr;
         uint32_t indexBufferOffset = 0;
 
-        PersistentPipelineState persistentPipelineState;
-        persistentPipelineState.SetDefaultState();
-
         PushConstantTracker pushConstants;
         InputBufferTracker inputBuffers;
 
         RenderPass* currentRenderPass = nullptr;
         Framebuffer* currentFramebuffer = nullptr;
         uint32_t currentSubpass = 0;
-        GLuint currentFBO = 0;
 
-        while (mCommands.NextCommandId(&type)) {
+        Operations* operations = &mOperations;
+
+        CommandBufferIterator commands(&mCommands);
+        while (commands.NextCommandId(&type)) {
             switch (type) {
                 case Command::BeginComputePass: {
-                    mCommands.NextCommand<BeginComputePassCmd>();
+                    commands.NextCommand<BeginComputePassCmd>();
                     pushConstants.OnBeginPass();
                 } break;
 
+                case Command::BeginQuery: {
+                    BeginQueryCmd* cmd = commands.NextCommand<BeginQueryCmd>();
+                    QuerySet* querySet = ToBackend(cmd->querySet.Get());
+                    GLenum target = querySet->GetGLTarget();
+                    GLuint query = querySet->GetHandle(cmd->queryIndex);
+                    operations->push_back([target, query]() { glBeginQuery(target, query); });
+                } break;
+
                 case Command::BeginRenderPass: {
-                    auto* cmd = mCommands.NextCommand<BeginRenderPassCmd>();
+                    auto* cmd = commands.NextCommand<BeginRenderPassCmd>();
                     currentRenderPass = ToBackend(cmd->renderPass.Get());
                     currentFramebuffer = ToBackend(cmd->framebuffer.Get());
                     currentSubpass = 0;
                 } break;
 
                 case Command::BeginRenderSubpass: {
-                    mCommands.NextCommand<BeginRenderSubpassCmd>();
+                    commands.NextCommand<BeginRenderSubpassCmd>();
                     pushConstants.OnBeginPass();
                     inputBuffers.OnBeginPass();
 
-                    // TODO(kainino@chromium.org): This is added to possibly
-                    // work around an issue seen on Windows/Intel. It should
-                    // break any feedback loop before the clears, even if
-                    // there shouldn't be any negative effects from this.
-                    // Investigate whether it's actually needed.
-                    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-                    // TODO(kainino@chromium.org): possible future
-                    // optimization: create these framebuffers at
-                    // Framebuffer build time (or maybe CommandBuffer build
-                    // time) so they don't have to be created and destroyed
-                    // at draw time.
-                    glGenFramebuffers(1, &currentFBO);
-                    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, currentFBO);
-
-                    const auto& subpass = currentRenderPass->GetSubpassInfo(currentSubpass);
-
-                    // Mapping from attachmentSlot to GL framebuffer
-                    // attachment points. Defaults to zero (GL_NONE).
-                    std::array<GLenum, kMaxColorAttachments> drawBuffers = {};
-
-                    // Construct GL framebuffer
-
-                    unsigned int attachmentCount = 0;
-                    for (unsigned int location : IterateBitSet(subpass.colorAttachmentsSet)) {
-                        uint32_t attachment = subpass.colorAttachments[location];
-
-                        auto textureView = currentFramebuffer->GetTextureView(attachment);
-                        GLuint texture = ToBackend(textureView->GetTexture())->GetHandle();
-
-                        // Attach color buffers.
-                        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + location,
-                                               GL_TEXTURE_2D, texture, 0);
-                        drawBuffers[location] = GL_COLOR_ATTACHMENT0 + location;
-                        attachmentCount = location + 1;
-
-                        // TODO(kainino@chromium.org): the color clears (later in
-                        // this function) may be undefined for other texture formats.
-                        ASSERT(textureView->GetTexture()->GetFormat() ==
-                               nxt::TextureFormat::R8G8B8A8Unorm);
-                    }
-                    glDrawBuffers(attachmentCount, drawBuffers.data());
-
-                    if (subpass.depthStencilAttachmentSet) {
-                        uint32_t attachmentSlot = subpass.depthStencilAttachment;
-
-                        auto textureView = currentFramebuffer->GetTextureView(attachmentSlot);
-                        GLuint texture = ToBackend(textureView->GetTexture())->GetHandle();
-                        nxt::TextureFormat format = textureView->GetTexture()->GetFormat();
-
-                        // Attach depth/stencil buffer.
-                        GLenum glAttachment = 0;
-                        // TODO(kainino@chromium.org): it may be valid to just always use
-                        // GL_DEPTH_STENCIL_ATTACHMENT here.
-                        if (TextureFormatHasDepth(format)) {
-                            if (TextureFormatHasStencil(format)) {
-                                glAttachment = GL_DEPTH_STENCIL_ATTACHMENT;
-                            } else {
-                                glAttachment = GL_DEPTH_ATTACHMENT;
-                            }
-                        } else {
-                            glAttachment = GL_STENCIL_ATTACHMENT;
-                        }
-
-                        glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, glAttachment, GL_TEXTURE_2D,
-                                               texture, 0);
-
-                        // TODO(kainino@chromium.org): the depth/stencil clears (later in
-                        // this function) may be undefined for other texture formats.
-                        ASSERT(format == nxt::TextureFormat::D32FloatS8Uint);
-                    }
-
-                    // Clear framebuffer attachments as needed
-
-                    for (unsigned int location : IterateBitSet(subpass.colorAttachmentsSet)) {
-                        uint32_t attachmentSlot = subpass.colorAttachments[location];
-                        const auto& attachmentInfo =
-                            currentRenderPass->GetAttachmentInfo(attachmentSlot);
-
-                        // Only perform load op on first use
-                        if (attachmentInfo.firstSubpass == currentSubpass) {
-                            // Load op - color
-                            if (attachmentInfo.colorLoadOp == nxt::LoadOp::Clear) {
-                                const auto& clear = currentFramebuffer->GetClearColor(location);
-                                glClearBufferfv(GL_COLOR, location, clear.color);
-                            }
-                        }
-                    }
-
-                    if (subpass.depthStencilAttachmentSet) {
-                        uint32_t attachmentSlot = subpass.depthStencilAttachment;
-                        const auto& attachmentInfo =
-                            currentRenderPass->GetAttachmentInfo(attachmentSlot);
-
-                        // Only perform load op on first use
-                        if (attachmentInfo.firstSubpass == currentSubpass) {
-                            // Load op - depth/stencil
-                            const auto& clear = currentFramebuffer->GetClearDepthStencil(
-                                subpass.depthStencilAttachment);
-                            bool doDepthClear = TextureFormatHasDepth(attachmentInfo.format) &&
-                                                (attachmentInfo.depthLoadOp == nxt::LoadOp::Clear);
-                            bool doStencilClear =
-                                TextureFormatHasStencil(attachmentInfo.format) &&
-                                (attachmentInfo.stencilLoadOp == nxt::LoadOp::Clear);
-                            if (doDepthClear && doStencilClear) {
-                                glClearBufferfi(GL_DEPTH_STENCIL, 0, clear.depth, clear.stencil);
-                            } else if (doDepthClear) {
-                                glClearBufferfv(GL_DEPTH, 0, &clear.depth);
-                            } else if (doStencilClear) {
-                                const GLint clearStencil = clear.stencil;
-                                glClearBufferiv(GL_STENCIL, 0, &clearStencil);
-                            }
-                        }
-                    }
-
-                    glBlendColor(0, 0, 0, 0);
-                    glViewport(0, 0, currentFramebuffer->GetWidth(),
-                               currentFramebuffer->GetHeight());
+                    RenderPass* renderPass = currentRenderPass;
+                    Framebuffer* framebuffer = currentFramebuffer;
+                    uint32_t subpass = currentSubpass;
+                    operations->push_back([this, renderPass, framebuffer, subpass]() {
+                        BeginSubpass(renderPass, framebuffer, subpass);
+                    });
                 } break;
 
                 case Command::CopyBufferToBuffer: {
-                    CopyBufferToBufferCmd* copy = mCommands.NextCommand<CopyBufferToBufferCmd>();
-                    auto& src = copy->source;
-                    auto& dst = copy->destination;
-
-                    glBindBuffer(GL_PIXEL_PACK_BUFFER, ToBackend(src.buffer)->GetHandle());
-                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ToBackend(dst.buffer)->GetHandle());
-                    glCopyBufferSubData(GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER, src.offset,
-                                        dst.offset, copy->size);
-
-                    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    CopyBufferToBufferCmd* copy = commands.NextCommand<CopyBufferToBufferCmd>();
+                    operations->push_back([copy]() {
+                        auto& src = copy->source;
+                        auto& dst = copy->destination;
+
+                        glBindBuffer(GL_PIXEL_PACK_BUFFER, ToBackend(src.buffer)->GetHandle());
+                        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ToBackend(dst.buffer)->GetHandle());
+                        glCopyBufferSubData(GL_PIXEL_PACK_BUFFER, GL_PIXEL_UNPACK_BUFFER,
+                                            src.offset, dst.offset, copy->size);
+
+                        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    });
                 } break;
 
                 case Command::CopyBufferToTexture: {
-                    CopyBufferToTextureCmd* copy = mCommands.NextCommand<CopyBufferToTextureCmd>();
-                    auto& src = copy->source;
-                    auto& dst = copy->destination;
-                    Buffer* buffer = ToBackend(src.buffer.Get());
-                    Texture* texture = ToBackend(dst.texture.Get());
-                    GLenum target = texture->GetGLTarget();
-                    auto format = texture->GetGLFormat();
-
-                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->GetHandle());
-                    glActiveTexture(GL_TEXTURE0);
-                    glBindTexture(target, texture->GetHandle());
-
-                    ASSERT(texture->GetDimension() == nxt::TextureDimension::e2D);
-                    glPixelStorei(GL_UNPACK_ROW_LENGTH,
-                                  copy->rowPitch / TextureFormatPixelSize(texture->GetFormat()));
-                    glTexSubImage2D(target, dst.level, dst.x, dst.y, dst.width, dst.height,
-                                    format.format, format.type,
-                                    reinterpret_cast<void*>(static_cast<uintptr_t>(src.offset)));
-                    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    CopyBufferToTextureCmd* copy = commands.NextCommand<CopyBufferToTextureCmd>();
+                    operations->push_back([copy]() {
+                        auto& src = copy->source;
+                        auto& dst = copy->destination;
+                        Buffer* buffer = ToBackend(src.buffer.Get());
+                        Texture* texture = ToBackend(dst.texture.Get());
+                        GLenum target = texture->GetGLTarget();
+                        auto format = texture->GetGLFormat();
+
+                        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->GetHandle());
+                        glActiveTexture(GL_TEXTURE0);
+                        glBindTexture(target, texture->GetHandle());
+
+                        ASSERT(texture->GetDimension() == nxt::TextureDimension::e2D);
+                        glPixelStorei(GL_UNPACK_ROW_LENGTH,
+                                      copy->rowPitch / TextureFormatPixelSize(texture->GetFormat()));
+                        glTexSubImage2D(target, dst.level, dst.x, dst.y, dst.width, dst.height,
+                                        format.format, format.type,
+                                        reinterpret_cast<void*>(static_cast<uintptr_t>(src.offset)));
+                        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+                        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                    });
                 } break;
 
                 case Command::CopyTextureToBuffer: {
-                    CopyTextureToBufferCmd* copy = mCommands.NextCommand<CopyTextureToBufferCmd>();
-                    auto& src = copy->source;
-                    auto& dst = copy->destination;
-                    Texture* texture = ToBackend(src.texture.Get());
-                    Buffer* buffer = ToBackend(dst.buffer.Get());
-                    auto format = texture->GetGLFormat();
-
-                    // The only way to move data from a texture to a buffer in GL is via
-                    // glReadPixels with a pack buffer. Create a temporary FBO for the copy.
-                    ASSERT(texture->GetDimension() == nxt::TextureDimension::e2D);
-                    glBindTexture(GL_TEXTURE_2D, texture->GetHandle());
-
-                    GLuint readFBO = 0;
-                    glGenFramebuffers(1, &readFBO);
-                    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
-
-                    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                                           texture->GetHandle(), src.level);
-
-                    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer->GetHandle());
-                    glPixelStorei(GL_PACK_ROW_LENGTH,
-                                  copy->rowPitch / TextureFormatPixelSize(texture->GetFormat()));
-                    ASSERT(src.depth == 1 && src.z == 0);
-                    void* offset = reinterpret_cast<void*>(static_cast<uintptr_t>(dst.offset));
-                    glReadPixels(src.x, src.y, src.width, src.height, format.format, format.type,
-                                 offset);
-                    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
-
-                    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-                    glDeleteFramebuffers(1, &readFBO);
+                    CopyTextureToBufferCmd* copy = commands.NextCommand<CopyTextureToBufferCmd>();
+                    operations->push_back([copy]() {
+                        auto& src = copy->source;
+                        auto& dst = copy->destination;
+                        Texture* texture = ToBackend(src.texture.Get());
+                        Buffer* buffer = ToBackend(dst.buffer.Get());
+                        auto format = texture->GetGLFormat();
+
+                        // The only way to move data from a texture to a buffer in GL is via
+                        // glReadPixels with a pack buffer. Create a temporary FBO for the copy.
+                        ASSERT(texture->GetDimension() == nxt::TextureDimension::e2D);
+                        glBindTexture(GL_TEXTURE_2D, texture->GetHandle());
+
+                        GLuint readFBO = 0;
+                        glGenFramebuffers(1, &readFBO);
+                        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+
+                        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                               GL_TEXTURE_2D, texture->GetHandle(), src.level);
+
+                        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer->GetHandle());
+                        glPixelStorei(GL_PACK_ROW_LENGTH,
+                                      copy->rowPitch / TextureFormatPixelSize(texture->GetFormat()));
+                        ASSERT(src.depth == 1 && src.z == 0);
+                        void* offset = reinterpret_cast<void*>(static_cast<uintptr_t>(dst.offset));
+                        glReadPixels(src.x, src.y, src.width, src.height, format.format,
+                                     format.type, offset);
+                        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+
+                        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                        glDeleteFramebuffers(1, &readFBO);
+                    });
                 } break;
 
                 case Command::Dispatch: {
-                    DispatchCmd* dispatch = mCommands.NextCommand<DispatchCmd>();
-                    pushConstants.Apply(lastPipeline, lastGLPipeline);
-                    glDispatchCompute(dispatch->x, dispatch->y, dispatch->z);
-                    // TODO(cwallez@chromium.org): add barriers to the API
-                    glMemoryBarrier(GL_ALL_BARRIER_BITS);
+                    DispatchCmd* dispatch = commands.NextCommand<DispatchCmd>();
+                    pushConstants.Apply(lastPipeline, lastGLPipeline, operations);
+                    operations->push_back([dispatch]() {
+                        glDispatchCompute(dispatch->x, dispatch->y, dispatch->z);
+                        // TODO(cwallez@chromium.org): add barriers to the API
+                        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+                    });
+                } break;
+
+                case Command::DispatchIndirect: {
+                    DispatchIndirectCmd* dispatch = commands.NextCommand<DispatchIndirectCmd>();
+                    pushConstants.Apply(lastPipeline, lastGLPipeline, operations);
+                    operations->push_back([dispatch]() {
+                        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER,
+                                     ToBackend(dispatch->indirectBuffer)->GetHandle());
+                        glDispatchComputeIndirect(static_cast<GLintptr>(dispatch->indirectOffset));
+                        // TODO(cwallez@chromium.org): add barriers to the API
+                        glMemoryBarrier(GL_ALL_BARRIER_BITS);
+                    });
                 } break;
 
                 case Command::DrawArrays: {
-                    DrawArraysCmd* draw = mCommands.NextCommand<DrawArraysCmd>();
-                    pushConstants.Apply(lastPipeline, lastGLPipeline);
-                    inputBuffers.Apply();
-
-                    if (draw->firstInstance > 0) {
-                        glDrawArraysInstancedBaseInstance(
-                            lastRenderPipeline->GetGLPrimitiveTopology(), draw->firstVertex,
-                            draw->vertexCount, draw->instanceCount, draw->firstInstance);
-                    } else {
-                        // This branch is only needed on OpenGL < 4.2
-                        glDrawArraysInstanced(lastRenderPipeline->GetGLPrimitiveTopology(),
-                                              draw->firstVertex, draw->vertexCount,
-                                              draw->instanceCount);
-                    }
+                    DrawArraysCmd* draw = commands.NextCommand<DrawArraysCmd>();
+                    pushConstants.Apply(lastPipeline, lastGLPipeline, operations);
+                    inputBuffers.Apply(operations);
+
+                    GLenum topology = lastRenderPipeline->GetGLPrimitiveTopology();
+                    operations->push_back([draw, topology]() {
+                        DrawArraysInstanced(topology, draw->vertexCount, draw->instanceCount,
+                                            draw->firstVertex, draw->firstInstance);
+                    });
+                } break;
+
+                case Command::DrawArraysIndirect: {
+                    DrawArraysIndirectCmd* draw = commands.NextCommand<DrawArraysIndirectCmd>();
+                    pushConstants.Apply(lastPipeline, lastGLPipeline, operations);
+                    inputBuffers.Apply(operations);
+
+                    GLenum topology = lastRenderPipeline->GetGLPrimitiveTopology();
+                    operations->push_back([draw, topology]() {
+                        glBindBuffer(GL_DRAW_INDIRECT_BUFFER,
+                                     ToBackend(draw->indirectBuffer)->GetHandle());
+                        glDrawArraysIndirect(topology, reinterpret_cast<void*>(static_cast<uintptr_t>(
+                                                           draw->indirectOffset)));
+                    });
                 } break;
 
                 case Command::DrawElements: {
-                    DrawElementsCmd* draw = mCommands.NextCommand<DrawElementsCmd>();
-                    pushConstants.Apply(lastPipeline, lastGLPipeline);
-                    inputBuffers.Apply();
+                    DrawElementsCmd* draw = commands.NextCommand<DrawElementsCmd>();
+                    pushConstants.Apply(lastPipeline, lastGLPipeline, operations);
+                    inputBuffers.Apply(operations);
 
                     nxt::IndexFormat indexFormat = lastRenderPipeline->GetIndexFormat();
                     size_t formatSize = IndexFormatSize(indexFormat);
                     GLenum formatType = IndexFormatType(indexFormat);
+                    GLenum topology = lastRenderPipeline->GetGLPrimitiveTopology();
+                    size_t indexOffset = draw->firstIndex * formatSize + indexBufferOffset;
+
+                    operations->push_back([draw, topology, formatType, indexOffset]() {
+                        DrawElementsInstanced(topology, formatType, draw->indexCount,
+                                              draw->instanceCount, indexOffset,
+                                              draw->firstInstance);
+                    });
+                } break;
 
-                    if (draw->firstInstance > 0) {
-                        glDrawElementsInstancedBaseInstance(
-                            lastRenderPipeline->GetGLPrimitiveTopology(), draw->indexCount,
-                            formatType,
-                            reinterpret_cast<void*>(draw->firstIndex * formatSize +
-                                                    indexBufferOffset),
-                            draw->instanceCount, draw->firstInstance);
-                    } else {
-                        // This branch is only needed on OpenGL < 4.2
-                        glDrawElementsInstanced(
-                            lastRenderPipeline->GetGLPrimitiveTopology(), draw->indexCount,
-                            formatType,
-                            reinterpret_cast<void*>(draw->firstIndex * formatSize +
-                                                    indexBufferOffset),
-                            draw->instanceCount);
-                    }
+                case Command::DrawElementsIndirect: {
+                    DrawElementsIndirectCmd* draw =
+                        commands.NextCommand<DrawElementsIndirectCmd>();
+                    pushConstants.Apply(lastPipeline, lastGLPipeline, operations);
+                    inputBuffers.Apply(operations);
+
+                    // The frontend validates that the index buffer offset is 0 because the first
+                    // index of the arguments is relative to the start of the index buffer.
+                    ASSERT(indexBufferOffset == 0);
+                    GLenum formatType = IndexFormatType(lastRenderPipeline->GetIndexFormat());
+                    GLenum topology = lastRenderPipeline->GetGLPrimitiveTopology();
+                    operations->push_back([draw, topology, formatType]() {
+                        glBindBuffer(GL_DRAW_INDIRECT_BUFFER,
+                                     ToBackend(draw->indirectBuffer)->GetHandle());
+                        glDrawElementsIndirect(
+                            topology, formatType,
+                            reinterpret_cast<void*>(static_cast<uintptr_t>(draw->indirectOffset)));
+                    });
                 } break;
 
                 case Command::EndComputePass: {
-                    mCommands.NextCommand<EndComputePassCmd>();
+                    commands.NextCommand<EndComputePassCmd>();
+                } break;
+
+                case Command::EndQuery: {
+                    EndQueryCmd* cmd = commands.NextCommand<EndQueryCmd>();
+                    GLenum target = ToBackend(cmd->querySet.Get())->GetGLTarget();
+                    operations->push_back([target]() { glEndQuery(target); });
                 } break;
 
                 case Command::EndRenderPass: {
-                    mCommands.NextCommand<EndRenderPassCmd>();
+                    commands.NextCommand<EndRenderPassCmd>();
                 } break;
 
                 case Command::EndRenderSubpass: {
-                    mCommands.NextCommand<EndRenderSubpassCmd>();
-                    glDeleteFramebuffers(1, &currentFBO);
-                    currentFBO = 0;
+                    commands.NextCommand<EndRenderSubpassCmd>();
+                    operations->push_back([this]() {
+                        glDeleteFramebuffers(1, &mCurrentFBO);
+                        mCurrentFBO = 0;
+                    });
                     currentSubpass += 1;
                 } break;
 
+                case Command::MultiDrawArrays: {
+                    MultiDrawArraysCmd* draw = commands.NextCommand<MultiDrawArraysCmd>();
+                    uint32_t* vertexCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* instanceCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstVertices = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstInstances = commands.NextData<uint32_t>(draw->drawCount);
+                    pushConstants.Apply(lastPipeline, lastGLPipeline, operations);
+                    inputBuffers.Apply(operations);
+
+                    GLenum topology = lastRenderPipeline->GetGLPrimitiveTopology();
+                    if (HasOnlySingleInstances(draw->drawCount, instanceCounts, firstInstances)) {
+                        operations->push_back([draw, topology, vertexCounts, firstVertices]() {
+                            glMultiDrawArrays(topology, reinterpret_cast<GLint*>(firstVertices),
+                                              reinterpret_cast<GLsizei*>(vertexCounts),
+                                              static_cast<GLsizei>(draw->drawCount));
+                        });
+                    } else {
+                        operations->push_back([draw, topology, vertexCounts, instanceCounts,
+                                               firstVertices, firstInstances]() {
+                            for (uint32_t i = 0; i < draw->drawCount; ++i) {
+                                DrawArraysInstanced(topology, vertexCounts[i], instanceCounts[i],
+                                                    firstVertices[i], firstInstances[i]);
+                            }
+                        });
+                    }
+                } break;
+
+                case Command::MultiDrawElements: {
+                    MultiDrawElementsCmd* draw = commands.NextCommand<MultiDrawElementsCmd>();
+                    uint32_t* indexCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* instanceCounts = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstIndices = commands.NextData<uint32_t>(draw->drawCount);
+                    uint32_t* firstInstances = commands.NextData<uint32_t>(draw->drawCount);
+                    pushConstants.Apply(lastPipeline, lastGLPipeline, operations);
+                    inputBuffers.Apply(operations);
+
+                    nxt::IndexFormat indexFormat = lastRenderPipeline->GetIndexFormat();
+                    size_t formatSize = IndexFormatSize(indexFormat);
+                    GLenum formatType = IndexFormatType(indexFormat);
+                    GLenum topology = lastRenderPipeline->GetGLPrimitiveTopology();
+
+                    std::vector<const void*> indexOffsets(draw->drawCount);
+                    for (uint32_t i = 0; i < draw->drawCount; ++i) {
+                        indexOffsets[i] = reinterpret_cast<const void*>(
+                            firstIndices[i] * formatSize + indexBufferOffset);
+                    }
+
+                    if (HasOnlySingleInstances(draw->drawCount, instanceCounts, firstInstances)) {
+                        operations->push_back([draw, topology, formatType, indexCounts,
+                                               indexOffsets = std::move(indexOffsets)]() {
+                            glMultiDrawElements(topology, reinterpret_cast<GLsizei*>(indexCounts),
+                                                formatType, indexOffsets.data(),
+                                                static_cast<GLsizei>(draw->drawCount));
+                        });
+                    } else {
+                        operations->push_back([draw, topology, formatType, indexCounts,
+                                               instanceCounts, firstInstances,
+                                               indexOffsets = std::move(indexOffsets)]() {
+                            for (uint32_t i = 0; i < draw->drawCount; ++i) {
+                                DrawElementsInstanced(
+                                    topology, formatType, indexCounts[i], instanceCounts[i],
+                                    reinterpret_cast<size_t>(indexOffsets[i]), firstInstances[i]);
+                            }
+                        });
+                    }
+                } break;
+
+                case Command::ResolveQuerySet: {
+                    ResolveQuerySetCmd* cmd = commands.NextCommand<ResolveQuerySetCmd>();
+                    if (ToBackend(GetDevice())->SupportsQueryBuffer()) {
+                        operations->push_back([cmd]() {
+                            QuerySet* querySet = ToBackend(cmd->querySet.Get());
+                            GLuint buffer = ToBackend(cmd->destination)->GetHandle();
+
+                            // With a query buffer bound the results are written by the GL
+                            // without waiting for them on the CPU.
+                            glBindBuffer(GL_QUERY_BUFFER, buffer);
+                            for (uint32_t i = 0; i < cmd->queryCount; ++i) {
+                                uintptr_t offset = cmd->destinationOffset + i * sizeof(uint64_t);
+                                glGetQueryObjectui64v(querySet->GetHandle(cmd->firstQuery + i),
+                                                      GL_QUERY_RESULT,
+                                                      reinterpret_cast<GLuint64*>(offset));
+                            }
+                            glBindBuffer(GL_QUERY_BUFFER, 0);
+                        });
+                    } else {
+                        operations->push_back([cmd]() {
+                            QuerySet* querySet = ToBackend(cmd->querySet.Get());
+                            GLuint buffer = ToBackend(cmd->destination)->GetHandle();
+
+                            // Without query buffers the results are waited for on the CPU and
+                            // uploaded to the destination.
+                            std::vector<GLuint64> results(cmd->queryCount);
+                            for (uint32_t i = 0; i < cmd->queryCount; ++i) {
+                                glGetQueryObjectui64v(querySet->GetHandle(cmd->firstQuery + i),
+                                                      GL_QUERY_RESULT, &results[i]);
+                            }
+                            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+                            glBufferSubData(GL_ARRAY_BUFFER, cmd->destinationOffset,
+                                            results.size() * sizeof(GLuint64), results.data());
+                        });
+                    }
+                } break;
+
                 case Command::SetComputePipeline: {
-                    SetComputePipelineCmd* cmd = mCommands.NextCommand<SetComputePipelineCmd>();
-                    ToBackend(cmd->pipeline)->ApplyNow();
-                    lastGLPipeline = ToBackend(cmd->pipeline).Get();
-                    lastPipeline = ToBackend(cmd->pipeline).Get();
+                    SetComputePipelineCmd* cmd = commands.NextCommand<SetComputePipelineCmd>();
+                    ComputePipeline* pipeline = ToBackend(cmd->pipeline).Get();
+                    operations->push_back([pipeline]() { pipeline->ApplyNow(); });
+                    lastGLPipeline = pipeline;
+                    lastPipeline = pipeline;
                     pushConstants.OnSetPipeline(lastPipeline);
                 } break;
 
                 case Command::SetRenderPipeline: {
-                    SetRenderPipelineCmd* cmd = mCommands.NextCommand<SetRenderPipelineCmd>();
-                    ToBackend(cmd->pipeline)->ApplyNow(persistentPipelineState);
-                    lastRenderPipeline = ToBackend(cmd->pipeline).Get();
-                    lastGLPipeline = ToBackend(cmd->pipeline).Get();
-                    lastPipeline = ToBackend(cmd->pipeline).Get();
+                    SetRenderPipelineCmd* cmd = commands.NextCommand<SetRenderPipelineCmd>();
+                    RenderPipeline* pipeline = ToBackend(cmd->pipeline).Get();
+                    operations->push_back(
+                        [this, pipeline]() { pipeline->ApplyNow(mPersistentPipelineState); });
+                    lastRenderPipeline = pipeline;
+                    lastGLPipeline = pipeline;
+                    lastPipeline = pipeline;
 
                     pushConstants.OnSetPipeline(lastPipeline);
                     inputBuffers.OnSetPipeline(lastRenderPipeline);
                 } break;
 
                 case Command::SetPushConstants: {
-                    SetPushConstantsCmd* cmd = mCommands.NextCommand<SetPushConstantsCmd>();
-                    uint32_t* data = mCommands.NextData<uint32_t>(cmd->count);
+                    SetPushConstantsCmd* cmd = commands.NextCommand<SetPushConstantsCmd>();
+                    uint32_t* data = commands.NextData<uint32_t>(cmd->count);
                     pushConstants.OnSetPushConstants(cmd->stages, cmd->count, cmd->offset, data);
                 } break;
 
                 case Command::SetStencilReference: {
-                    SetStencilReferenceCmd* cmd = mCommands.NextCommand<SetStencilReferenceCmd>();
-                    persistentPipelineState.SetStencilReference(cmd->reference);
+                    SetStencilReferenceCmd* cmd = commands.NextCommand<SetStencilReferenceCmd>();
+                    operations->push_back([this, cmd]() {
+                        mPersistentPipelineState.SetStencilReference(cmd->reference);
+                    });
                 } break;
 
                 case Command::SetBlendColor: {
-                    SetBlendColorCmd* cmd = mCommands.NextCommand<SetBlendColorCmd>();
-                    glBlendColor(cmd->r, cmd->g, cmd->b, cmd->a);
+                    SetBlendColorCmd* cmd = commands.NextCommand<SetBlendColorCmd>();
+                    operations->push_back(
+                        [cmd]() { glBlendColor(cmd->r, cmd->g, cmd->b, cmd->a); });
                 } break;
 
                 case Command::SetBindGroup: {
-                    SetBindGroupCmd* cmd = mCommands.NextCommand<SetBindGroupCmd>();
-                    size_t groupIndex = cmd->index;
-                    BindGroup* group = ToBackend(cmd->group.Get());
-
-                    const auto& indices =
-                        ToBackend(lastPipeline->GetLayout())->GetBindingIndexInfo()[groupIndex];
-                    const auto& layout = group->GetLayout()->GetBindingInfo();
-
-                    for (uint32_t binding : IterateBitSet(layout.mask)) {
-                        switch (layout.types[binding]) {
-                            case nxt::BindingType::UniformBuffer: {
-                                BufferView* view =
-                                    ToBackend(group->GetBindingAsBufferView(binding));
-                                GLuint buffer = ToBackend(view->GetBuffer())->GetHandle();
-                                GLuint uboIndex = indices[binding];
-
-                                glBindBufferRange(GL_UNIFORM_BUFFER, uboIndex, buffer,
-                                                  view->GetOffset(), view->GetSize());
-                            } break;
-
-                            case nxt::BindingType::Sampler: {
-                                GLuint sampler =
-                                    ToBackend(group->GetBindingAsSampler(binding))->GetHandle();
-                                GLuint samplerIndex = indices[binding];
-
-                                for (auto unit :
-                                     lastGLPipeline->GetTextureUnitsForSampler(samplerIndex)) {
-                                    glBindSampler(unit, sampler);
-                                }
-                            } break;
-
-                            case nxt::BindingType::SampledTexture: {
-                                TextureView* view =
-                                    ToBackend(group->GetBindingAsTextureView(binding));
-                                Texture* texture = ToBackend(view->GetTexture());
-                                GLuint handle = texture->GetHandle();
-                                GLenum target = texture->GetGLTarget();
-                                GLuint textureIndex = indices[binding];
-
-                                for (auto unit :
-                                     lastGLPipeline->GetTextureUnitsForTexture(textureIndex)) {
-                                    glActiveTexture(GL_TEXTURE0 + unit);
-                                    glBindTexture(target, handle);
-                                }
-                            } break;
-
-                            case nxt::BindingType::StorageBuffer: {
-                                BufferView* view =
-                                    ToBackend(group->GetBindingAsBufferView(binding));
-                                GLuint buffer = ToBackend(view->GetBuffer())->GetHandle();
-                                GLuint ssboIndex = indices[binding];
-
-                                glBindBufferRange(GL_SHADER_STORAGE_BUFFER, ssboIndex, buffer,
-                                                  view->GetOffset(), view->GetSize());
-                            } break;
-                        }
-                    }
+                    SetBindGroupCmd* cmd = commands.NextCommand<SetBindGroupCmd>();
+                    uint32_t* dynamicOffsets = commands.NextData<uint32_t>(cmd->dynamicOffsetCount);
+                    PipelineBase* pipeline = lastPipeline;
+                    PipelineGL* glPipeline = lastGLPipeline;
+                    operations->push_back([cmd, dynamicOffsets, pipeline, glPipeline]() {
+                        ApplyBindGroup(cmd, dynamicOffsets, pipeline, glPipeline);
+                    });
                 } break;
 
                 case Command::SetIndexBuffer: {
-                    SetIndexBufferCmd* cmd = mCommands.NextCommand<SetIndexBufferCmd>();
+                    SetIndexBufferCmd* cmd = commands.NextCommand<SetIndexBufferCmd>();
                     indexBufferOffset = cmd->offset;
                     inputBuffers.OnSetIndexBuffer(cmd->buffer.Get());
                 } break;
 
                 case Command::SetVertexBuffers: {
-                    SetVertexBuffersCmd* cmd = mCommands.NextCommand<SetVertexBuffersCmd>();
-                    auto buffers = mCommands.NextData<Ref<BufferBase>>(cmd->count);
-                    auto offsets = mCommands.NextData<uint32_t>(cmd->count);
+                    SetVertexBuffersCmd* cmd = commands.NextCommand<SetVertexBuffersCmd>();
+                    auto buffers = commands.NextData<Ref<BufferBase>>(cmd->count);
+                    auto offsets = commands.NextData<uint32_t>(cmd->count);
                     inputBuffers.OnSetVertexBuffers(cmd->startSlot, cmd->count, buffers, offsets);
                 } break;
 
+                case Command::ExecuteBundles:
+                    // The iterator replaces bundles with their commands.
+                    UNREACHABLE();
+                    break;
+
                 case Command::TransitionBufferUsage: {
                     TransitionBufferUsageCmd* cmd =
-                        mCommands.NextCommand<TransitionBufferUsageCmd>();
-
-                    cmd->buffer->UpdateUsageInternal(cmd->usage);
+                        commands.NextCommand<TransitionBufferUsageCmd>();
+                    operations->push_back(
+                        [cmd]() { cmd->buffer->UpdateUsageInternal(cmd->usage); });
                 } break;
 
                 case Command::TransitionTextureUsage: {
                     TransitionTextureUsageCmd* cmd =
-                        mCommands.NextCommand<TransitionTextureUsageCmd>();
+                        commands.NextCommand<TransitionTextureUsageCmd>();
+                    operations->push_back(
+                        [cmd]() { cmd->texture->UpdateUsageInternal(cmd->usage); });
+                } break;
 
-                    cmd->texture->UpdateUsageInternal(cmd->usage);
+                case Command::WriteTimestamp: {
+                    WriteTimestampCmd* cmd = commands.NextCommand<WriteTimestampCmd>();
+                    GLuint query = ToBackend(cmd->querySet.Get())->GetHandle(cmd->queryIndex);
+                    operations->push_back([query]() { glQueryCounter(query, GL_TIMESTAMP); });
                 } break;
             }
         }
+        mWasTranslated = true;
+    }
 
-        // HACK: cleanup a tiny bit of state to make this work with
-        // virtualized contexts enabled in Chromium
-        glBindSampler(0, 0);
+    void CommandBuffer::BeginSubpass(RenderPass* renderPass,
+                                     Framebuffer* framebuffer,
+                                     uint32_t subpassIndex) {
+        // TODO(kainino@chromium.org): This is added to possibly
+        // work around an issue seen on Windows/Intel. It should
+        // break any feedback loop before the clears, even if
+        // there shouldn't be any negative effects from this.
+        // Investigate whether it's actually needed.
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        // TODO(kainino@chromium.org): possible future
+        // optimization: create these framebuffers at
+        // Framebuffer build time (or maybe CommandBuffer build
+        // time) so they don't have to be created and destroyed
+        // at draw time.
+        glGenFramebuffers(1, &mCurrentFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, mCurrentFBO);
+
+        const auto& subpass = renderPass->GetSubpassInfo(subpassIndex);
+
+        // Mapping from attachmentSlot to GL framebuffer
+        // attachment points. Defaults to zero (GL_NONE).
+        std::array<GLenum, kMaxColorAttachments> drawBuffers = {};
+
+        // Construct GL framebuffer
+
+        unsigned int attachmentCount = 0;
+        for (unsigned int location : IterateBitSet(subpass.colorAttachmentsSet)) {
+            uint32_t attachment = subpass.colorAttachments[location];
+
+            auto textureView = framebuffer->GetTextureView(attachment);
+            GLuint texture = ToBackend(textureView->GetTexture())->GetHandle();
+
+            // Attach color buffers.
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + location,
+                                   GL_TEXTURE_2D, texture, 0);
+            drawBuffers[location] = GL_COLOR_ATTACHMENT0 + location;
+            attachmentCount = location + 1;
+
+            // TODO(kainino@chromium.org): the color clears (later in
+            // this function) may be undefined for other texture formats.
+            ASSERT(textureView->GetTexture()->GetFormat() == nxt::TextureFormat::R8G8B8A8Unorm);
+        }
+        glDrawBuffers(attachmentCount, drawBuffers.data());
+
+        if (subpass.depthStencilAttachmentSet) {
+            uint32_t attachmentSlot = subpass.depthStencilAttachment;
+
+            auto textureView = framebuffer->GetTextureView(attachmentSlot);
+            GLuint texture = ToBackend(textureView->GetTexture())->GetHandle();
+            nxt::TextureFormat format = textureView->GetTexture()->GetFormat();
+
+            // Attach depth/stencil buffer.
+            GLenum glAttachment = 0;
+            // TODO(kainino@chromium.org): it may be valid to just always use
+            // GL_DEPTH_STENCIL_ATTACHMENT here.
+            if (TextureFormatHasDepth(format)) {
+                if (TextureFormatHasStencil(format)) {
+                    glAttachment = GL_DEPTH_STENCIL_ATTACHMENT;
+                } else {
+                    glAttachment = GL_DEPTH_ATTACHMENT;
+                }
+            } else {
+                glAttachment = GL_STENCIL_ATTACHMENT;
+            }
+
+            glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, glAttachment, GL_TEXTURE_2D, texture, 0);
+
+            // TODO(kainino@chromium.org): the depth/stencil clears (later in
+            // this function) may be undefined for other texture formats.
+            ASSERT(format == nxt::TextureFormat::D32FloatS8Uint);
+        }
+
+        // Clear framebuffer attachments as needed. The clear values can change between submits
+        // so they are read when the operations are executed.
+
+        for (unsigned int location : IterateBitSet(subpass.colorAttachmentsSet)) {
+            uint32_t attachmentSlot = subpass.colorAttachments[location];
+            const auto& attachmentInfo = renderPass->GetAttachmentInfo(attachmentSlot);
+
+            // Only perform load op on first use
+            if (attachmentInfo.firstSubpass == subpassIndex) {
+                // Load op - color
+                if (attachmentInfo.colorLoadOp == nxt::LoadOp::Clear) {
+                    const auto& clear = framebuffer->GetClearColor(location);
+                    glClearBufferfv(GL_COLOR, location, clear.color);
+                }
+            }
+        }
+
+        if (subpass.depthStencilAttachmentSet) {
+            uint32_t attachmentSlot = subpass.depthStencilAttachment;
+            const auto& attachmentInfo = renderPass->GetAttachmentInfo(attachmentSlot);
+
+            // Only perform load op on first use
+            if (attachmentInfo.firstSubpass == subpassIndex) {
+                // Load op - depth/stencil
+                const auto& clear =
+                    framebuffer->GetClearDepthStencil(subpass.depthStencilAttachment);
+                bool doDepthClear = TextureFormatHasDepth(attachmentInfo.format) &&
+                                    (attachmentInfo.depthLoadOp == nxt::LoadOp::Clear);
+                bool doStencilClear = TextureFormatHasStencil(attachmentInfo.format) &&
+                                      (attachmentInfo.stencilLoadOp == nxt::LoadOp::Clear);
+                if (doDepthClear && doStencilClear) {
+                    glClearBufferfi(GL_DEPTH_STENCIL, 0, clear.depth, clear.stencil);
+                } else if (doDepthClear) {
+                    glClearBufferfv(GL_DEPTH, 0, &clear.depth);
+                } else if (doStencilClear) {
+                    const GLint clearStencil = clear.stencil;
+                    glClearBufferiv(GL_STENCIL, 0, &clearStencil);
+                }
+            }
+        }
+
+        glBlendColor(0, 0, 0, 0);
+        glViewport(0, 0, framebuffer->GetWidth(), framebuffer->GetHeight());
     }
 
 }}  // namespace backend::opengl
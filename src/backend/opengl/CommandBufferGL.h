@@ -17,10 +17,16 @@
 
 #include "backend/CommandAllocator.h"
 #include "backend/CommandBuffer.h"
+#include "backend/opengl/PersistentPipelineStateGL.h"
+
+#include <functional>
+#include <vector>
 
 namespace backend { namespace opengl {
 
     class Device;
+    class Framebuffer;
+    class RenderPass;
 
     class CommandBuffer : public CommandBufferBase {
       public:
@@ -30,7 +36,19 @@ namespace backend { namespace opengl {
         void Execute();
 
       private:
+        // Does the state tracking of the commands and records the GL calls they result in.
+        void Translate();
+        void BeginSubpass(RenderPass* renderPass, Framebuffer* framebuffer, uint32_t subpass);
+
         CommandIterator mCommands;
+
+        // Reusable command buffers keep their operations to replay them on the next submits.
+        std::vector<std::function<void()>> mOperations;
+        bool mWasTranslated = false;
+
+        // State used by the operations while they are executed.
+        PersistentPipelineState mPersistentPipelineState;
+        GLuint mCurrentFBO = 0;
     };
 
 }}  // namespace backend::opengl
@@ -16,26 +16,56 @@
 
 #include "backend/opengl/BlendStateGL.h"
 #include "backend/opengl/BufferGL.h"
+#include "backend/opengl/BufferUploaderGL.h"
 #include "backend/opengl/CommandBufferGL.h"
 #include "backend/opengl/ComputePipelineGL.h"
 #include "backend/opengl/DepthStencilStateGL.h"
 #include "backend/opengl/InputStateGL.h"
 #include "backend/opengl/PipelineLayoutGL.h"
+#include "backend/opengl/QuerySetGL.h"
 #include "backend/opengl/RenderPipelineGL.h"
 #include "backend/opengl/SamplerGL.h"
 #include "backend/opengl/ShaderModuleGL.h"
 #include "backend/opengl/SwapChainGL.h"
 #include "backend/opengl/TextureGL.h"
 
+#include <cstring>
+
 namespace backend { namespace opengl {
     nxtProcTable GetNonValidatingProcs();
     nxtProcTable GetValidatingProcs();
 
+    namespace {
+
+        bool HasExtension(const char* name) {
+            GLint extensionCount = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+            for (GLint i = 0; i < extensionCount; ++i) {
+                const char* extension =
+                    reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+                if (strcmp(extension, name) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        constexpr GLuint64 kFenceWaitTimeoutNs = 1000 * 1000 * 1000;
+
+    }  // anonymous namespace
+
     void Init(void* (*getProc)(const char*), nxtProcTable* procs, nxtDevice* device) {
         *device = nullptr;
 
         gladLoadGLLoader(reinterpret_cast<GLADloadproc>(getProc));
 
+        // ARB_buffer_storage exposes glBufferStorage under its core name but glad only loads it
+        // for GL 4.4 contexts, so load it manually when only the extension is present.
+        if (!GLAD_GL_VERSION_4_4 && HasExtension("GL_ARB_buffer_storage")) {
+            glad_glBufferStorage =
+                reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(getProc("glBufferStorage"));
+        }
+
         *procs = GetValidatingProcs();
         *device = reinterpret_cast<nxtDevice>(new Device);
 
@@ -43,8 +73,48 @@ namespace backend { namespace opengl {
         glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
     }
 
+    void StartFenceWaiter(nxtDevice device, void (*makeCurrent)(void* userdata), void* userdata) {
+        reinterpret_cast<Device*>(device)->StartFenceWaiter(makeCurrent, userdata);
+    }
+
     // Device
 
+    Device::Device() {
+        mSupportsBufferStorage = glBufferStorage != nullptr;
+        mSupportsQueryBuffer = GLAD_GL_VERSION_4_4 || HasExtension("GL_ARB_query_buffer_object");
+
+        mBufferUploader = new BufferUploader(this);
+        mMapReadRequestTracker = new MapReadRequestTracker(this);
+    }
+
+    Device::~Device() {
+        // Fence all the commands and wait for the GPU to be done with them so that all the
+        // operations waiting on a serial complete.
+        InsertFence();
+        glFinish();
+
+        // The waiter handles all the fences it was given before stopping.
+        if (mFenceWaiterThread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mFenceWaiterMutex);
+                mStopFenceWaiter = true;
+                mFenceWaiterCondition.notify_all();
+            }
+            mFenceWaiterThread.join();
+        }
+
+        CheckPassedFences();
+        ASSERT(mFencesInFlight.empty());
+        mCompletedSerial = mNextSerial;
+        Tick();
+
+        delete mBufferUploader;
+        mBufferUploader = nullptr;
+
+        delete mMapReadRequestTracker;
+        mMapReadRequestTracker = nullptr;
+    }
+
     BindGroupBase* Device::CreateBindGroup(BindGroupBuilder* builder) {
         return new BindGroup(builder);
     }
@@ -78,9 +148,15 @@ namespace backend { namespace opengl {
     PipelineLayoutBase* Device::CreatePipelineLayout(PipelineLayoutBuilder* builder) {
         return new PipelineLayout(builder);
     }
+    QuerySetBase* Device::CreateQuerySet(QuerySetBuilder* builder) {
+        return new QuerySet(builder);
+    }
     QueueBase* Device::CreateQueue(QueueBuilder* builder) {
         return new Queue(builder);
     }
+    RenderBundleBase* Device::CreateRenderBundle(RenderBundleBuilder* builder) {
+        return new RenderBundleBase(builder);
+    }
     RenderPassBase* Device::CreateRenderPass(RenderPassBuilder* builder) {
         return new RenderPass(builder);
     }
@@ -104,6 +180,122 @@ namespace backend { namespace opengl {
     }
 
     void Device::TickImpl() {
+        CheckPassedFences();
+        mMapReadRequestTracker->Tick(mCompletedSerial);
+        mBufferUploader->Tick(mCompletedSerial);
+        mFenceSignalTracker.Tick(mCompletedSerial);
+    }
+
+    // Fences can only be polled with a current context, so without the waiter the device can't
+    // tell when work completes.
+    bool Device::SignalsCompletion() const {
+        return mFenceWaiterThread.joinable();
+    }
+
+    void Device::StartFenceWaiter(void (*makeCurrent)(void* userdata), void* userdata) {
+        ASSERT(!mFenceWaiterThread.joinable());
+
+        // The fences already in flight are given to the waiter, in order.
+        mFencesToWait = mFencesInFlight;
+
+        mFenceWaiterThread = std::thread(
+            [this, makeCurrent, userdata]() { FenceWaiterThreadMain(makeCurrent, userdata); });
+    }
+
+    BufferUploader* Device::GetBufferUploader() const {
+        return mBufferUploader;
+    }
+
+    bool Device::SupportsBufferStorage() const {
+        return mSupportsBufferStorage;
+    }
+
+    bool Device::SupportsQueryBuffer() const {
+        return mSupportsQueryBuffer;
+    }
+
+    FenceSignalTracker* Device::GetFenceSignalTracker() {
+        return &mFenceSignalTracker;
+    }
+
+    MapReadRequestTracker* Device::GetMapReadRequestTracker() const {
+        return mMapReadRequestTracker;
+    }
+
+    Serial Device::GetSerial() const {
+        return mNextSerial;
+    }
+
+    void Device::InsertFence() {
+        GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // Make sure the fence reaches the GPU, otherwise polling it could never see it signaled.
+        glFlush();
+
+        mFencesInFlight.emplace(sync, mNextSerial);
+        if (mFenceWaiterThread.joinable()) {
+            std::lock_guard<std::mutex> lock(mFenceWaiterMutex);
+            mFencesToWait.emplace(sync, mNextSerial);
+            mFenceWaiterCondition.notify_all();
+        }
+        mNextSerial++;
+    }
+
+    void Device::CheckPassedFences() {
+        while (!mFencesInFlight.empty()) {
+            GLsync sync = mFencesInFlight.front().first;
+            Serial fenceSerial = mFencesInFlight.front().second;
+
+            if (mFenceWaiterThread.joinable()) {
+                // The fence can't be deleted while the waiter can still be using it.
+                if (fenceSerial > mLastWaitedSerial.load()) {
+                    return;
+                }
+            } else {
+                // Poll with a zero timeout so that Tick never blocks on the GPU.
+                GLenum result = glClientWaitSync(sync, 0, 0);
+                ASSERT(result != GL_WAIT_FAILED);
+
+                // Fences are added in order, so we can stop searching as soon
+                // as we see one that's not ready.
+                if (result == GL_TIMEOUT_EXPIRED) {
+                    return;
+                }
+            }
+
+            glDeleteSync(sync);
+            mFencesInFlight.pop();
+
+            ASSERT(fenceSerial > mCompletedSerial);
+            mCompletedSerial = fenceSerial;
+        }
+    }
+
+    void Device::FenceWaiterThreadMain(void (*makeCurrent)(void* userdata), void* userdata) {
+        makeCurrent(userdata);
+
+        while (true) {
+            std::pair<GLsync, Serial> fenceAndSerial;
+            {
+                std::unique_lock<std::mutex> lock(mFenceWaiterMutex);
+                mFenceWaiterCondition.wait(
+                    lock, [this]() { return !mFencesToWait.empty() || mStopFenceWaiter; });
+                if (mFencesToWait.empty()) {
+                    return;
+                }
+                fenceAndSerial = mFencesToWait.front();
+                mFencesToWait.pop();
+            }
+
+            // InsertFence flushed the fence so it is guaranteed to be signaled eventually.
+            GLenum result;
+            do {
+                result = glClientWaitSync(fenceAndSerial.first, 0, kFenceWaitTimeoutNs);
+            } while (result == GL_TIMEOUT_EXPIRED);
+            ASSERT(result != GL_WAIT_FAILED);
+
+            mLastWaitedSerial = fenceAndSerial.second;
+            SignalCompletion();
+        }
     }
 
     // Bind Group
@@ -133,6 +325,14 @@ namespace backend { namespace opengl {
         }
     }
 
+    void Queue::SignalImpl(FenceBase* fence, uint64_t signalValue) {
+        // The fence completes with a GL fence inserted after the commands submitted so far.
+        Device* device = ToBackend(GetDevice());
+        device->GetFenceSignalTracker()->UpdateFenceOnComplete(fence, signalValue,
+                                                               device->GetSerial());
+        device->InsertFence();
+    }
+
     // RenderPass
 
     RenderPass::RenderPass(RenderPassBuilder* builder) : RenderPassBase(builder) {
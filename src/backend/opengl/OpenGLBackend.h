@@ -23,30 +23,44 @@
 #include "backend/Buffer.h"
 #include "backend/DepthStencilState.h"
 #include "backend/Device.h"
+#include "backend/Fence.h"
 #include "backend/Framebuffer.h"
 #include "backend/InputState.h"
 #include "backend/Queue.h"
+#include "backend/RenderBundle.h"
 #include "backend/RenderPass.h"
 #include "backend/ToBackend.h"
+#include "common/Serial.h"
 
 #include "glad/glad.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+
 namespace backend { namespace opengl {
 
     class BindGroup;
     class BindGroupLayout;
     class BlendState;
     class Buffer;
+    class BufferUploader;
     class BufferView;
     class CommandBuffer;
     class ComputePipeline;
     class DepthStencilState;
     class Device;
+    using Fence = FenceBase;
     class Framebuffer;
     class InputState;
+    class MapReadRequestTracker;
     class PersistentPipelineState;
     class PipelineLayout;
+    class QuerySet;
     class Queue;
+    using RenderBundle = RenderBundleBase;
     class RenderPass;
     class RenderPipeline;
     class Sampler;
@@ -65,10 +79,13 @@ namespace backend { namespace opengl {
         using ComputePipelineType = ComputePipeline;
         using DepthStencilStateType = DepthStencilState;
         using DeviceType = Device;
+        using FenceType = Fence;
         using FramebufferType = Framebuffer;
         using InputStateType = InputState;
         using PipelineLayoutType = PipelineLayout;
+        using QuerySetType = QuerySet;
         using QueueType = Queue;
+        using RenderBundleType = RenderBundle;
         using RenderPassType = RenderPass;
         using RenderPipelineType = RenderPipeline;
         using SamplerType = Sampler;
@@ -86,6 +103,9 @@ namespace backend { namespace opengl {
     // Definition of backend types
     class Device : public DeviceBase {
       public:
+        Device();
+        ~Device();
+
         BindGroupBase* CreateBindGroup(BindGroupBuilder* builder) override;
         BindGroupLayoutBase* CreateBindGroupLayout(BindGroupLayoutBuilder* builder) override;
         BlendStateBase* CreateBlendState(BlendStateBuilder* builder) override;
@@ -97,7 +117,9 @@ namespace backend { namespace opengl {
         InputStateBase* CreateInputState(InputStateBuilder* builder) override;
         FramebufferBase* CreateFramebuffer(FramebufferBuilder* builder) override;
         PipelineLayoutBase* CreatePipelineLayout(PipelineLayoutBuilder* builder) override;
+        QuerySetBase* CreateQuerySet(QuerySetBuilder* builder) override;
         QueueBase* CreateQueue(QueueBuilder* builder) override;
+        RenderBundleBase* CreateRenderBundle(RenderBundleBuilder* builder) override;
         RenderPassBase* CreateRenderPass(RenderPassBuilder* builder) override;
         RenderPipelineBase* CreateRenderPipeline(RenderPipelineBuilder* builder) override;
         SamplerBase* CreateSampler(SamplerBuilder* builder) override;
@@ -107,6 +129,51 @@ namespace backend { namespace opengl {
         TextureViewBase* CreateTextureView(TextureViewBuilder* builder) override;
 
         void TickImpl() override;
+        bool SignalsCompletion() const override;
+
+        // Starts a thread that waits on the fences and signals the completion fd when they pass.
+        // makeCurrent is called once on that thread and must make current a context that shares
+        // objects with the device's context, and that outlives the device.
+        void StartFenceWaiter(void (*makeCurrent)(void* userdata), void* userdata);
+
+        BufferUploader* GetBufferUploader() const;
+        // Whether glBufferStorage is available, either from GL 4.4 or ARB_buffer_storage.
+        bool SupportsBufferStorage() const;
+        // Whether query results can be written to GL_QUERY_BUFFER, from GL 4.4 or
+        // ARB_query_buffer_object.
+        bool SupportsQueryBuffer() const;
+        FenceSignalTracker* GetFenceSignalTracker();
+        MapReadRequestTracker* GetMapReadRequestTracker() const;
+
+        // The serial of the GL commands recorded since the last fence.
+        Serial GetSerial() const;
+        // Inserts a fence after the GL commands recorded so far, the current serial is completed
+        // when Tick sees it signaled.
+        void InsertFence();
+
+      private:
+        void CheckPassedFences();
+
+        bool mSupportsBufferStorage = false;
+        bool mSupportsQueryBuffer = false;
+        BufferUploader* mBufferUploader = nullptr;
+        FenceSignalTracker mFenceSignalTracker;
+        MapReadRequestTracker* mMapReadRequestTracker = nullptr;
+
+        std::queue<std::pair<GLsync, Serial>> mFencesInFlight;
+        Serial mNextSerial = 1;
+        Serial mCompletedSerial = 0;
+
+        // Sync objects are shared with the waiter's context. They are only deleted once the
+        // waiter is done with them.
+        void FenceWaiterThreadMain(void (*makeCurrent)(void* userdata), void* userdata);
+        std::thread mFenceWaiterThread;
+        std::mutex mFenceWaiterMutex;
+        std::condition_variable mFenceWaiterCondition;
+        // Protected by the mutex.
+        std::queue<std::pair<GLsync, Serial>> mFencesToWait;
+        bool mStopFenceWaiter = false;
+        std::atomic<Serial> mLastWaitedSerial{0};
     };
 
     class BindGroup : public BindGroupBase {
@@ -130,6 +197,9 @@ namespace backend { namespace opengl {
 
         // NXT API
         void Submit(uint32_t numCommands, CommandBuffer* const* commands);
+
+      private:
+        void SignalImpl(FenceBase* fence, uint64_t signalValue) override;
     };
 
     class RenderPass : public RenderPassBase {
@@ -134,12 +134,14 @@ namespace backend { namespace opengl {
 
                 std::string name = GetBindingName(group, binding);
                 switch (groupInfo.types[binding]) {
-                    case nxt::BindingType::UniformBuffer: {
+                    case nxt::BindingType::UniformBuffer:
+                    case nxt::BindingType::DynamicUniformBuffer: {
                         GLint location = glGetUniformBlockIndex(mProgram, name.c_str());
                         glUniformBlockBinding(mProgram, location, indices[group][binding]);
                     } break;
 
-                    case nxt::BindingType::StorageBuffer: {
+                    case nxt::BindingType::StorageBuffer:
+                    case nxt::BindingType::DynamicStorageBuffer: {
                         GLuint location = glGetProgramResourceIndex(
                             mProgram, GL_SHADER_STORAGE_BLOCK, name.c_str());
                         glShaderStorageBlockBinding(mProgram, location, indices[group][binding]);
@@ -34,6 +34,7 @@ namespace backend { namespace opengl {
 
                 switch (groupInfo.types[binding]) {
                     case nxt::BindingType::UniformBuffer:
+                    case nxt::BindingType::DynamicUniformBuffer:
                         mIndexInfo[group][binding] = uboIndex;
                         uboIndex++;
                         break;
@@ -47,6 +48,7 @@ namespace backend { namespace opengl {
                         break;
 
                     case nxt::BindingType::StorageBuffer:
+                    case nxt::BindingType::DynamicStorageBuffer:
                         mIndexInfo[group][binding] = ssboIndex;
                         ssboIndex++;
                         break;
@@ -0,0 +1,58 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "backend/opengl/QuerySetGL.h"
+
+#include "common/Assert.h"
+
+namespace backend { namespace opengl {
+
+    QuerySet::QuerySet(QuerySetBuilder* builder)
+        : QuerySetBase(builder), mHandles(GetCount()) {
+        glGenQueries(static_cast<GLsizei>(mHandles.size()), mHandles.data());
+
+        // Query names only become query objects when they are first used, and getting the result
+        // of a name that isn't a query object is an error. Use every query once so that resolving
+        // queries that weren't written is valid, even though their result is undefined.
+        for (GLuint handle : mHandles) {
+            if (GetType() == nxt::QueryType::Timestamp) {
+                glQueryCounter(handle, GL_TIMESTAMP);
+            } else {
+                glBeginQuery(GetGLTarget(), handle);
+                glEndQuery(GetGLTarget());
+            }
+        }
+    }
+
+    QuerySet::~QuerySet() {
+        glDeleteQueries(static_cast<GLsizei>(mHandles.size()), mHandles.data());
+    }
+
+    GLuint QuerySet::GetHandle(uint32_t index) const {
+        ASSERT(index < mHandles.size());
+        return mHandles[index];
+    }
+
+    GLenum QuerySet::GetGLTarget() const {
+        switch (GetType()) {
+            case nxt::QueryType::Occlusion:
+                return GL_SAMPLES_PASSED;
+            case nxt::QueryType::PipelineStatistics:
+                return GL_PRIMITIVES_GENERATED;
+            default:
+                UNREACHABLE();
+        }
+    }
+
+}}  // namespace backend::opengl
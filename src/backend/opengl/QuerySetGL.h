@@ -12,31 +12,30 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#ifndef WIRE_TERRIBLE_COMMAND_BUFFER_H_
-#define WIRE_TERRIBLE_COMMAND_BUFFER_H_
+#ifndef BACKEND_OPENGL_QUERYSETGL_H_
+#define BACKEND_OPENGL_QUERYSETGL_H_
 
-#include <vector>
+#include "backend/QuerySet.h"
+
+#include "glad/glad.h"
 
-#include "wire/Wire.h"
+#include <vector>
 
-namespace nxt { namespace wire {
+namespace backend { namespace opengl {
 
-    class TerribleCommandBuffer : public CommandSerializer {
+    class QuerySet : public QuerySetBase {
       public:
-        TerribleCommandBuffer();
-        TerribleCommandBuffer(CommandHandler* handler);
-
-        void SetHandler(CommandHandler* handler);
+        QuerySet(QuerySetBuilder* builder);
+        ~QuerySet();
 
-        void* GetCmdSpace(size_t size) override;
-        void Flush() override;
+        GLuint GetHandle(uint32_t index) const;
+        // The target of glBeginQuery, timestamps are written with glQueryCounter instead.
+        GLenum GetGLTarget() const;
 
       private:
-        CommandHandler* mHandler = nullptr;
-        size_t mOffset = 0;
-        uint8_t mBuffer[10000000];
+        std::vector<GLuint> mHandles;
     };
 
-}}  // namespace nxt::wire
+}}  // namespace backend::opengl
 
-#endif  // WIRE_TERRIBLE_COMMAND_BUFFER_H_
+#endif  // BACKEND_OPENGL_QUERYSETGL_H_
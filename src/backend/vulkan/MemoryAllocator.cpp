@@ -15,8 +15,32 @@
 #include "backend/vulkan/MemoryAllocator.h"
 #include "backend/vulkan/VulkanBackend.h"
 
+#include <algorithm>
+
 namespace backend { namespace vulkan {
 
+    namespace {
+
+        // Blocks are at most this big, smaller heaps get smaller blocks so that a single block
+        // doesn't use a large fraction of the heap.
+        constexpr uint64_t kMaxBlockSize = 64 * 1024 * 1024;
+        constexpr uint64_t kMinHeapFractionPerBlock = 8;
+        constexpr uint64_t kMinSubAllocationSize = 256;
+
+    }  // anonymous namespace
+
+    struct MemoryBlock {
+        MemoryBlock(uint64_t size, uint64_t minBlockSize) : allocator(size, minBlockSize) {
+        }
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        uint8_t* mappedPointer = nullptr;
+        uint32_t memoryType = 0;
+        BuddyAllocator allocator;
+    };
+
+    // DeviceMemoryAllocation
+
     DeviceMemoryAllocation::~DeviceMemoryAllocation() {
         ASSERT(mMemory == VK_NULL_HANDLE);
     }
@@ -33,16 +57,130 @@ namespace backend { namespace vulkan {
         return mMappedPointer;
     }
 
+    // MemoryAllocator
+
     MemoryAllocator::MemoryAllocator(Device* device) : mDevice(device) {
+        const VulkanDeviceInfo& info = mDevice->GetDeviceInfo();
+
+        // bufferImageGranularity is a power of two in practice, but the spec doesn't require it.
+        uint64_t granularity = info.properties.limits.bufferImageGranularity;
+        mMinBlockSize = kMinSubAllocationSize;
+        while (mMinBlockSize < granularity) {
+            mMinBlockSize *= 2;
+        }
+
+        mBlocks.resize(info.memoryTypes.size());
     }
 
     MemoryAllocator::~MemoryAllocator() {
-        ASSERT(mReleasedMemory.Empty());
+        ASSERT(mReleasedAllocations.Empty());
+
+        for (auto& blocks : mBlocks) {
+            for (auto& block : blocks) {
+                ASSERT(block->allocator.GetAllocationCount() == 0);
+                mDevice->fn.FreeMemory(mDevice->GetVkDevice(), block->memory, nullptr);
+            }
+        }
+        mBlocks.clear();
     }
 
     bool MemoryAllocator::Allocate(VkMemoryRequirements requirements,
                                    bool mappable,
                                    DeviceMemoryAllocation* allocation) {
+        int bestType = FindBestMemoryType(requirements, mappable);
+
+        // TODO(cwallez@chromium.org): I think the Vulkan spec guarantees this should never happen
+        if (bestType == -1) {
+            ASSERT(false);
+            return false;
+        }
+        uint32_t memoryType = static_cast<uint32_t>(bestType);
+
+        // Small resources are sub-allocated in blocks, big ones get their own device memory
+        // as they would waste too much space in the blocks.
+        uint64_t blockSize = GetBlockSize(memoryType);
+        if (requirements.size <= blockSize / 2) {
+            if (SubAllocate(requirements.size, requirements.alignment, memoryType, allocation)) {
+                return true;
+            }
+        }
+
+        VkDeviceMemory allocatedMemory = VK_NULL_HANDLE;
+        uint8_t* mappedPointer = nullptr;
+        if (!AllocateDeviceMemory(requirements.size, memoryType, &allocatedMemory,
+                                  &mappedPointer)) {
+            return false;
+        }
+        mDedicatedAllocationCount++;
+
+        allocation->mMemory = allocatedMemory;
+        allocation->mOffset = 0;
+        allocation->mMappedPointer = mappedPointer;
+        allocation->mBlock = nullptr;
+
+        return true;
+    }
+
+    void MemoryAllocator::Free(DeviceMemoryAllocation* allocation) {
+        // The memory can still be in use by the GPU so it is only released once the current
+        // serial has passed.
+        ReleasedAllocation released;
+        released.memory = allocation->mMemory;
+        released.block = allocation->mBlock;
+        released.offset = allocation->mOffset;
+        mReleasedAllocations.Enqueue(released, mDevice->GetSerial());
+
+        allocation->mMemory = VK_NULL_HANDLE;
+        allocation->mOffset = 0;
+        allocation->mMappedPointer = nullptr;
+        allocation->mBlock = nullptr;
+    }
+
+    void MemoryAllocator::Tick(Serial finishedSerial) {
+        for (const auto& released : mReleasedAllocations.IterateUpTo(finishedSerial)) {
+            if (released.block == nullptr) {
+                mDevice->fn.FreeMemory(mDevice->GetVkDevice(), released.memory, nullptr);
+                mDedicatedAllocationCount--;
+                continue;
+            }
+
+            released.block->allocator.Deallocate(released.offset);
+            FreeBlockIfUnused(released.block);
+        }
+        mReleasedAllocations.ClearUpTo(finishedSerial);
+    }
+
+    MemoryAllocatorStats MemoryAllocator::GetStats() const {
+        MemoryAllocatorStats stats;
+        stats.dedicatedAllocationCount = mDedicatedAllocationCount;
+
+        uint64_t sumOfLargestFreeBlocks = 0;
+        for (const auto& blocks : mBlocks) {
+            for (const auto& block : blocks) {
+                const BuddyAllocator& allocator = block->allocator;
+
+                stats.blockCount++;
+                stats.subAllocationCount += static_cast<uint32_t>(allocator.GetAllocationCount());
+                stats.reservedSize += allocator.GetSize();
+                stats.usedSize += allocator.GetUsedSize();
+                stats.freeSize += allocator.GetFreeSize();
+                stats.largestFreeBlockSize =
+                    std::max(stats.largestFreeBlockSize, allocator.GetLargestFreeBlockSize());
+                sumOfLargestFreeBlocks += allocator.GetLargestFreeBlockSize();
+            }
+        }
+        stats.deviceMemoryCount = stats.blockCount + stats.dedicatedAllocationCount;
+
+        if (stats.freeSize != 0) {
+            stats.fragmentation = 1.0f - static_cast<float>(sumOfLargestFreeBlocks) /
+                                             static_cast<float>(stats.freeSize);
+        }
+
+        return stats;
+    }
+
+    int MemoryAllocator::FindBestMemoryType(VkMemoryRequirements requirements,
+                                            bool mappable) const {
         const VulkanDeviceInfo& info = mDevice->GetDeviceInfo();
 
         // Find a suitable memory type for this allocation
@@ -79,25 +217,36 @@ namespace backend { namespace vulkan {
             // All things equal favor the memory in the biggest heap
             VkDeviceSize bestTypeHeapSize =
                 info.memoryHeaps[info.memoryTypes[bestType].heapIndex].size;
-            VkDeviceSize candidateHeapSize =
-                info.memoryHeaps[info.memoryTypes[bestType].heapIndex].size;
+            VkDeviceSize candidateHeapSize = info.memoryHeaps[info.memoryTypes[i].heapIndex].size;
             if (candidateHeapSize > bestTypeHeapSize) {
                 bestType = static_cast<int>(i);
                 continue;
             }
         }
 
-        // TODO(cwallez@chromium.org): I think the Vulkan spec guarantees this should never happen
-        if (bestType == -1) {
-            ASSERT(false);
-            return false;
+        return bestType;
+    }
+
+    uint64_t MemoryAllocator::GetBlockSize(uint32_t memoryType) const {
+        const VulkanDeviceInfo& info = mDevice->GetDeviceInfo();
+        VkDeviceSize heapSize = info.memoryHeaps[info.memoryTypes[memoryType].heapIndex].size;
+
+        uint64_t blockSize = kMaxBlockSize;
+        while (blockSize > mMinBlockSize && blockSize * kMinHeapFractionPerBlock > heapSize) {
+            blockSize /= 2;
         }
+        return blockSize;
+    }
 
+    bool MemoryAllocator::AllocateDeviceMemory(uint64_t size,
+                                               uint32_t memoryType,
+                                               VkDeviceMemory* memory,
+                                               uint8_t** mappedPointer) {
         VkMemoryAllocateInfo allocateInfo;
         allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
         allocateInfo.pNext = nullptr;
-        allocateInfo.allocationSize = requirements.size;
-        allocateInfo.memoryTypeIndex = static_cast<uint32_t>(bestType);
+        allocateInfo.allocationSize = size;
+        allocateInfo.memoryTypeIndex = memoryType;
 
         VkDeviceMemory allocatedMemory = VK_NULL_HANDLE;
         if (mDevice->fn.AllocateMemory(mDevice->GetVkDevice(), &allocateInfo, nullptr,
@@ -105,32 +254,94 @@ namespace backend { namespace vulkan {
             return false;
         }
 
-        void* mappedPointer = nullptr;
-        if (mappable) {
-            if (mDevice->fn.MapMemory(mDevice->GetVkDevice(), allocatedMemory, 0, requirements.size,
-                                      0, &mappedPointer) != VK_SUCCESS) {
+        // Host visible memory is mapped for its whole lifetime so that sub-allocations don't
+        // need to map and unmap the shared VkDeviceMemory.
+        void* mapped = nullptr;
+        const VulkanDeviceInfo& info = mDevice->GetDeviceInfo();
+        if ((info.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) !=
+            0) {
+            if (mDevice->fn.MapMemory(mDevice->GetVkDevice(), allocatedMemory, 0, VK_WHOLE_SIZE,
+                                      0, &mapped) != VK_SUCCESS) {
+                mDevice->fn.FreeMemory(mDevice->GetVkDevice(), allocatedMemory, nullptr);
                 return false;
             }
         }
 
-        allocation->mMemory = allocatedMemory;
-        allocation->mOffset = 0;
-        allocation->mMappedPointer = reinterpret_cast<uint8_t*>(mappedPointer);
-
+        *memory = allocatedMemory;
+        *mappedPointer = reinterpret_cast<uint8_t*>(mapped);
         return true;
     }
 
-    void MemoryAllocator::Free(DeviceMemoryAllocation* allocation) {
-        mReleasedMemory.Enqueue(allocation->mMemory, mDevice->GetSerial());
-        allocation->mMemory = VK_NULL_HANDLE;
-        allocation->mOffset = 0;
-        allocation->mMappedPointer = nullptr;
+    bool MemoryAllocator::SubAllocate(uint64_t size,
+                                      uint64_t alignment,
+                                      uint32_t memoryType,
+                                      DeviceMemoryAllocation* allocation) {
+        std::vector<std::unique_ptr<MemoryBlock>>& blocks = mBlocks[memoryType];
+
+        // Look for space in the existing blocks first, the oldest blocks are tried first so
+        // that newer ones have a chance to become empty and be freed.
+        MemoryBlock* block = nullptr;
+        uint64_t offset = BuddyAllocator::kInvalidOffset;
+        for (auto& candidate : blocks) {
+            offset = candidate->allocator.Allocate(size, alignment);
+            if (offset != BuddyAllocator::kInvalidOffset) {
+                block = candidate.get();
+                break;
+            }
+        }
+
+        if (block == nullptr) {
+            uint64_t blockSize = GetBlockSize(memoryType);
+            std::unique_ptr<MemoryBlock> newBlock(new MemoryBlock(blockSize, mMinBlockSize));
+
+            // Alignments bigger than a block can't be sub-allocated, the caller falls back to a
+            // dedicated allocation instead.
+            if (newBlock->allocator.GetBlockSizeFor(size, alignment) > blockSize) {
+                return false;
+            }
+
+            newBlock->memoryType = memoryType;
+            if (!AllocateDeviceMemory(blockSize, memoryType, &newBlock->memory,
+                                      &newBlock->mappedPointer)) {
+                return false;
+            }
+
+            offset = newBlock->allocator.Allocate(size, alignment);
+            ASSERT(offset != BuddyAllocator::kInvalidOffset);
+
+            block = newBlock.get();
+            blocks.push_back(std::move(newBlock));
+        }
+
+        allocation->mMemory = block->memory;
+        allocation->mOffset = static_cast<size_t>(offset);
+        allocation->mMappedPointer =
+            block->mappedPointer != nullptr ? block->mappedPointer + offset : nullptr;
+        allocation->mBlock = block;
+
+        return true;
     }
 
-    void MemoryAllocator::Tick(Serial finishedSerial) {
-        for (auto memory : mReleasedMemory.IterateUpTo(finishedSerial)) {
-            mDevice->fn.FreeMemory(mDevice->GetVkDevice(), memory, nullptr);
+    void MemoryAllocator::FreeBlockIfUnused(MemoryBlock* block) {
+        if (block->allocator.GetAllocationCount() != 0) {
+            return;
+        }
+
+        // Keep one block per memory type around to avoid allocating and freeing device memory
+        // when resources are created and destroyed every frame.
+        std::vector<std::unique_ptr<MemoryBlock>>& blocks = mBlocks[block->memoryType];
+        if (blocks.size() == 1) {
+            return;
         }
-        mReleasedMemory.ClearUpTo(finishedSerial);
+
+        auto it = std::find_if(blocks.begin(), blocks.end(),
+                               [block](const std::unique_ptr<MemoryBlock>& candidate) {
+                                   return candidate.get() == block;
+                               });
+        ASSERT(it != blocks.end());
+
+        mDevice->fn.FreeMemory(mDevice->GetVkDevice(), block->memory, nullptr);
+        blocks.erase(it);
     }
+
 }}  // namespace backend::vulkan
@@ -16,12 +16,17 @@
 #define BACKEND_VULKAN_MEMORYALLOCATOR_H_
 
 #include "backend/vulkan/vulkan_platform.h"
+#include "common/BuddyAllocator.h"
 #include "common/SerialQueue.h"
 
+#include <memory>
+#include <vector>
+
 namespace backend { namespace vulkan {
 
     class Device;
     class MemoryAllocator;
+    struct MemoryBlock;
 
     class DeviceMemoryAllocation {
       public:
@@ -35,8 +40,33 @@ namespace backend { namespace vulkan {
         VkDeviceMemory mMemory = VK_NULL_HANDLE;
         size_t mOffset = 0;
         uint8_t* mMappedPointer = nullptr;
+        // The block this allocation was sub-allocated from, nullptr for dedicated allocations.
+        MemoryBlock* mBlock = nullptr;
+    };
+
+    struct MemoryAllocatorStats {
+        // Number of VkDeviceMemory objects alive, drivers can limit it to as low as 4096.
+        uint32_t deviceMemoryCount = 0;
+        uint32_t blockCount = 0;
+        uint32_t dedicatedAllocationCount = 0;
+        uint32_t subAllocationCount = 0;
+
+        // Total size of the VkDeviceMemory objects.
+        uint64_t reservedSize = 0;
+        // Size used by resources, including the rounding done by the sub-allocator.
+        uint64_t usedSize = 0;
+        // Free size in the blocks and the biggest contiguous range in it.
+        uint64_t freeSize = 0;
+        uint64_t largestFreeBlockSize = 0;
+
+        // 0 when the free space of each block is contiguous, tends to 1 when it is scattered
+        // in small ranges.
+        float fragmentation = 0.0f;
     };
 
+    // Allocates device memory for resources. Small allocations are sub-allocated with a buddy
+    // allocator from large per-memory-type blocks, big allocations get their own VkDeviceMemory.
+    // Host-visible memory is kept persistently mapped.
     class MemoryAllocator {
       public:
         MemoryAllocator(Device* device);
@@ -49,9 +79,37 @@ namespace backend { namespace vulkan {
 
         void Tick(Serial finishedSerial);
 
+        MemoryAllocatorStats GetStats() const;
+
       private:
+        int FindBestMemoryType(VkMemoryRequirements requirements, bool mappable) const;
+        uint64_t GetBlockSize(uint32_t memoryType) const;
+        bool AllocateDeviceMemory(uint64_t size,
+                                  uint32_t memoryType,
+                                  VkDeviceMemory* memory,
+                                  uint8_t** mappedPointer);
+        bool SubAllocate(uint64_t size,
+                         uint64_t alignment,
+                         uint32_t memoryType,
+                         DeviceMemoryAllocation* allocation);
+        void FreeBlockIfUnused(MemoryBlock* block);
+
         Device* mDevice = nullptr;
-        SerialQueue<VkDeviceMemory> mReleasedMemory;
+
+        // Sub-allocations are at least this big so that linear and non-linear resources never
+        // share a bufferImageGranularity page.
+        uint64_t mMinBlockSize = 0;
+
+        // The blocks for each memory type.
+        std::vector<std::vector<std::unique_ptr<MemoryBlock>>> mBlocks;
+        uint32_t mDedicatedAllocationCount = 0;
+
+        struct ReleasedAllocation {
+            VkDeviceMemory memory;
+            MemoryBlock* block;
+            uint64_t offset;
+        };
+        SerialQueue<ReleasedAllocation> mReleasedAllocations;
     };
 
 }}  // namespace backend::vulkan
@@ -110,6 +110,8 @@ namespace backend { namespace vulkan {
         mMapReadRequestTracker = new MapReadRequestTracker(this);
         mMemoryAllocator = new MemoryAllocator(this);
         mBufferUploader = new BufferUploader(this);
+
+        mFenceWaiterThread = std::thread([this]() { FenceWaiterThreadMain(); });
     }
 
     Device::~Device() {
@@ -119,6 +121,17 @@ namespace backend { namespace vulkan {
         if (fn.QueueWaitIdle(mQueue) != VK_SUCCESS) {
             ASSERT(false);
         }
+
+        // All the fences are signaled now so the waiter goes through the remaining ones quickly.
+        if (mFenceWaiterThread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mFenceWaiterMutex);
+                mStopFenceWaiter = true;
+                mFenceWaiterCondition.notify_all();
+            }
+            mFenceWaiterThread.join();
+        }
+
         CheckPassedFences();
         ASSERT(mFencesInFlight.empty());
 
@@ -205,9 +218,17 @@ namespace backend { namespace vulkan {
     PipelineLayoutBase* Device::CreatePipelineLayout(PipelineLayoutBuilder* builder) {
         return new PipelineLayout(builder);
     }
+    QuerySetBase* Device::CreateQuerySet(QuerySetBuilder* builder) {
+        // Queries aren't implemented in this backend.
+        builder->HandleError("Query sets are not supported on this backend");
+        return nullptr;
+    }
     QueueBase* Device::CreateQueue(QueueBuilder* builder) {
         return new Queue(builder);
     }
+    RenderBundleBase* Device::CreateRenderBundle(RenderBundleBuilder* builder) {
+        return new RenderBundle(builder);
+    }
     RenderPassBase* Device::CreateRenderPass(RenderPassBuilder* builder) {
         return new RenderPass(builder);
     }
@@ -242,6 +263,7 @@ namespace backend { namespace vulkan {
         mMapReadRequestTracker->Tick(mCompletedSerial);
         mBufferUploader->Tick(mCompletedSerial);
         mMemoryAllocator->Tick(mCompletedSerial);
+        mFenceSignalTracker.Tick(mCompletedSerial);
 
         if (mPendingCommands.pool != VK_NULL_HANDLE) {
             SubmitPendingCommands();
@@ -252,6 +274,10 @@ namespace backend { namespace vulkan {
         return mDeviceInfo;
     }
 
+    FenceSignalTracker* Device::GetFenceSignalTracker() {
+        return &mFenceSignalTracker;
+    }
+
     MapReadRequestTracker* Device::GetMapReadRequestTracker() const {
         return mMapReadRequestTracker;
     }
@@ -314,6 +340,11 @@ namespace backend { namespace vulkan {
         mCommandsInFlight.Enqueue(mPendingCommands, mNextSerial);
         mPendingCommands = CommandPoolAndBuffer();
         mFencesInFlight.emplace(fence, mNextSerial);
+        {
+            std::lock_guard<std::mutex> lock(mFenceWaiterMutex);
+            mFencesToWait.emplace(fence, mNextSerial);
+            mFenceWaiterCondition.notify_all();
+        }
         mNextSerial++;
     }
 
@@ -496,12 +527,10 @@ namespace backend { namespace vulkan {
             VkFence fence = mFencesInFlight.front().first;
             Serial fenceSerial = mFencesInFlight.front().second;
 
-            VkResult result = fn.GetFenceStatus(mVkDevice, fence);
-            ASSERT(result == VK_SUCCESS || result == VK_NOT_READY);
-
-            // Fence are added in order, so we can stop searching as soon
-            // as we see one that's not ready.
-            if (result == VK_NOT_READY) {
+            // The waiter thread waits on the fences in order so the fences up to the last one it
+            // waited on are signaled, and it is done with them so they can be reset. We can stop
+            // searching as soon as we see one it hasn't reached.
+            if (fenceSerial > mLastWaitedSerial) {
                 return;
             }
 
@@ -517,6 +546,30 @@ namespace backend { namespace vulkan {
         }
     }
 
+    void Device::FenceWaiterThreadMain() {
+        while (true) {
+            std::pair<VkFence, Serial> fenceAndSerial;
+            {
+                std::unique_lock<std::mutex> lock(mFenceWaiterMutex);
+                mFenceWaiterCondition.wait(
+                    lock, [this]() { return !mFencesToWait.empty() || mStopFenceWaiter; });
+                if (mFencesToWait.empty()) {
+                    return;
+                }
+                fenceAndSerial = mFencesToWait.front();
+                mFencesToWait.pop();
+            }
+
+            if (fn.WaitForFences(mVkDevice, 1, &fenceAndSerial.first, VK_TRUE, UINT64_MAX) !=
+                VK_SUCCESS) {
+                ASSERT(false);
+            }
+
+            mLastWaitedSerial = fenceAndSerial.second;
+            SignalCompletion();
+        }
+    }
+
     Device::CommandPoolAndBuffer Device::GetUnusedCommands() {
         if (!mUnusedCommands.empty()) {
             CommandPoolAndBuffer commands = mUnusedCommands.back();
@@ -582,6 +635,16 @@ namespace backend { namespace vulkan {
     void Queue::Submit(uint32_t, CommandBuffer* const*) {
     }
 
+    void Queue::SignalImpl(FenceBase* fence, uint64_t signalValue) {
+        // Submitting the pending commands, even if empty, gives a VkFence that is signaled after
+        // all the previous submits.
+        Device* device = ToBackend(GetDevice());
+        device->GetPendingCommandBuffer();
+        device->GetFenceSignalTracker()->UpdateFenceOnComplete(fence, signalValue,
+                                                               device->GetSerial());
+        device->SubmitPendingCommands();
+    }
+
     // Texture
 
     Texture::Texture(TextureBuilder* builder) : TextureBase(builder) {
@@ -24,10 +24,13 @@
 #include "backend/ComputePipeline.h"
 #include "backend/DepthStencilState.h"
 #include "backend/Device.h"
+#include "backend/Fence.h"
 #include "backend/Framebuffer.h"
 #include "backend/InputState.h"
 #include "backend/PipelineLayout.h"
+#include "backend/QuerySet.h"
 #include "backend/Queue.h"
+#include "backend/RenderBundle.h"
 #include "backend/RenderPass.h"
 #include "backend/RenderPipeline.h"
 #include "backend/Sampler.h"
@@ -41,7 +44,11 @@
 #include "common/Serial.h"
 #include "common/SerialQueue.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <queue>
+#include <thread>
 
 namespace backend { namespace vulkan {
 
@@ -54,10 +61,13 @@ namespace backend { namespace vulkan {
     using ComputePipeline = ComputePipelineBase;
     using DepthStencilState = DepthStencilStateBase;
     class Device;
+    using Fence = FenceBase;
     using Framebuffer = FramebufferBase;
     using InputState = InputStateBase;
     using PipelineLayout = PipelineLayoutBase;
+    using QuerySet = QuerySetBase;
     class Queue;
+    using RenderBundle = RenderBundleBase;
     using RenderPass = RenderPassBase;
     using RenderPipeline = RenderPipelineBase;
     using Sampler = SamplerBase;
@@ -80,10 +90,13 @@ namespace backend { namespace vulkan {
         using ComputePipelineType = ComputePipeline;
         using DepthStencilStateType = DepthStencilState;
         using DeviceType = Device;
+        using FenceType = Fence;
         using FramebufferType = Framebuffer;
         using InputStateType = InputState;
         using PipelineLayoutType = PipelineLayout;
+        using QuerySetType = QuerySet;
         using QueueType = Queue;
+        using RenderBundleType = RenderBundle;
         using RenderPassType = RenderPass;
         using RenderPipelineType = RenderPipeline;
         using SamplerType = Sampler;
@@ -114,7 +127,9 @@ namespace backend { namespace vulkan {
         FramebufferBase* CreateFramebuffer(FramebufferBuilder* builder) override;
         InputStateBase* CreateInputState(InputStateBuilder* builder) override;
         PipelineLayoutBase* CreatePipelineLayout(PipelineLayoutBuilder* builder) override;
+        QuerySetBase* CreateQuerySet(QuerySetBuilder* builder) override;
         QueueBase* CreateQueue(QueueBuilder* builder) override;
+        RenderBundleBase* CreateRenderBundle(RenderBundleBuilder* builder) override;
         RenderPassBase* CreateRenderPass(RenderPassBuilder* builder) override;
         RenderPipelineBase* CreateRenderPipeline(RenderPipelineBuilder* builder) override;
         SamplerBase* CreateSampler(SamplerBuilder* builder) override;
@@ -126,6 +141,7 @@ namespace backend { namespace vulkan {
         void TickImpl() override;
 
         const VulkanDeviceInfo& GetDeviceInfo() const;
+        FenceSignalTracker* GetFenceSignalTracker();
         MapReadRequestTracker* GetMapReadRequestTracker() const;
         MemoryAllocator* GetMemoryAllocator() const;
         BufferUploader* GetBufferUploader() const;
@@ -173,6 +189,7 @@ namespace backend { namespace vulkan {
         VkQueue mQueue = VK_NULL_HANDLE;
         VkDebugReportCallbackEXT mDebugReportCallback = VK_NULL_HANDLE;
 
+        FenceSignalTracker mFenceSignalTracker;
         MapReadRequestTracker* mMapReadRequestTracker = nullptr;
         MemoryAllocator* mMemoryAllocator = nullptr;
         BufferUploader* mBufferUploader = nullptr;
@@ -189,6 +206,18 @@ namespace backend { namespace vulkan {
         Serial mNextSerial = 1;
         Serial mCompletedSerial = 0;
 
+        // A thread waits on the fences in flight and signals the completion fd when they are
+        // reached, so that applications can sleep until there is work for Tick. Fences are only
+        // recycled once the waiter is done with them as they can't be reset while it waits.
+        void FenceWaiterThreadMain();
+        std::thread mFenceWaiterThread;
+        std::mutex mFenceWaiterMutex;
+        std::condition_variable mFenceWaiterCondition;
+        // Protected by the mutex.
+        std::queue<std::pair<VkFence, Serial>> mFencesToWait;
+        bool mStopFenceWaiter = false;
+        std::atomic<Serial> mLastWaitedSerial{0};
+
         struct CommandPoolAndBuffer {
             VkCommandPool pool = VK_NULL_HANDLE;
             VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
@@ -210,6 +239,9 @@ namespace backend { namespace vulkan {
 
         // NXT API
         void Submit(uint32_t numCommands, CommandBuffer* const* commands);
+
+      private:
+        void SignalImpl(FenceBase* fence, uint64_t signalValue) override;
     };
 
     class Texture : public TextureBase {
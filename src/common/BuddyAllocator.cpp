@@ -0,0 +1,168 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/BuddyAllocator.h"
+
+#include "common/Assert.h"
+
+#include <algorithm>
+
+namespace {
+
+    bool IsPowerOfTwo64(uint64_t value) {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    uint32_t Log2Of64(uint64_t value) {
+        ASSERT(value != 0);
+        uint32_t result = 0;
+        while (value > 1) {
+            value >>= 1;
+            result++;
+        }
+        return result;
+    }
+
+    uint64_t NextPowerOfTwo(uint64_t value) {
+        ASSERT(value != 0);
+        uint64_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+}  // anonymous namespace
+
+constexpr uint64_t BuddyAllocator::kInvalidOffset;
+
+BuddyAllocator::BuddyAllocator(uint64_t size, uint64_t minBlockSize)
+    : mSize(size), mMinBlockSize(minBlockSize) {
+    ASSERT(IsPowerOfTwo64(size));
+    ASSERT(IsPowerOfTwo64(minBlockSize));
+    ASSERT(minBlockSize <= size);
+
+    mMaxLevel = Log2Of64(size) - Log2Of64(minBlockSize);
+    mFreeBlocks.resize(mMaxLevel + 1);
+    mFreeBlocks[0].insert(0);
+}
+
+BuddyAllocator::~BuddyAllocator() {
+}
+
+uint64_t BuddyAllocator::Allocate(uint64_t size, uint64_t alignment) {
+    // Checked before rounding up so that huge sizes or alignments can't overflow the block size.
+    if (size > mSize || alignment > mSize) {
+        return kInvalidOffset;
+    }
+    uint64_t blockSize = GetBlockSizeFor(size, alignment);
+    if (blockSize > mSize) {
+        return kInvalidOffset;
+    }
+    uint32_t targetLevel = LevelForSize(blockSize);
+
+    // Look for the smallest free block that can contain the allocation.
+    uint32_t level = targetLevel;
+    while (mFreeBlocks[level].empty()) {
+        if (level == 0) {
+            return kInvalidOffset;
+        }
+        level--;
+    }
+
+    uint64_t offset = *mFreeBlocks[level].begin();
+    mFreeBlocks[level].erase(mFreeBlocks[level].begin());
+
+    // Split it until it has the right size, the upper halves become free blocks.
+    while (level < targetLevel) {
+        level++;
+        mFreeBlocks[level].insert(offset + SizeForLevel(level));
+    }
+
+    mAllocatedBlocks[offset] = targetLevel;
+    mUsedSize += blockSize;
+    return offset;
+}
+
+void BuddyAllocator::Deallocate(uint64_t offset) {
+    auto it = mAllocatedBlocks.find(offset);
+    ASSERT(it != mAllocatedBlocks.end());
+
+    uint32_t level = it->second;
+    mAllocatedBlocks.erase(it);
+    mUsedSize -= SizeForLevel(level);
+
+    // Merge with the buddy for as long as it is free.
+    while (level > 0) {
+        uint64_t buddy = offset ^ SizeForLevel(level);
+        auto buddyIt = mFreeBlocks[level].find(buddy);
+        if (buddyIt == mFreeBlocks[level].end()) {
+            break;
+        }
+
+        mFreeBlocks[level].erase(buddyIt);
+        offset = std::min(offset, buddy);
+        level--;
+    }
+
+    mFreeBlocks[level].insert(offset);
+}
+
+uint64_t BuddyAllocator::GetSize() const {
+    return mSize;
+}
+
+uint64_t BuddyAllocator::GetMinBlockSize() const {
+    return mMinBlockSize;
+}
+
+uint64_t BuddyAllocator::GetBlockSizeFor(uint64_t size, uint64_t alignment) const {
+    ASSERT(IsPowerOfTwo64(alignment));
+    if (size == 0) {
+        size = 1;
+    }
+    return std::max(NextPowerOfTwo(std::max(size, alignment)), mMinBlockSize);
+}
+
+size_t BuddyAllocator::GetAllocationCount() const {
+    return mAllocatedBlocks.size();
+}
+
+uint64_t BuddyAllocator::GetUsedSize() const {
+    return mUsedSize;
+}
+
+uint64_t BuddyAllocator::GetFreeSize() const {
+    return mSize - mUsedSize;
+}
+
+uint64_t BuddyAllocator::GetLargestFreeBlockSize() const {
+    for (uint32_t level = 0; level <= mMaxLevel; ++level) {
+        if (!mFreeBlocks[level].empty()) {
+            return SizeForLevel(level);
+        }
+    }
+    return 0;
+}
+
+uint32_t BuddyAllocator::LevelForSize(uint64_t blockSize) const {
+    ASSERT(IsPowerOfTwo64(blockSize));
+    ASSERT(blockSize >= mMinBlockSize && blockSize <= mSize);
+    return Log2Of64(mSize) - Log2Of64(blockSize);
+}
+
+uint64_t BuddyAllocator::SizeForLevel(uint32_t level) const {
+    ASSERT(level <= mMaxLevel);
+    return mSize >> level;
+}
@@ -0,0 +1,74 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef COMMON_BUDDYALLOCATOR_H_
+#define COMMON_BUDDYALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// BuddyAllocator hands out power-of-two sized ranges of a [0, size) address space that isn't
+// owned by the allocator, for example a VkDeviceMemory. Each range is aligned to its own size
+// so any power-of-two alignment up to the size of the range is honored for free, and two
+// allocations never share a minimum-sized block.
+//
+// Free ranges are kept per size class in ordered sets so that allocation prefers the lowest
+// offsets, which keeps live allocations packed at the start of the address space.
+class BuddyAllocator {
+  public:
+    static constexpr uint64_t kInvalidOffset = std::numeric_limits<uint64_t>::max();
+
+    // Both sizes must be powers of two and minBlockSize must be smaller or equal to size.
+    BuddyAllocator(uint64_t size, uint64_t minBlockSize);
+    ~BuddyAllocator();
+
+    BuddyAllocator(const BuddyAllocator&) = delete;
+    BuddyAllocator& operator=(const BuddyAllocator&) = delete;
+
+    // Returns the offset of a block big enough to contain size bytes with the given alignment,
+    // or kInvalidOffset if there is no such free block.
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+    // Offset must have been returned by Allocate and not yet deallocated.
+    void Deallocate(uint64_t offset);
+
+    uint64_t GetSize() const;
+    uint64_t GetMinBlockSize() const;
+    // The size of the block that would be used for an allocation of size bytes.
+    uint64_t GetBlockSizeFor(uint64_t size, uint64_t alignment = 1) const;
+
+    size_t GetAllocationCount() const;
+    uint64_t GetUsedSize() const;
+    uint64_t GetFreeSize() const;
+    uint64_t GetLargestFreeBlockSize() const;
+
+  private:
+    // Level 0 is the whole address space, level mMaxLevel blocks are mMinBlockSize big.
+    uint32_t LevelForSize(uint64_t blockSize) const;
+    uint64_t SizeForLevel(uint32_t level) const;
+
+    uint64_t mSize;
+    uint64_t mMinBlockSize;
+    uint32_t mMaxLevel;
+    uint64_t mUsedSize = 0;
+
+    std::vector<std::set<uint64_t>> mFreeBlocks;
+    // Offset -> level of the live allocations, needed to know the size at Deallocate.
+    std::unordered_map<uint64_t, uint32_t> mAllocatedBlocks;
+};
+
+#endif  // COMMON_BUDDYALLOCATOR_H_
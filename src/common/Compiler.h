@@ -19,6 +19,7 @@
 //  - NXT_COMPILER_[CLANG|GCC|MSVC]: Compiler detection
 //  - NXT_BREAKPOINT(): Raises an exception and breaks in the debugger
 //  - NXT_BUILTIN_UNREACHABLE(): Hints the compiler that a code path is unreachable
+//  - NXT_NO_INLINE: Prevents the compiler from inlining a function
 
 // Clang and GCC
 #if defined(__GNUC__)
@@ -35,6 +36,7 @@
 #    endif
 
 #    define NXT_BUILTIN_UNREACHABLE() __builtin_unreachable()
+#    define NXT_NO_INLINE __attribute__((noinline))
 
 // MSVC
 #elif defined(_MSC_VER)
@@ -44,6 +46,7 @@ extern void __cdecl __debugbreak(void);
 #    define NXT_BREAKPOINT() __debugbreak()
 
 #    define NXT_BUILTIN_UNREACHABLE() __assume(false)
+#    define NXT_NO_INLINE __declspec(noinline)
 
 #else
 #    error "Unsupported compiler"
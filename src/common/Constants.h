@@ -26,5 +26,7 @@ static constexpr uint32_t kMaxVertexInputs = 16u;
 static constexpr uint32_t kNumStages = 3;
 static constexpr uint32_t kMaxColorAttachments = 4u;
 static constexpr uint32_t kTextureRowPitchAlignment = 256u;
+static constexpr uint32_t kDynamicBufferOffsetAlignment = 256u;
+static constexpr uint32_t kMaxQueriesPerSet = 4096u;
 
 #endif  // COMMON_CONSTANTS_H_
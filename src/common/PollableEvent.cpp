@@ -0,0 +1,128 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/PollableEvent.h"
+
+#include "common/Platform.h"
+
+#include <cstdint>
+
+#if NXT_PLATFORM_LINUX
+#    include <sys/eventfd.h>
+#    include <unistd.h>
+#elif NXT_PLATFORM_POSIX
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+#if NXT_PLATFORM_LINUX
+
+PollableEvent::PollableEvent() {
+    mReadFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    mWriteFd = mReadFd;
+}
+
+PollableEvent::~PollableEvent() {
+    if (mReadFd >= 0) {
+        close(mReadFd);
+    }
+}
+
+void PollableEvent::Signal() {
+    if (mWriteFd < 0) {
+        return;
+    }
+
+    // Adding to the counter makes the eventfd readable. It only fails if the counter would
+    // overflow, in which case it is already readable.
+    uint64_t one = 1;
+    ssize_t written = write(mWriteFd, &one, sizeof(one));
+    (void)written;
+}
+
+void PollableEvent::Clear() {
+    if (mReadFd < 0) {
+        return;
+    }
+
+    // Reading resets the counter, this fails with EAGAIN if the event wasn't signaled.
+    uint64_t counter;
+    ssize_t readSize = read(mReadFd, &counter, sizeof(counter));
+    (void)readSize;
+}
+
+#elif NXT_PLATFORM_POSIX
+
+PollableEvent::PollableEvent() {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return;
+    }
+
+    for (int fd : fds) {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    mReadFd = fds[0];
+    mWriteFd = fds[1];
+}
+
+PollableEvent::~PollableEvent() {
+    if (mReadFd >= 0) {
+        close(mReadFd);
+        close(mWriteFd);
+    }
+}
+
+void PollableEvent::Signal() {
+    if (mWriteFd < 0) {
+        return;
+    }
+
+    // The write fails if the pipe is full, in which case it is already readable.
+    uint8_t byte = 0;
+    ssize_t written = write(mWriteFd, &byte, sizeof(byte));
+    (void)written;
+}
+
+void PollableEvent::Clear() {
+    if (mReadFd < 0) {
+        return;
+    }
+
+    // Drain the pipe, read fails with EAGAIN once it is empty.
+    uint8_t bytes[64];
+    while (read(mReadFd, bytes, sizeof(bytes)) > 0) {
+    }
+}
+
+#else
+
+PollableEvent::PollableEvent() {
+}
+
+PollableEvent::~PollableEvent() {
+}
+
+void PollableEvent::Signal() {
+}
+
+void PollableEvent::Clear() {
+}
+
+#endif
+
+int PollableEvent::GetFd() const {
+    return mReadFd;
+}
@@ -0,0 +1,43 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef COMMON_POLLABLEEVENT_H_
+#define COMMON_POLLABLEEVENT_H_
+
+// An event that can be waited on with poll, select or epoll: its file descriptor becomes readable
+// when the event is signaled and stays readable until it is cleared. Signal can be called from
+// any thread, which lets other threads wake an event loop.
+//
+// It is an eventfd on Linux and a non-blocking pipe on other POSIX platforms. Other platforms
+// don't have file descriptors to poll, so GetFd returns -1 and Signal and Clear do nothing.
+class PollableEvent {
+  public:
+    PollableEvent();
+    ~PollableEvent();
+
+    PollableEvent(const PollableEvent&) = delete;
+    PollableEvent& operator=(const PollableEvent&) = delete;
+
+    int GetFd() const;
+
+    void Signal();
+    void Clear();
+
+  private:
+    int mReadFd = -1;
+    // The same as mReadFd for eventfds.
+    int mWriteFd = -1;
+};
+
+#endif  // COMMON_POLLABLEEVENT_H_
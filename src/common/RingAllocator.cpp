@@ -0,0 +1,104 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/RingAllocator.h"
+
+#include "common/Assert.h"
+#include "common/Math.h"
+
+constexpr size_t RingAllocator::kInvalidOffset;
+
+RingAllocator::RingAllocator(size_t size) : mSize(size) {
+    ASSERT(size > 0);
+}
+
+RingAllocator::~RingAllocator() {
+}
+
+size_t RingAllocator::Allocate(size_t size, size_t alignment, Serial serial) {
+    ASSERT(IsPowerOfTwo(alignment));
+    if (size == 0 || size > mSize) {
+        return kInvalidOffset;
+    }
+
+    // Restart from the beginning when everything is free, to avoid needless wraparounds.
+    if (mUsedSize == 0) {
+        mHead = 0;
+        mTail = 0;
+    } else if (mHead == mTail) {
+        // The used space covers the whole ring.
+        return kInvalidOffset;
+    }
+
+    size_t alignedHead = (mHead + alignment - 1) & ~(alignment - 1);
+    size_t offset = kInvalidOffset;
+    size_t consumed = 0;
+
+    if (mHead >= mTail) {
+        // The free space is [mHead, mSize) followed by [0, mTail).
+        if (alignedHead <= mSize && size <= mSize - alignedHead) {
+            offset = alignedHead;
+            consumed = alignedHead - mHead + size;
+        } else if (size <= mTail) {
+            // Skip the end of the ring, offset 0 is aligned for any alignment.
+            offset = 0;
+            consumed = mSize - mHead + size;
+        }
+    } else {
+        // The free space is [mHead, mTail).
+        if (alignedHead <= mTail && size <= mTail - alignedHead) {
+            offset = alignedHead;
+            consumed = alignedHead - mHead + size;
+        }
+    }
+
+    if (offset == kInvalidOffset) {
+        return kInvalidOffset;
+    }
+
+    mHead = offset + size;
+    if (mHead == mSize) {
+        mHead = 0;
+    }
+    mUsedSize += consumed;
+    ASSERT(mUsedSize <= mSize);
+
+    Request request;
+    request.endOffset = mHead;
+    request.size = consumed;
+    mInflightRequests.Enqueue(request, serial);
+
+    return offset;
+}
+
+void RingAllocator::Tick(Serial completedSerial) {
+    for (const Request& request : mInflightRequests.IterateUpTo(completedSerial)) {
+        ASSERT(request.size <= mUsedSize);
+        mUsedSize -= request.size;
+        mTail = request.endOffset;
+    }
+    mInflightRequests.ClearUpTo(completedSerial);
+}
+
+size_t RingAllocator::GetSize() const {
+    return mSize;
+}
+
+size_t RingAllocator::GetUsedSize() const {
+    return mUsedSize;
+}
+
+bool RingAllocator::Empty() const {
+    return mUsedSize == 0;
+}
@@ -0,0 +1,66 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef COMMON_RINGALLOCATOR_H_
+#define COMMON_RINGALLOCATOR_H_
+
+#include "common/Serial.h"
+#include "common/SerialQueue.h"
+
+#include <cstddef>
+#include <limits>
+
+// RingAllocator hands out ranges of a [0, size) address space that isn't owned by the allocator,
+// for example a persistently mapped staging buffer. Ranges are allocated one after the other and
+// tagged with the serial of the GPU work using them. They are reclaimed all at once, in order,
+// when that serial completes, which makes it a good fit for per-frame streaming of data.
+class RingAllocator {
+  public:
+    static constexpr size_t kInvalidOffset = std::numeric_limits<size_t>::max();
+
+    RingAllocator(size_t size);
+    ~RingAllocator();
+
+    RingAllocator(const RingAllocator&) = delete;
+    RingAllocator& operator=(const RingAllocator&) = delete;
+
+    // Returns the offset of a range of size bytes with the given power-of-two alignment, or
+    // kInvalidOffset if there is no such free range until some serial completes. Serials must
+    // be given in increasing order.
+    size_t Allocate(size_t size, size_t alignment, Serial serial);
+    // Frees all the ranges allocated with a serial smaller or equal to completedSerial.
+    void Tick(Serial completedSerial);
+
+    size_t GetSize() const;
+    // Includes the padding and the space skipped when allocations wrap around.
+    size_t GetUsedSize() const;
+    bool Empty() const;
+
+  private:
+    size_t mSize;
+    size_t mUsedSize = 0;
+    // The offset where the next allocation starts, and the start of the oldest live allocation.
+    size_t mHead = 0;
+    size_t mTail = 0;
+
+    struct Request {
+        // The end of the allocation, becomes the tail when it is freed.
+        size_t endOffset;
+        // The size consumed by the allocation, including padding.
+        size_t size;
+    };
+    SerialQueue<Request> mInflightRequests;
+};
+
+#endif  // COMMON_RINGALLOCATOR_H_
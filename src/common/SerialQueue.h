@@ -18,21 +18,64 @@
 #include "common/Assert.h"
 #include "common/Serial.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <new>
+#include <utility>
 #include <vector>
 
+// SerialQueue stores values associated with monotonically increasing serials, typically the
+// serial of the GPU submission after which a resource can be recycled.
+//
+// Values are stored in a single ring buffer and the serials are stored as run-lengths in a second
+// ring buffer, such that in steady state neither Enqueue nor ClearUpTo allocate memory.
 template <typename T>
 class SerialQueue {
   private:
-    using SerialPair = std::pair<Serial, std::vector<T>>;
-    using Storage = std::vector<SerialPair>;
-    using StorageIterator = typename Storage::iterator;
-    using ConstStorageIterator = typename Storage::const_iterator;
+    // A growable ring buffer indexed from its front. Elements are constructed in place and
+    // destroyed when popped, storage is only reallocated when the ring is full.
+    template <typename U>
+    class Ring {
+      public:
+        Ring() = default;
+        Ring(const Ring& other) = delete;
+        Ring& operator=(const Ring& other) = delete;
+        Ring(Ring&& other);
+        Ring& operator=(Ring&& other);
+        ~Ring();
+
+        size_t Size() const;
+        U& operator[](size_t index);
+        const U& operator[](size_t index) const;
+        U& Front();
+        const U& Front() const;
+        U& Back();
+
+        template <typename... Args>
+        void EmplaceBack(Args&&... args);
+        void PopFront();
+        void Clear();
+
+      private:
+        void Grow();
+
+        U* mStorage = nullptr;
+        // Always zero or a power of two so indices can be wrapped with a mask.
+        size_t mCapacity = 0;
+        size_t mHead = 0;
+        size_t mSize = 0;
+    };
+
+    // A run of consecutive values in the value ring that share the same serial.
+    struct SerialRun {
+        Serial serial;
+        size_t count;
+    };
 
   public:
     class Iterator {
       public:
-        Iterator(StorageIterator start);
+        Iterator(SerialQueue* queue, size_t index);
         Iterator& operator++();
 
         bool operator==(const Iterator& other) const;
@@ -40,16 +83,13 @@ class SerialQueue {
         T& operator*() const;
 
       private:
-        StorageIterator mStorageIterator;
-        // Special case the mSerialIterator when it should be equal to mStorageIterator.begin()
-        // otherwise we could ask mStorageIterator.begin() when mStorageIterator is mStorage.end()
-        // which is invalid. mStorageIterator.begin() is tagged with a nullptr.
-        T* mSerialIterator;
+        SerialQueue* mQueue;
+        size_t mIndex;
     };
 
     class ConstIterator {
       public:
-        ConstIterator(ConstStorageIterator start);
+        ConstIterator(const SerialQueue* queue, size_t index);
         ConstIterator& operator++();
 
         bool operator==(const ConstIterator& other) const;
@@ -57,32 +97,34 @@ class SerialQueue {
         const T& operator*() const;
 
       private:
-        ConstStorageIterator mStorageIterator;
-        const T* mSerialIterator;
+        const SerialQueue* mQueue;
+        size_t mIndex;
     };
 
     class BeginEnd {
       public:
-        BeginEnd(StorageIterator start, StorageIterator end);
+        BeginEnd(SerialQueue* queue, size_t start, size_t end);
 
         Iterator begin() const;
         Iterator end() const;
 
       private:
-        StorageIterator mStartIt;
-        StorageIterator mEndIt;
+        SerialQueue* mQueue;
+        size_t mStart;
+        size_t mEnd;
     };
 
     class ConstBeginEnd {
       public:
-        ConstBeginEnd(ConstStorageIterator start, ConstStorageIterator end);
+        ConstBeginEnd(const SerialQueue* queue, size_t start, size_t end);
 
         ConstIterator begin() const;
         ConstIterator end() const;
 
       private:
-        ConstStorageIterator mStartIt;
-        ConstStorageIterator mEndIt;
+        const SerialQueue* mQueue;
+        size_t mStart;
+        size_t mEnd;
     };
 
     // The serial must be given in (not strictly) increasing order.
@@ -107,153 +149,279 @@ class SerialQueue {
     Serial FirstSerial() const;
 
   private:
-    // Returns the first StorageIterator that a serial bigger than serial.
-    ConstStorageIterator FindUpTo(Serial serial) const;
-    StorageIterator FindUpTo(Serial serial);
-    Storage mStorage;
+    // Returns the number of values associated to a serial smaller or equal to serial.
+    size_t FindUpTo(Serial serial) const;
+    // Returns the run for serial, adding a new one at the back if needed.
+    SerialRun& GetRunForEnqueue(Serial serial);
+
+    Ring<T> mValues;
+    Ring<SerialRun> mRuns;
 };
 
 // SerialQueue
 
 template <typename T>
 void SerialQueue<T>::Enqueue(const T& value, Serial serial) {
-    NXT_ASSERT(Empty() || mStorage.back().first <= serial);
-
-    if (Empty() || mStorage.back().first < serial) {
-        mStorage.emplace_back(SerialPair(serial, {}));
-    }
-    mStorage.back().second.emplace_back(value);
+    SerialRun& run = GetRunForEnqueue(serial);
+    mValues.EmplaceBack(value);
+    run.count++;
 }
 
 template <typename T>
 void SerialQueue<T>::Enqueue(T&& value, Serial serial) {
-    NXT_ASSERT(Empty() || mStorage.back().first <= serial);
-
-    if (Empty() || mStorage.back().first < serial) {
-        mStorage.emplace_back(SerialPair(serial, {}));
-    }
-    mStorage.back().second.emplace_back(value);
+    SerialRun& run = GetRunForEnqueue(serial);
+    mValues.EmplaceBack(std::move(value));
+    run.count++;
 }
 
 template <typename T>
 void SerialQueue<T>::Enqueue(const std::vector<T>& values, Serial serial) {
     NXT_ASSERT(values.size() > 0);
-    NXT_ASSERT(Empty() || mStorage.back().first <= serial);
-    mStorage.emplace_back(SerialPair(serial, {values}));
+    SerialRun& run = GetRunForEnqueue(serial);
+    for (const T& value : values) {
+        mValues.EmplaceBack(value);
+    }
+    run.count += values.size();
 }
 
 template <typename T>
 void SerialQueue<T>::Enqueue(std::vector<T>&& values, Serial serial) {
     NXT_ASSERT(values.size() > 0);
-    NXT_ASSERT(Empty() || mStorage.back().first <= serial);
-    mStorage.emplace_back(SerialPair(serial, {values}));
+    SerialRun& run = GetRunForEnqueue(serial);
+    for (T& value : values) {
+        mValues.EmplaceBack(std::move(value));
+    }
+    run.count += values.size();
+    values.clear();
 }
 
 template <typename T>
 bool SerialQueue<T>::Empty() const {
-    return mStorage.empty();
+    return mRuns.Size() == 0;
 }
 
 template <typename T>
 typename SerialQueue<T>::ConstBeginEnd SerialQueue<T>::IterateAll() const {
-    return {mStorage.begin(), mStorage.end()};
+    return {this, 0, mValues.Size()};
 }
 
 template <typename T>
 typename SerialQueue<T>::ConstBeginEnd SerialQueue<T>::IterateUpTo(Serial serial) const {
-    return {mStorage.begin(), FindUpTo(serial)};
+    return {this, 0, FindUpTo(serial)};
 }
 
 template <typename T>
 typename SerialQueue<T>::BeginEnd SerialQueue<T>::IterateAll() {
-    return {mStorage.begin(), mStorage.end()};
+    return {this, 0, mValues.Size()};
 }
 
 template <typename T>
 typename SerialQueue<T>::BeginEnd SerialQueue<T>::IterateUpTo(Serial serial) {
-    return {mStorage.begin(), FindUpTo(serial)};
+    return {this, 0, FindUpTo(serial)};
 }
 
 template <typename T>
 void SerialQueue<T>::Clear() {
-    mStorage.clear();
+    mValues.Clear();
+    mRuns.Clear();
 }
 
 template <typename T>
 void SerialQueue<T>::ClearUpTo(Serial serial) {
-    mStorage.erase(mStorage.begin(), FindUpTo(serial));
+    while (mRuns.Size() != 0 && mRuns.Front().serial <= serial) {
+        for (size_t i = 0; i < mRuns.Front().count; ++i) {
+            mValues.PopFront();
+        }
+        mRuns.PopFront();
+    }
 }
 
 template <typename T>
 Serial SerialQueue<T>::FirstSerial() const {
     NXT_ASSERT(!Empty());
-    return mStorage.front().first;
+    return mRuns.Front().serial;
 }
 
 template <typename T>
-typename SerialQueue<T>::ConstStorageIterator SerialQueue<T>::FindUpTo(Serial serial) const {
-    auto it = mStorage.begin();
-    while (it != mStorage.end() && it->first <= serial) {
-        it++;
+size_t SerialQueue<T>::FindUpTo(Serial serial) const {
+    size_t count = 0;
+    for (size_t i = 0; i < mRuns.Size() && mRuns[i].serial <= serial; ++i) {
+        count += mRuns[i].count;
     }
-    return it;
+    return count;
 }
 
 template <typename T>
-typename SerialQueue<T>::StorageIterator SerialQueue<T>::FindUpTo(Serial serial) {
-    auto it = mStorage.begin();
-    while (it != mStorage.end() && it->first <= serial) {
-        it++;
+typename SerialQueue<T>::SerialRun& SerialQueue<T>::GetRunForEnqueue(Serial serial) {
+    NXT_ASSERT(Empty() || mRuns.Back().serial <= serial);
+
+    if (Empty() || mRuns.Back().serial < serial) {
+        mRuns.EmplaceBack(SerialRun{serial, 0});
     }
-    return it;
+    return mRuns.Back();
 }
 
-// SerialQueue::BeginEnd
+// SerialQueue::Ring
 
 template <typename T>
-SerialQueue<T>::BeginEnd::BeginEnd(typename SerialQueue<T>::StorageIterator start,
-                                   typename SerialQueue<T>::StorageIterator end)
-    : mStartIt(start), mEndIt(end) {
+template <typename U>
+SerialQueue<T>::Ring<U>::Ring(Ring&& other)
+    : mStorage(other.mStorage),
+      mCapacity(other.mCapacity),
+      mHead(other.mHead),
+      mSize(other.mSize) {
+    other.mStorage = nullptr;
+    other.mCapacity = 0;
+    other.mHead = 0;
+    other.mSize = 0;
 }
 
 template <typename T>
-typename SerialQueue<T>::Iterator SerialQueue<T>::BeginEnd::begin() const {
-    return {mStartIt};
+template <typename U>
+typename SerialQueue<T>::template Ring<U>& SerialQueue<T>::Ring<U>::operator=(Ring&& other) {
+    if (this != &other) {
+        Clear();
+        ::operator delete(mStorage);
+
+        mStorage = other.mStorage;
+        mCapacity = other.mCapacity;
+        mHead = other.mHead;
+        mSize = other.mSize;
+
+        other.mStorage = nullptr;
+        other.mCapacity = 0;
+        other.mHead = 0;
+        other.mSize = 0;
+    }
+    return *this;
 }
 
 template <typename T>
-typename SerialQueue<T>::Iterator SerialQueue<T>::BeginEnd::end() const {
-    return {mEndIt};
+template <typename U>
+SerialQueue<T>::Ring<U>::~Ring() {
+    Clear();
+    ::operator delete(mStorage);
 }
 
-// SerialQueue::Iterator
+template <typename T>
+template <typename U>
+size_t SerialQueue<T>::Ring<U>::Size() const {
+    return mSize;
+}
 
 template <typename T>
-SerialQueue<T>::Iterator::Iterator(typename SerialQueue<T>::StorageIterator start)
-    : mStorageIterator(start), mSerialIterator(nullptr) {
+template <typename U>
+U& SerialQueue<T>::Ring<U>::operator[](size_t index) {
+    NXT_ASSERT(index < mSize);
+    return mStorage[(mHead + index) & (mCapacity - 1)];
 }
 
 template <typename T>
-typename SerialQueue<T>::Iterator& SerialQueue<T>::Iterator::operator++() {
-    T* vectorData = mStorageIterator->second.data();
+template <typename U>
+const U& SerialQueue<T>::Ring<U>::operator[](size_t index) const {
+    NXT_ASSERT(index < mSize);
+    return mStorage[(mHead + index) & (mCapacity - 1)];
+}
 
-    if (mSerialIterator == nullptr) {
-        mSerialIterator = vectorData + 1;
-    } else {
-        mSerialIterator++;
+template <typename T>
+template <typename U>
+U& SerialQueue<T>::Ring<U>::Front() {
+    return (*this)[0];
+}
+
+template <typename T>
+template <typename U>
+const U& SerialQueue<T>::Ring<U>::Front() const {
+    return (*this)[0];
+}
+
+template <typename T>
+template <typename U>
+U& SerialQueue<T>::Ring<U>::Back() {
+    return (*this)[mSize - 1];
+}
+
+template <typename T>
+template <typename U>
+template <typename... Args>
+void SerialQueue<T>::Ring<U>::EmplaceBack(Args&&... args) {
+    if (mSize == mCapacity) {
+        Grow();
     }
+    new (&mStorage[(mHead + mSize) & (mCapacity - 1)]) U(std::forward<Args>(args)...);
+    mSize++;
+}
 
-    if (mSerialIterator >= vectorData + mStorageIterator->second.size()) {
-        mSerialIterator = nullptr;
-        mStorageIterator++;
+template <typename T>
+template <typename U>
+void SerialQueue<T>::Ring<U>::PopFront() {
+    NXT_ASSERT(mSize > 0);
+    mStorage[mHead].~U();
+    mHead = (mHead + 1) & (mCapacity - 1);
+    mSize--;
+}
+
+template <typename T>
+template <typename U>
+void SerialQueue<T>::Ring<U>::Clear() {
+    while (mSize > 0) {
+        PopFront();
+    }
+    mHead = 0;
+}
+
+template <typename T>
+template <typename U>
+void SerialQueue<T>::Ring<U>::Grow() {
+    size_t newCapacity = mCapacity == 0 ? 16 : mCapacity * 2;
+    U* newStorage = static_cast<U*>(::operator new(newCapacity * sizeof(U)));
+
+    // Move the elements to the start of the new storage, unwrapping them in the process.
+    for (size_t i = 0; i < mSize; ++i) {
+        U& element = (*this)[i];
+        new (&newStorage[i]) U(std::move(element));
+        element.~U();
     }
+    ::operator delete(mStorage);
+
+    mStorage = newStorage;
+    mCapacity = newCapacity;
+    mHead = 0;
+}
+
+// SerialQueue::BeginEnd
+
+template <typename T>
+SerialQueue<T>::BeginEnd::BeginEnd(SerialQueue<T>* queue, size_t start, size_t end)
+    : mQueue(queue), mStart(start), mEnd(end) {
+}
+
+template <typename T>
+typename SerialQueue<T>::Iterator SerialQueue<T>::BeginEnd::begin() const {
+    return {mQueue, mStart};
+}
 
+template <typename T>
+typename SerialQueue<T>::Iterator SerialQueue<T>::BeginEnd::end() const {
+    return {mQueue, mEnd};
+}
+
+// SerialQueue::Iterator
+
+template <typename T>
+SerialQueue<T>::Iterator::Iterator(SerialQueue<T>* queue, size_t index)
+    : mQueue(queue), mIndex(index) {
+}
+
+template <typename T>
+typename SerialQueue<T>::Iterator& SerialQueue<T>::Iterator::operator++() {
+    mIndex++;
     return *this;
 }
 
 template <typename T>
 bool SerialQueue<T>::Iterator::operator==(const typename SerialQueue<T>::Iterator& other) const {
-    return other.mStorageIterator == mStorageIterator && other.mSerialIterator == mSerialIterator;
+    return other.mQueue == mQueue && other.mIndex == mIndex;
 }
 
 template <typename T>
@@ -263,59 +431,45 @@ bool SerialQueue<T>::Iterator::operator!=(const typename SerialQueue<T>::Iterato
 
 template <typename T>
 T& SerialQueue<T>::Iterator::operator*() const {
-    if (mSerialIterator == nullptr) {
-        return *mStorageIterator->second.begin();
-    }
-    return *mSerialIterator;
+    return mQueue->mValues[mIndex];
 }
 
 // SerialQueue::ConstBeginEnd
 
 template <typename T>
-SerialQueue<T>::ConstBeginEnd::ConstBeginEnd(typename SerialQueue<T>::ConstStorageIterator start,
-                                             typename SerialQueue<T>::ConstStorageIterator end)
-    : mStartIt(start), mEndIt(end) {
+SerialQueue<T>::ConstBeginEnd::ConstBeginEnd(const SerialQueue<T>* queue,
+                                             size_t start,
+                                             size_t end)
+    : mQueue(queue), mStart(start), mEnd(end) {
 }
 
 template <typename T>
 typename SerialQueue<T>::ConstIterator SerialQueue<T>::ConstBeginEnd::begin() const {
-    return {mStartIt};
+    return {mQueue, mStart};
 }
 
 template <typename T>
 typename SerialQueue<T>::ConstIterator SerialQueue<T>::ConstBeginEnd::end() const {
-    return {mEndIt};
+    return {mQueue, mEnd};
 }
 
 // SerialQueue::ConstIterator
 
 template <typename T>
-SerialQueue<T>::ConstIterator::ConstIterator(typename SerialQueue<T>::ConstStorageIterator start)
-    : mStorageIterator(start), mSerialIterator(nullptr) {
+SerialQueue<T>::ConstIterator::ConstIterator(const SerialQueue<T>* queue, size_t index)
+    : mQueue(queue), mIndex(index) {
 }
 
 template <typename T>
 typename SerialQueue<T>::ConstIterator& SerialQueue<T>::ConstIterator::operator++() {
-    const T* vectorData = mStorageIterator->second.data();
-
-    if (mSerialIterator == nullptr) {
-        mSerialIterator = vectorData + 1;
-    } else {
-        mSerialIterator++;
-    }
-
-    if (mSerialIterator >= vectorData + mStorageIterator->second.size()) {
-        mSerialIterator = nullptr;
-        mStorageIterator++;
-    }
-
+    mIndex++;
     return *this;
 }
 
 template <typename T>
 bool SerialQueue<T>::ConstIterator::operator==(
     const typename SerialQueue<T>::ConstIterator& other) const {
-    return other.mStorageIterator == mStorageIterator && other.mSerialIterator == mSerialIterator;
+    return other.mQueue == mQueue && other.mIndex == mIndex;
 }
 
 template <typename T>
@@ -326,10 +480,7 @@ bool SerialQueue<T>::ConstIterator::operator!=(
 
 template <typename T>
 const T& SerialQueue<T>::ConstIterator::operator*() const {
-    if (mSerialIterator == nullptr) {
-        return *mStorageIterator->second.begin();
-    }
-    return *mSerialIterator;
+    return mQueue->mValues[mIndex];
 }
 
 #endif  // COMMON_SERIALQUEUE_H_
@@ -0,0 +1,65 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NXT_TRACING_H
+#define NXT_TRACING_H
+
+#include <nxt/nxt.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    /// Name of the C function of the entry point, for example "nxtQueueSubmit".
+    const char* name;
+
+    uint64_t callCount;
+    /// Extrapolated from the latency of the sampled calls.
+    uint64_t totalNanoseconds;
+
+    /// Percentiles of the latency of a sample of the calls, 0 when no call was sampled.
+    uint64_t p50Nanoseconds;
+    uint64_t p90Nanoseconds;
+    uint64_t p99Nanoseconds;
+
+    /// Bytes of the array and string arguments of all the calls.
+    uint64_t arrayBytes;
+} nxtTracingEntryPointStats;
+
+/// Fills tracingProcs with entry points that record statistics then forward to procs. The
+/// tracing entry points and statistics are global, so only one table can be wrapped per process:
+/// wrapping a different table returns false and leaves tracingProcs unchanged.
+bool nxtTracingWrapProcs(const nxtProcTable* procs, nxtProcTable* tracingProcs);
+
+/// Entry points are indexed in the order of nxtProcTable. Out of range entry points get zeroed
+/// statistics with a NULL name.
+uint32_t nxtTracingGetEntryPointCount();
+void nxtTracingGetEntryPointStats(uint32_t entryPoint, nxtTracingEntryPointStats* stats);
+
+/// Clears the statistics, calls in flight on other threads may still be recorded.
+void nxtTracingResetStats();
+
+/// Writes the statistics of the entry points that were called as a NUL-terminated JSON object,
+/// truncated to size bytes. Returns the size needed for the whole object, including the NUL.
+size_t nxtTracingDumpJSON(char* buffer, size_t size);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // NXT_TRACING_H
@@ -144,12 +144,12 @@ class BlendStateTest : public NXTTest {
                     .BeginRenderSubpass()
                         // First use the base pipeline to draw a triangle with no blending
                         .SetRenderPipeline(basePipeline)
-                        .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { base } })))
+                        .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { base } })), 0, nullptr)
                         .DrawArrays(3, 1, 0, 0)
 
                         // Then use the test pipeline to draw the test triangle with blending
                         .SetRenderPipeline(testPipeline)
-                        .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { triangle.color } })))
+                        .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { triangle.color } })), 0, nullptr)
                         .SetBlendColor(triangle.blendFactor[0], triangle.blendFactor[1], triangle.blendFactor[2], triangle.blendFactor[3])
                         .DrawArrays(3, 1, 0, 0)
                     .EndRenderSubpass()
@@ -819,11 +819,11 @@ TEST_P(BlendStateTest, IndependentBlendState) {
             .BeginRenderPass(renderpass, framebuffer)
             .BeginRenderSubpass()
             .SetRenderPipeline(basePipeline)
-            .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 4>({ { base, base, base, base } })))
+            .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 4>({ { base, base, base, base } })), 0, nullptr)
             .DrawArrays(3, 1, 0, 0)
 
             .SetRenderPipeline(testPipeline)
-            .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 4>({ { color0, color1, color2, color3 } })))
+            .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 4>({ { color0, color1, color2, color3 } })), 0, nullptr)
             .DrawArrays(3, 1, 0, 0)
             .EndRenderSubpass()
             .EndRenderPass()
@@ -908,10 +908,10 @@ TEST_P(BlendStateTest, DefaultBlendColor) {
             .BeginRenderPass(renderpass, framebuffer)
             .BeginRenderSubpass()
                 .SetRenderPipeline(basePipeline)
-                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(0, 0, 0, 0) } })))
+                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(0, 0, 0, 0) } })), 0, nullptr)
                 .DrawArrays(3, 1, 0, 0)
                 .SetRenderPipeline(testPipeline)
-                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(255, 255, 255, 255) } })))
+                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(255, 255, 255, 255) } })), 0, nullptr)
                 .DrawArrays(3, 1, 0, 0)
             .EndRenderSubpass()
             .EndRenderPass()
@@ -928,11 +928,11 @@ TEST_P(BlendStateTest, DefaultBlendColor) {
             .BeginRenderPass(renderpass, framebuffer)
             .BeginRenderSubpass()
                 .SetRenderPipeline(basePipeline)
-                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(0, 0, 0, 0) } })))
+                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(0, 0, 0, 0) } })), 0, nullptr)
                 .DrawArrays(3, 1, 0, 0)
                 .SetRenderPipeline(testPipeline)
                 .SetBlendColor(1, 1, 1, 1)
-                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(255, 255, 255, 255) } })))
+                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(255, 255, 255, 255) } })), 0, nullptr)
                 .DrawArrays(3, 1, 0, 0)
             .EndRenderSubpass()
             .EndRenderPass()
@@ -949,19 +949,19 @@ TEST_P(BlendStateTest, DefaultBlendColor) {
             .BeginRenderPass(renderpass, framebuffer)
             .BeginRenderSubpass()
                 .SetRenderPipeline(basePipeline)
-                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(0, 0, 0, 0) } })))
+                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(0, 0, 0, 0) } })), 0, nullptr)
                 .DrawArrays(3, 1, 0, 0)
                 .SetRenderPipeline(testPipeline)
                 .SetBlendColor(1, 1, 1, 1)
-                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(255, 255, 255, 255) } })))
+                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(255, 255, 255, 255) } })), 0, nullptr)
                 .DrawArrays(3, 1, 0, 0)
             .EndRenderSubpass()
             .BeginRenderSubpass()
                 .SetRenderPipeline(basePipeline2)
-                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(0, 0, 0, 0) } })))
+                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(0, 0, 0, 0) } })), 0, nullptr)
                 .DrawArrays(3, 1, 0, 0)
                 .SetRenderPipeline(testPipeline2)
-                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(255, 255, 255, 255) } })))
+                .SetBindGroup(0, MakeBindGroupForColors(std::array<RGBA8, 1>({ { RGBA8(255, 255, 255, 255) } })), 0, nullptr)
                 .DrawArrays(3, 1, 0, 0)
             .EndRenderSubpass()
             .EndRenderPass()
@@ -15,6 +15,7 @@
 #include "tests/NXTTest.h"
 
 #include <cstring>
+#include <vector>
 
 class BufferMapReadTests : public NXTTest {
     protected:
@@ -37,8 +38,27 @@ class BufferMapReadTests : public NXTTest {
             return mappedData;
         }
 
+        static void MapReadRangesCallback(nxtBufferMapReadStatus status, uint32_t count, const void* const* data, nxtCallbackUserdata userdata) {
+            ASSERT_EQ(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, status);
+            ASSERT_NE(nullptr, data);
+
+            auto test = reinterpret_cast<BufferMapReadTests*>(static_cast<uintptr_t>(userdata));
+            test->mappedRanges.assign(data, data + count);
+        }
+
+        std::vector<const void*> MapReadRangesAsyncAndWait(uint32_t count, const nxt::Buffer* buffers, const uint32_t* starts, const uint32_t* sizes) {
+            device.MapReadRangesAsync(count, buffers, starts, sizes, MapReadRangesCallback, static_cast<nxt::CallbackUserdata>(reinterpret_cast<uintptr_t>(this)));
+
+            while (mappedRanges.empty()) {
+                WaitABit();
+            }
+
+            return mappedRanges;
+        }
+
     private:
         const void* mappedData = nullptr;
+        std::vector<const void*> mappedRanges;
 };
 
 // Test that the simplest map read (one u32 at offset 0) works.
@@ -100,6 +120,37 @@ TEST_P(BufferMapReadTests, LargeRead) {
     buffer.Unmap();
 }
 
+// Test mapping multiple ranges of multiple buffers in a single request.
+TEST_P(BufferMapReadTests, MultipleRanges) {
+    nxt::Buffer buffers[2];
+    for (uint32_t i = 0; i < 2; ++i) {
+        buffers[i] = device.CreateBufferBuilder()
+            .SetSize(4000)
+            .SetAllowedUsage(nxt::BufferUsageBit::MapRead | nxt::BufferUsageBit::TransferDst)
+            .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+            .GetResult();
+
+        uint32_t myData[2] = {100 + i, 200 + i};
+        buffers[i].SetSubData(0, 1, &myData[0]);
+        buffers[i].SetSubData(2048 / sizeof(uint32_t), 1, &myData[1]);
+        buffers[i].TransitionUsage(nxt::BufferUsageBit::MapRead);
+    }
+
+    nxt::Buffer rangeBuffers[] = {buffers[0].Clone(), buffers[1].Clone(), buffers[0].Clone(), buffers[1].Clone()};
+    uint32_t starts[] = {0, 0, 2048, 2048};
+    uint32_t sizes[] = {4, 4, 4, 4};
+
+    std::vector<const void*> mappedRanges = MapReadRangesAsyncAndWait(4, rangeBuffers, starts, sizes);
+    ASSERT_EQ(4u, mappedRanges.size());
+    ASSERT_EQ(100u, *reinterpret_cast<const uint32_t*>(mappedRanges[0]));
+    ASSERT_EQ(101u, *reinterpret_cast<const uint32_t*>(mappedRanges[1]));
+    ASSERT_EQ(200u, *reinterpret_cast<const uint32_t*>(mappedRanges[2]));
+    ASSERT_EQ(201u, *reinterpret_cast<const uint32_t*>(mappedRanges[3]));
+
+    buffers[0].Unmap();
+    buffers[1].Unmap();
+}
+
 NXT_INSTANTIATE_TEST(BufferMapReadTests, D3D12Backend, MetalBackend, OpenGLBackend, VulkanBackend)
 
 class BufferSetSubDataTests : public NXTTest {
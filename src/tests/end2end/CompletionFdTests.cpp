@@ -0,0 +1,98 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/NXTTest.h"
+
+#include "common/Platform.h"
+
+#if defined(NXT_PLATFORM_POSIX)
+#    include <poll.h>
+#endif
+
+class CompletionFdTests : public NXTTest {
+    protected:
+        void SetUp() override {
+            NXTTest::SetUp();
+            fd = device.GetCompletionFd();
+        }
+
+        // Returns whether the completion fd is readable or becomes readable within timeoutMs.
+        bool WaitForFd(int timeoutMs) {
+#if defined(NXT_PLATFORM_POSIX)
+            pollfd pollFd = {fd, POLLIN, 0};
+            return poll(&pollFd, 1, timeoutMs) == 1;
+#else
+            return false;
+#endif
+        }
+
+        // Ticks the device until it has no more completed work to handle. The fd must then stay
+        // unreadable instead of waking up event loops while the device is idle.
+        void ExpectIdleFdStaysUnreadable() {
+            for (int i = 0; i < 100 && WaitForFd(0); ++i) {
+                device.Tick();
+                WaitForFd(10);
+            }
+            EXPECT_FALSE(WaitForFd(50));
+        }
+
+        static void MapReadCallback(nxtBufferMapReadStatus status, const void* data, nxtCallbackUserdata userdata) {
+            ASSERT_EQ(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, status);
+            ASSERT_NE(nullptr, data);
+
+            auto test = reinterpret_cast<CompletionFdTests*>(static_cast<uintptr_t>(userdata));
+            test->mappedValue = *reinterpret_cast<const uint32_t*>(data);
+            test->mapped = true;
+        }
+
+        int fd = -1;
+        bool mapped = false;
+        uint32_t mappedValue = 0;
+};
+
+// Test that the completion fd wakes up a poll when a map read completes, and only then.
+TEST_P(CompletionFdTests, ReadableWhenMapReadCompletes) {
+    // Backends that can't tell when work completes don't have a completion fd.
+    if (fd == -1) {
+        return;
+    }
+
+    ExpectIdleFdStaysUnreadable();
+
+    nxt::Buffer buffer = device.CreateBufferBuilder()
+        .SetSize(4)
+        .SetAllowedUsage(nxt::BufferUsageBit::MapRead | nxt::BufferUsageBit::TransferDst)
+        .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+        .GetResult();
+
+    uint32_t myData = 2934875;
+    buffer.SetSubData(0, 1, &myData);
+    buffer.TransitionUsage(nxt::BufferUsageBit::MapRead);
+    buffer.MapReadAsync(0, 4, MapReadCallback, static_cast<nxt::CallbackUserdata>(reinterpret_cast<uintptr_t>(this)));
+
+    // Sleep on the fd like an event loop would, ticking only when it is readable.
+    for (int i = 0; i < 10 && !mapped; ++i) {
+        if (WaitForFd(1000)) {
+            device.Tick();
+        }
+    }
+    ASSERT_TRUE(mapped);
+    ASSERT_EQ(myData, mappedValue);
+
+    buffer.Unmap();
+
+    ExpectIdleFdStaysUnreadable();
+}
+
+NXT_INSTANTIATE_TEST(CompletionFdTests, D3D12Backend, MetalBackend, OpenGLBackend, VulkanBackend)
@@ -243,7 +243,7 @@ class DepthStencilStateTest : public NXTTest {
 
                 builder.SetRenderPipeline(pipeline)
                     .SetStencilReference(test.stencil)  // Set the stencil reference
-                    .SetBindGroup(0, bindGroup)         // Set the bind group which contains color and depth data
+                    .SetBindGroup(0, bindGroup, 0, nullptr)         // Set the bind group which contains color and depth data
                     .DrawArrays(6, 1, 0, 0);
             }
 
@@ -0,0 +1,194 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/NXTTest.h"
+
+#include "common/Constants.h"
+#include "utils/NXTHelpers.h"
+
+#include <array>
+
+constexpr static unsigned int kRTSize = 64;
+constexpr static uint32_t kOffsetInFloats = kDynamicBufferOffsetAlignment / sizeof(float);
+constexpr static uint32_t kOffsetInUints = kDynamicBufferOffsetAlignment / sizeof(uint32_t);
+
+class DynamicBufferOffsetTest : public NXTTest {
+};
+
+// Test that draws using the same bind group read the dynamic uniform buffer at their own offset
+TEST_P(DynamicBufferOffsetTest, UniformBufferInRenderPass) {
+    nxt::Texture renderTarget = device.CreateTextureBuilder()
+        .SetDimension(nxt::TextureDimension::e2D)
+        .SetExtent(kRTSize, kRTSize, 1)
+        .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+        .SetMipLevels(1)
+        .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment | nxt::TextureUsageBit::TransferSrc)
+        .SetInitialUsage(nxt::TextureUsageBit::OutputAttachment)
+        .GetResult();
+    nxt::TextureView renderTargetView = renderTarget.CreateTextureViewBuilder().GetResult();
+
+    nxt::RenderPass renderpass = device.CreateRenderPassBuilder()
+        .SetAttachmentCount(1)
+        .SetSubpassCount(1)
+        .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+        .AttachmentSetColorLoadOp(0, nxt::LoadOp::Clear)
+        .SubpassSetColorAttachment(0, 0, 0)
+        .GetResult();
+    nxt::Framebuffer framebuffer = device.CreateFramebufferBuilder()
+        .SetRenderPass(renderpass)
+        .SetDimensions(kRTSize, kRTSize)
+        .SetAttachment(0, renderTargetView)
+        .GetResult();
+
+    nxt::BindGroupLayout bgl = device.CreateBindGroupLayoutBuilder()
+        .SetBindingsType(nxt::ShaderStageBit::Fragment, nxt::BindingType::DynamicUniformBuffer, 0, 1)
+        .GetResult();
+    nxt::PipelineLayout pl = device.CreatePipelineLayoutBuilder()
+        .SetBindGroupLayout(0, bgl)
+        .GetResult();
+
+    // Vertices 0 to 5 cover the left half of the render target and vertices 6 to 11 the right half.
+    nxt::ShaderModule vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+        #version 450
+        void main() {
+            const vec2 pos[6] = vec2[6](vec2(-1.f, -1.f), vec2(0.f, -1.f), vec2(-1.f, 1.f),
+                                        vec2(0.f, -1.f), vec2(0.f, 1.f), vec2(-1.f, 1.f));
+            gl_Position = vec4(pos[gl_VertexIndex % 6] + vec2(gl_VertexIndex / 6, 0.f), 0.f, 1.f);
+        })"
+    );
+    nxt::ShaderModule fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+        #version 450
+        layout(set = 0, binding = 0) uniform ColorBlock {
+            vec4 color;
+        } colorBlock;
+        layout(location = 0) out vec4 fragColor;
+        void main() {
+            fragColor = colorBlock.color;
+        })"
+    );
+    nxt::RenderPipeline pipeline = device.CreateRenderPipelineBuilder()
+        .SetSubpass(renderpass, 0)
+        .SetLayout(pl)
+        .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+        .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+        .GetResult();
+
+    // Red at offset 0 and green one dynamic offset alignment further.
+    std::array<float, 2 * kOffsetInFloats> colors = {};
+    colors[0] = 1.0f;
+    colors[3] = 1.0f;
+    colors[kOffsetInFloats + 1] = 1.0f;
+    colors[kOffsetInFloats + 3] = 1.0f;
+    nxt::Buffer buffer = utils::CreateFrozenBufferFromData(device, colors.data(), static_cast<uint32_t>(sizeof(colors)), nxt::BufferUsageBit::Uniform);
+    nxt::BufferView view = buffer.CreateBufferViewBuilder()
+        .SetExtent(0, 4 * sizeof(float))
+        .GetResult();
+    nxt::BindGroup bindGroup = device.CreateBindGroupBuilder()
+        .SetLayout(bgl)
+        .SetUsage(nxt::BindGroupUsage::Frozen)
+        .SetBufferViews(0, 1, &view)
+        .GetResult();
+
+    uint32_t redOffset = 0;
+    uint32_t greenOffset = kDynamicBufferOffsetAlignment;
+    nxt::CommandBuffer commands = device.CreateCommandBufferBuilder()
+        .BeginRenderPass(renderpass, framebuffer)
+            .BeginRenderSubpass()
+                .SetRenderPipeline(pipeline)
+                .SetBindGroup(0, bindGroup, 1, &redOffset)
+                .DrawArrays(6, 1, 0, 0)
+                .SetBindGroup(0, bindGroup, 1, &greenOffset)
+                .DrawArrays(6, 1, 6, 0)
+            .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(255, 0, 0, 255), renderTarget, kRTSize / 4, kRTSize / 2);
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 3 * kRTSize / 4, kRTSize / 2);
+}
+
+// Test that dispatches using the same bind group access the dynamic uniform and storage buffers at
+// their own offsets
+TEST_P(DynamicBufferOffsetTest, UniformAndStorageBuffersInComputePass) {
+    nxt::BindGroupLayout bgl = device.CreateBindGroupLayoutBuilder()
+        .SetBindingsType(nxt::ShaderStageBit::Compute, nxt::BindingType::DynamicUniformBuffer, 0, 1)
+        .SetBindingsType(nxt::ShaderStageBit::Compute, nxt::BindingType::DynamicStorageBuffer, 1, 1)
+        .GetResult();
+    nxt::PipelineLayout pl = device.CreatePipelineLayoutBuilder()
+        .SetBindGroupLayout(0, bgl)
+        .GetResult();
+
+    nxt::ShaderModule module = utils::CreateShaderModule(device, nxt::ShaderStage::Compute, R"(
+        #version 450
+        layout(set = 0, binding = 0) uniform UniformBlock {
+            uint value;
+        } uniformBlock;
+        layout(set = 0, binding = 1) buffer StorageBlock {
+            uint value;
+        } storageBlock;
+        void main() {
+            storageBlock.value = uniformBlock.value;
+        })"
+    );
+    nxt::ComputePipeline pipeline = device.CreateComputePipelineBuilder()
+        .SetLayout(pl)
+        .SetStage(nxt::ShaderStage::Compute, module, "main")
+        .GetResult();
+
+    std::array<uint32_t, 2 * kOffsetInUints> values = {};
+    values[0] = 42;
+    values[kOffsetInUints] = 1337;
+    nxt::Buffer uniformBuffer = utils::CreateFrozenBufferFromData(device, values.data(), static_cast<uint32_t>(sizeof(values)), nxt::BufferUsageBit::Uniform);
+
+    std::array<uint32_t, 3 * kOffsetInUints> zeroes = {};
+    nxt::Buffer storageBuffer = device.CreateBufferBuilder()
+        .SetSize(sizeof(zeroes))
+        .SetAllowedUsage(nxt::BufferUsageBit::Storage | nxt::BufferUsageBit::TransferSrc | nxt::BufferUsageBit::TransferDst)
+        .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+        .GetResult();
+    storageBuffer.SetSubData(0, static_cast<uint32_t>(zeroes.size()), zeroes.data());
+
+    nxt::BufferView views[2] = {
+        uniformBuffer.CreateBufferViewBuilder().SetExtent(0, sizeof(uint32_t)).GetResult(),
+        storageBuffer.CreateBufferViewBuilder().SetExtent(0, sizeof(uint32_t)).GetResult(),
+    };
+    nxt::BindGroup bindGroup = device.CreateBindGroupBuilder()
+        .SetLayout(bgl)
+        .SetUsage(nxt::BindGroupUsage::Frozen)
+        .SetBufferViews(0, 2, views)
+        .GetResult();
+
+    uint32_t offsets1[2] = {0, 0};
+    uint32_t offsets2[2] = {kDynamicBufferOffsetAlignment, 2 * kDynamicBufferOffsetAlignment};
+    nxt::CommandBuffer commands = device.CreateCommandBufferBuilder()
+        .TransitionBufferUsage(storageBuffer, nxt::BufferUsageBit::Storage)
+        .BeginComputePass()
+            .SetComputePipeline(pipeline)
+            .SetBindGroup(0, bindGroup, 2, offsets1)
+            .Dispatch(1, 1, 1)
+            .SetBindGroup(0, bindGroup, 2, offsets2)
+            .Dispatch(1, 1, 1)
+        .EndComputePass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_BUFFER_U32_EQ(42, storageBuffer, 0);
+    EXPECT_BUFFER_U32_EQ(0, storageBuffer, kDynamicBufferOffsetAlignment);
+    EXPECT_BUFFER_U32_EQ(1337, storageBuffer, 2 * kDynamicBufferOffsetAlignment);
+}
+
+NXT_INSTANTIATE_TEST(DynamicBufferOffsetTest, D3D12Backend, MetalBackend, OpenGLBackend)
@@ -0,0 +1,221 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/NXTTest.h"
+
+#include "utils/NXTHelpers.h"
+
+constexpr uint32_t kRTSize = 400;
+
+class IndirectCommandsTest : public NXTTest {
+    protected:
+        void SetUp() override {
+            NXTTest::SetUp();
+
+            renderpass = device.CreateRenderPassBuilder()
+                .SetAttachmentCount(1)
+                .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+                .AttachmentSetColorLoadOp(0, nxt::LoadOp::Clear)
+                .SetSubpassCount(1)
+                .SubpassSetColorAttachment(0, 0, 0)
+                .GetResult();
+
+            renderTarget = device.CreateTextureBuilder()
+                .SetDimension(nxt::TextureDimension::e2D)
+                .SetExtent(kRTSize, kRTSize, 1)
+                .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+                .SetMipLevels(1)
+                .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment | nxt::TextureUsageBit::TransferSrc)
+                .SetInitialUsage(nxt::TextureUsageBit::OutputAttachment)
+                .GetResult();
+
+            renderTargetView = renderTarget.CreateTextureViewBuilder().GetResult();
+
+            framebuffer = device.CreateFramebufferBuilder()
+                .SetRenderPass(renderpass)
+                .SetAttachment(0, renderTargetView)
+                .SetDimensions(kRTSize, kRTSize)
+                .GetResult();
+
+            nxt::InputState inputState = device.CreateInputStateBuilder()
+                .SetInput(0, 4 * sizeof(float), nxt::InputStepMode::Vertex)
+                .SetAttribute(0, 0, nxt::VertexFormat::FloatR32G32B32A32, 0)
+                .GetResult();
+
+            nxt::ShaderModule vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                layout(location = 0) in vec4 pos;
+                void main() {
+                    gl_Position = pos;
+                })"
+            );
+
+            nxt::ShaderModule fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = vec4(0.0, 1.0, 0.0, 1.0);
+                })"
+            );
+
+            renderPipeline = device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderpass, 0)
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .SetIndexFormat(nxt::IndexFormat::Uint32)
+                .SetInputState(inputState)
+                .GetResult();
+
+            // A triangle covering the top-left half of the render target
+            vertexBuffer = utils::CreateFrozenBufferFromData<float>(device, nxt::BufferUsageBit::Vertex, {
+                -1.0f,  1.0f, 0.0f, 1.0f,
+                 1.0f,  1.0f, 0.0f, 1.0f,
+                -1.0f, -1.0f, 0.0f, 1.0f
+            });
+        }
+
+        nxt::CommandBufferBuilder BeginDraw() {
+            uint32_t zeroOffset = 0;
+            nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+            builder.BeginRenderPass(renderpass, framebuffer)
+                .BeginRenderSubpass()
+                .SetRenderPipeline(renderPipeline)
+                .SetVertexBuffers(0, 1, &vertexBuffer, &zeroOffset);
+            return builder;
+        }
+
+        nxt::RenderPass renderpass;
+        nxt::Texture renderTarget;
+        nxt::TextureView renderTargetView;
+        nxt::Framebuffer framebuffer;
+        nxt::RenderPipeline renderPipeline;
+        nxt::Buffer vertexBuffer;
+};
+
+// Test that DrawArraysIndirect uses the arguments at the indirect offset
+TEST_P(IndirectCommandsTest, DrawArraysIndirect) {
+    // The first arguments have an instance count of 0 and would draw nothing
+    nxt::Buffer indirectBuffer = utils::CreateFrozenBufferFromData<uint32_t>(device, nxt::BufferUsageBit::Indirect, {
+        3, 0, 0, 0,
+        3, 1, 0, 0
+    });
+
+    nxt::CommandBuffer commands = BeginDraw()
+            .DrawArraysIndirect(indirectBuffer, 4 * sizeof(uint32_t))
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 100, 100);
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 0, 0, 0), renderTarget, 300, 300);
+}
+
+// Test that DrawArraysIndirect draws nothing when the vertex count is 0
+TEST_P(IndirectCommandsTest, DrawArraysIndirectEmpty) {
+    nxt::Buffer indirectBuffer = utils::CreateFrozenBufferFromData<uint32_t>(device, nxt::BufferUsageBit::Indirect, {
+        0, 1, 0, 0
+    });
+
+    nxt::CommandBuffer commands = BeginDraw()
+            .DrawArraysIndirect(indirectBuffer, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 0, 0, 0), renderTarget, 100, 100);
+}
+
+// Test that DrawElementsIndirect reads the indices starting at the first index of the arguments
+TEST_P(IndirectCommandsTest, DrawElementsIndirect) {
+    // Drawing the first three indices would produce a degenerate triangle
+    nxt::Buffer indexBuffer = utils::CreateFrozenBufferFromData<uint32_t>(device, nxt::BufferUsageBit::Index, {
+        0, 0, 0, 0, 1, 2
+    });
+    nxt::Buffer indirectBuffer = utils::CreateFrozenBufferFromData<uint32_t>(device, nxt::BufferUsageBit::Indirect, {
+        3, 1, 3, 0, 0
+    });
+
+    nxt::CommandBuffer commands = BeginDraw()
+            .SetIndexBuffer(indexBuffer, 0)
+            .DrawElementsIndirect(indirectBuffer, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 100, 100);
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 0, 0, 0), renderTarget, 300, 300);
+}
+
+// Test that DispatchIndirect runs the number of workgroups of the arguments
+TEST_P(IndirectCommandsTest, DispatchIndirect) {
+    nxt::Buffer counter = device.CreateBufferBuilder()
+        .SetSize(4)
+        .SetAllowedUsage(nxt::BufferUsageBit::Storage | nxt::BufferUsageBit::TransferSrc | nxt::BufferUsageBit::TransferDst)
+        .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+        .GetResult();
+    uint32_t zero = 0;
+    counter.SetSubData(0, 1, &zero);
+
+    nxt::BindGroupLayout bgl = device.CreateBindGroupLayoutBuilder()
+        .SetBindingsType(nxt::ShaderStageBit::Compute, nxt::BindingType::StorageBuffer, 0, 1)
+        .GetResult();
+    nxt::PipelineLayout pl = device.CreatePipelineLayoutBuilder()
+        .SetBindGroupLayout(0, bgl)
+        .GetResult();
+    nxt::BufferView view = counter.CreateBufferViewBuilder().SetExtent(0, 4).GetResult();
+    nxt::BindGroup bindGroup = device.CreateBindGroupBuilder()
+        .SetLayout(bgl)
+        .SetUsage(nxt::BindGroupUsage::Frozen)
+        .SetBufferViews(0, 1, &view)
+        .GetResult();
+
+    nxt::ShaderModule module = utils::CreateShaderModule(device, nxt::ShaderStage::Compute, R"(
+        #version 450
+        layout(set = 0, binding = 0) buffer Counter {
+            uint count;
+        } counter;
+        void main() {
+            atomicAdd(counter.count, 1);
+        })"
+    );
+    nxt::ComputePipeline pipeline = device.CreateComputePipelineBuilder()
+        .SetLayout(pl)
+        .SetStage(nxt::ShaderStage::Compute, module, "main")
+        .GetResult();
+
+    nxt::Buffer indirectBuffer = utils::CreateFrozenBufferFromData<uint32_t>(device, nxt::BufferUsageBit::Indirect, {
+        0, 2, 3, 1
+    });
+
+    nxt::CommandBuffer commands = device.CreateCommandBufferBuilder()
+        .TransitionBufferUsage(counter, nxt::BufferUsageBit::Storage)
+        .BeginComputePass()
+            .SetComputePipeline(pipeline)
+            .SetBindGroup(0, bindGroup, 0, nullptr)
+            .DispatchIndirect(indirectBuffer, sizeof(uint32_t))
+        .EndComputePass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_BUFFER_U32_EQ(6, counter, 0);
+}
+
+NXT_INSTANTIATE_TEST(IndirectCommandsTest, D3D12Backend, MetalBackend, OpenGLBackend)
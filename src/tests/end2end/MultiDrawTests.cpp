@@ -0,0 +1,173 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/NXTTest.h"
+
+#include "utils/NXTHelpers.h"
+
+constexpr uint32_t kRTSize = 400;
+
+class MultiDrawTest : public NXTTest {
+    protected:
+        void SetUp() override {
+            NXTTest::SetUp();
+
+            renderpass = device.CreateRenderPassBuilder()
+                .SetAttachmentCount(1)
+                .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+                .AttachmentSetColorLoadOp(0, nxt::LoadOp::Clear)
+                .SetSubpassCount(1)
+                .SubpassSetColorAttachment(0, 0, 0)
+                .GetResult();
+
+            renderTarget = device.CreateTextureBuilder()
+                .SetDimension(nxt::TextureDimension::e2D)
+                .SetExtent(kRTSize, kRTSize, 1)
+                .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+                .SetMipLevels(1)
+                .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment | nxt::TextureUsageBit::TransferSrc)
+                .SetInitialUsage(nxt::TextureUsageBit::OutputAttachment)
+                .GetResult();
+
+            renderTargetView = renderTarget.CreateTextureViewBuilder().GetResult();
+
+            framebuffer = device.CreateFramebufferBuilder()
+                .SetRenderPass(renderpass)
+                .SetAttachment(0, renderTargetView)
+                .SetDimensions(kRTSize, kRTSize)
+                .GetResult();
+
+            nxt::InputState inputState = device.CreateInputStateBuilder()
+                .SetInput(0, 4 * sizeof(float), nxt::InputStepMode::Vertex)
+                .SetAttribute(0, 0, nxt::VertexFormat::FloatR32G32B32A32, 0)
+                .GetResult();
+
+            nxt::ShaderModule vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                layout(location = 0) in vec4 pos;
+                void main() {
+                    gl_Position = pos;
+                })"
+            );
+
+            nxt::ShaderModule fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = vec4(0.0, 1.0, 0.0, 1.0);
+                })"
+            );
+
+            renderPipeline = device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderpass, 0)
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .SetIndexFormat(nxt::IndexFormat::Uint32)
+                .SetInputState(inputState)
+                .GetResult();
+
+            // A triangle covering the top-left half of the render target followed by a triangle
+            // covering the bottom-right half.
+            vertexBuffer = utils::CreateFrozenBufferFromData<float>(device, nxt::BufferUsageBit::Vertex, {
+                -1.0f,  1.0f, 0.0f, 1.0f,
+                 1.0f,  1.0f, 0.0f, 1.0f,
+                -1.0f, -1.0f, 0.0f, 1.0f,
+
+                 1.0f,  1.0f, 0.0f, 1.0f,
+                 1.0f, -1.0f, 0.0f, 1.0f,
+                -1.0f, -1.0f, 0.0f, 1.0f
+            });
+        }
+
+        nxt::CommandBufferBuilder BeginDraw() {
+            uint32_t zeroOffset = 0;
+            nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+            builder.BeginRenderPass(renderpass, framebuffer)
+                .BeginRenderSubpass()
+                .SetRenderPipeline(renderPipeline)
+                .SetVertexBuffers(0, 1, &vertexBuffer, &zeroOffset);
+            return builder;
+        }
+
+        nxt::RenderPass renderpass;
+        nxt::Texture renderTarget;
+        nxt::TextureView renderTargetView;
+        nxt::Framebuffer framebuffer;
+        nxt::RenderPipeline renderPipeline;
+        nxt::Buffer vertexBuffer;
+};
+
+// Test that MultiDrawArrays draws each of its draws
+TEST_P(MultiDrawTest, MultiDrawArrays) {
+    uint32_t vertexCounts[] = {3, 3};
+    uint32_t instanceCounts[] = {1, 1};
+    uint32_t firstVertices[] = {0, 3};
+    uint32_t firstInstances[] = {0, 0};
+
+    nxt::CommandBuffer commands = BeginDraw()
+            .MultiDrawArrays(2, vertexCounts, instanceCounts, firstVertices, firstInstances)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 100, 100);
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 300, 300);
+}
+
+// Test that MultiDrawArrays uses the instance count of each draw
+TEST_P(MultiDrawTest, MultiDrawArraysInstanceCounts) {
+    uint32_t vertexCounts[] = {3, 3};
+    uint32_t instanceCounts[] = {0, 2};
+    uint32_t firstVertices[] = {0, 3};
+    uint32_t firstInstances[] = {0, 0};
+
+    nxt::CommandBuffer commands = BeginDraw()
+            .MultiDrawArrays(2, vertexCounts, instanceCounts, firstVertices, firstInstances)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 0, 0, 0), renderTarget, 100, 100);
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 300, 300);
+}
+
+// Test that MultiDrawElements reads the indices starting at the first index of each draw
+TEST_P(MultiDrawTest, MultiDrawElements) {
+    // The indices in between the draws would produce a degenerate triangle
+    nxt::Buffer indexBuffer = utils::CreateFrozenBufferFromData<uint32_t>(device, nxt::BufferUsageBit::Index, {
+        0, 1, 2, 0, 0, 0, 3, 4, 5
+    });
+    uint32_t indexCounts[] = {3, 3};
+    uint32_t instanceCounts[] = {1, 1};
+    uint32_t firstIndices[] = {0, 6};
+    uint32_t firstInstances[] = {0, 0};
+
+    nxt::CommandBuffer commands = BeginDraw()
+            .SetIndexBuffer(indexBuffer, 0)
+            .MultiDrawElements(2, indexCounts, instanceCounts, firstIndices, firstInstances)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 100, 100);
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 300, 300);
+}
+
+NXT_INSTANTIATE_TEST(MultiDrawTest, D3D12Backend, MetalBackend, OpenGLBackend)
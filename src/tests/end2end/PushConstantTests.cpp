@@ -250,7 +250,7 @@ TEST_P(PushConstantTest, ComputePassDefaultsToZero) {
         .BeginComputePass()
             // Test compute push constants are set to zero by default.
             .SetComputePipeline(pipeline)
-            .SetBindGroup(0, binding.bindGroup)
+            .SetBindGroup(0, binding.bindGroup, 0, nullptr)
             .Dispatch(1, 1, 1)
             // Set push constants to non-zero value to check they will be reset to zero
             // on the next BeginComputePass
@@ -258,7 +258,7 @@ TEST_P(PushConstantTest, ComputePassDefaultsToZero) {
         .EndComputePass()
         .BeginComputePass()
             .SetComputePipeline(pipeline)
-            .SetBindGroup(0, binding.bindGroup)
+            .SetBindGroup(0, binding.bindGroup, 0, nullptr)
             .Dispatch(1, 1, 1)
         .EndComputePass()
         .GetResult();
@@ -336,7 +336,7 @@ TEST_P(PushConstantTest, VariousConstantTypes) {
         .BeginComputePass()
             .SetPushConstants(nxt::ShaderStageBit::Compute, 0, 3, reinterpret_cast<uint32_t*>(&values))
             .SetComputePipeline(pipeline)
-            .SetBindGroup(0, binding.bindGroup)
+            .SetBindGroup(0, binding.bindGroup, 0, nullptr)
             .Dispatch(1, 1, 1)
         .EndComputePass()
         .GetResult();
@@ -365,12 +365,12 @@ TEST_P(PushConstantTest, InheritThroughPipelineLayoutChange) {
             // Set Push constant before there is a pipeline set
             .SetPushConstants(nxt::ShaderStageBit::Compute, 0, 1, &one)
             .SetComputePipeline(pipeline1)
-            .SetBindGroup(0, binding1.bindGroup)
+            .SetBindGroup(0, binding1.bindGroup, 0, nullptr)
             .Dispatch(1, 1, 1)
             // Change the push constant before changing pipeline layout
             .SetPushConstants(nxt::ShaderStageBit::Compute, 0, 1, &two)
             .SetComputePipeline(pipeline2)
-            .SetBindGroup(0, binding2.bindGroup)
+            .SetBindGroup(0, binding2.bindGroup, 0, nullptr)
             .Dispatch(1, 1, 1)
         .EndComputePass()
         .GetResult();
@@ -398,7 +398,7 @@ TEST_P(PushConstantTest, SetAllConstantsToNonZero) {
         .BeginComputePass()
             .SetPushConstants(nxt::ShaderStageBit::Compute, 0, kMaxPushConstants, &values[0])
             .SetComputePipeline(pipeline)
-            .SetBindGroup(0, binding.bindGroup)
+            .SetBindGroup(0, binding.bindGroup, 0, nullptr)
             .Dispatch(1, 1, 1)
         .EndComputePass()
         .GetResult();
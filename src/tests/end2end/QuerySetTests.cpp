@@ -0,0 +1,138 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/NXTTest.h"
+
+#include "utils/NXTHelpers.h"
+
+constexpr uint32_t kRTSize = 64;
+
+class QuerySetTest : public NXTTest {
+    protected:
+        void SetUp() override {
+            NXTTest::SetUp();
+
+            renderpass = device.CreateRenderPassBuilder()
+                .SetAttachmentCount(1)
+                .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+                .AttachmentSetColorLoadOp(0, nxt::LoadOp::Clear)
+                .SetSubpassCount(1)
+                .SubpassSetColorAttachment(0, 0, 0)
+                .GetResult();
+
+            renderTarget = device.CreateTextureBuilder()
+                .SetDimension(nxt::TextureDimension::e2D)
+                .SetExtent(kRTSize, kRTSize, 1)
+                .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+                .SetMipLevels(1)
+                .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment | nxt::TextureUsageBit::TransferSrc)
+                .SetInitialUsage(nxt::TextureUsageBit::OutputAttachment)
+                .GetResult();
+
+            renderTargetView = renderTarget.CreateTextureViewBuilder().GetResult();
+
+            framebuffer = device.CreateFramebufferBuilder()
+                .SetRenderPass(renderpass)
+                .SetAttachment(0, renderTargetView)
+                .SetDimensions(kRTSize, kRTSize)
+                .GetResult();
+
+            nxt::InputState inputState = device.CreateInputStateBuilder()
+                .SetInput(0, 4 * sizeof(float), nxt::InputStepMode::Vertex)
+                .SetAttribute(0, 0, nxt::VertexFormat::FloatR32G32B32A32, 0)
+                .GetResult();
+
+            nxt::ShaderModule vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                layout(location = 0) in vec4 pos;
+                void main() {
+                    gl_Position = pos;
+                })"
+            );
+
+            nxt::ShaderModule fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = vec4(0.0, 1.0, 0.0, 1.0);
+                })"
+            );
+
+            renderPipeline = device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderpass, 0)
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .SetInputState(inputState)
+                .GetResult();
+
+            // Two triangles covering the whole render target
+            vertexBuffer = utils::CreateFrozenBufferFromData<float>(device, nxt::BufferUsageBit::Vertex, {
+                -1.0f,  1.0f, 0.0f, 1.0f,
+                 1.0f,  1.0f, 0.0f, 1.0f,
+                -1.0f, -1.0f, 0.0f, 1.0f,
+                 1.0f,  1.0f, 0.0f, 1.0f,
+                 1.0f, -1.0f, 0.0f, 1.0f,
+                -1.0f, -1.0f, 0.0f, 1.0f
+            });
+        }
+
+        nxt::Buffer CreateResultBuffer(uint32_t queryCount) {
+            return device.CreateBufferBuilder()
+                .SetSize(queryCount * sizeof(uint64_t))
+                .SetAllowedUsage(nxt::BufferUsageBit::TransferSrc | nxt::BufferUsageBit::TransferDst)
+                .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+                .GetResult();
+        }
+
+        nxt::RenderPass renderpass;
+        nxt::Texture renderTarget;
+        nxt::TextureView renderTargetView;
+        nxt::Framebuffer framebuffer;
+        nxt::RenderPipeline renderPipeline;
+        nxt::Buffer vertexBuffer;
+};
+
+// Test that occlusion queries count the samples that passed the depth and stencil tests
+TEST_P(QuerySetTest, OcclusionQuery) {
+    nxt::QuerySet querySet = device.CreateQuerySetBuilder()
+        .SetType(nxt::QueryType::Occlusion)
+        .SetCount(2)
+        .GetResult();
+    nxt::Buffer results = CreateResultBuffer(2);
+
+    uint32_t zeroOffset = 0;
+    nxt::CommandBuffer commands = device.CreateCommandBufferBuilder()
+        .BeginRenderPass(renderpass, framebuffer)
+        .BeginRenderSubpass()
+            .SetRenderPipeline(renderPipeline)
+            .SetVertexBuffers(0, 1, &vertexBuffer, &zeroOffset)
+            .BeginQuery(querySet, 0)
+            .DrawArrays(6, 1, 0, 0)
+            .EndQuery(querySet, 0)
+            .BeginQuery(querySet, 1)
+            .EndQuery(querySet, 1)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .TransitionBufferUsage(results, nxt::BufferUsageBit::TransferDst)
+        .ResolveQuerySet(querySet, 0, 2, results, 0)
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    // The results are 64 bit integers, compare them as pairs of 32 bit words.
+    uint32_t expected[4] = {kRTSize * kRTSize, 0, 0, 0};
+    EXPECT_BUFFER_U32_RANGE_EQ(expected, results, 0, 4);
+}
+
+NXT_INSTANTIATE_TEST(QuerySetTest, OpenGLBackend)
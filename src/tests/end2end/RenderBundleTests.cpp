@@ -0,0 +1,172 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/NXTTest.h"
+
+#include "utils/NXTHelpers.h"
+
+constexpr uint32_t kRTSize = 400;
+
+class RenderBundleTest : public NXTTest {
+    protected:
+        void SetUp() override {
+            NXTTest::SetUp();
+
+            renderpass = device.CreateRenderPassBuilder()
+                .SetAttachmentCount(1)
+                .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+                .AttachmentSetColorLoadOp(0, nxt::LoadOp::Clear)
+                .SetSubpassCount(1)
+                .SubpassSetColorAttachment(0, 0, 0)
+                .GetResult();
+
+            renderTarget = device.CreateTextureBuilder()
+                .SetDimension(nxt::TextureDimension::e2D)
+                .SetExtent(kRTSize, kRTSize, 1)
+                .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+                .SetMipLevels(1)
+                .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment | nxt::TextureUsageBit::TransferSrc)
+                .SetInitialUsage(nxt::TextureUsageBit::OutputAttachment)
+                .GetResult();
+
+            renderTargetView = renderTarget.CreateTextureViewBuilder().GetResult();
+
+            framebuffer = device.CreateFramebufferBuilder()
+                .SetRenderPass(renderpass)
+                .SetAttachment(0, renderTargetView)
+                .SetDimensions(kRTSize, kRTSize)
+                .GetResult();
+
+            nxt::InputState inputState = device.CreateInputStateBuilder()
+                .SetInput(0, 4 * sizeof(float), nxt::InputStepMode::Vertex)
+                .SetAttribute(0, 0, nxt::VertexFormat::FloatR32G32B32A32, 0)
+                .GetResult();
+
+            nxt::ShaderModule vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                layout(location = 0) in vec4 pos;
+                void main() {
+                    gl_Position = pos;
+                })"
+            );
+
+            nxt::ShaderModule fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(push_constant) uniform ColorBlock {
+                    float r;
+                    float g;
+                    float b;
+                    float a;
+                } block;
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = vec4(block.r, block.g, block.b, block.a);
+                })"
+            );
+
+            renderPipeline = device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderpass, 0)
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .SetInputState(inputState)
+                .GetResult();
+
+            // A triangle covering the top-left half of the render target
+            topLeftBuffer = utils::CreateFrozenBufferFromData<float>(device, nxt::BufferUsageBit::Vertex, {
+                -1.0f,  1.0f, 0.0f, 1.0f,
+                 1.0f,  1.0f, 0.0f, 1.0f,
+                -1.0f, -1.0f, 0.0f, 1.0f
+            });
+
+            // A triangle covering the bottom-right half of the render target
+            bottomRightBuffer = utils::CreateFrozenBufferFromData<float>(device, nxt::BufferUsageBit::Vertex, {
+                 1.0f,  1.0f, 0.0f, 1.0f,
+                 1.0f, -1.0f, 0.0f, 1.0f,
+                -1.0f, -1.0f, 0.0f, 1.0f
+            });
+        }
+
+        // Records a draw of the triangle in the vertex buffer with the given color.
+        template <typename Builder>
+        void RecordDraw(Builder* builder, const nxt::Buffer& vertexBuffer, const float color[4]) {
+            uint32_t zeroOffset = 0;
+            builder->SetRenderPipeline(renderPipeline)
+                .SetPushConstants(nxt::ShaderStageBit::Fragment, 0, 4,
+                                  reinterpret_cast<const uint32_t*>(color))
+                .SetVertexBuffers(0, 1, &vertexBuffer, &zeroOffset)
+                .DrawArrays(3, 1, 0, 0);
+        }
+
+        nxt::RenderBundle MakeBundle(const nxt::Buffer& vertexBuffer, const float color[4]) {
+            nxt::RenderBundleBuilder builder = device.CreateRenderBundleBuilder();
+            builder.SetSubpass(renderpass, 0);
+            RecordDraw(&builder, vertexBuffer, color);
+            return builder.GetResult();
+        }
+
+        nxt::RenderPass renderpass;
+        nxt::Texture renderTarget;
+        nxt::TextureView renderTargetView;
+        nxt::Framebuffer framebuffer;
+        nxt::RenderPipeline renderPipeline;
+        nxt::Buffer topLeftBuffer;
+        nxt::Buffer bottomRightBuffer;
+};
+
+// Test that executing bundles draws their commands
+TEST_P(RenderBundleTest, Basic) {
+    const float kGreen[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+    const float kBlue[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    nxt::RenderBundle bundles[2] = {MakeBundle(topLeftBuffer, kGreen),
+                                    MakeBundle(bottomRightBuffer, kBlue)};
+
+    nxt::CommandBuffer commands = device.CreateCommandBufferBuilder()
+        .BeginRenderPass(renderpass, framebuffer)
+        .BeginRenderSubpass()
+            .ExecuteBundles(2, bundles)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    queue.Submit(1, &commands);
+
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 100, 100);
+    EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 0, 255, 255), renderTarget, 300, 300);
+}
+
+// Test that bundles can be mixed with commands recorded directly in the command buffer, and that a
+// bundle can be executed by several command buffers
+TEST_P(RenderBundleTest, MixedWithCommands) {
+    const float kGreen[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+    const float kRed[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+    nxt::RenderBundle bundle = MakeBundle(topLeftBuffer, kGreen);
+
+    for (int i = 0; i < 2; ++i) {
+        nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+        builder.BeginRenderPass(renderpass, framebuffer)
+            .BeginRenderSubpass()
+            .ExecuteBundles(1, &bundle);
+        RecordDraw(&builder, bottomRightBuffer, kRed);
+        nxt::CommandBuffer commands = builder.EndRenderSubpass()
+            .EndRenderPass()
+            .GetResult();
+
+        queue.Submit(1, &commands);
+
+        EXPECT_PIXEL_RGBA8_EQ(RGBA8(0, 255, 0, 255), renderTarget, 100, 100);
+        EXPECT_PIXEL_RGBA8_EQ(RGBA8(255, 0, 0, 255), renderTarget, 300, 300);
+    }
+}
+
+NXT_INSTANTIATE_TEST(RenderBundleTest, D3D12Backend, MetalBackend, OpenGLBackend)
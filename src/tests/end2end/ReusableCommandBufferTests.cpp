@@ -0,0 +1,154 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/NXTTest.h"
+
+#include "utils/NXTHelpers.h"
+
+#include <array>
+
+constexpr static unsigned int kRTSize = 16;
+
+class ReusableCommandBufferTest : public NXTTest {
+    protected:
+        void SetUp() override {
+            NXTTest::SetUp();
+
+            renderTarget = device.CreateTextureBuilder()
+                .SetDimension(nxt::TextureDimension::e2D)
+                .SetExtent(kRTSize, kRTSize, 1)
+                .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+                .SetMipLevels(1)
+                .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment | nxt::TextureUsageBit::TransferSrc)
+                .SetInitialUsage(nxt::TextureUsageBit::OutputAttachment)
+                .GetResult();
+
+            renderpass = device.CreateRenderPassBuilder()
+                .SetAttachmentCount(1)
+                .SetSubpassCount(1)
+                .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+                .AttachmentSetColorLoadOp(0, nxt::LoadOp::Clear)
+                .SubpassSetColorAttachment(0, 0, 0)
+                .GetResult();
+
+            framebuffer = device.CreateFramebufferBuilder()
+                .SetRenderPass(renderpass)
+                .SetDimensions(kRTSize, kRTSize)
+                .SetAttachment(0, renderTarget.CreateTextureViewBuilder().GetResult())
+                .GetResult();
+
+            colorBuffer = device.CreateBufferBuilder()
+                .SetSize(4 * sizeof(float))
+                .SetAllowedUsage(nxt::BufferUsageBit::Uniform | nxt::BufferUsageBit::TransferDst)
+                .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+                .GetResult();
+
+            nxt::BindGroupLayout bgl = device.CreateBindGroupLayoutBuilder()
+                .SetBindingsType(nxt::ShaderStageBit::Fragment, nxt::BindingType::UniformBuffer, 0, 1)
+                .GetResult();
+            nxt::BufferView view = colorBuffer.CreateBufferViewBuilder()
+                .SetExtent(0, 4 * sizeof(float))
+                .GetResult();
+            bindGroup = device.CreateBindGroupBuilder()
+                .SetLayout(bgl)
+                .SetUsage(nxt::BindGroupUsage::Frozen)
+                .SetBufferViews(0, 1, &view)
+                .GetResult();
+
+            // Draws the left half of the render target with the color in the uniform buffer.
+            nxt::ShaderModule vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                void main() {
+                    const vec2 pos[6] = vec2[6](vec2(-1.f, -1.f), vec2(0.f, -1.f), vec2(-1.f, 1.f),
+                                                vec2(0.f, -1.f), vec2(0.f, 1.f), vec2(-1.f, 1.f));
+                    gl_Position = vec4(pos[gl_VertexIndex], 0.f, 1.f);
+                })"
+            );
+            nxt::ShaderModule fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(set = 0, binding = 0) uniform ColorBlock {
+                    vec4 color;
+                } colorBlock;
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = colorBlock.color;
+                })"
+            );
+            pipeline = device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderpass, 0)
+                .SetLayout(device.CreatePipelineLayoutBuilder().SetBindGroupLayout(0, bgl).GetResult())
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .GetResult();
+
+            // The command buffer transitions the uniform buffer so that it stays valid when the
+            // buffer is transitioned for SetSubData between submits.
+            commands = device.CreateCommandBufferBuilder()
+                .SetReusable(true)
+                .TransitionBufferUsage(colorBuffer, nxt::BufferUsageBit::Uniform)
+                .BeginRenderPass(renderpass, framebuffer)
+                    .BeginRenderSubpass()
+                        .SetRenderPipeline(pipeline)
+                        .SetBindGroup(0, bindGroup, 0, nullptr)
+                        .DrawArrays(6, 1, 0, 0)
+                    .EndRenderSubpass()
+                .EndRenderPass()
+                .GetResult();
+        }
+
+        void SetColor(float r, float g, float b, float a) {
+            std::array<float, 4> color = {{r, g, b, a}};
+            colorBuffer.TransitionUsage(nxt::BufferUsageBit::TransferDst);
+            colorBuffer.SetSubData(0, static_cast<uint32_t>(color.size()), reinterpret_cast<const uint32_t*>(color.data()));
+        }
+
+        void SubmitAndExpect(RGBA8 drawn, RGBA8 cleared) {
+            queue.Submit(1, &commands);
+            EXPECT_PIXEL_RGBA8_EQ(drawn, renderTarget, kRTSize / 4, kRTSize / 2);
+            EXPECT_PIXEL_RGBA8_EQ(cleared, renderTarget, 3 * kRTSize / 4, kRTSize / 2);
+        }
+
+        nxt::Texture renderTarget;
+        nxt::RenderPass renderpass;
+        nxt::Framebuffer framebuffer;
+        nxt::Buffer colorBuffer;
+        nxt::BindGroup bindGroup;
+        nxt::RenderPipeline pipeline;
+        nxt::CommandBuffer commands;
+};
+
+// Test that each submit of a reusable command buffer uses the current clear color of the framebuffer
+TEST_P(ReusableCommandBufferTest, ClearColorChangesBetweenSubmits) {
+    SetColor(0.0f, 0.0f, 1.0f, 1.0f);
+
+    framebuffer.AttachmentSetClearColor(0, 1.0f, 0.0f, 0.0f, 1.0f);
+    SubmitAndExpect(RGBA8(0, 0, 255, 255), RGBA8(255, 0, 0, 255));
+
+    framebuffer.AttachmentSetClearColor(0, 0.0f, 1.0f, 0.0f, 1.0f);
+    SubmitAndExpect(RGBA8(0, 0, 255, 255), RGBA8(0, 255, 0, 255));
+}
+
+// Test that each submit of a reusable command buffer reads the current content of the buffers in
+// its bind groups, after they were transitioned out of the usage the command buffer needs
+TEST_P(ReusableCommandBufferTest, BoundBufferChangesBetweenSubmits) {
+    framebuffer.AttachmentSetClearColor(0, 0.0f, 0.0f, 0.0f, 0.0f);
+
+    SetColor(1.0f, 0.0f, 0.0f, 1.0f);
+    SubmitAndExpect(RGBA8(255, 0, 0, 255), RGBA8(0, 0, 0, 0));
+
+    SetColor(0.0f, 1.0f, 0.0f, 1.0f);
+    SubmitAndExpect(RGBA8(0, 255, 0, 255), RGBA8(0, 0, 0, 0));
+}
+
+NXT_INSTANTIATE_TEST(ReusableCommandBufferTest, D3D12Backend, MetalBackend, OpenGLBackend)
@@ -0,0 +1,45 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TESTS_PERF_BENCHMARKUTILS_H_
+#define TESTS_PERF_BENCHMARKUTILS_H_
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace perf {
+
+    // Calls run runCount times and returns the duration of the fastest call, in nanoseconds.
+    // Taking the best run filters out most of the noise from the scheduler and the caches.
+    template <typename F>
+    double MeasureBestRun(int runCount, F run) {
+        using Clock = std::chrono::steady_clock;
+
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < runCount; ++i) {
+            Clock::time_point start = Clock::now();
+            run();
+            Clock::time_point end = Clock::now();
+
+            double nanoseconds = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            best = std::min(best, nanoseconds);
+        }
+        return best;
+    }
+
+}  // namespace perf
+
+#endif  // TESTS_PERF_BENCHMARKUTILS_H_
@@ -0,0 +1,175 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures large SetSubData and MapReadAsync calls through the wire, with a null backend server in
+// the same process, when their data is sent inline in the commands and when it goes through a
+// BulkDataChannel. Use a release build.
+
+#include "common/Assert.h"
+#include "common/Math.h"
+#include "tests/perf/BenchmarkUtils.h"
+#include "wire/BulkDataChannel.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/Wire.h"
+
+#include <nxt/nxtcpp.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace backend { namespace null {
+    void Init(nxtProcTable* procs, nxtDevice* device);
+}}  // namespace backend::null
+
+namespace {
+
+    constexpr int kRunCount = 100;
+    constexpr size_t kSizes[] = {64 * 1024, 1024 * 1024, 4 * 1024 * 1024};
+    constexpr size_t kMaxSize = 4 * 1024 * 1024;
+    // Twice the biggest payload so that each call finds space in the region.
+    constexpr size_t kBulkDataSize = 2 * kMaxSize;
+
+    // A wire client and a null backend server in the same process, optionally connected by a
+    // BulkDataChannel.
+    class Wire {
+      public:
+        Wire(bool useBulkData) {
+            if (useBulkData) {
+                size_t memorySize =
+                    nxt::wire::BulkDataChannel::GetRequiredMemorySize(kBulkDataSize, kBulkDataSize);
+                mBulkDataAllocation.resize(memorySize + 64);
+                uint8_t* memory = AlignPtr(mBulkDataAllocation.data(), 64);
+                nxt::wire::BulkDataChannel::Initialize(memory);
+                mClientBulkData.reset(new nxt::wire::BulkDataChannel(
+                    memory, kBulkDataSize, kBulkDataSize, nxt::wire::BulkDataChannel::Side::Client));
+                mServerBulkData.reset(new nxt::wire::BulkDataChannel(
+                    memory, kBulkDataSize, kBulkDataSize, nxt::wire::BulkDataChannel::Side::Server));
+            }
+
+            nxtProcTable backendProcs;
+            nxtDevice backendDevice;
+            backend::null::Init(&backendProcs, &backendDevice);
+            mServer.reset(nxt::wire::NewServerCommandHandler(
+                backendDevice, backendProcs, &mReturnCommands, mServerBulkData.get()));
+            mCommands.SetHandler(mServer.get());
+
+            nxtProcTable procs;
+            nxtDevice device;
+            mClient.reset(
+                nxt::wire::NewClientDevice(&procs, &device, &mCommands, mClientBulkData.get()));
+            mReturnCommands.SetHandler(mClient.get());
+            nxtSetProcs(&procs);
+            mDevice = nxt::Device::Acquire(device);
+        }
+
+        ~Wire() {
+            mDevice = nxt::Device();
+            Flush();
+        }
+
+        const nxt::Device& GetDevice() const {
+            return mDevice;
+        }
+
+        void Flush() {
+            mCommands.Flush();
+            mReturnCommands.Flush();
+        }
+
+      private:
+        std::vector<uint8_t> mBulkDataAllocation;
+        std::unique_ptr<nxt::wire::BulkDataChannel> mClientBulkData;
+        std::unique_ptr<nxt::wire::BulkDataChannel> mServerBulkData;
+        nxt::wire::ChunkedCommandSerializer mCommands;
+        nxt::wire::ChunkedCommandSerializer mReturnCommands;
+        std::unique_ptr<nxt::wire::CommandHandler> mServer;
+        std::unique_ptr<nxt::wire::CommandHandler> mClient;
+        nxt::Device mDevice;
+    };
+
+    struct Results {
+        double setSubData[3];
+        double mapRead[3];
+    };
+
+    void MapReadCallback(nxtBufferMapReadStatus status,
+                         const void* data,
+                         nxtCallbackUserdata userdata) {
+        ASSERT(status == NXT_BUFFER_MAP_READ_STATUS_SUCCESS);
+        *reinterpret_cast<const void**>(static_cast<uintptr_t>(userdata)) = data;
+    }
+
+    // Returns the best times, in microseconds, of a SetSubData and of a MapReadAsync until its
+    // callback, for each of kSizes.
+    Results Measure(bool useBulkData) {
+        Wire wire(useBulkData);
+        const nxt::Device& device = wire.GetDevice();
+        nxt::Queue queue = device.CreateQueueBuilder().GetResult();
+
+        nxt::Buffer upload = device.CreateBufferBuilder()
+                                 .SetSize(kMaxSize)
+                                 .SetAllowedUsage(nxt::BufferUsageBit::TransferDst)
+                                 .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+                                 .GetResult();
+        nxt::Buffer readback = device.CreateBufferBuilder()
+                                   .SetSize(kMaxSize)
+                                   .SetAllowedUsage(nxt::BufferUsageBit::MapRead)
+                                   .SetInitialUsage(nxt::BufferUsageBit::MapRead)
+                                   .GetResult();
+        std::vector<uint32_t> data(kMaxSize / sizeof(uint32_t), 42);
+
+        Results results;
+        for (size_t i = 0; i < 3; ++i) {
+            uint32_t size = static_cast<uint32_t>(kSizes[i]);
+
+            results.setSubData[i] = perf::MeasureBestRun(kRunCount, [&]() {
+                upload.SetSubData(0, size / sizeof(uint32_t), data.data());
+                wire.Flush();
+            }) / 1000.0;
+
+            results.mapRead[i] = perf::MeasureBestRun(kRunCount, [&]() {
+                const void* mappedData = nullptr;
+                readback.MapReadAsync(
+                    0, size, MapReadCallback,
+                    static_cast<nxtCallbackUserdata>(reinterpret_cast<uintptr_t>(&mappedData)));
+                queue.Submit(0, nullptr);
+                wire.Flush();
+                ASSERT(mappedData != nullptr);
+                readback.Unmap();
+            }) / 1000.0;
+        }
+
+        return results;
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    Results inlineData = Measure(false);
+    Results bulkData = Measure(true);
+
+    printf("Best of %d calls through the wire to a null backend, in microseconds:\n", kRunCount);
+    printf("                  inline      bulk\n");
+    for (size_t i = 0; i < 3; ++i) {
+        printf("  SetSubData %4zuKB  %8.1f  %8.1f\n", kSizes[i] / 1024, inlineData.setSubData[i],
+               bulkData.setSubData[i]);
+    }
+    for (size_t i = 0; i < 3; ++i) {
+        printf("  MapRead    %4zuKB  %8.1f  %8.1f\n", kSizes[i] / 1024, inlineData.mapRead[i],
+               bulkData.mapRead[i]);
+    }
+
+    return 0;
+}
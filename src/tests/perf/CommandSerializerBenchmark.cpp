@@ -0,0 +1,78 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures recording commands in the wire's ChunkedCommandSerializer and flushing them to a
+// handler once per frame, for frames of small commands like the ones of a draw loop. Use a release
+// build.
+
+#include "tests/perf/BenchmarkUtils.h"
+#include "wire/ChunkedCommandSerializer.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+    constexpr int kRunCount = 200;
+    constexpr uint32_t kCommandsPerFrame = 20000;
+
+    // The sizes of a SetPushConstants with 4 values and of a DrawArrays, alternating.
+    constexpr size_t kCommandSizes[2] = {40, 24};
+
+    // Reads every command so that the flushed data is used.
+    class ChecksumHandler : public nxt::wire::CommandHandler {
+      public:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+            for (size_t i = 0; i < size; i += sizeof(uint32_t)) {
+                uint32_t word;
+                memcpy(&word, &commands[i], sizeof(word));
+                mChecksum += word;
+            }
+            return commands + size;
+        }
+
+        uint32_t GetChecksum() const {
+            return mChecksum;
+        }
+
+      private:
+        uint32_t mChecksum = 0;
+    };
+
+    void RecordFrame(nxt::wire::CommandSerializer* serializer) {
+        for (uint32_t i = 0; i < kCommandsPerFrame; ++i) {
+            size_t size = kCommandSizes[i % 2];
+            uint32_t* command = reinterpret_cast<uint32_t*>(serializer->GetCmdSpace(size));
+            command[0] = i;
+            memset(&command[1], 0, size - sizeof(uint32_t));
+        }
+        serializer->Flush();
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    ChecksumHandler handler;
+    nxt::wire::ChunkedCommandSerializer serializer(&handler);
+
+    double best = perf::MeasureBestRun(kRunCount, [&]() { RecordFrame(&serializer); });
+    double nsPerCommand = best / kCommandsPerFrame;
+
+    printf("Best of %d frames of %u commands recorded and flushed:\n", kRunCount,
+           kCommandsPerFrame);
+    printf("  %.2f ns per command, %.1f M commands/s\n", nsPerCommand, 1000.0 / nsPerCommand);
+    printf("  (checksum %u)\n", handler.GetChecksum());
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the size of a frame of SetPushConstants and DrawArrays commands, like Animometer's,
+// recorded by the wire client with and without the compact encoding, and how fast the
+// CompactCommandHandler decodes it. Use a release build.
+
+#include "common/Assert.h"
+#include "tests/perf/BenchmarkUtils.h"
+#include "tests/perf/DrawBenchmarkUtils.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/CompactEncoding.h"
+#include "wire/Wire.h"
+
+#include <nxt/nxtcpp.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+
+    constexpr int kRunCount = 200;
+    constexpr uint32_t kDrawCount = 10000;
+
+    // Keeps a copy of all the commands it is given.
+    class RecordingHandler : public nxt::wire::CommandHandler {
+      public:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+            data.insert(data.end(), commands, commands + size);
+            return commands + size;
+        }
+
+        std::vector<uint8_t> data;
+    };
+
+    // Accepts commands without doing anything with them.
+    class NullHandler : public nxt::wire::CommandHandler {
+      public:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+            return commands + size;
+        }
+    };
+
+    void RecordFrame(const nxt::Device& device, const perf::DrawState& state) {
+        nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+        builder.BeginRenderPass(state.renderPass, state.framebuffer)
+            .BeginRenderSubpass()
+            .SetRenderPipeline(state.pipeline);
+        for (uint32_t i = 0; i < kDrawCount; ++i) {
+            float constants[4] = {0.1f * i, 0.2f, 0.3f, 0.4f};
+            builder
+                .SetPushConstants(nxt::ShaderStageBit::Vertex, 0, 4,
+                                  reinterpret_cast<const uint32_t*>(constants))
+                .DrawArrays(3, 1, 0, 0);
+        }
+        builder.EndRenderSubpass().EndRenderPass().GetResult();
+    }
+
+    // Records a frame with the wire client and returns the stream given to the transport.
+    std::vector<uint8_t> RecordStream(bool compact, uint64_t* frameSize) {
+        RecordingHandler recorder;
+        nxt::wire::ChunkedCommandSerializer transport(&recorder);
+        std::unique_ptr<nxt::wire::CompactCommandSerializer> compactSerializer;
+        nxt::wire::CommandSerializer* serializer = &transport;
+        if (compact) {
+            compactSerializer.reset(new nxt::wire::CompactCommandSerializer(&transport));
+            serializer = compactSerializer.get();
+        }
+
+        nxtProcTable procs;
+        nxtDevice cDevice;
+        std::unique_ptr<nxt::wire::CommandHandler> client(
+            nxt::wire::NewClientDevice(&procs, &cDevice, serializer));
+        nxtSetProcs(&procs);
+        {
+            nxt::Device device = nxt::Device::Acquire(cDevice);
+            perf::DrawState state = perf::CreateDrawState(device);
+            serializer->Flush();
+            size_t setupSize = recorder.data.size();
+
+            RecordFrame(device, state);
+            serializer->Flush();
+            *frameSize = recorder.data.size() - setupSize;
+        }
+        serializer->Flush();
+        return std::move(recorder.data);
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    uint64_t rawFrameSize = 0;
+    uint64_t compactFrameSize = 0;
+    std::vector<uint8_t> raw = RecordStream(false, &rawFrameSize);
+    std::vector<uint8_t> compact = RecordStream(true, &compactFrameSize);
+
+    // Decodes the whole stream, which is mostly the frame, in a new handler each time since the
+    // encoding depends on the commands that came before.
+    NullHandler sink;
+    double best = perf::MeasureBestRun(kRunCount, [&]() {
+        nxt::wire::CompactCommandHandler handler(&sink);
+        const uint8_t* end = handler.HandleCommands(compact.data(), compact.size());
+        ASSERT(end != nullptr);
+    });
+
+    printf("A frame of %u SetPushConstants and DrawArrays:\n", kDrawCount);
+    printf("  Raw size      %8llu bytes\n", static_cast<unsigned long long>(rawFrameSize));
+    printf("  Compact size  %8llu bytes\n", static_cast<unsigned long long>(compactFrameSize));
+    printf("Best of %d decodes of the compact stream (%zu bytes, %zu decoded):\n", kRunCount,
+           compact.size(), raw.size());
+    printf("  %.1f us, %.0f MB/s of decoded commands\n", best / 1000.0,
+           static_cast<double>(raw.size()) * 1000.0 / best);
+
+    return 0;
+}
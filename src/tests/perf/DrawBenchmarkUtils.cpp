@@ -0,0 +1,79 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/perf/DrawBenchmarkUtils.h"
+
+#include "utils/NXTHelpers.h"
+
+#include <nxt/nxt.h>
+
+namespace backend { namespace null {
+    void Init(nxtProcTable* procs, nxtDevice* device);
+}}  // namespace backend::null
+
+namespace perf {
+
+    nxt::Device CreateNullDevice() {
+        nxtProcTable procs;
+        nxtDevice cDevice;
+        backend::null::Init(&procs, &cDevice);
+        nxtSetProcs(&procs);
+        return nxt::Device::Acquire(cDevice);
+    }
+
+    DrawState CreateDrawState(const nxt::Device& device) {
+        DrawState state;
+        state.renderPass = device.CreateRenderPassBuilder()
+                               .SetAttachmentCount(1)
+                               .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+                               .SetSubpassCount(1)
+                               .SubpassSetColorAttachment(0, 0, 0)
+                               .GetResult();
+
+        nxt::Texture texture = device.CreateTextureBuilder()
+                                   .SetDimension(nxt::TextureDimension::e2D)
+                                   .SetExtent(64, 64, 1)
+                                   .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+                                   .SetMipLevels(1)
+                                   .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment)
+                                   .GetResult();
+        texture.FreezeUsage(nxt::TextureUsageBit::OutputAttachment);
+        state.framebuffer = device.CreateFramebufferBuilder()
+                                .SetRenderPass(state.renderPass)
+                                .SetAttachment(0, texture.CreateTextureViewBuilder().GetResult())
+                                .SetDimensions(64, 64)
+                                .GetResult();
+
+        nxt::ShaderModule vsModule =
+            utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                void main() {
+                    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+                })");
+        nxt::ShaderModule fsModule =
+            utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = vec4(0.0, 1.0, 0.0, 1.0);
+                })");
+        state.pipeline = device.CreateRenderPipelineBuilder()
+                             .SetSubpass(state.renderPass, 0)
+                             .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                             .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                             .GetResult();
+        return state;
+    }
+
+}  // namespace perf
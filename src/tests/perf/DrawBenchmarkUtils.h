@@ -0,0 +1,36 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TESTS_PERF_DRAWBENCHMARKUTILS_H_
+#define TESTS_PERF_DRAWBENCHMARKUTILS_H_
+
+#include <nxt/nxtcpp.h>
+
+namespace perf {
+
+    // Sets the procs to the null backend's and returns its device.
+    nxt::Device CreateNullDevice();
+
+    // The objects needed to record draws: a render pass with one color attachment and a pipeline
+    // without bindings or vertex inputs.
+    struct DrawState {
+        nxt::RenderPass renderPass;
+        nxt::Framebuffer framebuffer;
+        nxt::RenderPipeline pipeline;
+    };
+    DrawState CreateDrawState(const nxt::Device& device);
+
+}  // namespace perf
+
+#endif  // TESTS_PERF_DRAWBENCHMARKUTILS_H_
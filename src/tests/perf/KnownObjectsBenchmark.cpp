@@ -0,0 +1,107 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the memory used by the wire server's KnownObjects with a million objects, and the time
+// of looking objects up in random order. The array of structs the server used before is measured
+// the same way for reference. Use a release build.
+
+#include "tests/perf/BenchmarkUtils.h"
+#include "wire/KnownObjects.h"
+
+#include <nxt/nxt.h>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+    constexpr int kRunCount = 20;
+    constexpr uint32_t kObjectCount = 1000000;
+
+    // The per-object data the server used to store for every type.
+    struct ObjectData {
+        nxtBuffer handle;
+        uint32_t serial = 0;
+        uint32_t builtObjectId = 0;
+        uint32_t builtObjectSerial = 0;
+        bool valid;
+        bool allocated;
+    };
+
+    nxtBuffer FakeHandle(uint32_t id) {
+        return reinterpret_cast<nxtBuffer>(static_cast<uintptr_t>(id + 1) * 16);
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    nxt::wire::server::KnownObjects<nxtBuffer> known;
+    std::vector<ObjectData> reference;
+    reference.emplace_back();
+    reference[0].handle = nullptr;
+    reference[0].valid = true;
+    reference[0].allocated = true;
+
+    for (uint32_t id = 1; id <= kObjectCount; ++id) {
+        known.Allocate(id, 0);
+        known.SetHandle(id, FakeHandle(id));
+
+        ObjectData data;
+        data.handle = FakeHandle(id);
+        data.valid = true;
+        data.allocated = true;
+        reference.push_back(data);
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<uint32_t> distribution(1, kObjectCount);
+    std::vector<uint32_t> ids(kObjectCount);
+    for (uint32_t& id : ids) {
+        id = distribution(generator);
+    }
+
+    // The handles are summed so that the lookups aren't optimized out.
+    uintptr_t knownSum = 0;
+    double knownLookup = perf::MeasureBestRun(kRunCount, [&]() {
+        for (uint32_t id : ids) {
+            nxtBuffer handle;
+            bool valid;
+            if (known.Get(id, &handle, &valid) && valid) {
+                knownSum += reinterpret_cast<uintptr_t>(handle);
+            }
+        }
+    });
+
+    uintptr_t referenceSum = 0;
+    double referenceLookup = perf::MeasureBestRun(kRunCount, [&]() {
+        for (uint32_t id : ids) {
+            if (id < reference.size() && reference[id].allocated && reference[id].valid) {
+                referenceSum += reinterpret_cast<uintptr_t>(reference[id].handle);
+            }
+        }
+    });
+
+    printf("%u objects, best of %d passes of random lookups:\n", kObjectCount, kRunCount);
+    printf("                   bytes per object  ns per lookup\n");
+    printf("  Array of structs  %8.2f          %8.2f\n",
+           static_cast<double>(reference.capacity() * sizeof(ObjectData)) / kObjectCount,
+           referenceLookup / kObjectCount);
+    printf("  KnownObjects      %8.2f          %8.2f\n",
+           static_cast<double>(known.GetMemoryUsage()) / kObjectCount,
+           knownLookup / kObjectCount);
+    printf("  (checksums %s)\n", knownSum == referenceSum ? "match" : "differ");
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures reading back the result of GPU work with MapReadAsync on the OpenGL backend: how long
+// the submit of the work and the MapReadAsync call block the CPU, and how long until the callback
+// is called while ticking the device. Drivers that copy to buffers on the CPU, like llvmpipe,
+// wait for the work in the submit already. Use a release build.
+
+#include "common/Assert.h"
+#include "common/Constants.h"
+#include "utils/BackendBinding.h"
+#include "utils/NXTHelpers.h"
+
+#include <nxt/nxt.h>
+#include <nxt/nxtcpp.h>
+#include "GLFW/glfw3.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kRunCount = 20;
+    constexpr uint32_t kRTSize = 512;
+    constexpr uint32_t kDrawCount = 4;
+
+    double Microseconds(Clock::time_point start, Clock::time_point end) {
+        return static_cast<double>(
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) /
+               1000.0;
+    }
+
+    double Median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    void MapReadCallback(nxtBufferMapReadStatus status,
+                         const void*,
+                         nxtCallbackUserdata userdata) {
+        NXT_ASSERT(status == NXT_BUFFER_MAP_READ_STATUS_SUCCESS);
+        *reinterpret_cast<bool*>(static_cast<uintptr_t>(userdata)) = true;
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    utils::BackendBinding* binding = utils::CreateBinding(utils::BackendType::OpenGL);
+    if (binding == nullptr || !glfwInit()) {
+        return 1;
+    }
+    glfwDefaultWindowHints();
+    binding->SetupGLFWWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "MapReadAsync benchmark", nullptr, nullptr);
+    if (window == nullptr) {
+        return 1;
+    }
+    binding->SetWindow(window);
+
+    nxtProcTable procs;
+    nxtDevice cDevice;
+    binding->GetProcAndDevice(&procs, &cDevice);
+    nxtSetProcs(&procs);
+
+    std::vector<double> submit;
+    std::vector<double> blocked;
+    std::vector<double> latency;
+    {
+        nxt::Device device = nxt::Device::Acquire(cDevice);
+        nxt::Queue queue = device.CreateQueueBuilder().GetResult();
+
+        nxt::Texture renderTarget =
+            device.CreateTextureBuilder()
+                .SetDimension(nxt::TextureDimension::e2D)
+                .SetExtent(kRTSize, kRTSize, 1)
+                .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+                .SetMipLevels(1)
+                .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment |
+                                 nxt::TextureUsageBit::TransferSrc)
+                .SetInitialUsage(nxt::TextureUsageBit::OutputAttachment)
+                .GetResult();
+        nxt::RenderPass renderPass = device.CreateRenderPassBuilder()
+                                         .SetAttachmentCount(1)
+                                         .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+                                         .SetSubpassCount(1)
+                                         .SubpassSetColorAttachment(0, 0, 0)
+                                         .GetResult();
+        nxt::Framebuffer framebuffer =
+            device.CreateFramebufferBuilder()
+                .SetRenderPass(renderPass)
+                .SetAttachment(0, renderTarget.CreateTextureViewBuilder().GetResult())
+                .SetDimensions(kRTSize, kRTSize)
+                .GetResult();
+
+        // A fullscreen triangle with a fragment shader long enough for the GPU to still be busy
+        // when MapReadAsync is called.
+        nxt::ShaderModule vsModule =
+            utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                void main() {
+                    const vec2 pos[3] = vec2[3](vec2(-1.f, -1.f), vec2(3.f, -1.f), vec2(-1.f, 3.f));
+                    gl_Position = vec4(pos[gl_VertexIndex], 0.f, 1.f);
+                })");
+        nxt::ShaderModule fsModule =
+            utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    float value = gl_FragCoord.x;
+                    for (int i = 0; i < 20; ++i) {
+                        value = fract(sin(value) * 43758.5453);
+                    }
+                    fragColor = vec4(value, 0.0, 0.0, 1.0);
+                })");
+        nxt::RenderPipeline pipeline = device.CreateRenderPipelineBuilder()
+                                           .SetSubpass(renderPass, 0)
+                                           .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                                           .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                                           .GetResult();
+
+        nxt::Buffer readback =
+            device.CreateBufferBuilder()
+                .SetSize(4)
+                .SetAllowedUsage(nxt::BufferUsageBit::MapRead | nxt::BufferUsageBit::TransferDst)
+                .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+                .GetResult();
+
+        for (int run = 0; run < kRunCount; ++run) {
+            renderTarget.TransitionUsage(nxt::TextureUsageBit::OutputAttachment);
+
+            nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+            builder.BeginRenderPass(renderPass, framebuffer)
+                .BeginRenderSubpass()
+                .SetRenderPipeline(pipeline);
+            for (uint32_t i = 0; i < kDrawCount; ++i) {
+                builder.DrawArrays(3, 1, 0, 0);
+            }
+            nxt::CommandBuffer commands =
+                builder.EndRenderSubpass()
+                    .EndRenderPass()
+                    .TransitionTextureUsage(renderTarget, nxt::TextureUsageBit::TransferSrc)
+                    .TransitionBufferUsage(readback, nxt::BufferUsageBit::TransferDst)
+                    .CopyTextureToBuffer(renderTarget, 0, 0, 0, 1, 1, 1, 0, readback, 0,
+                                         kTextureRowPitchAlignment)
+                    .GetResult();
+            Clock::time_point start = Clock::now();
+            queue.Submit(1, &commands);
+
+            bool mapped = false;
+            Clock::time_point submitted = Clock::now();
+            readback.TransitionUsage(nxt::BufferUsageBit::MapRead);
+            readback.MapReadAsync(0, 4, MapReadCallback,
+                                  static_cast<nxtCallbackUserdata>(
+                                      reinterpret_cast<uintptr_t>(&mapped)));
+            Clock::time_point returned = Clock::now();
+            while (!mapped) {
+                device.Tick();
+            }
+            Clock::time_point end = Clock::now();
+            readback.Unmap();
+
+            submit.push_back(Microseconds(start, submitted));
+            blocked.push_back(Microseconds(submitted, returned));
+            latency.push_back(Microseconds(submitted, end));
+        }
+    }
+
+    printf("Median of %d readbacks after %u fullscreen draws of %ux%u, in microseconds:\n",
+           kRunCount, kDrawCount, kRTSize, kRTSize);
+    printf("  Blocked in Submit        %8.1f\n", Median(submit));
+    printf("  Blocked in MapReadAsync  %8.1f\n", Median(blocked));
+    printf("  Until the callback       %8.1f\n", Median(latency));
+
+    delete binding;
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
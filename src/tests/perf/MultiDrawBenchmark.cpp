@@ -0,0 +1,77 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures recording many draws as DrawArrays calls or as a single MultiDrawArrays, with the null
+// backend and including the validation in GetResult. Use a release build.
+
+#include "tests/perf/BenchmarkUtils.h"
+#include "tests/perf/DrawBenchmarkUtils.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    constexpr int kRunCount = 200;
+    constexpr uint32_t kDrawCount = 10000;
+
+    // Returns the best time per draw, in nanoseconds, of recording a command buffer with a render
+    // pass in which record adds kDrawCount draws.
+    template <typename F>
+    double MeasureDraws(const nxt::Device& device, const perf::DrawState& state, F record) {
+        double best = perf::MeasureBestRun(kRunCount, [&]() {
+            nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+            builder.BeginRenderPass(state.renderPass, state.framebuffer)
+                .BeginRenderSubpass()
+                .SetRenderPipeline(state.pipeline);
+            record(builder);
+            builder.EndRenderSubpass().EndRenderPass().GetResult();
+        });
+        return best / kDrawCount;
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    nxt::Device device = perf::CreateNullDevice();
+    perf::DrawState state = perf::CreateDrawState(device);
+
+    std::vector<uint32_t> vertexCounts(kDrawCount, 3);
+    std::vector<uint32_t> instanceCounts(kDrawCount, 1);
+    std::vector<uint32_t> firstVertices(kDrawCount);
+    std::vector<uint32_t> firstInstances(kDrawCount, 0);
+    for (uint32_t i = 0; i < kDrawCount; ++i) {
+        firstVertices[i] = 3 * i;
+    }
+
+    double drawArrays =
+        MeasureDraws(device, state, [&](const nxt::CommandBufferBuilder& builder) {
+            for (uint32_t i = 0; i < kDrawCount; ++i) {
+                builder.DrawArrays(vertexCounts[i], instanceCounts[i], firstVertices[i],
+                                   firstInstances[i]);
+            }
+        });
+    double multiDrawArrays =
+        MeasureDraws(device, state, [&](const nxt::CommandBufferBuilder& builder) {
+            builder.MultiDrawArrays(kDrawCount, vertexCounts.data(), instanceCounts.data(),
+                                    firstVertices.data(), firstInstances.data());
+        });
+
+    printf("Best of %d command buffers of %u draws, in nanoseconds per draw:\n", kRunCount,
+           kDrawCount);
+    printf("  DrawArrays       %.2f\n", drawArrays);
+    printf("  MultiDrawArrays  %.2f\n", multiDrawArrays);
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the cost per frame of recording and submitting draws with the null backend, when the
+// draws are recorded in the command buffer and when they are executed from a render bundle built
+// once. Use a release build.
+
+#include "tests/perf/BenchmarkUtils.h"
+#include "tests/perf/DrawBenchmarkUtils.h"
+
+#include <cstdio>
+
+namespace {
+
+    constexpr int kRunCount = 200;
+    constexpr uint32_t kDrawCount = 10000;
+
+    // Records kDrawCount draws, each with its own push constants, like draws of different objects.
+    template <typename Builder>
+    void RecordDraws(const Builder& builder, const perf::DrawState& state) {
+        builder.SetRenderPipeline(state.pipeline);
+        for (uint32_t i = 0; i < kDrawCount; ++i) {
+            uint32_t constants[4] = {i, i, i, i};
+            builder.SetPushConstants(nxt::ShaderStageBit::Fragment, 0, 4, constants)
+                .DrawArrays(3, 1, 0, 0);
+        }
+    }
+
+    nxt::CommandBuffer RecordFrame(const nxt::Device& device,
+                                   const perf::DrawState& state,
+                                   const nxt::RenderBundle* bundle) {
+        nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+        builder.BeginRenderPass(state.renderPass, state.framebuffer).BeginRenderSubpass();
+        if (bundle != nullptr) {
+            builder.ExecuteBundles(1, bundle);
+        } else {
+            RecordDraws(builder, state);
+        }
+        return builder.EndRenderSubpass().EndRenderPass().GetResult();
+    }
+
+    struct FrameCost {
+        double record;
+        double submit;
+    };
+
+    // Returns the best times, in microseconds, of recording a frame of kDrawCount draws with
+    // GetResult and of submitting it.
+    FrameCost MeasureFrame(const nxt::Device& device,
+                           const perf::DrawState& state,
+                           const nxt::RenderBundle* bundle) {
+        nxt::Queue queue = device.CreateQueueBuilder().GetResult();
+        nxt::CommandBuffer commands = RecordFrame(device, state, bundle);
+
+        FrameCost cost;
+        cost.record =
+            perf::MeasureBestRun(kRunCount, [&]() { RecordFrame(device, state, bundle); }) /
+            1000.0;
+        cost.submit = perf::MeasureBestRun(kRunCount, [&]() { queue.Submit(1, &commands); }) /
+                      1000.0;
+        return cost;
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    nxt::Device device = perf::CreateNullDevice();
+    perf::DrawState state = perf::CreateDrawState(device);
+
+    nxt::RenderBundleBuilder bundleBuilder = device.CreateRenderBundleBuilder();
+    bundleBuilder.SetSubpass(state.renderPass, 0);
+    RecordDraws(bundleBuilder, state);
+    nxt::RenderBundle bundle = bundleBuilder.GetResult();
+
+    FrameCost direct = MeasureFrame(device, state, nullptr);
+    FrameCost bundled = MeasureFrame(device, state, &bundle);
+
+    printf("Best of %d frames of %u draws, in microseconds per frame:\n", kRunCount, kDrawCount);
+    printf("                  record  submit\n");
+    printf("  Command buffer  %6.1f  %6.1f\n", direct.record, direct.submit);
+    printf("  Render bundle   %6.1f  %6.1f\n", bundled.record, bundled.submit);
+
+    return 0;
+}
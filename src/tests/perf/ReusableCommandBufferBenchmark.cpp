@@ -0,0 +1,68 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures submitting the same command buffer again with the null backend, with and without
+// SetReusable. Use a release build.
+
+#include "tests/perf/BenchmarkUtils.h"
+#include "tests/perf/DrawBenchmarkUtils.h"
+
+#include <cstdio>
+
+namespace {
+
+    constexpr int kRunCount = 200;
+    constexpr uint32_t kDrawCount = 10000;
+
+    nxt::CommandBuffer RecordDraws(const nxt::Device& device,
+                                   const perf::DrawState& state,
+                                   bool reusable) {
+        nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+        builder.SetReusable(reusable)
+            .BeginRenderPass(state.renderPass, state.framebuffer)
+            .BeginRenderSubpass()
+            .SetRenderPipeline(state.pipeline);
+        for (uint32_t i = 0; i < kDrawCount; ++i) {
+            builder.DrawArrays(3, 1, 3 * i, 0);
+        }
+        return builder.EndRenderSubpass().EndRenderPass().GetResult();
+    }
+
+    // Returns the best time, in microseconds, of submitting a command buffer of kDrawCount draws
+    // that was already submitted once.
+    double MeasureResubmit(const nxt::Device& device, const perf::DrawState& state, bool reusable) {
+        nxt::Queue queue = device.CreateQueueBuilder().GetResult();
+        nxt::CommandBuffer commands = RecordDraws(device, state, reusable);
+        queue.Submit(1, &commands);
+
+        double best = perf::MeasureBestRun(kRunCount, [&]() { queue.Submit(1, &commands); });
+        return best / 1000.0;
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    nxt::Device device = perf::CreateNullDevice();
+    perf::DrawState state = perf::CreateDrawState(device);
+
+    double oneShot = MeasureResubmit(device, state, false);
+    double reusable = MeasureResubmit(device, state, true);
+
+    printf("Best of %d submits of a command buffer of %u draws, in microseconds per submit:\n",
+           kRunCount, kDrawCount);
+    printf("  One-shot  %.2f\n", oneShot);
+    printf("  Reusable  %.2f\n", reusable);
+
+    return 0;
+}
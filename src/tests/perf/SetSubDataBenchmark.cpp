@@ -0,0 +1,195 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures frames that update many small uniform buffers with SetSubData on the OpenGL backend,
+// and then draw once with each of them, while the previous frames still use them. Use a release
+// build.
+
+#include "utils/BackendBinding.h"
+#include "utils/NXTHelpers.h"
+
+#include <nxt/nxt.h>
+#include <nxt/nxtcpp.h>
+#include "GLFW/glfw3.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kWarmupFrameCount = 5;
+    constexpr int kFrameCount = 50;
+    constexpr uint32_t kUpdatesPerFrame = 1000;
+    constexpr uint32_t kRTSize = 64;
+
+    double Microseconds(Clock::time_point start, Clock::time_point end) {
+        return static_cast<double>(
+                   std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) /
+               1000.0;
+    }
+
+    double Median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    utils::BackendBinding* binding = utils::CreateBinding(utils::BackendType::OpenGL);
+    if (binding == nullptr || !glfwInit()) {
+        return 1;
+    }
+    glfwDefaultWindowHints();
+    binding->SetupGLFWWindowHints();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "SetSubData benchmark", nullptr, nullptr);
+    if (window == nullptr) {
+        return 1;
+    }
+    binding->SetWindow(window);
+
+    nxtProcTable procs;
+    nxtDevice cDevice;
+    binding->GetProcAndDevice(&procs, &cDevice);
+    nxtSetProcs(&procs);
+
+    std::vector<double> updates;
+    std::vector<double> frames;
+    {
+        nxt::Device device = nxt::Device::Acquire(cDevice);
+        nxt::Queue queue = device.CreateQueueBuilder().GetResult();
+
+        nxt::Texture renderTarget = device.CreateTextureBuilder()
+                                        .SetDimension(nxt::TextureDimension::e2D)
+                                        .SetExtent(kRTSize, kRTSize, 1)
+                                        .SetFormat(nxt::TextureFormat::R8G8B8A8Unorm)
+                                        .SetMipLevels(1)
+                                        .SetAllowedUsage(nxt::TextureUsageBit::OutputAttachment)
+                                        .GetResult();
+        renderTarget.FreezeUsage(nxt::TextureUsageBit::OutputAttachment);
+        nxt::RenderPass renderPass = device.CreateRenderPassBuilder()
+                                         .SetAttachmentCount(1)
+                                         .AttachmentSetFormat(0, nxt::TextureFormat::R8G8B8A8Unorm)
+                                         .SetSubpassCount(1)
+                                         .SubpassSetColorAttachment(0, 0, 0)
+                                         .GetResult();
+        nxt::Framebuffer framebuffer =
+            device.CreateFramebufferBuilder()
+                .SetRenderPass(renderPass)
+                .SetAttachment(0, renderTarget.CreateTextureViewBuilder().GetResult())
+                .SetDimensions(kRTSize, kRTSize)
+                .GetResult();
+
+        nxt::BindGroupLayout bindGroupLayout =
+            device.CreateBindGroupLayoutBuilder()
+                .SetBindingsType(nxt::ShaderStageBit::Fragment, nxt::BindingType::UniformBuffer, 0,
+                                 1)
+                .GetResult();
+        nxt::ShaderModule vsModule =
+            utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                void main() {
+                    const vec2 pos[3] = vec2[3](vec2(-1.f, -1.f), vec2(3.f, -1.f), vec2(-1.f, 3.f));
+                    gl_Position = vec4(pos[gl_VertexIndex], 0.f, 1.f);
+                })");
+        nxt::ShaderModule fsModule =
+            utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(set = 0, binding = 0) uniform ColorBlock {
+                    vec4 color;
+                } colorBlock;
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = colorBlock.color;
+                })");
+        nxt::RenderPipeline pipeline =
+            device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderPass, 0)
+                .SetLayout(device.CreatePipelineLayoutBuilder()
+                               .SetBindGroupLayout(0, bindGroupLayout)
+                               .GetResult())
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .GetResult();
+
+        // One small uniform buffer per draw, like per-object constants.
+        std::vector<nxt::Buffer> buffers;
+        std::vector<nxt::BindGroup> bindGroups;
+        for (uint32_t i = 0; i < kUpdatesPerFrame; ++i) {
+            nxt::Buffer buffer = device.CreateBufferBuilder()
+                                     .SetSize(4 * sizeof(float))
+                                     .SetAllowedUsage(nxt::BufferUsageBit::Uniform |
+                                                      nxt::BufferUsageBit::TransferDst)
+                                     .SetInitialUsage(nxt::BufferUsageBit::TransferDst)
+                                     .GetResult();
+            nxt::BufferView view =
+                buffer.CreateBufferViewBuilder().SetExtent(0, 4 * sizeof(float)).GetResult();
+            bindGroups.push_back(device.CreateBindGroupBuilder()
+                                     .SetLayout(bindGroupLayout)
+                                     .SetUsage(nxt::BindGroupUsage::Frozen)
+                                     .SetBufferViews(0, 1, &view)
+                                     .GetResult());
+            buffers.push_back(std::move(buffer));
+        }
+
+        for (int frame = 0; frame < kWarmupFrameCount + kFrameCount; ++frame) {
+            Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < kUpdatesPerFrame; ++i) {
+                float color[4] = {static_cast<float>(frame % 2), static_cast<float>(i % 2), 0.0f,
+                                  1.0f};
+                buffers[i].TransitionUsage(nxt::BufferUsageBit::TransferDst);
+                buffers[i].SetSubData(0, 4, reinterpret_cast<const uint32_t*>(color));
+            }
+            Clock::time_point updated = Clock::now();
+
+            nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+            for (uint32_t i = 0; i < kUpdatesPerFrame; ++i) {
+                builder.TransitionBufferUsage(buffers[i], nxt::BufferUsageBit::Uniform);
+            }
+            builder.BeginRenderPass(renderPass, framebuffer)
+                .BeginRenderSubpass()
+                .SetRenderPipeline(pipeline);
+            for (uint32_t i = 0; i < kUpdatesPerFrame; ++i) {
+                builder.SetBindGroup(0, bindGroups[i], 0, nullptr).DrawArrays(3, 1, 0, 0);
+            }
+            nxt::CommandBuffer commands =
+                builder.EndRenderSubpass().EndRenderPass().GetResult();
+            queue.Submit(1, &commands);
+            device.Tick();
+            Clock::time_point end = Clock::now();
+
+            if (frame >= kWarmupFrameCount) {
+                updates.push_back(Microseconds(start, updated));
+                frames.push_back(Microseconds(start, end));
+            }
+        }
+    }
+
+    printf("Median of %d frames of %u SetSubData of 16 bytes and %u draws, in microseconds:\n",
+           kFrameCount, kUpdatesPerFrame, kUpdatesPerFrame);
+    printf("  SetSubData calls  %8.1f\n", Median(updates));
+    printf("  Whole frame       %8.1f\n", Median(frames));
+
+    delete binding;
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures creating and releasing objects with the wire client, without a server so that only the
+// client side is measured: frames that each create and release buffer builders and buffers. Use a
+// release build.
+
+#include "tests/perf/BenchmarkUtils.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/Wire.h"
+
+#include <nxt/nxtcpp.h>
+
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+    constexpr int kRunCount = 200;
+    constexpr uint32_t kObjectsPerFrame = 2000;
+
+    // Accepts commands without doing anything with them.
+    class NullHandler : public nxt::wire::CommandHandler {
+      public:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+            return commands + size;
+        }
+    };
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    NullHandler sink;
+    nxt::wire::ChunkedCommandSerializer serializer(&sink);
+
+    nxtProcTable procs;
+    nxtDevice cDevice;
+    std::unique_ptr<nxt::wire::CommandHandler> client(
+        nxt::wire::NewClientDevice(&procs, &cDevice, &serializer));
+    nxtSetProcs(&procs);
+
+    double best = 0.0;
+    {
+        nxt::Device device = nxt::Device::Acquire(cDevice);
+
+        // Each iteration creates a buffer builder and a buffer and releases both.
+        best = perf::MeasureBestRun(kRunCount, [&]() {
+            for (uint32_t i = 0; i < kObjectsPerFrame; ++i) {
+                nxt::Buffer buffer = device.CreateBufferBuilder()
+                                         .SetSize(256)
+                                         .SetAllowedUsage(nxt::BufferUsageBit::Uniform)
+                                         .GetResult();
+            }
+            serializer.Flush();
+        });
+    }
+
+    printf("Best of %d frames of %u buffer builders and buffers created and released:\n",
+           kRunCount, kObjectsPerFrame);
+    printf("  %.1f ns per builder and buffer pair\n", best / kObjectsPerFrame);
+
+    return 0;
+}
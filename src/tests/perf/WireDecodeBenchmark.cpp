@@ -0,0 +1,208 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures how fast the wire server decodes commands, by replaying frames recorded by the wire
+// client into a server whose proc table does nothing, so that only the wire layer is measured.
+// Use a release build.
+
+#include "common/Assert.h"
+#include "tests/perf/BenchmarkUtils.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/Wire.h"
+
+#include <nxt/nxtcpp.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+    constexpr int kRunCount = 1500;
+    constexpr uint32_t kIterationsPerFrame = 1000;
+    constexpr uint32_t kCommandBuffersPerSubmit = 8;
+
+    // The procs of the no-op table return the same fake object for all the objects they create.
+    int sFakeObject;
+
+    template <typename R>
+    struct NoopResult {
+        static R Get() {
+            return reinterpret_cast<R>(&sFakeObject);
+        }
+    };
+
+    template <>
+    struct NoopResult<void> {
+        static void Get() {
+        }
+    };
+
+    template <typename R, typename... Args>
+    R Noop(Args...) {
+        return NoopResult<R>::Get();
+    }
+
+    // Only the procs used by the frames below are set, the others are null so that using them
+    // crashes instead of measuring something else.
+    nxtProcTable GetNoopProcs() {
+        nxtProcTable procs;
+        memset(&procs, 0, sizeof(procs));
+        procs.deviceSetErrorCallback = Noop;
+        procs.deviceTick = Noop;
+        procs.deviceCreateBufferBuilder = Noop;
+        procs.deviceCreateCommandBufferBuilder = Noop;
+        procs.deviceCreateQueueBuilder = Noop;
+        procs.bufferBuilderSetAllowedUsage = Noop;
+        procs.bufferBuilderSetSize = Noop;
+        procs.bufferBuilderSetErrorCallback = Noop;
+        procs.bufferBuilderGetResult = Noop;
+        procs.bufferBuilderRelease = Noop;
+        procs.bufferSetSubData = Noop;
+        procs.bufferRelease = Noop;
+        procs.commandBufferBuilderSetErrorCallback = Noop;
+        procs.commandBufferBuilderGetResult = Noop;
+        procs.commandBufferBuilderRelease = Noop;
+        procs.commandBufferRelease = Noop;
+        procs.queueBuilderSetErrorCallback = Noop;
+        procs.queueBuilderGetResult = Noop;
+        procs.queueBuilderRelease = Noop;
+        procs.queueSubmit = Noop;
+        return procs;
+    }
+
+    // Keeps a copy of all the commands it is given.
+    class RecordingHandler : public nxt::wire::CommandHandler {
+      public:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+            data.insert(data.end(), commands, commands + size);
+            return commands + size;
+        }
+
+        std::vector<uint8_t> data;
+    };
+
+    // Counts the commands the client records, each of them asks for space once.
+    class CountingSerializer : public nxt::wire::CommandSerializer {
+      public:
+        CountingSerializer(nxt::wire::CommandSerializer* serializer) : mSerializer(serializer) {
+        }
+
+        void* GetCmdSpace(size_t size) override {
+            commandCount++;
+            return mSerializer->GetCmdSpace(size);
+        }
+
+        void Flush() override {
+            mSerializer->Flush();
+        }
+
+        size_t commandCount = 0;
+
+      private:
+        nxt::wire::CommandSerializer* mSerializer;
+    };
+
+    struct Frame {
+        std::vector<uint8_t> setup;
+        std::vector<uint8_t> commands;
+        size_t commandCount;
+    };
+
+    // Records a frame with the wire client. The frame releases all the objects it creates, so
+    // that it can be replayed any number of times.
+    template <typename F>
+    Frame RecordFrame(F recordFrame) {
+        RecordingHandler recorder;
+        nxt::wire::ChunkedCommandSerializer chunks(&recorder);
+        CountingSerializer serializer(&chunks);
+
+        nxtProcTable procs;
+        nxtDevice cDevice;
+        std::unique_ptr<nxt::wire::CommandHandler> client(
+            nxt::wire::NewClientDevice(&procs, &cDevice, &serializer));
+        nxtSetProcs(&procs);
+
+        Frame frame;
+        nxt::Device device = nxt::Device::Acquire(cDevice);
+        nxt::Queue queue = device.CreateQueueBuilder().GetResult();
+        serializer.Flush();
+        frame.setup = std::move(recorder.data);
+        recorder.data.clear();
+
+        serializer.commandCount = 0;
+        recordFrame(device, queue);
+        serializer.Flush();
+        frame.commands = std::move(recorder.data);
+        frame.commandCount = serializer.commandCount;
+
+        return frame;
+    }
+
+    void CreateBuffers(const nxt::Device& device, const nxt::Queue&) {
+        uint32_t data[4] = {1, 2, 3, 4};
+        for (uint32_t i = 0; i < kIterationsPerFrame; ++i) {
+            nxt::Buffer buffer = device.CreateBufferBuilder()
+                                     .SetSize(sizeof(data))
+                                     .SetAllowedUsage(nxt::BufferUsageBit::TransferDst)
+                                     .GetResult();
+            buffer.SetSubData(0, 4, data);
+        }
+    }
+
+    void CreateBuffersAndSubmit(const nxt::Device& device, const nxt::Queue& queue) {
+        CreateBuffers(device, queue);
+        for (uint32_t i = 0; i < kIterationsPerFrame / kCommandBuffersPerSubmit; ++i) {
+            nxt::CommandBuffer commands[kCommandBuffersPerSubmit];
+            for (uint32_t j = 0; j < kCommandBuffersPerSubmit; ++j) {
+                commands[j] = device.CreateCommandBufferBuilder().GetResult();
+            }
+            queue.Submit(kCommandBuffersPerSubmit, commands);
+        }
+    }
+
+    // Returns the best time per command, in nanoseconds, of the server decoding the frame.
+    double MeasureDecode(const Frame& frame) {
+        RecordingHandler returnRecorder;
+        nxt::wire::ChunkedCommandSerializer returnCommands(&returnRecorder);
+        nxtProcTable procs = GetNoopProcs();
+        std::unique_ptr<nxt::wire::CommandHandler> server(nxt::wire::NewServerCommandHandler(
+            reinterpret_cast<nxtDevice>(&sFakeObject), procs, &returnCommands));
+
+        server->HandleCommands(frame.setup.data(), frame.setup.size());
+        double best = perf::MeasureBestRun(kRunCount, [&]() {
+            const uint8_t* end =
+                server->HandleCommands(frame.commands.data(), frame.commands.size());
+            ASSERT(end != nullptr);
+        });
+
+        return best / frame.commandCount;
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    Frame buffers = RecordFrame(CreateBuffers);
+    Frame buffersAndSubmits = RecordFrame(CreateBuffersAndSubmit);
+
+    printf("Best of %d frames decoded by the server with a no-op proc table:\n", kRunCount);
+    printf("  Buffer create, SetSubData and release     %zu commands  %.2f ns/command\n",
+           buffers.commandCount, MeasureDecode(buffers));
+    printf("  Also submitting %u command buffers at once  %zu commands  %.2f ns/command\n",
+           kCommandBuffersPerSubmit, buffersAndSubmits.commandCount,
+           MeasureDecode(buffersAndSubmits));
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the server CPU time of a frame of SetPushConstants and DrawArrays recorded by the wire
+// client, when the server uses the null backend's validating procs and when it uses the procs that
+// trust the client to have checked enums and bitmasks. Use a release build.
+
+#include "common/Assert.h"
+#include "tests/perf/BenchmarkUtils.h"
+#include "tests/perf/DrawBenchmarkUtils.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/Wire.h"
+
+#include <nxt/nxtcpp.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace backend { namespace null {
+    void Init(nxtProcTable* procs, nxtDevice* device);
+    nxtProcTable GetClientValidatedProcs();
+}}  // namespace backend::null
+
+namespace {
+
+    constexpr int kRunCount = 200;
+    constexpr uint32_t kDrawCount = 10000;
+
+    // Keeps a copy of all the commands it is given.
+    class RecordingHandler : public nxt::wire::CommandHandler {
+      public:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+            data.insert(data.end(), commands, commands + size);
+            return commands + size;
+        }
+
+        std::vector<uint8_t> data;
+    };
+
+    struct Streams {
+        std::vector<uint8_t> setup;
+        std::vector<uint8_t> frame;
+    };
+
+    // Records the commands creating the objects used by the frame, and the commands of a frame
+    // that releases everything it creates so that it can be replayed any number of times.
+    Streams RecordStreams() {
+        RecordingHandler recorder;
+        nxt::wire::ChunkedCommandSerializer serializer(&recorder);
+
+        nxtProcTable procs;
+        nxtDevice cDevice;
+        std::unique_ptr<nxt::wire::CommandHandler> client(
+            nxt::wire::NewClientDevice(&procs, &cDevice, &serializer));
+        nxtSetProcs(&procs);
+
+        Streams streams;
+        nxt::Device device = nxt::Device::Acquire(cDevice);
+        perf::DrawState state = perf::CreateDrawState(device);
+        serializer.Flush();
+        streams.setup = std::move(recorder.data);
+        recorder.data.clear();
+
+        {
+            nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+            builder.BeginRenderPass(state.renderPass, state.framebuffer)
+                .BeginRenderSubpass()
+                .SetRenderPipeline(state.pipeline);
+            for (uint32_t i = 0; i < kDrawCount; ++i) {
+                uint32_t constants[4] = {i, i, i, i};
+                builder.SetPushConstants(nxt::ShaderStageBit::Fragment, 0, 4, constants)
+                    .DrawArrays(3, 1, 0, 0);
+            }
+            builder.EndRenderSubpass().EndRenderPass().GetResult();
+        }
+        serializer.Flush();
+        streams.frame = std::move(recorder.data);
+
+        return streams;
+    }
+
+    // Returns the best time per draw, in nanoseconds, of the server handling the frame.
+    double MeasureServer(const Streams& streams, const nxtProcTable& procs, nxtDevice device) {
+        // The return commands are the builders' callbacks, they aren't needed.
+        RecordingHandler returnRecorder;
+        nxt::wire::ChunkedCommandSerializer returnCommands(&returnRecorder);
+        std::unique_ptr<nxt::wire::CommandHandler> server(
+            nxt::wire::NewServerCommandHandler(device, procs, &returnCommands));
+
+        server->HandleCommands(streams.setup.data(), streams.setup.size());
+        double best = perf::MeasureBestRun(kRunCount, [&]() {
+            const uint8_t* end = server->HandleCommands(streams.frame.data(), streams.frame.size());
+            ASSERT(end != nullptr);
+        });
+        returnCommands.Flush();
+
+        return best / kDrawCount;
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    Streams streams = RecordStreams();
+
+    nxtProcTable validatingProcs;
+    nxtDevice validatingDevice;
+    backend::null::Init(&validatingProcs, &validatingDevice);
+    double validating = MeasureServer(streams, validatingProcs, validatingDevice);
+
+    nxtProcTable unusedProcs;
+    nxtDevice clientValidatedDevice;
+    backend::null::Init(&unusedProcs, &clientValidatedDevice);
+    double clientValidated = MeasureServer(streams, backend::null::GetClientValidatedProcs(),
+                                           clientValidatedDevice);
+
+    printf("Best of %d frames of %u draws handled by the server, in ns per SetPushConstants and "
+           "DrawArrays pair:\n",
+           kRunCount, kDrawCount);
+    printf("  Validating procs        %.2f\n", validating);
+    printf("  Client-validated procs  %.2f\n", clientValidated);
+
+    return 0;
+}
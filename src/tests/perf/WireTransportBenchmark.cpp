@@ -0,0 +1,269 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the wire between a client and a server on the null backend, in a single process with
+// ChunkedCommandSerializers and in two processes with a SharedMemoryTransport:
+//  - the latency of a round trip, a MapReadAsync until its callback is called,
+//  - the throughput of frames of SetPushConstants and DrawArrays, like Animometer.
+// Only runs on Linux, where the SharedMemoryTransport is implemented. Use a release build.
+
+#include "common/Assert.h"
+#include "tests/perf/BenchmarkUtils.h"
+#include "tests/perf/DrawBenchmarkUtils.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/SharedMemoryTransport.h"
+#include "wire/Wire.h"
+
+#include <nxt/nxtcpp.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace backend { namespace null {
+    void Init(nxtProcTable* procs, nxtDevice* device);
+}}  // namespace backend::null
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kRoundTripCount = 2000;
+    constexpr int kRunCount = 20;
+    constexpr int kFramesPerRun = 10;
+    constexpr uint32_t kDrawCount = 10000;
+    constexpr size_t kRingCapacity = 4 * 1024 * 1024;
+
+    // How the client's commands get to the server and its return commands come back.
+    class Connection {
+      public:
+        virtual ~Connection() = default;
+
+        virtual nxt::wire::CommandSerializer* GetCommandSerializer() = 0;
+        // Flushes the client's commands and handles return commands until done is set by one of
+        // the client's callbacks.
+        virtual void FlushUntil(const bool* done) = 0;
+
+        void SetClient(nxt::wire::CommandHandler* client) {
+            mClient = client;
+        }
+
+      protected:
+        nxt::wire::CommandHandler* mClient = nullptr;
+    };
+
+    // The server runs in the same process and handles the commands during the client's Flush.
+    class InProcessConnection : public Connection {
+      public:
+        InProcessConnection() {
+            nxtProcTable procs;
+            nxtDevice device;
+            backend::null::Init(&procs, &device);
+            mServer.reset(nxt::wire::NewServerCommandHandler(device, procs, &mReturnCommands));
+            mCommands.SetHandler(mServer.get());
+        }
+
+        nxt::wire::CommandSerializer* GetCommandSerializer() override {
+            return &mCommands;
+        }
+
+        void FlushUntil(const bool* done) override {
+            mReturnCommands.SetHandler(mClient);
+            mCommands.Flush();
+            mReturnCommands.Flush();
+            ASSERT(*done);
+        }
+
+      private:
+        nxt::wire::ChunkedCommandSerializer mCommands;
+        nxt::wire::ChunkedCommandSerializer mReturnCommands;
+        std::unique_ptr<nxt::wire::CommandHandler> mServer;
+    };
+
+    // Runs the server in a child process that opens the transport's memory again.
+    void ServerProcessMain(int fd) {
+        std::unique_ptr<nxt::wire::SharedMemoryTransport> transport =
+            nxt::wire::SharedMemoryTransport::Open(fd);
+        ASSERT(transport != nullptr);
+        nxt::wire::SharedMemoryRing* commands = transport->GetClientToServerRing();
+        nxt::wire::SharedMemoryRingSerializer returnCommands(transport->GetServerToClientRing());
+
+        nxtProcTable procs;
+        nxtDevice device;
+        backend::null::Init(&procs, &device);
+        std::unique_ptr<nxt::wire::CommandHandler> server(
+            nxt::wire::NewServerCommandHandler(device, procs, &returnCommands));
+
+        while (!commands->IsClosed()) {
+            if (!commands->WaitForMessages(100)) {
+                continue;
+            }
+            if (!commands->HandleMessages(server.get())) {
+                break;
+            }
+            returnCommands.Flush();
+        }
+    }
+
+    class TwoProcessConnection : public Connection {
+      public:
+        TwoProcessConnection() {
+            mTransport = nxt::wire::SharedMemoryTransport::Create(kRingCapacity);
+            ASSERT(mTransport != nullptr);
+            mCommands.reset(
+                new nxt::wire::SharedMemoryRingSerializer(mTransport->GetClientToServerRing()));
+
+            mServerPid = fork();
+            ASSERT(mServerPid >= 0);
+            if (mServerPid == 0) {
+                ServerProcessMain(dup(mTransport->GetFd()));
+                _exit(0);
+            }
+        }
+
+        ~TwoProcessConnection() {
+            mTransport->GetClientToServerRing()->Close();
+            waitpid(mServerPid, nullptr, 0);
+        }
+
+        nxt::wire::CommandSerializer* GetCommandSerializer() override {
+            return mCommands.get();
+        }
+
+        void FlushUntil(const bool* done) override {
+            mCommands->Flush();
+            nxt::wire::SharedMemoryRing* returnCommands = mTransport->GetServerToClientRing();
+            while (!*done) {
+                if (returnCommands->WaitForMessages(1000)) {
+                    returnCommands->HandleMessages(mClient);
+                }
+            }
+        }
+
+      private:
+        std::unique_ptr<nxt::wire::SharedMemoryTransport> mTransport;
+        std::unique_ptr<nxt::wire::SharedMemoryRingSerializer> mCommands;
+        pid_t mServerPid = 0;
+    };
+
+    void MapReadCallback(nxtBufferMapReadStatus status,
+                         const void*,
+                         nxtCallbackUserdata userdata) {
+        ASSERT(status == NXT_BUFFER_MAP_READ_STATUS_SUCCESS);
+        *reinterpret_cast<bool*>(static_cast<uintptr_t>(userdata)) = true;
+    }
+
+    // Maps the buffer and waits for the callback, which needs the server to have handled all the
+    // commands sent before.
+    void RoundTrip(Connection* connection, const nxt::Queue& queue, const nxt::Buffer& buffer) {
+        bool mapped = false;
+        buffer.MapReadAsync(
+            0, 4, MapReadCallback,
+            static_cast<nxtCallbackUserdata>(reinterpret_cast<uintptr_t>(&mapped)));
+        queue.Submit(0, nullptr);
+        connection->FlushUntil(&mapped);
+        buffer.Unmap();
+    }
+
+    struct Results {
+        double medianRoundTrip;
+        double bestFrame;
+    };
+
+    Results Measure(Connection* connection) {
+        nxtProcTable procs;
+        nxtDevice cDevice;
+        std::unique_ptr<nxt::wire::CommandHandler> client(
+            nxt::wire::NewClientDevice(&procs, &cDevice, connection->GetCommandSerializer()));
+        connection->SetClient(client.get());
+        nxtSetProcs(&procs);
+
+        Results results;
+        {
+            nxt::Device device = nxt::Device::Acquire(cDevice);
+            nxt::Queue queue = device.CreateQueueBuilder().GetResult();
+            nxt::Buffer buffer = device.CreateBufferBuilder()
+                                     .SetSize(4)
+                                     .SetAllowedUsage(nxt::BufferUsageBit::MapRead)
+                                     .SetInitialUsage(nxt::BufferUsageBit::MapRead)
+                                     .GetResult();
+            perf::DrawState state = perf::CreateDrawState(device);
+
+            std::vector<double> roundTrips;
+            for (int i = 0; i < kRoundTripCount; ++i) {
+                Clock::time_point start = Clock::now();
+                RoundTrip(connection, queue, buffer);
+                Clock::time_point end = Clock::now();
+                roundTrips.push_back(static_cast<double>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+            }
+            std::sort(roundTrips.begin(), roundTrips.end());
+            results.medianRoundTrip = roundTrips[roundTrips.size() / 2] / 1000.0;
+
+            // Frames are flushed without waiting for the server, which can then decode a frame
+            // while the client records the next one. The round trip at the end waits for the
+            // server to have handled all of them.
+            double best = perf::MeasureBestRun(kRunCount, [&]() {
+                for (int frame = 0; frame < kFramesPerRun; ++frame) {
+                    nxt::CommandBufferBuilder builder = device.CreateCommandBufferBuilder();
+                    builder.BeginRenderPass(state.renderPass, state.framebuffer)
+                        .BeginRenderSubpass()
+                        .SetRenderPipeline(state.pipeline);
+                    for (uint32_t i = 0; i < kDrawCount; ++i) {
+                        uint32_t constants[4] = {i, i, i, i};
+                        builder.SetPushConstants(nxt::ShaderStageBit::Fragment, 0, 4, constants)
+                            .DrawArrays(3, 1, 0, 0);
+                    }
+                    nxt::CommandBuffer commands =
+                        builder.EndRenderSubpass().EndRenderPass().GetResult();
+                    queue.Submit(1, &commands);
+                    connection->GetCommandSerializer()->Flush();
+                }
+                RoundTrip(connection, queue, buffer);
+            });
+            results.bestFrame = best / kFramesPerRun / 1000.0;
+        }
+
+        return results;
+    }
+
+}  // anonymous namespace
+
+int main(int, const char**) {
+    Results inProcess;
+    {
+        InProcessConnection connection;
+        inProcess = Measure(&connection);
+    }
+    Results twoProcesses;
+    {
+        TwoProcessConnection connection;
+        twoProcesses = Measure(&connection);
+    }
+
+    printf("Wire client and null backend server, in microseconds:\n");
+    printf("                 round trip (median of %d)  frame of %u draws (best of %d)\n",
+           kRoundTripCount, kDrawCount, kRunCount);
+    printf("  In-process     %8.2f                    %8.1f\n", inProcess.medianRoundTrip,
+           inProcess.bestFrame);
+    printf("  Two processes  %8.2f                    %8.1f\n", twoProcesses.medianRoundTrip,
+           twoProcesses.bestFrame);
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "common/BuddyAllocator.h"
+
+#include <vector>
+
+// Test that a new allocator has the whole space free
+TEST(BuddyAllocator, Empty) {
+    BuddyAllocator allocator(1024, 16);
+
+    EXPECT_EQ(allocator.GetSize(), 1024u);
+    EXPECT_EQ(allocator.GetUsedSize(), 0u);
+    EXPECT_EQ(allocator.GetFreeSize(), 1024u);
+    EXPECT_EQ(allocator.GetLargestFreeBlockSize(), 1024u);
+    EXPECT_EQ(allocator.GetAllocationCount(), 0u);
+}
+
+// Test allocating the whole space, then failing to allocate more
+TEST(BuddyAllocator, WholeSpace) {
+    BuddyAllocator allocator(1024, 16);
+
+    uint64_t offset = allocator.Allocate(1024);
+    EXPECT_EQ(offset, 0u);
+    EXPECT_EQ(allocator.GetFreeSize(), 0u);
+    EXPECT_EQ(allocator.GetLargestFreeBlockSize(), 0u);
+
+    EXPECT_EQ(allocator.Allocate(16), BuddyAllocator::kInvalidOffset);
+
+    allocator.Deallocate(offset);
+    EXPECT_EQ(allocator.GetLargestFreeBlockSize(), 1024u);
+}
+
+// Test that allocations bigger than the space fail
+TEST(BuddyAllocator, TooBig) {
+    BuddyAllocator allocator(1024, 16);
+
+    EXPECT_EQ(allocator.Allocate(1025), BuddyAllocator::kInvalidOffset);
+    EXPECT_EQ(allocator.Allocate(16, 2048), BuddyAllocator::kInvalidOffset);
+    EXPECT_EQ(allocator.GetAllocationCount(), 0u);
+}
+
+// Test that alignments bigger than the space fail without changing the allocator
+TEST(BuddyAllocator, AlignmentBiggerThanSize) {
+    BuddyAllocator allocator(32, 16);
+
+    EXPECT_EQ(allocator.GetBlockSizeFor(8, 64), 64u);
+    EXPECT_EQ(allocator.Allocate(8, 64), BuddyAllocator::kInvalidOffset);
+    EXPECT_EQ(allocator.Allocate(8, uint64_t(1) << 63), BuddyAllocator::kInvalidOffset);
+    EXPECT_EQ(allocator.Allocate(uint64_t(1) << 63), BuddyAllocator::kInvalidOffset);
+    EXPECT_EQ(allocator.GetAllocationCount(), 0u);
+    EXPECT_EQ(allocator.GetLargestFreeBlockSize(), 32u);
+
+    // The allocator is still usable for allocations that fit
+    EXPECT_EQ(allocator.Allocate(8, 32), 0u);
+    EXPECT_EQ(allocator.GetUsedSize(), 32u);
+}
+
+// Test that sizes are rounded up to the block size and to the alignment
+TEST(BuddyAllocator, BlockSize) {
+    BuddyAllocator allocator(1024, 16);
+
+    EXPECT_EQ(allocator.GetBlockSizeFor(0), 16u);
+    EXPECT_EQ(allocator.GetBlockSizeFor(1), 16u);
+    EXPECT_EQ(allocator.GetBlockSizeFor(17), 32u);
+    EXPECT_EQ(allocator.GetBlockSizeFor(64), 64u);
+    EXPECT_EQ(allocator.GetBlockSizeFor(3, 256), 256u);
+}
+
+// Test that small allocations are packed at the start and aligned to their size
+TEST(BuddyAllocator, PackedAndAligned) {
+    BuddyAllocator allocator(1024, 16);
+
+    EXPECT_EQ(allocator.Allocate(16), 0u);
+    EXPECT_EQ(allocator.Allocate(16), 16u);
+    EXPECT_EQ(allocator.Allocate(32), 32u);
+    EXPECT_EQ(allocator.Allocate(20), 64u);
+    EXPECT_EQ(allocator.Allocate(8, 128), 128u);
+
+    EXPECT_EQ(allocator.GetAllocationCount(), 5u);
+    EXPECT_EQ(allocator.GetUsedSize(), 16u + 16u + 32u + 32u + 128u);
+}
+
+// Test that freed blocks are merged with their buddies
+TEST(BuddyAllocator, Merging) {
+    BuddyAllocator allocator(1024, 16);
+
+    std::vector<uint64_t> offsets;
+    for (uint32_t i = 0; i < 64; ++i) {
+        uint64_t offset = allocator.Allocate(16);
+        ASSERT_NE(offset, BuddyAllocator::kInvalidOffset);
+        offsets.push_back(offset);
+    }
+    EXPECT_EQ(allocator.Allocate(16), BuddyAllocator::kInvalidOffset);
+
+    // Free every other block, the space is fragmented and no big block is available
+    for (uint32_t i = 0; i < 64; i += 2) {
+        allocator.Deallocate(offsets[i]);
+    }
+    EXPECT_EQ(allocator.GetFreeSize(), 512u);
+    EXPECT_EQ(allocator.GetLargestFreeBlockSize(), 16u);
+    EXPECT_EQ(allocator.Allocate(32), BuddyAllocator::kInvalidOffset);
+
+    // Free the rest, everything merges back into a single block
+    for (uint32_t i = 1; i < 64; i += 2) {
+        allocator.Deallocate(offsets[i]);
+    }
+    EXPECT_EQ(allocator.GetFreeSize(), 1024u);
+    EXPECT_EQ(allocator.GetLargestFreeBlockSize(), 1024u);
+    EXPECT_EQ(allocator.Allocate(1024), 0u);
+}
+
+// Test that freed space is reused
+TEST(BuddyAllocator, Reuse) {
+    BuddyAllocator allocator(256, 16);
+
+    uint64_t a = allocator.Allocate(64);
+    uint64_t b = allocator.Allocate(64);
+    uint64_t c = allocator.Allocate(128);
+    EXPECT_EQ(allocator.Allocate(16), BuddyAllocator::kInvalidOffset);
+
+    allocator.Deallocate(b);
+    EXPECT_EQ(allocator.Allocate(32), b);
+    EXPECT_EQ(allocator.Allocate(32), b + 32);
+
+    allocator.Deallocate(a);
+    allocator.Deallocate(c);
+    EXPECT_EQ(allocator.GetLargestFreeBlockSize(), 128u);
+}
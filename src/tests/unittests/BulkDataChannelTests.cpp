@@ -0,0 +1,120 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "common/Math.h"
+#include "wire/BulkDataChannel.h"
+
+#include <memory>
+
+using namespace nxt::wire;
+
+class BulkDataChannelTests : public testing::Test {
+  protected:
+    static constexpr size_t kUploadSize = 1024;
+    static constexpr size_t kReadbackSize = 512;
+
+    void SetUp() override {
+        size_t size = BulkDataChannel::GetRequiredMemorySize(kUploadSize, kReadbackSize);
+        mStorage.reset(new uint8_t[size + 64]);
+        void* memory = AlignPtr(mStorage.get(), 64);
+        BulkDataChannel::Initialize(memory);
+
+        client.reset(new BulkDataChannel(memory, kUploadSize, kReadbackSize,
+                                         BulkDataChannel::Side::Client));
+        server.reset(new BulkDataChannel(memory, kUploadSize, kReadbackSize,
+                                         BulkDataChannel::Side::Server));
+    }
+
+    std::unique_ptr<BulkDataChannel> client;
+    std::unique_ptr<BulkDataChannel> server;
+
+  private:
+    std::unique_ptr<uint8_t[]> mStorage;
+};
+
+// Test that data written by one side is seen by the other side
+TEST_F(BulkDataChannelTests, Basic) {
+    uint32_t serial = 0;
+    uint32_t offset = 0;
+    uint8_t* upload = client->Allocate(4, &serial, &offset);
+    ASSERT_NE(upload, nullptr);
+    upload[0] = 42;
+
+    const uint8_t* received = server->Receive(serial, offset, 4);
+    ASSERT_EQ(received, upload);
+    EXPECT_EQ(received[0], 42u);
+    server->Release(serial);
+
+    uint8_t* readback = server->Allocate(4, &serial, &offset);
+    ASSERT_NE(readback, nullptr);
+    EXPECT_NE(readback, upload);
+    EXPECT_EQ(client->Receive(serial, offset, 4), readback);
+    client->Release(serial);
+}
+
+// Test that the space is reused only once the other side released it
+TEST_F(BulkDataChannelTests, ReuseAfterRelease) {
+    uint32_t serial0, offset0, serial1, offset1, serial;
+    ASSERT_NE(client->Allocate(512, &serial0, &offset0), nullptr);
+    ASSERT_NE(client->Allocate(512, &serial1, &offset1), nullptr);
+    EXPECT_EQ(client->Allocate(512, &serial, &offset0), nullptr);
+
+    ASSERT_NE(server->Receive(serial0, offset0, 512), nullptr);
+    ASSERT_NE(server->Receive(serial1, offset1, 512), nullptr);
+    EXPECT_EQ(client->Allocate(512, &serial, &offset0), nullptr);
+
+    server->Release(serial0);
+    EXPECT_NE(client->Allocate(512, &serial, &offset0), nullptr);
+}
+
+// Test that releases out of order are only published once all the previous serials are released
+TEST_F(BulkDataChannelTests, ReleaseOutOfOrder) {
+    uint32_t serials[2];
+    uint32_t offsets[2];
+    uint32_t serial, offset;
+    for (uint32_t i = 0; i < 2; ++i) {
+        ASSERT_NE(server->Allocate(256, &serials[i], &offsets[i]), nullptr);
+        ASSERT_NE(client->Receive(serials[i], offsets[i], 256), nullptr);
+    }
+    EXPECT_EQ(server->Allocate(256, &serial, &offset), nullptr);
+
+    client->Release(serials[1]);
+    EXPECT_EQ(server->Allocate(256, &serial, &offset), nullptr);
+
+    client->Release(serials[0]);
+    EXPECT_NE(server->Allocate(512, &serial, &offset), nullptr);
+}
+
+// Test that allocations that can't fit are refused
+TEST_F(BulkDataChannelTests, AllocateTooBig) {
+    uint32_t serial, offset;
+    EXPECT_EQ(client->Allocate(kUploadSize + 1, &serial, &offset), nullptr);
+    EXPECT_EQ(server->Allocate(kReadbackSize + 1, &serial, &offset), nullptr);
+    EXPECT_EQ(client->Allocate(0, &serial, &offset), nullptr);
+}
+
+// Test that Receive rejects serials out of order and ranges out of the region
+TEST_F(BulkDataChannelTests, ReceiveValidation) {
+    uint32_t serial, offset;
+    ASSERT_NE(client->Allocate(16, &serial, &offset), nullptr);
+
+    EXPECT_EQ(server->Receive(serial + 1, offset, 16), nullptr);
+    EXPECT_EQ(server->Receive(serial, kUploadSize - 8, 16), nullptr);
+    EXPECT_EQ(server->Receive(serial, 0xFFFFFFF0u, 32), nullptr);
+
+    ASSERT_NE(server->Receive(serial, offset, 16), nullptr);
+    EXPECT_EQ(server->Receive(serial, offset, 16), nullptr);
+}
@@ -0,0 +1,154 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "wire/ChunkedCommandSerializer.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace nxt::wire;
+
+// A handler that records the size of each call and the bytes it received.
+class RecordingHandler : public CommandHandler {
+  public:
+    const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+        callSizes.push_back(size);
+        data.insert(data.end(), commands, commands + size);
+        return commands + size;
+    }
+
+    std::vector<size_t> callSizes;
+    std::vector<uint8_t> data;
+};
+
+static void RecordCommand(ChunkedCommandSerializer* serializer, size_t size, uint8_t value) {
+    void* space = serializer->GetCmdSpace(size);
+    ASSERT_NE(space, nullptr);
+    memset(space, value, size);
+}
+
+// Test that nothing is handled before Flush and that commands are given in order
+TEST(ChunkedCommandSerializer, HandledOnFlush) {
+    RecordingHandler handler;
+    ChunkedCommandSerializer serializer(&handler, 64);
+
+    RecordCommand(&serializer, 8, 1);
+    RecordCommand(&serializer, 16, 2);
+    EXPECT_TRUE(handler.callSizes.empty());
+
+    serializer.Flush();
+    ASSERT_EQ(handler.callSizes.size(), 1u);
+    EXPECT_EQ(handler.callSizes[0], 24u);
+    EXPECT_EQ(handler.data[0], 1u);
+    EXPECT_EQ(handler.data[8], 2u);
+
+    // Flushing again without commands doesn't call the handler
+    serializer.Flush();
+    EXPECT_EQ(handler.callSizes.size(), 1u);
+}
+
+// Test that a command that doesn't fit in the current chunk starts a new one
+TEST(ChunkedCommandSerializer, CommandsStayContiguous) {
+    RecordingHandler handler;
+    ChunkedCommandSerializer serializer(&handler, 64);
+
+    RecordCommand(&serializer, 40, 1);
+    RecordCommand(&serializer, 40, 2);
+    RecordCommand(&serializer, 24, 3);
+    EXPECT_EQ(serializer.GetPendingChunkCount(), 2u);
+
+    serializer.Flush();
+    ASSERT_EQ(handler.callSizes.size(), 2u);
+    EXPECT_EQ(handler.callSizes[0], 40u);
+    EXPECT_EQ(handler.callSizes[1], 64u);
+    EXPECT_EQ(handler.data[39], 1u);
+    EXPECT_EQ(handler.data[40], 2u);
+    EXPECT_EQ(handler.data[80], 3u);
+}
+
+// Test that commands bigger than the chunk size get a chunk of their own that is freed on Flush
+TEST(ChunkedCommandSerializer, BigCommand) {
+    RecordingHandler handler;
+    ChunkedCommandSerializer serializer(&handler, 64);
+
+    RecordCommand(&serializer, 16, 1);
+    RecordCommand(&serializer, 1000, 2);
+    RecordCommand(&serializer, 16, 3);
+    EXPECT_EQ(serializer.GetAllocatedSize(), 64u + 1000u + 64u);
+
+    serializer.Flush();
+    ASSERT_EQ(handler.callSizes.size(), 3u);
+    EXPECT_EQ(handler.callSizes[1], 1000u);
+    EXPECT_EQ(handler.data[16 + 999], 2u);
+    EXPECT_EQ(serializer.GetAllocatedSize(), 64u + 64u);
+}
+
+// Test that recording the same commands between flushes reuses the chunks
+TEST(ChunkedCommandSerializer, SteadyStateDoesntAllocate) {
+    RecordingHandler handler;
+    ChunkedCommandSerializer serializer(&handler, 64);
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        RecordCommand(&serializer, 48, 1);
+        RecordCommand(&serializer, 48, 2);
+        RecordCommand(&serializer, 48, 3);
+    }
+    serializer.Flush();
+    size_t allocatedSize = serializer.GetAllocatedSize();
+    EXPECT_EQ(allocatedSize, 30u * 64u);
+
+    for (uint32_t frame = 0; frame < 5; ++frame) {
+        for (uint32_t i = 0; i < 10; ++i) {
+            RecordCommand(&serializer, 48, 1);
+            RecordCommand(&serializer, 48, 2);
+            RecordCommand(&serializer, 48, 3);
+        }
+        serializer.Flush();
+        EXPECT_EQ(serializer.GetAllocatedSize(), allocatedSize);
+    }
+}
+
+// A handler that records a command in the serializer that is being flushed.
+class ReentrantHandler : public RecordingHandler {
+  public:
+    const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+        if (serializer != nullptr) {
+            RecordCommand(serializer, 4, 9);
+            serializer = nullptr;
+        }
+        return RecordingHandler::HandleCommands(commands, size);
+    }
+
+    ChunkedCommandSerializer* serializer = nullptr;
+};
+
+// Test that commands recorded by the handler during Flush are handled on the next Flush
+TEST(ChunkedCommandSerializer, RecordDuringFlush) {
+    ReentrantHandler handler;
+    ChunkedCommandSerializer serializer(&handler, 64);
+    handler.serializer = &serializer;
+
+    RecordCommand(&serializer, 8, 1);
+    serializer.Flush();
+    ASSERT_EQ(handler.callSizes.size(), 1u);
+    EXPECT_EQ(handler.callSizes[0], 8u);
+    EXPECT_EQ(serializer.GetPendingChunkCount(), 1u);
+
+    serializer.Flush();
+    ASSERT_EQ(handler.callSizes.size(), 2u);
+    EXPECT_EQ(handler.callSizes[1], 4u);
+    EXPECT_EQ(handler.data[8], 9u);
+}
@@ -0,0 +1,326 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "common/Math.h"
+#include "wire/BulkDataChannel.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/CommandTrace.h"
+#include "wire/TraceReplayer.h"
+#include "wire/WireCmd.h"
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace nxt::wire;
+
+namespace backend { namespace null {
+    void Init(nxtProcTable* procs, nxtDevice* device);
+}}  // namespace backend::null
+
+namespace {
+
+    // A handler that concatenates all the commands it receives.
+    class CommandRecorder : public CommandHandler {
+      public:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+            received.insert(received.end(), commands, commands + size);
+            return commands + size;
+        }
+
+        std::vector<uint8_t> received;
+    };
+
+    void IgnoreMapReadCallback(nxtBufferMapReadStatus, const void*, nxtCallbackUserdata) {
+    }
+
+}  // anonymous namespace
+
+class CommandTraceTests : public testing::Test {
+  protected:
+    void SetUp() override {
+        mFile = tmpfile();
+        ASSERT_NE(mFile, nullptr);
+    }
+
+    void TearDown() override {
+        fclose(mFile);
+    }
+
+    // Reads the trace written so far in 8-byte aligned memory.
+    void ReadTrace() {
+        fflush(mFile);
+        long size = ftell(mFile);
+        mTrace.resize((size + 7) / 8);
+        rewind(mFile);
+        ASSERT_EQ(fread(mTrace.data(), 1, size, mFile), static_cast<size_t>(size));
+        mTraceSize = static_cast<size_t>(size);
+    }
+
+    const uint8_t* GetTrace() const {
+        return reinterpret_cast<const uint8_t*>(mTrace.data());
+    }
+
+    uint8_t* GetMutableTrace() {
+        return reinterpret_cast<uint8_t*>(mTrace.data());
+    }
+
+    template <typename T>
+    void Record(CommandSerializer* serializer, const T& command) {
+        memcpy(serializer->GetCmdSpace(sizeof(command)), &command, sizeof(command));
+    }
+
+    FILE* mFile = nullptr;
+    std::vector<uint64_t> mTrace;
+    size_t mTraceSize = 0;
+};
+
+// Test that commands are forwarded unchanged and recorded with their sizes
+TEST_F(CommandTraceTests, RoundTrip) {
+    CommandRecorder recorder;
+    ChunkedCommandSerializer transport(&recorder);
+    {
+        TraceWriter writer(mFile);
+        TraceCommandSerializer serializer(&transport, &writer, TraceRecordType::Commands);
+
+        for (uint32_t i = 0; i < 10; ++i) {
+            CommandBufferBuilderDrawArraysCmd draw;
+            draw.self = i;
+            draw.vertexCount = 3;
+            draw.instanceCount = 1;
+            draw.firstVertex = 0;
+            draw.firstInstance = 0;
+            Record(&serializer, draw);
+
+            BufferSetSubDataBulkCmd bulk;
+            bulk.bufferId = i;
+            bulk.start = 0;
+            bulk.count = 4;
+            bulk.dataSerial = 0;
+            bulk.dataOffset = 0;
+            Record(&serializer, bulk);
+        }
+        serializer.Flush();
+        ASSERT_FALSE(recorder.received.empty());
+    }
+
+    ReadTrace();
+    TraceReader reader(GetTrace(), mTraceSize);
+    ASSERT_TRUE(reader.IsValid());
+    EXPECT_EQ(reader.GetHeader().bulkDataUploadSize, 0u);
+
+    std::vector<uint8_t> traced;
+    uint32_t commandCount = 0;
+    TraceRecord record;
+    while (reader.Next(&record)) {
+        ASSERT_EQ(record.type, TraceRecordType::Commands);
+        for (uint32_t i = 0; i < record.commandCount; ++i) {
+            size_t expectedSize = sizeof(CommandBufferBuilderDrawArraysCmd);
+            if (commandCount % 2 == 1) {
+                expectedSize = sizeof(BufferSetSubDataBulkCmd);
+            }
+            EXPECT_EQ(record.commandSizes[i], expectedSize);
+            commandCount++;
+        }
+        traced.insert(traced.end(), record.data, record.data + record.size);
+    }
+    EXPECT_TRUE(reader.IsValid());
+    EXPECT_EQ(commandCount, 20u);
+    EXPECT_EQ(traced, recorder.received);
+}
+
+// Test that the data of bulk SetSubData is recorded before the command referencing it
+TEST_F(CommandTraceTests, BulkData) {
+    constexpr size_t kUploadSize = 1024;
+    constexpr size_t kReadbackSize = 512;
+    size_t memorySize = BulkDataChannel::GetRequiredMemorySize(kUploadSize, kReadbackSize);
+    std::unique_ptr<uint8_t[]> storage(new uint8_t[memorySize + 64]);
+    void* memory = AlignPtr(storage.get(), 64);
+    BulkDataChannel::Initialize(memory);
+    BulkDataChannel client(memory, kUploadSize, kReadbackSize, BulkDataChannel::Side::Client);
+
+    CommandRecorder recorder;
+    ChunkedCommandSerializer transport(&recorder);
+    {
+        TraceWriter writer(mFile, kUploadSize, kReadbackSize);
+        TraceCommandSerializer serializer(&transport, &writer, TraceRecordType::Commands, &client);
+
+        BufferSetSubDataBulkCmd bulk;
+        bulk.bufferId = 1;
+        bulk.start = 0;
+        bulk.count = 3;
+        uint8_t* data = client.Allocate(bulk.count * sizeof(uint32_t), &bulk.dataSerial,
+                                        &bulk.dataOffset);
+        ASSERT_NE(data, nullptr);
+        for (uint32_t i = 0; i < bulk.count * sizeof(uint32_t); ++i) {
+            data[i] = static_cast<uint8_t>(i + 1);
+        }
+        Record(&serializer, bulk);
+        serializer.Flush();
+    }
+
+    ReadTrace();
+    TraceReader reader(GetTrace(), mTraceSize);
+    ASSERT_TRUE(reader.IsValid());
+    EXPECT_EQ(reader.GetHeader().bulkDataUploadSize, kUploadSize);
+    EXPECT_EQ(reader.GetHeader().bulkDataReadbackSize, kReadbackSize);
+
+    TraceRecord record;
+    ASSERT_TRUE(reader.Next(&record));
+    ASSERT_EQ(record.type, TraceRecordType::UploadData);
+    EXPECT_EQ(record.bulkDataSerial, 1u);
+    ASSERT_EQ(record.size, 12u);
+    for (uint32_t i = 0; i < 12; ++i) {
+        EXPECT_EQ(record.data[i], i + 1);
+    }
+
+    ASSERT_TRUE(reader.Next(&record));
+    ASSERT_EQ(record.type, TraceRecordType::Commands);
+    EXPECT_EQ(record.commandCount, 1u);
+
+    EXPECT_FALSE(reader.Next(&record));
+    EXPECT_TRUE(reader.IsValid());
+}
+
+// Test that traces with a bad header or truncated records are rejected
+TEST_F(CommandTraceTests, InvalidTraces) {
+    {
+        TraceWriter writer(mFile);
+        uint32_t size = 8;
+        uint8_t commands[8] = {};
+        writer.WriteCommands(TraceRecordType::Commands, &size, 1, commands, sizeof(commands));
+    }
+    ReadTrace();
+
+    // Truncated header
+    {
+        TraceReader reader(GetTrace(), sizeof(TraceHeader) - 1);
+        EXPECT_FALSE(reader.IsValid());
+    }
+
+    // Truncated record
+    {
+        TraceReader reader(GetTrace(), mTraceSize - 8);
+        ASSERT_TRUE(reader.IsValid());
+        TraceRecord record;
+        EXPECT_FALSE(reader.Next(&record));
+        EXPECT_FALSE(reader.IsValid());
+    }
+
+    // Command sizes that don't match the size of the record
+    {
+        uint32_t badSize = 12;
+        memcpy(GetMutableTrace() + sizeof(TraceHeader) + sizeof(TraceRecordHeader), &badSize,
+               sizeof(badSize));
+        TraceReader reader(GetTrace(), mTraceSize);
+        ASSERT_TRUE(reader.IsValid());
+        TraceRecord record;
+        EXPECT_FALSE(reader.Next(&record));
+        EXPECT_FALSE(reader.IsValid());
+    }
+
+    // Bad version
+    {
+        uint32_t version = kTraceVersion + 1;
+        memcpy(GetMutableTrace() + offsetof(TraceHeader, version), &version, sizeof(version));
+        TraceReader reader(GetTrace(), mTraceSize);
+        EXPECT_FALSE(reader.IsValid());
+    }
+}
+
+// Test that replaying a trace of a wire on the null backend gives the same return commands as
+// when it was traced, every time
+TEST_F(CommandTraceTests, ReplayIsDeterministic) {
+    {
+        nxtProcTable backendProcs;
+        nxtDevice backendDevice;
+        backend::null::Init(&backendProcs, &backendDevice);
+
+        TraceWriter writer(mFile);
+        ChunkedCommandSerializer c2sBuf;
+        ChunkedCommandSerializer s2cBuf;
+        TraceCommandSerializer c2sTrace(&c2sBuf, &writer, TraceRecordType::Commands);
+        TraceCommandSerializer s2cTrace(&s2cBuf, &writer, TraceRecordType::ReturnCommands);
+
+        std::unique_ptr<CommandHandler> server(
+            NewServerCommandHandler(backendDevice, backendProcs, &s2cTrace));
+        c2sBuf.SetHandler(server.get());
+
+        nxtProcTable procs;
+        nxtDevice device;
+        std::unique_ptr<CommandHandler> client(NewClientDevice(&procs, &device, &c2sTrace));
+        s2cBuf.SetHandler(client.get());
+
+        // A buffer that is written then read back, and a builder error.
+        nxtBufferBuilder builder = procs.deviceCreateBufferBuilder(device);
+        nxtBufferUsageBit usage = static_cast<nxtBufferUsageBit>(
+            NXT_BUFFER_USAGE_BIT_MAP_READ | NXT_BUFFER_USAGE_BIT_TRANSFER_DST);
+        procs.bufferBuilderSetAllowedUsage(builder, usage);
+        procs.bufferBuilderSetInitialUsage(builder, NXT_BUFFER_USAGE_BIT_TRANSFER_DST);
+        procs.bufferBuilderSetSize(builder, 16);
+        nxtBuffer buffer = procs.bufferBuilderGetResult(builder);
+        procs.bufferBuilderRelease(builder);
+
+        uint32_t data[2] = {42, 43};
+        procs.bufferSetSubData(buffer, 0, 2, data);
+        procs.bufferTransitionUsage(buffer, NXT_BUFFER_USAGE_BIT_MAP_READ);
+        procs.bufferMapReadAsync(buffer, 0, 16, IgnoreMapReadCallback, 0);
+
+        nxtBufferBuilder badBuilder = procs.deviceCreateBufferBuilder(device);
+        nxtBuffer badBuffer = procs.bufferBuilderGetResult(badBuilder);
+        procs.bufferBuilderRelease(badBuilder);
+
+        nxtQueueBuilder queueBuilder = procs.deviceCreateQueueBuilder(device);
+        nxtQueue queue = procs.queueBuilderGetResult(queueBuilder);
+        procs.queueBuilderRelease(queueBuilder);
+        procs.queueSubmit(queue, 0, nullptr);
+
+        c2sTrace.Flush();
+        s2cTrace.Flush();
+
+        procs.queueRelease(queue);
+        procs.bufferRelease(badBuffer);
+        procs.bufferRelease(buffer);
+        c2sTrace.Flush();
+        s2cTrace.Flush();
+    }
+
+    ReadTrace();
+    TraceReplayer replayer(GetMutableTrace(), mTraceSize);
+    ASSERT_TRUE(replayer.IsValid());
+    EXPECT_GT(replayer.GetCommandCount(), 0u);
+
+    for (int i = 0; i < 2; ++i) {
+        nxtProcTable procs;
+        nxtDevice device;
+        backend::null::Init(&procs, &device);
+
+        std::vector<ReplayCommandStats> stats;
+        ASSERT_TRUE(replayer.Replay(device, procs, i == 0 ? &stats : nullptr));
+        EXPECT_EQ(replayer.GetReplayReturnHash(), replayer.GetTracedReturnHash());
+
+        if (i == 0) {
+            uint64_t commandCount = 0;
+            for (const ReplayCommandStats& commandStats : stats) {
+                commandCount += commandStats.count;
+            }
+            EXPECT_EQ(commandCount, replayer.GetCommandCount());
+            ASSERT_GT(stats.size(), static_cast<size_t>(WireCmd::BufferSetSubData));
+            EXPECT_EQ(stats[static_cast<size_t>(WireCmd::BufferSetSubData)].count, 1u);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/CompactEncoding.h"
+#include "wire/WireCmd.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace nxt::wire;
+
+// A handler that concatenates all the commands it receives.
+class CommandRecorder : public CommandHandler {
+  public:
+    const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+        received.insert(received.end(), commands, commands + size);
+        return commands + size;
+    }
+
+    std::vector<uint8_t> received;
+};
+
+class CompactEncodingTests : public testing::Test {
+  protected:
+    CompactEncodingTests() : handler(&recorder), transport(&handler), serializer(&transport) {
+    }
+
+    // Records a command in the compact serializer and remembers what should be decoded.
+    void Record(const void* command, size_t size) {
+        memcpy(serializer.GetCmdSpace(size), command, size);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(command);
+        expected.insert(expected.end(), bytes, bytes + size);
+    }
+
+    template <typename T>
+    void Record(const T& command) {
+        Record(&command, sizeof(command));
+    }
+
+    // The compact commands go through a transport to the handler that decodes them.
+    CommandRecorder recorder;
+    CompactCommandHandler handler;
+    ChunkedCommandSerializer transport;
+    CompactCommandSerializer serializer;
+
+    std::vector<uint8_t> expected;
+};
+
+// Test that commands of various types and sizes are decoded to the same bytes
+TEST_F(CompactEncodingTests, RoundTrip) {
+    for (uint32_t i = 0; i < 100; ++i) {
+        CommandBufferBuilderDrawArraysCmd draw;
+        draw.self = 3 + i / 10;
+        draw.vertexCount = 3 * i;
+        draw.instanceCount = 1;
+        draw.firstVertex = 0xFFFFFFFF - i;
+        draw.firstInstance = 0;
+        Record(draw);
+
+        BufferSetSubDataBulkCmd bulk;
+        bulk.bufferId = i;
+        bulk.start = 0;
+        bulk.count = i * 1000;
+        bulk.dataSerial = i;
+        bulk.dataOffset = 0x80000000u;
+        Record(bulk);
+
+        // Commands with a size that isn't a multiple of 4, like the ones with strings.
+        uint8_t odd[7] = {static_cast<uint8_t>(WireCmd::BufferMapReadAsync), 0, 0, 0, 1, 2,
+                          static_cast<uint8_t>(i)};
+        Record(odd, sizeof(odd));
+
+        if (i % 10 == 9) {
+            serializer.Flush();
+        }
+    }
+    serializer.Flush();
+
+    EXPECT_EQ(recorder.received, expected);
+    EXPECT_EQ(serializer.GetFlushedCommandSize(), expected.size());
+    EXPECT_LT(serializer.GetFlushedEncodedSize(), serializer.GetFlushedCommandSize());
+}
+
+// Test that repeated commands are run-length encoded
+TEST_F(CompactEncodingTests, RunLength) {
+    CommandBufferBuilderDrawArraysCmd draw;
+    draw.self = 1;
+    draw.vertexCount = 3;
+    draw.instanceCount = 1;
+    draw.firstVertex = 0;
+    draw.firstInstance = 0;
+    for (uint32_t i = 0; i < 100000; ++i) {
+        Record(draw);
+    }
+    serializer.Flush();
+
+    EXPECT_EQ(recorder.received, expected);
+    EXPECT_LT(serializer.GetFlushedEncodedSize(), 64u);
+}
+
+// Test that repeated commands past the run budget of a flush are still decoded correctly
+TEST_F(CompactEncodingTests, RunBudget) {
+    std::vector<uint8_t> command(1024);
+    uint32_t commandId = static_cast<uint32_t>(WireCmd::CommandBufferBuilderDrawArrays);
+    memcpy(command.data(), &commandId, sizeof(commandId));
+    for (uint32_t i = 0; i < 20000; ++i) {
+        Record(command.data(), command.size());
+    }
+    serializer.Flush();
+
+    EXPECT_EQ(recorder.received, expected);
+}
+
+// Test that large commands are sent as-is
+TEST_F(CompactEncodingTests, LargeCommands) {
+    std::vector<uint8_t> command(100000);
+    for (size_t i = 0; i < command.size(); ++i) {
+        command[i] = static_cast<uint8_t>(i * 7);
+    }
+    Record(command.data(), command.size());
+    Record(command.data(), command.size());
+    serializer.Flush();
+
+    EXPECT_EQ(recorder.received, expected);
+    EXPECT_LT(serializer.GetFlushedEncodedSize(), 2 * command.size() + 32);
+}
+
+// Test the size of a stream of push constants and draws, like the ones of the Animometer sample
+TEST_F(CompactEncodingTests, PushConstantsAndDraws) {
+    for (uint32_t i = 0; i < 10000; ++i) {
+        CommandBufferBuilderSetPushConstantsCmd pushConstants;
+        pushConstants.self = 5;
+        pushConstants.stages = NXT_SHADER_STAGE_BIT_VERTEX;
+        pushConstants.offset = 0;
+        pushConstants.count = 4;
+        float values[4] = {0.1f * i, 0.2f, 1.0f / (i + 1), 0.5f};
+
+        std::vector<uint8_t> command(pushConstants.GetRequiredSize());
+        memcpy(command.data(), &pushConstants, sizeof(pushConstants));
+        memcpy(command.data() + sizeof(pushConstants), values, sizeof(values));
+        Record(command.data(), command.size());
+
+        CommandBufferBuilderDrawArraysCmd draw;
+        draw.self = 5;
+        draw.vertexCount = 3;
+        draw.instanceCount = 1;
+        draw.firstVertex = 0;
+        draw.firstInstance = 0;
+        Record(draw);
+    }
+    serializer.Flush();
+
+    EXPECT_EQ(recorder.received, expected);
+    EXPECT_LT(serializer.GetFlushedEncodedSize() * 2, serializer.GetFlushedCommandSize());
+}
+
+// Test that streams that don't start with the magic number are forwarded unchanged
+TEST(CompactCommandHandlerTests, RawStreamForwarded) {
+    CommandRecorder recorder;
+    CompactCommandHandler handler(&recorder);
+
+    uint32_t commands[3] = {static_cast<uint32_t>(WireCmd::BufferMapReadAsync), 1, 2};
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(commands);
+    EXPECT_EQ(handler.HandleCommands(bytes, sizeof(commands)), bytes + sizeof(commands));
+    EXPECT_EQ(handler.HandleCommands(bytes, sizeof(commands)), bytes + sizeof(commands));
+    EXPECT_EQ(recorder.received.size(), 2 * sizeof(commands));
+}
+
+// Test that invalid compact streams are rejected
+TEST(CompactCommandHandlerTests, InvalidStreams) {
+    const uint8_t kMagic[4] = {'X', 'N', 'C', 'P'};
+    const std::vector<std::vector<uint8_t>> streams = {
+        // A repeat without a previous command.
+        {0, 1},
+        // A command with a truncated size.
+        {0x80},
+        // A command with a size smaller than a command ID.
+        {2 << 1, 0},
+        // A command ID that's too large.
+        {8 << 1, 0xFF, 0x7F, 0},
+        // A command missing words.
+        {8 << 1, 1},
+        // A command sent as-is that is truncated.
+        {(8 << 1) | 1, 1, 2, 3},
+    };
+
+    for (const auto& stream : streams) {
+        CommandRecorder recorder;
+        CompactCommandHandler handler(&recorder);
+
+        std::vector<uint8_t> data(kMagic, kMagic + sizeof(kMagic));
+        data.insert(data.end(), stream.begin(), stream.end());
+        EXPECT_EQ(handler.HandleCommands(data.data(), data.size()), nullptr);
+        EXPECT_TRUE(recorder.received.empty());
+    }
+}
+
+// Test that runs decoding to more than the budget of a flush are rejected
+TEST(CompactCommandHandlerTests, RunBudgetExceeded) {
+    CommandRecorder recorder;
+    CompactCommandHandler handler(&recorder);
+
+    // A 1024 byte command with command ID 1 and all its other words unchanged.
+    std::vector<uint8_t> data = {'X', 'N', 'C', 'P', 0x80, 0x10, 1};
+    data.insert(data.end(), 255, 0);
+    // Repeated 65536 times, which is 64MB.
+    data.insert(data.end(), {0, 0x80, 0x80, 0x04});
+
+    EXPECT_EQ(handler.HandleCommands(data.data(), data.size()), nullptr);
+    EXPECT_TRUE(recorder.received.empty());
+}
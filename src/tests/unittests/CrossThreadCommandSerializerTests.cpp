@@ -0,0 +1,132 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "wire/CrossThreadCommandSerializer.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace nxt::wire;
+
+// A handler that records the bytes it receives and the thread it is called on.
+class ThreadRecordingHandler : public CommandHandler {
+  public:
+    const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+        data.insert(data.end(), commands, commands + size);
+        thread = std::this_thread::get_id();
+        return commands + size;
+    }
+
+    std::vector<uint8_t> data;
+    std::thread::id thread;
+};
+
+static void RecordByte(CommandSerializer* serializer, uint8_t value) {
+    *static_cast<uint8_t*>(serializer->GetCmdSpace(1)) = value;
+}
+
+// Test that batches are handled in order on the handling thread
+TEST(CrossThreadCommandSerializer, HandledInOrderOnOtherThread) {
+    CrossThreadCommandSerializer serializer(3);
+    ThreadRecordingHandler handler;
+
+    std::thread::id handlingThreadId;
+    std::thread handlingThread([&]() {
+        handlingThreadId = std::this_thread::get_id();
+        while (serializer.HandleFlushedCommands(&handler, true)) {
+        }
+    });
+
+    for (uint8_t i = 0; i < 100; ++i) {
+        RecordByte(&serializer, i);
+        if (i % 3 == 0) {
+            serializer.Flush();
+        }
+    }
+    serializer.Flush();
+    serializer.WaitForIdle();
+
+    serializer.Close();
+    handlingThread.join();
+
+    ASSERT_EQ(handler.data.size(), 100u);
+    for (uint8_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(handler.data[i], i);
+    }
+    EXPECT_EQ(handler.thread, handlingThreadId);
+}
+
+// Test that flushing without commands doesn't create a batch
+TEST(CrossThreadCommandSerializer, EmptyFlush) {
+    CrossThreadCommandSerializer serializer(2);
+    ThreadRecordingHandler handler;
+
+    serializer.Flush();
+    EXPECT_FALSE(serializer.HandleFlushedCommands(&handler, false));
+
+    RecordByte(&serializer, 1);
+    serializer.Flush();
+    EXPECT_TRUE(serializer.HandleFlushedCommands(&handler, false));
+    EXPECT_FALSE(serializer.HandleFlushedCommands(&handler, false));
+}
+
+// Test that Flush waits for a batch to be handled when all of them are in flight
+TEST(CrossThreadCommandSerializer, BackPressure) {
+    CrossThreadCommandSerializer serializer(2);
+    ThreadRecordingHandler handler;
+
+    // The first flush gets a second batch to record in.
+    RecordByte(&serializer, 1);
+    serializer.Flush();
+
+    // The second flush has to wait for the first batch to be handled.
+    std::atomic<bool> secondFlushDone(false);
+    std::thread recordingThread([&]() {
+        RecordByte(&serializer, 2);
+        serializer.Flush();
+        secondFlushDone = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(secondFlushDone);
+
+    EXPECT_TRUE(serializer.HandleFlushedCommands(&handler, false));
+    recordingThread.join();
+    EXPECT_TRUE(secondFlushDone);
+
+    EXPECT_TRUE(serializer.HandleFlushedCommands(&handler, false));
+    ASSERT_EQ(handler.data.size(), 2u);
+    EXPECT_EQ(handler.data[1], 2u);
+}
+
+// Test that an unbounded serializer never waits in Flush
+TEST(CrossThreadCommandSerializer, Unbounded) {
+    CrossThreadCommandSerializer serializer(0);
+    ThreadRecordingHandler handler;
+
+    for (uint8_t i = 0; i < 10; ++i) {
+        RecordByte(&serializer, i);
+        serializer.Flush();
+    }
+
+    uint32_t handledCount = 0;
+    while (serializer.HandleFlushedCommands(&handler, false)) {
+        handledCount++;
+    }
+    EXPECT_EQ(handledCount, 10u);
+}
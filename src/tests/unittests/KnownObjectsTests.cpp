@@ -0,0 +1,144 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "wire/KnownObjects.h"
+
+using namespace nxt::wire::server;
+
+struct FakeObject {};
+using FakeHandle = FakeObject*;
+
+// Test that ID 0 is the valid null object
+TEST(KnownObjectsTests, NullObject) {
+    KnownObjects<FakeHandle> known;
+
+    FakeHandle handle;
+    bool valid;
+    ASSERT_TRUE(known.Get(0, &handle, &valid));
+    EXPECT_EQ(handle, nullptr);
+    EXPECT_TRUE(valid);
+    EXPECT_FALSE(known.Allocate(0, 0));
+}
+
+// Test allocating, using and freeing IDs
+TEST(KnownObjectsTests, AllocateAndFree) {
+    KnownObjects<FakeHandle> known;
+    FakeObject object;
+
+    FakeHandle handle;
+    bool valid;
+    EXPECT_FALSE(known.Get(1, &handle, &valid));
+
+    // IDs can only be allocated one after the other.
+    EXPECT_FALSE(known.Allocate(2, 0));
+    ASSERT_TRUE(known.Allocate(1, 7));
+    EXPECT_FALSE(known.Allocate(1, 7));
+
+    // Objects are errors until the backend returns an object.
+    ASSERT_TRUE(known.Get(1, &handle, &valid));
+    EXPECT_FALSE(valid);
+    EXPECT_EQ(known.GetSerial(1), 7u);
+
+    known.SetHandle(1, &object);
+    ASSERT_TRUE(known.Get(1, &handle, &valid));
+    EXPECT_EQ(handle, &object);
+    EXPECT_TRUE(valid);
+
+    known.SetValid(1, false);
+    ASSERT_TRUE(known.Get(1, &handle, &valid));
+    EXPECT_FALSE(valid);
+
+    // Freed IDs can be allocated again, and start as errors.
+    known.Free(1);
+    EXPECT_FALSE(known.IsAllocated(1));
+    EXPECT_FALSE(known.Get(1, &handle, &valid));
+    ASSERT_TRUE(known.Allocate(1, 8));
+    ASSERT_TRUE(known.Get(1, &handle, &valid));
+    EXPECT_EQ(handle, nullptr);
+    EXPECT_FALSE(valid);
+    EXPECT_EQ(known.GetSerial(1), 8u);
+}
+
+// Test getting the handles of arrays of IDs
+TEST(KnownObjectsTests, GetMany) {
+    KnownObjects<FakeHandle> known;
+    FakeObject objects[2];
+    ASSERT_TRUE(known.Allocate(1, 0));
+    ASSERT_TRUE(known.Allocate(2, 0));
+    known.SetHandle(1, &objects[0]);
+    known.SetHandle(2, &objects[1]);
+
+    uint32_t ids[3] = {2, 0, 1};
+    FakeHandle handles[3];
+    bool allValid = false;
+    ASSERT_TRUE(known.GetMany(ids, 3, handles, &allValid));
+    EXPECT_TRUE(allValid);
+    EXPECT_EQ(handles[0], &objects[1]);
+    EXPECT_EQ(handles[1], nullptr);
+    EXPECT_EQ(handles[2], &objects[0]);
+
+    // An error object makes the array invalid.
+    known.SetValid(2, false);
+    ASSERT_TRUE(known.GetMany(ids, 3, handles, &allValid));
+    EXPECT_FALSE(allValid);
+
+    // An unallocated ID is a fatal error.
+    known.Free(1);
+    EXPECT_FALSE(known.GetMany(ids, 3, handles, &allValid));
+}
+
+// Test that builders remember the object they built, and it is reset when the ID is reused
+TEST(KnownObjectsTests, BuiltObject) {
+    KnownObjects<FakeHandle, true> known;
+
+    ASSERT_TRUE(known.Allocate(1, 0));
+    EXPECT_EQ(known.GetBuiltObject(1).id, 0u);
+
+    known.SetBuiltObject(1, 42, 3);
+    EXPECT_EQ(known.GetBuiltObject(1).id, 42u);
+    EXPECT_EQ(known.GetBuiltObject(1).serial, 3u);
+
+    known.Free(1);
+    ASSERT_TRUE(known.Allocate(1, 1));
+    EXPECT_EQ(known.GetBuiltObject(1).id, 0u);
+}
+
+// Test the memory used by a million objects, builder metadata is only stored for builders
+TEST(KnownObjectsTests, MillionObjects) {
+    constexpr uint32_t kObjectCount = 1000000;
+    KnownObjects<FakeHandle> known;
+    KnownObjects<FakeHandle, true> knownBuilders;
+    FakeObject object;
+
+    for (uint32_t id = 1; id <= kObjectCount; ++id) {
+        ASSERT_TRUE(known.Allocate(id, 0));
+        ASSERT_TRUE(knownBuilders.Allocate(id, 0));
+        known.SetHandle(id, &object);
+    }
+
+    // A handle and a serial per object, plus two bits.
+    EXPECT_LE(known.GetMemoryUsage(), 2 * kObjectCount * (sizeof(FakeHandle) + sizeof(uint32_t)));
+    EXPECT_GT(knownBuilders.GetMemoryUsage(), known.GetMemoryUsage());
+
+    // Freeing and reallocating the objects doesn't grow the storage.
+    for (uint32_t id = 1; id <= kObjectCount; ++id) {
+        known.Free(id);
+    }
+    for (uint32_t id = 1; id <= kObjectCount; ++id) {
+        ASSERT_TRUE(known.Allocate(id, 1));
+    }
+    EXPECT_EQ(known.GetIdCount(), kObjectCount + 1);
+}
@@ -0,0 +1,109 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "wire/ObjectSlabs.h"
+
+#include <vector>
+
+using namespace nxt::wire::client;
+
+// An object that counts how many of its instances are alive
+struct CountedObject {
+    CountedObject(int* count, uint32_t id) : count(count), id(id) {
+        (*count)++;
+    }
+    ~CountedObject() {
+        (*count)--;
+    }
+
+    int* count;
+    uint32_t id;
+};
+
+// Test constructing, getting and destroying objects
+TEST(ObjectSlabsTests, ConstructAndDestroy) {
+    int count = 0;
+    ObjectSlabs<CountedObject, 4> slabs;
+
+    EXPECT_EQ(slabs.Get(0), nullptr);
+    EXPECT_EQ(slabs.Get(1), nullptr);
+
+    CountedObject* object = slabs.Construct(1, &count, 1);
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(slabs.Get(1), object);
+    EXPECT_EQ(object->id, 1u);
+    EXPECT_EQ(slabs.Get(0), nullptr);
+
+    slabs.Destroy(1);
+    EXPECT_EQ(count, 0);
+    EXPECT_EQ(slabs.Get(1), nullptr);
+}
+
+// Test that the generation of an ID is incremented each time its object is destroyed
+TEST(ObjectSlabsTests, Generations) {
+    int count = 0;
+    ObjectSlabs<CountedObject, 4> slabs;
+
+    EXPECT_EQ(slabs.GetGeneration(3), 0u);
+    slabs.Construct(3, &count, 3);
+    EXPECT_EQ(slabs.GetGeneration(3), 0u);
+    slabs.Destroy(3);
+    EXPECT_EQ(slabs.GetGeneration(3), 1u);
+    slabs.Construct(3, &count, 3);
+    EXPECT_EQ(slabs.GetGeneration(3), 1u);
+
+    // Other IDs in the slab are unaffected.
+    EXPECT_EQ(slabs.GetGeneration(2), 0u);
+}
+
+// Test that object addresses are stable when slabs are added, and that they are only added
+// every kSlabSize IDs
+TEST(ObjectSlabsTests, StableAddresses) {
+    int count = 0;
+    ObjectSlabs<CountedObject, 4> slabs;
+
+    std::vector<CountedObject*> objects;
+    for (uint32_t id = 0; id < 100; ++id) {
+        objects.push_back(slabs.Construct(id, &count, id));
+    }
+    EXPECT_EQ(slabs.GetSlabCount(), 25u);
+
+    for (uint32_t id = 0; id < 100; ++id) {
+        EXPECT_EQ(slabs.Get(id), objects[id]);
+        EXPECT_EQ(objects[id]->id, id);
+    }
+
+    // Reusing IDs doesn't add slabs.
+    for (uint32_t id = 0; id < 100; ++id) {
+        slabs.Destroy(id);
+        EXPECT_EQ(slabs.Construct(id, &count, id), objects[id]);
+    }
+    EXPECT_EQ(slabs.GetSlabCount(), 25u);
+}
+
+// Test that live objects are destroyed with the slabs
+TEST(ObjectSlabsTests, DestroyedWithSlabs) {
+    int count = 0;
+    {
+        ObjectSlabs<CountedObject, 4> slabs;
+        for (uint32_t id = 0; id < 10; ++id) {
+            slabs.Construct(id, &count, id);
+        }
+        slabs.Destroy(5);
+        EXPECT_EQ(count, 9);
+    }
+    EXPECT_EQ(count, 0);
+}
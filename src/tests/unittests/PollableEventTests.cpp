@@ -0,0 +1,89 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "common/Platform.h"
+#include "common/PollableEvent.h"
+
+#if NXT_PLATFORM_POSIX
+
+#include <poll.h>
+
+#include <thread>
+
+namespace {
+
+    bool IsReadable(const PollableEvent& event, int timeoutMs = 0) {
+        pollfd fd = {};
+        fd.fd = event.GetFd();
+        fd.events = POLLIN;
+        return poll(&fd, 1, timeoutMs) == 1 && (fd.revents & POLLIN) != 0;
+    }
+
+}  // anonymous namespace
+
+// Test that the event is readable only between Signal and Clear
+TEST(PollableEvent, SignalAndClear) {
+    PollableEvent event;
+    ASSERT_GE(event.GetFd(), 0);
+    ASSERT_FALSE(IsReadable(event));
+
+    event.Signal();
+    ASSERT_TRUE(IsReadable(event));
+    // Polling doesn't consume the event
+    ASSERT_TRUE(IsReadable(event));
+
+    event.Clear();
+    ASSERT_FALSE(IsReadable(event));
+
+    // Clearing an event that isn't signaled is fine
+    event.Clear();
+    ASSERT_FALSE(IsReadable(event));
+}
+
+// Test that a single Clear clears multiple signals
+TEST(PollableEvent, MultipleSignals) {
+    PollableEvent event;
+
+    event.Signal();
+    event.Signal();
+    event.Signal();
+    ASSERT_TRUE(IsReadable(event));
+
+    event.Clear();
+    ASSERT_FALSE(IsReadable(event));
+}
+
+// Test that signaling from another thread wakes a thread polling the event
+TEST(PollableEvent, SignalFromOtherThread) {
+    PollableEvent event;
+
+    std::thread signaler([&event]() { event.Signal(); });
+    ASSERT_TRUE(IsReadable(event, 5000));
+    signaler.join();
+}
+
+#else
+
+// Test that the event isn't pollable on platforms without file descriptors
+TEST(PollableEvent, NoFd) {
+    PollableEvent event;
+    ASSERT_EQ(event.GetFd(), -1);
+
+    event.Signal();
+    event.Clear();
+}
+
+#endif  // NXT_PLATFORM_POSIX
@@ -0,0 +1,100 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "common/RingAllocator.h"
+
+// Test that allocations are sequential and respect the alignment
+TEST(RingAllocator, Sequential) {
+    RingAllocator allocator(256);
+
+    EXPECT_EQ(allocator.Allocate(16, 4, 1), 0u);
+    EXPECT_EQ(allocator.Allocate(4, 4, 1), 16u);
+    EXPECT_EQ(allocator.Allocate(8, 16, 1), 32u);
+    EXPECT_EQ(allocator.GetUsedSize(), 40u);
+}
+
+// Test that allocations fail when the ring is full and succeed again once the serials complete
+TEST(RingAllocator, FullUntilTick) {
+    RingAllocator allocator(64);
+
+    EXPECT_EQ(allocator.Allocate(32, 4, 1), 0u);
+    EXPECT_EQ(allocator.Allocate(32, 4, 2), 32u);
+    EXPECT_EQ(allocator.GetUsedSize(), 64u);
+    EXPECT_EQ(allocator.Allocate(4, 4, 3), RingAllocator::kInvalidOffset);
+
+    // Completing serial 1 only frees the first allocation
+    allocator.Tick(1);
+    EXPECT_EQ(allocator.GetUsedSize(), 32u);
+    EXPECT_EQ(allocator.Allocate(32, 4, 3), 0u);
+    EXPECT_EQ(allocator.Allocate(4, 4, 3), RingAllocator::kInvalidOffset);
+
+    allocator.Tick(3);
+    EXPECT_TRUE(allocator.Empty());
+}
+
+// Test that an allocation that doesn't fit at the end of the ring wraps around to the start
+TEST(RingAllocator, Wraparound) {
+    RingAllocator allocator(64);
+
+    EXPECT_EQ(allocator.Allocate(24, 4, 1), 0u);
+    EXPECT_EQ(allocator.Allocate(24, 4, 2), 24u);
+    allocator.Tick(1);
+
+    // There are 16 bytes left at the end, not enough, so it goes at the start and the end is
+    // counted as used.
+    EXPECT_EQ(allocator.Allocate(20, 4, 3), 0u);
+    EXPECT_EQ(allocator.GetUsedSize(), 24u + 16u + 20u);
+
+    // Only [20, 24) is free now.
+    EXPECT_EQ(allocator.Allocate(8, 4, 3), RingAllocator::kInvalidOffset);
+    EXPECT_EQ(allocator.Allocate(4, 4, 3), 20u);
+
+    // The skipped end of the ring is freed with the allocation that wrapped around.
+    allocator.Tick(2);
+    EXPECT_EQ(allocator.GetUsedSize(), 16u + 20u + 4u);
+    allocator.Tick(3);
+    EXPECT_TRUE(allocator.Empty());
+}
+
+// Test that allocations too big for the ring always fail
+TEST(RingAllocator, TooBig) {
+    RingAllocator allocator(64);
+
+    EXPECT_EQ(allocator.Allocate(65, 4, 1), RingAllocator::kInvalidOffset);
+    EXPECT_EQ(allocator.Allocate(64, 4, 1), 0u);
+    EXPECT_EQ(allocator.Allocate(1, 1, 1), RingAllocator::kInvalidOffset);
+}
+
+// Test streaming many small allocations over many serials, like per-frame uniform updates
+TEST(RingAllocator, Streaming) {
+    RingAllocator allocator(1024);
+
+    for (Serial serial = 1; serial < 100; ++serial) {
+        for (uint32_t i = 0; i < 10; ++i) {
+            size_t offset = allocator.Allocate(20, 16, serial);
+            ASSERT_NE(offset, RingAllocator::kInvalidOffset);
+            ASSERT_EQ(offset % 16, 0u);
+            ASSERT_LE(offset + 20, allocator.GetSize());
+        }
+        // The GPU is two frames behind
+        if (serial > 2) {
+            allocator.Tick(serial - 2);
+        }
+    }
+
+    allocator.Tick(100);
+    EXPECT_TRUE(allocator.Empty());
+}
@@ -16,6 +16,8 @@
 
 #include "common/SerialQueue.h"
 
+#include <memory>
+
 using TestSerialQueue = SerialQueue<int>;
 
 // A number of basic tests for SerialQueue that are difficult to split from one another
@@ -141,3 +143,91 @@ TEST(SerialQueue, FirstSerial) {
     queue.Enqueue(vector1, 6);
     EXPECT_EQ(queue.FirstSerial(), 6);
 }
+
+// Test that the queue works when values wrap around the end of the ring buffer
+TEST(SerialQueue, Wraparound) {
+    TestSerialQueue queue;
+
+    int nextValue = 0;
+    int nextExpected = 0;
+    for (Serial serial = 0; serial < 100; ++serial) {
+        for (int i = 0; i < 7; ++i) {
+            queue.Enqueue(nextValue++, serial);
+        }
+
+        // Keep a few serials in flight so that the values wrap in the ring buffer
+        if (serial >= 3) {
+            for (int value : queue.IterateUpTo(serial - 3)) {
+                EXPECT_EQ(nextExpected++, value);
+            }
+            queue.ClearUpTo(serial - 3);
+            EXPECT_EQ(queue.FirstSerial(), serial - 2);
+        }
+    }
+
+    for (int value : queue.IterateAll()) {
+        EXPECT_EQ(nextExpected++, value);
+    }
+    EXPECT_EQ(nextExpected, nextValue);
+}
+
+// Test a frame-like pattern with thousands of values per serial
+TEST(SerialQueue, ThousandsPerSerial) {
+    TestSerialQueue queue;
+
+    constexpr int kValuesPerFrame = 5000;
+    constexpr Serial kFramesInFlight = 3;
+    for (Serial frame = 0; frame < 20; ++frame) {
+        for (int i = 0; i < kValuesPerFrame; ++i) {
+            queue.Enqueue(i, frame);
+        }
+
+        if (frame >= kFramesInFlight) {
+            int count = 0;
+            for (int value : queue.IterateUpTo(frame - kFramesInFlight)) {
+                EXPECT_EQ(count % kValuesPerFrame, value);
+                count++;
+            }
+            EXPECT_EQ(count, kValuesPerFrame);
+            queue.ClearUpTo(frame - kFramesInFlight);
+        }
+    }
+
+    int count = 0;
+    for (int value : queue.IterateAll()) {
+        (void)value;
+        count++;
+    }
+    EXPECT_EQ(count, static_cast<int>(kFramesInFlight) * kValuesPerFrame);
+}
+
+// Test that values are destroyed when they are cleared and can be modified while iterating
+TEST(SerialQueue, ValueLifetime) {
+    SerialQueue<std::unique_ptr<int>> queue;
+
+    queue.Enqueue(std::unique_ptr<int>(new int(1)), 0);
+    queue.Enqueue(std::unique_ptr<int>(new int(2)), 1);
+
+    std::weak_ptr<int> observer;
+    {
+        std::shared_ptr<int> shared(new int(3));
+        observer = shared;
+        SerialQueue<std::shared_ptr<int>> sharedQueue;
+        sharedQueue.Enqueue(std::move(shared), 0);
+        EXPECT_FALSE(observer.expired());
+        sharedQueue.ClearUpTo(0);
+        EXPECT_TRUE(observer.expired());
+    }
+
+    for (auto& value : queue.IterateUpTo(0)) {
+        value.reset(new int(4));
+    }
+    queue.ClearUpTo(0);
+
+    int count = 0;
+    for (const auto& value : queue.IterateAll()) {
+        EXPECT_EQ(*value, 2);
+        count++;
+    }
+    EXPECT_EQ(count, 1);
+}
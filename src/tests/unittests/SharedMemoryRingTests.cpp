@@ -0,0 +1,340 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "common/Math.h"
+#include "common/Platform.h"
+#include "wire/SharedMemoryRing.h"
+#include "wire/SharedMemoryTransport.h"
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if NXT_PLATFORM_LINUX
+#    include <unistd.h>
+#endif
+
+using namespace nxt::wire;
+
+// A handler that stores each message it receives.
+class MessageRecorder : public CommandHandler {
+  public:
+    const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+        messages.emplace_back(commands, commands + size);
+        return commands + size;
+    }
+
+    std::vector<std::vector<uint8_t>> messages;
+};
+
+class SharedMemoryRingTests : public testing::Test {
+  protected:
+    // Creates a ring in process memory, views on it behave the same as in shared memory.
+    std::unique_ptr<SharedMemoryRing> CreateRing(size_t capacity) {
+        mStorage.reset(new uint8_t[SharedMemoryRing::GetRequiredMemorySize(capacity) + 64]);
+        void* memory = AlignPtr(mStorage.get(), 64);
+        SharedMemoryRing::Initialize(memory, capacity);
+        mData = reinterpret_cast<uint8_t*>(memory) +
+                (SharedMemoryRing::GetRequiredMemorySize(capacity) - capacity);
+        return std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(memory, capacity));
+    }
+
+    // Overwrites the header of the message at the start of the ring data, like a misbehaving
+    // producer would.
+    void CorruptFirstMessageHeader(uint32_t size, uint32_t isPadding) {
+        memcpy(mData, &size, sizeof(size));
+        memcpy(mData + sizeof(size), &isPadding, sizeof(isPadding));
+    }
+
+    uint8_t* GetRingData() {
+        return mData;
+    }
+
+    static std::vector<uint8_t> MakeMessage(size_t size, uint8_t seed) {
+        std::vector<uint8_t> message(size);
+        for (size_t i = 0; i < size; ++i) {
+            message[i] = static_cast<uint8_t>(seed + i);
+        }
+        return message;
+    }
+
+  private:
+    std::unique_ptr<uint8_t[]> mStorage;
+    uint8_t* mData = nullptr;
+};
+
+// Test that messages are only visible once published, and are received in order
+TEST_F(SharedMemoryRingTests, PublishedInOrder) {
+    auto ring = CreateRing(256);
+    MessageRecorder recorder;
+
+    std::vector<uint8_t> a = MakeMessage(5, 1);
+    std::vector<uint8_t> b = MakeMessage(16, 2);
+    ASSERT_TRUE(ring->Write(a.data(), a.size()));
+    ASSERT_TRUE(ring->Write(b.data(), b.size()));
+
+    EXPECT_FALSE(ring->WaitForMessages(0));
+    ASSERT_TRUE(ring->HandleMessages(&recorder));
+    EXPECT_TRUE(recorder.messages.empty());
+
+    ring->Publish();
+    EXPECT_TRUE(ring->WaitForMessages(0));
+    ASSERT_TRUE(ring->HandleMessages(&recorder));
+    ASSERT_EQ(recorder.messages.size(), 2u);
+    EXPECT_EQ(recorder.messages[0], a);
+    EXPECT_EQ(recorder.messages[1], b);
+    EXPECT_FALSE(ring->WaitForMessages(0));
+}
+
+// Test that messages that would straddle the end of the ring are still received whole
+TEST_F(SharedMemoryRingTests, Wraparound) {
+    auto ring = CreateRing(128);
+    MessageRecorder recorder;
+
+    for (uint8_t i = 0; i < 20; ++i) {
+        std::vector<uint8_t> message = MakeMessage(36, i);
+        ASSERT_TRUE(ring->Write(message.data(), message.size()));
+        ring->Publish();
+        ASSERT_TRUE(ring->HandleMessages(&recorder));
+        ASSERT_EQ(recorder.messages.back(), message);
+    }
+    EXPECT_EQ(recorder.messages.size(), 20u);
+}
+
+// Test that a message bigger than the ring is streamed by the producer and reassembled
+TEST_F(SharedMemoryRingTests, MessageBiggerThanRing) {
+    auto ring = CreateRing(128);
+    MessageRecorder recorder;
+
+    std::vector<uint8_t> big = MakeMessage(1001, 7);
+    std::vector<uint8_t> small = MakeMessage(3, 8);
+    std::thread producer([&]() {
+        EXPECT_TRUE(ring->Write(big.data(), big.size()));
+        EXPECT_TRUE(ring->Write(small.data(), small.size()));
+        ring->Publish();
+    });
+
+    while (recorder.messages.size() < 2) {
+        ring->WaitForMessages(10);
+        ASSERT_TRUE(ring->HandleMessages(&recorder));
+    }
+    producer.join();
+
+    EXPECT_EQ(recorder.messages[0], big);
+    EXPECT_EQ(recorder.messages[1], small);
+}
+
+// Test a producer and a consumer on different threads with messages of varying sizes
+TEST_F(SharedMemoryRingTests, Threaded) {
+    auto ring = CreateRing(1024);
+    MessageRecorder recorder;
+
+    constexpr uint32_t kMessageCount = 2000;
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < kMessageCount; ++i) {
+            std::vector<uint8_t> message = MakeMessage((i * 37) % 1500, static_cast<uint8_t>(i));
+            ASSERT_TRUE(ring->Write(message.data(), message.size()));
+            if (i % 7 == 0) {
+                ring->Publish();
+            }
+        }
+        ring->Publish();
+    });
+
+    while (recorder.messages.size() < kMessageCount) {
+        ring->WaitForMessages(10);
+        ASSERT_TRUE(ring->HandleMessages(&recorder));
+    }
+    producer.join();
+
+    for (uint32_t i = 0; i < kMessageCount; ++i) {
+        ASSERT_EQ(recorder.messages[i], MakeMessage((i * 37) % 1500, static_cast<uint8_t>(i)));
+    }
+}
+
+// Test that closing the ring stops a producer waiting for space
+TEST_F(SharedMemoryRingTests, CloseStopsWaitingProducer) {
+    auto ring = CreateRing(64);
+
+    std::vector<uint8_t> message = MakeMessage(40, 0);
+    ASSERT_TRUE(ring->Write(message.data(), message.size()));
+
+    bool writeResult = true;
+    std::thread producer([&]() { writeResult = ring->Write(message.data(), message.size()); });
+    ring->Close();
+    producer.join();
+
+    EXPECT_FALSE(writeResult);
+    EXPECT_TRUE(ring->IsClosed());
+}
+
+// Test that a message header claiming more data than was published closes the ring
+TEST_F(SharedMemoryRingTests, MalformedMessageSize) {
+    auto ring = CreateRing(256);
+    MessageRecorder recorder;
+
+    std::vector<uint8_t> message = MakeMessage(16, 0);
+    ASSERT_TRUE(ring->Write(message.data(), message.size()));
+    ring->Publish();
+    CorruptFirstMessageHeader(100, 0);
+
+    EXPECT_FALSE(ring->HandleMessages(&recorder));
+    EXPECT_TRUE(recorder.messages.empty());
+    EXPECT_TRUE(ring->IsClosed());
+}
+
+// Test that padding that doesn't go until the end of the ring closes the ring
+TEST_F(SharedMemoryRingTests, MalformedPadding) {
+    auto ring = CreateRing(256);
+    MessageRecorder recorder;
+
+    std::vector<uint8_t> message = MakeMessage(16, 0);
+    ASSERT_TRUE(ring->Write(message.data(), message.size()));
+    ring->Publish();
+    CorruptFirstMessageHeader(8, 1);
+
+    EXPECT_FALSE(ring->HandleMessages(&recorder));
+    EXPECT_TRUE(recorder.messages.empty());
+    EXPECT_TRUE(ring->IsClosed());
+}
+
+// Test that messages bigger than the maximum size are rejected instead of being reassembled
+TEST_F(SharedMemoryRingTests, MessageBiggerThanMaxSize) {
+    auto ring = CreateRing(256);
+    MessageRecorder recorder;
+
+    std::vector<uint8_t> message = MakeMessage(16, 0);
+    ASSERT_TRUE(ring->Write(message.data(), message.size()));
+    ring->Publish();
+    CorruptFirstMessageHeader(static_cast<uint32_t>(SharedMemoryRing::kMaxMessageSize + 1), 0);
+
+    EXPECT_FALSE(ring->HandleMessages(&recorder));
+    EXPECT_TRUE(recorder.messages.empty());
+    EXPECT_TRUE(ring->IsClosed());
+}
+
+// Test that the producer changing a message after publishing it doesn't change the message the
+// handler sees, so that it can't bypass the handler's validation
+TEST_F(SharedMemoryRingTests, MessageChangedAfterPublish) {
+    auto ring = CreateRing(256);
+
+    // Overwrites the whole ring data while the message is being handled.
+    class OverwritingHandler : public CommandHandler {
+      public:
+        OverwritingHandler(uint8_t* ringData) : mRingData(ringData) {
+        }
+
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+            std::vector<uint8_t> before(commands, commands + size);
+            memset(mRingData, 0xFF, 256);
+            changed = before != std::vector<uint8_t>(commands, commands + size);
+            message = before;
+            return commands + size;
+        }
+
+        bool changed = false;
+        std::vector<uint8_t> message;
+
+      private:
+        uint8_t* mRingData;
+    };
+    OverwritingHandler handler(GetRingData());
+
+    std::vector<uint8_t> message = MakeMessage(16, 0);
+    ASSERT_TRUE(ring->Write(message.data(), message.size()));
+    ring->Publish();
+
+    EXPECT_TRUE(ring->HandleMessages(&handler));
+    EXPECT_FALSE(handler.changed);
+    EXPECT_EQ(handler.message, message);
+}
+
+// Test that the serializer sends each chunk of commands as a message on Flush
+TEST_F(SharedMemoryRingTests, Serializer) {
+    auto ring = CreateRing(1024);
+    SharedMemoryRingSerializer serializer(ring.get());
+    MessageRecorder recorder;
+
+    memset(serializer.GetCmdSpace(8), 1, 8);
+    memset(serializer.GetCmdSpace(4), 2, 4);
+    ASSERT_TRUE(ring->HandleMessages(&recorder));
+    EXPECT_TRUE(recorder.messages.empty());
+
+    serializer.Flush();
+    ASSERT_TRUE(ring->HandleMessages(&recorder));
+    ASSERT_EQ(recorder.messages.size(), 1u);
+    ASSERT_EQ(recorder.messages[0].size(), 12u);
+    EXPECT_EQ(recorder.messages[0][7], 1u);
+    EXPECT_EQ(recorder.messages[0][8], 2u);
+}
+
+#if NXT_PLATFORM_LINUX
+// Test that two mappings of the transport's memfd see the same rings
+TEST_F(SharedMemoryRingTests, TransportSharesMemory) {
+    std::unique_ptr<SharedMemoryTransport> client = SharedMemoryTransport::Create(4096);
+    ASSERT_NE(client, nullptr);
+    std::unique_ptr<SharedMemoryTransport> server =
+        SharedMemoryTransport::Open(dup(client->GetFd()));
+    ASSERT_NE(server, nullptr);
+
+    std::vector<uint8_t> command = MakeMessage(100, 3);
+    ASSERT_TRUE(client->GetClientToServerRing()->Write(command.data(), command.size()));
+    client->GetClientToServerRing()->Publish();
+
+    MessageRecorder serverRecorder;
+    ASSERT_TRUE(server->GetClientToServerRing()->HandleMessages(&serverRecorder));
+    ASSERT_EQ(serverRecorder.messages.size(), 1u);
+    EXPECT_EQ(serverRecorder.messages[0], command);
+
+    std::vector<uint8_t> reply = MakeMessage(10, 4);
+    ASSERT_TRUE(server->GetServerToClientRing()->Write(reply.data(), reply.size()));
+    server->GetServerToClientRing()->Publish();
+
+    MessageRecorder clientRecorder;
+    ASSERT_TRUE(client->GetServerToClientRing()->HandleMessages(&clientRecorder));
+    ASSERT_EQ(clientRecorder.messages.size(), 1u);
+    EXPECT_EQ(clientRecorder.messages[0], reply);
+
+    EXPECT_EQ(client->GetBulkDataChannel(BulkDataChannel::Side::Client), nullptr);
+}
+
+// Test that the bulk data channel of the transport is shared as well
+TEST_F(SharedMemoryRingTests, TransportBulkData) {
+    std::unique_ptr<SharedMemoryTransport> client = SharedMemoryTransport::Create(4096, 65536);
+    ASSERT_NE(client, nullptr);
+    std::unique_ptr<SharedMemoryTransport> server =
+        SharedMemoryTransport::Open(dup(client->GetFd()));
+    ASSERT_NE(server, nullptr);
+
+    BulkDataChannel* clientBulkData = client->GetBulkDataChannel(BulkDataChannel::Side::Client);
+    BulkDataChannel* serverBulkData = server->GetBulkDataChannel(BulkDataChannel::Side::Server);
+    ASSERT_NE(clientBulkData, nullptr);
+    ASSERT_NE(serverBulkData, nullptr);
+
+    uint32_t serial, offset;
+    uint8_t* upload = clientBulkData->Allocate(65536, &serial, &offset);
+    ASSERT_NE(upload, nullptr);
+    upload[65535] = 42;
+
+    const uint8_t* received = serverBulkData->Receive(serial, offset, 65536);
+    ASSERT_NE(received, nullptr);
+    EXPECT_EQ(received[65535], 42u);
+    serverBulkData->Release(serial);
+
+    EXPECT_NE(clientBulkData->Allocate(65536, &serial, &offset), nullptr);
+}
+#endif  // NXT_PLATFORM_LINUX
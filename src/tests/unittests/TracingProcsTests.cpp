@@ -0,0 +1,189 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "tracing/TracingStats.h"
+
+#include <nxt/nxt_tracing.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace nxt::tracing;
+
+namespace backend { namespace null {
+    void Init(nxtProcTable* procs, nxtDevice* device);
+}}  // namespace backend::null
+
+namespace {
+
+    class TracingProcsTests : public testing::Test {
+      protected:
+        void SetUp() override {
+            nxtProcTable backendProcs;
+            backend::null::Init(&backendProcs, &device);
+            ASSERT_TRUE(nxtTracingWrapProcs(&backendProcs, &procs));
+            nxtTracingResetStats();
+        }
+
+        void TearDown() override {
+            procs.deviceRelease(device);
+        }
+
+        nxtTracingEntryPointStats GetStats(const char* name) {
+            nxtTracingEntryPointStats stats = {};
+            for (uint32_t i = 0; i < nxtTracingGetEntryPointCount(); ++i) {
+                nxtTracingGetEntryPointStats(i, &stats);
+                if (strcmp(stats.name, name) == 0) {
+                    return stats;
+                }
+            }
+            ADD_FAILURE() << "Unknown entry point " << name;
+            return stats;
+        }
+
+        nxtBuffer CreateBuffer() {
+            nxtBufferBuilder builder = procs.deviceCreateBufferBuilder(device);
+            procs.bufferBuilderSetAllowedUsage(builder, NXT_BUFFER_USAGE_BIT_TRANSFER_DST);
+            procs.bufferBuilderSetSize(builder, 64);
+            nxtBuffer buffer = procs.bufferBuilderGetResult(builder);
+            procs.bufferBuilderRelease(builder);
+            return buffer;
+        }
+
+        nxtProcTable procs;
+        nxtDevice device;
+    };
+
+}  // anonymous namespace
+
+// Test that calls are counted per entry point
+TEST_F(TracingProcsTests, CallCounts) {
+    for (int i = 0; i < 3; ++i) {
+        nxtBuffer buffer = CreateBuffer();
+        procs.bufferRelease(buffer);
+    }
+
+    EXPECT_EQ(GetStats("nxtDeviceCreateBufferBuilder").callCount, 3u);
+    EXPECT_EQ(GetStats("nxtBufferBuilderGetResult").callCount, 3u);
+    EXPECT_EQ(GetStats("nxtBufferRelease").callCount, 3u);
+    EXPECT_EQ(GetStats("nxtQueueSubmit").callCount, 0u);
+
+    // The first call is always sampled.
+    nxtTracingEntryPointStats stats = GetStats("nxtBufferBuilderGetResult");
+    EXPECT_LE(stats.p50Nanoseconds, stats.p90Nanoseconds);
+    EXPECT_LE(stats.p90Nanoseconds, stats.p99Nanoseconds);
+
+    nxtTracingResetStats();
+    EXPECT_EQ(GetStats("nxtDeviceCreateBufferBuilder").callCount, 0u);
+    EXPECT_EQ(GetStats("nxtDeviceCreateBufferBuilder").totalNanoseconds, 0u);
+}
+
+// Test that calls on other threads are counted, including after the threads exit
+TEST_F(TracingProcsTests, CallsOnOtherThreads) {
+    std::thread thread([this]() {
+        for (int i = 0; i < 40; ++i) {
+            nxtBuffer buffer = CreateBuffer();
+            procs.bufferRelease(buffer);
+        }
+    });
+    nxtBuffer buffer = CreateBuffer();
+    procs.bufferRelease(buffer);
+    thread.join();
+
+    EXPECT_EQ(GetStats("nxtBufferRelease").callCount, 41u);
+
+    nxtTracingResetStats();
+    EXPECT_EQ(GetStats("nxtBufferRelease").callCount, 0u);
+}
+
+// Test that the tracing procs can't be made to forward to another table
+TEST_F(TracingProcsTests, WrapOtherProcs) {
+    nxtProcTable otherProcs = procs;
+    nxtProcTable tracingProcs = {};
+    EXPECT_FALSE(nxtTracingWrapProcs(&otherProcs, &tracingProcs));
+    EXPECT_EQ(tracingProcs.bufferRelease, nullptr);
+}
+
+// Test that out of range entry points get zeroed statistics
+TEST_F(TracingProcsTests, OutOfRangeEntryPoint) {
+    nxtBuffer buffer = CreateBuffer();
+    procs.bufferRelease(buffer);
+
+    nxtTracingEntryPointStats stats;
+    memset(&stats, 0xFF, sizeof(stats));
+    nxtTracingGetEntryPointStats(nxtTracingGetEntryPointCount(), &stats);
+    EXPECT_EQ(stats.name, nullptr);
+    EXPECT_EQ(stats.callCount, 0u);
+    EXPECT_EQ(stats.totalNanoseconds, 0u);
+    EXPECT_EQ(stats.arrayBytes, 0u);
+}
+
+// Test that the bytes of array and string arguments are counted
+TEST_F(TracingProcsTests, ArrayBytes) {
+    nxtBuffer buffer = CreateBuffer();
+    uint32_t data[4] = {1, 2, 3, 4};
+    procs.bufferSetSubData(buffer, 0, 4, data);
+    procs.bufferSetSubData(buffer, 4, 2, data);
+    procs.bufferRelease(buffer);
+
+    nxtTracingEntryPointStats stats = GetStats("nxtBufferSetSubData");
+    EXPECT_EQ(stats.callCount, 2u);
+    EXPECT_EQ(stats.arrayBytes, 6 * sizeof(uint32_t));
+    EXPECT_EQ(GetStats("nxtBufferBuilderSetSize").arrayBytes, 0u);
+}
+
+// Test that the JSON dump contains the entry points that were called and reports its size
+TEST_F(TracingProcsTests, DumpJSON) {
+    size_t emptySize = nxtTracingDumpJSON(nullptr, 0);
+    std::vector<char> json(emptySize);
+    ASSERT_EQ(nxtTracingDumpJSON(json.data(), json.size()), emptySize);
+    ASSERT_STREQ(json.data(), "{\"entryPoints\": []}");
+
+    nxtBuffer buffer = CreateBuffer();
+    procs.bufferRelease(buffer);
+
+    size_t size = nxtTracingDumpJSON(nullptr, 0);
+    json.resize(size);
+    ASSERT_EQ(nxtTracingDumpJSON(json.data(), json.size()), size);
+    ASSERT_EQ(strlen(json.data()) + 1, size);
+
+    std::string dump(json.data());
+    EXPECT_NE(dump.find("\"name\": \"nxtBufferBuilderSetSize\", \"callCount\": 1"),
+              std::string::npos);
+    EXPECT_NE(dump.find("\"name\": \"nxtBufferRelease\", \"callCount\": 1"), std::string::npos);
+    EXPECT_EQ(dump.find("nxtQueueSubmit"), std::string::npos);
+
+    // A buffer that is too small gets a truncated, NUL-terminated dump.
+    char small[8];
+    ASSERT_EQ(nxtTracingDumpJSON(small, sizeof(small)), size);
+    ASSERT_EQ(std::string(small), dump.substr(0, 7));
+}
+
+// Test that the latency buckets cover all latencies in increasing order
+TEST(TracingLatencyBuckets, StartsMatchBuckets) {
+    for (uint32_t bucket = 0; bucket < kLatencyBucketCount; ++bucket) {
+        uint64_t start = GetLatencyBucketStart(bucket);
+        ASSERT_EQ(GetLatencyBucket(start), bucket);
+        if (bucket + 1 < kLatencyBucketCount) {
+            uint64_t nextStart = GetLatencyBucketStart(bucket + 1);
+            ASSERT_LT(start, nextStart);
+            ASSERT_EQ(GetLatencyBucket(nextStart - 1), bucket);
+        }
+    }
+    ASSERT_EQ(GetLatencyBucket(UINT64_MAX), kLatencyBucketCount - 1);
+}
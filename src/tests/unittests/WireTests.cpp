@@ -15,8 +15,17 @@
 #include "gtest/gtest.h"
 #include "mock/mock_nxt.h"
 
-#include "wire/TerribleCommandBuffer.h"
+#include "common/Math.h"
+#include "common/PollableEvent.h"
+#include "wire/BulkDataChannel.h"
+#include "wire/ChunkedCommandSerializer.h"
 #include "wire/Wire.h"
+#include "wire/WireServerThread.h"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 using namespace testing;
 using namespace nxt::wire;
@@ -52,16 +61,42 @@ static void ToMockBufferMapReadCallback(nxtBufferMapReadStatus status, const voi
     mockBufferMapReadCallback->Call(status, reinterpret_cast<const uint32_t*>(ptr), userdata);
 }
 
+class MockBufferMapReadRangesCallback {
+    public:
+        MOCK_METHOD4(Call, void(nxtBufferMapReadStatus status, uint32_t count, const void* const* data, nxtCallbackUserdata userdata));
+};
+
+static MockBufferMapReadRangesCallback* mockBufferMapReadRangesCallback = nullptr;
+static void ToMockBufferMapReadRangesCallback(nxtBufferMapReadStatus status, uint32_t count, const void* const* data, nxtCallbackUserdata userdata) {
+    mockBufferMapReadRangesCallback->Call(status, count, data, userdata);
+}
+
+class MockFenceOnCompletionCallback {
+    public:
+        MOCK_METHOD2(Call, void(nxtFenceCompletionStatus status, nxtCallbackUserdata userdata));
+};
+
+static MockFenceOnCompletionCallback* mockFenceOnCompletionCallback = nullptr;
+static void ToMockFenceOnCompletionCallback(nxtFenceCompletionStatus status, nxtCallbackUserdata userdata) {
+    mockFenceOnCompletionCallback->Call(status, userdata);
+}
+
 class WireTestsBase : public Test {
     protected:
-        WireTestsBase(bool ignoreSetCallbackCalls)
-            : mIgnoreSetCallbackCalls(ignoreSetCallbackCalls) {
+        WireTestsBase(bool ignoreSetCallbackCalls,
+                      bool useServerThread = false,
+                      bool useBulkData = false)
+            : mIgnoreSetCallbackCalls(ignoreSetCallbackCalls),
+              mUseServerThread(useServerThread),
+              mUseBulkData(useBulkData) {
         }
 
         void SetUp() override {
             mockDeviceErrorCallback = new MockDeviceErrorCallback;
             mockBuilderErrorCallback = new MockBuilderErrorCallback;
             mockBufferMapReadCallback = new MockBufferMapReadCallback;
+            mockBufferMapReadRangesCallback = new MockBufferMapReadRangesCallback;
+            mockFenceOnCompletionCallback = new MockFenceOnCompletionCallback;
 
             nxtProcTable mockProcs;
             nxtDevice mockDevice;
@@ -73,17 +108,39 @@ class WireTestsBase : public Test {
                 EXPECT_CALL(api, OnBuilderSetErrorCallback(_, _, _, _)).Times(AnyNumber());
             }
             EXPECT_CALL(api, DeviceTick(_)).Times(AnyNumber());
-
-            mS2cBuf = new TerribleCommandBuffer();
-            mC2sBuf = new TerribleCommandBuffer(mWireServer);
-
-            mWireServer = NewServerCommandHandler(mockDevice, mockProcs, mS2cBuf);
-            mC2sBuf->SetHandler(mWireServer);
+            EXPECT_CALL(api, DeviceGetCompletionFd(_)).Times(AnyNumber());
+
+            if (mUseBulkData) {
+                size_t bulkDataMemorySize =
+                    BulkDataChannel::GetRequiredMemorySize(kBulkDataSize, kBulkDataSize);
+                mBulkDataAllocation.resize(bulkDataMemorySize + 64);
+                mBulkDataMemory = AlignPtr(mBulkDataAllocation.data(), 64);
+                mBulkDataMemorySize = bulkDataMemorySize;
+
+                BulkDataChannel::Initialize(mBulkDataMemory);
+                mClientBulkData = new BulkDataChannel(mBulkDataMemory, kBulkDataSize, kBulkDataSize,
+                                                      BulkDataChannel::Side::Client);
+                mServerBulkData = new BulkDataChannel(mBulkDataMemory, kBulkDataSize, kBulkDataSize,
+                                                      BulkDataChannel::Side::Server);
+            }
 
             nxtProcTable clientProcs;
-            mWireClient = NewClientDevice(&clientProcs, &device, mC2sBuf);
+            if (mUseServerThread) {
+                mServerThread = new WireServerThread(mockDevice, mockProcs);
+                mWireClient =
+                    NewClientDevice(&clientProcs, &device, mServerThread->GetCommandSerializer());
+            } else {
+                mS2cBuf = new ChunkedCommandSerializer();
+                mC2sBuf = new ChunkedCommandSerializer(mWireServer);
+
+                mWireServer =
+                    NewServerCommandHandler(mockDevice, mockProcs, mS2cBuf, mServerBulkData);
+                mC2sBuf->SetHandler(mWireServer);
+
+                mWireClient = NewClientDevice(&clientProcs, &device, mC2sBuf, mClientBulkData);
+                mS2cBuf->SetHandler(mWireClient);
+            }
             nxtSetProcs(&clientProcs);
-            mS2cBuf->SetHandler(mWireClient);
 
             apiDevice = mockDevice;
         }
@@ -92,32 +149,62 @@ class WireTestsBase : public Test {
             nxtSetProcs(nullptr);
             delete mWireServer;
             delete mWireClient;
+            delete mServerThread;
             delete mC2sBuf;
             delete mS2cBuf;
+            delete mClientBulkData;
+            delete mServerBulkData;
             delete mockDeviceErrorCallback;
             delete mockBuilderErrorCallback;
             delete mockBufferMapReadCallback;
+            delete mockBufferMapReadRangesCallback;
+            delete mockFenceOnCompletionCallback;
         }
 
         void FlushClient() {
-            mC2sBuf->Flush();
+            if (mUseServerThread) {
+                mServerThread->GetCommandSerializer()->Flush();
+                mServerThread->WaitForIdle();
+            } else {
+                mC2sBuf->Flush();
+            }
         }
 
         void FlushServer() {
-            mS2cBuf->Flush();
+            if (mUseServerThread) {
+                mServerThread->HandleReturnCommands(mWireClient);
+            } else {
+                mS2cBuf->Flush();
+            }
         }
 
+        bool IsInBulkData(const void* pointer) const {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(pointer);
+            return bytes >= mBulkDataMemory && bytes < mBulkDataMemory + mBulkDataMemorySize;
+        }
+
+        static constexpr size_t kBulkDataSize = 64 * 1024;
+
         MockProcTable api;
         nxtDevice apiDevice;
         nxtDevice device;
 
     private:
         bool mIgnoreSetCallbackCalls = false;
+        bool mUseServerThread = false;
+        bool mUseBulkData = false;
+
+        std::vector<uint8_t> mBulkDataAllocation;
+        uint8_t* mBulkDataMemory = nullptr;
+        size_t mBulkDataMemorySize = 0;
+        BulkDataChannel* mClientBulkData = nullptr;
+        BulkDataChannel* mServerBulkData = nullptr;
 
         CommandHandler* mWireServer = nullptr;
         CommandHandler* mWireClient = nullptr;
-        TerribleCommandBuffer* mS2cBuf = nullptr;
-        TerribleCommandBuffer* mC2sBuf = nullptr;
+        ChunkedCommandSerializer* mS2cBuf = nullptr;
+        ChunkedCommandSerializer* mC2sBuf = nullptr;
+        WireServerThread* mServerThread = nullptr;
 };
 
 class WireTests : public WireTestsBase {
@@ -487,6 +574,73 @@ TEST_F(WireTests, ErrorCallbackForwardedToDevice) {
     FlushServer();
 }
 
+// Test that calls with bad enum or bitmask values are reported to the device by the client and
+// not sent to the server
+TEST_F(WireTests, BadValueCallNotSent) {
+    uint64_t userdata = 4389;
+    nxtDeviceSetErrorCallback(device, ToMockDeviceErrorCallback, userdata);
+
+    nxtBufferBuilder bufferBuilder = nxtDeviceCreateBufferBuilder(device);
+    nxtBuffer buffer = nxtBufferBuilderGetResult(bufferBuilder);
+
+    EXPECT_CALL(*mockDeviceErrorCallback,
+                Call(StrEq("Bad value in BufferTransitionUsage"), userdata))
+        .Times(1);
+    nxtBufferTransitionUsage(buffer, static_cast<nxtBufferUsageBit>(0x80000000));
+
+    nxtBufferBuilder apiBufferBuilder = api.GetNewBufferBuilder();
+    EXPECT_CALL(api, DeviceCreateBufferBuilder(apiDevice))
+        .WillOnce(Return(apiBufferBuilder));
+
+    nxtBuffer apiBuffer = api.GetNewBuffer();
+    EXPECT_CALL(api, BufferBuilderGetResult(apiBufferBuilder))
+        .WillOnce(Return(apiBuffer));
+
+    EXPECT_CALL(api, BufferTransitionUsage(_, _)).Times(0);
+
+    FlushClient();
+}
+
+// Test that errors in builder calls found by the client are reported on GetResult like the server
+// would, and that the server makes an error object without calling GetResult
+TEST_F(WireTests, BuilderBadValueReportedByClient) {
+    uint64_t userdata = 1337;
+    nxtDeviceSetErrorCallback(device, ToMockDeviceErrorCallback, userdata);
+
+    nxtBufferBuilder bufferBuilder = nxtDeviceCreateBufferBuilder(device);
+    nxtBufferBuilderSetErrorCallback(bufferBuilder, ToMockBuilderErrorCallback, 1, 2);
+    nxtBufferBuilderSetAllowedUsage(bufferBuilder, static_cast<nxtBufferUsageBit>(0x80000000));
+
+    // The builder can't be used after the error.
+    EXPECT_CALL(*mockDeviceErrorCallback,
+                Call(StrEq("Builder cannot be used after GetResult"), userdata))
+        .Times(2);
+    nxtBufferBuilderSetSize(bufferBuilder, 4);
+
+    EXPECT_CALL(*mockBuilderErrorCallback,
+                Call(NXT_BUILDER_ERROR_STATUS_ERROR,
+                     StrEq("Bad value in BufferBuilderSetAllowedUsage"), 1, 2))
+        .Times(1);
+    nxtBuffer buffer = nxtBufferBuilderGetResult(bufferBuilder);
+
+    nxtBufferBuilder apiBufferBuilder = api.GetNewBufferBuilder();
+    EXPECT_CALL(api, DeviceCreateBufferBuilder(apiDevice))
+        .WillOnce(Return(apiBufferBuilder));
+
+    EXPECT_CALL(api, BufferBuilderSetAllowedUsage(_, _)).Times(0);
+    EXPECT_CALL(api, BufferBuilderSetSize(_, _)).Times(0);
+    EXPECT_CALL(api, BufferBuilderGetResult(_)).Times(0);
+
+    // Calls on the resulting error object are skipped by the server.
+    nxtBufferTransitionUsage(buffer, NXT_BUFFER_USAGE_BIT_UNIFORM);
+    EXPECT_CALL(api, BufferTransitionUsage(_, _)).Times(0);
+
+    FlushClient();
+
+    // The error callback the server sends for the error object is ignored.
+    FlushServer();
+}
+
 class WireSetCallbackTests : public WireTestsBase {
     public:
         WireSetCallbackTests() : WireTestsBase(false) {
@@ -552,7 +706,7 @@ TEST_F(WireSetCallbackTests, BuilderErrorCallback) {
 
 class WireBufferMappingTests : public WireTestsBase {
     public:
-        WireBufferMappingTests() : WireTestsBase(true) {
+        WireBufferMappingTests(bool useBulkData = false) : WireTestsBase(true, false, useBulkData) {
         }
 
         void SetUp() override {
@@ -596,6 +750,23 @@ class WireBufferMappingTests : public WireTestsBase {
         nxtBuffer errorBuffer;
 };
 
+// Check that commands bigger than the serializer's chunks are sent correctly
+TEST_F(WireBufferMappingTests, SetSubDataBiggerThanChunk) {
+    std::vector<uint32_t> data(ChunkedCommandSerializer::kDefaultChunkSize / sizeof(uint32_t) * 2);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint32_t>(i);
+    }
+    uint32_t count = static_cast<uint32_t>(data.size());
+    nxtBufferSetSubData(buffer, 0, count, data.data());
+
+    EXPECT_CALL(api, BufferSetSubData(apiBuffer, 0, count, _))
+        .WillOnce(Invoke([&](nxtBuffer, uint32_t, uint32_t, const uint32_t* receivedData) {
+            EXPECT_EQ(memcmp(receivedData, data.data(), count * sizeof(uint32_t)), 0);
+        }));
+
+    FlushClient();
+}
+
 // Check mapping a succesfully created buffer
 TEST_F(WireBufferMappingTests, MappingSuccessBuffer) {
     nxtCallbackUserdata userdata = 8653;
@@ -724,3 +895,452 @@ TEST_F(WireBufferMappingTests, MappingErrorWhileAlreadyMappedGetsNullptr) {
 
     FlushServer();
 }
+
+// Check mapping multiple ranges in a single request, the data of each range is forwarded
+TEST_F(WireBufferMappingTests, MappingRangesSuccess) {
+    nxtBuffer buffers[] = {buffer, buffer};
+    uint32_t starts[] = {40, 80};
+    uint32_t sizes[] = {sizeof(uint32_t), 2 * sizeof(uint32_t)};
+
+    nxtCallbackUserdata userdata = 8658;
+    nxtDeviceMapReadRangesAsync(device, 2, buffers, starts, sizes, ToMockBufferMapReadRangesCallback, userdata);
+
+    uint32_t firstContent = 31337;
+    uint32_t secondContent[] = {42, 4242};
+    const void* serverData[] = {&firstContent, secondContent};
+    EXPECT_CALL(api, OnDeviceMapReadRangesAsyncCallback(apiDevice, 2, _, _, _, _))
+        .WillOnce(Invoke([&](nxtDevice, uint32_t, nxtBuffer const* apiBuffers, uint32_t const* apiStarts, uint32_t const* apiSizes, nxtCallbackUserdata) {
+            EXPECT_EQ(apiBuffers[0], apiBuffer);
+            EXPECT_EQ(apiBuffers[1], apiBuffer);
+            EXPECT_EQ(apiStarts[1], 80u);
+            EXPECT_EQ(apiSizes[1], 2 * sizeof(uint32_t));
+            api.CallMapReadRangesCallback(apiDevice, NXT_BUFFER_MAP_READ_STATUS_SUCCESS, 2, serverData);
+        }));
+
+    FlushClient();
+
+    EXPECT_CALL(*mockBufferMapReadRangesCallback, Call(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, 2u, Ne(nullptr), userdata))
+        .WillOnce(Invoke([&](nxtBufferMapReadStatus, uint32_t, const void* const* data, nxtCallbackUserdata) {
+            EXPECT_EQ(*static_cast<const uint32_t*>(data[0]), firstContent);
+            EXPECT_EQ(static_cast<const uint32_t*>(data[1])[0], secondContent[0]);
+            EXPECT_EQ(static_cast<const uint32_t*>(data[1])[1], secondContent[1]);
+        }));
+
+    FlushServer();
+
+    nxtBufferUnmap(buffer);
+    EXPECT_CALL(api, BufferUnmap(apiBuffer))
+        .Times(1);
+
+    FlushClient();
+}
+
+// Check mapping ranges of a buffer that didn't get created on the server side
+TEST_F(WireBufferMappingTests, MappingRangesErrorBuffer) {
+    nxtBuffer buffers[] = {buffer, errorBuffer};
+    uint32_t starts[] = {40, 40};
+    uint32_t sizes[] = {sizeof(uint32_t), sizeof(uint32_t)};
+
+    nxtCallbackUserdata userdata = 8659;
+    nxtDeviceMapReadRangesAsync(device, 2, buffers, starts, sizes, ToMockBufferMapReadRangesCallback, userdata);
+
+    FlushClient();
+
+    EXPECT_CALL(*mockBufferMapReadRangesCallback, Call(NXT_BUFFER_MAP_READ_STATUS_ERROR, 2u, nullptr, userdata))
+        .Times(1);
+
+    FlushServer();
+}
+
+// Check the callback is called with UNKNOWN when one of the buffers is unmapped before the result
+TEST_F(WireBufferMappingTests, MappingRangesUnmapCalledTooEarly) {
+    uint32_t start = 40;
+    uint32_t size = sizeof(uint32_t);
+
+    nxtCallbackUserdata userdata = 8660;
+    nxtDeviceMapReadRangesAsync(device, 1, &buffer, &start, &size, ToMockBufferMapReadRangesCallback, userdata);
+
+    uint32_t bufferContent = 31337;
+    const void* serverData[] = {&bufferContent};
+    EXPECT_CALL(api, OnDeviceMapReadRangesAsyncCallback(apiDevice, 1, _, _, _, _))
+        .WillOnce(InvokeWithoutArgs([&]() {
+            api.CallMapReadRangesCallback(apiDevice, NXT_BUFFER_MAP_READ_STATUS_SUCCESS, 1, serverData);
+        }));
+
+    FlushClient();
+
+    EXPECT_CALL(*mockBufferMapReadRangesCallback, Call(NXT_BUFFER_MAP_READ_STATUS_UNKNOWN, 1u, nullptr, userdata))
+        .Times(1);
+    nxtBufferUnmap(buffer);
+
+    // The callback shouldn't get called, even when the request succeeded on the server side
+    FlushServer();
+}
+
+class WireFenceTests : public WireTestsBase {
+    public:
+        WireFenceTests() : WireTestsBase(true) {
+        }
+
+        void SetUp() override {
+            WireTestsBase::SetUp();
+
+            {
+                nxtQueueBuilder apiQueueBuilder = api.GetNewQueueBuilder();
+                nxtQueueBuilder queueBuilder = nxtDeviceCreateQueueBuilder(device);
+                EXPECT_CALL(api, DeviceCreateQueueBuilder(apiDevice))
+                    .WillOnce(Return(apiQueueBuilder))
+                    .RetiresOnSaturation();
+
+                apiQueue = api.GetNewQueue();
+                queue = nxtQueueBuilderGetResult(queueBuilder);
+                EXPECT_CALL(api, QueueBuilderGetResult(apiQueueBuilder))
+                    .WillOnce(Return(apiQueue))
+                    .RetiresOnSaturation();
+                FlushClient();
+            }
+            {
+                nxtFenceBuilder apiFenceBuilder = api.GetNewFenceBuilder();
+                nxtFenceBuilder fenceBuilder = nxtDeviceCreateFenceBuilder(device);
+                EXPECT_CALL(api, DeviceCreateFenceBuilder(apiDevice))
+                    .WillOnce(Return(apiFenceBuilder))
+                    .RetiresOnSaturation();
+
+                nxtFenceBuilderSetInitialValue(fenceBuilder, 1);
+                EXPECT_CALL(api, FenceBuilderSetInitialValue(apiFenceBuilder, 1))
+                    .Times(1);
+
+                apiFence = api.GetNewFence();
+                fence = nxtFenceBuilderGetResult(fenceBuilder);
+                EXPECT_CALL(api, FenceBuilderGetResult(apiFenceBuilder))
+                    .WillOnce(Return(apiFence))
+                    .RetiresOnSaturation();
+                FlushClient();
+            }
+        }
+
+    protected:
+        // Signals the fence and makes the server-side fence complete the value
+        void SignalAndComplete(uint64_t value) {
+            nxtQueueSignal(queue, fence, value);
+            EXPECT_CALL(api, QueueSignal(apiQueue, apiFence, value))
+                .Times(1);
+            EXPECT_CALL(api, OnFenceOnCompletionCallback(apiFence, value, _))
+                .WillOnce(InvokeWithoutArgs([&]() {
+                    api.CallFenceOnCompletionCallback(apiFence, NXT_FENCE_COMPLETION_STATUS_SUCCESS);
+                }));
+            FlushClient();
+        }
+
+        nxtQueue queue;
+        nxtQueue apiQueue;
+        nxtFence fence;
+        nxtFence apiFence;
+};
+
+// Check that the completed value is known on the client without a roundtrip
+TEST_F(WireFenceTests, InitialCompletedValue) {
+    ASSERT_EQ(nxtFenceGetCompletedValue(fence), 1u);
+}
+
+// Check that the completed value and callbacks are updated when the server completes the signal
+TEST_F(WireFenceTests, SignalAndComplete) {
+    nxtCallbackUserdata userdata = 9001;
+
+    SignalAndComplete(2);
+    nxtFenceOnCompletion(fence, 2, ToMockFenceOnCompletionCallback, userdata);
+    ASSERT_EQ(nxtFenceGetCompletedValue(fence), 1u);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_SUCCESS, userdata))
+        .Times(1);
+    FlushServer();
+    ASSERT_EQ(nxtFenceGetCompletedValue(fence), 2u);
+}
+
+// Check that the client validates the signaled values and OnCompletion requests
+TEST_F(WireFenceTests, ClientSideValidation) {
+    nxtCallbackUserdata userdata = 9002;
+    nxtDeviceSetErrorCallback(device, ToMockDeviceErrorCallback, 0);
+
+    // Signaling a value that isn't increasing doesn't reach the server
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(_, _)).Times(1);
+    nxtQueueSignal(queue, fence, 1);
+    FlushClient();
+
+    // OnCompletion on a value that wasn't signaled is an error
+    EXPECT_CALL(*mockDeviceErrorCallback, Call(_, _)).Times(1);
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_ERROR, userdata))
+        .Times(1);
+    nxtFenceOnCompletion(fence, 2, ToMockFenceOnCompletionCallback, userdata);
+}
+
+// Check that pending callbacks are called with "Unknown" when the client fence is released
+TEST_F(WireFenceTests, DestroyBeforeCompletion) {
+    nxtCallbackUserdata userdata = 9003;
+
+    SignalAndComplete(2);
+    nxtFenceOnCompletion(fence, 2, ToMockFenceOnCompletionCallback, userdata);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_UNKNOWN, userdata))
+        .Times(1);
+    nxtFenceRelease(fence);
+
+    // The callback shouldn't get called again when the server completes the value
+    FlushServer();
+}
+
+class WireBulkDataTests : public WireBufferMappingTests {
+    public:
+        WireBulkDataTests() : WireBufferMappingTests(true) {
+        }
+
+    protected:
+        std::vector<uint32_t> MakeData(size_t size, uint32_t seed) {
+            std::vector<uint32_t> data(size / sizeof(uint32_t));
+            for (size_t i = 0; i < data.size(); ++i) {
+                data[i] = seed + static_cast<uint32_t>(i);
+            }
+            return data;
+        }
+
+        void ExpectSetSubData(const std::vector<uint32_t>& data, bool inBulkData) {
+            uint32_t count = static_cast<uint32_t>(data.size());
+            EXPECT_CALL(api, BufferSetSubData(apiBuffer, 0, count, _))
+                .WillOnce(Invoke([&data, count, inBulkData, this](nxtBuffer, uint32_t, uint32_t,
+                                                                  const uint32_t* receivedData) {
+                    EXPECT_EQ(IsInBulkData(receivedData), inBulkData);
+                    EXPECT_EQ(memcmp(receivedData, data.data(), count * sizeof(uint32_t)), 0);
+                }))
+                .RetiresOnSaturation();
+        }
+
+        // Maps the buffer, checks where the client gets the data from, and unmaps it.
+        void MapReadAndUnmap(const std::vector<uint32_t>& content, bool inBulkData) {
+            uint32_t size = static_cast<uint32_t>(content.size() * sizeof(uint32_t));
+            nxtBufferMapReadAsync(buffer, 0, size, ToMockBufferMapReadCallback, 1);
+
+            EXPECT_CALL(api, OnBufferMapReadAsyncCallback(apiBuffer, 0, size, _, _))
+                .WillOnce(InvokeWithoutArgs([&]() {
+                    api.CallMapReadCallback(apiBuffer, NXT_BUFFER_MAP_READ_STATUS_SUCCESS,
+                                            content.data());
+                }))
+                .RetiresOnSaturation();
+            FlushClient();
+
+            EXPECT_CALL(*mockBufferMapReadCallback, Call(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, _, 1))
+                .WillOnce(Invoke([&](nxtBufferMapReadStatus, const void* data, nxtCallbackUserdata) {
+                    EXPECT_EQ(IsInBulkData(data), inBulkData);
+                    EXPECT_EQ(memcmp(data, content.data(), size), 0);
+                }))
+                .RetiresOnSaturation();
+            FlushServer();
+
+            nxtBufferUnmap(buffer);
+            EXPECT_CALL(api, BufferUnmap(apiBuffer)).Times(1).RetiresOnSaturation();
+            FlushClient();
+        }
+};
+
+// Check that large SetSubData go through the bulk data channel and small ones are inline
+TEST_F(WireBulkDataTests, SetSubData) {
+    std::vector<uint32_t> bigData = MakeData(BulkDataChannel::kMinBulkDataSize, 1);
+    nxtBufferSetSubData(buffer, 0, static_cast<uint32_t>(bigData.size()), bigData.data());
+    ExpectSetSubData(bigData, true);
+    FlushClient();
+
+    std::vector<uint32_t> smallData = MakeData(16, 2);
+    nxtBufferSetSubData(buffer, 0, static_cast<uint32_t>(smallData.size()), smallData.data());
+    ExpectSetSubData(smallData, false);
+    FlushClient();
+}
+
+// Check that SetSubData falls back to inline data when the channel is full, and that the space
+// is reused after the server handled the commands
+TEST_F(WireBulkDataTests, SetSubDataWhenFull) {
+    std::vector<uint32_t> data0 = MakeData(kBulkDataSize / 2, 1);
+    std::vector<uint32_t> data1 = MakeData(kBulkDataSize / 2, 2);
+    std::vector<uint32_t> data2 = MakeData(kBulkDataSize / 2, 3);
+    for (const auto* data : {&data0, &data1, &data2}) {
+        nxtBufferSetSubData(buffer, 0, static_cast<uint32_t>(data->size()), data->data());
+    }
+    {
+        InSequence sequence;
+        ExpectSetSubData(data0, true);
+        ExpectSetSubData(data1, true);
+        ExpectSetSubData(data2, false);
+    }
+    FlushClient();
+
+    std::vector<uint32_t> data3 = MakeData(kBulkDataSize / 2, 4);
+    nxtBufferSetSubData(buffer, 0, static_cast<uint32_t>(data3.size()), data3.data());
+    ExpectSetSubData(data3, true);
+    FlushClient();
+}
+
+// Check that large MapReadAsync results are used from the bulk data channel, and that the space
+// is released on Unmap
+TEST_F(WireBulkDataTests, MapRead) {
+    for (uint32_t i = 0; i < 3; ++i) {
+        MapReadAndUnmap(MakeData(kBulkDataSize * 3 / 4, i), true);
+    }
+    MapReadAndUnmap(MakeData(16, 3), false);
+}
+
+// Check that bulk data for a MapReadAsync cancelled by Unmap is released
+TEST_F(WireBulkDataTests, MapReadCancelled) {
+    std::vector<uint32_t> content = MakeData(kBulkDataSize * 3 / 4, 1);
+    uint32_t size = static_cast<uint32_t>(content.size() * sizeof(uint32_t));
+    nxtBufferMapReadAsync(buffer, 0, size, ToMockBufferMapReadCallback, 1);
+
+    EXPECT_CALL(api, OnBufferMapReadAsyncCallback(apiBuffer, 0, size, _, _))
+        .WillOnce(InvokeWithoutArgs([&]() {
+            api.CallMapReadCallback(apiBuffer, NXT_BUFFER_MAP_READ_STATUS_SUCCESS, content.data());
+        }));
+    FlushClient();
+
+    EXPECT_CALL(*mockBufferMapReadCallback, Call(NXT_BUFFER_MAP_READ_STATUS_UNKNOWN, nullptr, 1))
+        .Times(1);
+    nxtBufferUnmap(buffer);
+    EXPECT_CALL(api, BufferUnmap(apiBuffer)).Times(1);
+    FlushServer();
+    FlushClient();
+
+    MapReadAndUnmap(content, true);
+}
+
+class WireServerThreadTests : public WireTestsBase {
+    public:
+        WireServerThreadTests() : WireTestsBase(true, true) {
+        }
+};
+
+// Test that calls are forwarded to the server thread
+TEST_F(WireServerThreadTests, CreateThenCall) {
+    nxtCommandBufferBuilder builder = nxtDeviceCreateCommandBufferBuilder(device);
+    nxtCommandBufferBuilderGetResult(builder);
+
+    nxtCommandBufferBuilder apiCmdBufBuilder = api.GetNewCommandBufferBuilder();
+    EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+        .WillOnce(Return(apiCmdBufBuilder));
+
+    nxtCommandBuffer apiCmdBuf = api.GetNewCommandBuffer();
+    EXPECT_CALL(api, CommandBufferBuilderGetResult(apiCmdBufBuilder))
+        .WillOnce(Return(apiCmdBuf));
+
+    FlushClient();
+}
+
+// Test that callbacks from the server thread are called on the client thread
+TEST_F(WireServerThreadTests, CallbackOnClientThread) {
+    nxtBufferBuilder bufferBuilder = nxtDeviceCreateBufferBuilder(device);
+    nxtBufferBuilderSetErrorCallback(bufferBuilder, ToMockBuilderErrorCallback, 1, 2);
+    nxtBufferBuilderGetResult(bufferBuilder);
+
+    nxtBufferBuilder apiBufferBuilder = api.GetNewBufferBuilder();
+    EXPECT_CALL(api, DeviceCreateBufferBuilder(apiDevice))
+        .WillOnce(Return(apiBufferBuilder));
+
+    std::thread::id clientThread = std::this_thread::get_id();
+    nxtBuffer apiBuffer = api.GetNewBuffer();
+    EXPECT_CALL(api, BufferBuilderGetResult(apiBufferBuilder))
+        .WillOnce(InvokeWithoutArgs([&]() -> nxtBuffer {
+            EXPECT_NE(std::this_thread::get_id(), clientThread);
+            api.CallBuilderErrorCallback(apiBufferBuilder, NXT_BUILDER_ERROR_STATUS_SUCCESS, "I like cheese");
+            return apiBuffer;
+        }));
+
+    FlushClient();
+
+    EXPECT_CALL(*mockBuilderErrorCallback, Call(NXT_BUILDER_ERROR_STATUS_SUCCESS, _ , 1 ,2))
+        .WillOnce(InvokeWithoutArgs([&]() {
+            EXPECT_EQ(std::this_thread::get_id(), clientThread);
+        }));
+
+    FlushServer();
+}
+
+// Test that many flushes in a row are all handled, in order
+TEST_F(WireServerThreadTests, ManyFlushes) {
+    // Expectations can't be set while the server thread calls the mock so they are set first.
+    {
+        InSequence sequence;
+        for (uint32_t i = 0; i < 100; ++i) {
+            nxtCommandBufferBuilder apiBuilder = api.GetNewCommandBufferBuilder();
+            EXPECT_CALL(api, DeviceCreateCommandBufferBuilder(apiDevice))
+                .WillOnce(Return(apiBuilder));
+            EXPECT_CALL(api, CommandBufferBuilderSetPushConstants(apiBuilder, NXT_SHADER_STAGE_BIT_VERTEX, i, 4, _));
+        }
+    }
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        nxtCommandBufferBuilder builder = nxtDeviceCreateCommandBufferBuilder(device);
+        nxtCommandBufferBuilderSetPushConstants(builder, NXT_SHADER_STAGE_BIT_VERTEX, i, 4, testPushConstantValues);
+        FlushClient();
+    }
+}
+
+class WireServerThreadCompletionTests : public WireTestsBase {
+    public:
+        WireServerThreadCompletionTests() : WireTestsBase(true, true) {
+        }
+
+        void SetUp() override {
+            // The server thread gets the completion fd of the device when it is created.
+            ON_CALL(api, DeviceGetCompletionFd(_)).WillByDefault(Return(completionEvent.GetFd()));
+            WireTestsBase::SetUp();
+        }
+
+    protected:
+        PollableEvent completionEvent;
+};
+
+// Test that the server ticks the device when its completion fd becomes readable, so that the
+// callbacks reach the client without it flushing commands
+TEST_F(WireServerThreadCompletionTests, TickOnCompletion) {
+    // There are no pollable fds on this platform.
+    if (completionEvent.GetFd() < 0) {
+        return;
+    }
+
+    nxtBufferBuilder bufferBuilder = nxtDeviceCreateBufferBuilder(device);
+    nxtBuffer buffer = nxtBufferBuilderGetResult(bufferBuilder);
+
+    nxtBufferBuilder apiBufferBuilder = api.GetNewBufferBuilder();
+    EXPECT_CALL(api, DeviceCreateBufferBuilder(apiDevice))
+        .WillOnce(Return(apiBufferBuilder));
+
+    nxtBuffer apiBuffer = api.GetNewBuffer();
+    EXPECT_CALL(api, BufferBuilderGetResult(apiBufferBuilder))
+        .WillOnce(Return(apiBuffer));
+
+    // The map read completes at the first tick after it was requested, like on a real backend.
+    nxtCallbackUserdata userdata = 8656;
+    nxtBufferMapReadAsync(buffer, 0, sizeof(uint32_t), ToMockBufferMapReadCallback, userdata);
+
+    bool mapRequested = false;
+    EXPECT_CALL(api, OnBufferMapReadAsyncCallback(apiBuffer, 0, sizeof(uint32_t), _, _))
+        .WillOnce(InvokeWithoutArgs([&]() { mapRequested = true; }));
+
+    uint32_t bufferContent = 31337;
+    EXPECT_CALL(api, DeviceTick(apiDevice))
+        .WillRepeatedly(InvokeWithoutArgs([&]() {
+            completionEvent.Clear();
+            if (mapRequested) {
+                mapRequested = false;
+                api.CallMapReadCallback(apiBuffer, NXT_BUFFER_MAP_READ_STATUS_SUCCESS, &bufferContent);
+            }
+        }));
+
+    FlushClient();
+
+    bool called = false;
+    EXPECT_CALL(*mockBufferMapReadCallback, Call(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, Pointee(Eq(bufferContent)), userdata))
+        .WillOnce(InvokeWithoutArgs([&]() { called = true; }));
+
+    completionEvent.Signal();
+    for (uint32_t i = 0; i < 5000 && !called; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        FlushServer();
+    }
+    ASSERT_TRUE(called);
+}
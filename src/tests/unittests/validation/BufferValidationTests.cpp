@@ -29,6 +29,16 @@ static void ToMockBufferMapReadCallback(nxtBufferMapReadStatus status, const voi
     mockBufferMapReadCallback->Call(status, reinterpret_cast<const uint32_t*>(ptr), userdata);
 }
 
+class MockBufferMapReadRangesCallback {
+    public:
+        MOCK_METHOD4(Call, void(nxtBufferMapReadStatus status, uint32_t count, const void* const* data, nxtCallbackUserdata userdata));
+};
+
+static MockBufferMapReadRangesCallback* mockBufferMapReadRangesCallback = nullptr;
+static void ToMockBufferMapReadRangesCallback(nxtBufferMapReadStatus status, uint32_t count, const void* const* data, nxtCallbackUserdata userdata) {
+    mockBufferMapReadRangesCallback->Call(status, count, data, userdata);
+}
+
 class BufferValidationTest : public ValidationTest {
     protected:
         nxt::Buffer CreateMapReadBuffer(uint32_t size) {
@@ -53,11 +63,13 @@ class BufferValidationTest : public ValidationTest {
             ValidationTest::SetUp();
 
             mockBufferMapReadCallback = new MockBufferMapReadCallback;
+            mockBufferMapReadRangesCallback = new MockBufferMapReadRangesCallback;
             queue = device.CreateQueueBuilder().GetResult();
         }
 
         void TearDown() override {
             delete mockBufferMapReadCallback;
+            delete mockBufferMapReadRangesCallback;
 
             ValidationTest::TearDown();
         }
@@ -290,6 +302,91 @@ TEST_F(BufferValidationTest, MapReadUnmapBeforeResultThenMapAgain) {
     queue.Submit(0, nullptr);
 }
 
+// Test the success case for mapping multiple ranges of multiple buffers in a single request
+TEST_F(BufferValidationTest, MapReadRangesSuccess) {
+    nxt::Buffer buf1 = CreateMapReadBuffer(16);
+    nxt::Buffer buf2 = CreateMapReadBuffer(16);
+
+    nxt::Buffer buffers[] = {buf1.Clone(), buf2.Clone(), buf1.Clone()};
+    uint32_t starts[] = {0, 4, 8};
+    uint32_t sizes[] = {4, 8, 4};
+
+    nxt::CallbackUserdata userdata = 40607;
+    device.MapReadRangesAsync(3, buffers, starts, sizes, ToMockBufferMapReadRangesCallback, userdata);
+
+    // There is a single callback, with a pointer for each range. Ranges of the same buffer are
+    // from the same mapping.
+    EXPECT_CALL(*mockBufferMapReadRangesCallback, Call(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, 3u, Ne(nullptr), userdata))
+        .WillOnce(Invoke([](nxtBufferMapReadStatus, uint32_t, const void* const* data, nxtCallbackUserdata) {
+            ASSERT_NE(data[0], nullptr);
+            ASSERT_NE(data[1], nullptr);
+            ASSERT_EQ(static_cast<const uint8_t*>(data[2]) - static_cast<const uint8_t*>(data[0]), 8);
+        }));
+    queue.Submit(0, nullptr);
+
+    // All the buffers are mapped
+    buf1.Unmap();
+    buf2.Unmap();
+}
+
+// Test that an invalid range makes the whole request fail without mapping any buffer
+TEST_F(BufferValidationTest, MapReadRangesOutOfRange) {
+    nxt::Buffer buf1 = CreateMapReadBuffer(16);
+    nxt::Buffer buf2 = CreateMapReadBuffer(16);
+
+    nxt::Buffer buffers[] = {buf1.Clone(), buf2.Clone()};
+    uint32_t starts[] = {0, 12};
+    uint32_t sizes[] = {4, 8};
+
+    nxt::CallbackUserdata userdata = 40608;
+    EXPECT_CALL(*mockBufferMapReadRangesCallback, Call(NXT_BUFFER_MAP_READ_STATUS_ERROR, 2u, nullptr, userdata))
+        .Times(1);
+    ASSERT_DEVICE_ERROR(device.MapReadRangesAsync(2, buffers, starts, sizes, ToMockBufferMapReadRangesCallback, userdata));
+
+    // buf1 wasn't mapped
+    ASSERT_DEVICE_ERROR(buf1.Unmap());
+}
+
+// Test mapping ranges of a buffer that is already mapped
+TEST_F(BufferValidationTest, MapReadRangesAlreadyMapped) {
+    nxt::Buffer buf = CreateMapReadBuffer(16);
+
+    nxt::CallbackUserdata userdata1 = 40609;
+    buf.MapReadAsync(0, 4, ToMockBufferMapReadCallback, userdata1);
+    EXPECT_CALL(*mockBufferMapReadCallback, Call(NXT_BUFFER_MAP_READ_STATUS_SUCCESS, Ne(nullptr), userdata1))
+        .Times(1);
+
+    uint32_t start = 4;
+    uint32_t size = 4;
+    nxt::CallbackUserdata userdata2 = 40610;
+    EXPECT_CALL(*mockBufferMapReadRangesCallback, Call(NXT_BUFFER_MAP_READ_STATUS_ERROR, 1u, nullptr, userdata2))
+        .Times(1);
+    ASSERT_DEVICE_ERROR(device.MapReadRangesAsync(1, &buf, &start, &size, ToMockBufferMapReadRangesCallback, userdata2));
+
+    queue.Submit(0, nullptr);
+}
+
+// Test unmapping one of the buffers before having the result gives UNKNOWN
+TEST_F(BufferValidationTest, MapReadRangesUnmapBeforeResult) {
+    nxt::Buffer buf1 = CreateMapReadBuffer(16);
+    nxt::Buffer buf2 = CreateMapReadBuffer(16);
+
+    nxt::Buffer buffers[] = {buf1.Clone(), buf2.Clone()};
+    uint32_t starts[] = {0, 0};
+    uint32_t sizes[] = {4, 4};
+
+    nxt::CallbackUserdata userdata = 40611;
+    device.MapReadRangesAsync(2, buffers, starts, sizes, ToMockBufferMapReadRangesCallback, userdata);
+    buf1.Unmap();
+
+    // The callback is called once the other buffer completes
+    EXPECT_CALL(*mockBufferMapReadRangesCallback, Call(NXT_BUFFER_MAP_READ_STATUS_UNKNOWN, 2u, nullptr, userdata))
+        .Times(1);
+    queue.Submit(0, nullptr);
+
+    buf2.Unmap();
+}
+
 // Test the success case for Buffer::SetSubData
 TEST_F(BufferValidationTest, SetSubDataSuccess) {
     nxt::Buffer buf = CreateSetSubDataBuffer(4);
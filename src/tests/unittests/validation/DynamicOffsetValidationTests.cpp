@@ -0,0 +1,169 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/unittests/validation/ValidationTest.h"
+
+#include "utils/NXTHelpers.h"
+
+constexpr static uint32_t kBufferSize = 1024;
+constexpr static uint32_t kViewSize = 256;
+
+class DynamicOffsetValidationTest : public ValidationTest {
+    protected:
+        void SetUp() override {
+            ValidationTest::SetUp();
+
+            layout = device.CreateBindGroupLayoutBuilder()
+                .SetBindingsType(nxt::ShaderStageBit::Compute, nxt::BindingType::DynamicUniformBuffer, 0, 1)
+                .SetBindingsType(nxt::ShaderStageBit::Compute, nxt::BindingType::DynamicStorageBuffer, 1, 1)
+                .GetResult();
+
+            nxt::Buffer uniformBuffer = MakeFrozenBuffer(nxt::BufferUsageBit::Uniform);
+            nxt::Buffer storageBuffer = MakeFrozenBuffer(nxt::BufferUsageBit::Storage);
+            nxt::BufferView views[2] = {
+                uniformBuffer.CreateBufferViewBuilder().SetExtent(0, kViewSize).GetResult(),
+                storageBuffer.CreateBufferViewBuilder().SetExtent(0, kViewSize).GetResult(),
+            };
+
+            bindGroup = AssertWillBeSuccess(device.CreateBindGroupBuilder())
+                .SetLayout(layout)
+                .SetUsage(nxt::BindGroupUsage::Frozen)
+                .SetBufferViews(0, 2, views)
+                .GetResult();
+
+            nxt::ShaderModule csModule = utils::CreateShaderModule(device, nxt::ShaderStage::Compute, R"(
+                #version 450
+                layout(set = 0, binding = 0) uniform UniformBlock {
+                    uint value;
+                } uniformBlock;
+                layout(set = 0, binding = 1) buffer StorageBlock {
+                    uint value;
+                } storageBlock;
+                void main() {
+                    storageBlock.value = uniformBlock.value;
+                })"
+            );
+
+            computePipeline = device.CreateComputePipelineBuilder()
+                .SetLayout(device.CreatePipelineLayoutBuilder().SetBindGroupLayout(0, layout).GetResult())
+                .SetStage(nxt::ShaderStage::Compute, csModule, "main")
+                .GetResult();
+        }
+
+        nxt::Buffer MakeFrozenBuffer(nxt::BufferUsageBit usage) {
+            nxt::Buffer buffer = device.CreateBufferBuilder()
+                .SetSize(kBufferSize)
+                .SetAllowedUsage(usage)
+                .GetResult();
+            buffer.FreezeUsage(usage);
+            return buffer;
+        }
+
+        void TestDispatch(bool success, uint32_t dynamicOffsetCount, const uint32_t* dynamicOffsets) {
+            nxt::CommandBufferBuilder builder;
+            if (success) {
+                builder = AssertWillBeSuccess(device.CreateCommandBufferBuilder());
+            } else {
+                builder = AssertWillBeError(device.CreateCommandBufferBuilder());
+            }
+            builder.BeginComputePass()
+                .SetComputePipeline(computePipeline)
+                .SetBindGroup(0, bindGroup, dynamicOffsetCount, dynamicOffsets)
+                .Dispatch(1, 1, 1)
+                .EndComputePass()
+                .GetResult();
+        }
+
+        nxt::BindGroupLayout layout;
+        nxt::BindGroup bindGroup;
+        nxt::ComputePipeline computePipeline;
+};
+
+// Test that dynamic buffers are compatible with the static blocks of the shader and that the same
+// bind group can be set with different offsets
+TEST_F(DynamicOffsetValidationTest, Success) {
+    uint32_t offsets1[2] = {0, 0};
+    uint32_t offsets2[2] = {256, 512};
+
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .BeginComputePass()
+            .SetComputePipeline(computePipeline)
+            .SetBindGroup(0, bindGroup, 2, offsets1)
+            .Dispatch(1, 1, 1)
+            .SetBindGroup(0, bindGroup, 2, offsets2)
+            .Dispatch(1, 1, 1)
+        .EndComputePass()
+        .GetResult();
+}
+
+// Test that there must be exactly one offset per dynamic buffer of the layout
+TEST_F(DynamicOffsetValidationTest, OffsetCountMismatch) {
+    uint32_t offsets[3] = {0, 0, 0};
+
+    TestDispatch(true, 2, offsets);
+    TestDispatch(false, 0, nullptr);
+    TestDispatch(false, 1, offsets);
+    TestDispatch(false, 3, offsets);
+}
+
+// Test that the offsets must be aligned
+TEST_F(DynamicOffsetValidationTest, UnalignedOffset) {
+    uint32_t uniformUnaligned[2] = {4, 0};
+    uint32_t storageUnaligned[2] = {0, 128};
+
+    TestDispatch(false, 2, uniformUnaligned);
+    TestDispatch(false, 2, storageUnaligned);
+}
+
+// Test that the offset views must stay inside their buffers
+TEST_F(DynamicOffsetValidationTest, OffsetOOB) {
+    uint32_t lastView[2] = {kBufferSize - kViewSize, kBufferSize - kViewSize};
+    uint32_t uniformOOB[2] = {kBufferSize, 0};
+    uint32_t storageOOB[2] = {0, kBufferSize - kViewSize + 256};
+    uint32_t overflow[2] = {0xFFFFFF00, 0};
+
+    TestDispatch(true, 2, lastView);
+    TestDispatch(false, 2, uniformOOB);
+    TestDispatch(false, 2, storageOOB);
+    TestDispatch(false, 2, overflow);
+}
+
+// Test that bind groups without dynamic buffers take no offsets
+TEST_F(DynamicOffsetValidationTest, StaticBindGroup) {
+    nxt::BindGroupLayout staticLayout = device.CreateBindGroupLayoutBuilder()
+        .SetBindingsType(nxt::ShaderStageBit::Compute, nxt::BindingType::UniformBuffer, 0, 1)
+        .GetResult();
+
+    nxt::Buffer buffer = MakeFrozenBuffer(nxt::BufferUsageBit::Uniform);
+    nxt::BufferView view = buffer.CreateBufferViewBuilder().SetExtent(0, kViewSize).GetResult();
+    nxt::BindGroup staticGroup = device.CreateBindGroupBuilder()
+        .SetLayout(staticLayout)
+        .SetUsage(nxt::BindGroupUsage::Frozen)
+        .SetBufferViews(0, 1, &view)
+        .GetResult();
+
+    uint32_t offset = 0;
+
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .BeginComputePass()
+            .SetBindGroup(0, staticGroup, 0, nullptr)
+        .EndComputePass()
+        .GetResult();
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginComputePass()
+            .SetBindGroup(0, staticGroup, 1, &offset)
+        .EndComputePass()
+        .GetResult();
+}
@@ -0,0 +1,165 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/unittests/validation/ValidationTest.h"
+
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+class MockFenceOnCompletionCallback {
+    public:
+        MOCK_METHOD2(Call, void(nxtFenceCompletionStatus status, nxtCallbackUserdata userdata));
+};
+
+static MockFenceOnCompletionCallback* mockFenceOnCompletionCallback = nullptr;
+static void ToMockFenceOnCompletionCallback(nxtFenceCompletionStatus status, nxtCallbackUserdata userdata) {
+    mockFenceOnCompletionCallback->Call(status, userdata);
+}
+
+class FenceValidationTest : public ValidationTest {
+    protected:
+        nxt::Fence MakeFence(uint64_t initialValue) {
+            return AssertWillBeSuccess(device.CreateFenceBuilder())
+                .SetInitialValue(initialValue)
+                .GetResult();
+        }
+
+        nxt::Queue queue;
+
+    private:
+        void SetUp() override {
+            ValidationTest::SetUp();
+
+            mockFenceOnCompletionCallback = new MockFenceOnCompletionCallback;
+            queue = device.CreateQueueBuilder().GetResult();
+        }
+
+        void TearDown() override {
+            delete mockFenceOnCompletionCallback;
+
+            ValidationTest::TearDown();
+        }
+};
+
+// Test the creation of fences
+TEST_F(FenceValidationTest, Creation) {
+    // The initial value is optional and defaults to 0
+    {
+        nxt::Fence fence = AssertWillBeSuccess(device.CreateFenceBuilder()).GetResult();
+        ASSERT_EQ(fence.GetCompletedValue(), 0u);
+    }
+
+    {
+        nxt::Fence fence = MakeFence(1);
+        ASSERT_EQ(fence.GetCompletedValue(), 1u);
+    }
+
+    // The initial value can't be set twice
+    AssertWillBeError(device.CreateFenceBuilder())
+        .SetInitialValue(1)
+        .SetInitialValue(2)
+        .GetResult();
+}
+
+// Test that the completed value is updated and the callbacks called when the signal completes
+TEST_F(FenceValidationTest, SignalAndComplete) {
+    nxt::Fence fence = MakeFence(1);
+
+    queue.Signal(fence, 2);
+    fence.OnCompletion(2, ToMockFenceOnCompletionCallback, 40);
+    ASSERT_EQ(fence.GetCompletedValue(), 1u);
+
+    // Submitting the queue makes the null backend complete the signal
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_SUCCESS, 40))
+        .Times(1);
+    queue.Submit(0, nullptr);
+    ASSERT_EQ(fence.GetCompletedValue(), 2u);
+}
+
+// Test that OnCompletion on an already completed value calls the callback immediately
+TEST_F(FenceValidationTest, OnCompletionAlreadyCompleted) {
+    nxt::Fence fence = MakeFence(2);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_SUCCESS, 41))
+        .Times(1);
+    fence.OnCompletion(1, ToMockFenceOnCompletionCallback, 41);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_SUCCESS, 42))
+        .Times(1);
+    fence.OnCompletion(2, ToMockFenceOnCompletionCallback, 42);
+}
+
+// Test that OnCompletion on a value that wasn't signaled is an error
+TEST_F(FenceValidationTest, OnCompletionLargerThanSignaled) {
+    nxt::Fence fence = MakeFence(1);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_ERROR, 43))
+        .Times(1);
+    ASSERT_DEVICE_ERROR(fence.OnCompletion(2, ToMockFenceOnCompletionCallback, 43));
+
+    // Signaled but not completed values are fine
+    queue.Signal(fence, 2);
+    fence.OnCompletion(2, ToMockFenceOnCompletionCallback, 44);
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_SUCCESS, 44))
+        .Times(1);
+    queue.Submit(0, nullptr);
+}
+
+// Test that signaled values must be strictly increasing
+TEST_F(FenceValidationTest, SignalValueMustIncrease) {
+    nxt::Fence fence = MakeFence(1);
+
+    ASSERT_DEVICE_ERROR(queue.Signal(fence, 0));
+    ASSERT_DEVICE_ERROR(queue.Signal(fence, 1));
+
+    queue.Signal(fence, 2);
+    ASSERT_DEVICE_ERROR(queue.Signal(fence, 2));
+    queue.Signal(fence, 3);
+}
+
+// Test that callbacks are called in the order of their values, and that each signal only
+// completes the requests it reaches
+TEST_F(FenceValidationTest, MultipleSignals) {
+    nxt::Fence fence = MakeFence(0);
+
+    queue.Signal(fence, 1);
+    queue.Signal(fence, 3);
+    fence.OnCompletion(3, ToMockFenceOnCompletionCallback, 46);
+    fence.OnCompletion(1, ToMockFenceOnCompletionCallback, 45);
+
+    {
+        InSequence sequence;
+        EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_SUCCESS, 45))
+            .Times(1);
+        EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_SUCCESS, 46))
+            .Times(1);
+    }
+    queue.Submit(0, nullptr);
+    ASSERT_EQ(fence.GetCompletedValue(), 3u);
+}
+
+// Test that the queue keeps the fence alive until its signal completes
+TEST_F(FenceValidationTest, DropFenceBeforeCompletion) {
+    nxt::Fence fence = MakeFence(0);
+
+    queue.Signal(fence, 1);
+    fence.OnCompletion(1, ToMockFenceOnCompletionCallback, 47);
+    fence = nxt::Fence();
+
+    EXPECT_CALL(*mockFenceOnCompletionCallback, Call(NXT_FENCE_COMPLETION_STATUS_SUCCESS, 47))
+        .Times(1);
+    queue.Submit(0, nullptr);
+}
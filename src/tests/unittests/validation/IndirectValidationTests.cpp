@@ -0,0 +1,157 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/unittests/validation/ValidationTest.h"
+
+#include "utils/NXTHelpers.h"
+
+class IndirectValidationTest : public ValidationTest {
+    protected:
+        void SetUp() override {
+            ValidationTest::SetUp();
+
+            renderpassData = CreateDummyRenderPass();
+
+            nxt::ShaderModule vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                void main() {
+                    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+                })"
+            );
+
+            nxt::ShaderModule fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = vec4(0.0, 1.0, 0.0, 1.0);
+                })"
+            );
+
+            nxt::ShaderModule csModule = utils::CreateShaderModule(device, nxt::ShaderStage::Compute, R"(
+                #version 450
+                void main() {
+                })"
+            );
+
+            renderPipeline = device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderpassData.renderPass, 0)
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .GetResult();
+
+            computePipeline = device.CreateComputePipelineBuilder()
+                .SetLayout(device.CreatePipelineLayoutBuilder().GetResult())
+                .SetStage(nxt::ShaderStage::Compute, csModule, "main")
+                .GetResult();
+
+            indirectBuffer = MakeFrozenBuffer(nxt::BufferUsageBit::Indirect);
+            indexBuffer = MakeFrozenBuffer(nxt::BufferUsageBit::Index);
+        }
+
+        nxt::Buffer MakeFrozenBuffer(nxt::BufferUsageBit usage) {
+            nxt::Buffer buffer = device.CreateBufferBuilder()
+                .SetSize(kBufferSize)
+                .SetAllowedUsage(usage)
+                .GetResult();
+            buffer.FreezeUsage(usage);
+            return buffer;
+        }
+
+        void TestDispatchIndirect(bool success, const nxt::Buffer& buffer, uint32_t offset) {
+            nxt::CommandBufferBuilder builder;
+            if (success) {
+                builder = AssertWillBeSuccess(device.CreateCommandBufferBuilder());
+            } else {
+                builder = AssertWillBeError(device.CreateCommandBufferBuilder());
+            }
+            builder.BeginComputePass()
+                .SetComputePipeline(computePipeline)
+                .DispatchIndirect(buffer, offset)
+                .EndComputePass()
+                .GetResult();
+        }
+
+        void TestDrawIndirect(bool success, bool indexed, const nxt::Buffer& buffer,
+                              uint32_t offset, uint32_t indexBufferOffset = 0) {
+            nxt::CommandBufferBuilder builder;
+            if (success) {
+                builder = AssertWillBeSuccess(device.CreateCommandBufferBuilder());
+            } else {
+                builder = AssertWillBeError(device.CreateCommandBufferBuilder());
+            }
+            builder.BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+                .BeginRenderSubpass()
+                .SetRenderPipeline(renderPipeline);
+            if (indexed) {
+                builder.SetIndexBuffer(indexBuffer, indexBufferOffset)
+                    .DrawElementsIndirect(buffer, offset);
+            } else {
+                builder.DrawArraysIndirect(buffer, offset);
+            }
+            builder.EndRenderSubpass()
+                .EndRenderPass()
+                .GetResult();
+        }
+
+        static constexpr uint32_t kBufferSize = 64;
+
+        DummyRenderPass renderpassData;
+        nxt::RenderPipeline renderPipeline;
+        nxt::ComputePipeline computePipeline;
+        nxt::Buffer indirectBuffer;
+        nxt::Buffer indexBuffer;
+};
+
+// Test the indirect commands with valid arguments
+TEST_F(IndirectValidationTest, Success) {
+    TestDispatchIndirect(true, indirectBuffer, 0);
+    TestDispatchIndirect(true, indirectBuffer, kBufferSize - 3 * sizeof(uint32_t));
+    TestDrawIndirect(true, false, indirectBuffer, 0);
+    TestDrawIndirect(true, false, indirectBuffer, kBufferSize - 4 * sizeof(uint32_t));
+    TestDrawIndirect(true, true, indirectBuffer, 0);
+    TestDrawIndirect(true, true, indirectBuffer, kBufferSize - 5 * sizeof(uint32_t));
+}
+
+// Test that the buffer must have the indirect usage
+TEST_F(IndirectValidationTest, BufferUsage) {
+    nxt::Buffer vertexBuffer = MakeFrozenBuffer(nxt::BufferUsageBit::Vertex);
+    TestDispatchIndirect(false, vertexBuffer, 0);
+    TestDrawIndirect(false, false, vertexBuffer, 0);
+    TestDrawIndirect(false, true, vertexBuffer, 0);
+}
+
+// Test that the indirect offset must be a multiple of 4
+TEST_F(IndirectValidationTest, OffsetAlignment) {
+    TestDispatchIndirect(false, indirectBuffer, 2);
+    TestDrawIndirect(false, false, indirectBuffer, 2);
+    TestDrawIndirect(false, true, indirectBuffer, 2);
+}
+
+// Test that the arguments must fit in the buffer
+TEST_F(IndirectValidationTest, ArgumentsOOB) {
+    TestDispatchIndirect(false, indirectBuffer, kBufferSize - 2 * sizeof(uint32_t));
+    TestDispatchIndirect(false, indirectBuffer, kBufferSize + 4);
+    TestDrawIndirect(false, false, indirectBuffer, kBufferSize - 3 * sizeof(uint32_t));
+    TestDrawIndirect(false, true, indirectBuffer, kBufferSize - 4 * sizeof(uint32_t));
+
+    // Check for overflows in the computation of the end of the arguments
+    TestDispatchIndirect(false, indirectBuffer, 0xFFFFFFFC);
+    TestDrawIndirect(false, false, indirectBuffer, 0xFFFFFFFC);
+}
+
+// Test that DrawElementsIndirect requires an index buffer set at offset 0
+TEST_F(IndirectValidationTest, IndexBufferOffset) {
+    TestDrawIndirect(true, true, indirectBuffer, 0, 0);
+    TestDrawIndirect(false, true, indirectBuffer, 0, 4);
+}
@@ -0,0 +1,118 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/unittests/validation/ValidationTest.h"
+
+#include "utils/NXTHelpers.h"
+
+class MultiDrawValidationTest : public ValidationTest {
+    protected:
+        void SetUp() override {
+            ValidationTest::SetUp();
+
+            renderpassData = CreateDummyRenderPass();
+
+            nxt::ShaderModule vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                void main() {
+                    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+                })"
+            );
+
+            nxt::ShaderModule fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = vec4(0.0, 1.0, 0.0, 1.0);
+                })"
+            );
+
+            renderPipeline = device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderpassData.renderPass, 0)
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .GetResult();
+
+            indexBuffer = device.CreateBufferBuilder()
+                .SetSize(64)
+                .SetAllowedUsage(nxt::BufferUsageBit::Index)
+                .GetResult();
+            indexBuffer.FreezeUsage(nxt::BufferUsageBit::Index);
+        }
+
+        // Records a multi-draw of kDrawCount draws, optionally without a pipeline or index buffer
+        void TestMultiDraw(bool success, bool indexed, bool setPipeline, bool setIndexBuffer) {
+            nxt::CommandBufferBuilder builder;
+            if (success) {
+                builder = AssertWillBeSuccess(device.CreateCommandBufferBuilder());
+            } else {
+                builder = AssertWillBeError(device.CreateCommandBufferBuilder());
+            }
+            builder.BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+                .BeginRenderSubpass();
+            if (setPipeline) {
+                builder.SetRenderPipeline(renderPipeline);
+            }
+            if (setIndexBuffer) {
+                builder.SetIndexBuffer(indexBuffer, 0);
+            }
+            if (indexed) {
+                builder.MultiDrawElements(kDrawCount, counts, instanceCounts, firsts, firstInstances);
+            } else {
+                builder.MultiDrawArrays(kDrawCount, counts, instanceCounts, firsts, firstInstances);
+            }
+            builder.EndRenderSubpass()
+                .EndRenderPass()
+                .GetResult();
+        }
+
+        static constexpr uint32_t kDrawCount = 3;
+        const uint32_t counts[kDrawCount] = {3, 6, 3};
+        const uint32_t instanceCounts[kDrawCount] = {1, 1, 2};
+        const uint32_t firsts[kDrawCount] = {0, 3, 9};
+        const uint32_t firstInstances[kDrawCount] = {0, 0, 1};
+
+        DummyRenderPass renderpassData;
+        nxt::RenderPipeline renderPipeline;
+        nxt::Buffer indexBuffer;
+};
+
+// Test the multi-draw commands with a complete state
+TEST_F(MultiDrawValidationTest, Success) {
+    TestMultiDraw(true, false, true, false);
+    TestMultiDraw(true, true, true, true);
+}
+
+// Test that the multi-draw commands require a render pipeline
+TEST_F(MultiDrawValidationTest, NoPipeline) {
+    TestMultiDraw(false, false, false, false);
+    TestMultiDraw(false, true, false, true);
+}
+
+// Test that MultiDrawElements requires an index buffer
+TEST_F(MultiDrawValidationTest, NoIndexBuffer) {
+    TestMultiDraw(false, true, true, false);
+}
+
+// Test that a multi-draw with no draws is valid
+TEST_F(MultiDrawValidationTest, ZeroDraws) {
+    nxt::CommandBuffer commandBuffer = AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+        .SetRenderPipeline(renderPipeline)
+        .MultiDrawArrays(0, nullptr, nullptr, nullptr, nullptr)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+}
@@ -0,0 +1,267 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/Constants.h"
+#include "tests/unittests/validation/ValidationTest.h"
+
+class QuerySetValidationTest : public ValidationTest {
+    protected:
+        void SetUp() override {
+            ValidationTest::SetUp();
+
+            renderpassData = CreateDummyRenderPass();
+        }
+
+        nxt::QuerySet MakeQuerySet(nxt::QueryType type, uint32_t count) {
+            return AssertWillBeSuccess(device.CreateQuerySetBuilder())
+                .SetType(type)
+                .SetCount(count)
+                .GetResult();
+        }
+
+        nxt::Buffer CreateFrozenBuffer(uint32_t size, nxt::BufferUsageBit usage) {
+            nxt::Buffer buf = AssertWillBeSuccess(device.CreateBufferBuilder())
+                .SetSize(size)
+                .SetAllowedUsage(usage)
+                .GetResult();
+            buf.FreezeUsage(usage);
+            return buf;
+        }
+
+        DummyRenderPass renderpassData;
+};
+
+// Test the creation of query sets
+TEST_F(QuerySetValidationTest, Creation) {
+    MakeQuerySet(nxt::QueryType::Occlusion, 1);
+    MakeQuerySet(nxt::QueryType::PipelineStatistics, 16);
+    MakeQuerySet(nxt::QueryType::Timestamp, kMaxQueriesPerSet);
+
+    // Type and count are required
+    AssertWillBeError(device.CreateQuerySetBuilder())
+        .SetCount(1)
+        .GetResult();
+    AssertWillBeError(device.CreateQuerySetBuilder())
+        .SetType(nxt::QueryType::Timestamp)
+        .GetResult();
+
+    // Count must be in [1, kMaxQueriesPerSet]
+    AssertWillBeError(device.CreateQuerySetBuilder())
+        .SetType(nxt::QueryType::Timestamp)
+        .SetCount(0)
+        .GetResult();
+    AssertWillBeError(device.CreateQuerySetBuilder())
+        .SetType(nxt::QueryType::Timestamp)
+        .SetCount(kMaxQueriesPerSet + 1)
+        .GetResult();
+}
+
+// Test that timestamps can only be written in timestamp query sets, inside the set
+TEST_F(QuerySetValidationTest, WriteTimestamp) {
+    nxt::QuerySet timestamps = MakeQuerySet(nxt::QueryType::Timestamp, 2);
+    nxt::QuerySet occlusion = MakeQuerySet(nxt::QueryType::Occlusion, 2);
+
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .WriteTimestamp(timestamps, 0)
+        .BeginComputePass()
+        .EndComputePass()
+        .WriteTimestamp(timestamps, 1)
+        .GetResult();
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .WriteTimestamp(timestamps, 2)
+        .GetResult();
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .WriteTimestamp(occlusion, 0)
+        .GetResult();
+}
+
+// Test that occlusion queries are only allowed in render subpasses
+TEST_F(QuerySetValidationTest, OcclusionQueryInSubpass) {
+    nxt::QuerySet occlusion = MakeQuerySet(nxt::QueryType::Occlusion, 2);
+
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .BeginQuery(occlusion, 0)
+            .EndQuery(occlusion, 0)
+            .BeginQuery(occlusion, 1)
+            .EndQuery(occlusion, 1)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginQuery(occlusion, 0)
+        .EndQuery(occlusion, 0)
+        .GetResult();
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginComputePass()
+            .BeginQuery(occlusion, 0)
+            .EndQuery(occlusion, 0)
+        .EndComputePass()
+        .GetResult();
+}
+
+// Test that pipeline statistics queries are allowed in render subpasses and compute passes
+TEST_F(QuerySetValidationTest, PipelineStatisticsQueryInPass) {
+    nxt::QuerySet statistics = MakeQuerySet(nxt::QueryType::PipelineStatistics, 2);
+
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .BeginQuery(statistics, 0)
+            .EndQuery(statistics, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .BeginComputePass()
+            .BeginQuery(statistics, 1)
+            .EndQuery(statistics, 1)
+        .EndComputePass()
+        .GetResult();
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginQuery(statistics, 0)
+        .EndQuery(statistics, 0)
+        .GetResult();
+}
+
+// Test the rules for the scopes of queries
+TEST_F(QuerySetValidationTest, QueryScopes) {
+    nxt::QuerySet occlusion = MakeQuerySet(nxt::QueryType::Occlusion, 2);
+    nxt::QuerySet statistics = MakeQuerySet(nxt::QueryType::PipelineStatistics, 1);
+    nxt::QuerySet timestamps = MakeQuerySet(nxt::QueryType::Timestamp, 1);
+
+    // Queries of different types can overlap
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .BeginQuery(occlusion, 0)
+            .BeginQuery(statistics, 0)
+            .EndQuery(occlusion, 0)
+            .EndQuery(statistics, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    // Only one query of each type can be active
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .BeginQuery(occlusion, 0)
+            .BeginQuery(occlusion, 1)
+            .EndQuery(occlusion, 1)
+            .EndQuery(occlusion, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    // The ended query must be the active one
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .BeginQuery(occlusion, 0)
+            .EndQuery(occlusion, 1)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    // Queries must be ended before the end of the subpass
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .BeginQuery(occlusion, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginComputePass()
+            .BeginQuery(statistics, 0)
+        .EndComputePass()
+        .GetResult();
+
+    // The query index must be in the set
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .BeginQuery(occlusion, 2)
+            .EndQuery(occlusion, 2)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    // Timestamps can't be used with BeginQuery
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginComputePass()
+            .BeginQuery(timestamps, 0)
+            .EndQuery(timestamps, 0)
+        .EndComputePass()
+        .GetResult();
+}
+
+// Test the validation of query set resolves
+TEST_F(QuerySetValidationTest, Resolve) {
+    nxt::QuerySet timestamps = MakeQuerySet(nxt::QueryType::Timestamp, 4);
+    nxt::Buffer destination = CreateFrozenBuffer(32, nxt::BufferUsageBit::TransferDst);
+
+    // Success, including resolves that touch the end of the buffer
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .ResolveQuerySet(timestamps, 0, 4, destination, 0)
+        .ResolveQuerySet(timestamps, 1, 2, destination, 16)
+        .ResolveQuerySet(timestamps, 3, 1, destination, 24)
+        .ResolveQuerySet(timestamps, 4, 0, destination, 32)
+        .GetResult();
+
+    // Queries out of the set
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .ResolveQuerySet(timestamps, 2, 3, destination, 0)
+        .GetResult();
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .ResolveQuerySet(timestamps, 0xFFFFFFFF, 2, destination, 0)
+        .GetResult();
+
+    // Unaligned destination offset
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .ResolveQuerySet(timestamps, 0, 1, destination, 4)
+        .GetResult();
+
+    // Results overflowing the buffer
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .ResolveQuerySet(timestamps, 0, 2, destination, 24)
+        .GetResult();
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .ResolveQuerySet(timestamps, 0, 1, destination, 0xFFFFFFF8)
+        .GetResult();
+}
+
+// Test that resolves need a TransferDst buffer and, like copies, can't happen in render passes
+TEST_F(QuerySetValidationTest, ResolveUsageAndScope) {
+    nxt::QuerySet timestamps = MakeQuerySet(nxt::QueryType::Timestamp, 1);
+    nxt::Buffer destination = CreateFrozenBuffer(8, nxt::BufferUsageBit::TransferDst);
+    nxt::Buffer storage = CreateFrozenBuffer(8, nxt::BufferUsageBit::Storage);
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .ResolveQuerySet(timestamps, 0, 1, storage, 0)
+        .GetResult();
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .ResolveQuerySet(timestamps, 0, 1, destination, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+}
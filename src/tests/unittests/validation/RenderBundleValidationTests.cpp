@@ -0,0 +1,205 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tests/unittests/validation/ValidationTest.h"
+
+#include "common/Constants.h"
+#include "utils/NXTHelpers.h"
+
+class RenderBundleValidationTest : public ValidationTest {
+    protected:
+        void SetUp() override {
+            ValidationTest::SetUp();
+
+            renderpassData = CreateDummyRenderPass();
+
+            vsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Vertex, R"(
+                #version 450
+                void main() {
+                    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+                })"
+            );
+
+            fsModule = utils::CreateShaderModule(device, nxt::ShaderStage::Fragment, R"(
+                #version 450
+                layout(location = 0) out vec4 fragColor;
+                void main() {
+                    fragColor = vec4(0.0, 1.0, 0.0, 1.0);
+                })"
+            );
+
+            pipeline = MakePipeline(renderpassData.renderPass);
+        }
+
+        nxt::RenderPipeline MakePipeline(const nxt::RenderPass& renderpass) {
+            return device.CreateRenderPipelineBuilder()
+                .SetSubpass(renderpass, 0)
+                .SetStage(nxt::ShaderStage::Vertex, vsModule, "main")
+                .SetStage(nxt::ShaderStage::Fragment, fsModule, "main")
+                .GetResult();
+        }
+
+        nxt::RenderBundle MakeBundle(const nxt::RenderPass& renderpass,
+                                     const nxt::RenderPipeline& bundlePipeline) {
+            return AssertWillBeSuccess(device.CreateRenderBundleBuilder())
+                .SetSubpass(renderpass, 0)
+                .SetRenderPipeline(bundlePipeline)
+                .DrawArrays(3, 1, 0, 0)
+                .GetResult();
+        }
+
+        DummyRenderPass renderpassData;
+        nxt::ShaderModule vsModule;
+        nxt::ShaderModule fsModule;
+        nxt::RenderPipeline pipeline;
+};
+
+// Test that a valid bundle can be executed, possibly several times, in a compatible subpass
+TEST_F(RenderBundleValidationTest, Success) {
+    nxt::RenderBundle bundle = MakeBundle(renderpassData.renderPass, pipeline);
+    nxt::RenderBundle bundles[2] = {bundle.Clone(), bundle.Clone()};
+
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .ExecuteBundles(2, bundles)
+            .ExecuteBundles(1, &bundle)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+}
+
+// Test that a bundle must have its subpass set
+TEST_F(RenderBundleValidationTest, SubpassNotSet) {
+    AssertWillBeError(device.CreateRenderBundleBuilder())
+        .SetRenderPipeline(pipeline)
+        .DrawArrays(3, 1, 0, 0)
+        .GetResult();
+}
+
+// Test that the subpass of a bundle must exist in its render pass
+TEST_F(RenderBundleValidationTest, SubpassOOB) {
+    AssertWillBeError(device.CreateRenderBundleBuilder())
+        .SetSubpass(renderpassData.renderPass, 1)
+        .GetResult();
+}
+
+// Test that the commands of a bundle are validated when the bundle is built
+TEST_F(RenderBundleValidationTest, DrawWithoutPipeline) {
+    AssertWillBeError(device.CreateRenderBundleBuilder())
+        .SetSubpass(renderpassData.renderPass, 0)
+        .DrawArrays(3, 1, 0, 0)
+        .GetResult();
+}
+
+// Test that bundles can only be executed in a render subpass
+TEST_F(RenderBundleValidationTest, ExecuteOutsideSubpass) {
+    nxt::RenderBundle bundle = MakeBundle(renderpassData.renderPass, pipeline);
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .ExecuteBundles(1, &bundle)
+        .GetResult();
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginComputePass()
+            .ExecuteBundles(1, &bundle)
+        .EndComputePass()
+        .GetResult();
+}
+
+// Test that bundles must be executed in a subpass compatible with their own
+TEST_F(RenderBundleValidationTest, IncompatibleSubpass) {
+    nxt::RenderPass otherRenderpass = CreateDummyRenderPass().renderPass;
+    nxt::RenderBundle bundle = MakeBundle(otherRenderpass, MakePipeline(otherRenderpass));
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .ExecuteBundles(1, &bundle)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+}
+
+// Test that the pipeline and bindings must be set again after executing bundles
+TEST_F(RenderBundleValidationTest, StateIsReset) {
+    nxt::RenderBundle bundle = MakeBundle(renderpassData.renderPass, pipeline);
+
+    AssertWillBeError(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .SetRenderPipeline(pipeline)
+            .ExecuteBundles(1, &bundle)
+            .DrawArrays(3, 1, 0, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+
+    AssertWillBeSuccess(device.CreateCommandBufferBuilder())
+        .BeginRenderPass(renderpassData.renderPass, renderpassData.framebuffer)
+        .BeginRenderSubpass()
+            .ExecuteBundles(1, &bundle)
+            .SetRenderPipeline(pipeline)
+            .DrawArrays(3, 1, 0, 0)
+        .EndRenderSubpass()
+        .EndRenderPass()
+        .GetResult();
+}
+
+// Test that the buffers used by a bundle must have a frozen usage since bundles can't transition
+// resources
+TEST_F(RenderBundleValidationTest, BufferUsageMustBeFrozen) {
+    nxt::Buffer indexBuffer = device.CreateBufferBuilder()
+        .SetSize(12)
+        .SetAllowedUsage(nxt::BufferUsageBit::Index | nxt::BufferUsageBit::TransferDst)
+        .SetInitialUsage(nxt::BufferUsageBit::Index)
+        .GetResult();
+
+    AssertWillBeError(device.CreateRenderBundleBuilder())
+        .SetSubpass(renderpassData.renderPass, 0)
+        .SetRenderPipeline(pipeline)
+        .SetIndexBuffer(indexBuffer, 0)
+        .DrawElements(3, 1, 0, 0)
+        .GetResult();
+
+    indexBuffer.FreezeUsage(nxt::BufferUsageBit::Index);
+
+    AssertWillBeSuccess(device.CreateRenderBundleBuilder())
+        .SetSubpass(renderpassData.renderPass, 0)
+        .SetRenderPipeline(pipeline)
+        .SetIndexBuffer(indexBuffer, 0)
+        .DrawElements(3, 1, 0, 0)
+        .GetResult();
+}
+
+// Test that push constants set in bundles are bounds checked, including when offset + count
+// overflows
+TEST_F(RenderBundleValidationTest, SetPushConstantsOOB) {
+    uint32_t constants[kMaxPushConstants] = {};
+
+    AssertWillBeSuccess(device.CreateRenderBundleBuilder())
+        .SetSubpass(renderpassData.renderPass, 0)
+        .SetPushConstants(nxt::ShaderStageBit::Vertex, 0, kMaxPushConstants, constants)
+        .GetResult();
+
+    AssertWillBeError(device.CreateRenderBundleBuilder())
+        .SetSubpass(renderpassData.renderPass, 0)
+        .SetPushConstants(nxt::ShaderStageBit::Vertex, 1, kMaxPushConstants, constants)
+        .GetResult();
+
+    AssertWillBeError(device.CreateRenderBundleBuilder())
+        .SetSubpass(renderpassData.renderPass, 0)
+        .SetPushConstants(nxt::ShaderStageBit::Vertex, 0xFFFFFFFF, 2, constants)
+        .GetResult();
+}
@@ -54,3 +54,45 @@ TEST_F(UsageValidationTest, UsageAfterCommandBuffer) {
 
     buf.SetSubData(0, 1, &foo);
 }
+
+// Test that resubmitting a reusable command buffer executes its commands again
+TEST_F(UsageValidationTest, ResubmitReusableCommandBuffer) {
+    nxt::Buffer buf = device.CreateBufferBuilder()
+        .SetSize(4)
+        .SetAllowedUsage(nxt::BufferUsageBit::TransferDst | nxt::BufferUsageBit::Vertex)
+        .SetInitialUsage(nxt::BufferUsageBit::Vertex)
+        .GetResult();
+
+    nxt::CommandBuffer cmdbuf = device.CreateCommandBufferBuilder()
+        .SetReusable(true)
+        .TransitionBufferUsage(buf, nxt::BufferUsageBit::TransferDst)
+        .GetResult();
+
+    uint32_t foo = 0;
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_DEVICE_ERROR(buf.SetSubData(0, 1, &foo));
+        queue.Submit(1, &cmdbuf);
+        // buf should be in TransferDst usage
+        buf.SetSubData(0, 1, &foo);
+
+        buf.TransitionUsage(nxt::BufferUsageBit::Vertex);
+    }
+}
+
+// Test that the frozen usages are checked again when resubmitting a reusable command buffer
+TEST_F(UsageValidationTest, ResubmitReusableCommandBufferAfterFreeze) {
+    nxt::Buffer buf = device.CreateBufferBuilder()
+        .SetSize(4)
+        .SetAllowedUsage(nxt::BufferUsageBit::TransferDst | nxt::BufferUsageBit::Vertex)
+        .SetInitialUsage(nxt::BufferUsageBit::Vertex)
+        .GetResult();
+
+    nxt::CommandBuffer cmdbuf = device.CreateCommandBufferBuilder()
+        .SetReusable(true)
+        .TransitionBufferUsage(buf, nxt::BufferUsageBit::TransferDst)
+        .GetResult();
+    queue.Submit(1, &cmdbuf);
+
+    buf.FreezeUsage(nxt::BufferUsageBit::TransferDst);
+    ASSERT_DEVICE_ERROR(queue.Submit(1, &cmdbuf));
+}
@@ -0,0 +1,318 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tracing/TracingStats.h"
+
+#include "common/Assert.h"
+
+#include <nxt/nxt_tracing.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nxt { namespace tracing {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        // The TSC frequency is measured against the steady clock between the wrapping of the procs
+        // and the first query of the statistics, waiting at least kMinCalibrationTime.
+        constexpr std::chrono::milliseconds kMinCalibrationTime(10);
+
+        std::mutex sCalibrationMutex;
+        bool sCalibrated = false;
+        double sNanosecondsPerTick = 1.0;
+        uint64_t sCalibrationStartTicks = 0;
+        Clock::time_point sCalibrationStartTime;
+
+        void StartCalibration() {
+            std::lock_guard<std::mutex> lock(sCalibrationMutex);
+            if (sCalibrated || sCalibrationStartTicks != 0) {
+                return;
+            }
+            sCalibrationStartTime = Clock::now();
+            sCalibrationStartTicks = ReadTimestamp();
+        }
+
+        double GetNanosecondsPerTick() {
+#if defined(NXT_TRACING_USE_TSC)
+            std::lock_guard<std::mutex> lock(sCalibrationMutex);
+            if (sCalibrated) {
+                return sNanosecondsPerTick;
+            }
+            if (sCalibrationStartTicks == 0) {
+                sCalibrationStartTime = Clock::now();
+                sCalibrationStartTicks = ReadTimestamp();
+            }
+
+            Clock::duration elapsed = Clock::now() - sCalibrationStartTime;
+            if (elapsed < kMinCalibrationTime) {
+                std::this_thread::sleep_for(kMinCalibrationTime - elapsed);
+            }
+            uint64_t endTicks = ReadTimestamp();
+            double nanoseconds = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                                     sCalibrationStartTime)
+                    .count());
+
+            if (endTicks > sCalibrationStartTicks) {
+                sNanosecondsPerTick =
+                    nanoseconds / static_cast<double>(endTicks - sCalibrationStartTicks);
+            }
+            sCalibrated = true;
+            return sNanosecondsPerTick;
+#else
+            return 1.0;
+#endif
+        }
+
+        uint64_t TicksToNanoseconds(uint64_t ticks, double nanosecondsPerTick) {
+            return static_cast<uint64_t>(static_cast<double>(ticks) * nanosecondsPerTick);
+        }
+
+        // Returns the middle of the bucket containing the given fraction of the samples.
+        uint64_t GetPercentileTicks(const uint32_t* buckets,
+                                    uint64_t sampleCount,
+                                    double fraction) {
+            uint64_t rank = static_cast<uint64_t>(static_cast<double>(sampleCount - 1) * fraction);
+            uint64_t seen = 0;
+            for (uint32_t bucket = 0; bucket < kLatencyBucketCount; ++bucket) {
+                seen += buckets[bucket];
+                if (seen > rank) {
+                    uint64_t start = GetLatencyBucketStart(bucket);
+                    if (bucket + 1 == kLatencyBucketCount) {
+                        return start;
+                    }
+                    return start + (GetLatencyBucketStart(bucket + 1) - start) / 2;
+                }
+            }
+            UNREACHABLE();
+            return 0;
+        }
+
+        // The statistics of a thread are registered so that queries can sum them, and are added
+        // to sExitedThreadStats when the thread exits.
+        class ThreadStats;
+        std::mutex sThreadStatsMutex;
+        std::vector<ThreadStats*> sThreadStats;
+        std::unique_ptr<EntryPointStats[]> sExitedThreadStats;
+
+        // Resetting the statistics increments the epoch, and each thread clears its own
+        // statistics the next time it records a call so that the reset doesn't race with it.
+        std::atomic<uint64_t> sResetEpoch(0);
+
+        // Only called with sThreadStatsMutex locked, so nothing else writes the destination.
+        void AddEntryPointStats(EntryPointStats* destination, const EntryPointStats& source) {
+            auto load = [](const auto& counter) { return counter.load(std::memory_order_relaxed); };
+            AddToThreadCounter<uint64_t>(&destination->callCount, load(source.callCount));
+            AddToThreadCounter<uint64_t>(&destination->sampledTicks, load(source.sampledTicks));
+            AddToThreadCounter<uint64_t>(&destination->arrayBytes, load(source.arrayBytes));
+            for (uint32_t i = 0; i < kLatencyBucketCount; ++i) {
+                AddToThreadCounter<uint32_t>(&destination->latencyBuckets[i],
+                                             load(source.latencyBuckets[i]));
+            }
+        }
+
+        void ClearEntryPointStats(EntryPointStats* stats) {
+            stats->callCount.store(0, std::memory_order_relaxed);
+            stats->sampledTicks.store(0, std::memory_order_relaxed);
+            stats->arrayBytes.store(0, std::memory_order_relaxed);
+            for (std::atomic<uint32_t>& bucket : stats->latencyBuckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        class ThreadStats {
+          public:
+            ThreadStats() : mEntryPoints(new EntryPointStats[kEntryPointCount]()) {
+                std::lock_guard<std::mutex> lock(sThreadStatsMutex);
+                mEpoch.store(sResetEpoch.load());
+                sThreadStats.push_back(this);
+            }
+
+            ~ThreadStats() {
+                std::lock_guard<std::mutex> lock(sThreadStatsMutex);
+                if (IsCurrent()) {
+                    if (sExitedThreadStats == nullptr) {
+                        sExitedThreadStats.reset(new EntryPointStats[kEntryPointCount]());
+                    }
+                    for (uint32_t i = 0; i < kEntryPointCount; ++i) {
+                        AddEntryPointStats(&sExitedThreadStats[i], mEntryPoints[i]);
+                    }
+                }
+                sThreadStats.erase(std::find(sThreadStats.begin(), sThreadStats.end(), this));
+            }
+
+            EntryPointStats* GetEntryPoints() {
+                uint64_t epoch = sResetEpoch.load(std::memory_order_relaxed);
+                if (mEpoch.load(std::memory_order_relaxed) != epoch) {
+                    for (uint32_t i = 0; i < kEntryPointCount; ++i) {
+                        ClearEntryPointStats(&mEntryPoints[i]);
+                    }
+                    mEpoch.store(epoch, std::memory_order_release);
+                }
+                return mEntryPoints.get();
+            }
+
+            // Statistics recorded before the last reset are ignored by queries.
+            bool IsCurrent() const {
+                return mEpoch.load(std::memory_order_acquire) == sResetEpoch.load();
+            }
+
+            const EntryPointStats& GetEntryPoint(uint32_t entryPoint) const {
+                return mEntryPoints[entryPoint];
+            }
+
+          private:
+            std::unique_ptr<EntryPointStats[]> mEntryPoints;
+            std::atomic<uint64_t> mEpoch;
+        };
+
+        void AppendFormat(std::string* json, const char* format, const char* name, uint64_t value) {
+            char buffer[128];
+            snprintf(buffer, sizeof(buffer), format, name, static_cast<unsigned long long>(value));
+            json->append(buffer);
+        }
+
+    }  // anonymous namespace
+
+    uint64_t GetLatencyBucketStart(uint32_t bucket) {
+        ASSERT(bucket < kLatencyBucketCount);
+        if (bucket < kSubBucketCount) {
+            return bucket;
+        }
+        uint32_t octave = bucket / kSubBucketCount;
+        uint32_t subBucket = bucket % kSubBucketCount;
+        return static_cast<uint64_t>(kSubBucketCount + subBucket) << (octave - 1);
+    }
+
+    EntryPointStats* GetThreadEntryPointStats() {
+        thread_local ThreadStats threadStats;
+        return threadStats.GetEntryPoints();
+    }
+
+}}  // namespace nxt::tracing
+
+using namespace nxt::tracing;
+
+bool nxtTracingWrapProcs(const nxtProcTable* procs, nxtProcTable* tracingProcs) {
+    static std::mutex wrapMutex;
+    std::lock_guard<std::mutex> lock(wrapMutex);
+    if (!WrapProcs(*procs, tracingProcs)) {
+        return false;
+    }
+    StartCalibration();
+    return true;
+}
+
+uint32_t nxtTracingGetEntryPointCount() {
+    return kEntryPointCount;
+}
+
+void nxtTracingGetEntryPointStats(uint32_t entryPoint, nxtTracingEntryPointStats* stats) {
+    *stats = {};
+    if (entryPoint >= kEntryPointCount) {
+        return;
+    }
+    double nanosecondsPerTick = GetNanosecondsPerTick();
+
+    EntryPointStats sum;
+    ClearEntryPointStats(&sum);
+    {
+        std::lock_guard<std::mutex> lock(sThreadStatsMutex);
+        for (const ThreadStats* threadStats : sThreadStats) {
+            if (threadStats->IsCurrent()) {
+                AddEntryPointStats(&sum, threadStats->GetEntryPoint(entryPoint));
+            }
+        }
+        if (sExitedThreadStats != nullptr) {
+            AddEntryPointStats(&sum, sExitedThreadStats[entryPoint]);
+        }
+    }
+
+    uint32_t buckets[kLatencyBucketCount];
+    uint64_t sampleCount = 0;
+    for (uint32_t i = 0; i < kLatencyBucketCount; ++i) {
+        buckets[i] = sum.latencyBuckets[i].load(std::memory_order_relaxed);
+        sampleCount += buckets[i];
+    }
+
+    stats->name = kEntryPointNames[entryPoint];
+    stats->callCount = sum.callCount.load(std::memory_order_relaxed);
+    stats->arrayBytes = sum.arrayBytes.load(std::memory_order_relaxed);
+    if (sampleCount == 0) {
+        return;
+    }
+
+    // Only the sampled calls are timed, so the total is extrapolated to all the calls.
+    double sampledNanoseconds = static_cast<double>(sum.sampledTicks.load()) * nanosecondsPerTick;
+    stats->totalNanoseconds = static_cast<uint64_t>(
+        sampledNanoseconds * static_cast<double>(stats->callCount) / sampleCount);
+    stats->p50Nanoseconds = TicksToNanoseconds(GetPercentileTicks(buckets, sampleCount, 0.50),
+                                               nanosecondsPerTick);
+    stats->p90Nanoseconds = TicksToNanoseconds(GetPercentileTicks(buckets, sampleCount, 0.90),
+                                               nanosecondsPerTick);
+    stats->p99Nanoseconds = TicksToNanoseconds(GetPercentileTicks(buckets, sampleCount, 0.99),
+                                               nanosecondsPerTick);
+}
+
+void nxtTracingResetStats() {
+    std::lock_guard<std::mutex> lock(sThreadStatsMutex);
+    sResetEpoch.fetch_add(1);
+    if (sExitedThreadStats != nullptr) {
+        for (uint32_t entryPoint = 0; entryPoint < kEntryPointCount; ++entryPoint) {
+            ClearEntryPointStats(&sExitedThreadStats[entryPoint]);
+        }
+    }
+}
+
+size_t nxtTracingDumpJSON(char* buffer, size_t size) {
+    std::string json = "{\"entryPoints\": [";
+    bool first = true;
+    for (uint32_t entryPoint = 0; entryPoint < kEntryPointCount; ++entryPoint) {
+        nxtTracingEntryPointStats stats;
+        nxtTracingGetEntryPointStats(entryPoint, &stats);
+        if (stats.callCount == 0) {
+            continue;
+        }
+
+        json += first ? "\n  {" : ",\n  {";
+        first = false;
+        json += "\"name\": \"";
+        json += stats.name;
+        json += "\"";
+        AppendFormat(&json, ", \"%s\": %llu", "callCount", stats.callCount);
+        AppendFormat(&json, ", \"%s\": %llu", "totalNanoseconds", stats.totalNanoseconds);
+        AppendFormat(&json, ", \"%s\": %llu", "p50Nanoseconds", stats.p50Nanoseconds);
+        AppendFormat(&json, ", \"%s\": %llu", "p90Nanoseconds", stats.p90Nanoseconds);
+        AppendFormat(&json, ", \"%s\": %llu", "p99Nanoseconds", stats.p99Nanoseconds);
+        AppendFormat(&json, ", \"%s\": %llu", "arrayBytes", stats.arrayBytes);
+        json += "}";
+    }
+    json += first ? "]}" : "\n]}";
+
+    if (size != 0) {
+        size_t copySize = std::min(json.size(), size - 1);
+        memcpy(buffer, json.data(), copySize);
+        buffer[copySize] = '\0';
+    }
+    return json.size() + 1;
+}
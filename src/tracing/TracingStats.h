@@ -0,0 +1,131 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TRACING_TRACING_STATS_H_
+#define TRACING_TRACING_STATS_H_
+
+#include "common/Compiler.h"
+
+#include <nxt/nxt.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#    define NXT_TRACING_USE_TSC
+#    if defined(NXT_COMPILER_MSVC)
+#        include <intrin.h>
+#    else
+#        include <x86intrin.h>
+#    endif
+#endif
+
+namespace nxt { namespace tracing {
+
+    // One call out of kSampleInterval of each entry point on each thread is timed, and its
+    // latency recorded in a histogram with kSubBucketCount buckets per power of two of ticks, so
+    // percentiles are within 25% of the real latency. The total latency is extrapolated from the
+    // sampled calls.
+    static constexpr uint64_t kSampleInterval = 16;
+    static constexpr uint32_t kSubBucketBits = 2;
+    static constexpr uint32_t kSubBucketCount = 1 << kSubBucketBits;
+    static constexpr uint32_t kLatencyBucketCount = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+    // Each thread has its own statistics so that threads calling the API don't contend on the
+    // same cache lines. They are only written by their thread, and are atomics so that they can
+    // be read by the thread querying the statistics.
+    struct EntryPointStats {
+        std::atomic<uint64_t> callCount;
+        std::atomic<uint64_t> sampledTicks;
+        std::atomic<uint64_t> arrayBytes;
+        std::atomic<uint32_t> latencyBuckets[kLatencyBucketCount];
+    };
+
+    // Defined by the generated TracingProcTable.cpp, indexed by entry point in the order of the
+    // nxtProcTable.
+    extern const uint32_t kEntryPointCount;
+    extern const char* const kEntryPointNames[];
+
+    // Makes tracingProcs forward to procs while recording the statistics of each entry point.
+    // The tracing procs have no way to know which table they were created for, so all the
+    // tracing procs of the process forward to the same procs. Returns false if other procs were
+    // already wrapped.
+    bool WrapProcs(const nxtProcTable& procs, nxtProcTable* tracingProcs);
+
+    // The statistics of the calling thread, for all the entry points.
+    EntryPointStats* GetThreadEntryPointStats();
+
+    // Ticks of the TSC when it is available, which takes a few nanoseconds to read, otherwise
+    // nanoseconds of the steady clock.
+    inline uint64_t ReadTimestamp() {
+#if defined(NXT_TRACING_USE_TSC)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+#endif
+    }
+
+    // Buckets are exact below kSubBucketCount ticks, then each power of two is split in
+    // kSubBucketCount buckets.
+    inline uint32_t GetLatencyBucket(uint64_t ticks) {
+        if (ticks < kSubBucketCount) {
+            return static_cast<uint32_t>(ticks);
+        }
+#if defined(NXT_COMPILER_MSVC)
+        unsigned long highestBit = 0ul;
+        _BitScanReverse64(&highestBit, ticks);
+#else
+        uint32_t highestBit = 63 - static_cast<uint32_t>(__builtin_clzll(ticks));
+#endif
+        uint32_t subBucket =
+            static_cast<uint32_t>(ticks >> (highestBit - kSubBucketBits)) & (kSubBucketCount - 1);
+        return (static_cast<uint32_t>(highestBit) - kSubBucketBits + 1) * kSubBucketCount +
+               subBucket;
+    }
+
+    // The smallest latency that falls in a bucket.
+    uint64_t GetLatencyBucketStart(uint32_t bucket);
+
+    // Only the thread owning the statistics writes them so a relaxed load and store are enough,
+    // and avoid the cost of an atomic read-modify-write.
+    template <typename T>
+    void AddToThreadCounter(std::atomic<T>* counter, T value) {
+        counter->store(counter->load(std::memory_order_relaxed) + value,
+                       std::memory_order_relaxed);
+    }
+
+    // Counts a call and returns whether it should be timed.
+    inline bool CountCall(EntryPointStats* stats) {
+        uint64_t callIndex = stats->callCount.load(std::memory_order_relaxed);
+        stats->callCount.store(callIndex + 1, std::memory_order_relaxed);
+        return callIndex % kSampleInterval == 0;
+    }
+
+    inline void RecordSampledCall(EntryPointStats* stats, uint64_t startTicks, uint64_t endTicks) {
+        // The TSCs of different cores might not be synchronized if the thread migrated.
+        uint64_t ticks = endTicks > startTicks ? endTicks - startTicks : 0;
+        AddToThreadCounter<uint64_t>(&stats->sampledTicks, ticks);
+        AddToThreadCounter<uint32_t>(&stats->latencyBuckets[GetLatencyBucket(ticks)], 1);
+    }
+
+    inline void RecordArrayBytes(EntryPointStats* stats, uint64_t bytes) {
+        AddToThreadCounter<uint64_t>(&stats->arrayBytes, bytes);
+    }
+
+}}  // namespace nxt::tracing
+
+#endif  // TRACING_TRACING_STATS_H_
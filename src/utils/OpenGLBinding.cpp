@@ -27,6 +27,7 @@
 
 namespace backend { namespace opengl {
     void Init(void* (*getProc)(const char*), nxtProcTable* procs, nxtDevice* device);
+    void StartFenceWaiter(nxtDevice device, void (*makeCurrent)(void* userdata), void* userdata);
 }}  // namespace backend::opengl
 
 namespace utils {
@@ -105,6 +106,13 @@ namespace utils {
 
     class OpenGLBinding : public BackendBinding {
       public:
+        ~OpenGLBinding() override {
+            // The device, whose fence waiter uses this window's context, is destroyed first.
+            if (mFenceWaiterWindow != nullptr) {
+                glfwDestroyWindow(mFenceWaiterWindow);
+            }
+        }
+
         void SetupGLFWWindowHints() override {
 #if defined(NXT_PLATFORM_APPLE)
             glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
@@ -123,6 +131,20 @@ namespace utils {
             backend::opengl::Init(reinterpret_cast<void* (*)(const char*)>(glfwGetProcAddress),
                                   procs, device);
 
+            // The device waits on its fences with a hidden context that shares objects with the
+            // window's, so that its completion fd becomes readable when GPU work completes.
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            mFenceWaiterWindow = glfwCreateWindow(1, 1, "NXT fence waiter", nullptr, mWindow);
+            glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+            if (mFenceWaiterWindow != nullptr) {
+                backend::opengl::StartFenceWaiter(
+                    *device,
+                    [](void* window) {
+                        glfwMakeContextCurrent(static_cast<GLFWwindow*>(window));
+                    },
+                    mFenceWaiterWindow);
+            }
+
             mBackendDevice = *device;
         }
 
@@ -139,6 +161,7 @@ namespace utils {
 
       private:
         nxtDevice mBackendDevice = nullptr;
+        GLFWwindow* mFenceWaiterWindow = nullptr;
         nxtSwapChainImplementation mSwapchainImpl = {};
     };
 
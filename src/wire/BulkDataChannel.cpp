@@ -0,0 +1,143 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/BulkDataChannel.h"
+
+#include "common/Assert.h"
+#include "common/Math.h"
+
+#include <new>
+
+namespace nxt { namespace wire {
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64bit atomics must be lock-free");
+
+    struct BulkDataHeader {
+        alignas(64) std::atomic<uint64_t> uploadReleasedSerial;
+        alignas(64) std::atomic<uint64_t> readbackReleasedSerial;
+    };
+
+    namespace {
+
+        constexpr size_t kRegionAlignment = 64;
+        constexpr size_t kDataAlignment = 16;
+
+        size_t AlignSize(size_t size) {
+            return (size + kRegionAlignment - 1) & ~(kRegionAlignment - 1);
+        }
+
+        constexpr size_t kHeaderSize =
+            (sizeof(BulkDataHeader) + kRegionAlignment - 1) & ~(kRegionAlignment - 1);
+
+    }  // anonymous namespace
+
+    constexpr size_t BulkDataChannel::kMinBulkDataSize;
+
+    // static
+    size_t BulkDataChannel::GetRequiredMemorySize(size_t uploadSize, size_t readbackSize) {
+        return kHeaderSize + AlignSize(uploadSize) + AlignSize(readbackSize);
+    }
+
+    // static
+    void BulkDataChannel::Initialize(void* memory) {
+        ASSERT(IsPtrAligned(memory, kRegionAlignment));
+
+        BulkDataHeader* header = new (memory) BulkDataHeader;
+        header->uploadReleasedSerial = 0;
+        header->readbackReleasedSerial = 0;
+    }
+
+    BulkDataChannel::BulkDataChannel(void* memory,
+                                     size_t uploadSize,
+                                     size_t readbackSize,
+                                     Side side)
+        : mAllocator(side == Side::Client ? uploadSize : readbackSize) {
+        BulkDataHeader* header = reinterpret_cast<BulkDataHeader*>(memory);
+        uint8_t* uploadRegion = reinterpret_cast<uint8_t*>(memory) + kHeaderSize;
+        uint8_t* readbackRegion = uploadRegion + AlignSize(uploadSize);
+
+        if (side == Side::Client) {
+            mWriteRegion = uploadRegion;
+            mWriteReleasedSerial = &header->uploadReleasedSerial;
+            mReadRegion = readbackRegion;
+            mReadRegionSize = readbackSize;
+            mReadReleasedSerial = &header->readbackReleasedSerial;
+        } else {
+            mWriteRegion = readbackRegion;
+            mWriteReleasedSerial = &header->readbackReleasedSerial;
+            mReadRegion = uploadRegion;
+            mReadRegionSize = uploadSize;
+            mReadReleasedSerial = &header->uploadReleasedSerial;
+        }
+    }
+
+    BulkDataChannel::~BulkDataChannel() {
+    }
+
+    uint8_t* BulkDataChannel::Allocate(size_t size, uint32_t* serial, uint32_t* offset) {
+        if (size == 0 || size > mAllocator.GetSize()) {
+            return nullptr;
+        }
+
+        mAllocator.Tick(mWriteReleasedSerial->load());
+        size_t allocationOffset = mAllocator.Allocate(size, kDataAlignment, mNextWriteSerial);
+        if (allocationOffset == RingAllocator::kInvalidOffset) {
+            return nullptr;
+        }
+
+        *serial = mNextWriteSerial++;
+        *offset = static_cast<uint32_t>(allocationOffset);
+        return mWriteRegion + allocationOffset;
+    }
+
+    uint8_t* BulkDataChannel::Receive(uint32_t serial, uint32_t offset, uint32_t size) {
+        if (serial != mLastReceivedSerial + 1) {
+            return nullptr;
+        }
+        if (offset > mReadRegionSize || size > mReadRegionSize - offset) {
+            return nullptr;
+        }
+
+        mLastReceivedSerial = serial;
+        return mReadRegion + offset;
+    }
+
+    void BulkDataChannel::Release(uint32_t serial) {
+        ASSERT(serial > mLastReleasedSerial && serial <= mLastReceivedSerial);
+        ASSERT(mOutOfOrderReleases.count(serial) == 0);
+
+        if (serial != mLastReleasedSerial + 1) {
+            mOutOfOrderReleases.insert(serial);
+            return;
+        }
+
+        mLastReleasedSerial = serial;
+        while (!mOutOfOrderReleases.empty() &&
+               *mOutOfOrderReleases.begin() == mLastReleasedSerial + 1) {
+            mLastReleasedSerial++;
+            mOutOfOrderReleases.erase(mOutOfOrderReleases.begin());
+        }
+
+        mReadReleasedSerial->store(mLastReleasedSerial);
+    }
+
+    uint8_t* BulkDataChannel::GetWriteData(uint32_t offset, uint32_t size) {
+        size_t regionSize = mAllocator.GetSize();
+        if (offset > regionSize || size > regionSize - offset) {
+            return nullptr;
+        }
+        return mWriteRegion + offset;
+    }
+
+}}  // namespace nxt::wire
@@ -0,0 +1,91 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_BULK_DATA_CHANNEL_H_
+#define WIRE_BULK_DATA_CHANNEL_H_
+
+#include "common/RingAllocator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+
+namespace nxt { namespace wire {
+
+    // Memory shared between the wire client and server for large payloads, so that they are
+    // referenced by offset in the commands instead of being copied in the command stream. It has
+    // an upload region written by the client, for SetSubData, and a readback region written by
+    // the server, for the results of MapReadAsync.
+    //
+    // The writer of a region allocates from it with a RingAllocator, each allocation getting the
+    // next serial. The reader receives the allocations in the same order, because they are
+    // referenced by commands that are handled in order, and releases them once the data isn't
+    // used anymore, possibly out of order. The highest serial such that all the ones before it
+    // are released is published in the shared header so the writer can reuse the space.
+    //
+    // When a region is full, or for small payloads, the data is sent inline in the commands.
+    class BulkDataChannel {
+      public:
+        static constexpr size_t kMinBulkDataSize = 16 * 1024;
+
+        enum class Side {
+            Client,
+            Server,
+        };
+
+        static size_t GetRequiredMemorySize(size_t uploadSize, size_t readbackSize);
+        // Must be called once on the memory, aligned to 64 bytes, before views on it are created.
+        static void Initialize(void* memory);
+
+        // The sizes aren't read from the shared memory so that the other side can't change them.
+        BulkDataChannel(void* memory, size_t uploadSize, size_t readbackSize, Side side);
+        ~BulkDataChannel();
+
+        BulkDataChannel(const BulkDataChannel&) = delete;
+        BulkDataChannel& operator=(const BulkDataChannel&) = delete;
+
+        // Allocates space for data sent by this side. Returns nullptr if there is no space left,
+        // in which case the data should be sent inline.
+        uint8_t* Allocate(size_t size, uint32_t* serial, uint32_t* offset);
+
+        // Returns data sent by the other side, or nullptr if the serial isn't the next one or the
+        // range is out of the region. Every successful call must be matched by a Release.
+        uint8_t* Receive(uint32_t serial, uint32_t offset, uint32_t size);
+        void Release(uint32_t serial);
+
+        // Returns a range of the region this side writes to, or nullptr if it is out of the
+        // region. Used by tools that record the data sent, or replay it without allocating.
+        uint8_t* GetWriteData(uint32_t offset, uint32_t size);
+
+      private:
+        // The region this side writes to, and where the reader publishes what it released.
+        uint8_t* mWriteRegion;
+        std::atomic<uint64_t>* mWriteReleasedSerial;
+        RingAllocator mAllocator;
+        uint32_t mNextWriteSerial = 1;
+
+        // The region this side reads from.
+        uint8_t* mReadRegion;
+        size_t mReadRegionSize;
+        std::atomic<uint64_t>* mReadReleasedSerial;
+        uint32_t mLastReceivedSerial = 0;
+        uint32_t mLastReleasedSerial = 0;
+        // Serials released before some of the ones preceding them.
+        std::set<uint32_t> mOutOfOrderReleases;
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_BULK_DATA_CHANNEL_H_
@@ -0,0 +1,95 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/ChunkedCommandSerializer.h"
+
+#include "common/Assert.h"
+
+#include <algorithm>
+
+namespace nxt { namespace wire {
+
+    constexpr size_t ChunkedCommandSerializer::kDefaultChunkSize;
+
+    ChunkedCommandSerializer::ChunkedCommandSerializer(CommandHandler* handler, size_t chunkSize)
+        : mHandler(handler), mChunkSize(chunkSize) {
+        ASSERT(chunkSize > 0);
+    }
+
+    ChunkedCommandSerializer::~ChunkedCommandSerializer() {
+    }
+
+    void ChunkedCommandSerializer::SetHandler(CommandHandler* handler) {
+        mHandler = handler;
+    }
+
+    void* ChunkedCommandSerializer::GetCmdSpace(size_t size) {
+        if (mPendingChunks.empty() ||
+            mPendingChunks.back().capacity - mPendingChunks.back().used < size) {
+            NextChunk(size);
+        }
+
+        Chunk& chunk = mPendingChunks.back();
+        uint8_t* result = &chunk.data[chunk.used];
+        chunk.used += size;
+        return result;
+    }
+
+    void ChunkedCommandSerializer::Flush() {
+        // The handler can cause commands to be recorded in this serializer, for example when it
+        // calls callbacks, so the chunks are taken out of the chain before being handed off.
+        ASSERT(mFlushingChunks.empty());
+        std::swap(mPendingChunks, mFlushingChunks);
+
+        for (Chunk& chunk : mFlushingChunks) {
+            if (chunk.used != 0) {
+                mHandler->HandleCommands(chunk.data.get(), chunk.used);
+            }
+
+            // Chunks bigger than the chunk size were made for a single big command and are
+            // unlikely to be reused, free them instead of keeping them around.
+            if (chunk.capacity > mChunkSize) {
+                mAllocatedSize -= chunk.capacity;
+                continue;
+            }
+
+            chunk.used = 0;
+            mFreeChunks.push_back(std::move(chunk));
+        }
+        mFlushingChunks.clear();
+    }
+
+    size_t ChunkedCommandSerializer::GetPendingChunkCount() const {
+        return mPendingChunks.size();
+    }
+
+    size_t ChunkedCommandSerializer::GetAllocatedSize() const {
+        return mAllocatedSize;
+    }
+
+    void ChunkedCommandSerializer::NextChunk(size_t size) {
+        if (size <= mChunkSize && !mFreeChunks.empty()) {
+            mPendingChunks.push_back(std::move(mFreeChunks.back()));
+            mFreeChunks.pop_back();
+            return;
+        }
+
+        Chunk chunk;
+        chunk.capacity = std::max(size, mChunkSize);
+        chunk.data.reset(new uint8_t[chunk.capacity]);
+        mAllocatedSize += chunk.capacity;
+        mPendingChunks.push_back(std::move(chunk));
+    }
+
+}}  // namespace nxt::wire
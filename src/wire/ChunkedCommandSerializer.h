@@ -0,0 +1,76 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_CHUNKED_COMMAND_SERIALIZER_H_
+#define WIRE_CHUNKED_COMMAND_SERIALIZER_H_
+
+#include <memory>
+#include <vector>
+
+#include "wire/Wire.h"
+
+namespace nxt { namespace wire {
+
+    // A CommandSerializer that records commands in a chain of chunks and gives them to the handler
+    // on Flush. Commands are always contiguous: a command that doesn't fit at the end of a chunk
+    // starts a new one, and a command bigger than the chunk size gets a chunk of its own. Each
+    // chunk then contains only whole commands and is handed to the handler as-is without copies.
+    //
+    // Chunks are recycled after a Flush so that recording the same amount of commands between
+    // flushes doesn't allocate once the chain has grown to the size needed.
+    class ChunkedCommandSerializer : public CommandSerializer {
+      public:
+        static constexpr size_t kDefaultChunkSize = 256 * 1024;
+
+        ChunkedCommandSerializer(CommandHandler* handler = nullptr,
+                                 size_t chunkSize = kDefaultChunkSize);
+        ~ChunkedCommandSerializer();
+
+        ChunkedCommandSerializer(const ChunkedCommandSerializer&) = delete;
+        ChunkedCommandSerializer& operator=(const ChunkedCommandSerializer&) = delete;
+
+        void SetHandler(CommandHandler* handler);
+
+        void* GetCmdSpace(size_t size) override;
+        void Flush() override;
+
+        // The number of chunks recorded since the last Flush and the total memory used by the
+        // chunks, recorded or free.
+        size_t GetPendingChunkCount() const;
+        size_t GetAllocatedSize() const;
+
+      private:
+        struct Chunk {
+            std::unique_ptr<uint8_t[]> data;
+            size_t capacity = 0;
+            size_t used = 0;
+        };
+
+        // Makes the last pending chunk one that has at least size bytes free.
+        void NextChunk(size_t size);
+
+        CommandHandler* mHandler = nullptr;
+        size_t mChunkSize;
+        size_t mAllocatedSize = 0;
+
+        // The chunks recorded since the last Flush, commands are added to the last one.
+        std::vector<Chunk> mPendingChunks;
+        // The chunks being given to the handler, kept as a member so its storage is reused.
+        std::vector<Chunk> mFlushingChunks;
+        std::vector<Chunk> mFreeChunks;
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_CHUNKED_COMMAND_SERIALIZER_H_
@@ -0,0 +1,284 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/CommandTrace.h"
+
+#include "common/Assert.h"
+#include "common/Math.h"
+#include "wire/BulkDataChannel.h"
+#include "wire/WireCmd.h"
+
+#include <cstring>
+
+namespace nxt { namespace wire {
+
+    namespace {
+
+        constexpr size_t kTraceAlignment = 8;
+
+        size_t AlignTraceSize(size_t size) {
+            return (size + kTraceAlignment - 1) & ~(kTraceAlignment - 1);
+        }
+
+        template <typename T>
+        bool IsCommand(const uint8_t* command, size_t size, T commandId) {
+            static_assert(sizeof(T) == sizeof(uint32_t), "Command IDs are 32bit");
+            uint32_t id;
+            if (size < sizeof(id)) {
+                return false;
+            }
+            memcpy(&id, command, sizeof(id));
+            return id == static_cast<uint32_t>(commandId);
+        }
+
+    }  // anonymous namespace
+
+    // TraceWriter
+
+    TraceWriter::TraceWriter(FILE* file, size_t bulkDataUploadSize, size_t bulkDataReadbackSize)
+        : mFile(file) {
+        TraceHeader header;
+        header.magic = kTraceMagic;
+        header.version = kTraceVersion;
+        header.bulkDataUploadSize = bulkDataUploadSize;
+        header.bulkDataReadbackSize = bulkDataReadbackSize;
+        fwrite(&header, sizeof(header), 1, mFile);
+        fflush(mFile);
+    }
+
+    TraceWriter::~TraceWriter() {
+    }
+
+    void TraceWriter::WriteCommands(TraceRecordType type,
+                                    const uint32_t* commandSizes,
+                                    uint32_t commandCount,
+                                    const uint8_t* commands,
+                                    size_t size) {
+        ASSERT(type == TraceRecordType::Commands || type == TraceRecordType::ReturnCommands);
+
+        TraceRecordHeader header = {};
+        header.type = type;
+        header.commandCount = commandCount;
+        header.size = AlignTraceSize(commandCount * sizeof(uint32_t)) + size;
+        WriteRecord(header, commandSizes, commandCount * sizeof(uint32_t), commands, size);
+    }
+
+    void TraceWriter::WriteBulkData(TraceRecordType type,
+                                    uint32_t serial,
+                                    uint32_t offset,
+                                    const uint8_t* data,
+                                    size_t size) {
+        ASSERT(type == TraceRecordType::UploadData || type == TraceRecordType::ReadbackData);
+
+        TraceRecordHeader header = {};
+        header.type = type;
+        header.bulkDataSerial = serial;
+        header.bulkDataOffset = offset;
+        header.size = size;
+        WriteRecord(header, nullptr, 0, data, size);
+    }
+
+    void TraceWriter::WriteRecord(const TraceRecordHeader& header,
+                                  const void* data0,
+                                  size_t size0,
+                                  const void* data1,
+                                  size_t size1) {
+        static const uint8_t kPadding[kTraceAlignment] = {};
+        static_assert(sizeof(TraceRecordHeader) % kTraceAlignment == 0, "");
+
+        fwrite(&header, sizeof(header), 1, mFile);
+        fwrite(data0, 1, size0, mFile);
+        fwrite(kPadding, 1, AlignTraceSize(size0) - size0, mFile);
+        fwrite(data1, 1, size1, mFile);
+        fwrite(kPadding, 1, AlignTraceSize(size1) - size1, mFile);
+        fflush(mFile);
+    }
+
+    // TraceCommandSerializer
+
+    TraceCommandSerializer::TraceCommandSerializer(CommandSerializer* serializer,
+                                                   TraceWriter* writer,
+                                                   TraceRecordType type,
+                                                   BulkDataChannel* bulkData)
+        : mSerializer(serializer),
+          mWriter(writer),
+          mType(type),
+          mBulkData(bulkData),
+          mStaging(this) {
+        ASSERT(type == TraceRecordType::Commands || type == TraceRecordType::ReturnCommands);
+    }
+
+    TraceCommandSerializer::~TraceCommandSerializer() {
+    }
+
+    void* TraceCommandSerializer::GetCmdSpace(size_t size) {
+        mCommandSizes.push_back(static_cast<uint32_t>(size));
+        return mStaging.GetCmdSpace(size);
+    }
+
+    void TraceCommandSerializer::Flush() {
+        mNextCommand = 0;
+        mStaging.Flush();
+        ASSERT(mNextCommand == mCommandSizes.size());
+        mCommandSizes.clear();
+
+        mSerializer->Flush();
+    }
+
+    const uint8_t* TraceCommandSerializer::HandleCommands(const uint8_t* commands, size_t size) {
+        // Chunks contain whole commands, in the order they were recorded.
+        size_t firstCommand = mNextCommand;
+        size_t offset = 0;
+        while (offset != size) {
+            ASSERT(mNextCommand < mCommandSizes.size());
+            size_t commandSize = mCommandSizes[mNextCommand++];
+            WriteBulkData(commands + offset, commandSize);
+            offset += commandSize;
+        }
+
+        mWriter->WriteCommands(mType, &mCommandSizes[firstCommand],
+                               static_cast<uint32_t>(mNextCommand - firstCommand), commands, size);
+
+        memcpy(mSerializer->GetCmdSpace(size), commands, size);
+        return commands + size;
+    }
+
+    void TraceCommandSerializer::WriteBulkData(const uint8_t* command, size_t size) {
+        if (mBulkData == nullptr) {
+            return;
+        }
+
+        uint32_t serial = 0;
+        uint32_t offset = 0;
+        uint64_t dataSize = 0;
+        TraceRecordType type;
+        if (mType == TraceRecordType::Commands) {
+            if (!IsCommand(command, size, WireCmd::BufferSetSubDataBulk)) {
+                return;
+            }
+            BufferSetSubDataBulkCmd cmd;
+            memcpy(&cmd, command, sizeof(cmd));
+            serial = cmd.dataSerial;
+            offset = cmd.dataOffset;
+            dataSize = uint64_t(cmd.count) * sizeof(uint32_t);
+            type = TraceRecordType::UploadData;
+        } else {
+            if (!IsCommand(command, size, ReturnWireCmd::BufferMapReadAsyncCallback)) {
+                return;
+            }
+            ReturnBufferMapReadAsyncCallbackCmd cmd;
+            memcpy(&cmd, command, sizeof(cmd));
+            if (cmd.bulkDataSerial == 0) {
+                return;
+            }
+            serial = cmd.bulkDataSerial;
+            offset = cmd.bulkDataOffset;
+            dataSize = cmd.dataLength;
+            type = TraceRecordType::ReadbackData;
+        }
+
+        ASSERT(dataSize <= UINT32_MAX);
+        const uint8_t* data = mBulkData->GetWriteData(offset, static_cast<uint32_t>(dataSize));
+        ASSERT(data != nullptr);
+        mWriter->WriteBulkData(type, serial, offset, data, static_cast<size_t>(dataSize));
+    }
+
+    // TraceReader
+
+    TraceReader::TraceReader(const uint8_t* data, size_t size) : mData(data), mSize(size) {
+        ASSERT(IsPtrAligned(data, kTraceAlignment));
+
+        if (size < sizeof(TraceHeader)) {
+            return;
+        }
+        memcpy(&mHeader, data, sizeof(mHeader));
+        mValid = mHeader.magic == kTraceMagic && mHeader.version == kTraceVersion;
+        mOffset = sizeof(TraceHeader);
+    }
+
+    bool TraceReader::IsValid() const {
+        return mValid;
+    }
+
+    const TraceHeader& TraceReader::GetHeader() const {
+        return mHeader;
+    }
+
+    bool TraceReader::Next(TraceRecord* record) {
+        if (!mValid || mOffset == mSize) {
+            return false;
+        }
+
+        // Any error makes the rest of the trace invalid.
+        mValid = false;
+
+        if (mSize - mOffset < sizeof(TraceRecordHeader)) {
+            return false;
+        }
+        const auto* header = reinterpret_cast<const TraceRecordHeader*>(mData + mOffset);
+        mOffset += sizeof(TraceRecordHeader);
+
+        if (header->size > mSize - mOffset || AlignTraceSize(header->size) > mSize - mOffset) {
+            return false;
+        }
+        const uint8_t* data = mData + mOffset;
+        size_t size = static_cast<size_t>(header->size);
+        mOffset += AlignTraceSize(size);
+
+        record->type = header->type;
+        record->commandCount = 0;
+        record->commandSizes = nullptr;
+        record->bulkDataSerial = 0;
+        record->bulkDataOffset = 0;
+
+        switch (header->type) {
+            case TraceRecordType::Commands:
+            case TraceRecordType::ReturnCommands: {
+                uint64_t sizesSize = uint64_t(header->commandCount) * sizeof(uint32_t);
+                sizesSize = AlignTraceSize(static_cast<size_t>(sizesSize));
+                if (sizesSize > size) {
+                    return false;
+                }
+
+                record->commandCount = header->commandCount;
+                record->commandSizes = reinterpret_cast<const uint32_t*>(data);
+                record->data = data + sizesSize;
+                record->size = size - static_cast<size_t>(sizesSize);
+
+                uint64_t commandsSize = 0;
+                for (uint32_t i = 0; i < record->commandCount; ++i) {
+                    commandsSize += record->commandSizes[i];
+                }
+                if (commandsSize != record->size) {
+                    return false;
+                }
+            } break;
+
+            case TraceRecordType::UploadData:
+            case TraceRecordType::ReadbackData:
+                record->bulkDataSerial = header->bulkDataSerial;
+                record->bulkDataOffset = header->bulkDataOffset;
+                record->data = data;
+                record->size = size;
+                break;
+
+            default:
+                return false;
+        }
+
+        mValid = true;
+        return true;
+    }
+
+}}  // namespace nxt::wire
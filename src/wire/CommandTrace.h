@@ -0,0 +1,161 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_COMMAND_TRACE_H_
+#define WIRE_COMMAND_TRACE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/Wire.h"
+
+namespace nxt { namespace wire {
+
+    class BulkDataChannel;
+
+    // A trace of the commands exchanged by a wire client and server, that can be replayed against
+    // a server to benchmark it with the workload of a real application.
+    //
+    // The trace starts with a TraceHeader and is followed by records, each a TraceRecordHeader
+    // followed by its data padded to 8 bytes. Everything is aligned so that a trace can be mapped
+    // in memory and its commands given to the server in place. The records for commands contain
+    // the size of each command followed by the commands, and are preceded by the records for the
+    // bulk data they reference.
+    constexpr uint32_t kTraceMagic = 0x5254584e;  // "NXTR"
+    constexpr uint32_t kTraceVersion = 1;
+
+    struct TraceHeader {
+        uint32_t magic;
+        uint32_t version;
+        // The sizes of the regions of the BulkDataChannel, 0 if there isn't one.
+        uint64_t bulkDataUploadSize;
+        uint64_t bulkDataReadbackSize;
+    };
+
+    enum class TraceRecordType : uint32_t {
+        Commands = 1,
+        ReturnCommands = 2,
+        UploadData = 3,
+        ReadbackData = 4,
+    };
+
+    struct TraceRecordHeader {
+        TraceRecordType type;
+        uint32_t commandCount;
+        uint32_t bulkDataSerial;
+        uint32_t bulkDataOffset;
+        uint64_t size;
+    };
+
+    struct TraceRecord {
+        TraceRecordType type;
+
+        // For commands.
+        uint32_t commandCount;
+        const uint32_t* commandSizes;
+
+        // For bulk data, where it was in the BulkDataChannel.
+        uint32_t bulkDataSerial;
+        uint32_t bulkDataOffset;
+
+        // The commands or the bulk data.
+        const uint8_t* data;
+        size_t size;
+    };
+
+    // Writes a trace to a file, flushing it after each record so that the trace of an application
+    // that doesn't exit cleanly can still be read up to its last flush.
+    class TraceWriter {
+      public:
+        TraceWriter(FILE* file, size_t bulkDataUploadSize = 0, size_t bulkDataReadbackSize = 0);
+        ~TraceWriter();
+
+        void WriteCommands(TraceRecordType type,
+                           const uint32_t* commandSizes,
+                           uint32_t commandCount,
+                           const uint8_t* commands,
+                           size_t size);
+        void WriteBulkData(TraceRecordType type,
+                           uint32_t serial,
+                           uint32_t offset,
+                           const uint8_t* data,
+                           size_t size);
+
+      private:
+        void WriteRecord(const TraceRecordHeader& header,
+                         const void* data0,
+                         size_t size0,
+                         const void* data1,
+                         size_t size1);
+
+        FILE* mFile;
+    };
+
+    // A serializer that records the commands written in it in a trace, and forwards them to
+    // another serializer on Flush. It is used on the client to server stream, with
+    // TraceRecordType::Commands, or on the server to client stream, with ReturnCommands. When
+    // the wire uses a BulkDataChannel, the one of the same side is needed to record the data the
+    // commands reference.
+    class TraceCommandSerializer : public CommandSerializer, private CommandHandler {
+      public:
+        TraceCommandSerializer(CommandSerializer* serializer,
+                               TraceWriter* writer,
+                               TraceRecordType type,
+                               BulkDataChannel* bulkData = nullptr);
+        ~TraceCommandSerializer();
+
+        void* GetCmdSpace(size_t size) override;
+        void Flush() override;
+
+      private:
+        // Records and forwards the chunks of commands given by mStaging on Flush.
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override;
+        void WriteBulkData(const uint8_t* command, size_t size);
+
+        CommandSerializer* mSerializer;
+        TraceWriter* mWriter;
+        TraceRecordType mType;
+        BulkDataChannel* mBulkData;
+
+        ChunkedCommandSerializer mStaging;
+        std::vector<uint32_t> mCommandSizes;
+        size_t mNextCommand = 0;
+    };
+
+    // Reads the records of a trace in memory, that must be aligned to 8 bytes and outlive the
+    // reader.
+    class TraceReader {
+      public:
+        TraceReader(const uint8_t* data, size_t size);
+
+        // Whether the header is valid and no invalid record was found.
+        bool IsValid() const;
+        const TraceHeader& GetHeader() const;
+
+        // Returns false at the end of the trace or if the next record is invalid.
+        bool Next(TraceRecord* record);
+
+      private:
+        const uint8_t* mData;
+        size_t mSize;
+        size_t mOffset = 0;
+        bool mValid = false;
+        TraceHeader mHeader = {};
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_COMMAND_TRACE_H_
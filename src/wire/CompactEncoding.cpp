@@ -0,0 +1,356 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/CompactEncoding.h"
+
+#include "common/Assert.h"
+
+#include <cstring>
+
+namespace nxt { namespace wire {
+
+    // Each encoded command starts with a varint header:
+    //  - 0 is followed by a varint N, the previous command is repeated N times.
+    //  - (size << 1) | 1 is followed by the size bytes of a command sent as-is.
+    //  - size << 1 is followed by the varint command ID, a zigzag varint delta for each of the
+    //    following words, and the size % 4 trailing bytes of the command.
+    namespace {
+
+        constexpr uint32_t kCompactMagic = 0x50434e58;  // "XNCP"
+
+        // Larger commands are sent as-is and can't be repeated.
+        constexpr size_t kMaxCompactCommandSize = 1024;
+        constexpr uint32_t kMaxRunLength = 1 << 16;
+        // The total size of the commands repeated by runs in a flush. Other encodings decode to
+        // at most a few times their size so this bounds how much a flush can expand, which
+        // protects the server against streams crafted to decode to huge sizes.
+        constexpr size_t kMaxRunDecodedSizePerFlush = 16 * 1024 * 1024;
+        // The command IDs that have delta state, others are sent as-is.
+        constexpr uint32_t kMaxCommandId = 1024;
+
+        uint32_t LoadWord(const uint8_t* data) {
+            uint32_t word;
+            memcpy(&word, data, sizeof(word));
+            return word;
+        }
+
+        void StoreWord(uint8_t* data, uint32_t word) {
+            memcpy(data, &word, sizeof(word));
+        }
+
+        uint32_t ZigZagEncode(int32_t value) {
+            return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+        }
+
+        int32_t ZigZagDecode(uint32_t value) {
+            return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+        }
+
+        std::vector<uint32_t>* GetPreviousWords(CompactEncodingState* state,
+                                                uint32_t commandId,
+                                                size_t wordCount) {
+            if (state->previousWords.size() <= commandId) {
+                state->previousWords.resize(commandId + 1);
+            }
+            std::vector<uint32_t>* previous = &state->previousWords[commandId];
+            previous->resize(wordCount, 0);
+            return previous;
+        }
+
+        class Reader {
+          public:
+            Reader(const uint8_t* data, size_t size) : mData(data), mEnd(data + size) {
+            }
+
+            bool AtEnd() const {
+                return mData == mEnd;
+            }
+
+            size_t GetRemainingSize() const {
+                return static_cast<size_t>(mEnd - mData);
+            }
+
+            bool ReadVarint(uint64_t* value) {
+                // Most values are deltas that fit in a single byte.
+                if (mData != mEnd && *mData < 0x80) {
+                    *value = *mData++;
+                    return true;
+                }
+
+                *value = 0;
+                for (uint32_t shift = 0; shift < 64; shift += 7) {
+                    if (mData == mEnd) {
+                        return false;
+                    }
+                    uint8_t byte = *mData++;
+                    *value |= uint64_t(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool ReadVarint32(uint32_t* value) {
+                uint64_t value64;
+                if (!ReadVarint(&value64) || value64 > 0xFFFFFFFFu) {
+                    return false;
+                }
+                *value = static_cast<uint32_t>(value64);
+                return true;
+            }
+
+            const uint8_t* ReadBytes(size_t size) {
+                if (GetRemainingSize() < size) {
+                    return nullptr;
+                }
+                const uint8_t* bytes = mData;
+                mData += size;
+                return bytes;
+            }
+
+          private:
+            const uint8_t* mData;
+            const uint8_t* mEnd;
+        };
+
+    }  // anonymous namespace
+
+    // CompactCommandSerializer
+
+    CompactCommandSerializer::CompactCommandSerializer(CommandSerializer* serializer)
+        : mSerializer(serializer), mStaging(this) {
+    }
+
+    CompactCommandSerializer::~CompactCommandSerializer() {
+    }
+
+    void* CompactCommandSerializer::GetCmdSpace(size_t size) {
+        mCommandSizes.push_back(size);
+        return mStaging.GetCmdSpace(size);
+    }
+
+    void CompactCommandSerializer::Flush() {
+        if (mCommandSizes.empty()) {
+            return;
+        }
+
+        mEncoded.clear();
+        if (!mSentMagic) {
+            mEncoded.resize(sizeof(kCompactMagic));
+            StoreWord(mEncoded.data(), kCompactMagic);
+            mSentMagic = true;
+        }
+
+        // Runs don't span flushes so that each flush can be decoded on its own.
+        mNextCommand = 0;
+        mRunDecodedSize = 0;
+        mStaging.Flush();
+        EncodeRun();
+        ASSERT(mNextCommand == mCommandSizes.size());
+        mCommandSizes.clear();
+
+        mFlushedEncodedSize += mEncoded.size();
+        void* destination = mSerializer->GetCmdSpace(mEncoded.size());
+        memcpy(destination, mEncoded.data(), mEncoded.size());
+        mSerializer->Flush();
+    }
+
+    uint64_t CompactCommandSerializer::GetFlushedCommandSize() const {
+        return mFlushedCommandSize;
+    }
+
+    uint64_t CompactCommandSerializer::GetFlushedEncodedSize() const {
+        return mFlushedEncodedSize;
+    }
+
+    const uint8_t* CompactCommandSerializer::HandleCommands(const uint8_t* commands, size_t size) {
+        // Chunks contain whole commands, in the order they were recorded.
+        const uint8_t* end = commands + size;
+        while (commands != end) {
+            ASSERT(mNextCommand < mCommandSizes.size());
+            size_t commandSize = mCommandSizes[mNextCommand++];
+            EncodeCommand(commands, commandSize);
+            commands += commandSize;
+        }
+        return end;
+    }
+
+    void CompactCommandSerializer::EncodeCommand(const uint8_t* command, size_t size) {
+        mFlushedCommandSize += size;
+
+        std::vector<uint8_t>& lastCommand = mState.lastCommand;
+        // Once the run budget of the flush is spent, repeated commands are encoded normally.
+        if (!lastCommand.empty() && size == lastCommand.size() &&
+            mRunDecodedSize + size <= kMaxRunDecodedSizePerFlush &&
+            memcmp(command, lastCommand.data(), size) == 0) {
+            mRunLength++;
+            mRunDecodedSize += size;
+            if (mRunLength == kMaxRunLength) {
+                EncodeRun();
+            }
+            return;
+        }
+        EncodeRun();
+
+        uint32_t commandId = size >= sizeof(uint32_t) ? LoadWord(command) : 0;
+        if (size < sizeof(uint32_t) || size > kMaxCompactCommandSize ||
+            commandId >= kMaxCommandId) {
+            WriteVarint((uint64_t(size) << 1) | 1);
+            mEncoded.insert(mEncoded.end(), command, command + size);
+            lastCommand.clear();
+            return;
+        }
+
+        WriteVarint(uint64_t(size) << 1);
+        WriteVarint(commandId);
+
+        size_t wordCount = size / sizeof(uint32_t);
+        std::vector<uint32_t>& previous = *GetPreviousWords(&mState, commandId, wordCount);
+        for (size_t i = 1; i < wordCount; ++i) {
+            uint32_t word = LoadWord(command + i * sizeof(uint32_t));
+            WriteVarint(ZigZagEncode(static_cast<int32_t>(word - previous[i])));
+            previous[i] = word;
+        }
+        mEncoded.insert(mEncoded.end(), command + wordCount * sizeof(uint32_t), command + size);
+
+        lastCommand.assign(command, command + size);
+    }
+
+    void CompactCommandSerializer::EncodeRun() {
+        if (mRunLength == 0) {
+            return;
+        }
+        WriteVarint(0);
+        WriteVarint(mRunLength);
+        mRunLength = 0;
+    }
+
+    void CompactCommandSerializer::WriteVarint(uint64_t value) {
+        while (value >= 0x80) {
+            mEncoded.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        mEncoded.push_back(static_cast<uint8_t>(value));
+    }
+
+    // CompactCommandHandler
+
+    CompactCommandHandler::CompactCommandHandler(CommandHandler* handler) : mHandler(handler) {
+    }
+
+    CompactCommandHandler::~CompactCommandHandler() {
+    }
+
+    const uint8_t* CompactCommandHandler::HandleCommands(const uint8_t* commands, size_t size) {
+        if (mMode == Mode::Unknown) {
+            mMode = Mode::Raw;
+            if (size >= sizeof(kCompactMagic) && LoadWord(commands) == kCompactMagic) {
+                mMode = Mode::Compact;
+                commands += sizeof(kCompactMagic);
+                size -= sizeof(kCompactMagic);
+            }
+        }
+
+        if (mMode == Mode::Raw) {
+            return mHandler->HandleCommands(commands, size);
+        }
+
+        if (!Decode(commands, size)) {
+            return nullptr;
+        }
+        if (mHandler->HandleCommands(mDecoded.data(), mDecoded.size()) == nullptr) {
+            return nullptr;
+        }
+        return commands + size;
+    }
+
+    bool CompactCommandHandler::Decode(const uint8_t* commands, size_t size) {
+        mDecoded.clear();
+        Reader reader(commands, size);
+        std::vector<uint8_t>& lastCommand = mState.lastCommand;
+        size_t runDecodedSize = 0;
+
+        while (!reader.AtEnd()) {
+            uint64_t header;
+            if (!reader.ReadVarint(&header)) {
+                return false;
+            }
+
+            if (header == 0) {
+                uint32_t runLength;
+                if (!reader.ReadVarint32(&runLength) || runLength == 0 ||
+                    runLength > kMaxRunLength || lastCommand.empty()) {
+                    return false;
+                }
+                size_t runSize = runLength * lastCommand.size();
+                if (runSize > kMaxRunDecodedSizePerFlush - runDecodedSize) {
+                    return false;
+                }
+                runDecodedSize += runSize;
+                for (uint32_t i = 0; i < runLength; ++i) {
+                    mDecoded.insert(mDecoded.end(), lastCommand.begin(), lastCommand.end());
+                }
+                continue;
+            }
+
+            uint64_t commandSize = header >> 1;
+            if (header & 1) {
+                const uint8_t* bytes = reader.ReadBytes(commandSize);
+                if (bytes == nullptr) {
+                    return false;
+                }
+                mDecoded.insert(mDecoded.end(), bytes, bytes + commandSize);
+                lastCommand.clear();
+                continue;
+            }
+
+            // Each word takes at least one byte, which bounds the size of the command.
+            uint32_t commandId;
+            size_t wordCount = static_cast<size_t>(commandSize / sizeof(uint32_t));
+            if (commandSize < sizeof(uint32_t) || commandSize > kMaxCompactCommandSize ||
+                wordCount > reader.GetRemainingSize() || !reader.ReadVarint32(&commandId) ||
+                commandId >= kMaxCommandId) {
+                return false;
+            }
+
+            size_t offset = mDecoded.size();
+            mDecoded.resize(offset + commandSize);
+            uint8_t* command = &mDecoded[offset];
+            StoreWord(command, commandId);
+
+            std::vector<uint32_t>& previous = *GetPreviousWords(&mState, commandId, wordCount);
+            for (size_t i = 1; i < wordCount; ++i) {
+                uint32_t delta;
+                if (!reader.ReadVarint32(&delta)) {
+                    return false;
+                }
+                previous[i] += static_cast<uint32_t>(ZigZagDecode(delta));
+                StoreWord(command + i * sizeof(uint32_t), previous[i]);
+            }
+
+            size_t tailSize = static_cast<size_t>(commandSize % sizeof(uint32_t));
+            const uint8_t* tail = reader.ReadBytes(tailSize);
+            if (tail == nullptr) {
+                return false;
+            }
+            memcpy(command + wordCount * sizeof(uint32_t), tail, tailSize);
+
+            lastCommand.assign(command, command + commandSize);
+        }
+
+        return true;
+    }
+
+}}  // namespace nxt::wire
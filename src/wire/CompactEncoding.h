@@ -0,0 +1,106 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_COMPACT_ENCODING_H_
+#define WIRE_COMPACT_ENCODING_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/Wire.h"
+
+namespace nxt { namespace wire {
+
+    // A compact encoding of the command stream for transports where bandwidth matters. The client
+    // records commands in a CompactCommandSerializer that writes their encoding in another
+    // serializer on Flush, and the server decodes them with a CompactCommandHandler before giving
+    // them to the wire server.
+    //
+    // Commands are split in 32bit words, the first being the command ID, and each word is encoded
+    // as a varint of its difference with the same word of the previous command with the same ID.
+    // Object IDs, in particular the object the command is called on, rarely change between
+    // commands of the same type so they take a single byte. Commands identical to the previous
+    // one are run-length encoded, up to a budget per flush that bounds how big a flush can
+    // decode to. Large commands, which mostly contain data, are sent as-is.
+    //
+    // The encoding is negotiated in-band: the serializer starts the stream with a magic number
+    // and the handler forwards streams that don't start with it unchanged, so a server using a
+    // CompactCommandHandler accepts clients using either encoding.
+    struct CompactEncodingState {
+        // The words of the previous command with each command ID, used as a reference for deltas.
+        std::vector<std::vector<uint32_t>> previousWords;
+        // The previous command, if it was small enough to be repeated.
+        std::vector<uint8_t> lastCommand;
+    };
+
+    class CompactCommandSerializer : public CommandSerializer, private CommandHandler {
+      public:
+        CompactCommandSerializer(CommandSerializer* serializer);
+        ~CompactCommandSerializer();
+
+        void* GetCmdSpace(size_t size) override;
+        void Flush() override;
+
+        // The size of all the commands flushed so far, before and after encoding.
+        uint64_t GetFlushedCommandSize() const;
+        uint64_t GetFlushedEncodedSize() const;
+
+      private:
+        // Encodes the chunks of commands given by mStaging on Flush.
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override;
+        void EncodeCommand(const uint8_t* command, size_t size);
+        void EncodeRun();
+        void WriteVarint(uint64_t value);
+
+        CommandSerializer* mSerializer;
+        ChunkedCommandSerializer mStaging;
+        std::vector<size_t> mCommandSizes;
+        size_t mNextCommand = 0;
+
+        std::vector<uint8_t> mEncoded;
+        CompactEncodingState mState;
+        uint32_t mRunLength = 0;
+        size_t mRunDecodedSize = 0;
+        bool mSentMagic = false;
+
+        uint64_t mFlushedCommandSize = 0;
+        uint64_t mFlushedEncodedSize = 0;
+    };
+
+    class CompactCommandHandler : public CommandHandler {
+      public:
+        CompactCommandHandler(CommandHandler* handler);
+        ~CompactCommandHandler();
+
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override;
+
+      private:
+        bool Decode(const uint8_t* commands, size_t size);
+
+        enum class Mode {
+            Unknown,
+            Raw,
+            Compact,
+        };
+
+        CommandHandler* mHandler;
+        Mode mMode = Mode::Unknown;
+        std::vector<uint8_t> mDecoded;
+        CompactEncodingState mState;
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_COMPACT_ENCODING_H_
@@ -0,0 +1,119 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/CrossThreadCommandSerializer.h"
+
+#include "common/Assert.h"
+
+namespace nxt { namespace wire {
+
+    CrossThreadCommandSerializer::CrossThreadCommandSerializer(size_t maxBatches)
+        : mMaxBatches(maxBatches) {
+        ASSERT(maxBatches == 0 || maxBatches >= 2);
+
+        mBatches.emplace_back(new ChunkedCommandSerializer);
+        mRecordingBatch = mBatches.back().get();
+    }
+
+    CrossThreadCommandSerializer::~CrossThreadCommandSerializer() {
+        ASSERT(mFlushedBatches.empty() && mHandlingBatchCount == 0);
+    }
+
+    void* CrossThreadCommandSerializer::GetCmdSpace(size_t size) {
+        return mRecordingBatch->GetCmdSpace(size);
+    }
+
+    void CrossThreadCommandSerializer::Flush() {
+        if (mRecordingBatch->GetPendingChunkCount() == 0) {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mFlushedBatches.push(mRecordingBatch);
+        mCondition.notify_all();
+
+        if (mFreeBatches.empty() && (mMaxBatches == 0 || mBatches.size() < mMaxBatches)) {
+            mBatches.emplace_back(new ChunkedCommandSerializer);
+            mRecordingBatch = mBatches.back().get();
+            return;
+        }
+
+        mCondition.wait(lock, [this]() { return !mFreeBatches.empty(); });
+        mRecordingBatch = mFreeBatches.back();
+        mFreeBatches.pop_back();
+    }
+
+    bool CrossThreadCommandSerializer::HandleFlushedCommands(CommandHandler* handler, bool wait) {
+        ChunkedCommandSerializer* batch = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (wait) {
+                mCondition.wait(lock, [this]() {
+                    return !mFlushedBatches.empty() || mClosed || mWakeRequested;
+                });
+            }
+
+            // Handling a batch runs the handler too, so it also satisfies the wake request.
+            bool wakeRequested = mWakeRequested;
+            mWakeRequested = false;
+
+            if (mFlushedBatches.empty()) {
+                if (!wakeRequested) {
+                    return false;
+                }
+
+                lock.unlock();
+                static const uint8_t kNoCommands = 0;
+                handler->HandleCommands(&kNoCommands, 0);
+                return true;
+            }
+
+            batch = mFlushedBatches.front();
+            mFlushedBatches.pop();
+            mHandlingBatchCount++;
+        }
+
+        // The chunks of the batch are given to the handler without holding the lock so that the
+        // recording thread can continue flushing.
+        batch->SetHandler(handler);
+        batch->Flush();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mFreeBatches.push_back(batch);
+            mHandlingBatchCount--;
+            mCondition.notify_all();
+        }
+        return true;
+    }
+
+    void CrossThreadCommandSerializer::WaitForIdle() {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock,
+                        [this]() { return mFlushedBatches.empty() && mHandlingBatchCount == 0; });
+    }
+
+    void CrossThreadCommandSerializer::Close() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+        mCondition.notify_all();
+    }
+
+    void CrossThreadCommandSerializer::Wake() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWakeRequested = true;
+        mCondition.notify_all();
+    }
+
+}}  // namespace nxt::wire
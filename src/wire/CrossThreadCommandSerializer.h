@@ -0,0 +1,80 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_CROSS_THREAD_COMMAND_SERIALIZER_H_
+#define WIRE_CROSS_THREAD_COMMAND_SERIALIZER_H_
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/Wire.h"
+
+namespace nxt { namespace wire {
+
+    // A CommandSerializer whose commands are recorded on one thread and handled on another.
+    // Commands are recorded in a batch, and Flush hands the batch to the handling thread and
+    // continues recording in the next one. This lets the recording thread work on the next batch
+    // while the previous ones are handled, like double or triple buffering.
+    //
+    // When maxBatches is not 0 it bounds the number of batches that can be in flight: Flush
+    // waits for the handling thread to finish a batch when they are all used. This keeps a fast
+    // recording thread from getting arbitrarily far ahead.
+    class CrossThreadCommandSerializer : public CommandSerializer {
+      public:
+        CrossThreadCommandSerializer(size_t maxBatches);
+        ~CrossThreadCommandSerializer();
+
+        // Called on the recording thread.
+        void* GetCmdSpace(size_t size) override;
+        void Flush() override;
+
+        // Called on the handling thread. Gives the oldest flushed batch to the handler and
+        // returns true, or returns false if there is none. If wait is true, it waits for a batch
+        // to be flushed and only returns false once the serializer is closed.
+        bool HandleFlushedCommands(CommandHandler* handler, bool wait);
+
+        // Waits until all the flushed batches have been handled.
+        void WaitForIdle();
+        // Makes the handling thread stop waiting once all flushed batches have been handled.
+        void Close();
+        // Can be called from any thread. Makes the handling thread give an empty batch to the
+        // handler if there are no flushed batches, so that the handler runs even when nothing
+        // was recorded.
+        void Wake();
+
+      private:
+        size_t mMaxBatches;
+
+        // All the batches, owned by the serializer.
+        std::vector<std::unique_ptr<ChunkedCommandSerializer>> mBatches;
+        // Only used by the recording thread.
+        ChunkedCommandSerializer* mRecordingBatch = nullptr;
+
+        // Protected by the mutex.
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::queue<ChunkedCommandSerializer*> mFlushedBatches;
+        std::vector<ChunkedCommandSerializer*> mFreeBatches;
+        uint32_t mHandlingBatchCount = 0;
+        bool mClosed = false;
+        bool mWakeRequested = false;
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_CROSS_THREAD_COMMAND_SERIALIZER_H_
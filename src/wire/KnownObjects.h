@@ -0,0 +1,172 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_KNOWN_OBJECTS_H_
+#define WIRE_KNOWN_OBJECTS_H_
+
+#include "common/Assert.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nxt { namespace wire { namespace server {
+
+    // Keeps track of the mapping between client IDs and backend objects on the server.
+    //
+    // The data is stored as a structure of arrays indexed by ID: the backend handles and serials
+    // are packed, whether the object is valid and whether the ID is allocated are bitsets, and
+    // only builders store the ID and serial of the object they built, for their error callbacks.
+    // The client reuses the lowest free IDs first so the arrays stay as small as the peak number
+    // of live objects.
+    template <typename T, bool IsBuilder = false>
+    class KnownObjects {
+      public:
+        struct BuiltObject {
+            uint32_t id = 0;
+            uint32_t serial = 0;
+        };
+
+        KnownObjects() {
+            // Pre-allocate ID 0 to refer to the null handle.
+            Allocate(0, 0);
+            mValid[0] = true;
+        }
+
+        bool IsAllocated(uint32_t id) const {
+            return id < mHandles.size() && mAllocated[id];
+        }
+
+        // Returns false if the ID isn't allocated, otherwise gets its handle and whether it is
+        // valid.
+        bool Get(uint32_t id, T* handle, bool* valid) const {
+            if (!IsAllocated(id)) {
+                return false;
+            }
+            *handle = mHandles[id];
+            *valid = mValid[id];
+            return true;
+        }
+
+        // Gets the handles of an array of IDs. Returns false if one of them isn't allocated,
+        // otherwise sets allValid to whether they are all valid.
+        bool GetMany(const uint32_t* ids, size_t count, T* handles, bool* allValid) const {
+            bool valid = true;
+            for (size_t i = 0; i < count; ++i) {
+                uint32_t id = ids[i];
+                if (!IsAllocated(id)) {
+                    return false;
+                }
+                handles[i] = mHandles[id];
+                valid = valid && mValid[id];
+            }
+            *allValid = valid;
+            return true;
+        }
+
+        // Allocates the ID with a null handle, as an error object. Returns false if the ID is
+        // already allocated, or too far ahead.
+        bool Allocate(uint32_t id, uint32_t serial) {
+            if (id > mHandles.size()) {
+                return false;
+            }
+
+            if (id == mHandles.size()) {
+                mHandles.push_back(nullptr);
+                mSerials.push_back(serial);
+                mValid.push_back(false);
+                mAllocated.push_back(true);
+                if (IsBuilder) {
+                    mBuiltObjects.emplace_back();
+                }
+                return true;
+            }
+
+            if (mAllocated[id]) {
+                return false;
+            }
+
+            mHandles[id] = nullptr;
+            mSerials[id] = serial;
+            mValid[id] = false;
+            mAllocated[id] = true;
+            if (IsBuilder) {
+                mBuiltObjects[id] = BuiltObject();
+            }
+            return true;
+        }
+
+        void Free(uint32_t id) {
+            ASSERT(IsAllocated(id));
+            mAllocated[id] = false;
+        }
+
+        // The accessors below must only be used on allocated IDs.
+        T GetHandle(uint32_t id) const {
+            ASSERT(IsAllocated(id));
+            return mHandles[id];
+        }
+
+        uint32_t GetSerial(uint32_t id) const {
+            ASSERT(IsAllocated(id));
+            return mSerials[id];
+        }
+
+        // Sets the backend object of the ID, it is valid if the backend returned one.
+        void SetHandle(uint32_t id, T handle) {
+            ASSERT(IsAllocated(id));
+            mHandles[id] = handle;
+            mValid[id] = handle != nullptr;
+        }
+
+        void SetValid(uint32_t id, bool valid) {
+            ASSERT(IsAllocated(id));
+            mValid[id] = valid;
+        }
+
+        const BuiltObject& GetBuiltObject(uint32_t id) const {
+            static_assert(IsBuilder, "Only builders have a built object");
+            ASSERT(IsAllocated(id));
+            return mBuiltObjects[id];
+        }
+
+        void SetBuiltObject(uint32_t id, uint32_t builtObjectId, uint32_t builtObjectSerial) {
+            static_assert(IsBuilder, "Only builders have a built object");
+            ASSERT(IsAllocated(id));
+            mBuiltObjects[id].id = builtObjectId;
+            mBuiltObjects[id].serial = builtObjectSerial;
+        }
+
+        // The number of IDs the arrays are sized for and the memory they use.
+        size_t GetIdCount() const {
+            return mHandles.size();
+        }
+
+        size_t GetMemoryUsage() const {
+            return mHandles.capacity() * sizeof(T) + mSerials.capacity() * sizeof(uint32_t) +
+                   (mValid.capacity() + mAllocated.capacity()) / 8 +
+                   mBuiltObjects.capacity() * sizeof(BuiltObject);
+        }
+
+      private:
+        std::vector<T> mHandles;
+        std::vector<uint32_t> mSerials;
+        std::vector<bool> mValid;
+        std::vector<bool> mAllocated;
+        std::vector<BuiltObject> mBuiltObjects;
+    };
+
+}}}  // namespace nxt::wire::server
+
+#endif  // WIRE_KNOWN_OBJECTS_H_
@@ -0,0 +1,129 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_OBJECT_SLABS_H_
+#define WIRE_OBJECT_SLABS_H_
+
+#include "common/Assert.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nxt { namespace wire { namespace client {
+
+    // Storage for the client objects of a type, indexed by ID.
+    //
+    // Objects are constructed in place in fixed-size slabs so that creating an object doesn't
+    // allocate, except for a new slab every kSlabSize IDs, and their addresses stay stable when
+    // more slabs are added. Each slot also stores the generation of its ID, which starts at 0 and
+    // is incremented each time the object is destroyed so the server can tell the objects that
+    // used the same ID apart.
+    template <typename T, size_t kSlabSize = 256>
+    class ObjectSlabs {
+      public:
+        ObjectSlabs() = default;
+        ObjectSlabs(const ObjectSlabs&) = delete;
+        ObjectSlabs& operator=(const ObjectSlabs&) = delete;
+
+        ~ObjectSlabs() {
+            for (auto& slab : mSlabs) {
+                for (size_t i = 0; i < kSlabSize; ++i) {
+                    if (slab->live[i]) {
+                        slab->GetObject(i)->~T();
+                    }
+                }
+            }
+        }
+
+        // Constructs the object for an ID that doesn't have one. IDs are expected to be allocated
+        // densely as the slabs up to the ID's are created.
+        template <typename... Args>
+        T* Construct(uint32_t id, Args&&... args) {
+            while (id / kSlabSize >= mSlabs.size()) {
+                mSlabs.emplace_back(new Slab);
+            }
+
+            Slab* slab = mSlabs[id / kSlabSize].get();
+            size_t index = id % kSlabSize;
+            ASSERT(!slab->live[index]);
+
+            T* object = new (&slab->storage[index]) T(std::forward<Args>(args)...);
+            slab->live[index] = true;
+            return object;
+        }
+
+        void Destroy(uint32_t id) {
+            ASSERT(Get(id) != nullptr);
+            Slab* slab = mSlabs[id / kSlabSize].get();
+            size_t index = id % kSlabSize;
+
+            slab->GetObject(index)->~T();
+            slab->live[index] = false;
+            slab->generations[index]++;
+        }
+
+        // Returns nullptr if the ID doesn't have an object.
+        T* Get(uint32_t id) const {
+            if (id / kSlabSize >= mSlabs.size()) {
+                return nullptr;
+            }
+            Slab* slab = mSlabs[id / kSlabSize].get();
+            size_t index = id % kSlabSize;
+            if (!slab->live[index]) {
+                return nullptr;
+            }
+            return slab->GetObject(index);
+        }
+
+        // The generation of the current or next object with this ID.
+        uint32_t GetGeneration(uint32_t id) const {
+            if (id / kSlabSize >= mSlabs.size()) {
+                return 0;
+            }
+            return mSlabs[id / kSlabSize]->generations[id % kSlabSize];
+        }
+
+        size_t GetSlabCount() const {
+            return mSlabs.size();
+        }
+
+      private:
+        struct Slab {
+            Slab() {
+                for (size_t i = 0; i < kSlabSize; ++i) {
+                    generations[i] = 0;
+                    live[i] = false;
+                }
+            }
+
+            T* GetObject(size_t index) {
+                return reinterpret_cast<T*>(&storage[index]);
+            }
+
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[kSlabSize];
+            uint32_t generations[kSlabSize];
+            bool live[kSlabSize];
+        };
+
+        std::vector<std::unique_ptr<Slab>> mSlabs;
+    };
+
+}}}  // namespace nxt::wire::client
+
+#endif  // WIRE_OBJECT_SLABS_H_
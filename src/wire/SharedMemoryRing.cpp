@@ -0,0 +1,399 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/SharedMemoryRing.h"
+
+#include "common/Assert.h"
+#include "common/Math.h"
+#include "common/Platform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if NXT_PLATFORM_LINUX
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <time.h>
+#    include <unistd.h>
+#endif
+
+namespace nxt { namespace wire {
+
+    // The atomics are shared between processes so they must not be implemented with locks.
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "64bit atomics must be lock-free");
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "32bit atomics must be lock-free");
+
+    struct RingHeader {
+        uint64_t capacity;
+        std::atomic<uint32_t> closed;
+
+        // Written by the producer. The sequence is incremented on each publish and is what the
+        // consumer sleeps on.
+        alignas(64) std::atomic<uint64_t> writePosition;
+        std::atomic<uint32_t> writeSequence;
+        std::atomic<uint32_t> consumerWaiting;
+
+        // Written by the consumer.
+        alignas(64) std::atomic<uint64_t> readPosition;
+        std::atomic<uint32_t> readSequence;
+        std::atomic<uint32_t> producerWaiting;
+    };
+
+    namespace {
+
+        // Each message starts with a header and is padded so the next one is aligned.
+        struct MessageHeader {
+            uint32_t size;
+            uint32_t isPadding;
+        };
+        constexpr size_t kMessageAlignment = 8;
+        static_assert(sizeof(MessageHeader) == kMessageAlignment, "");
+
+        constexpr size_t kDataOffset = (sizeof(RingHeader) + 63) / 64 * 64;
+
+        size_t AlignedMessageSize(size_t size) {
+            return (sizeof(MessageHeader) + size + kMessageAlignment - 1) &
+                   ~(kMessageAlignment - 1);
+        }
+
+        // Sleeps until the value at address isn't expectedValue anymore, or the timeout expires.
+        // Spurious wakeups are allowed.
+        void WaitOnAddress(std::atomic<uint32_t>* address,
+                           uint32_t expectedValue,
+                           uint32_t timeoutMs) {
+#if NXT_PLATFORM_LINUX
+            // std::atomic<uint32_t> is lock-free so it has the layout of a uint32_t. Not using
+            // FUTEX_PRIVATE_FLAG is what makes the futex work across processes.
+            timespec timeout;
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAIT, expectedValue,
+                    &timeout, nullptr, 0);
+#else
+            auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+            while (address->load() == expectedValue && std::chrono::steady_clock::now() < end) {
+                std::this_thread::yield();
+            }
+#endif
+        }
+
+        void WakeAddress(std::atomic<uint32_t>* address) {
+#if NXT_PLATFORM_LINUX
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(address), FUTEX_WAKE, 1, nullptr,
+                    nullptr, 0);
+#endif
+        }
+
+        constexpr uint32_t kWaitSliceMs = 100;
+
+    }  // anonymous namespace
+
+    // static
+    size_t SharedMemoryRing::GetRequiredMemorySize(size_t capacity) {
+        return kDataOffset + capacity;
+    }
+
+    // static
+    void SharedMemoryRing::Initialize(void* memory, size_t capacity) {
+        ASSERT(IsPowerOfTwo(capacity) && capacity >= 64);
+        ASSERT(IsPtrAligned(memory, 64));
+
+        RingHeader* header = new (memory) RingHeader;
+        header->capacity = capacity;
+        header->closed = 0;
+        header->writePosition = 0;
+        header->writeSequence = 0;
+        header->consumerWaiting = 0;
+        header->readPosition = 0;
+        header->readSequence = 0;
+        header->producerWaiting = 0;
+    }
+
+    constexpr size_t SharedMemoryRing::kMaxMessageSize;
+
+    SharedMemoryRing::SharedMemoryRing(void* memory, size_t capacity)
+        : mHeader(reinterpret_cast<RingHeader*>(memory)),
+          mData(reinterpret_cast<uint8_t*>(memory) + kDataOffset),
+          mCapacity(capacity) {
+        ASSERT(IsPowerOfTwo(capacity) && capacity >= 64);
+        mWritePosition = mHeader->writePosition.load();
+        mReadPosition = mHeader->readPosition.load();
+    }
+
+    size_t SharedMemoryRing::GetCapacity() const {
+        return mCapacity;
+    }
+
+    bool SharedMemoryRing::Write(const uint8_t* data, size_t size) {
+        ASSERT(size <= kMaxMessageSize);
+        size_t alignedSize = AlignedMessageSize(size);
+
+        MessageHeader header;
+        header.size = static_cast<uint32_t>(size);
+        header.isPadding = 0;
+
+        // Messages that fit are made contiguous by padding until the end of the ring, and are
+        // only ever published whole.
+        if (alignedSize <= mCapacity) {
+            size_t spaceUntilEnd = mCapacity - static_cast<size_t>(mWritePosition % mCapacity);
+            if (alignedSize > spaceUntilEnd) {
+                if (!WaitForSpace(spaceUntilEnd)) {
+                    return false;
+                }
+                MessageHeader padding;
+                padding.size = static_cast<uint32_t>(spaceUntilEnd);
+                padding.isPadding = 1;
+                WriteBytes(reinterpret_cast<const uint8_t*>(&padding), sizeof(padding));
+                mWritePosition += spaceUntilEnd - sizeof(padding);
+            }
+
+            if (!WaitForSpace(alignedSize)) {
+                return false;
+            }
+            WriteBytes(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+            WriteBytes(data, size);
+            // The padding at the end of the message is left uninitialized.
+            mWritePosition += alignedSize - sizeof(header) - size;
+            return true;
+        }
+
+        // Bigger messages are streamed in as big pieces as the free space allows.
+        if (!WaitForSpace(sizeof(header))) {
+            return false;
+        }
+        WriteBytes(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+
+        size_t remainingSize = alignedSize - sizeof(header);
+        while (remainingSize > 0) {
+            if (!WaitForSpace(kMessageAlignment)) {
+                return false;
+            }
+            uint64_t freeSpace = mCapacity - (mWritePosition - mHeader->readPosition.load());
+            size_t pieceSize = static_cast<size_t>(std::min<uint64_t>(remainingSize, freeSpace));
+
+            size_t dataSize = std::min(pieceSize, size);
+            WriteBytes(data, dataSize);
+            mWritePosition += pieceSize - dataSize;
+            data += dataSize;
+            size -= dataSize;
+            remainingSize -= pieceSize;
+        }
+
+        return true;
+    }
+
+    void SharedMemoryRing::Publish() {
+        if (mHeader->writePosition.load(std::memory_order_relaxed) == mWritePosition) {
+            return;
+        }
+
+        mHeader->writePosition.store(mWritePosition);
+        mHeader->writeSequence.fetch_add(1);
+        if (mHeader->consumerWaiting.load() != 0) {
+            WakeAddress(&mHeader->writeSequence);
+        }
+    }
+
+    bool SharedMemoryRing::HandleMessages(CommandHandler* handler) {
+        uint64_t writePosition = mHeader->writePosition.load(std::memory_order_acquire);
+        bool success = true;
+
+        // The producer can't have written more than the ring holds.
+        if (writePosition - mReadPosition > mCapacity) {
+            Close();
+            return false;
+        }
+
+        while (writePosition - mReadPosition > 0) {
+            uint64_t availableSize = writePosition - mReadPosition;
+            size_t ringOffset = static_cast<size_t>(mReadPosition % mCapacity);
+
+            // Continue copying a message that is bigger than the ring.
+            if (mPartialMessageRemainingSize != 0) {
+                size_t pieceSize = static_cast<size_t>(std::min<uint64_t>(
+                    {mPartialMessageRemainingSize, availableSize, mCapacity - ringOffset}));
+
+                // The padding at the end of the message isn't copied.
+                size_t dataSize = std::min(pieceSize, mPartialMessageSize - mMessage.size());
+                mMessage.insert(mMessage.end(), &mData[ringOffset], &mData[ringOffset + dataSize]);
+                mPartialMessageRemainingSize -= pieceSize;
+                mReadPosition += pieceSize;
+                ReleaseReadSpace(mReadPosition);
+
+                if (mPartialMessageRemainingSize == 0) {
+                    success = success &&
+                              handler->HandleCommands(mMessage.data(), mPartialMessageSize) != nullptr;
+                    mMessage.clear();
+                }
+                continue;
+            }
+
+            // Headers are aligned so they never straddle the end of the ring, but the data after
+            // them isn't trusted until it is validated.
+            if (availableSize < sizeof(MessageHeader)) {
+                Close();
+                return false;
+            }
+            MessageHeader header;
+            memcpy(&header, &mData[ringOffset], sizeof(header));
+
+            // Padding always goes until the end of the ring.
+            if (header.isPadding) {
+                if (header.size != mCapacity - ringOffset || header.size > availableSize) {
+                    Close();
+                    return false;
+                }
+                mReadPosition += header.size;
+                ReleaseReadSpace(mReadPosition);
+                continue;
+            }
+
+            if (header.size > kMaxMessageSize) {
+                Close();
+                return false;
+            }
+
+            size_t alignedSize = AlignedMessageSize(header.size);
+            if (alignedSize > mCapacity) {
+                mPartialMessageSize = header.size;
+                mPartialMessageRemainingSize = alignedSize - sizeof(header);
+                mReadPosition += sizeof(header);
+                ReleaseReadSpace(mReadPosition);
+                continue;
+            }
+
+            // Messages that fit are published whole and contiguous.
+            if (availableSize < alignedSize || ringOffset + alignedSize > mCapacity) {
+                Close();
+                return false;
+            }
+            // Empty messages are given a pointer in the ring since there is nothing to copy.
+            const uint8_t* messageData = &mData[ringOffset + sizeof(header)];
+            if (header.size != 0) {
+                mMessage.assign(messageData, messageData + header.size);
+                messageData = mMessage.data();
+            }
+            mReadPosition += alignedSize;
+            ReleaseReadSpace(mReadPosition);
+
+            success = success && handler->HandleCommands(messageData, header.size) != nullptr;
+            mMessage.clear();
+        }
+
+        return success;
+    }
+
+    bool SharedMemoryRing::WaitForMessages(uint32_t timeoutMs) {
+        auto hasMessages = [this]() -> bool {
+            return mHeader->writePosition.load() != mHeader->readPosition.load();
+        };
+
+        if (hasMessages()) {
+            return true;
+        }
+
+        uint32_t sequence = mHeader->writeSequence.load();
+        mHeader->consumerWaiting.store(1);
+        // Check again after announcing that we wait so that a publish can't be missed.
+        if (!hasMessages() && !IsClosed()) {
+            WaitOnAddress(&mHeader->writeSequence, sequence, timeoutMs);
+        }
+        mHeader->consumerWaiting.store(0);
+
+        return hasMessages();
+    }
+
+    void SharedMemoryRing::Close() {
+        mHeader->closed.store(1);
+        mHeader->writeSequence.fetch_add(1);
+        mHeader->readSequence.fetch_add(1);
+        WakeAddress(&mHeader->writeSequence);
+        WakeAddress(&mHeader->readSequence);
+    }
+
+    bool SharedMemoryRing::IsClosed() const {
+        return mHeader->closed.load() != 0;
+    }
+
+    bool SharedMemoryRing::WaitForSpace(size_t size) {
+        ASSERT(size <= mCapacity);
+
+        auto hasSpace = [this, size]() -> bool {
+            return mCapacity - (mWritePosition - mHeader->readPosition.load()) >= size;
+        };
+
+        while (!hasSpace()) {
+            if (IsClosed()) {
+                return false;
+            }
+
+            // The consumer might be waiting on data we haven't published yet.
+            Publish();
+
+            uint32_t sequence = mHeader->readSequence.load();
+            mHeader->producerWaiting.store(1);
+            if (!hasSpace() && !IsClosed()) {
+                WaitOnAddress(&mHeader->readSequence, sequence, kWaitSliceMs);
+            }
+            mHeader->producerWaiting.store(0);
+        }
+
+        return !IsClosed();
+    }
+
+    void SharedMemoryRing::WriteBytes(const uint8_t* data, size_t size) {
+        size_t ringOffset = static_cast<size_t>(mWritePosition % mCapacity);
+        size_t firstSize = std::min(size, mCapacity - ringOffset);
+        memcpy(&mData[ringOffset], data, firstSize);
+        memcpy(&mData[0], data + firstSize, size - firstSize);
+        mWritePosition += size;
+    }
+
+    void SharedMemoryRing::ReleaseReadSpace(uint64_t readPosition) {
+        mHeader->readPosition.store(readPosition);
+        mHeader->readSequence.fetch_add(1);
+        if (mHeader->producerWaiting.load() != 0) {
+            WakeAddress(&mHeader->readSequence);
+        }
+    }
+
+    SharedMemoryRingSerializer::SharedMemoryRingSerializer(SharedMemoryRing* ring)
+        : mRing(ring), mChunks(this) {
+    }
+
+    SharedMemoryRingSerializer::~SharedMemoryRingSerializer() {
+    }
+
+    void* SharedMemoryRingSerializer::GetCmdSpace(size_t size) {
+        return mChunks.GetCmdSpace(size);
+    }
+
+    void SharedMemoryRingSerializer::Flush() {
+        mChunks.Flush();
+        mRing->Publish();
+    }
+
+    const uint8_t* SharedMemoryRingSerializer::HandleCommands(const uint8_t* commands,
+                                                              size_t size) {
+        if (!mRing->Write(commands, size)) {
+            return nullptr;
+        }
+        return commands + size;
+    }
+
+}}  // namespace nxt::wire
@@ -0,0 +1,118 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_SHARED_MEMORY_RING_H_
+#define WIRE_SHARED_MEMORY_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/Wire.h"
+
+namespace nxt { namespace wire {
+
+    struct RingHeader;
+
+    // A lock-free single-producer single-consumer ring of messages that lives in memory that can
+    // be shared between processes. The memory contains a header with the read and write
+    // positions followed by the ring data, and nothing in it depends on the address where it is
+    // mapped.
+    //
+    // Messages that fit in the ring are always contiguous, bigger messages are streamed through
+    // the ring and reassembled by the consumer. The consumer copies messages out of the ring
+    // before handling them so that the producer can't change them while they are handled.
+    // When a side has to wait for the other, it sleeps on a futex in the header on Linux and
+    // yields in a loop on other platforms.
+    class SharedMemoryRing {
+      public:
+        // The capacity must be a power of two and at least 64 bytes.
+        static size_t GetRequiredMemorySize(size_t capacity);
+        // Must be called once on the memory before views on it are created.
+        static void Initialize(void* memory, size_t capacity);
+
+        // Messages can't be bigger than this, so that a misbehaving producer can't make the
+        // consumer reassemble arbitrarily big messages.
+        static constexpr size_t kMaxMessageSize = 256 * 1024 * 1024;
+
+        // Creates a view on memory that was initialized with Initialize. The capacity is passed
+        // again, instead of read back from the header, because the other process can write to
+        // the memory.
+        SharedMemoryRing(void* memory, size_t capacity);
+
+        size_t GetCapacity() const;
+
+        // Producer side. Write copies a message in the ring, waiting for space if needed, and
+        // returns false if the ring was closed. Messages are visible to the consumer only once
+        // they are published, which also happens when Write has to wait.
+        bool Write(const uint8_t* data, size_t size);
+        void Publish();
+
+        // Consumer side. Gives all the complete published messages to the handler and returns
+        // false if the handler failed to handle one of them. Data that wasn't written by a
+        // well-behaved producer closes the ring and makes this return false.
+        bool HandleMessages(CommandHandler* handler);
+        // Waits for new published data until the timeout expires or the ring is closed, returns
+        // whether there is data to read.
+        bool WaitForMessages(uint32_t timeoutMs);
+
+        // Can be called by either side to stop the other one from waiting forever, for example
+        // when the connection is shutting down.
+        void Close();
+        bool IsClosed() const;
+
+      private:
+        // Waits until there are at least size bytes free, returns false if the ring is closed.
+        bool WaitForSpace(size_t size);
+        void WriteBytes(const uint8_t* data, size_t size);
+        void ReleaseReadSpace(uint64_t readPosition);
+
+        RingHeader* mHeader;
+        uint8_t* mData;
+        size_t mCapacity;
+
+        // Producer state, the position up to which data has been written but not yet published.
+        uint64_t mWritePosition = 0;
+
+        // Consumer state. The read position is kept locally so that the producer can't change it.
+        uint64_t mReadPosition = 0;
+        // The copy of the message being handled. Messages bigger than the ring are copied piece
+        // by piece.
+        std::vector<uint8_t> mMessage;
+        size_t mPartialMessageSize = 0;
+        // Includes the padding at the end of the message.
+        size_t mPartialMessageRemainingSize = 0;
+    };
+
+    // A CommandSerializer that records commands with a ChunkedCommandSerializer and writes each
+    // chunk to the ring as a message on Flush.
+    class SharedMemoryRingSerializer : public CommandSerializer, private CommandHandler {
+      public:
+        SharedMemoryRingSerializer(SharedMemoryRing* ring);
+        ~SharedMemoryRingSerializer();
+
+        void* GetCmdSpace(size_t size) override;
+        void Flush() override;
+
+      private:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override;
+
+        SharedMemoryRing* mRing;
+        ChunkedCommandSerializer mChunks;
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_SHARED_MEMORY_RING_H_
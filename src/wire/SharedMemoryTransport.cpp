@@ -0,0 +1,186 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/SharedMemoryTransport.h"
+
+#include "common/Math.h"
+#include "common/Platform.h"
+
+#if NXT_PLATFORM_LINUX
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace nxt { namespace wire {
+
+    namespace {
+
+        // The layout of the region: a small header followed by the two rings, and the bulk data
+        // channel if there is one.
+        struct TransportHeader {
+            uint32_t magic;
+            uint32_t ringCapacity;
+            uint32_t bulkDataSize;
+        };
+        constexpr uint32_t kTransportMagic = 0x4e585457;  // "NXTW"
+        constexpr size_t kRingsOffset = 64;
+
+        size_t GetRegionSize(size_t ringCapacity, size_t bulkDataSize) {
+            size_t size = kRingsOffset + 2 * SharedMemoryRing::GetRequiredMemorySize(ringCapacity);
+            if (bulkDataSize != 0) {
+                size += BulkDataChannel::GetRequiredMemorySize(bulkDataSize, bulkDataSize);
+            }
+            return size;
+        }
+
+    }  // anonymous namespace
+
+#if NXT_PLATFORM_LINUX
+
+    // static
+    std::unique_ptr<SharedMemoryTransport> SharedMemoryTransport::Create(size_t ringCapacity,
+                                                                         size_t bulkDataSize) {
+        size_t ringSize = SharedMemoryRing::GetRequiredMemorySize(ringCapacity);
+        size_t size = GetRegionSize(ringCapacity, bulkDataSize);
+
+        // Calling memfd_create through syscall works with older C libraries without a wrapper.
+        int fd = static_cast<int>(syscall(SYS_memfd_create, "nxt-wire", 0));
+        if (fd < 0) {
+            return nullptr;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            close(fd);
+            return nullptr;
+        }
+
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+
+        TransportHeader* header = reinterpret_cast<TransportHeader*>(memory);
+        header->magic = kTransportMagic;
+        header->ringCapacity = static_cast<uint32_t>(ringCapacity);
+        header->bulkDataSize = static_cast<uint32_t>(bulkDataSize);
+        uint8_t* rings = reinterpret_cast<uint8_t*>(memory) + kRingsOffset;
+        SharedMemoryRing::Initialize(rings, ringCapacity);
+        SharedMemoryRing::Initialize(rings + ringSize, ringCapacity);
+        if (bulkDataSize != 0) {
+            BulkDataChannel::Initialize(rings + 2 * ringSize);
+        }
+
+        return std::unique_ptr<SharedMemoryTransport>(
+            new SharedMemoryTransport(fd, memory, size, ringCapacity, bulkDataSize));
+    }
+
+    // static
+    std::unique_ptr<SharedMemoryTransport> SharedMemoryTransport::Open(int fd) {
+        struct stat fdStat;
+        if (fstat(fd, &fdStat) != 0 || static_cast<size_t>(fdStat.st_size) < kRingsOffset) {
+            close(fd);
+            return nullptr;
+        }
+        size_t size = static_cast<size_t>(fdStat.st_size);
+
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (memory == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+
+        // Check the other process gave us a region with the layout we expect. The header is read
+        // once so that the other process can't change it after it is validated.
+        const TransportHeader* header = reinterpret_cast<const TransportHeader*>(memory);
+        uint32_t magic = header->magic;
+        size_t ringCapacity = header->ringCapacity;
+        size_t bulkDataSize = header->bulkDataSize;
+        if (magic != kTransportMagic || !IsPowerOfTwo(ringCapacity) || ringCapacity < 64 ||
+            size != GetRegionSize(ringCapacity, bulkDataSize)) {
+            munmap(memory, size);
+            close(fd);
+            return nullptr;
+        }
+
+        return std::unique_ptr<SharedMemoryTransport>(
+            new SharedMemoryTransport(fd, memory, size, ringCapacity, bulkDataSize));
+    }
+
+    SharedMemoryTransport::~SharedMemoryTransport() {
+        mClientToServer = nullptr;
+        mServerToClient = nullptr;
+        mClientBulkData = nullptr;
+        mServerBulkData = nullptr;
+        munmap(mMemory, mSize);
+        close(mFd);
+    }
+
+#else
+
+    // static
+    std::unique_ptr<SharedMemoryTransport> SharedMemoryTransport::Create(size_t, size_t) {
+        return nullptr;
+    }
+
+    // static
+    std::unique_ptr<SharedMemoryTransport> SharedMemoryTransport::Open(int) {
+        return nullptr;
+    }
+
+    SharedMemoryTransport::~SharedMemoryTransport() {
+    }
+
+#endif  // NXT_PLATFORM_LINUX
+
+    SharedMemoryTransport::SharedMemoryTransport(int fd,
+                                                 void* memory,
+                                                 size_t size,
+                                                 size_t ringCapacity,
+                                                 size_t bulkDataSize)
+        : mFd(fd), mMemory(memory), mSize(size) {
+        size_t ringSize = SharedMemoryRing::GetRequiredMemorySize(ringCapacity);
+        uint8_t* rings = reinterpret_cast<uint8_t*>(memory) + kRingsOffset;
+
+        mClientToServer.reset(new SharedMemoryRing(rings, ringCapacity));
+        mServerToClient.reset(new SharedMemoryRing(rings + ringSize, ringCapacity));
+
+        if (bulkDataSize != 0) {
+            uint8_t* bulkData = rings + 2 * ringSize;
+            mClientBulkData.reset(new BulkDataChannel(bulkData, bulkDataSize, bulkDataSize,
+                                                      BulkDataChannel::Side::Client));
+            mServerBulkData.reset(new BulkDataChannel(bulkData, bulkDataSize, bulkDataSize,
+                                                      BulkDataChannel::Side::Server));
+        }
+    }
+
+    int SharedMemoryTransport::GetFd() const {
+        return mFd;
+    }
+
+    SharedMemoryRing* SharedMemoryTransport::GetClientToServerRing() {
+        return mClientToServer.get();
+    }
+
+    SharedMemoryRing* SharedMemoryTransport::GetServerToClientRing() {
+        return mServerToClient.get();
+    }
+
+    BulkDataChannel* SharedMemoryTransport::GetBulkDataChannel(BulkDataChannel::Side side) {
+        return side == BulkDataChannel::Side::Client ? mClientBulkData.get()
+                                                     : mServerBulkData.get();
+    }
+
+}}  // namespace nxt::wire
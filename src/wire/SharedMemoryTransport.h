@@ -0,0 +1,68 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_SHARED_MEMORY_TRANSPORT_H_
+#define WIRE_SHARED_MEMORY_TRANSPORT_H_
+
+#include <memory>
+
+#include "wire/BulkDataChannel.h"
+#include "wire/SharedMemoryRing.h"
+
+namespace nxt { namespace wire {
+
+    // A shared memory region containing a ring for the client->server commands and one for the
+    // server->client return commands, optionally followed by a BulkDataChannel with regions of
+    // bulkDataSize bytes in each direction. One process creates it and sends the file descriptor
+    // to the other process, for example over a UNIX socket, which opens it.
+    //
+    // Only implemented on Linux where the region is a memfd, Create and Open return nullptr on
+    // other platforms.
+    class SharedMemoryTransport {
+      public:
+        static std::unique_ptr<SharedMemoryTransport> Create(size_t ringCapacity,
+                                                             size_t bulkDataSize = 0);
+        // Takes ownership of the file descriptor.
+        static std::unique_ptr<SharedMemoryTransport> Open(int fd);
+        ~SharedMemoryTransport();
+
+        SharedMemoryTransport(const SharedMemoryTransport&) = delete;
+        SharedMemoryTransport& operator=(const SharedMemoryTransport&) = delete;
+
+        int GetFd() const;
+
+        SharedMemoryRing* GetClientToServerRing();
+        SharedMemoryRing* GetServerToClientRing();
+        // Returns nullptr if the transport was created without bulk data.
+        BulkDataChannel* GetBulkDataChannel(BulkDataChannel::Side side);
+
+      private:
+        SharedMemoryTransport(int fd,
+                              void* memory,
+                              size_t size,
+                              size_t ringCapacity,
+                              size_t bulkDataSize);
+
+        int mFd;
+        void* mMemory;
+        size_t mSize;
+        std::unique_ptr<SharedMemoryRing> mClientToServer;
+        std::unique_ptr<SharedMemoryRing> mServerToClient;
+        std::unique_ptr<BulkDataChannel> mClientBulkData;
+        std::unique_ptr<BulkDataChannel> mServerBulkData;
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_SHARED_MEMORY_TRANSPORT_H_
@@ -0,0 +1,314 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/TraceReplayer.h"
+
+#include "common/Assert.h"
+#include "common/Math.h"
+#include "wire/BulkDataChannel.h"
+#include "wire/ChunkedCommandSerializer.h"
+#include "wire/WireCmd.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+namespace nxt { namespace wire {
+
+    namespace {
+
+        constexpr uint64_t kHashOffsetBasis = 0xcbf29ce484222325ull;
+        constexpr uint64_t kHashPrime = 0x100000001b3ull;
+
+        uint64_t HashBytes(uint64_t hash, const uint8_t* data, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ data[i]) * kHashPrime;
+            }
+            return hash;
+        }
+
+        uint32_t GetCommandId(const uint8_t* command) {
+            uint32_t id;
+            memcpy(&id, command, sizeof(id));
+            return id;
+        }
+
+        // Handles the return commands of the server in place of a client: hashes them with the
+        // readback data they reference, which is released immediately.
+        class ReturnCommandHasher : public CommandSerializer, private CommandHandler {
+          public:
+            ReturnCommandHasher(BulkDataChannel* bulkData) : mBulkData(bulkData), mStaging(this) {
+            }
+
+            void* GetCmdSpace(size_t size) override {
+                mCommandSizes.push_back(static_cast<uint32_t>(size));
+                return mStaging.GetCmdSpace(size);
+            }
+
+            void Flush() override {
+                mNextCommand = 0;
+                mStaging.Flush();
+                mCommandSizes.clear();
+            }
+
+            uint64_t GetHash() const {
+                return mHash;
+            }
+
+          private:
+            const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+                size_t offset = 0;
+                while (offset != size) {
+                    size_t commandSize = mCommandSizes[mNextCommand++];
+                    HandleCommand(commands + offset, commandSize);
+                    offset += commandSize;
+                }
+                return commands + size;
+            }
+
+            void HandleCommand(const uint8_t* command, size_t size) {
+                mHash = HashBytes(mHash, command, size);
+
+                if (mBulkData == nullptr ||
+                    GetCommandId(command) !=
+                        static_cast<uint32_t>(ReturnWireCmd::BufferMapReadAsyncCallback)) {
+                    return;
+                }
+                ReturnBufferMapReadAsyncCallbackCmd cmd;
+                memcpy(&cmd, command, sizeof(cmd));
+                if (cmd.bulkDataSerial == 0) {
+                    return;
+                }
+                const uint8_t* data =
+                    mBulkData->Receive(cmd.bulkDataSerial, cmd.bulkDataOffset, cmd.dataLength);
+                ASSERT(data != nullptr);
+                mHash = HashBytes(mHash, data, cmd.dataLength);
+                mBulkData->Release(cmd.bulkDataSerial);
+            }
+
+            BulkDataChannel* mBulkData;
+            ChunkedCommandSerializer mStaging;
+            std::vector<uint32_t> mCommandSizes;
+            size_t mNextCommand = 0;
+            uint64_t mHash = kHashOffsetBasis;
+        };
+
+    }  // anonymous namespace
+
+    TraceReplayer::TraceReplayer(uint8_t* trace, size_t size) {
+        TraceReader reader(trace, size);
+        if (!reader.IsValid()) {
+            return;
+        }
+        mHeader = reader.GetHeader();
+
+        // The hash of the trace's return commands is computed like ReturnCommandHasher does, the
+        // readback data being recorded before the commands referencing it.
+        mTracedReturnHash = kHashOffsetBasis;
+        std::vector<TraceRecord> readbacks;
+
+        TraceRecord record;
+        while (reader.Next(&record)) {
+            switch (record.type) {
+                case TraceRecordType::Commands:
+                    mCommandCount += record.commandCount;
+                    mCommandBytes += record.size;
+                    mRecords.push_back(record);
+                    break;
+
+                case TraceRecordType::UploadData:
+                    mRecords.push_back(record);
+                    break;
+
+                case TraceRecordType::ReadbackData:
+                    readbacks.push_back(record);
+                    break;
+
+                case TraceRecordType::ReturnCommands: {
+                    const uint8_t* command = record.data;
+                    for (uint32_t i = 0; i < record.commandCount; ++i) {
+                        size_t commandSize = record.commandSizes[i];
+                        mTracedReturnHash = HashBytes(mTracedReturnHash, command, commandSize);
+                        if (GetCommandId(command) ==
+                            static_cast<uint32_t>(ReturnWireCmd::BufferMapReadAsyncCallback)) {
+                            ReturnBufferMapReadAsyncCallbackCmd cmd;
+                            memcpy(&cmd, command, sizeof(cmd));
+                            for (const TraceRecord& readback : readbacks) {
+                                if (cmd.bulkDataSerial != 0 &&
+                                    readback.bulkDataSerial == cmd.bulkDataSerial) {
+                                    mTracedReturnHash = HashBytes(mTracedReturnHash, readback.data,
+                                                                  readback.size);
+                                }
+                            }
+                        }
+                        command += commandSize;
+                    }
+                    readbacks.clear();
+                } break;
+            }
+        }
+
+        mValid = reader.IsValid();
+    }
+
+    TraceReplayer::~TraceReplayer() {
+    }
+
+    bool TraceReplayer::IsValid() const {
+        return mValid;
+    }
+
+    void TraceReplayer::SetSwapChainImplementation(uint64_t implementation) {
+        for (const TraceRecord& record : mRecords) {
+            if (record.type != TraceRecordType::Commands) {
+                continue;
+            }
+
+            // The records point in the trace given as writable to the constructor.
+            uint8_t* command = const_cast<uint8_t*>(record.data);
+            for (uint32_t i = 0; i < record.commandCount; ++i) {
+                if (GetCommandId(command) ==
+                    static_cast<uint32_t>(WireCmd::SwapChainBuilderSetImplementation)) {
+                    memcpy(command + offsetof(SwapChainBuilderSetImplementationCmd, implementation),
+                           &implementation, sizeof(implementation));
+                }
+                command += record.commandSizes[i];
+            }
+        }
+    }
+
+    bool TraceReplayer::Replay(nxtDevice device,
+                               const nxtProcTable& procs,
+                               std::vector<ReplayCommandStats>* stats) {
+        ASSERT(mValid);
+        mReplayNanoseconds = 0;
+
+        // The bulk data channel is recreated so that the serials start from 1 as in the trace.
+        std::unique_ptr<uint8_t[]> bulkDataStorage;
+        std::unique_ptr<BulkDataChannel> clientBulkData;
+        std::unique_ptr<BulkDataChannel> serverBulkData;
+        if (mHeader.bulkDataUploadSize != 0 || mHeader.bulkDataReadbackSize != 0) {
+            size_t uploadSize = static_cast<size_t>(mHeader.bulkDataUploadSize);
+            size_t readbackSize = static_cast<size_t>(mHeader.bulkDataReadbackSize);
+            size_t memorySize = BulkDataChannel::GetRequiredMemorySize(uploadSize, readbackSize);
+            bulkDataStorage.reset(new uint8_t[memorySize + 64]);
+            void* memory = AlignPtr(bulkDataStorage.get(), 64);
+            BulkDataChannel::Initialize(memory);
+
+            clientBulkData.reset(new BulkDataChannel(memory, uploadSize, readbackSize,
+                                                     BulkDataChannel::Side::Client));
+            serverBulkData.reset(new BulkDataChannel(memory, uploadSize, readbackSize,
+                                                     BulkDataChannel::Side::Server));
+        }
+
+        ReturnCommandHasher returns(clientBulkData.get());
+        std::unique_ptr<CommandHandler> server(
+            NewServerCommandHandler(device, procs, &returns, serverBulkData.get()));
+
+        bool success = true;
+        for (const TraceRecord& record : mRecords) {
+            if (record.type == TraceRecordType::UploadData) {
+                uint8_t* data = nullptr;
+                if (clientBulkData != nullptr) {
+                    data = clientBulkData->GetWriteData(record.bulkDataOffset,
+                                                        static_cast<uint32_t>(record.size));
+                }
+                if (data == nullptr) {
+                    success = false;
+                    break;
+                }
+                memcpy(data, record.data, record.size);
+                continue;
+            }
+
+            if (!HandleCommands(server.get(), record, stats)) {
+                success = false;
+                break;
+            }
+            returns.Flush();
+        }
+
+        mReplayReturnHash = returns.GetHash();
+        return success;
+    }
+
+    bool TraceReplayer::HandleCommands(CommandHandler* server,
+                                       const TraceRecord& record,
+                                       std::vector<ReplayCommandStats>* stats) {
+        using Clock = std::chrono::high_resolution_clock;
+
+        if (stats == nullptr) {
+            auto start = Clock::now();
+            const uint8_t* end = server->HandleCommands(record.data, record.size);
+            mReplayNanoseconds +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            return end != nullptr;
+        }
+
+        // Split the chunk in runs of commands of the same type.
+        const uint8_t* runStart = record.data;
+        uint32_t i = 0;
+        while (i < record.commandCount) {
+            uint32_t id = GetCommandId(runStart);
+            size_t runSize = 0;
+            uint32_t runCount = 0;
+            while (i < record.commandCount && GetCommandId(runStart + runSize) == id) {
+                runSize += record.commandSizes[i];
+                runCount++;
+                i++;
+            }
+
+            auto start = Clock::now();
+            const uint8_t* end = server->HandleCommands(runStart, runSize);
+            uint64_t nanoseconds =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            if (end == nullptr) {
+                return false;
+            }
+            mReplayNanoseconds += nanoseconds;
+
+            if (id >= stats->size()) {
+                stats->resize(id + 1);
+            }
+            (*stats)[id].count += runCount;
+            (*stats)[id].bytes += runSize;
+            (*stats)[id].nanoseconds += nanoseconds;
+
+            runStart += runSize;
+        }
+        return true;
+    }
+
+    uint64_t TraceReplayer::GetCommandCount() const {
+        return mCommandCount;
+    }
+
+    uint64_t TraceReplayer::GetCommandBytes() const {
+        return mCommandBytes;
+    }
+
+    uint64_t TraceReplayer::GetReplayNanoseconds() const {
+        return mReplayNanoseconds;
+    }
+
+    uint64_t TraceReplayer::GetReplayReturnHash() const {
+        return mReplayReturnHash;
+    }
+
+    uint64_t TraceReplayer::GetTracedReturnHash() const {
+        return mTracedReturnHash;
+    }
+
+}}  // namespace nxt::wire
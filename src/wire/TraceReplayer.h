@@ -0,0 +1,85 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_TRACE_REPLAYER_H_
+#define WIRE_TRACE_REPLAYER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "wire/CommandTrace.h"
+
+namespace nxt { namespace wire {
+
+    // Statistics for a type of command when replaying a trace.
+    struct ReplayCommandStats {
+        uint64_t count = 0;
+        uint64_t bytes = 0;
+        uint64_t nanoseconds = 0;
+    };
+
+    // Replays the commands of a trace on a new wire server for each replay. The return commands
+    // are consumed like a client would, releasing the bulk data they reference, and hashed so that
+    // replays can be checked to be deterministic, and to match the trace when the backend is the
+    // same as the one that was traced.
+    class TraceReplayer {
+      public:
+        // The trace must be aligned to 8 bytes and outlive the replayer. It is modified in place by
+        // SetSwapChainImplementation.
+        TraceReplayer(uint8_t* trace, size_t size);
+        ~TraceReplayer();
+
+        bool IsValid() const;
+
+        // SwapChainBuilderSetImplementation commands contain pointers that were only valid in the
+        // traced process, replace them with an implementation for the replay device.
+        void SetSwapChainImplementation(uint64_t implementation);
+
+        // Replays all the commands, returning false if the server rejected some. When stats isn't
+        // null, it is indexed by WireCmd and the commands are handled in runs of the same type that
+        // are timed separately, which adds the overhead of the timer to each run.
+        bool Replay(nxtDevice device,
+                    const nxtProcTable& procs,
+                    std::vector<ReplayCommandStats>* stats = nullptr);
+
+        uint64_t GetCommandCount() const;
+        uint64_t GetCommandBytes() const;
+
+        // The time spent in the server's HandleCommands during the last replay.
+        uint64_t GetReplayNanoseconds() const;
+
+        // FNV-1a hashes of the return commands and readback data of the last replay, and of the
+        // trace.
+        uint64_t GetReplayReturnHash() const;
+        uint64_t GetTracedReturnHash() const;
+
+      private:
+        bool HandleCommands(CommandHandler* server,
+                            const TraceRecord& record,
+                            std::vector<ReplayCommandStats>* stats);
+
+        std::vector<TraceRecord> mRecords;
+        TraceHeader mHeader = {};
+        bool mValid = false;
+
+        uint64_t mCommandCount = 0;
+        uint64_t mCommandBytes = 0;
+        uint64_t mReplayNanoseconds = 0;
+        uint64_t mReplayReturnHash = 0;
+        uint64_t mTracedReturnHash = 0;
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_TRACE_REPLAYER_H_
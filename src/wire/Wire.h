@@ -34,12 +34,22 @@ namespace nxt { namespace wire {
         virtual const uint8_t* HandleCommands(const uint8_t* commands, size_t size) = 0;
     };
 
+    class BulkDataChannel;
+
+    // When a BulkDataChannel is given, with the matching side, large SetSubData and MapReadAsync
+    // payloads are sent through it instead of inline in the commands.
+    //
+    // The server ticks the device each time it handles commands. To call the client's callbacks
+    // promptly, hosts can poll the device's completion fd and give the server an empty batch of
+    // commands when it is readable.
     CommandHandler* NewClientDevice(nxtProcTable* procs,
                                     nxtDevice* device,
-                                    CommandSerializer* serializer);
+                                    CommandSerializer* serializer,
+                                    BulkDataChannel* bulkData = nullptr);
     CommandHandler* NewServerCommandHandler(nxtDevice device,
                                             const nxtProcTable& procs,
-                                            CommandSerializer* serializer);
+                                            CommandSerializer* serializer,
+                                            BulkDataChannel* bulkData = nullptr);
 
 }}  // namespace nxt::wire
 
@@ -32,7 +32,14 @@ namespace nxt { namespace wire {
         return sizeof(*this);
     }
 
+    size_t BufferSetSubDataBulkCmd::GetRequiredSize() const {
+        return sizeof(*this);
+    }
+
     size_t ReturnBufferMapReadAsyncCallbackCmd::GetRequiredSize() const {
+        if (bulkDataSerial != 0) {
+            return sizeof(*this);
+        }
         return sizeof(*this) + dataLength;
     }
 
@@ -44,4 +51,36 @@ namespace nxt { namespace wire {
         return this + 1;
     }
 
+    size_t DeviceMapReadRangesAsyncCmd::GetRequiredSize() const {
+        return sizeof(*this) + rangeCount * sizeof(MapReadRange);
+    }
+
+    MapReadRange* DeviceMapReadRangesAsyncCmd::GetRanges() {
+        return reinterpret_cast<MapReadRange*>(this + 1);
+    }
+
+    const MapReadRange* DeviceMapReadRangesAsyncCmd::GetRanges() const {
+        return reinterpret_cast<const MapReadRange*>(this + 1);
+    }
+
+    size_t ReturnDeviceMapReadRangesAsyncCallbackCmd::GetRequiredSize() const {
+        return sizeof(*this) + dataLength;
+    }
+
+    void* ReturnDeviceMapReadRangesAsyncCallbackCmd::GetData() {
+        return this + 1;
+    }
+
+    const void* ReturnDeviceMapReadRangesAsyncCallbackCmd::GetData() const {
+        return this + 1;
+    }
+
+    size_t FenceOnCompletionCmd::GetRequiredSize() const {
+        return sizeof(*this);
+    }
+
+    size_t ReturnFenceUpdateCompletedValueCmd::GetRequiredSize() const {
+        return sizeof(*this);
+    }
+
 }}  // namespace nxt::wire
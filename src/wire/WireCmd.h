@@ -40,11 +40,59 @@ namespace nxt { namespace wire {
         size_t GetRequiredSize() const;
     };
 
+    // SetSubData with the data in the upload region of the BulkDataChannel.
+    struct BufferSetSubDataBulkCmd {
+        wire::WireCmd commandId = WireCmd::BufferSetSubDataBulk;
+
+        uint32_t bufferId;
+        uint32_t start;
+        uint32_t count;
+        uint32_t dataSerial;
+        uint32_t dataOffset;
+
+        size_t GetRequiredSize() const;
+    };
+
+    // Followed by the data on success, unless bulkDataSerial isn't 0 in which case the data is in
+    // the readback region of the BulkDataChannel.
     struct ReturnBufferMapReadAsyncCallbackCmd {
         wire::ReturnWireCmd commandId = ReturnWireCmd::BufferMapReadAsyncCallback;
 
         uint32_t bufferId;
         uint32_t bufferSerial;
+        uint32_t requestSerial;
+        uint32_t status;
+        uint32_t dataLength;
+        uint32_t bulkDataSerial = 0;
+        uint32_t bulkDataOffset = 0;
+
+        size_t GetRequiredSize() const;
+        void* GetData();
+        const void* GetData() const;
+    };
+
+    struct MapReadRange {
+        uint32_t bufferId;
+        uint32_t start;
+        uint32_t size;
+    };
+
+    // Followed by rangeCount MapReadRange.
+    struct DeviceMapReadRangesAsyncCmd {
+        wire::WireCmd commandId = WireCmd::DeviceMapReadRangesAsync;
+
+        uint32_t requestSerial;
+        uint32_t rangeCount;
+
+        size_t GetRequiredSize() const;
+        MapReadRange* GetRanges();
+        const MapReadRange* GetRanges() const;
+    };
+
+    // Followed by the data of all the ranges, one after the other, on success.
+    struct ReturnDeviceMapReadRangesAsyncCallbackCmd {
+        wire::ReturnWireCmd commandId = ReturnWireCmd::DeviceMapReadRangesAsyncCallback;
+
         uint32_t requestSerial;
         uint32_t status;
         uint32_t dataLength;
@@ -54,6 +102,26 @@ namespace nxt { namespace wire {
         const void* GetData() const;
     };
 
+    // Asks the server to send the completed value of the fence when it reaches value.
+    struct FenceOnCompletionCmd {
+        wire::WireCmd commandId = WireCmd::FenceOnCompletion;
+
+        uint32_t fenceId;
+        uint64_t value;
+
+        size_t GetRequiredSize() const;
+    };
+
+    struct ReturnFenceUpdateCompletedValueCmd {
+        wire::ReturnWireCmd commandId = ReturnWireCmd::FenceUpdateCompletedValue;
+
+        uint32_t fenceId;
+        uint32_t fenceSerial;
+        uint64_t value;
+
+        size_t GetRequiredSize() const;
+    };
+
 }}  // namespace nxt::wire
 
 #endif  // WIRE_WIRECMD_H_
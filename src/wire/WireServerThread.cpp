@@ -0,0 +1,140 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "wire/WireServerThread.h"
+
+#include "common/Assert.h"
+#include "common/Platform.h"
+
+#if NXT_PLATFORM_POSIX
+#    include <errno.h>
+#    include <poll.h>
+#endif
+
+namespace nxt { namespace wire {
+
+    namespace {
+
+        class DiscardingCommandHandler : public CommandHandler {
+          public:
+            const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override {
+                return commands + size;
+            }
+        };
+
+    }  // anonymous namespace
+
+    WireServerThread::WireServerThread(nxtDevice device,
+                                       const nxtProcTable& procs,
+                                       size_t maxPendingFlushes)
+        : mCommands(maxPendingFlushes), mReturnCommands(0) {
+        mServer = NewServerCommandHandler(device, procs, &mReturnCommands);
+        mThread = std::thread([this]() { ThreadMain(); });
+
+        int completionFd = procs.deviceGetCompletionFd(device);
+        if (completionFd >= 0 && mStopCompletionThread.GetFd() >= 0) {
+            mCompletionThread =
+                std::thread([this, completionFd]() { CompletionThreadMain(completionFd); });
+        }
+    }
+
+    WireServerThread::~WireServerThread() {
+        if (mCompletionThread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mHandledMutex);
+                mStopping = true;
+                mHandledCondition.notify_all();
+            }
+            mStopCompletionThread.Signal();
+            mCompletionThread.join();
+        }
+
+        mCommands.Close();
+        mThread.join();
+        delete mServer;
+
+        // Drop the return commands that were never handled by the client.
+        DiscardingCommandHandler discard;
+        HandleReturnCommands(&discard);
+    }
+
+    CommandSerializer* WireServerThread::GetCommandSerializer() {
+        return &mCommands;
+    }
+
+    void WireServerThread::HandleReturnCommands(CommandHandler* client) {
+        while (mReturnCommands.HandleFlushedCommands(client, false)) {
+        }
+    }
+
+    void WireServerThread::WaitForIdle() {
+        mCommands.WaitForIdle();
+    }
+
+    const uint8_t* WireServerThread::HandleCommands(const uint8_t* commands, size_t size) {
+        const uint8_t* result = mServer->HandleCommands(commands, size);
+        // Make the return commands available to the client as soon as possible.
+        mReturnCommands.Flush();
+
+        {
+            std::lock_guard<std::mutex> lock(mHandledMutex);
+            mHandledCount++;
+            mHandledCondition.notify_all();
+        }
+        return result;
+    }
+
+    void WireServerThread::ThreadMain() {
+        while (mCommands.HandleFlushedCommands(this, true)) {
+        }
+    }
+
+    void WireServerThread::CompletionThreadMain(int completionFd) {
+#if NXT_PLATFORM_POSIX
+        pollfd fds[2] = {};
+        fds[0].fd = completionFd;
+        fds[0].events = POLLIN;
+        fds[1].fd = mStopCompletionThread.GetFd();
+        fds[1].events = POLLIN;
+
+        while (true) {
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            if (fds[1].revents != 0) {
+                return;
+            }
+
+            // The server ticks the device each time it handles commands, an empty batch is
+            // enough. Wait for it to be handled, otherwise we would see the fd readable again.
+            std::unique_lock<std::mutex> lock(mHandledMutex);
+            uint64_t handledCount = mHandledCount;
+            mCommands.Wake();
+            mHandledCondition.wait(
+                lock, [this, handledCount]() { return mHandledCount != handledCount || mStopping; });
+            if (mStopping) {
+                return;
+            }
+        }
+#else
+        // Only POSIX platforms have completion fds, the thread is never started on others.
+        (void)completionFd;
+        UNREACHABLE();
+#endif
+    }
+
+}}  // namespace nxt::wire
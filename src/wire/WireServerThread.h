@@ -0,0 +1,77 @@
+// Copyright 2017 The NXT Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef WIRE_WIRE_SERVER_THREAD_H_
+#define WIRE_WIRE_SERVER_THREAD_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "common/PollableEvent.h"
+#include "wire/CrossThreadCommandSerializer.h"
+#include "wire/Wire.h"
+
+namespace nxt { namespace wire {
+
+    // Runs a wire server on its own thread so that decoding the commands and executing them on
+    // the backend happens in parallel with the client recording the next ones. The backend
+    // device must support being used from a thread other than the one that created it.
+    //
+    // The client gets the serializer to record commands with, and every client Flush sends its
+    // commands to the server thread, blocking only if maxPendingFlushes flushes are already
+    // waiting to be handled. Return commands are recorded on the server thread and are handled
+    // on the client thread when it calls HandleReturnCommands, so client callbacks are always
+    // called on the client thread.
+    //
+    // When the device has a completion fd, another thread polls it and makes the server tick the
+    // device as soon as work completes, so that the client gets the return commands for its
+    // callbacks without having to flush commands.
+    class WireServerThread : private CommandHandler {
+      public:
+        WireServerThread(nxtDevice device, const nxtProcTable& procs, size_t maxPendingFlushes = 3);
+        ~WireServerThread();
+
+        CommandSerializer* GetCommandSerializer();
+
+        // Handles the return commands the server produced so far with the client.
+        void HandleReturnCommands(CommandHandler* client);
+        // Waits until the server has handled all the flushed commands.
+        void WaitForIdle();
+
+      private:
+        const uint8_t* HandleCommands(const uint8_t* commands, size_t size) override;
+        void ThreadMain();
+        void CompletionThreadMain(int completionFd);
+
+        CrossThreadCommandSerializer mCommands;
+        // Return commands aren't bounded, otherwise the server would wait for a client that can
+        // be waiting on the server in Flush.
+        CrossThreadCommandSerializer mReturnCommands;
+        CommandHandler* mServer = nullptr;
+        std::thread mThread;
+
+        std::thread mCompletionThread;
+        PollableEvent mStopCompletionThread;
+        // Lets the completion thread wait for the server to tick, as the completion fd stays
+        // readable until then.
+        std::mutex mHandledMutex;
+        std::condition_variable mHandledCondition;
+        uint64_t mHandledCount = 0;
+        bool mStopping = false;
+    };
+
+}}  // namespace nxt::wire
+
+#endif  // WIRE_WIRE_SERVER_THREAD_H_